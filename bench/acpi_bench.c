@@ -0,0 +1,586 @@
+/* Microbenchmarks for the hot paths of the table tools */
+#include "acpi_validate.h"
+#include "acpigen.h"
+#include "utils.h"
+#include <common.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Usage
+
+  acpi_bench [-b benchmarks] [-s sizes] [-p positions] [-r repeats]
+             [-w work_dir] [-l label] [-o out.json]
+
+  benchmarks  Comma separated, default all:
+                scan       locate_table_in_binary() (acpi_extractor) on a
+                           synthetic static archive
+                qcom_scan  locate_qcom_table_in_binary() (iort_reader) on a
+                           synthetic tz/hyp image
+                checksum   checksum() over the whole input
+                read       get_file_size() + read_file_content()
+                write      write_file_content()
+                walk       acpi_validate_table() on a PPTT of about the
+                           input size built with libacpigen (up to 64M)
+  sizes       Input sizes with K/M/G suffix, default 1M,16M,64M (4K..8G)
+  positions   Magic placement for the scans: start, middle, end, absent.
+              Default all four
+  repeats     Timed runs per case after one warm up run, default 10
+
+  Inputs are generated once into work_dir (default /tmp/acpi_bench) and
+  reused: a fixed seed xorshift filler with bit 7 set in every byte, so no
+  ASCII magic can appear by chance, and the magic planted at the requested
+  position. Scans and checksum run on a private mapping of the file, so
+  8G inputs do not need 8G of heap.
+
+  Every case reports throughput (input bytes / median), latency min, p50,
+  p90, p99, max and the resident set size, to stdout and as JSON to -o
+  (default bench.json). label (e.g. a commit hash) is stored in the JSON,
+  bench/compare.py prints the speedup between two result files.
+*/
+
+#define BENCH_SEED 0x9E3779B97F4A7C15ULL
+#define BENCH_CHUNK (1UL << 20)
+#define BENCH_MAX_WALK_SIZE (64UL << 20)
+#define BENCH_MAX_REPEATS 1000
+
+enum BENCH {
+  BENCH_SCAN = 0,
+  BENCH_QCOM_SCAN,
+  BENCH_CHECKSUM,
+  BENCH_READ,
+  BENCH_WRITE,
+  BENCH_WALK,
+  BENCH_COUNT,
+};
+
+static const char *const bench_names[BENCH_COUNT] = {
+    "scan", "qcom_scan", "checksum", "read", "write", "walk",
+};
+
+enum BENCH_POSITION {
+  POSITION_START = 0,
+  POSITION_MIDDLE,
+  POSITION_END,
+  POSITION_ABSENT,
+  POSITION_COUNT,
+};
+
+static const char *const position_names[POSITION_COUNT] = {
+    "start", "middle", "end", "absent",
+};
+
+// Synthetic inputs: a static archive (acpi_extractor) or a TZ image
+enum BENCH_INPUT {
+  INPUT_ARCHIVE = 0,
+  INPUT_QCOM_IMAGE,
+};
+
+typedef struct {
+  const char *workDir;
+  uint32_t repeats;
+} BenchConfig;
+
+typedef struct {
+  enum BENCH bench;
+  size_t size;
+  int position; // enum BENCH_POSITION, -1 when it does not apply
+  size_t bytes; // Bytes processed per run
+  uint64_t latency[BENCH_MAX_REPEATS];
+  uint32_t runs;
+  long maxRssKb;
+  long rssKb;
+} BenchResult;
+
+static volatile uint64_t bench_sink; // Keeps results of pure loops alive
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static long current_rss_kb(void) {
+  long pages = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (statm == NULL)
+    return 0;
+  if (fscanf(statm, "%*s %ld", &pages) != 1)
+    pages = 0;
+  fclose(statm);
+  return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static long max_rss_kb(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+// Nearest rank percentile of sorted latencies
+static uint64_t percentile(const BenchResult *result, uint32_t pct) {
+  uint32_t rank = (pct * result->runs + 99) / 100;
+  return result->latency[rank ? rank - 1 : 0];
+}
+
+static int parse_size(const char *text, size_t *size) {
+  char *end;
+  unsigned long long value = strtoull(text, &end, 0);
+
+  switch (*end) {
+  case 'k': case 'K': value <<= 10; end++; break;
+  case 'm': case 'M': value <<= 20; end++; break;
+  case 'g': case 'G': value <<= 30; end++; break;
+  default: break;
+  }
+  if (*end != '\0' || value < 4096)
+    return -EINVAL;
+  *size = (size_t)value;
+  return 0;
+}
+
+/**
+ * Magic payload of an input: the wrapped table of acpi_extractor
+ * ("ACGS", header, "ACGE") or a header with the QCOM OEM table ID.
+ */
+static size_t input_payload(enum BENCH_INPUT input, uint8_t *payload) {
+  const char start_magic[] = {ACPI_TABLE_START_MAGIC};
+  const char end_magic[] = {ACPI_TABLE_END_MAGIC};
+  ACPI_TABLE_HEADER header = {
+      .Signature = {'B', 'N', 'C', 'H'},
+      .Length = sizeof(ACPI_TABLE_HEADER),
+      .Revision = 1,
+  };
+
+  if (input == INPUT_QCOM_IMAGE) {
+    memcpy(header.OemTableId, "2KDEMOCQ", 8);
+    memcpy(payload, &header, sizeof(header));
+    return sizeof(header);
+  }
+  memcpy(payload, start_magic, sizeof(start_magic));
+  memcpy(payload + sizeof(start_magic), &header, sizeof(header));
+  memcpy(payload + sizeof(start_magic) + sizeof(header), end_magic,
+         sizeof(end_magic));
+  return sizeof(start_magic) + sizeof(header) + sizeof(end_magic);
+}
+
+/**
+ * Path of a synthetic input, generated on first use.
+ *
+ * @retval 0        Success, path holds the input file.
+ * @retval -EIO     Input can not be written.
+ */
+static int prepare_input(const BenchConfig *config, enum BENCH_INPUT input,
+                         size_t size, enum BENCH_POSITION position,
+                         char *path, size_t path_size) {
+  static const char *const prefix[] = {"archive", "image"};
+  static const uint8_t file_magic[][8] = {
+      {'!', '<', 'a', 'r', 'c', 'h', '>', '\n'}, // ar(1) archive
+      {0x7f, 'E', 'L', 'F', 2, 1, 1, 0},         // ELF64 (mbn)
+  };
+  uint8_t payload[64];
+  size_t payload_size = input_payload(input, payload);
+  size_t offset = 0;
+  struct stat st;
+  uint64_t state = BENCH_SEED;
+  uint8_t *chunk;
+  FILE *out;
+  int ret = 0;
+
+  snprintf(path, path_size, "%s/%s_%zu_%s.bin", config->workDir,
+           prefix[input], size, position_names[position]);
+  if (stat(path, &st) == 0 && (size_t)st.st_size == size)
+    return 0;
+
+  chunk = malloc(BENCH_CHUNK);
+  out = fopen(path, "wb");
+  if (chunk == NULL || out == NULL) {
+    log_err("Failed to create %s", path);
+    free(chunk);
+    if (out)
+      fclose(out);
+    return -EIO;
+  }
+  for (size_t done = 0; done < size && ret == 0; done += BENCH_CHUNK) {
+    size_t count = size - done < BENCH_CHUNK ? size - done : BENCH_CHUNK;
+    for (size_t i = 0; i < count; i++) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      chunk[i] = (uint8_t)(state >> 56) | 0x80;
+    }
+    if (done == 0)
+      memcpy(chunk, file_magic[input], sizeof(file_magic[input]));
+    if (fwrite(chunk, 1, count, out) != count)
+      ret = -EIO;
+  }
+
+  switch (position) {
+  case POSITION_START: offset = 0x40; break;
+  case POSITION_MIDDLE: offset = size / 2; break;
+  case POSITION_END: offset = size - payload_size - 16; break;
+  default: break;
+  }
+  if (ret == 0 && position != POSITION_ABSENT &&
+      (fseek(out, (long)offset, SEEK_SET) != 0 ||
+       fwrite(payload, 1, payload_size, out) != payload_size))
+    ret = -EIO;
+  if (fclose(out) != 0)
+    ret = -EIO;
+  free(chunk);
+  if (ret < 0) {
+    log_err("Failed to write %s", path);
+    unlink(path);
+  }
+  return ret;
+}
+
+static uint8_t *map_input(const char *path, size_t size) {
+  int fd = open(path, O_RDONLY);
+  void *data;
+
+  if (fd < 0)
+    return NULL;
+  data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  return data == MAP_FAILED ? NULL : data;
+}
+
+/**
+ * PPTT of about size bytes: clusters of 8 CPUs, each cluster with an L2
+ * and every CPU with the cluster L1I/L1D, like acpi_sweep.
+ */
+static int build_walk_table(AcpiGen *gen, AcpiArena *arena, size_t size,
+                            const uint8_t **table, size_t *length) {
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE cache = {
+      .Flags = PPTT_CACHE_FLAG_CACHE_TYPE_VALID,
+      .Attributes = SET_BITS(PPTT_CACHE_ATTR_CACHE_TYPE_MSK,
+                             PPTT_CACHE_ATTR_CACHE_TYPE_UNIFIED),
+  };
+  ACPI_PPTT_ID id = {0};
+  AcpiGenRef system, cluster, l2, l1[2];
+  uint32_t cpu = 0;
+  int ret = acpigen_pptt_begin(gen, arena);
+
+  if (ret < 0)
+    return ret;
+  l2 = acpigen_pptt_id(gen, &id);
+  system = acpigen_pptt_processor(gen, PPTT_PROC_FLAG_PHYSICAL_PACKAGE, 0,
+                                  ACPIGEN_NO_REF, &l2, 1);
+  for (uint32_t c = 0; gen->length < size && gen->error == 0; c++) {
+    l2 = acpigen_pptt_cache(gen, &cache, ACPIGEN_NO_REF);
+    l1[0] = acpigen_pptt_cache(gen, &cache, l2);
+    l1[1] = acpigen_pptt_cache(gen, &cache, l2);
+    cluster = acpigen_pptt_processor(gen, 0, c, system, &l2, 1);
+    for (uint32_t n = 0; n < 8; n++, cpu++)
+      acpigen_pptt_processor(gen,
+                             PPTT_PROC_FLAG_ACPI_PROC_ID_VALID |
+                                 PPTT_PROC_FLAG_NODE_IS_LEAF,
+                             cpu, cluster, l1, 2);
+  }
+  return acpigen_finalize(gen, table, length);
+}
+
+/**
+ * One warm up run, then config->repeats timed runs of a benchmark.
+ *
+ * @retval 0        Success.
+ * @retval -EINVAL  The scan result does not match the planted magic.
+ * @retval <0       Input could not be prepared.
+ */
+static int run_case(const BenchConfig *config, BenchResult *result) {
+  char path[512];
+  char out_path[512];
+  uint8_t *data = NULL;
+  AcpiArena arena;
+  AcpiGen gen;
+  const uint8_t *table = NULL;
+  size_t length = 0;
+  FileContent file = {0};
+  int position = result->position;
+  int ret = 0;
+
+  if (result->bench == BENCH_WALK) {
+    acpi_arena_init(&arena, 0);
+    ret = build_walk_table(&gen, &arena, result->size, &table, &length);
+    if (ret < 0) {
+      acpi_arena_free(&arena);
+      log_err("Failed to build a %zu bytes PPTT", result->size);
+      return ret;
+    }
+    result->bytes = length;
+  } else {
+    enum BENCH_INPUT input =
+        result->bench == BENCH_QCOM_SCAN ? INPUT_QCOM_IMAGE : INPUT_ARCHIVE;
+    ret = prepare_input(config, input, result->size,
+                        position < 0 ? POSITION_ABSENT : position, path,
+                        sizeof(path));
+    if (ret < 0)
+      return ret;
+    result->bytes = result->size;
+    if (result->bench != BENCH_READ && result->bench != BENCH_WRITE) {
+      data = map_input(path, result->size);
+      if (data == NULL) {
+        log_err("Failed to map %s", path);
+        return -ENOMEM;
+      }
+    } else if (result->bench == BENCH_WRITE) {
+      file.filePath = path;
+      file.fileSize = result->size;
+      file.fileBuffer = malloc(result->size);
+      if (file.fileBuffer == NULL || read_file_content(&file) == NULL) {
+        free(file.fileBuffer);
+        log_err("Failed to read %s", path);
+        return -ENOMEM;
+      }
+      snprintf(out_path, sizeof(out_path), "%s/write_%zu.bin",
+               config->workDir, result->size);
+      file.filePath = out_path;
+    }
+  }
+
+  for (uint32_t run = 0; run <= config->repeats && ret == 0; run++) {
+    uint64_t start = now_ns();
+    size_t offset = 0, wrapped = 0;
+    int found = -1;
+    AcpiValidation validation;
+
+    switch (result->bench) {
+    case BENCH_SCAN:
+      found = locate_table_in_binary(data, result->size, &offset,
+                                     &wrapped) == 0;
+      break;
+    case BENCH_QCOM_SCAN:
+      found = locate_qcom_table_in_binary(data, result->size, &offset) == 0;
+      break;
+    case BENCH_CHECKSUM:
+      bench_sink += checksum(data, result->size);
+      break;
+    case BENCH_READ: {
+      FileContent in = {.filePath = path};
+      if (get_file_size(&in) != result->size ||
+          (in.fileBuffer = malloc(in.fileSize)) == NULL ||
+          read_file_content(&in) == NULL)
+        ret = -EIO;
+      else
+        bench_sink += in.fileBuffer[in.fileSize - 1];
+      free(in.fileBuffer);
+      break;
+    }
+    case BENCH_WRITE:
+      ret = write_file_content(&file);
+      break;
+    case BENCH_WALK:
+      acpi_validate_table(table, length, "PPTT", &validation);
+      if (acpi_validation_failed(&validation)) {
+        log_err("Synthetic PPTT failed validation");
+        ret = -EINVAL;
+      }
+      bench_sink += validation.subtableCount;
+      break;
+    default:
+      break;
+    }
+    if (run > 0)
+      result->latency[result->runs++] = now_ns() - start;
+
+    if (found >= 0 && found != (position != POSITION_ABSENT)) {
+      log_err("%s %zu %s: magic %s", bench_names[result->bench],
+              result->size, position_names[position],
+              found ? "found but none was planted" : "not found");
+      ret = -EINVAL;
+    }
+  }
+
+  result->rssKb = current_rss_kb();
+  result->maxRssKb = max_rss_kb();
+  if (data)
+    munmap(data, result->size);
+  if (result->bench == BENCH_WRITE) {
+    unlink(out_path);
+    free(file.fileBuffer);
+  }
+  if (result->bench == BENCH_WALK)
+    acpi_arena_free(&arena);
+  qsort(result->latency, result->runs, sizeof(uint64_t), compare_u64);
+  return ret;
+}
+
+static double throughput_mb_s(const BenchResult *result) {
+  uint64_t median = percentile(result, 50);
+  return median ? result->bytes / (median / 1e9) / (1 << 20) : 0.0;
+}
+
+static void print_result(const BenchResult *result) {
+  printf("%-10s %10zu %-7s %10.1f MB/s  p50 %12.3f ms  p99 %12.3f ms  "
+         "rss %8ld KB\n",
+         bench_names[result->bench], result->size,
+         result->position < 0 ? "-" : position_names[result->position],
+         throughput_mb_s(result), percentile(result, 50) / 1e6,
+         percentile(result, 99) / 1e6, result->rssKb);
+}
+
+static int write_json(const char *path, const char *label,
+                      const BenchConfig *config, const BenchResult *results,
+                      size_t count) {
+  FILE *out = fopen(path, "w");
+
+  if (out == NULL)
+    return -EIO;
+  fprintf(out, "{\n  \"tool\": \"acpi_bench\",\n  \"version\": 1,\n");
+  fprintf(out, "  \"label\": \"%s\",\n  \"timestamp\": %lld,\n", label,
+          (long long)time(NULL));
+  fprintf(out, "  \"repeats\": %u,\n  \"results\": [", config->repeats);
+  for (size_t i = 0; i < count; i++) {
+    const BenchResult *r = &results[i];
+    uint64_t sum = 0;
+    for (uint32_t run = 0; run < r->runs; run++)
+      sum += r->latency[run];
+    fprintf(out,
+            "%s\n    {\"benchmark\": \"%s\", \"size\": %zu, "
+            "\"position\": \"%s\", \"bytes\": %zu, \"runs\": %u, "
+            "\"throughput_mb_s\": %.3f, \"latency_ns\": {\"min\": %llu, "
+            "\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"max\": %llu, "
+            "\"mean\": %llu}, \"rss_kb\": %ld, \"max_rss_kb\": %ld}",
+            i ? "," : "", bench_names[r->bench], r->size,
+            r->position < 0 ? "none" : position_names[r->position], r->bytes,
+            r->runs, throughput_mb_s(r),
+            (unsigned long long)r->latency[0],
+            (unsigned long long)percentile(r, 50),
+            (unsigned long long)percentile(r, 90),
+            (unsigned long long)percentile(r, 99),
+            (unsigned long long)r->latency[r->runs - 1],
+            (unsigned long long)(sum / r->runs), r->rssKb, r->maxRssKb);
+  }
+  fprintf(out, "\n  ]\n}\n");
+  return fclose(out) == 0 ? 0 : -EIO;
+}
+
+// Comma separated names to a bit mask, -EINVAL on an unknown name
+static int parse_names(char *list, const char *const *names, int count,
+                       uint32_t *mask) {
+  *mask = 0;
+  for (char *name = strtok(list, ","); name; name = strtok(NULL, ",")) {
+    int i = 0;
+    while (i < count && strcmp(name, names[i]) != 0)
+      i++;
+    if (i == count) {
+      log_err("Unknown name %s", name);
+      return -EINVAL;
+    }
+    *mask |= 1U << i;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  BenchConfig config = {.workDir = "/tmp/acpi_bench", .repeats = 10};
+  char default_sizes[] = "1M,16M,64M";
+  char *size_list = default_sizes;
+  uint32_t benches = (1U << BENCH_COUNT) - 1;
+  uint32_t positions = (1U << POSITION_COUNT) - 1;
+  const char *label = "";
+  const char *out_path = "bench.json";
+  size_t sizes[32];
+  size_t size_count = 0;
+  BenchResult *results;
+  size_t result_count = 0, capacity;
+  int ret = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+      ret = parse_names(argv[++i], bench_names, BENCH_COUNT, &benches);
+    } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+      size_list = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+      ret = parse_names(argv[++i], position_names, POSITION_COUNT,
+                        &positions);
+    } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+      config.repeats = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "-w") == 0) {
+      config.workDir = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-l") == 0) {
+      label = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+      out_path = argv[++i];
+    } else {
+      log_warn("Usage: %s [-b benchmarks] [-s sizes] [-p positions] "
+               "[-r repeats] [-w work_dir] [-l label] [-o out.json]",
+               argv[0]);
+      return -EINVAL;
+    }
+    if (ret < 0)
+      return ret;
+  }
+  for (char *size = strtok(size_list, ","); size; size = strtok(NULL, ",")) {
+    if (size_count == sizeof(sizes) / sizeof(sizes[0]) ||
+        parse_size(size, &sizes[size_count]) < 0) {
+      log_err("Invalid size %s (4K..8G, at most 32 sizes)", size);
+      return -EINVAL;
+    }
+    size_count++;
+  }
+  if (config.repeats < 1 || config.repeats > BENCH_MAX_REPEATS || !benches ||
+      !positions || !size_count) {
+    log_err("Repeats must be 1..%d, with at least one benchmark, position "
+            "and size",
+            BENCH_MAX_REPEATS);
+    return -EINVAL;
+  }
+  if (mkdir(config.workDir, 0755) != 0 && !is_directory(config.workDir)) {
+    log_err("Failed to create %s", config.workDir);
+    return -EIO;
+  }
+
+  capacity = BENCH_COUNT * POSITION_COUNT * size_count;
+  results = calloc(capacity, sizeof(BenchResult));
+  if (results == NULL)
+    return -ENOMEM;
+
+  for (int b = 0; b < BENCH_COUNT && ret == 0; b++) {
+    if (!(benches & (1U << b)))
+      continue;
+    for (size_t s = 0; s < size_count && ret == 0; s++) {
+      bool scan = b == BENCH_SCAN || b == BENCH_QCOM_SCAN;
+      if (b == BENCH_WALK && sizes[s] > BENCH_MAX_WALK_SIZE) {
+        log_warn("walk: %zu bytes is above the %lu bytes PPTT limit, skipped",
+                 sizes[s], BENCH_MAX_WALK_SIZE);
+        continue;
+      }
+      for (int p = 0; p < POSITION_COUNT && ret == 0; p++) {
+        BenchResult *result = &results[result_count];
+        if (scan ? !(positions & (1U << p)) : p > 0)
+          continue;
+        result->bench = b;
+        result->size = sizes[s];
+        result->position = scan ? p : -1;
+        ret = run_case(&config, result);
+        if (ret == 0) {
+          print_result(result);
+          result_count++;
+        }
+      }
+    }
+  }
+
+  if (ret == 0 && result_count) {
+    ret = write_json(out_path, label, &config, results, result_count);
+    if (ret < 0)
+      log_err("Failed to write %s", out_path);
+    else
+      log_info("%zu result(s) written to %s", result_count, out_path);
+  }
+  free(results);
+  return ret;
+}
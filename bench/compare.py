@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""
+Compare two acpi_bench result files
+
+Cases are matched by (benchmark, size, position). Prints the median
+latency of both runs, the speedup (old / new) and the resident set size
+change. Returns 1 if a case is slower than --threshold.
+
+Usage: compare.py <old.json> <new.json> [--threshold 1.10]
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    cases = {(r['benchmark'], r['size'], r['position']): r for r in data['results']}
+    return data.get('label') or path, cases
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two acpi_bench result files")
+    parser.add_argument('old')
+    parser.add_argument('new')
+    parser.add_argument('--threshold', type=float, default=1.10,
+                        help="fail if new p50 > old p50 * threshold (default: 1.10)")
+    args = parser.parse_args()
+
+    old_label, old = load(args.old)
+    new_label, new = load(args.new)
+    print(f"old: {old_label}\nnew: {new_label}\n")
+    print(f"{'Benchmark':<10} {'Size':>11} {'Position':<8} {'Old p50 ms':>11} {'New p50 ms':>11} "
+          f"{'Speedup':>8} {'RSS KB':>9}")
+
+    regressions = 0
+    for key in sorted(set(old) & set(new)):
+        o, n = old[key], new[key]
+        old_p50, new_p50 = o['latency_ns']['p50'], n['latency_ns']['p50']
+        speedup = old_p50 / new_p50 if new_p50 else float('inf')
+        slower = new_p50 > old_p50 * args.threshold
+        regressions += slower
+        print(f"{key[0]:<10} {key[1]:>11} {key[2]:<8} {old_p50 / 1e6:>11.3f} {new_p50 / 1e6:>11.3f} "
+              f"{speedup:>7.2f}x {n['rss_kb'] - o['rss_kb']:>+9}{'  SLOWER' if slower else ''}")
+
+    for key in sorted(set(old) ^ set(new)):
+        print(f"{key[0]:<10} {key[1]:>11} {key[2]:<8} only in {'old' if key in old else 'new'}")
+
+    if regressions:
+        print(f"\n{regressions} case(s) slower than {args.threshold:.2f}x")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
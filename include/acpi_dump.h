@@ -0,0 +1,28 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** Native disassembler for the tables this generator builds
+
+  Output follows the data table format of "iasl -d": one line per field as
+
+    [HexOffset DecimalOffset ByteLength] FieldName : FieldValue (in hex)
+
+  with the same field names, widths, flag decoding and subtable layout, so
+  scripts parsing iasl DSL can read it unchanged. Tables without a field
+  layout here are dumped as header plus raw bytes.
+*/
+
+bool acpi_dump_supported(const char *signature);
+int acpi_dump_table(FILE *out, const uint8_t *table, size_t size,
+                    const char *file_name);
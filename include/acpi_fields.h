@@ -0,0 +1,369 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+/** Member lists of the table structures
+
+  Every structure both lib/acpi_layout.c and the layout manifest
+  (src/layout/) describe has one list here, in member order:
+
+    #define <TYPE>_FIELDS(X, type, ...) X(kind, member, type, __VA_ARGS__) ...
+
+  kind is UINT, CHARS or BYTES for scalars and arrays, GAS or ACPI_GAS for
+  a Generic Address Structure member (ACPI_GENERIC_ADDRESS_STRUCTURE or the
+  DBG2 ACPI_GAS) and RECORD_HEADER for a FPDT_PERFORMANCE_RECORD_HEADER
+  member. The arguments after type are passed to X as they are, the
+  descriptor tables use them for the base offset and name prefix.
+
+  Members that depend on the table revision or on the platform follow the
+  table headers, so include this file after them.
+*/
+
+/* Shared types, include/acpi.h and include/common/fpdt.h */
+#define ACPI_TABLE_HEADER_FIELDS(X, type, ...)                                 \
+  X(CHARS, Signature, type, __VA_ARGS__)                                       \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Revision, type, __VA_ARGS__)                                         \
+  X(UINT, Checksum, type, __VA_ARGS__)                                         \
+  X(CHARS, OemId, type, __VA_ARGS__)                                           \
+  X(CHARS, OemTableId, type, __VA_ARGS__)                                      \
+  X(UINT, OemRevision, type, __VA_ARGS__)                                      \
+  X(CHARS, CreatorId, type, __VA_ARGS__)                                       \
+  X(UINT, CreatorRevision, type, __VA_ARGS__)
+
+#define ACPI_GENERIC_ADDRESS_STRUCTURE_FIELDS(X, type, ...)                    \
+  X(UINT, AddressSpaceId, type, __VA_ARGS__)                                   \
+  X(UINT, RegisterBitWidth, type, __VA_ARGS__)                                 \
+  X(UINT, RegisterBitOffset, type, __VA_ARGS__)                                \
+  X(UINT, AccessSize, type, __VA_ARGS__)                                       \
+  X(UINT, Address, type, __VA_ARGS__)
+
+#define FPDT_PERFORMANCE_RECORD_HEADER_FIELDS(X, type, ...)                    \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Revision, type, __VA_ARGS__)
+
+/* MADT */
+#define MADT_HEADER_EXTRA_DATA_FIELDS(X, type, ...)                            \
+  X(UINT, LocalInterruptControllerAddress, type, __VA_ARGS__)                  \
+  X(UINT, Flags, type, __VA_ARGS__)
+
+#ifdef GICC_HAS_TRBE_INTERRUPT
+#define MADT_GICC_TRBE_FIELDS(X, type, ...)                                    \
+  X(UINT, TRBEInterrupt, type, __VA_ARGS__)
+#else
+#define MADT_GICC_TRBE_FIELDS(X, type, ...)
+#endif
+
+#define MADT_GICC_STRUCTURE_FIELDS(X, type, ...)                               \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, CPUInterfaceNumber, type, __VA_ARGS__)                               \
+  X(UINT, ACPIProcessorUID, type, __VA_ARGS__)                                 \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, ParkingProtocolVersion, type, __VA_ARGS__)                           \
+  X(UINT, PerformanceInterruptGSI, type, __VA_ARGS__)                          \
+  X(UINT, ParkedAddress, type, __VA_ARGS__)                                    \
+  X(UINT, PhysicalBaseAddress, type, __VA_ARGS__)                              \
+  X(UINT, GICV, type, __VA_ARGS__)                                             \
+  X(UINT, GICH, type, __VA_ARGS__)                                             \
+  X(UINT, VGICMaintenanceInterrupt, type, __VA_ARGS__)                         \
+  X(UINT, GICRBaseAddress, type, __VA_ARGS__)                                  \
+  X(UINT, MPIDR, type, __VA_ARGS__)                                            \
+  X(UINT, ProcessorPowerEfficiencyClass, type, __VA_ARGS__)                    \
+  X(UINT, Reserved2, type, __VA_ARGS__)                                        \
+  X(UINT, SpeOverflowInterrupt, type, __VA_ARGS__)                             \
+  MADT_GICC_TRBE_FIELDS(X, type, __VA_ARGS__)
+
+#define MADT_GICD_STRUCTURE_FIELDS(X, type, ...)                               \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, GICID, type, __VA_ARGS__)                                            \
+  X(UINT, PhysicalBaseAddress, type, __VA_ARGS__)                              \
+  X(UINT, SystemVectorBase, type, __VA_ARGS__)                                 \
+  X(UINT, GICVersion, type, __VA_ARGS__)                                       \
+  X(BYTES, Reserved2, type, __VA_ARGS__)
+
+#define MADT_GIC_MSI_FRAME_STRUCTURE_FIELDS(X, type, ...)                      \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, GICMSRFrameID, type, __VA_ARGS__)                                    \
+  X(UINT, PhysicalBaseAddress, type, __VA_ARGS__)                              \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, SPICount, type, __VA_ARGS__)                                         \
+  X(UINT, SPIBase, type, __VA_ARGS__)
+
+#define MADT_GICR_STRUCTURE_FIELDS(X, type, ...)                               \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, DiscoveryRangeBaseAddress, type, __VA_ARGS__)                        \
+  X(UINT, DiscoveryRangeLength, type, __VA_ARGS__)
+
+#define MADT_GIC_ITS_STRUCTURE_FIELDS(X, type, ...)                            \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, GICITSID, type, __VA_ARGS__)                                         \
+  X(UINT, PhysicalBaseAddress, type, __VA_ARGS__)                              \
+  X(UINT, Reserved2, type, __VA_ARGS__)
+
+/* PPTT */
+#define ACPI_PPTT_PROCESSOR_HIERARCHY_NODE_FIELDS(X, type, ...)                \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, Parent, type, __VA_ARGS__)                                           \
+  X(UINT, AcpiProcessorId, type, __VA_ARGS__)                                  \
+  X(UINT, NumberOfPrivateResources, type, __VA_ARGS__)
+
+#if ACPI_PPTT_REVISION == 3
+#define ACPI_PPTT_CACHE_ID_FIELDS(X, type, ...)                                \
+  X(UINT, CacheId, type, __VA_ARGS__)
+#else
+#define ACPI_PPTT_CACHE_ID_FIELDS(X, type, ...)
+#endif
+
+#define ACPI_PPTT_CACHE_TYPE_STRUCTURE_FIELDS(X, type, ...)                    \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, NextLevelOfCache, type, __VA_ARGS__)                                 \
+  X(UINT, Size, type, __VA_ARGS__)                                             \
+  X(UINT, NumberOfSets, type, __VA_ARGS__)                                     \
+  X(UINT, Associativity, type, __VA_ARGS__)                                    \
+  X(UINT, Attributes, type, __VA_ARGS__)                                       \
+  X(UINT, LineSize, type, __VA_ARGS__)                                         \
+  ACPI_PPTT_CACHE_ID_FIELDS(X, type, __VA_ARGS__)
+
+#define ACPI_PPTT_ID_FIELDS(X, type, ...)                                      \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, VendorId, type, __VA_ARGS__)                                         \
+  X(UINT, Level1Id, type, __VA_ARGS__)                                         \
+  X(UINT, Level2Id, type, __VA_ARGS__)                                         \
+  X(UINT, MajorRevision, type, __VA_ARGS__)                                    \
+  X(UINT, MinorRevision, type, __VA_ARGS__)                                    \
+  X(UINT, SpinRevision, type, __VA_ARGS__)
+
+/* GTDT */
+#if ACPI_GTDT_REVISION >= 3
+#define GTDT_EL2_VIRTUAL_TIMER_FIELDS(X, type, ...)                            \
+  X(UINT, VirtualEL2TimerGSI, type, __VA_ARGS__)                               \
+  X(UINT, VirtualEL2TimerFlags, type, __VA_ARGS__)
+#else
+#define GTDT_EL2_VIRTUAL_TIMER_FIELDS(X, type, ...)
+#endif
+
+#define GTDT_HEADER_EXTRA_DATA_FIELDS(X, type, ...)                            \
+  X(UINT, CntControlBasePhyAddress, type, __VA_ARGS__)                         \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, SecureEL1TimerGSI, type, __VA_ARGS__)                                \
+  X(UINT, SecureEL1TimerFlags, type, __VA_ARGS__)                              \
+  X(UINT, NSEL1TimerGSI, type, __VA_ARGS__)                                    \
+  X(UINT, NSEL1TimerFlags, type, __VA_ARGS__)                                  \
+  X(UINT, VirtualEL1TimerGSI, type, __VA_ARGS__)                               \
+  X(UINT, VirtualEL1TimerFlags, type, __VA_ARGS__)                             \
+  X(UINT, EL2TimerGSI, type, __VA_ARGS__)                                      \
+  X(UINT, EL2TimerFlags, type, __VA_ARGS__)                                    \
+  X(UINT, CntReadBasePhyAddress, type, __VA_ARGS__)                            \
+  X(UINT, PlatformTimerCount, type, __VA_ARGS__)                               \
+  X(UINT, PlatformTimerOffset, type, __VA_ARGS__)                              \
+  GTDT_EL2_VIRTUAL_TIMER_FIELDS(X, type, __VA_ARGS__)
+
+#define ACPI_GTDT_GENERIC_WDT_STRUCTURE_FIELDS(X, type, ...)                   \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, RefreshFramePhysicalAddress, type, __VA_ARGS__)                      \
+  X(UINT, WatchdogControlFramePhysicalAddress, type, __VA_ARGS__)              \
+  X(UINT, WatchdogTimerGSI, type, __VA_ARGS__)                                 \
+  X(UINT, WatchdogTimerFlags, type, __VA_ARGS__)
+
+/* DBG2 */
+#define ACPI_GAS_FIELDS(X, type, ...)                                          \
+  X(UINT, AddressSpaceID, type, __VA_ARGS__)                                   \
+  X(UINT, RegisterBitWidth, type, __VA_ARGS__)                                 \
+  X(UINT, RegisterBitOffset, type, __VA_ARGS__)                                \
+  X(UINT, AccessSize, type, __VA_ARGS__)                                       \
+  X(UINT, Address, type, __VA_ARGS__)
+
+#define DBG2_HEADER_EXTRA_DATA_FIELDS(X, type, ...)                            \
+  X(UINT, OffsetDbgDeviceInfo, type, __VA_ARGS__)                              \
+  X(UINT, NumberOfDbgDevices, type, __VA_ARGS__)
+
+/* SPCR */
+#if ACPI_SPCR_REVISION == 4
+#define SPCR_REVISION_FIELDS(X, type, ...)                                     \
+  X(UINT, UARTClockFrequency, type, __VA_ARGS__)                               \
+  X(UINT, PreciseBaudRate, type, __VA_ARGS__)                                  \
+  X(UINT, NameSpaceStringLength, type, __VA_ARGS__)                            \
+  X(UINT, NameSpaceStringOffset, type, __VA_ARGS__)
+#elif ACPI_SPCR_REVISION == 2
+#define SPCR_REVISION_FIELDS(X, type, ...)                                     \
+  X(BYTES, Reserved2, type, __VA_ARGS__)
+#else
+#define SPCR_REVISION_FIELDS(X, type, ...)
+#endif
+
+#define SPCR_HEADER_EXTRA_DATA_FIELDS(X, type, ...)                            \
+  X(UINT, InterfaceType, type, __VA_ARGS__)                                    \
+  X(BYTES, Reserved, type, __VA_ARGS__)                                        \
+  X(ACPI_GAS, BaseAddress, type, __VA_ARGS__)                                  \
+  X(UINT, InterruptType, type, __VA_ARGS__)                                    \
+  X(UINT, Irq, type, __VA_ARGS__)                                              \
+  X(UINT, GlobalSystemInterrupt, type, __VA_ARGS__)                            \
+  X(UINT, ConfiguredBaudRate, type, __VA_ARGS__)                               \
+  X(UINT, Parity, type, __VA_ARGS__)                                           \
+  X(UINT, StopBits, type, __VA_ARGS__)                                         \
+  X(UINT, FlowControl, type, __VA_ARGS__)                                      \
+  X(UINT, TerminalType, type, __VA_ARGS__)                                     \
+  X(UINT, Language, type, __VA_ARGS__)                                         \
+  X(UINT, PciDeviceId, type, __VA_ARGS__)                                      \
+  X(UINT, PciVendorId, type, __VA_ARGS__)                                      \
+  X(UINT, PciBusNumber, type, __VA_ARGS__)                                     \
+  X(UINT, PciDeviceNumber, type, __VA_ARGS__)                                  \
+  X(UINT, PciFunctionNumber, type, __VA_ARGS__)                                \
+  X(UINT, PciFlags, type, __VA_ARGS__)                                         \
+  X(UINT, PciSegment, type, __VA_ARGS__)                                       \
+  SPCR_REVISION_FIELDS(X, type, __VA_ARGS__)
+
+/* FACP */
+#define FACP_DATA_STRUCTURE_FIELDS(X, type, ...)                               \
+  X(UINT, FIRMWARE_CTRL, type, __VA_ARGS__)                                    \
+  X(UINT, DSDT, type, __VA_ARGS__)                                             \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, Preferred_PM_Profile, type, __VA_ARGS__)                             \
+  X(UINT, SCI_INT, type, __VA_ARGS__)                                          \
+  X(UINT, SMI_CMD, type, __VA_ARGS__)                                          \
+  X(UINT, ACPI_ENABLE, type, __VA_ARGS__)                                      \
+  X(UINT, ACPI_DISABLE, type, __VA_ARGS__)                                     \
+  X(UINT, S4BIOS_REQ, type, __VA_ARGS__)                                       \
+  X(UINT, PSTATE_CNT, type, __VA_ARGS__)                                       \
+  X(UINT, PM1a_EVT_BLK, type, __VA_ARGS__)                                     \
+  X(UINT, PM1b_EVT_BLK, type, __VA_ARGS__)                                     \
+  X(UINT, PM1a_CNT_BLK, type, __VA_ARGS__)                                     \
+  X(UINT, PM1b_CNT_BLK, type, __VA_ARGS__)                                     \
+  X(UINT, PM2_CNT_BLK, type, __VA_ARGS__)                                      \
+  X(UINT, PM_TMR_BLK, type, __VA_ARGS__)                                       \
+  X(UINT, GPE0_BLK, type, __VA_ARGS__)                                         \
+  X(UINT, GPE1_BLK, type, __VA_ARGS__)                                         \
+  X(UINT, PM1_EVT_LEN, type, __VA_ARGS__)                                      \
+  X(UINT, PM1_CNT_LEN, type, __VA_ARGS__)                                      \
+  X(UINT, PM2_CNT_LEN, type, __VA_ARGS__)                                      \
+  X(UINT, PM_TMR_LEN, type, __VA_ARGS__)                                       \
+  X(UINT, GPE0_BLK_LEN, type, __VA_ARGS__)                                     \
+  X(UINT, GPE1_BLK_LEN, type, __VA_ARGS__)                                     \
+  X(UINT, GPE1_BASE, type, __VA_ARGS__)                                        \
+  X(UINT, CST_CNT, type, __VA_ARGS__)                                          \
+  X(UINT, P_LVL2_LAT, type, __VA_ARGS__)                                       \
+  X(UINT, P_LVL3_LAT, type, __VA_ARGS__)                                       \
+  X(UINT, FLUSH_SIZE, type, __VA_ARGS__)                                       \
+  X(UINT, FLUSH_STRIDE, type, __VA_ARGS__)                                     \
+  X(UINT, DUTY_OFFSET, type, __VA_ARGS__)                                      \
+  X(UINT, DUTY_WIDTH, type, __VA_ARGS__)                                       \
+  X(UINT, DAY_ALRM, type, __VA_ARGS__)                                         \
+  X(UINT, MON_ALRM, type, __VA_ARGS__)                                         \
+  X(UINT, CENTURY, type, __VA_ARGS__)                                          \
+  X(UINT, IAPC_BOOT_ARCH, type, __VA_ARGS__)                                   \
+  X(UINT, Reserved2, type, __VA_ARGS__)                                        \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(GAS, ResetReg, type, __VA_ARGS__)                                          \
+  X(UINT, ResetValue, type, __VA_ARGS__)                                       \
+  X(UINT, ARM_BOOT_ARCH, type, __VA_ARGS__)                                    \
+  X(UINT, MinorRevision, type, __VA_ARGS__)                                    \
+  X(UINT, X_FIRMWARE_CTRL, type, __VA_ARGS__)                                  \
+  X(UINT, X_DSDT, type, __VA_ARGS__)                                           \
+  X(GAS, X_PM1a_EVT_BLK, type, __VA_ARGS__)                                    \
+  X(GAS, X_PM1b_EVT_BLK, type, __VA_ARGS__)                                    \
+  X(GAS, X_PM1a_CNT_BLK, type, __VA_ARGS__)                                    \
+  X(GAS, X_PM1b_CNT_BLK, type, __VA_ARGS__)                                    \
+  X(GAS, X_PM2_CNT_BLK, type, __VA_ARGS__)                                     \
+  X(GAS, X_PM_TMR_BLK, type, __VA_ARGS__)                                      \
+  X(GAS, X_GPE0_BLK, type, __VA_ARGS__)                                        \
+  X(GAS, X_GPE1_BLK, type, __VA_ARGS__)                                        \
+  X(GAS, SLEEP_CONTROL_REG, type, __VA_ARGS__)                                 \
+  X(GAS, SLEEP_STATUS_REG, type, __VA_ARGS__)                                  \
+  X(UINT, HypervisorVendorIdentity, type, __VA_ARGS__)
+
+/* FACS */
+#define ACPI_FACS_TABLE_FIELDS(X, type, ...)                                   \
+  X(CHARS, Signature, type, __VA_ARGS__)                                       \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, HardwareSignature, type, __VA_ARGS__)                                \
+  X(UINT, FirmwareWakingVector, type, __VA_ARGS__)                             \
+  X(UINT, GlobalLock, type, __VA_ARGS__)                                       \
+  X(UINT, Flags, type, __VA_ARGS__)                                            \
+  X(UINT, X_FirmwareWakingVector, type, __VA_ARGS__)                           \
+  X(UINT, Version, type, __VA_ARGS__)                                          \
+  X(BYTES, Reserved, type, __VA_ARGS__)                                        \
+  X(UINT, OSPMFlags, type, __VA_ARGS__)                                        \
+  X(BYTES, Reserved1, type, __VA_ARGS__)
+
+/* FPDT and FBPT */
+#define FPDT_FBPT_POINTER_RECORD_FIELDS(X, type, ...)                          \
+  X(RECORD_HEADER, Header, type, __VA_ARGS__)                                  \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, FBPTPointer, type, __VA_ARGS__)
+
+#define FBPT_HEADER_FIELDS(X, type, ...)                                       \
+  X(CHARS, Signature, type, __VA_ARGS__)                                       \
+  X(UINT, Length, type, __VA_ARGS__)
+
+#define FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD_FIELDS(X, type, ...)           \
+  X(RECORD_HEADER, Header, type, __VA_ARGS__)                                  \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, ResetEnd, type, __VA_ARGS__)                                         \
+  X(UINT, OsLoaderLoadImageStart, type, __VA_ARGS__)                           \
+  X(UINT, OsLoaderStartImageStart, type, __VA_ARGS__)                          \
+  X(UINT, ExitBootServicesEntry, type, __VA_ARGS__)                            \
+  X(UINT, ExitBootServicesExit, type, __VA_ARGS__)
+
+/* MCFG */
+#define MCFG_HEADER_EXTRA_DATA_FIELDS(X, type, ...)                            \
+  X(UINT, Reserved, type, __VA_ARGS__)
+
+#define MCFG_MEM_MAP_EC_SPACE_STRUCTURE_FIELDS(X, type, ...)                   \
+  X(UINT, BaseAddress, type, __VA_ARGS__)                                      \
+  X(UINT, PCISegmentGroupNumber, type, __VA_ARGS__)                            \
+  X(UINT, StartBusNumber, type, __VA_ARGS__)                                   \
+  X(UINT, EndBusNumber, type, __VA_ARGS__)                                     \
+  X(UINT, Reserved, type, __VA_ARGS__)
+
+/* CSRT */
+#define CSRT_RESOURCE_GROUPS_HEADER_FORMAT_FIELDS(X, type, ...)                \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, VendorId, type, __VA_ARGS__)                                         \
+  X(UINT, SubVendorId, type, __VA_ARGS__)                                      \
+  X(UINT, DeviceId, type, __VA_ARGS__)                                         \
+  X(UINT, SubDeviceId, type, __VA_ARGS__)                                      \
+  X(UINT, Revision, type, __VA_ARGS__)                                         \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, SharedInfoLength, type, __VA_ARGS__)
+
+/* IORT */
+#define IORT_HEADER_EXTRA_DATA_FIELDS(X, type, ...)                            \
+  X(UINT, NumOfNodes, type, __VA_ARGS__)                                       \
+  X(UINT, OffsetToNodeArray, type, __VA_ARGS__)                                \
+  X(UINT, Reserved, type, __VA_ARGS__)
+
+#define IORT_NODE_FORMAT_FIELDS(X, type, ...)                                  \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Revision, type, __VA_ARGS__)                                         \
+  X(UINT, Identifier, type, __VA_ARGS__)                                       \
+  X(UINT, NumOfIDMappings, type, __VA_ARGS__)                                  \
+  X(UINT, ReferenceToIdArray, type, __VA_ARGS__)
@@ -0,0 +1,100 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Binary layout descriptors of the tables this generator knows about
+
+  Offsets are taken with offsetof() on the structures in include/common, so
+  descriptors always match the tables built from the same headers.
+
+  A table is described by its fixed part (header + header extra data) and an
+  optional stream of subtables (MADT interrupt controllers, PPTT nodes, ...).
+  Tools walk the stream with acpi_layout_walk() and resolve fields by name
+  instead of hard coding offsets.
+*/
+
+enum ACPI_FIELD_KIND {
+  ACPI_FIELD_UINT = 0,  // Little endian integer of 1, 2, 4 or 8 bytes
+  ACPI_FIELD_CHARS = 1, // Fixed size character array, e.g. OemId
+  ACPI_FIELD_BYTES = 2, // Raw bytes, e.g. reserved arrays
+};
+
+typedef struct {
+  const char *name; // e.g. "Flags", "BaseAddress.Address"
+  uint32_t offset;  // From structure start (table start for fixed part)
+  uint32_t size;
+  uint8_t kind; // enum ACPI_FIELD_KIND
+} AcpiFieldDescriptor;
+
+#define ACPI_LAYOUT_ANY_TYPE -1
+
+typedef struct {
+  const char *name; // e.g. "GICC", "PROCESSOR"
+  int32_t type;     // Subtable type value or ACPI_LAYOUT_ANY_TYPE
+  const AcpiFieldDescriptor *fields;
+  size_t fieldCount;
+} AcpiStructureLayout;
+
+#define ACPI_LAYOUT_NO_FIELD -1
+
+typedef struct {
+  char signature[4];
+  bool hasHeader; // Standard ACPI_TABLE_HEADER, false for FACS/FBPT
+  const AcpiFieldDescriptor *fields; // Fixed part after the header
+  size_t fieldCount;
+
+  /* Subtable stream, structureCount == 0 if the table has none */
+  uint32_t subtableStart;      // Offset of the first subtable
+  int32_t subtableStartField;  // UINT32 field holding the start, or NO_FIELD
+  int32_t subtableCountField;  // UINT32 field holding the count, or NO_FIELD
+  int32_t typeOffset;          // UINT8 type offset, or NO_FIELD if untyped
+  uint32_t lengthOffset;       // Length field offset inside subtable
+  uint32_t lengthSize;         // Length field size, 0 for fixed size entries
+  uint32_t fixedLength;        // Entry size when lengthSize is 0
+  const AcpiStructureLayout *structures;
+  size_t structureCount;
+} AcpiTableLayout;
+
+//
+// One subtable found while walking a table.
+//
+typedef struct {
+  const AcpiStructureLayout *layout; // NULL if type is unknown
+  uint32_t offset;                   // From table start
+  uint32_t length;
+  int32_t type;   // ACPI_LAYOUT_ANY_TYPE for untyped streams
+  uint32_t index; // Position among subtables with the same layout
+} AcpiSubtable;
+
+// Return 0 to continue, >0 to stop walking, <0 to abort with an error
+typedef int (*AcpiSubtableCallback)(const uint8_t *table,
+                                    const AcpiSubtable *subtable,
+                                    void *context);
+
+extern const AcpiFieldDescriptor acpi_header_fields[];
+extern const size_t acpi_header_field_count;
+
+const AcpiTableLayout *acpi_layout_find(const char *signature);
+const AcpiTableLayout *acpi_layout_get(size_t index);
+const AcpiStructureLayout *
+acpi_layout_find_structure(const AcpiTableLayout *layout, const char *name);
+const AcpiFieldDescriptor *acpi_layout_find_field(
+    const AcpiFieldDescriptor *fields, size_t count, const char *name);
+const AcpiFieldDescriptor *
+acpi_layout_find_table_field(const AcpiTableLayout *layout, const char *name);
+int acpi_layout_walk(const uint8_t *table, size_t length,
+                     const AcpiTableLayout *layout,
+                     AcpiSubtableCallback callback, void *context);
+uint64_t acpi_field_read(const uint8_t *base, const AcpiFieldDescriptor *field);
+void acpi_field_write(uint8_t *base, const AcpiFieldDescriptor *field,
+                      uint64_t value);
+bool acpi_field_fits(const AcpiFieldDescriptor *field, uint64_t value);
@@ -0,0 +1,139 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include "fdt.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** CPU topology as Linux derives it from MADT and PPTT
+
+  acpi_topology_simulate() follows the arm64 kernel step by step:
+
+  - Logical CPUs: MADT GICCs that are enabled or online capable, with a
+    valid and unique MPIDR, in table order. The first one is taken as the
+    boot CPU (logical CPU 0), as on a boot from the first GICC.
+  - IDs (drivers/acpi/pptt.c, parse_acpi_topology()): the PPTT leaf with
+    the GICC UID as ACPI processor ID, thread/core from the leaf and its
+    parent, cluster from the parent (grandparent for threads), package
+    from the first node up with the physical package flag. A node ID is
+    its ACPI processor ID if valid, else its table offset. Threads are
+    told by the PPTT leaf flag from revision 2, by the boot CPU MPIDR MT
+    bit before. If any CPU has no leaf, Linux drops the whole PPTT
+    topology: every CPU is its own core in package 0.
+  - Cache leaves (cacheinfo): as many levels as the private resources of
+    the leaf and its ancestors reach, split in data and instruction up to
+    the last level that has a split cache. Each leaf is looked up by
+    level and type from the leaf up. Two CPUs share a leaf if both have a
+    valid PPTT cache ID and they are equal, else if the cache was found
+    through the same processor node.
+  - Masks (drivers/base/arch_topology.c update_siblings_masks(),
+    cpu_coregroup_mask(), cpu_clustergroup_mask()) with a single NUMA
+    node and CONFIG_SCHED_CLUSTER.
+
+  Capacity needs _CPC, which these tables do not have: Linux gives every
+  CPU the same capacity. The MADT GICC processor power efficiency class
+  is reported instead, it is what tells the capacity classes apart here.
+
+  acpi_topology_from_dtb() reads the topology Linux takes from a device
+  tree cpu-map (parse_dt_topology()) and the next-level-cache chains, and
+  acpi_topology_diff() compares the two. acpi_topology_compare() checks that
+  two PPTTs give the same topology with the same MADT.
+*/
+
+enum ACPI_TOPOLOGY_MASK {
+  ACPI_TOPOLOGY_THREAD_SIBLINGS = 0, // topology/thread_siblings
+  ACPI_TOPOLOGY_CORE_SIBLINGS,       // topology/core_siblings (package)
+  ACPI_TOPOLOGY_CLUSTER_CPUS,        // topology/cluster_cpus
+  ACPI_TOPOLOGY_LLC_SIBLINGS,        // CPUs sharing the last level cache
+  ACPI_TOPOLOGY_COREGROUP,           // MC scheduler domain
+  ACPI_TOPOLOGY_CLUSTERGROUP,        // CLS scheduler domain
+  ACPI_TOPOLOGY_MASK_COUNT,
+};
+
+enum ACPI_TOPOLOGY_CACHE_TYPE {
+  ACPI_TOPOLOGY_CACHE_DATA = 0,
+  ACPI_TOPOLOGY_CACHE_INSTRUCTION,
+  ACPI_TOPOLOGY_CACHE_UNIFIED,
+};
+
+// Cache leaves of a CPU: 7 levels, split at most
+#define ACPI_TOPOLOGY_MAX_CACHE_LEAVES 14
+#define ACPI_TOPOLOGY_MESSAGE_SIZE 160
+#define ACPI_TOPOLOGY_NO_ID INT64_MIN // -ENOENT in the kernel
+
+typedef struct {
+  uint8_t level;
+  uint8_t type;     // enum ACPI_TOPOLOGY_CACHE_TYPE
+  uint32_t offset;  // PPTT cache structure, 0 if no cache matches
+  uint32_t token;   // Processor node the cache was found through
+  bool hasCacheId;  // PPTT revision 3 cache ID is valid
+  uint32_t cacheId;
+  uint32_t size;
+  uint32_t sets;
+  uint8_t ways;
+  uint16_t lineSize;
+} AcpiTopologyCache;
+
+typedef struct {
+  uint32_t uid;   // GICC ACPI processor UID, PPTT leaf ID without MADT
+  uint64_t mpidr; // 0 without MADT
+  uint8_t efficiencyClass;
+  uint32_t leaf; // PPTT leaf node offset, 0 if none
+  int64_t threadId; // -1 if not threaded
+  int64_t coreId;
+  int64_t clusterId;
+  int64_t packageId;
+  uint32_t cacheLevels;
+  uint32_t splitLevels;
+  uint32_t leafCount;
+  AcpiTopologyCache caches[ACPI_TOPOLOGY_MAX_CACHE_LEAVES];
+} AcpiTopologyCpu;
+
+typedef struct {
+  char message[ACPI_TOPOLOGY_MESSAGE_SIZE];
+} AcpiTopologyNote;
+
+typedef struct {
+  uint32_t cpuCount;
+  uint32_t words; // uint64_t per CPU mask
+  AcpiTopologyCpu *cpus;
+  uint64_t *masks;      // cpuCount x ACPI_TOPOLOGY_MASK_COUNT masks
+  uint64_t *cacheMasks; // cpuCount x ACPI_TOPOLOGY_MAX_CACHE_LEAVES masks
+  bool hasMpidr;  // From the MADT or the DTB cpu reg
+  bool hasCaches; // Cache masks are meaningful (PPTT, or DTB chains)
+  uint8_t ppttRevision;
+  AcpiTopologyNote *notes; // What the kernel would warn about
+  size_t noteCount;
+  size_t noteCapacity;
+} AcpiTopology;
+
+typedef void (*AcpiTopologyDiffCallback)(const char *message, void *context);
+
+extern const char *const acpi_topology_mask_names[ACPI_TOPOLOGY_MASK_COUNT];
+extern const char *const acpi_topology_cache_type_names[];
+
+int acpi_topology_simulate(const uint8_t *pptt, size_t ppttSize,
+                           const uint8_t *madt, size_t madtSize,
+                           AcpiTopology *topology);
+int acpi_topology_from_dtb(const FdtTree *tree, AcpiTopology *topology);
+size_t acpi_topology_diff(const AcpiTopology *actual,
+                          const AcpiTopology *expected,
+                          AcpiTopologyDiffCallback callback, void *context);
+size_t acpi_topology_compare(const AcpiTopology *before,
+                             const AcpiTopology *after,
+                             AcpiTopologyDiffCallback callback, void *context);
+const uint64_t *acpi_topology_mask(const AcpiTopology *topology, uint32_t cpu,
+                                   enum ACPI_TOPOLOGY_MASK mask);
+const uint64_t *acpi_topology_cache_mask(const AcpiTopology *topology,
+                                         uint32_t cpu, uint32_t leaf);
+size_t acpi_topology_format_list(const AcpiTopology *topology,
+                                 const uint64_t *mask, char *buffer,
+                                 size_t size);
+void acpi_topology_free(AcpiTopology *topology);
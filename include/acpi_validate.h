@@ -0,0 +1,54 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Native checks run on built tables
+
+  Every table goes through the same fixed list of checks. Subtables are
+  walked with acpi_layout_walk(), so only tables described in
+  lib/acpi_layout.c get the subtable and reference checks, the others report
+  them as skipped.
+*/
+
+enum ACPI_CHECK {
+  ACPI_CHECK_SIGNATURE = 0, // Signature matches the file name
+  ACPI_CHECK_LENGTH,        // Header length matches the file size
+  ACPI_CHECK_CHECKSUM,      // Byte sum is zero (tables with a checksum)
+  ACPI_CHECK_SUBTABLES,     // Subtable types and lengths inside the table
+  ACPI_CHECK_REFERENCES,    // PPTT/IORT offsets point to valid nodes
+  ACPI_CHECK_COUNT,
+};
+
+enum ACPI_CHECK_STATUS {
+  ACPI_CHECK_PASS = 0,
+  ACPI_CHECK_SKIP = 1,
+  ACPI_CHECK_WARN = 2,
+  ACPI_CHECK_FAIL = 3,
+};
+
+#define ACPI_VALIDATE_MESSAGE_SIZE 160
+
+typedef struct {
+  uint8_t status[ACPI_CHECK_COUNT]; // enum ACPI_CHECK_STATUS
+  // First problem found by each check, empty when it passed
+  char message[ACPI_CHECK_COUNT][ACPI_VALIDATE_MESSAGE_SIZE];
+  uint32_t subtableCount;
+  uint32_t referenceCount;
+} AcpiValidation;
+
+extern const char *const acpi_check_names[ACPI_CHECK_COUNT];
+extern const char *const acpi_check_status_names[];
+
+void acpi_validate_table(const uint8_t *table, size_t size,
+                         const char *expected_signature,
+                         AcpiValidation *result);
+bool acpi_validation_failed(const AcpiValidation *result);
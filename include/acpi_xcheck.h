@@ -0,0 +1,78 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include "acpi_validate.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Cross-table checks of one device
+
+  acpi_validate_table() looks at one table at a time. These checks look at
+  the relations between the tables of a device: every table is added once
+  to an AcpiTableSet, acpi_xcheck_run() walks each of them once into
+  indexes (GICC by ACPI processor UID, PPTT leaf by ACPI processor ID, GSI
+  to the interrupt sources that use it) and checks the relations against
+  those indexes, so the cost is linear in the number of subtables.
+
+  A check whose tables the device does not have is skipped. Every
+  violation gets its own diagnostic.
+*/
+
+enum ACPI_XCHECK {
+  ACPI_XCHECK_CPU_UID = 0, // GICC ACPIProcessorUID vs PPTT leaf processor IDs
+  ACPI_XCHECK_TIMER_GSI,   // GTDT GSIs vs MADT GIC version and PPI/SPI range
+  ACPI_XCHECK_GSI_OWNER,   // A GSI belongs to one interrupt source
+  ACPI_XCHECK_CONSOLE,     // SPCR UART is a DBG2 serial port
+  ACPI_XCHECK_PCI_SEGMENT, // MCFG segments vs IORT root complexes
+  ACPI_XCHECK_COUNT,
+};
+
+// Tables the checks read, in AcpiTableSet.tables
+enum ACPI_XCHECK_TABLE {
+  ACPI_XCHECK_MADT = 0,
+  ACPI_XCHECK_PPTT,
+  ACPI_XCHECK_GTDT,
+  ACPI_XCHECK_SPCR,
+  ACPI_XCHECK_DBG2,
+  ACPI_XCHECK_MCFG,
+  ACPI_XCHECK_IORT,
+  ACPI_XCHECK_TABLE_COUNT,
+};
+
+typedef struct {
+  const uint8_t *table; // NULL if the device has no such table
+  size_t size;
+} AcpiXcheckTable;
+
+typedef struct {
+  AcpiXcheckTable tables[ACPI_XCHECK_TABLE_COUNT];
+} AcpiTableSet;
+
+typedef struct {
+  uint8_t check;  // enum ACPI_XCHECK
+  uint8_t status; // ACPI_CHECK_WARN or ACPI_CHECK_FAIL
+  char message[ACPI_VALIDATE_MESSAGE_SIZE];
+} AcpiXcheckDiagnostic;
+
+typedef struct {
+  uint8_t status[ACPI_XCHECK_COUNT];     // enum ACPI_CHECK_STATUS
+  uint32_t relations[ACPI_XCHECK_COUNT]; // Pairs of entries compared
+  AcpiXcheckDiagnostic *diagnostics;     // In check order
+  size_t diagnosticCount;
+  size_t diagnosticCapacity;
+  bool oom; // Diagnostics were dropped
+} AcpiXcheckResult;
+
+extern const char *const acpi_xcheck_names[ACPI_XCHECK_COUNT];
+
+int acpi_xcheck_add(AcpiTableSet *set, const uint8_t *table, size_t size);
+int acpi_xcheck_run(const AcpiTableSet *set, AcpiXcheckResult *result);
+bool acpi_xcheck_failed(const AcpiXcheckResult *result);
+void acpi_xcheck_free(AcpiXcheckResult *result);
@@ -0,0 +1,153 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <acpi.h>
+#include <common/iort.h>
+#include <common/madt.h>
+#include <common/pptt.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Runtime table builder (libacpigen)
+
+  The tables in include/vendor are fixed at compile time by the *_START /
+  *_END initializers. This library builds the same binary tables at run
+  time, so configuration sweeps (core counts, cache layouts, ...) do not
+  need new headers and a rebuild:
+
+    AcpiArena arena;
+    AcpiGen gen;
+    acpi_arena_init(&arena, 0);
+    acpigen_pptt_begin(&gen, &arena);
+    l2 = acpigen_pptt_cache(&gen, &cache, ACPIGEN_NO_REF);
+    cluster = acpigen_pptt_processor(&gen, 0, 0, system, &l2, 1);
+    ...
+    acpigen_finalize(&gen, &table, &length);
+    acpi_arena_reset(&arena);  // Next variant reuses the same memory
+
+  Every append returns a reference to the new subtable. References are
+  resolved to table offsets by acpigen_finalize(), which also fixes the
+  table length, node counts and checksum, so a subtable may refer to one
+  appended later (acpigen_forward() + acpigen_bind()).
+
+  Errors are sticky: a failing append returns ACPIGEN_NO_REF and the error
+  is returned by acpigen_finalize(), so callers only check once per table.
+  Everything lives in the arena, a table stays valid until the arena is
+  reset or freed.
+*/
+
+//
+// Bump allocator made of blocks that are kept across resets, so steady
+// state generation does not call malloc.
+//
+typedef struct AcpiArenaBlock AcpiArenaBlock;
+
+typedef struct {
+  AcpiArenaBlock *first;
+  AcpiArenaBlock *current;
+  size_t blockSize; // Minimum size of a new block
+} AcpiArena;
+
+#define ACPI_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+void acpi_arena_init(AcpiArena *arena, size_t block_size);
+void *acpi_arena_alloc(AcpiArena *arena, size_t size);
+void *acpi_arena_grow(AcpiArena *arena, void *ptr, size_t old_size,
+                      size_t new_size);
+void acpi_arena_reset(AcpiArena *arena);
+void acpi_arena_free(AcpiArena *arena);
+
+// Subtable reference, 0 is "no reference" and encodes as offset 0
+typedef uint32_t AcpiGenRef;
+#define ACPIGEN_NO_REF 0
+
+typedef struct {
+  uint32_t slot; // Table offset of the UINT32 to patch
+  AcpiGenRef ref;
+} AcpiGenFixup;
+
+typedef struct {
+  AcpiArena *arena;
+  uint8_t *data;
+  uint32_t length;
+  uint32_t capacity;
+  uint32_t *refOffsets; // Offset of each reference, index ref - 1
+  uint32_t refCount;
+  uint32_t refCapacity;
+  AcpiGenFixup *fixups;
+  uint32_t fixupCount;
+  uint32_t fixupCapacity;
+  int32_t nodeCountOffset; // UINT32 counting subtables, or -1
+  uint32_t nodeCount;
+  int error; // First error, negative errno
+} AcpiGen;
+
+//
+// Generic builder, for any table made of a header, a fixed part and a
+// stream of subtables.
+//
+int acpigen_begin(AcpiGen *gen, AcpiArena *arena, const char signature[4],
+                  uint8_t revision, size_t fixed_size);
+void acpigen_set_oem(AcpiGen *gen, const char oem_id[6],
+                     const char oem_table_id[8], uint32_t oem_revision);
+void acpigen_write(AcpiGen *gen, uint32_t offset, const void *data,
+                   size_t size);
+AcpiGenRef acpigen_append(AcpiGen *gen, const void *data, size_t size);
+AcpiGenRef acpigen_forward(AcpiGen *gen);
+void acpigen_bind(AcpiGen *gen, AcpiGenRef forward, AcpiGenRef ref);
+void acpigen_reference(AcpiGen *gen, uint32_t slot, AcpiGenRef ref);
+int acpigen_finalize(AcpiGen *gen, const uint8_t **table, size_t *length);
+
+//
+// PPTT, caches and processor nodes in append order.
+//
+int acpigen_pptt_begin(AcpiGen *gen, AcpiArena *arena);
+AcpiGenRef acpigen_pptt_id(AcpiGen *gen, const ACPI_PPTT_ID *id);
+AcpiGenRef acpigen_pptt_cache(AcpiGen *gen,
+                              const ACPI_PPTT_CACHE_TYPE_STRUCTURE *cache,
+                              AcpiGenRef next_level);
+AcpiGenRef acpigen_pptt_processor(AcpiGen *gen, uint32_t flags,
+                                  uint32_t acpi_processor_id,
+                                  AcpiGenRef parent,
+                                  const AcpiGenRef *resources,
+                                  uint32_t resource_count);
+
+//
+// MADT, interrupt controller structures in append order. Type and Length
+// of the given structures are filled in.
+//
+int acpigen_madt_begin(AcpiGen *gen, AcpiArena *arena,
+                       uint32_t local_intc_address, uint32_t flags);
+AcpiGenRef acpigen_madt_gicc(AcpiGen *gen, const MADT_GICC_STRUCTURE *gicc);
+AcpiGenRef acpigen_madt_gicd(AcpiGen *gen, const MADT_GICD_STRUCTURE *gicd);
+AcpiGenRef acpigen_madt_gic_msi_frame(AcpiGen *gen,
+                                      const MADT_GIC_MSI_FRAME_STRUCTURE *msi);
+AcpiGenRef acpigen_madt_gicr(AcpiGen *gen, const MADT_GICR_STRUCTURE *gicr);
+AcpiGenRef acpigen_madt_gic_its(AcpiGen *gen,
+                                const MADT_GIC_ITS_STRUCTURE *its);
+
+//
+// IORT, nodes with their ID mappings. OutputReference of each mapping is
+// given as a reference and resolved at finalize time.
+//
+typedef struct {
+  uint32_t inputBase;
+  uint32_t numOfIds;
+  uint32_t outputBase;
+  AcpiGenRef output;
+  uint32_t flags;
+} AcpiGenIortMapping;
+
+int acpigen_iort_begin(AcpiGen *gen, AcpiArena *arena);
+AcpiGenRef acpigen_iort_node(AcpiGen *gen, const void *node, size_t node_size,
+                             const AcpiGenIortMapping *mappings,
+                             uint32_t mapping_count);
+AcpiGenRef acpigen_iort_its_group(AcpiGen *gen, uint32_t identifier,
+                                  const uint32_t *its_ids, uint32_t count);
@@ -0,0 +1,101 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include "sha256.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Multi-device ACPI table bundle
+
+  All fields are little endian, every section is 8 bytes aligned so the
+  bundle can be used in place from a read-only mapping.
+
+        +---------------------+  offset 0
+        |       Header        |
+        +---------------------+  IndexOffset
+        |    Index entries    |  sorted by (Device, Signature)
+        +---------------------+  BlobOffset
+        |     Blob entries    |  one per unique table content
+        +---------------------+
+        |      Payloads       |  raw or deflate compressed
+        +---------------------+  TotalSize
+
+  Several index entries point at the same blob when their content is
+  byte-identical (same SHA-256).
+*/
+
+#define ACPI_BUNDLE_MAGIC 'A', 'C', 'P', 'I', 'B', 'N', 'D', 'L'
+#define ACPI_BUNDLE_VERSION 1
+#define ACPI_BUNDLE_ALIGNMENT 8
+#define ACPI_BUNDLE_DEVICE_NAME_SIZE 32
+
+enum ACPI_BUNDLE_COMPRESSION {
+  ACPI_BUNDLE_COMPRESSION_NONE = 0,
+  ACPI_BUNDLE_COMPRESSION_DEFLATE = 1, // zlib stream
+};
+
+typedef struct {
+  char Magic[8]; // "ACPIBNDL"
+  uint32_t Version;
+  uint32_t EntryCount;
+  uint32_t BlobCount;
+  uint32_t Reserved;
+  uint64_t IndexOffset;
+  uint64_t BlobOffset;
+  uint64_t TotalSize; // Size of the whole bundle file
+} __attribute__((packed)) ACPI_BUNDLE_HEADER;
+_Static_assert(sizeof(ACPI_BUNDLE_HEADER) == 48,
+               "ACPI_BUNDLE_HEADER size is incorrect");
+
+typedef struct {
+  char Device[ACPI_BUNDLE_DEVICE_NAME_SIZE]; // NUL padded, e.g. "qcom_sm8850"
+  char Signature[4];
+  uint32_t BlobIndex;
+} __attribute__((packed)) ACPI_BUNDLE_INDEX_ENTRY;
+_Static_assert(sizeof(ACPI_BUNDLE_INDEX_ENTRY) == 40,
+               "ACPI_BUNDLE_INDEX_ENTRY size is incorrect");
+
+typedef struct {
+  uint64_t Offset;     // Payload offset from bundle start
+  uint32_t StoredSize; // Payload size in the bundle
+  uint32_t Size;       // Table size once decompressed
+  uint8_t Compression; // enum ACPI_BUNDLE_COMPRESSION
+  uint8_t Reserved[7];
+  uint8_t Sha256[SHA256_DIGEST_SIZE]; // Hash of the decompressed table
+} __attribute__((packed)) ACPI_BUNDLE_BLOB_ENTRY;
+_Static_assert(sizeof(ACPI_BUNDLE_BLOB_ENTRY) == 56,
+               "ACPI_BUNDLE_BLOB_ENTRY size is incorrect");
+
+//
+// Read-only view over a bundle buffer (file content or mmap).
+//
+typedef struct {
+  const uint8_t *base;
+  size_t size;
+  const ACPI_BUNDLE_HEADER *header;
+  const ACPI_BUNDLE_INDEX_ENTRY *index;
+  const ACPI_BUNDLE_BLOB_ENTRY *blobs;
+} AcpiBundle;
+
+int bundle_open(AcpiBundle *bundle, const uint8_t *buffer, size_t size);
+int bundle_compare_key(const char *device, const char *signature,
+                       const ACPI_BUNDLE_INDEX_ENTRY *entry);
+const ACPI_BUNDLE_INDEX_ENTRY *bundle_find(const AcpiBundle *bundle,
+                                           const char *device,
+                                           const char *signature);
+const ACPI_BUNDLE_BLOB_ENTRY *
+bundle_entry_blob(const AcpiBundle *bundle,
+                  const ACPI_BUNDLE_INDEX_ENTRY *entry);
+const uint8_t *bundle_blob_data(const AcpiBundle *bundle,
+                                const ACPI_BUNDLE_BLOB_ENTRY *blob);
+int bundle_read_blob(const AcpiBundle *bundle,
+                     const ACPI_BUNDLE_BLOB_ENTRY *blob, uint8_t *output,
+                     size_t output_size);
+bool bundle_compression_supported(uint8_t compression);
@@ -22,6 +22,14 @@
     << __builtin_ctzll((unsigned long long)(mask))) &                          \
    (unsigned long long)(mask))
 
+// Compile time check usable inside constant expressions such as table
+// initializers, fails the build with msg when cond is false, else is 0
+#define STATIC_CHECK(cond, msg)                                                \
+  (0 * sizeof(struct {                                                         \
+     _Static_assert(cond, msg);                                                \
+     char Unused;                                                              \
+   }))
+
 // Standard type definitions
 typedef char CHAR8;
 _Static_assert(sizeof(CHAR8) == 1, "CHAR8 size is incorrect");
@@ -55,4 +63,22 @@ _Static_assert(sizeof(CHAR8) == 1, "CHAR8 size incorrect");
 #define GIC_SGI(x) (x)
 #define GIC_PPI(x) (16ULL + (x))
 #define GIC_SPI(x) (32ULL + (x))
-#define GIC_LPI(x) (8192ULL + (x))
\ No newline at end of file
+#define GIC_LPI(x) (8192ULL + (x))
+// Cores per cluster, platforms declare them in table_header.h, a cluster
+// that is not declared has no cores
+#ifndef NUM_CLUSTER_0_CORES
+#define NUM_CLUSTER_0_CORES 0
+#endif
+#ifndef NUM_CLUSTER_1_CORES
+#define NUM_CLUSTER_1_CORES 0
+#endif
+#ifndef NUM_CLUSTER_2_CORES
+#define NUM_CLUSTER_2_CORES 0
+#endif
+#ifndef NUM_CLUSTER_3_CORES
+#define NUM_CLUSTER_3_CORES 0
+#endif
+// 0 when the platform declares no cluster sizes
+#define NUM_CLUSTER_CORES_SUM                                                  \
+  (NUM_CLUSTER_0_CORES + NUM_CLUSTER_1_CORES + NUM_CLUSTER_2_CORES +           \
+   NUM_CLUSTER_3_CORES)
@@ -0,0 +1,154 @@
+#pragma once
+#include <acpi.h>
+#include <common.h>
+
+/** Firmware Performance Data Table (FPDT)
+Reference:
+  ACPI 6.6 Spec, 5.2.24 Firmware Performance Data Table
+
+    Structure:
+        +----------------+
+        |      FPDT      |
+        +----------------+
+        |  ACPI Header   |
+        +----------------+          +----------------+
+        |  FBPT Pointer  | -------> |      FBPT      |
+        |     Record     |          +----------------+
+        +----------------+          |  FBPT Header   |
+                                    +----------------+
+                                    | Boot Perf Data |
+                                    |     Record     |
+                                    +----------------+
+
+  The FBPT lives in firmware reserved memory and is not listed in the XSDT.
+  It is generated as a separate template (FBPT.aml) which firmware copies to
+  runtime memory, fills in place and then points FPDT at.
+*/
+
+/* Table signature */
+#define ACPI_FPDT_SIGNATURE 'F', 'P', 'D', 'T'
+#define ACPI_FPDT_REVISION 1
+
+#define ACPI_FPDT_TABLE_STRUCTURE_NAME FIRMWARE_PERFORMANCE_DATA_TABLE
+
+/* FBPT has only a signature and length, like FACS */
+#define ACPI_FBPT_SIGNATURE 'F', 'B', 'P', 'T'
+
+#define ACPI_FBPT_TABLE_STRUCTURE_NAME FIRMWARE_BASIC_BOOT_PERFORMANCE_TABLE
+
+/* Body Structures */
+// Performance Record Header (Table 5.107)
+typedef struct {
+  UINT16 Type;
+  UINT8 Length;
+  UINT8 Revision;
+} __attribute__((packed)) FPDT_PERFORMANCE_RECORD_HEADER;
+_Static_assert(sizeof(FPDT_PERFORMANCE_RECORD_HEADER) == 4,
+               "FPDT_PERFORMANCE_RECORD_HEADER size incorrect");
+
+// Performance Record Types (Table 5.108)
+enum FPDT_RECORD_TYPE {
+  FPDT_RECORD_TYPE_FBPT_POINTER = 0x0000,
+  FPDT_RECORD_TYPE_S3PT_POINTER = 0x0001,
+  /* 0x0002 - 0x0FFF are reserved */
+  FPDT_RECORD_TYPE_RESERVED = 0x0FFF,
+};
+
+// Firmware Basic Boot Performance Pointer Record (Table 5.110)
+typedef struct {
+  FPDT_PERFORMANCE_RECORD_HEADER Header; // Type 0, Length 16, Revision 1
+  UINT32 Reserved;
+  UINT64 FBPTPointer; // 64-bit physical address of the FBPT
+} __attribute__((packed)) FPDT_FBPT_POINTER_RECORD;
+_Static_assert(sizeof(FPDT_FBPT_POINTER_RECORD) == 16,
+               "FPDT_FBPT_POINTER_RECORD size incorrect");
+
+// Firmware Basic Boot Performance Table Header (Table 5.111)
+typedef struct {
+  CHAR8 Signature[4]; // "FBPT"
+  UINT32 Length;      // Length of the entire FBPT including this header
+} __attribute__((packed)) FBPT_HEADER;
+_Static_assert(sizeof(FBPT_HEADER) == 8, "FBPT_HEADER size incorrect");
+
+// Runtime Performance Record Types (Table 5.113)
+enum FBPT_RECORD_TYPE {
+  FBPT_RECORD_TYPE_BASIC_BOOT_PERFORMANCE_DATA = 0x0002,
+};
+
+// Firmware Basic Boot Performance Data Record (Table 5.114)
+// All timestamps are in nanoseconds, 0 means not reported.
+typedef struct {
+  FPDT_PERFORMANCE_RECORD_HEADER Header; // Type 2, Length 48, Revision 2
+  UINT32 Reserved;
+  UINT64 ResetEnd;                // Timer value at the end of reset
+  UINT64 OsLoaderLoadImageStart;  // Start of OS loader load image
+  UINT64 OsLoaderStartImageStart; // Start of OS loader start image
+  UINT64 ExitBootServicesEntry;   // Entry of ExitBootServices()
+  UINT64 ExitBootServicesExit;    // Exit of ExitBootServices()
+} __attribute__((packed)) FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD;
+_Static_assert(sizeof(FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD) == 48,
+               "FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD size incorrect");
+
+/* Helper macros */
+#define FPDT_DEFINE_TABLE                                                      \
+  typedef struct {                                                             \
+    ACPI_TABLE_HEADER Header;                                                  \
+    FPDT_FBPT_POINTER_RECORD FbptPointerRecord;                                \
+  } __attribute__((packed)) ACPI_FPDT_TABLE_STRUCTURE_NAME;
+
+#define FPDT_DECLARE_FBPT_POINTER_RECORD(fbpt_address)                         \
+  .FbptPointerRecord = {                                                       \
+      .Header =                                                                \
+          {                                                                    \
+              .Type = FPDT_RECORD_TYPE_FBPT_POINTER,                           \
+              .Length = sizeof(FPDT_FBPT_POINTER_RECORD),                      \
+              .Revision = 1,                                                   \
+          },                                                                   \
+      .Reserved = 0,                                                           \
+      .FBPTPointer = fbpt_address,                                             \
+  }
+
+#define FPDT_DECLARE_HEADER                                                    \
+  ACPI_DECLARE_TABLE_HEADER(                                                   \
+      ACPI_FPDT_SIGNATURE, ACPI_FPDT_TABLE_STRUCTURE_NAME, ACPI_FPDT_REVISION)
+
+#define FBPT_DEFINE_TABLE                                                      \
+  typedef struct {                                                             \
+    FBPT_HEADER Header;                                                        \
+    FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD BasicBootPerformanceData;          \
+  } __attribute__((packed)) ACPI_FBPT_TABLE_STRUCTURE_NAME;
+
+#define FBPT_DECLARE_HEADER                                                    \
+  .Header = {                                                                  \
+      .Signature = {ACPI_FBPT_SIGNATURE},                                      \
+      .Length = sizeof(ACPI_FBPT_TABLE_STRUCTURE_NAME),                        \
+  }
+
+// Reserved record, all timestamps left zero for firmware to fill in place
+#define FBPT_DECLARE_BASIC_BOOT_PERFORMANCE_DATA_RECORD                        \
+  .BasicBootPerformanceData = {                                                \
+      .Header =                                                                \
+          {                                                                    \
+              .Type = FBPT_RECORD_TYPE_BASIC_BOOT_PERFORMANCE_DATA,            \
+              .Length = sizeof(FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD),       \
+              .Revision = 2,                                                   \
+          },                                                                   \
+  }
+
+/* Well known offsets, the loader may patch these without parsing */
+// Offset of FBPTPointer inside FPDT
+#define FPDT_FBPT_POINTER_OFFSET                                               \
+  (sizeof(ACPI_TABLE_HEADER) + offsetof(FPDT_FBPT_POINTER_RECORD, FBPTPointer))
+// Offset of the Basic Boot Performance Data Record inside FBPT
+#define FBPT_BASIC_BOOT_PERFORMANCE_DATA_OFFSET (sizeof(FBPT_HEADER))
+
+/* FPDT/FBPT Table with Magic */
+#define FPDT_DEFINE_WITH_MAGIC                                                 \
+  ACPI_TABLE_WITH_MAGIC(ACPI_FPDT_TABLE_STRUCTURE_NAME)
+#define FPDT_START ACPI_TABLE_START(ACPI_FPDT_TABLE_STRUCTURE_NAME)
+#define FPDT_END ACPI_TABLE_END(ACPI_FPDT_TABLE_STRUCTURE_NAME)
+
+#define FBPT_DEFINE_WITH_MAGIC                                                 \
+  ACPI_TABLE_WITH_MAGIC(ACPI_FBPT_TABLE_STRUCTURE_NAME)
+#define FBPT_START ACPI_TABLE_START(ACPI_FBPT_TABLE_STRUCTURE_NAME)
+#define FBPT_END ACPI_TABLE_END(ACPI_FBPT_TABLE_STRUCTURE_NAME)
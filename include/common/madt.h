@@ -135,19 +135,6 @@ _Static_assert(sizeof(MADT_GIC_ITS_STRUCTURE) == 20,
 #define MADT_GIC_ITS_FLAG_RESERVED GEN_MSK(7, 1)
 
 // Helper macros fill madt define table
-#ifndef NUM_CLUSTER_0_CORES
-#define NUM_CLUSTER_0_CORES 0
-#endif
-#ifndef NUM_CLUSTER_1_CORES
-#define NUM_CLUSTER_1_CORES 0
-#endif
-#ifndef NUM_CLUSTER_2_CORES
-#define NUM_CLUSTER_2_CORES 0
-#endif
-#ifndef NUM_CLUSTER_3_CORES
-#define NUM_CLUSTER_3_CORES 0
-#endif
-
 #define CPUID_TO_CLUSTER(cpu)                                                  \
   (((cpu) < NUM_CLUSTER_0_CORES)                                               \
        ? 0                                                                     \
@@ -162,6 +149,11 @@ _Static_assert(sizeof(MADT_GIC_ITS_STRUCTURE) == 20,
                             ? 3                                                \
                             : 0))))
 
+// GICC entries of the table, the ACPI processor UIDs are 0 to count - 1
+#define MADT_GICC_COUNT                                                        \
+  (sizeof(((ACPI_MADT_TABLE_STRUCTURE_NAME *)0)->GiccStructures) /             \
+   sizeof(MADT_GICC_STRUCTURE))
+
 #define MADT_DECLARE_HEADER_EXTRA_DATA(local_intc_addr, flags)                 \
   .MadtHeaderExtraData = {                                                     \
       .LocalInterruptControllerAddress = local_intc_addr,                      \
@@ -198,7 +190,10 @@ _Static_assert(sizeof(MADT_GIC_ITS_STRUCTURE) == 20,
       .Length = sizeof(MADT_GICC_STRUCTURE),                                   \
       .Reserved = 0,                                                           \
       .CPUInterfaceNumber = cpu_id,                                            \
-      .ACPIProcessorUID = cpu_id,                                              \
+      .ACPIProcessorUID =                                                      \
+          (cpu_id) + STATIC_CHECK((unsigned long long)(cpu_id) <               \
+                                      MADT_GICC_COUNT,                         \
+                                  "GICC cpu_id beyond the GICC count"),        \
       .Flags = MADT_GICC_FLAG_ENABLED,                                         \
       .ParkingProtocolVersion = 0,                                             \
       .PerformanceInterruptGSI = GICC_PERFORMANCE_INTERRUPT_GSI,               \
@@ -221,7 +216,10 @@ _Static_assert(sizeof(MADT_GIC_ITS_STRUCTURE) == 20,
       .Length = sizeof(MADT_GICC_STRUCTURE),                                   \
       .Reserved = 0,                                                           \
       .CPUInterfaceNumber = cpu_id,                                            \
-      .ACPIProcessorUID = cpu_id,                                              \
+      .ACPIProcessorUID =                                                      \
+          (cpu_id) + STATIC_CHECK((unsigned long long)(cpu_id) <               \
+                                      MADT_GICC_COUNT,                         \
+                                  "GICC cpu_id beyond the GICC count"),        \
       .Flags = MADT_GICC_FLAG_ENABLED,                                         \
       .ParkingProtocolVersion = 0,                                             \
       .PerformanceInterruptGSI = GICC_PERFORMANCE_INTERRUPT_GSI,               \
@@ -245,7 +243,12 @@ _Static_assert(sizeof(MADT_GIC_ITS_STRUCTURE) == 20,
     MADT_GICD_STRUCTURE GicDStructure;                                         \
     MADT_GIC_ITS_STRUCTURE GicItsStructures[its_count];                        \
     MADT_GICC_STRUCTURE GiccStructures[core_count];                            \
-  } __attribute__((packed)) name;
+  } __attribute__((packed)) name;                                              \
+  _Static_assert((core_count) == NUM_CORES,                                    \
+                 "GICC count does not match the NUM_CORES PPTT leaves");       \
+  _Static_assert(NUM_CLUSTER_CORES_SUM == 0 ||                                 \
+                     NUM_CLUSTER_CORES_SUM == (core_count),                    \
+                 "NUM_CLUSTER_n_CORES do not add up to the GICC count")
 
 #define MADT_DECLARE_HEADER                                                    \
   ACPI_DECLARE_TABLE_HEADER(                                                   \
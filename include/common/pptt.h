@@ -162,6 +162,19 @@ _Static_assert(sizeof(ACPI_PPTT_ID) == 30, "ACPI_PPTT_ID size is incorrect");
 #define PPTT_CACHE_ATTR_RESERVED_MSK GEN_MSK(7, 5)
 
 /* Helper macros */
+#define PPTT_CACHES_COUNT                                                      \
+  ((L1_CACHES_COUNT) + (L2_CACHES_COUNT) + (L3_CACHES_COUNT))
+
+// Number of elements of an array member of the table
+#define PPTT_TABLE_COUNT(member)                                               \
+  (sizeof(((PROCESSOR_PROPERTIES_TOPOLOGY_TABLE *)0)->member) /                \
+   sizeof(((PROCESSOR_PROPERTIES_TOPOLOGY_TABLE *)0)->member[0]))
+
+// Private resources a node type has room for
+#define PPTT_PRIVATE_RESOURCES_CAPACITY(type)                                  \
+  ((sizeof(type) - sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)) /               \
+   sizeof(ACPI_PPTT_PRIVATE_RESOURCE))
+
 #if ACPI_PPTT_REVISION == 3
 #define PPTT_DECLARE_CACHE(index, cache_type_val, next_level_of_cache, flag)   \
   .CacheTypeStructures[index] = {                                              \
@@ -211,7 +224,9 @@ _Static_assert(sizeof(ACPI_PPTT_ID) == 30, "ACPI_PPTT_ID size is incorrect");
 #define PPTT_REFERENCE_CACHE(index)                                            \
   ((UINT32)(offsetof(PROCESSOR_PROPERTIES_TOPOLOGY_TABLE,                      \
                      CacheTypeStructures) +                                    \
-            ((index) * sizeof(ACPI_PPTT_CACHE_TYPE_STRUCTURE))))
+            ((index) * sizeof(ACPI_PPTT_CACHE_TYPE_STRUCTURE)) +               \
+            STATIC_CHECK((unsigned long long)(index) < PPTT_CACHES_COUNT,      \
+                         "PPTT_REFERENCE_CACHE index out of range")))
 
 #define PPTT_DECLARE_PROCESSOR_HIERARCHY(name, index, cpuid, flags, parent,    \
                                          type, ...)                            \
@@ -221,11 +236,21 @@ _Static_assert(sizeof(ACPI_PPTT_ID) == 30, "ACPI_PPTT_ID size is incorrect");
                   .ProcNode.Parent = (parent),                                 \
                   .ProcNode.Flags = (flags),                                   \
                   .ProcNode.AcpiProcessorId = (cpuid),                         \
-                  .ProcNode.NumberOfPrivateResources = 0 __VA_OPT__(           \
-                      +(sizeof((ACPI_PPTT_PRIVATE_RESOURCE[]){__VA_ARGS__}) /  \
-                        sizeof(ACPI_PPTT_PRIVATE_RESOURCE))),                  \
+                  .ProcNode.NumberOfPrivateResources =                         \
+                      PPTT_CHECKED_RESOURCES_COUNT(type, __VA_ARGS__),         \
                   __VA_OPT__(.PrivateResources = {__VA_ARGS__}, )}
 
+#define PPTT_PRIVATE_RESOURCES_COUNT(...)                                      \
+  (0 __VA_OPT__(+(sizeof((ACPI_PPTT_PRIVATE_RESOURCE[]){__VA_ARGS__}) /        \
+                  sizeof(ACPI_PPTT_PRIVATE_RESOURCE))))
+
+// Private resources passed to a node, no more than its type has room for
+#define PPTT_CHECKED_RESOURCES_COUNT(type, ...)                                \
+  (PPTT_PRIVATE_RESOURCES_COUNT(__VA_ARGS__) +                                 \
+   STATIC_CHECK(PPTT_PRIVATE_RESOURCES_COUNT(__VA_ARGS__) <=                   \
+                    PPTT_PRIVATE_RESOURCES_CAPACITY(type),                     \
+                "more private resources than *_PRIVATE_RESOURCES_COUNT"))
+
 #define PPTT_DECLARE_PROCESSOR_HIERARCHY_SYSTEM(index, cpuid, ...)             \
   PPTT_DECLARE_PROCESSOR_HIERARCHY(                                            \
       SystemHierarchyNode, index, cpuid, PPTT_PROC_FLAG_PHYSICAL_PACKAGE, 0,   \
@@ -238,10 +263,13 @@ _Static_assert(sizeof(ACPI_PPTT_ID) == 30, "ACPI_PPTT_ID size is incorrect");
 
 #define PPTT_DECLARE_PROCESSOR_HIERARCHY_PHYSICAL_CPU(index, cpuid, parent,    \
                                                       ...)                     \
-  PPTT_DECLARE_PROCESSOR_HIERARCHY(PhysicalCpuHierarchyNodes, index, cpuid,    \
-                                   PPTT_PROC_FLAG_ACPI_PROC_ID_VALID, parent,  \
-                                   ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU, \
-                                   __VA_ARGS__)
+  PPTT_DECLARE_PROCESSOR_HIERARCHY(                                            \
+      PhysicalCpuHierarchyNodes, index,                                        \
+      (cpuid) + STATIC_CHECK((unsigned long long)(cpuid) <                     \
+                                 PPTT_TABLE_COUNT(PhysicalCpuHierarchyNodes),  \
+                             "ACPI processor ID has no MADT GICC entry"),      \
+      PPTT_PROC_FLAG_ACPI_PROC_ID_VALID, parent,                               \
+      ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU, __VA_ARGS__)
 
 #define PPTT_DECLARE_ID()                                                      \
   .Id = {                                                                      \
@@ -267,7 +295,9 @@ _Static_assert(sizeof(ACPI_PPTT_ID) == 30, "ACPI_PPTT_ID size is incorrect");
                      ClusterHierarchyNodes) +                                  \
             ((index) * (sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +           \
                         sizeof(ACPI_PPTT_PRIVATE_RESOURCE) *                   \
-                            CLUSTER_PRIVATE_RESOURCES_COUNT))))
+                            CLUSTER_PRIVATE_RESOURCES_COUNT)) +                \
+            STATIC_CHECK((unsigned long long)(index) < NUM_CLUSTERS,           \
+                         "PPTT_REFERENCE_CLUSTER index out of range")))
 
 #define PPTT_DEFINE_SYSTEM                                                     \
   typedef struct {                                                             \
@@ -302,7 +332,21 @@ _Static_assert(sizeof(ACPI_PPTT_ID) == 30, "ACPI_PPTT_ID size is incorrect");
     ClusterHierarchyNodes[NUM_CLUSTERS];                                       \
     ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU                                 \
     PhysicalCpuHierarchyNodes[NUM_CORES];                                      \
-  } __attribute__((packed)) ACPI_PPTT_TABLE_STRUCTURE_NAME;
+  } __attribute__((packed)) ACPI_PPTT_TABLE_STRUCTURE_NAME;                    \
+  _Static_assert(sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_CLUSTER) ==              \
+                     sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +              \
+                         sizeof(ACPI_PPTT_PRIVATE_RESOURCE) *                  \
+                             CLUSTER_PRIVATE_RESOURCES_COUNT,                  \
+                 "PPTT_REFERENCE_CLUSTER stride does not match the layout");   \
+  _Static_assert(sizeof(ACPI_PPTT_TABLE_STRUCTURE_NAME) <= UINT32_MAX,         \
+                 "PPTT references do not fit in 32 bits");                     \
+  _Static_assert(NUM_CLUSTER_CORES_SUM == 0 ||                                 \
+                     NUM_CLUSTER_CORES_SUM == NUM_CORES,                       \
+                 "NUM_CLUSTER_n_CORES do not add up to NUM_CORES");            \
+  _Static_assert((NUM_CLUSTERS >= 2 || NUM_CLUSTER_1_CORES == 0) &&            \
+                     (NUM_CLUSTERS >= 3 || NUM_CLUSTER_2_CORES == 0) &&        \
+                     (NUM_CLUSTERS >= 4 || NUM_CLUSTER_3_CORES == 0),          \
+                 "NUM_CLUSTER_n_CORES set for a cluster beyond NUM_CLUSTERS")
 
 #define PPTT_DECLARE_HEADER                                                    \
   ACPI_DECLARE_TABLE_HEADER(                                                   \
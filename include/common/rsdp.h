@@ -0,0 +1,31 @@
+#pragma once
+#include <acpi.h>
+#include <common.h>
+
+/** Root System Description Pointer (RSDP)
+Reference:
+  ACPI 6.6 Spec, 5.2.5 Root System Description Pointer (RSDP)
+
+  RSDP is not a table, it has no standard header. Firmware publishes its
+  address (EFI_ACPI_TABLE_GUID configuration table on UEFI systems).
+*/
+
+#define ACPI_RSDP_SIGNATURE 'R', 'S', 'D', ' ', 'P', 'T', 'R', ' '
+#define ACPI_RSDP_REVISION 2
+
+typedef struct {
+  CHAR8 Signature[8]; // "RSD PTR "
+  UINT8 Checksum;     // Checksum of the first 20 bytes
+  CHAR8 OemId[6];
+  UINT8 Revision;       // 2 for ACPI 2.0 and later
+  UINT32 RsdtAddress;   // 32-bit physical address of RSDT, unused on ARM
+  UINT32 Length;        // Length of the whole structure (36)
+  UINT64 XsdtAddress;   // 64-bit physical address of XSDT
+  UINT8 ExtendedChecksum; // Checksum of the entire structure
+  UINT8 Reserved[3];
+} __attribute__((packed)) ACPI_RSDP_STRUCTURE;
+_Static_assert(sizeof(ACPI_RSDP_STRUCTURE) == 36,
+               "ACPI_RSDP_STRUCTURE size is incorrect");
+
+// Legacy checksum only covers the ACPI 1.0 part of RSDP
+#define ACPI_RSDP_CHECKSUM_LENGTH 20
@@ -0,0 +1,24 @@
+#pragma once
+#include <acpi.h>
+#include <common.h>
+
+/** Extended System Description Table (XSDT)
+Reference:
+  ACPI 6.6 Spec, 5.2.8 Extended System Description Table (XSDT)
+*/
+
+/* Table signature */
+#define ACPI_XSDT_SIGNATURE 'X', 'S', 'D', 'T'
+#define ACPI_XSDT_REVISION 1
+
+#define ACPI_XSDT_TABLE_STRUCTURE_NAME EXTENDED_SYSTEM_DESCRIPTION_TABLE
+
+typedef struct {
+  ACPI_TABLE_HEADER Header;
+  // UINT64 Entry[]; // 64-bit physical addresses of other tables
+} __attribute__((packed)) ACPI_XSDT_TABLE_HEADER;
+_Static_assert(sizeof(ACPI_XSDT_TABLE_HEADER) == 36,
+               "ACPI_XSDT_TABLE_HEADER size is incorrect");
+
+#define XSDT_TABLE_LENGTH(entry_count)                                         \
+  (sizeof(ACPI_XSDT_TABLE_HEADER) + sizeof(UINT64) * (entry_count))
@@ -0,0 +1,69 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include "fdt.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Platform description extracted from a DTB
+
+  The values tools/dtb_to_table_header.py, dtb_to_madt.py and
+  dtb_to_mcfg.py derive from a device tree, computed with the same
+  heuristics in one pass over a parsed FdtTree. dtb_to_headers prints them
+  as headers, dtb_to_aml builds the tables from them directly, so both
+  always agree.
+
+  "First match" searches follow the script walk: an explicit stack (pop a
+  node, look at its children in order, push them).
+*/
+
+#define DTB_MAX_CLUSTERS 64
+#define DTB_MAX_COMMENT 1024
+
+typedef struct {
+  uint32_t segment;
+  uint64_t base;
+  uint32_t busStart;
+  uint32_t busEnd;
+  char comment[DTB_MAX_COMMENT]; // Node name or path the entry came from
+} DtbMcfgEntry;
+
+typedef struct {
+  // table_header.h
+  uint32_t cores;
+  uint32_t clusterCount;
+  uint32_t clusters[DTB_MAX_CLUSTERS]; // Cores per cluster, descending
+  bool l2Shared; // Every cpu@ has the same next-level-cache
+  bool l3;
+
+  // madt.h
+  uint64_t gicdBase;
+  uint64_t gicrBase;
+  uint64_t gicrStride;
+  uint64_t itsBase;
+  uint32_t itsCount;
+  uint8_t gicVersion; // enum MADT_GICD_GIC_VERSION
+  uint64_t perfGsi;
+  uint64_t vgicGsi;
+
+  // mcfg.h, sorted by segment
+  DtbMcfgEntry *mcfg;
+  uint32_t mcfgCount;
+
+  // Architected timer: secure, non secure, virtual, hypervisor
+  bool hasTimer;
+  uint32_t timerGsi[4];
+} DtbPlatform;
+
+int dtb_platform_extract(const FdtTree *tree, DtbPlatform *platform);
+void dtb_platform_free(DtbPlatform *platform);
+
+uint64_t dtb_infer_oem_revision(const char *name);
+const char *dtb_gic_version_name(uint8_t version);
+bool dtb_contains_nocase(const char *text, const char *needle);
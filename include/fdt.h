@@ -0,0 +1,75 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Flattened device tree (DTB) reader
+
+  The blob is mapped read only and parsed in a single pass over the
+  structure block. Nodes and properties go to two flat arrays (names and
+  values point into the blob, nothing is allocated per node), and two hash
+  indexes are built on the way: full path -> node and phandle -> node.
+
+  Nodes are referenced by index, node 0 is the root. Children of a node are
+  linked in blob order, which is the order dtc and pyfdt show them in.
+*/
+
+#define FDT_MAGIC 0xD00DFEED
+#define FDT_NO_NODE UINT32_MAX
+
+typedef struct {
+  const char *name; // Points into the strings block
+  const uint8_t *value;
+  uint32_t length;
+} FdtProperty;
+
+typedef struct {
+  const char *name; // Unit name ("cpu@0"), "" for the root
+  uint32_t parent;  // FDT_NO_NODE for the root
+  uint32_t firstChild;
+  uint32_t nextSibling;
+  uint32_t firstProperty; // Index in FdtTree.properties
+  uint32_t propertyCount;
+  uint32_t phandle; // 0 if the node has none
+  uint32_t depth;
+  uint64_t pathHash;
+} FdtNode;
+
+typedef struct {
+  const uint8_t *blob;
+  size_t size;
+  bool mapped;
+  FdtNode *nodes;
+  uint32_t nodeCount;
+  FdtProperty *properties;
+  uint32_t propertyCount;
+  uint32_t *pathIndex; // Open addressing, pathIndexSize is a power of two
+  uint32_t pathIndexSize;
+  uint32_t *phandleIndex;
+  uint32_t phandleIndexSize;
+} FdtTree;
+
+size_t fdt_find_blob(const uint8_t *data, size_t size, size_t *offset);
+int fdt_open(FdtTree *tree, const char *path);
+int fdt_parse(FdtTree *tree, const uint8_t *blob, size_t size);
+void fdt_close(FdtTree *tree);
+
+uint32_t fdt_find_path(const FdtTree *tree, const char *path);
+uint32_t fdt_find_phandle(const FdtTree *tree, uint32_t phandle);
+size_t fdt_node_path(const FdtTree *tree, uint32_t node, char *buffer,
+                     size_t size);
+
+const FdtProperty *fdt_get_property(const FdtTree *tree, uint32_t node,
+                                    const char *name);
+uint32_t fdt_property_cells(const FdtProperty *property);
+uint32_t fdt_property_cell(const FdtProperty *property, uint32_t index);
+bool fdt_property_is_string(const FdtProperty *property);
+bool fdt_property_has_string(const FdtProperty *property, const char *needle);
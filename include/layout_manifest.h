@@ -0,0 +1,197 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** Layout manifest of a device
+
+  Every src/layout/<table>.c is compiled with the include path of one
+  device, like src/dummy/<table>.c, and describes the structures of the
+  table with offsetof()/sizeof() together with the configuration macros
+  the table was built with. The <device>_layout host program links them
+  and writes <build>/<device>/layout.json:
+
+    {
+      "device": "qcom_sm8850",
+      "tables": {
+        "PPTT": {"signature": "PPTT", "revision": 1, "size": 376,
+                 "struct": "PROCESSOR_PROPERTIES_TOPOLOGY_TABLE",
+                 "config": {"NUM_CORES": 8, ...}},
+        ...
+      },
+      "types": {
+        "ACPI_PPTT_ID": {"size": 30, "fields": [
+          {"name": "Type", "offset": 0, "size": 1, "count": 1,
+           "kind": "uint"},
+          ...
+        ]},
+        ...
+      }
+    }
+
+  Structures lib/acpi_layout.c also describes take their members from
+  include/acpi_fields.h, see LAYOUT_LIST_TYPE(). A type is only written
+  if its fields cover it byte for byte, so a member added to a structure
+  and not to its layout fails the build.
+*/
+
+enum LAYOUT_FIELD_KIND {
+  LAYOUT_UINT = 0,   // Little endian integer, or array of them
+  LAYOUT_CHARS = 1,  // Character array, e.g. OemId
+  LAYOUT_BYTES = 2,  // Raw bytes, e.g. reserved or vendor data
+  LAYOUT_STRUCT = 3, // Structure described in "types", or array of them
+};
+
+typedef struct {
+  const char *name;
+  uint32_t offset; // From structure start
+  uint32_t size;   // Whole member, all elements of an array
+  uint32_t count;  // Array elements, 1 for scalars
+  uint8_t kind;    // enum LAYOUT_FIELD_KIND
+  const char *type; // Element type of LAYOUT_STRUCT fields
+} LayoutField;
+
+#define LAYOUT_MAX_TYPES 128
+
+typedef struct {
+  const char *device;
+  char *tablesText; // "tables" members, built in tablesStream
+  size_t tablesSize;
+  FILE *tablesStream;
+  char *typesText; // "types" members, built in typesStream
+  size_t typesSize;
+  FILE *typesStream;
+  unsigned tableCount;
+  unsigned configCount; // Of the current table
+  unsigned typeCount;
+  char *typeNames[LAYOUT_MAX_TYPES];
+  char *typeTexts[LAYOUT_MAX_TYPES]; // To tell duplicates from conflicts
+  int error;                         // First error, negative errno
+} LayoutWriter;
+
+#define _LAYOUT_STRINGIFY(x) #x
+#define LAYOUT_STRINGIFY(x) _LAYOUT_STRINGIFY(x)
+
+// Describe a member of type, see LAYOUT_TYPE()
+#define LAYOUT_MEMBER_SIZE(type, member) sizeof(((type *)0)->member)
+#define LAYOUT_FIELD(type, member, kind, element_size, element)               \
+  {#member,                                                                    \
+   offsetof(type, member),                                                     \
+   LAYOUT_MEMBER_SIZE(type, member),                                           \
+   LAYOUT_MEMBER_SIZE(type, member) / (element_size),                          \
+   kind,                                                                       \
+   element}
+#define LAYOUT_UINT_FIELD(type, member)                                        \
+  LAYOUT_FIELD(type, member, LAYOUT_UINT, LAYOUT_MEMBER_SIZE(type, member),    \
+               NULL)
+#define LAYOUT_UINT_ARRAY(type, member, element)                               \
+  LAYOUT_FIELD(type, member, LAYOUT_UINT, sizeof(element), NULL)
+#define LAYOUT_CHARS_FIELD(type, member)                                       \
+  LAYOUT_FIELD(type, member, LAYOUT_CHARS, 1, NULL)
+#define LAYOUT_BYTES_FIELD(type, member)                                       \
+  LAYOUT_FIELD(type, member, LAYOUT_BYTES, 1, NULL)
+#define LAYOUT_STRUCT_FIELD(type, member, element)                             \
+  LAYOUT_FIELD(type, member, LAYOUT_STRUCT, sizeof(element),                   \
+               LAYOUT_STRINGIFY(element))
+
+// X of the member lists in include/acpi_fields.h
+#define LAYOUT_LIST_FIELD(kind, member, type, ...)                             \
+  LAYOUT_KIND_##kind(type, member),
+#define LAYOUT_KIND_UINT LAYOUT_UINT_FIELD
+#define LAYOUT_KIND_CHARS LAYOUT_CHARS_FIELD
+#define LAYOUT_KIND_BYTES LAYOUT_BYTES_FIELD
+#define LAYOUT_KIND_GAS(type, member)                                          \
+  LAYOUT_STRUCT_FIELD(type, member, ACPI_GENERIC_ADDRESS_STRUCTURE)
+#define LAYOUT_KIND_ACPI_GAS(type, member)                                     \
+  LAYOUT_STRUCT_FIELD(type, member, ACPI_GAS)
+#define LAYOUT_KIND_RECORD_HEADER(type, member)                                \
+  LAYOUT_STRUCT_FIELD(type, member, FPDT_PERFORMANCE_RECORD_HEADER)
+
+// Members a table defines per device (CSRT resource groups, DBG2 device
+// information...), the bytes of type after member as one "Body" field
+#define LAYOUT_BODY_AFTER(type, member)                                        \
+  {"Body",                                                                     \
+   offsetof(type, member) + LAYOUT_MEMBER_SIZE(type, member),                  \
+   sizeof(type) - offsetof(type, member) - LAYOUT_MEMBER_SIZE(type, member),   \
+   1,                                                                          \
+   LAYOUT_BYTES,                                                               \
+   NULL}
+
+// Write a type with its fields, type may be a macro like
+// ACPI_PPTT_TABLE_STRUCTURE_NAME
+#define LAYOUT_TYPE(writer, type, ...)                                         \
+  layout_type(writer, LAYOUT_STRINGIFY(type), sizeof(type),                    \
+              (const LayoutField[]){__VA_ARGS__},                              \
+              sizeof((const LayoutField[]){__VA_ARGS__}) / sizeof(LayoutField))
+
+// Write a type with the members of its list in include/acpi_fields.h, the
+// same list lib/acpi_layout.c describes the tables with
+#define LAYOUT_LIST_TYPE(writer, type)                                         \
+  LAYOUT_TYPE(writer, type, type##_FIELDS(LAYOUT_LIST_FIELD, type, 0))
+
+// ACPI_TABLE_<type>_WITH_MAGIC wrapper the extractor looks for
+#define _LAYOUT_MAGIC_TYPE(writer, type)                                       \
+  LAYOUT_TYPE(                                                                 \
+      writer, ACPI_TABLE_##type##_WITH_MAGIC,                                  \
+      LAYOUT_CHARS_FIELD(ACPI_TABLE_##type##_WITH_MAGIC, StartMagic),          \
+      LAYOUT_STRUCT_FIELD(ACPI_TABLE_##type##_WITH_MAGIC, ACPI_TABLE, type),   \
+      LAYOUT_CHARS_FIELD(ACPI_TABLE_##type##_WITH_MAGIC, EndMagic))
+#define LAYOUT_MAGIC_TYPE(writer, type) _LAYOUT_MAGIC_TYPE(writer, type)
+
+// Start the "tables" entry of a table, name is the AML file name and the
+// signature a character list like ACPI_PPTT_SIGNATURE
+#define LAYOUT_BEGIN_TABLE(writer, name, revision, type, ...)                  \
+  layout_begin_table(writer, name, (const char[]){__VA_ARGS__},                \
+                     sizeof((const char[]){__VA_ARGS__}), revision,            \
+                     LAYOUT_STRINGIFY(type), sizeof(type))
+
+// Resolved value of an integer or character list configuration macro
+#define LAYOUT_CONFIG(writer, macro)                                           \
+  layout_config(writer, #macro, (unsigned long long)(macro))
+#define LAYOUT_CONFIG_CHARS(writer, macro)                                     \
+  layout_config_chars(writer, #macro, (const char[]){macro},                   \
+                      sizeof((const char[]){macro}))
+
+// Header configuration every table of a device is built with
+#define LAYOUT_HEADER_CONFIG(writer)                                           \
+  do {                                                                         \
+    LAYOUT_CONFIG_CHARS(writer, ACPI_TABLE_HEADER_OEM_ID);                     \
+    LAYOUT_CONFIG_CHARS(writer, ACPI_TABLE_HEADER_OEM_TABLE_ID);               \
+    LAYOUT_CONFIG(writer, ACPI_OEM_REVISION);                                  \
+  } while (0)
+
+// One layout_table_<name>() per src/layout/<name>.c, the layout program
+// only calls the ones of the tables the device has
+#define LAYOUT_TABLES(X)                                                       \
+  X(csrt) X(dbg2) X(facp) X(facs) X(fbpt) X(fpdt) X(gtdt) X(madt) X(mcfg)      \
+      X(pptt) X(spcr)
+#define LAYOUT_DECLARE_TABLE(name)                                             \
+  void layout_table_##name(LayoutWriter *writer);
+LAYOUT_TABLES(LAYOUT_DECLARE_TABLE)
+
+// Types of include/acpi.h and of the tables built outside the device
+// libraries (RSDP, XSDT, IORT), see src/layout/common.c
+void layout_common_types(LayoutWriter *writer);
+
+int layout_open(LayoutWriter *writer, const char *device);
+void layout_begin_table(LayoutWriter *writer, const char *name,
+                        const char *signature, size_t signatureSize,
+                        unsigned revision, const char *type, size_t size);
+void layout_config(LayoutWriter *writer, const char *name,
+                   unsigned long long value);
+void layout_config_chars(LayoutWriter *writer, const char *name,
+                         const char *value, size_t size);
+void layout_end_table(LayoutWriter *writer);
+void layout_type(LayoutWriter *writer, const char *name, size_t size,
+                 const LayoutField *fields, size_t count);
+int layout_write(LayoutWriter *writer, const char *path);
+void layout_close(LayoutWriter *writer);
@@ -0,0 +1,48 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include "acpigen.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** PPTT size optimizer
+
+  The compile time PPTT (PPTT_DEFINE_TABLE) gives every node of a kind the
+  same private resource array, sized for the node that needs the most, and
+  declares one cache structure per CacheTypeStructures index. pptt_optimize()
+  re-emits a built PPTT with libacpigen, structures in their original order:
+
+  - Processor nodes keep NumberOfPrivateResources references only, the
+    unused slots of the fixed arrays are dropped.
+  - Cache structures no processor node reaches, directly or through
+    NextLevelOfCache, are dropped.
+  - Identical cache structures (same bytes, same next level once shared)
+    become one, unless a processor node references both: the structures
+    then stand for different caches of that node (e.g. untyped L1I and
+    L1D). Sharing is what the spec allows: without a valid cache ID a cache
+    structure describes a cache private to each node referencing it, and
+    identical structures with a valid cache ID already name the same cache.
+
+  Other structures (ID, unknown types) are copied as they are. The header
+  is kept, Length and Checksum are fixed by acpigen_finalize().
+*/
+
+typedef struct {
+  uint32_t sizeBefore;
+  uint32_t sizeAfter;
+  uint32_t cachesBefore;
+  uint32_t cachesAfter;
+  uint32_t sharedCaches;      // Structures merged into an identical one
+  uint32_t unreachableCaches; // Structures no processor node reaches
+  uint32_t packedBytes;       // Unused private resource slots and padding
+} PpttOptimizeStats;
+
+int pptt_optimize(const uint8_t *pptt, size_t size, AcpiArena *arena,
+                  const uint8_t **table, size_t *length,
+                  PpttOptimizeStats *stats);
@@ -0,0 +1,32 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_DIGEST_SIZE 32
+#define SHA256_BLOCK_SIZE 64
+
+//
+// Streaming SHA-256 context (FIPS 180-4).
+//
+typedef struct {
+  uint32_t state[8];
+  uint64_t length; // Total bytes hashed
+  uint8_t block[SHA256_BLOCK_SIZE];
+  size_t blockUsed;
+} Sha256Context;
+
+void sha256_init(Sha256Context *ctx);
+void sha256_update(Sha256Context *ctx, const void *data, size_t length);
+void sha256_final(Sha256Context *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+void sha256(const void *data, size_t length,
+            uint8_t digest[SHA256_DIGEST_SIZE]);
+void sha256_to_hex(const uint8_t digest[SHA256_DIGEST_SIZE],
+                   char hex[SHA256_DIGEST_SIZE * 2 + 1]);
@@ -0,0 +1,32 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Environment variable naming the span file, tracing is off when unset
+#define TRACE_FILE_ENV "ACPI_TRACE_FILE"
+
+//
+// One timed pipeline stage, wall clock microseconds since the epoch so
+// spans of different processes share a time base.
+//
+typedef struct {
+  uint64_t startUs;
+  uint64_t endUs;
+} TraceSpan;
+
+bool trace_enabled(void);
+uint64_t trace_now_us(void);
+void trace_begin(TraceSpan *span);
+void trace_end(TraceSpan *span);
+int trace_write(const TraceSpan *span, const char *tool, const char *device,
+                const char *table, const char *stage, uint64_t bytes);
+const char *trace_device_of(const char *path, char *buffer, size_t size);
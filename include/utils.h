@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <time.h>
 
 #define EBADF 9   // Bad file descriptor
 #define EINVAL 22 // Invalid argument
@@ -38,8 +39,23 @@ typedef struct {
 size_t get_file_size(FileContent *fileContent);
 uint8_t *read_file_content(FileContent *fileContent);
 int write_file_content(pFileContent fileContent);
+uint16_t read_le16(const uint8_t *base, size_t offset);
+uint32_t read_le32(const uint8_t *base, size_t offset);
+uint64_t read_le64(const uint8_t *base, size_t offset);
 uint8_t checksum(uint8_t *buffer, size_t length);
+bool table_has_checksum(const char *signature);
 bool is_directory(const char *path);
+int read_table_directory(const char *dir, FileContent **tables, size_t *count);
+void free_table_directory(FileContent *tables, size_t count);
+double elapsed_ms(const struct timespec *start);
+int compare_names(const void *a, const void *b);
+size_t list_names(const char *dir, const char *suffix, char ***names);
+size_t list_devices(const char *build_dir, char ***names);
+void free_names(char **names, size_t count);
+int locate_table_in_binary(const uint8_t *buffer, size_t size,
+                           size_t *offset, size_t *length);
+int locate_qcom_table_in_binary(const uint8_t *buffer, size_t size,
+                                size_t *offset);
 
 #define LOG_COLOR_RESET "\x1b[0m"
 #define LOG_COLOR_INFO "\x1b[97m"         /* bright white */
@@ -0,0 +1,1449 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "acpi_dump.h"
+#include "utils.h"
+#include <acpi.h>
+#include <string.h>
+
+/**
+ * Field kinds, a table is described as a list of fields laid out back to
+ * back, like the ACPI_DMTABLE_INFO lists of iasl.
+ */
+enum ACPI_DUMP_KIND {
+    ACPI_DUMP_END = 0,
+    ACPI_DUMP_UINT8,
+    ACPI_DUMP_UINT16,
+    ACPI_DUMP_UINT24,
+    ACPI_DUMP_UINT32,
+    ACPI_DUMP_UINT64,
+    ACPI_DUMP_NAME4,
+    ACPI_DUMP_NAME6,
+    ACPI_DUMP_NAME8,
+    ACPI_DUMP_SIGNATURE,
+    ACPI_DUMP_CHECKSUM,
+    ACPI_DUMP_GAS,
+    ACPI_DUMP_FLAG, // Bits of the previous integer field, takes no bytes
+};
+
+static const uint8_t dump_kind_size[] = {
+    [ACPI_DUMP_UINT8] = 1,     [ACPI_DUMP_UINT16] = 2,
+    [ACPI_DUMP_UINT24] = 3,    [ACPI_DUMP_UINT32] = 4,
+    [ACPI_DUMP_UINT64] = 8,    [ACPI_DUMP_NAME4] = 4,
+    [ACPI_DUMP_NAME6] = 6,     [ACPI_DUMP_NAME8] = 8,
+    [ACPI_DUMP_SIGNATURE] = 4, [ACPI_DUMP_CHECKSUM] = 1,
+    [ACPI_DUMP_GAS] = 12,      [ACPI_DUMP_FLAG] = 0,
+};
+
+// Value names of an enumerated field, terminated by a NULL name
+typedef struct {
+    uint32_t value;
+    const char *name;
+} AcpiDumpName;
+
+typedef struct {
+    uint8_t kind;  // enum ACPI_DUMP_KIND
+    uint8_t bit;   // First bit, ACPI_DUMP_FLAG only
+    uint8_t width; // Bit count, ACPI_DUMP_FLAG only
+    const char *name;
+    const AcpiDumpName *names; // Printed after the value, or NULL
+} AcpiDumpField;
+
+#define DUMP_FIELD(kind, name) {kind, 0, 0, name, NULL}
+#define DUMP_UINT8(name) DUMP_FIELD(ACPI_DUMP_UINT8, name)
+#define DUMP_UINT16(name) DUMP_FIELD(ACPI_DUMP_UINT16, name)
+#define DUMP_UINT24(name) DUMP_FIELD(ACPI_DUMP_UINT24, name)
+#define DUMP_UINT32(name) DUMP_FIELD(ACPI_DUMP_UINT32, name)
+#define DUMP_UINT64(name) DUMP_FIELD(ACPI_DUMP_UINT64, name)
+#define DUMP_NAME4(name) DUMP_FIELD(ACPI_DUMP_NAME4, name)
+#define DUMP_NAME6(name) DUMP_FIELD(ACPI_DUMP_NAME6, name)
+#define DUMP_NAME8(name) DUMP_FIELD(ACPI_DUMP_NAME8, name)
+#define DUMP_GAS(name) DUMP_FIELD(ACPI_DUMP_GAS, name)
+#define DUMP_ENUM8(name, names) {ACPI_DUMP_UINT8, 0, 0, name, names}
+#define DUMP_ENUM16(name, names) {ACPI_DUMP_UINT16, 0, 0, name, names}
+#define DUMP_FLAG(bit, name) {ACPI_DUMP_FLAG, bit, 1, name, NULL}
+#define DUMP_FLAGS(bit, width, name) {ACPI_DUMP_FLAG, bit, width, name, NULL}
+#define DUMP_END DUMP_FIELD(ACPI_DUMP_END, NULL)
+
+typedef struct {
+    FILE *out;
+    const uint8_t *table;
+    uint32_t length; // Dumped length, header length bounded by the file
+    uint8_t sum;     // Byte sum of the table, 0 if checksum is correct
+    const char *description; // Printed after the signature
+    uint64_t flags;          // Last integer field, decoded by ACPI_DUMP_FLAG
+    bool flagsValid;
+} AcpiDumper;
+
+static uint64_t read_value(const uint8_t *buffer, uint32_t size) {
+    uint64_t value = 0;
+
+    for (uint32_t i = size; i > 0; i--)
+        value = (value << 8) | buffer[i - 1];
+    return value;
+}
+
+static uint32_t dump_read(const AcpiDumper *d, uint32_t offset,
+                          uint32_t size) {
+    if (offset > d->length || size > d->length - offset)
+        return 0;
+    return (uint32_t)read_value(d->table + offset, size);
+}
+
+static const char *lookup_name(const AcpiDumpName *names, uint64_t value) {
+    for (; names->name != NULL; names++) {
+        if (names->value == value)
+            return names->name;
+    }
+    return "Reserved";
+}
+
+static void line_header(AcpiDumper *d, uint32_t offset, uint32_t length,
+                        const char *name) {
+    fprintf(d->out, "[%3.3Xh %4.4u %3.3Xh] %27s : ", offset, offset, length,
+            name);
+}
+
+static const AcpiDumpName gas_space_names[] = {
+    {0x00, "SystemMemory"},
+    {0x01, "SystemIO"},
+    {0x02, "PCI_Config"},
+    {0x03, "EmbeddedControl"},
+    {0x04, "SMBus"},
+    {0x05, "SystemCMOS"},
+    {0x06, "PCIBARTarget"},
+    {0x07, "IPMI"},
+    {0x08, "GeneralPurposeIo"},
+    {0x09, "GenericSerialBus"},
+    {0x0A, "PCC"},
+    {0x0B, "PlatformRtMechanism"},
+    {0x7F, "FunctionalFixedHW"},
+    {0, NULL},
+};
+
+static const AcpiDumpName gas_access_names[] = {
+    {0, "Undefined/Legacy"}, {1, "Byte Access:8"},   {2, "Word Access:16"},
+    {3, "DWord Access:32"},  {4, "QWord Access:64"}, {0, NULL},
+};
+
+static const AcpiDumpField gas_fields[] = {
+    DUMP_ENUM8("Space ID", gas_space_names),
+    DUMP_UINT8("Bit Width"),
+    DUMP_UINT8("Bit Offset"),
+    DUMP_ENUM8("Encoded Access Width", gas_access_names),
+    DUMP_UINT64("Address"),
+    DUMP_END,
+};
+
+/**
+ * Print fields laid out back to back from offset.
+ *
+ * Printing stops at the first field not fitting before end, so optional
+ * trailing fields (e.g. GICC TRBE Interrupt) only show up when present.
+ *
+ * @param d       Dumper state.
+ * @param offset  Offset of the first field from the table start.
+ * @param end     Offset where the enclosing structure ends.
+ * @param fields  Field list terminated by DUMP_END.
+ *
+ * @retval        Offset right after the last printed field.
+ */
+static uint32_t dump_fields(AcpiDumper *d, uint32_t offset, uint32_t end,
+                            const AcpiDumpField *fields) {
+    const uint8_t *data;
+    uint32_t size;
+    uint64_t value;
+
+    if (end > d->length)
+        end = d->length;
+
+    for (; fields->kind != ACPI_DUMP_END; fields++) {
+        if (fields->kind == ACPI_DUMP_FLAG) {
+            if (d->flagsValid) {
+                value = (d->flags >> fields->bit) &
+                        ((1ULL << fields->width) - 1);
+                fprintf(d->out, "%44s : %.*X\n", fields->name,
+                        (fields->width + 3) / 4, (unsigned int)value);
+            }
+            continue;
+        }
+
+        size = dump_kind_size[fields->kind];
+        if (offset > end || size > end - offset) {
+            d->flagsValid = false;
+            break;
+        }
+
+        data = d->table + offset;
+        value = read_value(data, size);
+        line_header(d, offset, size, fields->name);
+        switch (fields->kind) {
+        case ACPI_DUMP_UINT8:
+            fprintf(d->out, "%2.2X", (unsigned int)value);
+            break;
+        case ACPI_DUMP_UINT16:
+            fprintf(d->out, "%4.4X", (unsigned int)value);
+            break;
+        case ACPI_DUMP_UINT24:
+            fprintf(d->out, "%6.6X", (unsigned int)value);
+            break;
+        case ACPI_DUMP_UINT32:
+            fprintf(d->out, "%8.8X", (unsigned int)value);
+            break;
+        case ACPI_DUMP_UINT64:
+            fprintf(d->out, "%8.8X%8.8X", (unsigned int)(value >> 32),
+                    (unsigned int)value);
+            break;
+        case ACPI_DUMP_NAME4:
+        case ACPI_DUMP_NAME6:
+        case ACPI_DUMP_NAME8:
+            fprintf(d->out, "\"%.*s\"", (int)size, (const char *)data);
+            break;
+        case ACPI_DUMP_SIGNATURE:
+            fprintf(d->out, "\"%.4s\"", (const char *)data);
+            if (d->description != NULL)
+                fprintf(d->out, "    [%s]", d->description);
+            break;
+        case ACPI_DUMP_CHECKSUM:
+            fprintf(d->out, "%2.2X", (unsigned int)value);
+            if (d->sum != 0)
+                fprintf(d->out,
+                        "     /* Incorrect checksum, should be %2.2X */",
+                        (uint8_t)(value - d->sum));
+            break;
+        case ACPI_DUMP_GAS:
+            fprintf(d->out, "[Generic Address Structure]\n");
+            dump_fields(d, offset, offset + size, gas_fields);
+            break;
+        default:
+            break;
+        }
+        if (fields->names != NULL)
+            fprintf(d->out, " [%s]", lookup_name(fields->names, value));
+        fputc('\n', d->out);
+
+        d->flags = value;
+        d->flagsValid = fields->kind != ACPI_DUMP_GAS;
+        offset += size;
+    }
+    return offset;
+}
+
+static void dump_buffer(AcpiDumper *d, uint32_t offset, uint32_t length,
+                        const char *name) {
+    if (length == 0 || offset > d->length || length > d->length - offset)
+        return;
+
+    line_header(d, offset, length, name);
+    for (uint32_t i = 0; i < length; i++) {
+        if (i != 0 && i % 16 == 0)
+            fprintf(d->out, "\n%47s", "");
+        fprintf(d->out, "%2.2X", d->table[offset + i]);
+        if (i + 1 < length && (i + 1) % 16 != 0)
+            fputc(' ', d->out);
+    }
+    fputc('\n', d->out);
+}
+
+// Print a NUL terminated string field, returns the bytes it used
+static uint32_t dump_string(AcpiDumper *d, uint32_t offset, uint32_t length,
+                            const char *name) {
+    const char *string;
+    uint32_t used;
+
+    if (length == 0 || offset > d->length || length > d->length - offset)
+        return 0;
+
+    string = (const char *)d->table + offset;
+    used = (uint32_t)strnlen(string, length);
+    if (used < length)
+        used++;
+    line_header(d, offset, used, name);
+    fprintf(d->out, "\"%.*s\"\n", (int)strnlen(string, used), string);
+    return used;
+}
+
+/* Subtable streams: typed structures with a length field */
+
+// Variable part after the fixed fields of a subtable
+typedef void (*AcpiDumpExtra)(AcpiDumper *d, uint32_t start,
+                              uint32_t fields_end, uint32_t end);
+
+typedef struct {
+    uint32_t type;
+    const AcpiDumpField *fields; // After the common subtable header
+    AcpiDumpExtra extra;         // NULL if the subtable has a fixed size
+} AcpiDumpSubtable;
+
+typedef struct {
+    const AcpiDumpField *header; // Common subtable header
+    uint32_t headerSize;
+    uint32_t typeSize;     // Type is the first field
+    uint32_t lengthOffset; // Length field inside the subtable
+    uint32_t lengthSize;
+    const AcpiDumpSubtable *subtables;
+    size_t subtableCount;
+} AcpiDumpStream;
+
+#define ARRAY_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+static void dump_stream(AcpiDumper *d, uint32_t offset, uint32_t end,
+                        const AcpiDumpStream *stream) {
+    const AcpiDumpSubtable *subtable;
+    uint32_t type, length, next;
+
+    if (end > d->length)
+        end = d->length;
+
+    while (offset < end && stream->headerSize <= end - offset) {
+        type = dump_read(d, offset, stream->typeSize);
+        length =
+            dump_read(d, offset + stream->lengthOffset, stream->lengthSize);
+
+        fputc('\n', d->out);
+        if (length < stream->headerSize || length > end - offset) {
+            // Stop here, the raw table data shows the remaining bytes
+            dump_fields(d, offset, end, stream->header);
+            return;
+        }
+
+        next = dump_fields(d, offset, offset + length, stream->header);
+        subtable = NULL;
+        for (size_t i = 0; i < stream->subtableCount; i++) {
+            if (stream->subtables[i].type == type) {
+                subtable = &stream->subtables[i];
+                break;
+            }
+        }
+
+        if (subtable == NULL) {
+            dump_buffer(d, next, offset + length - next, "Data");
+        } else {
+            next = dump_fields(d, next, offset + length, subtable->fields);
+            if (subtable->extra != NULL)
+                subtable->extra(d, offset, next, offset + length);
+        }
+        offset += length;
+    }
+}
+
+// Print an array of fixed size entries, a blank line before each entry
+static void dump_array(AcpiDumper *d, uint32_t offset, uint32_t count,
+                       uint32_t entry_size, uint32_t end,
+                       const AcpiDumpField *fields) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (offset + entry_size > end || offset + entry_size < offset)
+            return;
+        fputc('\n', d->out);
+        dump_fields(d, offset, offset + entry_size, fields);
+        offset += entry_size;
+    }
+}
+
+// Print an array of single field entries without separators
+static void dump_list(AcpiDumper *d, uint32_t offset, uint32_t count,
+                      uint32_t end, const AcpiDumpField *field) {
+    uint32_t size = dump_kind_size[field->kind];
+
+    for (uint32_t i = 0; i < count && offset + size <= end; i++)
+        offset = dump_fields(d, offset, end, field);
+}
+
+/* Standard header */
+static const AcpiDumpField header_fields[] = {
+    DUMP_FIELD(ACPI_DUMP_SIGNATURE, "Signature"),
+    DUMP_UINT32("Table Length"),
+    DUMP_UINT8("Revision"),
+    DUMP_FIELD(ACPI_DUMP_CHECKSUM, "Checksum"),
+    DUMP_NAME6("Oem ID"),
+    DUMP_NAME8("Oem Table ID"),
+    DUMP_UINT32("Oem Revision"),
+    DUMP_NAME4("Asl Compiler ID"),
+    DUMP_UINT32("Asl Compiler Revision"),
+    DUMP_END,
+};
+
+/* MADT */
+static const AcpiDumpField madt_fields[] = {
+    DUMP_UINT32("Local Apic Address"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "PC-AT Compatibility"),
+    DUMP_END,
+};
+
+static const AcpiDumpName madt_subtable_names[] = {
+    {0x00, "Processor Local APIC"},
+    {0x01, "I/O APIC"},
+    {0x02, "Interrupt Source Override"},
+    {0x03, "NMI Source"},
+    {0x04, "Local APIC NMI"},
+    {0x05, "Local APIC Address Override"},
+    {0x06, "I/O SAPIC"},
+    {0x07, "Local SAPIC"},
+    {0x08, "Platform Interrupt Sources"},
+    {0x09, "Processor Local x2APIC"},
+    {0x0A, "Local x2APIC NMI"},
+    {0x0B, "Generic Interrupt Controller"},
+    {0x0C, "Generic Interrupt Distributor"},
+    {0x0D, "Generic MSI Frame"},
+    {0x0E, "Generic Interrupt Redistributor"},
+    {0x0F, "Generic Interrupt Translator"},
+    {0, NULL},
+};
+
+static const AcpiDumpField madt_header_fields[] = {
+    DUMP_ENUM8("Subtable Type", madt_subtable_names),
+    DUMP_UINT8("Length"),
+    DUMP_END,
+};
+
+static const AcpiDumpField madt_gicc_fields[] = {
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("CPU Interface Number"),
+    DUMP_UINT32("Processor UID"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "Processor Enabled"),
+    DUMP_FLAG(1, "Performance Interrupt Trigger Mode"),
+    DUMP_FLAG(2, "Virtual GIC Interrupt Trigger Mode"),
+    DUMP_FLAG(3, "Online Capable"),
+    DUMP_FLAG(4, "GICR non-coherent"),
+    DUMP_UINT32("Parking Protocol Version"),
+    DUMP_UINT32("Performance Interrupt"),
+    DUMP_UINT64("Parked Address"),
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT64("Virtual GIC Base Address"),
+    DUMP_UINT64("Hypervisor GIC Base Address"),
+    DUMP_UINT32("Virtual GIC Interrupt"),
+    DUMP_UINT64("Redistributor Base Address"),
+    DUMP_UINT64("ARM MPIDR"),
+    DUMP_UINT8("Efficiency Class"),
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT16("SPE Overflow Interrupt"),
+    DUMP_UINT16("TRBE Interrupt"),
+    DUMP_END,
+};
+
+static const AcpiDumpField madt_gicd_fields[] = {
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("Local GIC Hardware ID"),
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT32("Interrupt Base"),
+    DUMP_UINT8("Version"),
+    DUMP_UINT24("Reserved"),
+    DUMP_END,
+};
+
+static const AcpiDumpField madt_gic_msi_frame_fields[] = {
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("Generic MSI Frame ID"),
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "Select SPI"),
+    DUMP_UINT16("SPI Count"),
+    DUMP_UINT16("SPI Base"),
+    DUMP_END,
+};
+
+static const AcpiDumpField madt_gicr_fields[] = {
+    DUMP_UINT8("Flags (decoded below)"),
+    DUMP_FLAG(0, "GICR non-coherent"),
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT32("Length"),
+    DUMP_END,
+};
+
+static const AcpiDumpField madt_gic_its_fields[] = {
+    DUMP_UINT8("Flags (decoded below)"),
+    DUMP_FLAG(0, "GIC ITS non-coherent"),
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT32("Translation ID"),
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT32("Reserved"),
+    DUMP_END,
+};
+
+static const AcpiDumpSubtable madt_subtables[] = {
+    {0x0B, madt_gicc_fields, NULL},
+    {0x0C, madt_gicd_fields, NULL},
+    {0x0D, madt_gic_msi_frame_fields, NULL},
+    {0x0E, madt_gicr_fields, NULL},
+    {0x0F, madt_gic_its_fields, NULL},
+};
+
+static const AcpiDumpStream madt_stream = {
+    madt_header_fields, 2, 1, 1, 1, madt_subtables, ARRAY_COUNT(madt_subtables),
+};
+
+static void dump_madt(AcpiDumper *d, uint32_t offset) {
+    dump_stream(d, offset, d->length, &madt_stream);
+}
+
+/* PPTT */
+static const AcpiDumpName pptt_subtable_names[] = {
+    {0, "Processor Hierarchy Node"},
+    {1, "Cache Type"},
+    {2, "ID"},
+    {0, NULL},
+};
+
+static const AcpiDumpField pptt_header_fields[] = {
+    DUMP_ENUM8("Subtable Type", pptt_subtable_names),
+    DUMP_UINT8("Length"),
+    DUMP_END,
+};
+
+static const AcpiDumpField pptt_processor_fields[] = {
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "Physical package"),
+    DUMP_FLAG(1, "ACPI Processor ID valid"),
+    DUMP_FLAG(2, "Processor is a thread"),
+    DUMP_FLAG(3, "Node is a leaf"),
+    DUMP_FLAG(4, "Identical Implementation"),
+    DUMP_UINT32("Parent"),
+    DUMP_UINT32("ACPI Processor ID"),
+    DUMP_UINT32("Private Resource Number"),
+    DUMP_END,
+};
+
+static const AcpiDumpField pptt_private_resource_field[] = {
+    DUMP_UINT32("Private Resource"),
+    DUMP_END,
+};
+
+static const AcpiDumpField pptt_cache_fields[] = {
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "Size valid"),
+    DUMP_FLAG(1, "Number of Sets valid"),
+    DUMP_FLAG(2, "Associativity valid"),
+    DUMP_FLAG(3, "Allocation Type valid"),
+    DUMP_FLAG(4, "Cache Type valid"),
+    DUMP_FLAG(5, "Write Policy valid"),
+    DUMP_FLAG(6, "Line Size valid"),
+    DUMP_FLAG(7, "Cache ID valid"),
+    DUMP_UINT32("Next Level of Cache"),
+    DUMP_UINT32("Size"),
+    DUMP_UINT32("Number of Sets"),
+    DUMP_UINT8("Associativity"),
+    DUMP_UINT8("Attributes"),
+    DUMP_FLAGS(0, 2, "Allocation Type"),
+    DUMP_FLAGS(2, 2, "Cache Type"),
+    DUMP_FLAG(4, "Write Policy"),
+    DUMP_UINT16("Line Size"),
+    DUMP_UINT32("Cache ID"),
+    DUMP_END,
+};
+
+static const AcpiDumpField pptt_id_fields[] = {
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("VENDOR_ID"),
+    DUMP_UINT64("LEVEL_1_ID"),
+    DUMP_UINT64("LEVEL_2_ID"),
+    DUMP_UINT16("MAJOR_REV"),
+    DUMP_UINT16("MINOR_REV"),
+    DUMP_UINT16("SPIN_REV"),
+    DUMP_END,
+};
+
+// Private resources follow the processor node, count at offset 16
+static void dump_pptt_processor(AcpiDumper *d, uint32_t start,
+                                uint32_t fields_end, uint32_t end) {
+    dump_list(d, fields_end, dump_read(d, start + 16, 4), end,
+              pptt_private_resource_field);
+}
+
+static const AcpiDumpSubtable pptt_subtables[] = {
+    {0, pptt_processor_fields, dump_pptt_processor},
+    {1, pptt_cache_fields, NULL},
+    {2, pptt_id_fields, NULL},
+};
+
+static const AcpiDumpStream pptt_stream = {
+    pptt_header_fields, 2, 1, 1, 1, pptt_subtables, ARRAY_COUNT(pptt_subtables),
+};
+
+static void dump_pptt(AcpiDumper *d, uint32_t offset) {
+    dump_stream(d, offset, d->length, &pptt_stream);
+}
+
+/* GTDT */
+#define GTDT_TIMER_FLAGS                                                       \
+    DUMP_FLAG(0, "Trigger Mode"), DUMP_FLAG(1, "Polarity"),                    \
+        DUMP_FLAG(2, "Always On")
+
+static const AcpiDumpField gtdt_fields[] = {
+    DUMP_UINT64("Counter Block Address"),
+    DUMP_UINT32("Reserved"),
+    DUMP_UINT32("Secure EL1 Interrupt"),
+    DUMP_UINT32("EL1 Flags (decoded below)"),
+    GTDT_TIMER_FLAGS,
+    DUMP_UINT32("Non-Secure EL1 Interrupt"),
+    DUMP_UINT32("NEL1 Flags (decoded below)"),
+    GTDT_TIMER_FLAGS,
+    DUMP_UINT32("Virtual Timer Interrupt"),
+    DUMP_UINT32("VTimer Flags (decoded below)"),
+    GTDT_TIMER_FLAGS,
+    DUMP_UINT32("Non-Secure EL2 Interrupt"),
+    DUMP_UINT32("NEL2 Flags (decoded below)"),
+    GTDT_TIMER_FLAGS,
+    DUMP_UINT64("Counter Read Block Address"),
+    DUMP_UINT32("Platform Timer Count"),
+    DUMP_UINT32("Platform Timer Offset"),
+    DUMP_END,
+};
+
+static const AcpiDumpField gtdt_el2_fields[] = {
+    DUMP_UINT32("Virtual EL2 Timer GSIV"),
+    DUMP_UINT32("Virtual EL2 Timer Flags"),
+    GTDT_TIMER_FLAGS,
+    DUMP_END,
+};
+
+static const AcpiDumpName gtdt_subtable_names[] = {
+    {0, "Generic Timer Block"},
+    {1, "Generic Watchdog Timer"},
+    {0, NULL},
+};
+
+static const AcpiDumpField gtdt_header_fields[] = {
+    DUMP_ENUM8("Subtable Type", gtdt_subtable_names),
+    DUMP_UINT16("Length"),
+    DUMP_END,
+};
+
+static const AcpiDumpField gtdt_block_fields[] = {
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT64("Block Address"),
+    DUMP_UINT32("Timer Count"),
+    DUMP_UINT32("Timer Offset"),
+    DUMP_END,
+};
+
+static const AcpiDumpField gtdt_block_timer_fields[] = {
+    DUMP_UINT8("Frame Number"),
+    DUMP_UINT24("Reserved"),
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT64("EL0 Base Address"),
+    DUMP_UINT32("Timer Interrupt"),
+    DUMP_UINT32("Timer Flags (decoded below)"),
+    DUMP_FLAG(0, "Trigger Mode"),
+    DUMP_FLAG(1, "Polarity"),
+    DUMP_UINT32("Virtual Timer Interrupt"),
+    DUMP_UINT32("Virtual Timer Flags (decoded below)"),
+    DUMP_FLAG(0, "Trigger Mode"),
+    DUMP_FLAG(1, "Polarity"),
+    DUMP_UINT32("Common Flags (decoded below)"),
+    DUMP_FLAG(0, "Secure"),
+    DUMP_FLAG(1, "Always On"),
+    DUMP_END,
+};
+
+static const AcpiDumpField gtdt_watchdog_fields[] = {
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT64("Refresh Frame Address"),
+    DUMP_UINT64("Control Frame Address"),
+    DUMP_UINT32("Timer Interrupt"),
+    DUMP_UINT32("Timer Flags (decoded below)"),
+    DUMP_FLAG(0, "Trigger Mode"),
+    DUMP_FLAG(1, "Polarity"),
+    DUMP_FLAG(2, "Security"),
+    DUMP_END,
+};
+
+// Timers of a block, count at offset 12 and offset at 16 of the block
+static void dump_gtdt_block(AcpiDumper *d, uint32_t start,
+                            uint32_t fields_end, uint32_t end) {
+    (void)fields_end;
+    dump_array(d, start + dump_read(d, start + 16, 4),
+               dump_read(d, start + 12, 4), 40, end, gtdt_block_timer_fields);
+}
+
+static const AcpiDumpSubtable gtdt_subtables[] = {
+    {0, gtdt_block_fields, dump_gtdt_block},
+    {1, gtdt_watchdog_fields, NULL},
+};
+
+static const AcpiDumpStream gtdt_stream = {
+    gtdt_header_fields, 3, 1, 1, 2, gtdt_subtables, ARRAY_COUNT(gtdt_subtables),
+};
+
+// Platform timers follow, count and offset are the last fixed fields
+static void dump_gtdt(AcpiDumper *d, uint32_t offset) {
+    uint32_t timer_count = dump_read(d, offset - 8, 4);
+    uint32_t timer_offset = dump_read(d, offset - 4, 4);
+
+    if (d->table[8] >= 3)
+        dump_fields(d, offset, d->length, gtdt_el2_fields);
+    if (timer_count != 0 && timer_offset != 0)
+        dump_stream(d, timer_offset, d->length, &gtdt_stream);
+}
+
+/* FADT */
+static const AcpiDumpName fadt_profile_names[] = {
+    {0, "Unspecified"},       {1, "Desktop"},
+    {2, "Mobile"},            {3, "Workstation"},
+    {4, "Enterprise Server"}, {5, "SOHO Server"},
+    {6, "Appliance PC"},      {7, "Performance Server"},
+    {8, "Tablet"},            {0, NULL},
+};
+
+static const AcpiDumpField fadt_fields[] = {
+    DUMP_UINT32("FACS Address"),
+    DUMP_UINT32("DSDT Address"),
+    DUMP_UINT8("Model"),
+    DUMP_ENUM8("PM Profile", fadt_profile_names),
+    DUMP_UINT16("SCI Interrupt"),
+    DUMP_UINT32("SMI Command Port"),
+    DUMP_UINT8("ACPI Enable Value"),
+    DUMP_UINT8("ACPI Disable Value"),
+    DUMP_UINT8("S4BIOS Command"),
+    DUMP_UINT8("P-State Control"),
+    DUMP_UINT32("PM1A Event Block Address"),
+    DUMP_UINT32("PM1B Event Block Address"),
+    DUMP_UINT32("PM1A Control Block Address"),
+    DUMP_UINT32("PM1B Control Block Address"),
+    DUMP_UINT32("PM2 Control Block Address"),
+    DUMP_UINT32("PM Timer Block Address"),
+    DUMP_UINT32("GPE0 Block Address"),
+    DUMP_UINT32("GPE1 Block Address"),
+    DUMP_UINT8("PM1 Event Block Length"),
+    DUMP_UINT8("PM1 Control Block Length"),
+    DUMP_UINT8("PM2 Control Block Length"),
+    DUMP_UINT8("PM Timer Block Length"),
+    DUMP_UINT8("GPE0 Block Length"),
+    DUMP_UINT8("GPE1 Block Length"),
+    DUMP_UINT8("GPE1 Base Offset"),
+    DUMP_UINT8("_CST Support"),
+    DUMP_UINT16("C2 Latency"),
+    DUMP_UINT16("C3 Latency"),
+    DUMP_UINT16("CPU Cache Size"),
+    DUMP_UINT16("Cache Flush Stride"),
+    DUMP_UINT8("Duty Cycle Offset"),
+    DUMP_UINT8("Duty Cycle Width"),
+    DUMP_UINT8("RTC Day Alarm Index"),
+    DUMP_UINT8("RTC Month Alarm Index"),
+    DUMP_UINT8("RTC Century Index"),
+    DUMP_UINT16("Boot Flags (decoded below)"),
+    DUMP_FLAG(0, "Legacy Devices Supported (V2)"),
+    DUMP_FLAG(1, "8042 Present on ports 60/64 (V2)"),
+    DUMP_FLAG(2, "VGA Not Present (V4)"),
+    DUMP_FLAG(3, "MSI Not Supported (V4)"),
+    DUMP_FLAG(4, "PCIe ASPM Not Supported (V4)"),
+    DUMP_FLAG(5, "CMOS RTC Not Present (V5)"),
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "WBINVD instruction is operational (V1)"),
+    DUMP_FLAG(1, "WBINVD flushes all caches (V1)"),
+    DUMP_FLAG(2, "All CPUs support C1 (V1)"),
+    DUMP_FLAG(3, "C2 works on MP system (V1)"),
+    DUMP_FLAG(4, "Control Method Power Button (V1)"),
+    DUMP_FLAG(5, "Control Method Sleep Button (V1)"),
+    DUMP_FLAG(6, "RTC wake not in fixed reg space (V1)"),
+    DUMP_FLAG(7, "RTC can wake system from S4 (V1)"),
+    DUMP_FLAG(8, "32-bit PM Timer (V1)"),
+    DUMP_FLAG(9, "Docking Supported (V1)"),
+    DUMP_FLAG(10, "Reset Register Supported (V2)"),
+    DUMP_FLAG(11, "Sealed Case (V3)"),
+    DUMP_FLAG(12, "Headless - No Video (V3)"),
+    DUMP_FLAG(13, "Use native instr after SLP_TYPx (V3)"),
+    DUMP_FLAG(14, "PCIEXP_WAK Bits Supported (V4)"),
+    DUMP_FLAG(15, "Use Platform Timer (V4)"),
+    DUMP_FLAG(16, "RTC_STS valid on S4 wake (V4)"),
+    DUMP_FLAG(17, "Remote Power-on capable (V4)"),
+    DUMP_FLAG(18, "Use APIC Cluster Model (V4)"),
+    DUMP_FLAG(19, "Use APIC Physical Destination Mode (V4)"),
+    DUMP_FLAG(20, "Hardware Reduced (V5)"),
+    DUMP_FLAG(21, "Low Power S0 Idle (V5)"),
+    DUMP_GAS("Reset Register"),
+    DUMP_UINT8("Value to cause reset"),
+    DUMP_UINT16("ARM Flags (decoded below)"),
+    DUMP_FLAG(0, "PSCI Compliant"),
+    DUMP_FLAG(1, "Must use HVC for PSCI"),
+    DUMP_UINT8("FADT Minor Revision"),
+    DUMP_UINT64("FACS Address"),
+    DUMP_UINT64("DSDT Address"),
+    DUMP_GAS("PM1A Event Block"),
+    DUMP_GAS("PM1B Event Block"),
+    DUMP_GAS("PM1A Control Block"),
+    DUMP_GAS("PM1B Control Block"),
+    DUMP_GAS("PM2 Control Block"),
+    DUMP_GAS("PM Timer Block"),
+    DUMP_GAS("GPE0 Block"),
+    DUMP_GAS("GPE1 Block"),
+    DUMP_GAS("Sleep Control Register"),
+    DUMP_GAS("Sleep Status Register"),
+    DUMP_UINT64("Hypervisor ID"),
+    DUMP_END,
+};
+
+/* FACS, no standard header */
+static const AcpiDumpField facs_fields[] = {
+    DUMP_NAME4("Signature"),
+    DUMP_UINT32("Length"),
+    DUMP_UINT32("Hardware Signature"),
+    DUMP_UINT32("32 Firmware Waking Vector"),
+    DUMP_UINT32("Global Lock"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "S4BIOS Support Present"),
+    DUMP_FLAG(1, "64-bit Wake Supported (V2)"),
+    DUMP_UINT64("64 Firmware Waking Vector"),
+    DUMP_UINT8("Version"),
+    DUMP_UINT24("Reserved"),
+    DUMP_UINT32("OspmFlags (decoded below)"),
+    DUMP_FLAG(0, "64-bit Wake Env Required (V2)"),
+    DUMP_END,
+};
+
+/* MCFG */
+static const AcpiDumpField mcfg_fields[] = {
+    DUMP_UINT64("Reserved"),
+    DUMP_END,
+};
+
+static const AcpiDumpField mcfg_allocation_fields[] = {
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT16("Segment Group Number"),
+    DUMP_UINT8("Start Bus Number"),
+    DUMP_UINT8("End Bus Number"),
+    DUMP_UINT32("Reserved"),
+    DUMP_END,
+};
+
+static void dump_mcfg(AcpiDumper *d, uint32_t offset) {
+    dump_array(d, offset, (d->length - offset) / 16, 16, d->length,
+               mcfg_allocation_fields);
+}
+
+/* SPCR */
+static const AcpiDumpField spcr_fields[] = {
+    DUMP_UINT8("Interface Type"),
+    DUMP_UINT24("Reserved"),
+    DUMP_GAS("Serial Port Register"),
+    DUMP_UINT8("Interrupt Type"),
+    DUMP_UINT8("PCAT-compatible IRQ"),
+    DUMP_UINT32("Interrupt"),
+    DUMP_UINT8("Baud Rate"),
+    DUMP_UINT8("Parity"),
+    DUMP_UINT8("Stop Bits"),
+    DUMP_UINT8("Flow Control"),
+    DUMP_UINT8("Terminal Type"),
+    DUMP_UINT8("Language"),
+    DUMP_UINT16("PCI Device ID"),
+    DUMP_UINT16("PCI Vendor ID"),
+    DUMP_UINT8("PCI Bus"),
+    DUMP_UINT8("PCI Device"),
+    DUMP_UINT8("PCI Function"),
+    DUMP_UINT32("PCI Flags"),
+    DUMP_UINT8("PCI Segment"),
+    DUMP_END,
+};
+
+static const AcpiDumpField spcr2_fields[] = {
+    DUMP_UINT32("Reserved"),
+    DUMP_END,
+};
+
+static const AcpiDumpField spcr4_fields[] = {
+    DUMP_UINT32("Uart Clock Freq"),
+    DUMP_UINT32("Precise Baud rate"),
+    DUMP_UINT16("NameSpaceStringLength"),
+    DUMP_UINT16("NameSpaceStringOffset"),
+    DUMP_END,
+};
+
+static void dump_spcr(AcpiDumper *d, uint32_t offset) {
+    uint32_t string_offset;
+
+    if (d->table[8] < 3) {
+        dump_fields(d, offset, d->length, spcr2_fields);
+        return;
+    }
+
+    // Revision 3 only adds the clock, printing stops at the table end
+    offset = dump_fields(d, offset, d->length, spcr4_fields);
+    string_offset = dump_read(d, offset - 2, 2);
+    if (d->table[8] >= 4 && string_offset != 0)
+        dump_string(d, string_offset, dump_read(d, offset - 4, 2),
+                    "NamespaceString");
+}
+
+/* DBG2 */
+static const AcpiDumpField dbg2_fields[] = {
+    DUMP_UINT32("Info Offset"),
+    DUMP_UINT32("Info Count"),
+    DUMP_END,
+};
+
+static const AcpiDumpField dbg2_device_fields[] = {
+    DUMP_UINT8("Revision"),
+    DUMP_UINT16("Length"),
+    DUMP_UINT8("Register Count"),
+    DUMP_UINT16("Namepath Length"),
+    DUMP_UINT16("Namepath Offset"),
+    DUMP_UINT16("OEM Data Length"),
+    DUMP_UINT16("OEM Data Offset"),
+    DUMP_UINT16("Port Type"),
+    DUMP_UINT16("Port Subtype"),
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT16("Base Address Offset"),
+    DUMP_UINT16("Address Size Offset"),
+    DUMP_END,
+};
+
+static const AcpiDumpField dbg2_address_field[] = {
+    DUMP_GAS("Base Address Register"),
+    DUMP_END,
+};
+
+static const AcpiDumpField dbg2_size_field[] = {
+    DUMP_UINT32("Address Size"),
+    DUMP_END,
+};
+
+static void dump_dbg2(AcpiDumper *d, uint32_t offset) {
+    uint32_t device = dump_read(d, 36, 4);
+    uint32_t count = dump_read(d, 40, 4);
+    uint32_t length, registers, end;
+
+    (void)offset;
+    for (uint32_t i = 0; i < count && device + 22 <= d->length; i++) {
+        length = dump_read(d, device + 1, 2);
+        if (length < 22 || length > d->length - device)
+            break;
+        end = device + length;
+
+        fputc('\n', d->out);
+        dump_fields(d, device, end, dbg2_device_fields);
+        registers = d->table[device + 3];
+        dump_list(d, device + dump_read(d, device + 18, 2), registers, end,
+                  dbg2_address_field);
+        dump_list(d, device + dump_read(d, device + 20, 2), registers, end,
+                  dbg2_size_field);
+        if (dump_read(d, device + 6, 2) != 0)
+            dump_string(d, device + dump_read(d, device + 6, 2),
+                        dump_read(d, device + 4, 2), "Namepath");
+        if (dump_read(d, device + 10, 2) != 0)
+            dump_buffer(d, device + dump_read(d, device + 10, 2),
+                        dump_read(d, device + 8, 2), "OEM Data");
+        device = end;
+    }
+}
+
+/* CSRT */
+static const AcpiDumpField csrt_group_fields[] = {
+    DUMP_UINT32("Length"),
+    DUMP_UINT32("Vendor ID"),
+    DUMP_UINT32("Subvendor ID"),
+    DUMP_UINT16("Device ID"),
+    DUMP_UINT16("Subdevice ID"),
+    DUMP_UINT16("Revision"),
+    DUMP_UINT16("Reserved"),
+    DUMP_UINT32("Shared Info Length"),
+    DUMP_END,
+};
+
+// Shared info layout of DMA controllers, the only one iasl decodes
+static const AcpiDumpField csrt_shared_info_fields[] = {
+    DUMP_UINT16("Major Version"),
+    DUMP_UINT16("Minor Version"),
+    DUMP_UINT32("MMIO Base Low"),
+    DUMP_UINT32("MMIO Base High"),
+    DUMP_UINT32("GSI Interrupt"),
+    DUMP_UINT8("Interrupt Polarity"),
+    DUMP_UINT8("Interrupt Mode"),
+    DUMP_UINT8("Num Channels"),
+    DUMP_UINT8("DMA Address Width"),
+    DUMP_UINT16("Base Request Line"),
+    DUMP_UINT16("Num Handshake Signals"),
+    DUMP_UINT32("Max Block Size"),
+    DUMP_END,
+};
+
+static const AcpiDumpField csrt_descriptor_fields[] = {
+    DUMP_UINT32("Length"),
+    DUMP_UINT16("Type"),
+    DUMP_UINT16("Subtype"),
+    DUMP_UINT32("UID"),
+    DUMP_END,
+};
+
+#define CSRT_GROUP_HEADER_SIZE 24
+#define CSRT_DESCRIPTOR_HEADER_SIZE 12
+#define CSRT_SHARED_INFO_SIZE 32
+
+static void dump_csrt(AcpiDumper *d, uint32_t offset) {
+    uint32_t length, shared, end, descriptor, descriptor_length;
+
+    while (offset + CSRT_GROUP_HEADER_SIZE <= d->length) {
+        length = dump_read(d, offset, 4);
+        if (length < CSRT_GROUP_HEADER_SIZE || length > d->length - offset)
+            break;
+        end = offset + length;
+
+        fputc('\n', d->out);
+        descriptor = dump_fields(d, offset, end, csrt_group_fields);
+        shared = dump_read(d, offset + 20, 4);
+        if (shared > end - descriptor)
+            shared = end - descriptor;
+        if (shared == CSRT_SHARED_INFO_SIZE) {
+            fputc('\n', d->out);
+            dump_fields(d, descriptor, descriptor + shared,
+                        csrt_shared_info_fields);
+        } else {
+            dump_buffer(d, descriptor, shared, "Shared Data");
+        }
+        descriptor += shared;
+
+        while (descriptor + CSRT_DESCRIPTOR_HEADER_SIZE <= end) {
+            descriptor_length = dump_read(d, descriptor, 4);
+            if (descriptor_length < CSRT_DESCRIPTOR_HEADER_SIZE ||
+                descriptor_length > end - descriptor)
+                break;
+            fputc('\n', d->out);
+            dump_fields(d, descriptor, descriptor + descriptor_length,
+                        csrt_descriptor_fields);
+            dump_buffer(d, descriptor + CSRT_DESCRIPTOR_HEADER_SIZE,
+                        descriptor_length - CSRT_DESCRIPTOR_HEADER_SIZE,
+                        "ResourceInfo");
+            descriptor += descriptor_length;
+        }
+        offset = end;
+    }
+}
+
+/* IORT */
+static const AcpiDumpField iort_fields[] = {
+    DUMP_UINT32("Node Count"),
+    DUMP_UINT32("Node Offset"),
+    DUMP_UINT32("Reserved"),
+    DUMP_END,
+};
+
+static const AcpiDumpName iort_node_names[] = {
+    {0, "ITS Group"}, {1, "Named Component"}, {2, "Root Complex"},
+    {3, "SMMU"},      {4, "SMMUv3"},          {5, "PMCG"},
+    {6, "RMR"},       {7, "IWB"},             {0, NULL},
+};
+
+static const AcpiDumpField iort_header_fields[] = {
+    DUMP_ENUM8("Type", iort_node_names),
+    DUMP_UINT16("Length"),
+    DUMP_UINT8("Revision"),
+    DUMP_UINT32("Identifier"),
+    DUMP_UINT32("Mapping Count"),
+    DUMP_UINT32("Mapping Offset"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_mapping_fields[] = {
+    DUMP_UINT32("Input base"),
+    DUMP_UINT32("ID Count"),
+    DUMP_UINT32("Output Base"),
+    DUMP_UINT32("Output Reference"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "Single Mapping"),
+    DUMP_END,
+};
+
+#define IORT_MEMORY_ACCESS_FIELDS                                              \
+    DUMP_UINT32("Cache Coherency"), DUMP_UINT8("Hints (decoded below)"),       \
+        DUMP_FLAG(0, "Transient"), DUMP_FLAG(1, "Write Allocate"),             \
+        DUMP_FLAG(2, "Read Allocate"), DUMP_FLAG(3, "Override"),               \
+        DUMP_UINT16("Reserved"), DUMP_UINT8("Memory Flags (decoded below)"),   \
+        DUMP_FLAG(0, "Coherency"), DUMP_FLAG(1, "Device Attribute"),           \
+        DUMP_FLAG(2, "Ensured Coherency of Accesses")
+
+static const AcpiDumpField iort_its_group_fields[] = {
+    DUMP_UINT32("ItsCount"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_its_identifier_field[] = {
+    DUMP_UINT32("Identifiers"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_named_component_fields[] = {
+    DUMP_UINT32("Node Flags"),
+    IORT_MEMORY_ACCESS_FIELDS,
+    DUMP_UINT8("Memory Size Limit"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_root_complex_fields[] = {
+    IORT_MEMORY_ACCESS_FIELDS,
+    DUMP_UINT32("ATS Attribute"),
+    DUMP_UINT32("PCI Segment Number"),
+    DUMP_UINT8("Memory Size Limit"),
+    DUMP_UINT16("PASID Capabilities"),
+    DUMP_UINT8("Reserved"),
+    DUMP_UINT32("Flags"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_smmu_fields[] = {
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT64("Span"),
+    DUMP_UINT32("Model"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "DVM Supported"),
+    DUMP_FLAG(1, "Coherent Walk"),
+    DUMP_UINT32("Global Interrupt Offset"),
+    DUMP_UINT32("Context Interrupt Count"),
+    DUMP_UINT32("Context Interrupt Offset"),
+    DUMP_UINT32("PMU Interrupt Count"),
+    DUMP_UINT32("PMU Interrupt Offset"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_smmu_global_fields[] = {
+    DUMP_UINT32("NSgIrpt"),
+    DUMP_UINT32("NSgIrpt Flags (decoded below)"),
+    DUMP_FLAG(0, "Edge Triggered"),
+    DUMP_UINT32("NSgCfgIrpt"),
+    DUMP_UINT32("NSgCfgIrpt Flags (decoded below)"),
+    DUMP_FLAG(0, "Edge Triggered"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_smmu_context_field[] = {
+    DUMP_UINT64("Context Interrupt"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_smmu_pmu_field[] = {
+    DUMP_UINT64("PMU Interrupt"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_smmu_v3_fields[] = {
+    DUMP_UINT64("Base Address"),
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "COHACC Override"),
+    DUMP_FLAGS(1, 2, "HTTU Override"),
+    DUMP_FLAG(3, "Proximity Domain Valid"),
+    DUMP_FLAG(4, "DeviceID Valid"),
+    DUMP_UINT32("Reserved"),
+    DUMP_UINT64("VATOS Address"),
+    DUMP_UINT32("Model"),
+    DUMP_UINT32("Event GSIV"),
+    DUMP_UINT32("PRI GSIV"),
+    DUMP_UINT32("GERR GSIV"),
+    DUMP_UINT32("Sync GSIV"),
+    DUMP_UINT32("Proximity Domain"),
+    DUMP_UINT32("Device ID Mapping Index"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_pmcg_fields[] = {
+    DUMP_UINT64("Page 0 Base Address"),
+    DUMP_UINT32("Overflow Interrupt GSIV"),
+    DUMP_UINT32("Node Reference"),
+    DUMP_UINT64("Page 1 Base Address"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_rmr_fields[] = {
+    DUMP_UINT32("Flags (decoded below)"),
+    DUMP_FLAG(0, "Remapping Permitted"),
+    DUMP_FLAG(1, "Access Privileged"),
+    DUMP_FLAGS(2, 8, "Access Attributes"),
+    DUMP_UINT32("Number of RMR Descriptors"),
+    DUMP_UINT32("RMR Descriptor Offset"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_rmr_descriptor_fields[] = {
+    DUMP_UINT64("Base Address of RMR"),
+    DUMP_UINT64("Length of RMR"),
+    DUMP_UINT32("Reserved"),
+    DUMP_END,
+};
+
+static const AcpiDumpField iort_iwb_fields[] = {
+    DUMP_UINT32("Reserved"),
+    DUMP_UINT64("Config Frame Base"),
+    DUMP_UINT16("IWB Index"),
+    DUMP_END,
+};
+
+#define IORT_NODE_HEADER_SIZE 16
+#define IORT_ID_MAPPING_SIZE 20
+
+// Where the ID mappings start, the variable part of a node ends there
+static uint32_t iort_mapping_start(AcpiDumper *d, uint32_t start,
+                                   uint32_t end) {
+    uint32_t offset = dump_read(d, start + 12, 4);
+
+    if (dump_read(d, start + 8, 4) == 0 || offset > end - start)
+        return end;
+    return start + offset;
+}
+
+static void dump_iort_mappings(AcpiDumper *d, uint32_t start,
+                               uint32_t fields_end, uint32_t end) {
+    (void)fields_end;
+    if (iort_mapping_start(d, start, end) == end)
+        return;
+    dump_array(d, iort_mapping_start(d, start, end),
+               dump_read(d, start + 8, 4), IORT_ID_MAPPING_SIZE, end,
+               iort_mapping_fields);
+}
+
+static void dump_iort_its_group(AcpiDumper *d, uint32_t start,
+                                uint32_t fields_end, uint32_t end) {
+    dump_list(d, fields_end, dump_read(d, start + 16, 4), end,
+              iort_its_identifier_field);
+    dump_iort_mappings(d, start, fields_end, end);
+}
+
+// Named components and IWBs end with the device object name
+static void dump_iort_device_name(AcpiDumper *d, uint32_t start,
+                                  uint32_t fields_end, uint32_t end) {
+    uint32_t names_end = iort_mapping_start(d, start, end);
+    uint32_t used = 0;
+
+    if (names_end > fields_end) {
+        used = dump_string(d, fields_end, names_end - fields_end,
+                           "Device Name");
+        dump_buffer(d, fields_end + used, names_end - fields_end - used,
+                    "Padding");
+    }
+    dump_iort_mappings(d, start, fields_end, end);
+}
+
+static void dump_iort_smmu(AcpiDumper *d, uint32_t start,
+                           uint32_t fields_end, uint32_t end) {
+    uint32_t global = dump_read(d, start + 40, 4);
+
+    if (global != 0 && global < end - start)
+        dump_fields(d, start + global, end, iort_smmu_global_fields);
+    dump_list(d, start + dump_read(d, start + 48, 4),
+              dump_read(d, start + 44, 4), end, iort_smmu_context_field);
+    dump_list(d, start + dump_read(d, start + 56, 4),
+              dump_read(d, start + 52, 4), end, iort_smmu_pmu_field);
+    dump_iort_mappings(d, start, fields_end, end);
+}
+
+static void dump_iort_rmr(AcpiDumper *d, uint32_t start, uint32_t fields_end,
+                          uint32_t end) {
+    dump_iort_mappings(d, start, fields_end, end);
+    dump_array(d, start + dump_read(d, start + 24, 4),
+               dump_read(d, start + 20, 4), 20, end,
+               iort_rmr_descriptor_fields);
+}
+
+static const AcpiDumpSubtable iort_subtables[] = {
+    {0, iort_its_group_fields, dump_iort_its_group},
+    {1, iort_named_component_fields, dump_iort_device_name},
+    {2, iort_root_complex_fields, dump_iort_mappings},
+    {3, iort_smmu_fields, dump_iort_smmu},
+    {4, iort_smmu_v3_fields, dump_iort_mappings},
+    {5, iort_pmcg_fields, dump_iort_mappings},
+    {6, iort_rmr_fields, dump_iort_rmr},
+    {7, iort_iwb_fields, dump_iort_device_name},
+};
+
+static const AcpiDumpStream iort_stream = {
+    iort_header_fields, IORT_NODE_HEADER_SIZE, 1, 1, 2, iort_subtables,
+    ARRAY_COUNT(iort_subtables),
+};
+
+static void dump_iort(AcpiDumper *d, uint32_t offset) {
+    uint32_t nodes = dump_read(d, 40, 4);
+
+    if (nodes > offset)
+        dump_buffer(d, offset, nodes - offset, "Optional Padding");
+    dump_stream(d, nodes, d->length, &iort_stream);
+}
+
+/* FPDT and the FBPT it points to */
+static const AcpiDumpName fpdt_record_names[] = {
+    {0, "Firmware Basic Boot Performance Record"},
+    {1, "S3 Performance Table Pointer Record"},
+    {2, "Basic Boot Performance Data Record"},
+    {0, NULL},
+};
+
+static const AcpiDumpField fpdt_header_fields[] = {
+    DUMP_ENUM16("Subtable Type", fpdt_record_names),
+    DUMP_UINT8("Length"),
+    DUMP_UINT8("Revision"),
+    DUMP_END,
+};
+
+static const AcpiDumpField fpdt_boot_pointer_fields[] = {
+    DUMP_UINT32("Reserved"),
+    DUMP_UINT64("FPDT Boot Record Address"),
+    DUMP_END,
+};
+
+static const AcpiDumpField fpdt_s3_pointer_fields[] = {
+    DUMP_UINT32("Reserved"),
+    DUMP_UINT64("S3PT Record Address"),
+    DUMP_END,
+};
+
+static const AcpiDumpField fbpt_fields[] = {
+    DUMP_NAME4("Signature"),
+    DUMP_UINT32("Length"),
+    DUMP_END,
+};
+
+static const AcpiDumpField fbpt_boot_data_fields[] = {
+    DUMP_UINT32("Reserved"),
+    DUMP_UINT64("Reset End"),
+    DUMP_UINT64("Load Image Start"),
+    DUMP_UINT64("Start Image Start"),
+    DUMP_UINT64("Exit Services Entry"),
+    DUMP_UINT64("Exit Services Exit"),
+    DUMP_END,
+};
+
+static const AcpiDumpSubtable fpdt_subtables[] = {
+    {0, fpdt_boot_pointer_fields, NULL},
+    {1, fpdt_s3_pointer_fields, NULL},
+    {2, fbpt_boot_data_fields, NULL},
+};
+
+static const AcpiDumpStream fpdt_stream = {
+    fpdt_header_fields, 4, 2, 2, 1, fpdt_subtables, ARRAY_COUNT(fpdt_subtables),
+};
+
+static void dump_fpdt(AcpiDumper *d, uint32_t offset) {
+    dump_stream(d, offset, d->length, &fpdt_stream);
+}
+
+/* Table dispatch */
+typedef struct {
+    const char *signature;
+    const char *description;
+    bool hasHeader; // Standard ACPI_TABLE_HEADER, false for FACS/FBPT
+    const AcpiDumpField *fields;                // Fixed part, or NULL
+    void (*dump)(AcpiDumper *d, uint32_t offset); // Rest, or NULL
+} AcpiDumpTable;
+
+static const AcpiDumpTable dump_tables[] = {
+    {"APIC", "Multiple APIC Description Table (MADT)", true, madt_fields,
+     dump_madt},
+    {"CSRT", "Core System Resource Table", true, NULL, dump_csrt},
+    {"DBG2", "Debug Port Table type 2", true, dbg2_fields, dump_dbg2},
+    {"FACP", "Fixed ACPI Description Table (FADT)", true, fadt_fields, NULL},
+    {"FACS", "Firmware ACPI Control Structure", false, facs_fields, NULL},
+    {"FBPT", "Firmware Basic Boot Performance Table", false, fbpt_fields,
+     dump_fpdt},
+    {"FPDT", "Firmware Performance Data Table", true, NULL, dump_fpdt},
+    {"GTDT", "Generic Timer Description Table", true, gtdt_fields,
+     dump_gtdt},
+    {"IORT", "IO Remapping Table", true, iort_fields, dump_iort},
+    {"MCFG", "Memory Mapped Configuration Table", true, mcfg_fields,
+     dump_mcfg},
+    {"PPTT", "Processor Properties Topology Table", true, NULL, dump_pptt},
+    {"SPCR", "Serial Port Console Redirection Table", true, spcr_fields,
+     dump_spcr},
+};
+
+static const AcpiDumpTable *find_table(const char *signature) {
+    for (size_t i = 0; i < ARRAY_COUNT(dump_tables); i++) {
+        if (memcmp(dump_tables[i].signature, signature, 4) == 0)
+            return &dump_tables[i];
+    }
+    return NULL;
+}
+
+/**
+ * Tell whether the dumper has a field layout for a table.
+ *
+ * @param signature  Four character table signature.
+ *
+ * @retval true      Fields are decoded.
+ * @retval false     Only the header and raw bytes are printed.
+ */
+bool acpi_dump_supported(const char *signature) {
+    return find_table(signature) != NULL;
+}
+
+static void dump_raw(FILE *out, const uint8_t *table, size_t size) {
+    size_t row, i;
+
+    fprintf(out, "\nRaw Table Data: Length %zu (0x%zX)\n\n", size, size);
+    for (row = 0; row < size; row += 16) {
+        fprintf(out, "    %4.4zX: ", row);
+        for (i = row; i < row + 16; i++) {
+            if (i < size)
+                fprintf(out, "%2.2X ", table[i]);
+            else
+                fprintf(out, "   ");
+        }
+        fprintf(out, " // ");
+        for (i = row; i < row + 16 && i < size; i++)
+            fputc(table[i] >= 0x20 && table[i] < 0x7F ? table[i] : '.', out);
+        fputc('\n', out);
+    }
+}
+
+/**
+ * Disassemble a table in the iasl data table format.
+ *
+ * @param out        Stream receiving the DSL text.
+ * @param table      Table bytes, starting with the signature.
+ * @param size       Number of bytes in table.
+ * @param file_name  Name shown in the banner, or NULL.
+ *
+ * @retval 0         Table dumped.
+ * @retval -EINVAL   Table is too short to hold a header.
+ */
+int acpi_dump_table(FILE *out, const uint8_t *table, size_t size,
+                    const char *file_name) {
+    const AcpiDumpTable *info;
+    AcpiDumper d = {0};
+    uint32_t offset = 0;
+    uint32_t length;
+
+    if (table == NULL || size < 8)
+        return -EINVAL;
+
+    info = find_table((const char *)table);
+    if ((info == NULL || info->hasHeader) && size < sizeof(ACPI_TABLE_HEADER))
+        return -EINVAL;
+
+    length = (uint32_t)read_value(table + 4, 4);
+    d.out = out;
+    d.table = table;
+    d.length = length >= 8 && length < size ? length : (uint32_t)size;
+    d.description = info != NULL ? info->description : NULL;
+    for (uint32_t i = 0; i < d.length; i++)
+        d.sum += table[i];
+
+    fprintf(out, "/*\n");
+    fprintf(out, " * Project Aloha native table disassembler (acpi_dump)\n");
+    fprintf(out, " *\n");
+    if (file_name != NULL)
+        fprintf(out, " * Disassembly of %s\n *\n", file_name);
+    fprintf(out, " * ACPI Data Table [%.4s]\n", (const char *)table);
+    fprintf(out, " *\n");
+    fprintf(out, " * Format: [HexOffset DecimalOffset ByteLength]  "
+                 "FieldName : FieldValue (in hex)\n");
+    fprintf(out, " */\n\n");
+
+    // Subtable streams start with their own blank line
+    if (info == NULL || info->hasHeader) {
+        offset = dump_fields(&d, 0, d.length, header_fields);
+        if (info != NULL && info->fields != NULL)
+            fputc('\n', out);
+    }
+    if (info != NULL && info->fields != NULL)
+        offset = dump_fields(&d, offset, d.length, info->fields);
+    if (info != NULL && info->dump != NULL)
+        info->dump(&d, offset);
+
+    dump_raw(out, table, size);
+    return 0;
+}
@@ -0,0 +1,546 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "acpi_layout.h"
+#include "utils.h"
+#include <acpi.h>
+#include <common.h>
+#include <common/csrt.h>
+#include <common/dbg2.h>
+#include <common/facp.h>
+#include <common/facs.h>
+#include <common/fpdt.h>
+#include <common/gtdt.h>
+#include <common/iort.h>
+#include <common/madt.h>
+#include <common/mcfg.h>
+#include <common/pptt.h>
+#include <common/spcr.h>
+#include <string.h>
+
+// After the table headers, some members follow their revision
+#include <acpi_fields.h>
+
+// Concrete instances of the variable structures, only used for offsetof()
+GTDT_DEFINE_TIMER_BLOCK_STRUCTURE_TYPE(LAYOUT, 1)
+DBG2_DEFINE_DEBUG_DEVICE_INFO_STRUCTURE(LAYOUT, 1, 1, 1)
+
+#define ACPI_LAYOUT_MAX_STRUCTURES 8
+
+#define MEMBER_SIZE(type, member) sizeof(((type *)0)->member)
+
+// X of the member lists in acpi_fields.h: a field of type at base, its name
+// is prefix followed by the member name. Generic Address Structures and
+// FPDT record headers are expanded to their members.
+#define ACPI_LAYOUT_FIELD(kind, member, type, base, prefix)                    \
+  ACPI_LAYOUT_KIND_##kind(member, type, base, prefix)
+// Same for the members of an expanded structure, ACPI_LAYOUT_FIELD is not
+// expanded again inside its own expansion
+#define ACPI_LAYOUT_MEMBER(kind, member, type, base, prefix)                   \
+  ACPI_LAYOUT_KIND_##kind(member, type, base, prefix)
+
+#define ACPI_LAYOUT_SCALAR(member, type, base, prefix, kind)                   \
+  {prefix #member, (base) + offsetof(type, member), MEMBER_SIZE(type, member), \
+   kind},
+#define ACPI_LAYOUT_KIND_UINT(member, type, base, prefix)                      \
+  ACPI_LAYOUT_SCALAR(member, type, base, prefix, ACPI_FIELD_UINT)
+#define ACPI_LAYOUT_KIND_CHARS(member, type, base, prefix)                     \
+  ACPI_LAYOUT_SCALAR(member, type, base, prefix, ACPI_FIELD_CHARS)
+#define ACPI_LAYOUT_KIND_BYTES(member, type, base, prefix)                     \
+  ACPI_LAYOUT_SCALAR(member, type, base, prefix, ACPI_FIELD_BYTES)
+// "<member>.Address"..., the DBG2 ACPI_GAS has the same layout
+#define ACPI_LAYOUT_KIND_GAS(member, type, base, prefix)                       \
+  ACPI_GENERIC_ADDRESS_STRUCTURE_FIELDS(                                       \
+      ACPI_LAYOUT_MEMBER, ACPI_GENERIC_ADDRESS_STRUCTURE,                      \
+      (base) + offsetof(type, member), prefix #member ".")
+#define ACPI_LAYOUT_KIND_ACPI_GAS ACPI_LAYOUT_KIND_GAS
+// Type, Length and Revision under the name of the record
+#define ACPI_LAYOUT_KIND_RECORD_HEADER(member, type, base, prefix)             \
+  FPDT_PERFORMANCE_RECORD_HEADER_FIELDS(ACPI_LAYOUT_MEMBER,                    \
+                                        FPDT_PERFORMANCE_RECORD_HEADER,        \
+                                        (base) + offsetof(type, member),       \
+                                        prefix)
+
+// Fields of a subtable, offset from subtable start
+#define SUBTABLE_FIELDS(type) type##_FIELDS(ACPI_LAYOUT_FIELD, type, 0, "")
+// Fields of the fixed part, located right after the standard header
+#define BODY_FIELDS(type)                                                      \
+  type##_FIELDS(ACPI_LAYOUT_FIELD, type, sizeof(ACPI_TABLE_HEADER), "")
+
+#define ARRAY_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+/* Standard header */
+const AcpiFieldDescriptor acpi_header_fields[] = {
+    SUBTABLE_FIELDS(ACPI_TABLE_HEADER)};
+const size_t acpi_header_field_count = ARRAY_COUNT(acpi_header_fields);
+
+/* MADT */
+static const AcpiFieldDescriptor madt_fields[] = {
+    BODY_FIELDS(MADT_HEADER_EXTRA_DATA)};
+static const AcpiFieldDescriptor madt_gicc_fields[] = {
+    SUBTABLE_FIELDS(MADT_GICC_STRUCTURE)};
+static const AcpiFieldDescriptor madt_gicd_fields[] = {
+    SUBTABLE_FIELDS(MADT_GICD_STRUCTURE)};
+static const AcpiFieldDescriptor madt_gic_msi_frame_fields[] = {
+    SUBTABLE_FIELDS(MADT_GIC_MSI_FRAME_STRUCTURE)};
+static const AcpiFieldDescriptor madt_gicr_fields[] = {
+    SUBTABLE_FIELDS(MADT_GICR_STRUCTURE)};
+static const AcpiFieldDescriptor madt_gic_its_fields[] = {
+    SUBTABLE_FIELDS(MADT_GIC_ITS_STRUCTURE)};
+
+static const AcpiStructureLayout madt_structures[] = {
+    {"GICC", 0xB, madt_gicc_fields, ARRAY_COUNT(madt_gicc_fields)},
+    {"GICD", 0xC, madt_gicd_fields, ARRAY_COUNT(madt_gicd_fields)},
+    {"GIC_MSI_FRAME", 0xD, madt_gic_msi_frame_fields,
+     ARRAY_COUNT(madt_gic_msi_frame_fields)},
+    {"GICR", 0xE, madt_gicr_fields, ARRAY_COUNT(madt_gicr_fields)},
+    {"GIC_ITS", 0xF, madt_gic_its_fields, ARRAY_COUNT(madt_gic_its_fields)},
+};
+
+/* PPTT */
+static const AcpiFieldDescriptor pptt_processor_fields[] = {
+    SUBTABLE_FIELDS(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)};
+static const AcpiFieldDescriptor pptt_cache_fields[] = {
+    SUBTABLE_FIELDS(ACPI_PPTT_CACHE_TYPE_STRUCTURE)};
+static const AcpiFieldDescriptor pptt_id_fields[] = {
+    SUBTABLE_FIELDS(ACPI_PPTT_ID)};
+
+static const AcpiStructureLayout pptt_structures[] = {
+    {"PROCESSOR", 0, pptt_processor_fields,
+     ARRAY_COUNT(pptt_processor_fields)},
+    {"CACHE", 1, pptt_cache_fields, ARRAY_COUNT(pptt_cache_fields)},
+    {"ID", 2, pptt_id_fields, ARRAY_COUNT(pptt_id_fields)},
+};
+
+/* GTDT */
+static const AcpiFieldDescriptor gtdt_fields[] = {
+    BODY_FIELDS(GTDT_HEADER_EXTRA_DATA)};
+
+// Head of a timer block, only described here
+#define GTDT_TIMER_BLOCK_STRUCTURE_LAYOUT_FIELDS(X, type, ...)                 \
+  X(UINT, Type, type, __VA_ARGS__)                                             \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, GTBlockPhysicalAddress, type, __VA_ARGS__)                           \
+  X(UINT, GTBlockTimerCount, type, __VA_ARGS__)                                \
+  X(UINT, GTBlockTimerOffset, type, __VA_ARGS__)
+static const AcpiFieldDescriptor gtdt_timer_block_fields[] = {
+    SUBTABLE_FIELDS(GTDT_TIMER_BLOCK_STRUCTURE_LAYOUT)};
+static const AcpiFieldDescriptor gtdt_watchdog_fields[] = {
+    SUBTABLE_FIELDS(ACPI_GTDT_GENERIC_WDT_STRUCTURE)};
+
+static const AcpiStructureLayout gtdt_structures[] = {
+    {"GT_BLOCK", 0, gtdt_timer_block_fields,
+     ARRAY_COUNT(gtdt_timer_block_fields)},
+    {"WATCHDOG", 1, gtdt_watchdog_fields, ARRAY_COUNT(gtdt_watchdog_fields)},
+};
+
+/* DBG2 */
+static const AcpiFieldDescriptor dbg2_fields[] = {
+    BODY_FIELDS(DBG2_HEADER_EXTRA_DATA)};
+
+// Only the fixed head, registers and strings follow at variable offsets
+#define DBG2_DEBUG_DEVICE_INFO_STRUCTURE_LAYOUT_FIELDS(X, type, ...)           \
+  X(UINT, Revision, type, __VA_ARGS__)                                         \
+  X(UINT, Length, type, __VA_ARGS__)                                           \
+  X(UINT, NumOfGenericAddrRegs, type, __VA_ARGS__)                             \
+  X(UINT, NamespaceStringLen, type, __VA_ARGS__)                               \
+  X(UINT, NamespaceStringOffset, type, __VA_ARGS__)                            \
+  X(UINT, OemDataLen, type, __VA_ARGS__)                                       \
+  X(UINT, OemDataOffset, type, __VA_ARGS__)                                    \
+  X(UINT, PortType, type, __VA_ARGS__)                                         \
+  X(UINT, PortSubtype, type, __VA_ARGS__)                                      \
+  X(UINT, Reserved, type, __VA_ARGS__)                                         \
+  X(UINT, BaseAddrRegOffset, type, __VA_ARGS__)                                \
+  X(UINT, AddrSizeOffset, type, __VA_ARGS__)
+static const AcpiFieldDescriptor dbg2_device_fields[] = {
+    SUBTABLE_FIELDS(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_LAYOUT)};
+
+static const AcpiStructureLayout dbg2_structures[] = {
+    {"DEVICE", ACPI_LAYOUT_ANY_TYPE, dbg2_device_fields,
+     ARRAY_COUNT(dbg2_device_fields)},
+};
+
+/* SPCR */
+static const AcpiFieldDescriptor spcr_fields[] = {
+    BODY_FIELDS(SPCR_HEADER_EXTRA_DATA)};
+
+/* FACP */
+static const AcpiFieldDescriptor facp_fields[] = {
+    BODY_FIELDS(FACP_DATA_STRUCTURE)};
+
+/* FACS, no standard header */
+static const AcpiFieldDescriptor facs_fields[] = {
+    SUBTABLE_FIELDS(ACPI_FACS_TABLE)};
+
+/* FPDT, the FBPT pointer record members under "FbptPointerRecord." */
+static const AcpiFieldDescriptor fpdt_fields[] = {
+    FPDT_FBPT_POINTER_RECORD_FIELDS(ACPI_LAYOUT_FIELD, FPDT_FBPT_POINTER_RECORD,
+                                    sizeof(ACPI_TABLE_HEADER),
+                                    "FbptPointerRecord.")};
+
+/* FBPT, no standard header */
+static const AcpiFieldDescriptor fbpt_fields[] = {
+    SUBTABLE_FIELDS(FBPT_HEADER)
+        FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD_FIELDS(
+            ACPI_LAYOUT_FIELD, FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD,
+            FBPT_BASIC_BOOT_PERFORMANCE_DATA_OFFSET,
+            "BasicBootPerformanceData.")};
+
+/* MCFG */
+static const AcpiFieldDescriptor mcfg_fields[] = {
+    BODY_FIELDS(MCFG_HEADER_EXTRA_DATA)};
+static const AcpiFieldDescriptor mcfg_allocation_fields[] = {
+    SUBTABLE_FIELDS(MCFG_MEM_MAP_EC_SPACE_STRUCTURE)};
+
+static const AcpiStructureLayout mcfg_structures[] = {
+    {"ALLOCATION", ACPI_LAYOUT_ANY_TYPE, mcfg_allocation_fields,
+     ARRAY_COUNT(mcfg_allocation_fields)},
+};
+
+/* CSRT */
+static const AcpiFieldDescriptor csrt_group_fields[] = {
+    SUBTABLE_FIELDS(CSRT_RESOURCE_GROUPS_HEADER_FORMAT)};
+
+static const AcpiStructureLayout csrt_structures[] = {
+    {"GROUP", ACPI_LAYOUT_ANY_TYPE, csrt_group_fields,
+     ARRAY_COUNT(csrt_group_fields)},
+};
+
+/* IORT */
+static const AcpiFieldDescriptor iort_fields[] = {
+    BODY_FIELDS(IORT_HEADER_EXTRA_DATA)};
+static const AcpiFieldDescriptor iort_node_fields[] = {
+    SUBTABLE_FIELDS(IORT_NODE_FORMAT)};
+
+static const AcpiStructureLayout iort_structures[] = {
+    {"NODE", ACPI_LAYOUT_ANY_TYPE, iort_node_fields,
+     ARRAY_COUNT(iort_node_fields)},
+};
+
+#define BODY_OFFSET(type, member) (sizeof(ACPI_TABLE_HEADER) + offsetof(type, member))
+
+static const AcpiTableLayout acpi_table_layouts[] = {
+    {
+        .signature = {ACPI_MADT_SIGNATURE},
+        .hasHeader = true,
+        .fields = madt_fields,
+        .fieldCount = ARRAY_COUNT(madt_fields),
+        .subtableStart =
+            sizeof(ACPI_TABLE_HEADER) + sizeof(MADT_HEADER_EXTRA_DATA),
+        .subtableStartField = ACPI_LAYOUT_NO_FIELD,
+        .subtableCountField = ACPI_LAYOUT_NO_FIELD,
+        .typeOffset = 0,
+        .lengthOffset = 1,
+        .lengthSize = 1,
+        .structures = madt_structures,
+        .structureCount = ARRAY_COUNT(madt_structures),
+    },
+    {
+        .signature = {ACPI_CSRT_SIGNATURE},
+        .hasHeader = true,
+        .subtableStart = sizeof(ACPI_TABLE_HEADER),
+        .subtableStartField = ACPI_LAYOUT_NO_FIELD,
+        .subtableCountField = ACPI_LAYOUT_NO_FIELD,
+        .typeOffset = ACPI_LAYOUT_NO_FIELD,
+        .lengthOffset = offsetof(CSRT_RESOURCE_GROUPS_HEADER_FORMAT, Length),
+        .lengthSize = 4,
+        .structures = csrt_structures,
+        .structureCount = ARRAY_COUNT(csrt_structures),
+    },
+    {
+        .signature = {ACPI_DBG2_SIGNATURE},
+        .hasHeader = true,
+        .fields = dbg2_fields,
+        .fieldCount = ARRAY_COUNT(dbg2_fields),
+        .subtableStartField =
+            BODY_OFFSET(DBG2_HEADER_EXTRA_DATA, OffsetDbgDeviceInfo),
+        .subtableCountField =
+            BODY_OFFSET(DBG2_HEADER_EXTRA_DATA, NumberOfDbgDevices),
+        .typeOffset = ACPI_LAYOUT_NO_FIELD,
+        .lengthOffset =
+            offsetof(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_LAYOUT, Length),
+        .lengthSize = 2,
+        .structures = dbg2_structures,
+        .structureCount = ARRAY_COUNT(dbg2_structures),
+    },
+    {
+        .signature = {ACPI_FACP_SIGNATURE},
+        .hasHeader = true,
+        .fields = facp_fields,
+        .fieldCount = ARRAY_COUNT(facp_fields),
+    },
+    {
+        .signature = {ACPI_FACS_SIGNATURE},
+        .hasHeader = false,
+        .fields = facs_fields,
+        .fieldCount = ARRAY_COUNT(facs_fields),
+    },
+    {
+        .signature = {ACPI_FBPT_SIGNATURE},
+        .hasHeader = false,
+        .fields = fbpt_fields,
+        .fieldCount = ARRAY_COUNT(fbpt_fields),
+    },
+    {
+        .signature = {ACPI_FPDT_SIGNATURE},
+        .hasHeader = true,
+        .fields = fpdt_fields,
+        .fieldCount = ARRAY_COUNT(fpdt_fields),
+    },
+    {
+        .signature = {ACPI_GTDT_SIGNATURE},
+        .hasHeader = true,
+        .fields = gtdt_fields,
+        .fieldCount = ARRAY_COUNT(gtdt_fields),
+        .subtableStartField =
+            BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, PlatformTimerOffset),
+        .subtableCountField =
+            BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, PlatformTimerCount),
+        .typeOffset = 0,
+        .lengthOffset = offsetof(ACPI_GTDT_GENERIC_WDT_STRUCTURE, Length),
+        .lengthSize = 2,
+        .structures = gtdt_structures,
+        .structureCount = ARRAY_COUNT(gtdt_structures),
+    },
+    {
+        .signature = {ACPI_IORT_SIGNATURE},
+        .hasHeader = true,
+        .fields = iort_fields,
+        .fieldCount = ARRAY_COUNT(iort_fields),
+        .subtableStartField =
+            BODY_OFFSET(IORT_HEADER_EXTRA_DATA, OffsetToNodeArray),
+        .subtableCountField = BODY_OFFSET(IORT_HEADER_EXTRA_DATA, NumOfNodes),
+        .typeOffset = 0,
+        .lengthOffset = offsetof(IORT_NODE_FORMAT, Length),
+        .lengthSize = 2,
+        .structures = iort_structures,
+        .structureCount = ARRAY_COUNT(iort_structures),
+    },
+    {
+        .signature = {ACPI_MCFG_SIGNATURE},
+        .hasHeader = true,
+        .fields = mcfg_fields,
+        .fieldCount = ARRAY_COUNT(mcfg_fields),
+        .subtableStart =
+            sizeof(ACPI_TABLE_HEADER) + sizeof(MCFG_HEADER_EXTRA_DATA),
+        .subtableStartField = ACPI_LAYOUT_NO_FIELD,
+        .subtableCountField = ACPI_LAYOUT_NO_FIELD,
+        .typeOffset = ACPI_LAYOUT_NO_FIELD,
+        .fixedLength = sizeof(MCFG_MEM_MAP_EC_SPACE_STRUCTURE),
+        .structures = mcfg_structures,
+        .structureCount = ARRAY_COUNT(mcfg_structures),
+    },
+    {
+        .signature = {ACPI_PPTT_SIGNATURE},
+        .hasHeader = true,
+        .subtableStart = sizeof(ACPI_TABLE_HEADER),
+        .subtableStartField = ACPI_LAYOUT_NO_FIELD,
+        .subtableCountField = ACPI_LAYOUT_NO_FIELD,
+        .typeOffset = 0,
+        .lengthOffset = 1,
+        .lengthSize = 1,
+        .structures = pptt_structures,
+        .structureCount = ARRAY_COUNT(pptt_structures),
+    },
+    {
+        .signature = {ACPI_SPCR_SIGNATURE},
+        .hasHeader = true,
+        .fields = spcr_fields,
+        .fieldCount = ARRAY_COUNT(spcr_fields),
+    },
+};
+
+/**
+ * Get the layout of a table by signature.
+ *
+ * @param signature 4 characters table signature, e.g. "APIC".
+ * @return  Layout or NULL if the table is unknown.
+ */
+const AcpiTableLayout *acpi_layout_find(const char *signature) {
+    for (size_t i = 0; i < ARRAY_COUNT(acpi_table_layouts); i++) {
+        if (memcmp(acpi_table_layouts[i].signature, signature, 4) == 0)
+            return &acpi_table_layouts[i];
+    }
+    return NULL;
+}
+
+/**
+ * Enumerate known layouts.
+ *
+ * @return  Layout at index or NULL past the last one.
+ */
+const AcpiTableLayout *acpi_layout_get(size_t index) {
+    if (index >= ARRAY_COUNT(acpi_table_layouts))
+        return NULL;
+    return &acpi_table_layouts[index];
+}
+
+/**
+ * Get a subtable layout by name, e.g. "GICC" in MADT.
+ */
+const AcpiStructureLayout *
+acpi_layout_find_structure(const AcpiTableLayout *layout, const char *name) {
+    for (size_t i = 0; i < layout->structureCount; i++) {
+        if (strcmp(layout->structures[i].name, name) == 0)
+            return &layout->structures[i];
+    }
+    return NULL;
+}
+
+/**
+ * Get a field by name in a descriptor array.
+ */
+const AcpiFieldDescriptor *acpi_layout_find_field(
+    const AcpiFieldDescriptor *fields, size_t count, const char *name) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(fields[i].name, name) == 0)
+            return &fields[i];
+    }
+    return NULL;
+}
+
+/**
+ * Get a field of the fixed part of a table, standard header included.
+ */
+const AcpiFieldDescriptor *
+acpi_layout_find_table_field(const AcpiTableLayout *layout, const char *name) {
+    const AcpiFieldDescriptor *field = NULL;
+    if (layout->hasHeader)
+        field = acpi_layout_find_field(acpi_header_fields,
+                                       acpi_header_field_count, name);
+    if (field == NULL)
+        field = acpi_layout_find_field(layout->fields, layout->fieldCount,
+                                       name);
+    return field;
+}
+
+static uint32_t read_uint(const uint8_t *base, uint32_t size) {
+    uint32_t value = 0;
+    memcpy(&value, base, size);
+    return value;
+}
+
+/**
+ * Walk the subtable stream of a table.
+ *
+ * Every subtable is bounds checked against the table length before the
+ * callback sees it.
+ *
+ * @param table     Table buffer.
+ * @param length    Table length.
+ * @param layout    Layout returned by acpi_layout_find.
+ * @param callback  Called for each subtable in order.
+ * @param context   Passed to callback.
+ * @retval 0        Success or stopped by callback.
+ * @retval -EINVAL  Subtable stream is truncated or malformed.
+ * @retval <0       Error returned by callback.
+ */
+int acpi_layout_walk(const uint8_t *table, size_t length,
+                     const AcpiTableLayout *layout,
+                     AcpiSubtableCallback callback, void *context) {
+    uint32_t counts[ACPI_LAYOUT_MAX_STRUCTURES] = {0};
+    uint64_t offset = layout->subtableStart;
+    uint64_t remaining = UINT64_MAX;
+    uint32_t minimum = 0;
+
+    if (layout->structureCount == 0)
+        return 0;
+
+    if (layout->subtableStartField != ACPI_LAYOUT_NO_FIELD) {
+        if ((uint64_t)layout->subtableStartField + 4 > length)
+            return -EINVAL;
+        offset = read_uint(table + layout->subtableStartField, 4);
+    }
+    if (layout->subtableCountField != ACPI_LAYOUT_NO_FIELD) {
+        if ((uint64_t)layout->subtableCountField + 4 > length)
+            return -EINVAL;
+        remaining = read_uint(table + layout->subtableCountField, 4);
+    }
+
+    // Bytes needed to read the subtable type and length
+    minimum = layout->lengthSize ? layout->lengthOffset + layout->lengthSize
+                                 : layout->fixedLength;
+    if (layout->typeOffset != ACPI_LAYOUT_NO_FIELD &&
+        (uint32_t)layout->typeOffset + 1 > minimum)
+        minimum = layout->typeOffset + 1;
+
+    while (remaining > 0 && offset < length) {
+        AcpiSubtable subtable = {0};
+        int ret;
+
+        if (offset + minimum > length)
+            return -EINVAL;
+        subtable.offset = offset;
+        subtable.length = layout->lengthSize
+                              ? read_uint(table + offset + layout->lengthOffset,
+                                          layout->lengthSize)
+                              : layout->fixedLength;
+        if (subtable.length < minimum || offset + subtable.length > length)
+            return -EINVAL;
+        subtable.type = layout->typeOffset != ACPI_LAYOUT_NO_FIELD
+                            ? table[offset + layout->typeOffset]
+                            : ACPI_LAYOUT_ANY_TYPE;
+
+        for (size_t i = 0; i < layout->structureCount &&
+                           i < ACPI_LAYOUT_MAX_STRUCTURES;
+             i++) {
+            if (layout->structures[i].type == ACPI_LAYOUT_ANY_TYPE ||
+                layout->structures[i].type == subtable.type) {
+                subtable.layout = &layout->structures[i];
+                subtable.index = counts[i]++;
+                break;
+            }
+        }
+
+        ret = callback(table, &subtable, context);
+        if (ret != 0)
+            return ret < 0 ? ret : 0;
+
+        offset += subtable.length;
+        if (remaining != UINT64_MAX)
+            remaining--;
+    }
+
+    // Header announced more subtables than the table holds
+    if (remaining != UINT64_MAX && remaining > 0)
+        return -EINVAL;
+    return 0;
+}
+
+/**
+ * Read an integer field.
+ *
+ * @param base  Start of the structure holding the field.
+ * @param field Field descriptor, bytes fields return their first 8 bytes.
+ */
+uint64_t acpi_field_read(const uint8_t *base,
+                         const AcpiFieldDescriptor *field) {
+    uint64_t value = 0;
+    memcpy(&value, base + field->offset, field->size < 8 ? field->size : 8);
+    return value;
+}
+
+/**
+ * Write an integer field, value must fit (see acpi_field_fits).
+ */
+void acpi_field_write(uint8_t *base, const AcpiFieldDescriptor *field,
+                      uint64_t value) {
+    memcpy(base + field->offset, &value, field->size < 8 ? field->size : 8);
+}
+
+/**
+ * Check whether an integer value fits in a field.
+ */
+bool acpi_field_fits(const AcpiFieldDescriptor *field, uint64_t value) {
+    if (field->kind != ACPI_FIELD_UINT)
+        return false;
+    if (field->size >= 8)
+        return true;
+    return value < (1ULL << (field->size * 8));
+}
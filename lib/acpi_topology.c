@@ -0,0 +1,1356 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "acpi_topology.h"
+#include "acpi_layout.h"
+#include "utils.h"
+#include <acpi.h>
+#include <common.h>
+#include <common/madt.h>
+#include <common/pptt.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Linux CPU topology simulation, see include/acpi_topology.h. Function
+// comments name the kernel function each helper mirrors. PPTT nodes and
+// caches are collected in table order, so references are resolved by
+// binary search on their offsets.
+//
+
+const char *const acpi_topology_mask_names[ACPI_TOPOLOGY_MASK_COUNT] = {
+    "thread_siblings", "core_siblings", "cluster_cpus",
+    "llc_siblings",    "coregroup",     "clustergroup",
+};
+
+const char *const acpi_topology_cache_type_names[] = {
+    [ACPI_TOPOLOGY_CACHE_DATA] = "Data",
+    [ACPI_TOPOLOGY_CACHE_INSTRUCTION] = "Instruction",
+    [ACPI_TOPOLOGY_CACHE_UNIFIED] = "Unified",
+};
+
+// arch/arm64/include/asm/cputype.h
+#define MPIDR_HWID_BITMASK 0xFF00FFFFFFULL
+#define MPIDR_MT_BITMASK BIT(24)
+
+// PPTT cache attributes bits 3:2, as include/acpi/actbl2.h tests them
+#define PPTT_CACHE_TYPE_MASK 0x0C
+#define PPTT_CACHE_TYPE_DATA 0x00
+#define PPTT_CACHE_TYPE_INSTRUCTION 0x04
+#define PPTT_CACHE_TYPE_UNIFIED 0x08
+
+// Levels walked up to find the physical package, drivers/acpi/pptt.c
+#define PPTT_ABORT_PACKAGE 0xFF
+
+// CacheId follows LineSize in revision 3 cache structures
+#define PPTT_CACHE_ID_OFFSET                                                  \
+    (offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, LineSize) + sizeof(uint16_t))
+
+#define TOPOLOGY_DT_MAX_NAME 32
+
+typedef struct {
+    uint32_t offset;
+    uint32_t flags;
+    uint32_t parent;
+    uint32_t id;
+    uint32_t resourceCount; // Bounded by the node length
+    bool isParent;          // Another processor node points to it
+} TopologyNode;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t flags;
+    uint32_t next;
+    uint8_t attributes;
+    uint32_t size;
+    uint32_t sets;
+    uint8_t ways;
+    uint16_t lineSize;
+    bool hasCacheId;
+    uint32_t cacheId;
+} TopologyCacheNode;
+
+typedef struct {
+    uint32_t id;
+    uint32_t node;
+} TopologyLeaf;
+
+typedef struct {
+    const uint8_t *table;
+    uint8_t revision;
+    TopologyNode *nodes; // Both in table order
+    uint32_t nodeCount;
+    TopologyCacheNode *caches;
+    uint32_t cacheCount;
+    TopologyLeaf *leaves; // By ID, then table order
+    uint32_t leafCount;
+    AcpiTopology *topology;
+} TopologyPptt;
+
+/**
+ * Keep something the kernel would warn about. Notes are best effort, a
+ * failed allocation drops the note.
+ */
+static void note(AcpiTopology *topology, const char *format, ...) {
+    char message[ACPI_TOPOLOGY_MESSAGE_SIZE];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    // The kernel repeats some warnings for every CPU, keep one
+    for (size_t i = 0; i < topology->noteCount; i++) {
+        if (strcmp(topology->notes[i].message, message) == 0)
+            return;
+    }
+
+    if (topology->noteCount == topology->noteCapacity) {
+        size_t capacity =
+            topology->noteCapacity ? topology->noteCapacity * 2 : 8;
+        AcpiTopologyNote *grown =
+            realloc(topology->notes, capacity * sizeof(*grown));
+        if (grown == NULL)
+            return;
+        topology->notes = grown;
+        topology->noteCapacity = capacity;
+    }
+    memcpy(topology->notes[topology->noteCount++].message, message,
+           sizeof(message));
+}
+
+// Grow an array on powers of two, before adding element count
+static int grow(void **array, uint32_t count, size_t elementSize) {
+    void *grown;
+
+    if (count & (count - 1))
+        return 0;
+    grown = realloc(*array, (count ? count * 2 : 16) * elementSize);
+    if (grown == NULL)
+        return -ENOMEM;
+    *array = grown;
+    return 0;
+}
+
+/* CPU masks */
+
+static uint64_t *mask_at(const AcpiTopology *topology, uint32_t cpu,
+                         uint32_t mask) {
+    return &topology->masks[((size_t)cpu * ACPI_TOPOLOGY_MASK_COUNT + mask) *
+                            topology->words];
+}
+
+static uint64_t *cache_mask_at(const AcpiTopology *topology, uint32_t cpu,
+                               uint32_t leaf) {
+    return &topology
+                ->cacheMasks[((size_t)cpu * ACPI_TOPOLOGY_MAX_CACHE_LEAVES +
+                              leaf) *
+                             topology->words];
+}
+
+static void mask_set(uint64_t *mask, uint32_t cpu) {
+    mask[cpu / 64] |= 1ULL << (cpu % 64);
+}
+
+static bool mask_test(const uint64_t *mask, uint32_t cpu) {
+    return (mask[cpu / 64] >> (cpu % 64)) & 1;
+}
+
+static bool mask_subset(const uint64_t *mask, const uint64_t *of,
+                        uint32_t words) {
+    for (uint32_t i = 0; i < words; i++) {
+        if (mask[i] & ~of[i])
+            return false;
+    }
+    return true;
+}
+
+const uint64_t *acpi_topology_mask(const AcpiTopology *topology, uint32_t cpu,
+                                   enum ACPI_TOPOLOGY_MASK mask) {
+    return mask_at(topology, cpu, mask);
+}
+
+const uint64_t *acpi_topology_cache_mask(const AcpiTopology *topology,
+                                         uint32_t cpu, uint32_t leaf) {
+    return cache_mask_at(topology, cpu, leaf);
+}
+
+/**
+ * Print a mask as a sysfs CPU list, e.g. "0-3,6".
+ *
+ * @retval  Length of the list, it is truncated to fit size.
+ */
+size_t acpi_topology_format_list(const AcpiTopology *topology,
+                                 const uint64_t *mask, char *buffer,
+                                 size_t size) {
+    size_t used = 0;
+
+    if (size)
+        buffer[0] = '\0';
+    for (uint32_t cpu = 0; cpu < topology->cpuCount; cpu++) {
+        uint32_t last = cpu;
+        int length;
+
+        if (!mask_test(mask, cpu))
+            continue;
+        while (last + 1 < topology->cpuCount && mask_test(mask, last + 1))
+            last++;
+        if (last == cpu)
+            length = snprintf(buffer + used, used < size ? size - used : 0,
+                              "%s%u", used ? "," : "", cpu);
+        else
+            length = snprintf(buffer + used, used < size ? size - used : 0,
+                              "%s%u-%u", used ? "," : "", cpu, last);
+        used += length;
+        cpu = last;
+    }
+    return used;
+}
+
+static int allocate_cpus(AcpiTopology *topology, uint32_t count) {
+    topology->cpuCount = count;
+    topology->words = count ? (count + 63) / 64 : 1;
+    topology->cpus = calloc(count ? count : 1, sizeof(*topology->cpus));
+    topology->masks =
+        calloc((size_t)(count ? count : 1) * ACPI_TOPOLOGY_MASK_COUNT *
+                   topology->words,
+               sizeof(uint64_t));
+    topology->cacheMasks =
+        calloc((size_t)(count ? count : 1) * ACPI_TOPOLOGY_MAX_CACHE_LEAVES *
+                   topology->words,
+               sizeof(uint64_t));
+    if (topology->cpus == NULL || topology->masks == NULL ||
+        topology->cacheMasks == NULL)
+        return -ENOMEM;
+    return 0;
+}
+
+/* PPTT */
+
+static int collect_pptt(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    TopologyPptt *pptt = data;
+    const uint8_t *base = table + subtable->offset;
+
+    if (subtable->layout == NULL)
+        return 0;
+    if (strcmp(subtable->layout->name, "PROCESSOR") == 0 &&
+        subtable->length >= sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)) {
+        TopologyNode *node;
+        uint32_t resources =
+            (subtable->length - sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)) /
+            sizeof(ACPI_PPTT_PRIVATE_RESOURCE);
+
+        if (grow((void **)&pptt->nodes, pptt->nodeCount, sizeof(*node)) < 0)
+            return -ENOMEM;
+        node = &pptt->nodes[pptt->nodeCount++];
+        memset(node, 0, sizeof(*node));
+        node->offset = subtable->offset;
+        node->flags = read_le32(
+            base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Flags));
+        node->parent = read_le32(
+            base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent));
+        node->id = read_le32(
+            base,
+            offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, AcpiProcessorId));
+        node->resourceCount =
+            read_le32(base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE,
+                                     NumberOfPrivateResources));
+        if (node->resourceCount > resources)
+            node->resourceCount = resources;
+    } else if (strcmp(subtable->layout->name, "CACHE") == 0 &&
+               subtable->length >= PPTT_CACHE_ID_OFFSET) {
+        TopologyCacheNode *cache;
+
+        if (grow((void **)&pptt->caches, pptt->cacheCount, sizeof(*cache)) < 0)
+            return -ENOMEM;
+        cache = &pptt->caches[pptt->cacheCount++];
+        memset(cache, 0, sizeof(*cache));
+        cache->offset = subtable->offset;
+        cache->flags =
+            read_le32(base, offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, Flags));
+        cache->next = read_le32(
+            base, offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, NextLevelOfCache));
+        cache->size =
+            read_le32(base, offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, Size));
+        cache->sets = read_le32(
+            base, offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, NumberOfSets));
+        cache->ways =
+            base[offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, Associativity)];
+        cache->attributes =
+            base[offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, Attributes)];
+        memcpy(&cache->lineSize,
+               base + offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, LineSize),
+               sizeof(cache->lineSize));
+        // update_cache_properties() only takes the ID from revision 3
+        if (pptt->revision >= 3 &&
+            subtable->length >= PPTT_CACHE_ID_OFFSET + sizeof(uint32_t) &&
+            (cache->flags & PPTT_CACHE_FLAG_CACHE_ID_VALID)) {
+            cache->hasCacheId = true;
+            cache->cacheId = read_le32(base, PPTT_CACHE_ID_OFFSET);
+        }
+    }
+    return 0;
+}
+
+// fetch_pptt_node(): index of the node at offset, -1 if there is none
+static int64_t find_node(const TopologyPptt *pptt, uint32_t offset) {
+    uint32_t low = 0, high = pptt->nodeCount;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (pptt->nodes[middle].offset < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < pptt->nodeCount && pptt->nodes[low].offset == offset
+               ? (int64_t)low
+               : -1;
+}
+
+// fetch_pptt_cache()
+static int64_t find_cache(const TopologyPptt *pptt, uint32_t offset) {
+    uint32_t low = 0, high = pptt->cacheCount;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (pptt->caches[middle].offset < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < pptt->cacheCount && pptt->caches[low].offset == offset
+               ? (int64_t)low
+               : -1;
+}
+
+// acpi_pptt_leaf_node()
+static bool is_leaf(const TopologyPptt *pptt, const TopologyNode *node) {
+    if (pptt->revision > 1 && (node->flags & PPTT_PROC_FLAG_NODE_IS_LEAF))
+        return true;
+    return !node->isParent;
+}
+
+static int compare_leaves(const void *a, const void *b) {
+    const TopologyLeaf *left = a, *right = b;
+
+    if (left->id != right->id)
+        return left->id < right->id ? -1 : 1;
+    return left->node < right->node ? -1 : left->node > right->node;
+}
+
+static int index_leaves(TopologyPptt *pptt) {
+    for (uint32_t i = 0; i < pptt->nodeCount; i++) {
+        int64_t parent = find_node(pptt, pptt->nodes[i].parent);
+        if (pptt->nodes[i].parent != 0 && parent >= 0)
+            pptt->nodes[parent].isParent = true;
+    }
+
+    pptt->leaves = malloc((pptt->nodeCount ? pptt->nodeCount : 1) *
+                          sizeof(*pptt->leaves));
+    if (pptt->leaves == NULL)
+        return -ENOMEM;
+    for (uint32_t i = 0; i < pptt->nodeCount; i++) {
+        if (is_leaf(pptt, &pptt->nodes[i]))
+            pptt->leaves[pptt->leafCount++] =
+                (TopologyLeaf){pptt->nodes[i].id, i};
+    }
+    qsort(pptt->leaves, pptt->leafCount, sizeof(*pptt->leaves),
+          compare_leaves);
+    return 0;
+}
+
+/**
+ * acpi_find_processor_node(): the first leaf in table order with the ACPI
+ * processor ID, the validity flag is not looked at.
+ */
+static int64_t find_processor(const TopologyPptt *pptt, uint32_t uid) {
+    uint32_t low = 0, high = pptt->leafCount;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (pptt->leaves[middle].id < uid)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low < pptt->leafCount && pptt->leaves[low].id == uid
+               ? (int64_t)pptt->leaves[low].node
+               : -1;
+}
+
+// Parent of a node, -1 for the root or a reference that is no node
+static int64_t parent_of(const TopologyPptt *pptt, uint32_t node) {
+    if (pptt->nodes[node].parent == 0)
+        return -1;
+    return find_node(pptt, pptt->nodes[node].parent);
+}
+
+// acpi_find_processor_tag()
+static uint32_t find_tag(const TopologyPptt *pptt, uint32_t node,
+                         unsigned level, uint32_t flag) {
+    while (level > 0) {
+        int64_t parent;
+
+        if (pptt->nodes[node].flags & flag)
+            break;
+        parent = parent_of(pptt, node);
+        if (parent < 0)
+            break;
+        node = (uint32_t)parent;
+        level--;
+    }
+    return node;
+}
+
+static int64_t node_id(const TopologyPptt *pptt, uint32_t node, bool actual) {
+    if (actual || (pptt->nodes[node].flags & PPTT_PROC_FLAG_ACPI_PROC_ID_VALID))
+        return pptt->nodes[node].id;
+    return pptt->nodes[node].offset;
+}
+
+// topology_get_acpi_cpu_tag()
+static int64_t cpu_tag(const TopologyPptt *pptt, uint32_t leaf, unsigned level,
+                       uint32_t flag) {
+    return node_id(pptt, find_tag(pptt, leaf, level, flag), level == 0);
+}
+
+// find_acpi_cpu_topology_cluster()
+static int64_t cluster_tag(const TopologyPptt *pptt, uint32_t leaf) {
+    int64_t cluster = parent_of(pptt, leaf);
+
+    if (cluster < 0)
+        return ACPI_TOPOLOGY_NO_ID;
+    if (pptt->nodes[leaf].flags & PPTT_PROC_FLAG_PROCESSOR_IS_THREAD) {
+        cluster = parent_of(pptt, (uint32_t)cluster);
+        if (cluster < 0)
+            return ACPI_TOPOLOGY_NO_ID;
+    }
+    return node_id(pptt, (uint32_t)cluster, false);
+}
+
+// acpi_pptt_match_type()
+static bool match_type(uint8_t attributes, uint8_t type) {
+    return (attributes & PPTT_CACHE_TYPE_MASK) == type ||
+           (attributes & PPTT_CACHE_TYPE_UNIFIED & type);
+}
+
+static uint8_t pptt_cache_type(uint8_t type) {
+    static const uint8_t types[] = {
+        [ACPI_TOPOLOGY_CACHE_DATA] = PPTT_CACHE_TYPE_DATA,
+        [ACPI_TOPOLOGY_CACHE_INSTRUCTION] = PPTT_CACHE_TYPE_INSTRUCTION,
+        [ACPI_TOPOLOGY_CACHE_UNIFIED] = PPTT_CACHE_TYPE_UNIFIED,
+    };
+    return types[type];
+}
+
+/**
+ * acpi_pptt_walk_cache(): follow a cache chain from a private resource.
+ *
+ * @retval  Level of the last cache of the chain, 0 if the resource is no
+ *          cache.
+ */
+static unsigned walk_cache(const TopologyPptt *pptt, unsigned localLevel,
+                           unsigned *splitLevels, uint32_t reference,
+                           int64_t *found, unsigned level, uint8_t type) {
+    int64_t cache = find_cache(pptt, reference);
+    uint32_t steps = 0;
+
+    if (cache < 0)
+        return 0;
+    // A loop in NextLevelOfCache would hang the kernel, stop here
+    while (cache >= 0 && steps++ <= pptt->cacheCount) {
+        const TopologyCacheNode *entry = &pptt->caches[cache];
+
+        localLevel++;
+        if (entry->flags & PPTT_CACHE_FLAG_CACHE_TYPE_VALID) {
+            if (splitLevels != NULL &&
+                (match_type(entry->attributes, PPTT_CACHE_TYPE_DATA) ||
+                 match_type(entry->attributes, PPTT_CACHE_TYPE_INSTRUCTION)))
+                *splitLevels = localLevel;
+            if (localLevel == level && match_type(entry->attributes, type)) {
+                if (*found >= 0 && *found != cache)
+                    note(pptt->topology,
+                         "PPTT 0x%03X: duplicate level %u cache, also at "
+                         "0x%03X",
+                         entry->offset, level, pptt->caches[*found].offset);
+                *found = cache;
+            }
+        }
+        cache = find_cache(pptt, entry->next);
+    }
+    return localLevel;
+}
+
+// acpi_find_cache_level()
+static int64_t find_cache_level(const TopologyPptt *pptt, uint32_t node,
+                                unsigned *startingLevel, unsigned *splitLevels,
+                                unsigned level, uint8_t type) {
+    const TopologyNode *entry = &pptt->nodes[node];
+    unsigned levels = *startingLevel;
+    int64_t found = -1;
+
+    for (uint32_t i = 0; i < entry->resourceCount; i++) {
+        uint32_t reference = read_le32(
+            pptt->table, entry->offset +
+                             sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +
+                             i * sizeof(ACPI_PPTT_PRIVATE_RESOURCE));
+        unsigned localLevel = walk_cache(pptt, *startingLevel, splitLevels,
+                                         reference, &found, level, type);
+        if (localLevel > levels)
+            levels = localLevel;
+    }
+    if (levels > *startingLevel)
+        *startingLevel = levels;
+    return found;
+}
+
+// acpi_get_cache_info() and cache_setup_acpi_cpu()
+static void setup_caches(const TopologyPptt *pptt, AcpiTopologyCpu *cpu) {
+    unsigned levels = 0, splitLevels = 0;
+
+    for (int64_t node = cpu->leaf ? find_node(pptt, cpu->leaf) : -1;
+         node >= 0; node = parent_of(pptt, (uint32_t)node))
+        find_cache_level(pptt, (uint32_t)node, &levels, &splitLevels, 0, 0);
+    cpu->cacheLevels = levels;
+    cpu->splitLevels = splitLevels;
+
+    for (unsigned level = 1; level <= levels; level++) {
+        uint8_t types[2] = {ACPI_TOPOLOGY_CACHE_UNIFIED};
+        unsigned typeCount = 1;
+
+        if (level <= splitLevels) {
+            types[0] = ACPI_TOPOLOGY_CACHE_DATA;
+            types[1] = ACPI_TOPOLOGY_CACHE_INSTRUCTION;
+            typeCount = 2;
+        }
+        for (unsigned t = 0; t < typeCount; t++) {
+            AcpiTopologyCache *leaf;
+            unsigned total = 0;
+            int64_t found = -1;
+            int64_t node = find_node(pptt, cpu->leaf);
+
+            if (cpu->leafCount == ACPI_TOPOLOGY_MAX_CACHE_LEAVES)
+                return;
+            leaf = &cpu->caches[cpu->leafCount++];
+            leaf->level = (uint8_t)level;
+            leaf->type = types[t];
+
+            // acpi_find_cache_node(): from the leaf up to the first match
+            while (node >= 0 && found < 0) {
+                found = find_cache_level(pptt, (uint32_t)node, &total, NULL,
+                                         level, pptt_cache_type(types[t]));
+                leaf->token = pptt->nodes[node].offset;
+                node = parent_of(pptt, (uint32_t)node);
+            }
+            if (found < 0) {
+                leaf->token = 0;
+                continue;
+            }
+            leaf->offset = pptt->caches[found].offset;
+            leaf->hasCacheId = pptt->caches[found].hasCacheId;
+            leaf->cacheId = pptt->caches[found].cacheId;
+            leaf->size = pptt->caches[found].size;
+            leaf->sets = pptt->caches[found].sets;
+            leaf->ways = pptt->caches[found].ways;
+            leaf->lineSize = pptt->caches[found].lineSize;
+        }
+    }
+}
+
+/**
+ * One note per cache leaf level and type that some CPUs found no PPTT
+ * cache for, with the list of those CPUs.
+ */
+static void note_missing_caches(AcpiTopology *topology) {
+    uint64_t *missing = calloc(topology->words, sizeof(uint64_t));
+
+    if (missing == NULL)
+        return;
+    for (uint32_t i = 0; i < topology->cpuCount; i++) {
+        for (uint32_t l = 0; l < topology->cpus[i].leafCount; l++) {
+            const AcpiTopologyCache *leaf = &topology->cpus[i].caches[l];
+            bool reported = false;
+            char list[ACPI_TOPOLOGY_MESSAGE_SIZE / 2];
+
+            if (leaf->offset != 0)
+                continue;
+            memset(missing, 0, topology->words * sizeof(uint64_t));
+            for (uint32_t j = 0; j < topology->cpuCount && !reported; j++) {
+                const AcpiTopologyCpu *other = &topology->cpus[j];
+                for (uint32_t m = 0; m < other->leafCount; m++) {
+                    if (other->caches[m].offset != 0 ||
+                        other->caches[m].level != leaf->level ||
+                        other->caches[m].type != leaf->type)
+                        continue;
+                    // Reported with the first CPU missing it
+                    reported = j < i;
+                    missing[j / 64] |= 1ULL << (j % 64);
+                }
+            }
+            if (reported)
+                continue;
+            acpi_topology_format_list(topology, missing, list, sizeof(list));
+            note(topology,
+                 "No PPTT cache with a valid type for L%u %s, CPUs %s",
+                 leaf->level, acpi_topology_cache_type_names[leaf->type],
+                 list);
+        }
+    }
+    free(missing);
+}
+
+/* Masks */
+
+// cache_leaves_are_shared()
+static bool leaves_shared(const AcpiTopologyCache *a,
+                          const AcpiTopologyCache *b) {
+    if (a->hasCacheId && b->hasCacheId)
+        return a->cacheId == b->cacheId;
+    return a->token != 0 && a->token == b->token;
+}
+
+// last_level_cache_is_valid()
+static bool llc_valid(const AcpiTopologyCpu *cpu) {
+    const AcpiTopologyCache *llc;
+
+    if (cpu->leafCount == 0)
+        return false;
+    llc = &cpu->caches[cpu->leafCount - 1];
+    return llc->hasCacheId || llc->token != 0;
+}
+
+/**
+ * cache_shared_cpu_map_setup(), update_siblings_masks(),
+ * cpu_coregroup_mask() and cpu_clustergroup_mask() for every CPU pair.
+ */
+static void build_masks(AcpiTopology *topology) {
+    uint32_t count = topology->cpuCount;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const AcpiTopologyCpu *cpu = &topology->cpus[i];
+
+        for (uint32_t mask = 0; mask < ACPI_TOPOLOGY_MASK_COUNT; mask++)
+            mask_set(mask_at(topology, i, mask), i);
+        for (uint32_t leaf = 0; leaf < cpu->leafCount; leaf++)
+            mask_set(cache_mask_at(topology, i, leaf), i);
+
+        for (uint32_t j = i + 1; j < count; j++) {
+            const AcpiTopologyCpu *other = &topology->cpus[j];
+
+            for (uint32_t leaf = 0;
+                 leaf < cpu->leafCount && leaf < other->leafCount; leaf++) {
+                if (!leaves_shared(&cpu->caches[leaf], &other->caches[leaf]))
+                    continue;
+                mask_set(cache_mask_at(topology, i, leaf), j);
+                mask_set(cache_mask_at(topology, j, leaf), i);
+            }
+
+            if (llc_valid(cpu) && llc_valid(other) &&
+                leaves_shared(&cpu->caches[cpu->leafCount - 1],
+                              &other->caches[other->leafCount - 1])) {
+                mask_set(mask_at(topology, i, ACPI_TOPOLOGY_LLC_SIBLINGS), j);
+                mask_set(mask_at(topology, j, ACPI_TOPOLOGY_LLC_SIBLINGS), i);
+            }
+            if (cpu->packageId != other->packageId)
+                continue;
+            mask_set(mask_at(topology, i, ACPI_TOPOLOGY_CORE_SIBLINGS), j);
+            mask_set(mask_at(topology, j, ACPI_TOPOLOGY_CORE_SIBLINGS), i);
+            if (cpu->clusterId != other->clusterId)
+                continue;
+            if (cpu->clusterId >= 0) {
+                mask_set(mask_at(topology, i, ACPI_TOPOLOGY_CLUSTER_CPUS), j);
+                mask_set(mask_at(topology, j, ACPI_TOPOLOGY_CLUSTER_CPUS), i);
+            }
+            if (cpu->coreId != other->coreId)
+                continue;
+            mask_set(mask_at(topology, i, ACPI_TOPOLOGY_THREAD_SIBLINGS), j);
+            mask_set(mask_at(topology, j, ACPI_TOPOLOGY_THREAD_SIBLINGS), i);
+        }
+    }
+
+    // Scheduler domains, one NUMA node spanning every CPU
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t *coregroup = mask_at(topology, i, ACPI_TOPOLOGY_COREGROUP);
+        const uint64_t *cluster =
+            mask_at(topology, i, ACPI_TOPOLOGY_CLUSTER_CPUS);
+        const uint64_t *core =
+            mask_at(topology, i, ACPI_TOPOLOGY_CORE_SIBLINGS);
+        const uint64_t *llc = mask_at(topology, i, ACPI_TOPOLOGY_LLC_SIBLINGS);
+        const uint64_t *chosen = core;
+
+        if (llc_valid(&topology->cpus[i]) &&
+            mask_subset(llc, chosen, topology->words))
+            chosen = llc;
+        if (mask_subset(chosen, cluster, topology->words))
+            chosen = cluster;
+        memcpy(coregroup, chosen, topology->words * sizeof(uint64_t));
+
+        chosen = mask_subset(coregroup, cluster, topology->words)
+                     ? mask_at(topology, i, ACPI_TOPOLOGY_THREAD_SIBLINGS)
+                     : cluster;
+        memcpy(mask_at(topology, i, ACPI_TOPOLOGY_CLUSTERGROUP), chosen,
+               topology->words * sizeof(uint64_t));
+    }
+}
+
+// reset_cpu_topology() followed by store_cpu_topology()
+static void reset_topology(AcpiTopology *topology) {
+    for (uint32_t i = 0; i < topology->cpuCount; i++) {
+        topology->cpus[i].threadId = -1;
+        topology->cpus[i].coreId = i;
+        topology->cpus[i].clusterId = -1;
+        topology->cpus[i].packageId = 0;
+    }
+}
+
+/* MADT */
+
+typedef struct {
+    AcpiTopology *topology;
+    AcpiTopologyCpu *cpus; // Grown while walking, NULL to count only
+    uint32_t count;
+} TopologyMadt;
+
+// acpi_map_gic_cpu_interface()
+static int collect_madt(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    TopologyMadt *madt = data;
+    const uint8_t *base = table + subtable->offset;
+    AcpiTopologyCpu *cpu;
+    uint32_t flags;
+    uint64_t mpidr;
+
+    if (subtable->layout == NULL ||
+        strcmp(subtable->layout->name, "GICC") != 0 ||
+        subtable->length <=
+            offsetof(MADT_GICC_STRUCTURE, ProcessorPowerEfficiencyClass))
+        return 0;
+    flags = read_le32(base, offsetof(MADT_GICC_STRUCTURE, Flags));
+    mpidr = read_le64(base, offsetof(MADT_GICC_STRUCTURE, MPIDR));
+    if (!(flags & (MADT_GICC_FLAG_ENABLED | MADT_GICC_FLAG_ONLINE_CAPABLE)))
+        return 0;
+    if (mpidr & ~MPIDR_HWID_BITMASK) {
+        note(madt->topology,
+             "MADT 0x%03X: invalid MPIDR 0x%llX, CPU skipped",
+             subtable->offset, (unsigned long long)mpidr);
+        return 0;
+    }
+    for (uint32_t i = 0; i < madt->count; i++) {
+        if (madt->cpus[i].mpidr == mpidr) {
+            note(madt->topology,
+                 "MADT 0x%03X: duplicate MPIDR 0x%llX, CPU skipped",
+                 subtable->offset, (unsigned long long)mpidr);
+            return 0;
+        }
+    }
+
+    if (grow((void **)&madt->cpus, madt->count, sizeof(*cpu)) < 0)
+        return -ENOMEM;
+    cpu = &madt->cpus[madt->count++];
+    memset(cpu, 0, sizeof(*cpu));
+    cpu->uid = read_le32(base, offsetof(MADT_GICC_STRUCTURE, ACPIProcessorUID));
+    cpu->mpidr = mpidr;
+    cpu->efficiencyClass =
+        base[offsetof(MADT_GICC_STRUCTURE, ProcessorPowerEfficiencyClass)];
+    return 0;
+}
+
+/**
+ * Simulate the topology Linux derives from a PPTT and a MADT.
+ *
+ * @param pptt      PPTT table.
+ * @param madt      MADT table, or NULL: the CPUs are then the PPTT leaves
+ *                  in table order.
+ * @param topology  Result, free with acpi_topology_free().
+ * @retval 0        Success, topology->notes holds what the kernel would
+ *                  warn about.
+ * @retval -EINVAL  A table is truncated or its subtables are malformed.
+ * @retval -ENOMEM  Out of memory.
+ */
+int acpi_topology_simulate(const uint8_t *pptt, size_t ppttSize,
+                           const uint8_t *madt, size_t madtSize,
+                           AcpiTopology *topology) {
+    TopologyPptt tree = {.table = pptt, .topology = topology};
+    TopologyMadt gicc = {.topology = topology};
+    bool threaded = false, dropped = false;
+    int ret;
+
+    memset(topology, 0, sizeof(*topology));
+    if (ppttSize < sizeof(ACPI_TABLE_HEADER) ||
+        (madt != NULL && madtSize < sizeof(ACPI_TABLE_HEADER)))
+        return -EINVAL;
+    tree.revision = ((const ACPI_TABLE_HEADER *)pptt)->Revision;
+    topology->ppttRevision = tree.revision;
+    topology->hasMpidr = madt != NULL;
+    topology->hasCaches = true;
+
+    ret = acpi_layout_walk(pptt, ppttSize, acpi_layout_find("PPTT"),
+                           collect_pptt, &tree);
+    if (ret == 0)
+        ret = index_leaves(&tree);
+    if (ret == 0 && madt != NULL)
+        ret = acpi_layout_walk(madt, madtSize, acpi_layout_find("APIC"),
+                               collect_madt, &gicc);
+    if (ret < 0)
+        goto out;
+
+    if (madt != NULL) {
+        ret = allocate_cpus(topology, gicc.count);
+        if (ret < 0)
+            goto out;
+        if (gicc.count)
+            memcpy(topology->cpus, gicc.cpus, gicc.count * sizeof(*gicc.cpus));
+        // acpi_cpu_is_threaded() falls back to the boot CPU before rev 2
+        threaded = gicc.count && (gicc.cpus[0].mpidr & MPIDR_MT_BITMASK);
+    } else {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < tree.nodeCount; i++)
+            count += is_leaf(&tree, &tree.nodes[i]);
+        ret = allocate_cpus(topology, count);
+        if (ret < 0)
+            goto out;
+        count = 0;
+        for (uint32_t i = 0; i < tree.nodeCount; i++) {
+            if (is_leaf(&tree, &tree.nodes[i]))
+                topology->cpus[count++].uid = tree.nodes[i].id;
+        }
+        note(topology, "No MADT: CPUs are the %u PPTT leaves in table order",
+             count);
+    }
+
+    // parse_acpi_topology()
+    for (uint32_t i = 0; i < topology->cpuCount; i++) {
+        AcpiTopologyCpu *cpu = &topology->cpus[i];
+        int64_t leaf = find_processor(&tree, cpu->uid);
+        bool thread;
+
+        if (leaf < 0) {
+            note(topology, "UID %u: no PPTT leaf, Linux drops the PPTT "
+                           "topology",
+                 cpu->uid);
+            dropped = true;
+            continue;
+        }
+        cpu->leaf = tree.nodes[leaf].offset;
+        thread = tree.revision >= 2
+                     ? tree.nodes[leaf].flags &
+                           PPTT_PROC_FLAG_PROCESSOR_IS_THREAD
+                     : threaded;
+        if (thread) {
+            cpu->threadId = cpu_tag(&tree, (uint32_t)leaf, 0, 0);
+            cpu->coreId = cpu_tag(&tree, (uint32_t)leaf, 1, 0);
+        } else {
+            cpu->threadId = -1;
+            cpu->coreId = cpu_tag(&tree, (uint32_t)leaf, 0, 0);
+        }
+        cpu->clusterId = cluster_tag(&tree, (uint32_t)leaf);
+        cpu->packageId = cpu_tag(&tree, (uint32_t)leaf, PPTT_ABORT_PACKAGE,
+                                 PPTT_PROC_FLAG_PHYSICAL_PACKAGE);
+        setup_caches(&tree, cpu);
+    }
+    if (dropped)
+        reset_topology(topology);
+    note_missing_caches(topology);
+    build_masks(topology);
+
+out:
+    free(tree.nodes);
+    free(tree.caches);
+    free(tree.leaves);
+    free(gicc.cpus);
+    if (ret < 0)
+        acpi_topology_free(topology);
+    return ret;
+}
+
+/* Device tree */
+
+typedef struct {
+    const FdtTree *tree;
+    AcpiTopology *topology;
+    uint32_t *cpuNodes; // Logical CPU -> /cpus child
+    int64_t coreId;     // Counter across clusters, as in parse_cluster()
+    int error;
+} TopologyDt;
+
+// of_node_name_eq(): the name up to the unit address
+static bool name_equals(const char *name, const char *expected) {
+    size_t length = strcspn(name, "@");
+    return strlen(expected) == length && strncmp(name, expected, length) == 0;
+}
+
+static uint32_t child_named(const FdtTree *tree, uint32_t node,
+                            const char *format, unsigned index) {
+    char name[TOPOLOGY_DT_MAX_NAME];
+
+    snprintf(name, sizeof(name), format, index);
+    for (uint32_t child = tree->nodes[node].firstChild; child != FDT_NO_NODE;
+         child = tree->nodes[child].nextSibling) {
+        if (name_equals(tree->nodes[child].name, name))
+            return child;
+    }
+    return FDT_NO_NODE;
+}
+
+static uint32_t phandle_of(const FdtTree *tree, uint32_t node,
+                           const char *property) {
+    const FdtProperty *value = fdt_get_property(tree, node, property);
+
+    if (value == NULL || fdt_property_cells(value) < 1)
+        return FDT_NO_NODE;
+    return fdt_find_phandle(tree, fdt_property_cell(value, 0));
+}
+
+// get_cpu_for_node()
+static int64_t cpu_for_node(const TopologyDt *dt, uint32_t node) {
+    uint32_t cpu = phandle_of(dt->tree, node, "cpu");
+
+    for (uint32_t i = 0; cpu != FDT_NO_NODE && i < dt->topology->cpuCount;
+         i++) {
+        if (dt->cpuNodes[i] == cpu)
+            return i;
+    }
+    return -1;
+}
+
+static void set_cpu(TopologyDt *dt, int64_t cpu, int64_t package,
+                    int64_t cluster, int64_t core, int64_t thread) {
+    AcpiTopologyCpu *entry = &dt->topology->cpus[cpu];
+
+    entry->packageId = package;
+    entry->clusterId = cluster;
+    entry->coreId = core;
+    entry->threadId = thread;
+}
+
+// parse_core()
+static void parse_core(TopologyDt *dt, uint32_t core, int64_t package,
+                       int64_t cluster, int64_t coreId) {
+    bool leaf = true;
+    int64_t cpu;
+
+    for (unsigned i = 0;; i++) {
+        uint32_t thread = child_named(dt->tree, core, "thread%u", i);
+        if (thread == FDT_NO_NODE)
+            break;
+        leaf = false;
+        cpu = cpu_for_node(dt, thread);
+        if (cpu < 0) {
+            dt->error = -EINVAL;
+            return;
+        }
+        set_cpu(dt, cpu, package, cluster, coreId, i);
+    }
+
+    cpu = cpu_for_node(dt, core);
+    if (cpu >= 0) {
+        if (!leaf)
+            dt->error = -EINVAL; // Core has both threads and a CPU
+        else
+            set_cpu(dt, cpu, package, cluster, coreId, -1);
+    } else if (leaf) {
+        dt->error = -EINVAL;
+    }
+}
+
+// parse_cluster()
+static void parse_cluster(TopologyDt *dt, uint32_t cluster, int64_t package,
+                          int64_t clusterId, unsigned depth) {
+    bool leaf = true;
+
+    for (unsigned i = 0; dt->error == 0; i++) {
+        uint32_t child = child_named(dt->tree, cluster, "cluster%u", i);
+        if (child == FDT_NO_NODE)
+            break;
+        leaf = false;
+        parse_cluster(dt, child, package, i, depth + 1);
+    }
+    for (unsigned i = 0; dt->error == 0; i++) {
+        uint32_t core = child_named(dt->tree, cluster, "core%u", i);
+        if (core == FDT_NO_NODE)
+            break;
+        if (depth == 0 || !leaf) {
+            dt->error = -EINVAL;
+            return;
+        }
+        parse_core(dt, core, package, clusterId, dt->coreId++);
+    }
+}
+
+static uint64_t cpu_hwid(const FdtTree *tree, uint32_t cpus, uint32_t node) {
+    const FdtProperty *cells = fdt_get_property(tree, cpus, "#address-cells");
+    const FdtProperty *reg = fdt_get_property(tree, node, "reg");
+    uint32_t count = cells != NULL && fdt_property_cells(cells) > 0
+                         ? fdt_property_cell(cells, 0)
+                         : 2;
+    uint64_t hwid = 0;
+
+    if (reg == NULL || fdt_property_cells(reg) < count || count > 2)
+        return 0;
+    for (uint32_t i = 0; i < count; i++)
+        hwid = (hwid << 32) | fdt_property_cell(reg, i);
+    return hwid & MPIDR_HWID_BITMASK;
+}
+
+// Cache leaves of a DT CPU: private L1 split, then the next-level-cache
+// chain, each cache node shared by the CPUs that reach it
+static void dt_caches(const FdtTree *tree, uint32_t node,
+                      AcpiTopologyCpu *cpu) {
+    uint32_t cache = node;
+
+    cpu->caches[0] = (AcpiTopologyCache){
+        .level = 1, .type = ACPI_TOPOLOGY_CACHE_DATA, .token = node + 1};
+    cpu->caches[1] = (AcpiTopologyCache){
+        .level = 1, .type = ACPI_TOPOLOGY_CACHE_INSTRUCTION,
+        .token = node + 1};
+    cpu->leafCount = 2;
+    cpu->cacheLevels = 1;
+    cpu->splitLevels = 1;
+
+    // of_find_next_cache_node()
+    while (cpu->leafCount < ACPI_TOPOLOGY_MAX_CACHE_LEAVES) {
+        uint32_t next = phandle_of(tree, cache, "l2-cache");
+        if (next == FDT_NO_NODE)
+            next = phandle_of(tree, cache, "next-level-cache");
+        if (next == FDT_NO_NODE || next == cache)
+            break;
+        cache = next;
+        cpu->cacheLevels++;
+        cpu->caches[cpu->leafCount++] = (AcpiTopologyCache){
+            .level = (uint8_t)cpu->cacheLevels,
+            .type = ACPI_TOPOLOGY_CACHE_UNIFIED,
+            .token = cache + 1};
+    }
+}
+
+/**
+ * Topology Linux takes from a device tree: logical CPUs are the cpu nodes
+ * of /cpus in order, IDs come from /cpus/cpu-map (parse_dt_topology()) and
+ * caches from the next-level-cache chains.
+ *
+ * @retval 0        Success, a cpu-map Linux rejects is a note and leaves
+ *                  every CPU its own core.
+ * @retval -ENOENT  No /cpus node or no cpu node in it.
+ * @retval -ENOMEM  Out of memory.
+ */
+int acpi_topology_from_dtb(const FdtTree *tree, AcpiTopology *topology) {
+    TopologyDt dt = {.tree = tree, .topology = topology};
+    uint32_t cpus = fdt_find_path(tree, "/cpus");
+    uint32_t count = 0, map;
+    int ret;
+
+    memset(topology, 0, sizeof(*topology));
+    if (cpus == FDT_NO_NODE)
+        return -ENOENT;
+    for (uint32_t child = tree->nodes[cpus].firstChild; child != FDT_NO_NODE;
+         child = tree->nodes[child].nextSibling) {
+        const FdtProperty *type = fdt_get_property(tree, child, "device_type");
+        if (type != NULL && fdt_property_has_string(type, "cpu"))
+            count++;
+    }
+    if (count == 0)
+        return -ENOENT;
+
+    ret = allocate_cpus(topology, count);
+    dt.cpuNodes = malloc(count * sizeof(*dt.cpuNodes));
+    if (ret < 0 || dt.cpuNodes == NULL) {
+        ret = -ENOMEM;
+        goto out;
+    }
+    topology->hasMpidr = true;
+    topology->hasCaches = true;
+    count = 0;
+    for (uint32_t child = tree->nodes[cpus].firstChild; child != FDT_NO_NODE;
+         child = tree->nodes[child].nextSibling) {
+        const FdtProperty *type = fdt_get_property(tree, child, "device_type");
+        if (type == NULL || !fdt_property_has_string(type, "cpu"))
+            continue;
+        dt.cpuNodes[count] = child;
+        topology->cpus[count].uid = count;
+        topology->cpus[count].mpidr = cpu_hwid(tree, cpus, child);
+        topology->cpus[count].packageId = -1;
+        dt_caches(tree, child, &topology->cpus[count]);
+        count++;
+    }
+
+    map = child_named(tree, cpus, "cpu-map", 0);
+    if (map == FDT_NO_NODE) {
+        note(topology, "No /cpus/cpu-map: every CPU is its own core");
+        dt.error = -ENOENT;
+    } else {
+        bool sockets = false;
+        // parse_socket()
+        for (unsigned i = 0; dt.error == 0; i++) {
+            uint32_t socket = child_named(tree, map, "socket%u", i);
+            if (socket == FDT_NO_NODE)
+                break;
+            sockets = true;
+            parse_cluster(&dt, socket, i, -1, 0);
+        }
+        if (!sockets)
+            parse_cluster(&dt, map, 0, -1, 0);
+        for (uint32_t i = 0; dt.error == 0 && i < count; i++) {
+            if (topology->cpus[i].packageId < 0)
+                dt.error = -EINVAL;
+        }
+        if (dt.error != 0)
+            note(topology, "cpu-map is incomplete or malformed, Linux drops "
+                           "it: every CPU is its own core");
+    }
+    if (dt.error != 0)
+        reset_topology(topology);
+    build_masks(topology);
+
+out:
+    free(dt.cpuNodes);
+    if (ret < 0)
+        acpi_topology_free(topology);
+    return ret;
+}
+
+/* Diff */
+
+static void report(AcpiTopologyDiffCallback callback, void *context,
+                   const char *format, ...) {
+    char message[ACPI_TOPOLOGY_MESSAGE_SIZE * 2];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    callback(message, context);
+}
+
+/**
+ * Compare two masks, expected one in the numbering of the other topology.
+ */
+static bool compare_mask(const AcpiTopology *actual, const uint64_t *mask,
+                         const AcpiTopology *expected, const uint64_t *want,
+                         const int64_t *toActual, uint64_t *scratch) {
+    memset(scratch, 0, actual->words * sizeof(uint64_t));
+    for (uint32_t e = 0; e < expected->cpuCount; e++) {
+        if (toActual[e] >= 0 && mask_test(want, e))
+            mask_set(scratch, (uint32_t)toActual[e]);
+    }
+    return memcmp(scratch, mask, actual->words * sizeof(uint64_t)) == 0;
+}
+
+/**
+ * Compare the topology from the tables with the one from a DTB. CPUs are
+ * paired by MPIDR when both know it, by logical number otherwise.
+ *
+ * @param callback  Called with one message per difference.
+ * @retval          Number of differences.
+ */
+size_t acpi_topology_diff(const AcpiTopology *actual,
+                          const AcpiTopology *expected,
+                          AcpiTopologyDiffCallback callback, void *context) {
+    static const enum ACPI_TOPOLOGY_MASK compared[] = {
+        ACPI_TOPOLOGY_THREAD_SIBLINGS,
+        ACPI_TOPOLOGY_CORE_SIBLINGS,
+        ACPI_TOPOLOGY_CLUSTER_CPUS,
+    };
+    int64_t *toActual = malloc((expected->cpuCount + 1) * sizeof(*toActual));
+    uint64_t *scratch = calloc(actual->words, sizeof(uint64_t));
+    bool *paired = calloc(actual->cpuCount + 1, sizeof(*paired));
+    char have[ACPI_TOPOLOGY_MESSAGE_SIZE / 2];
+    char want[ACPI_TOPOLOGY_MESSAGE_SIZE / 2];
+    bool byMpidr = actual->hasMpidr && expected->hasMpidr;
+    size_t differences = 0;
+
+    if (toActual == NULL || scratch == NULL || paired == NULL) {
+        report(callback, context, "Out of memory comparing the topologies");
+        differences = 1;
+        goto out;
+    }
+
+    for (uint32_t e = 0; e < expected->cpuCount; e++) {
+        toActual[e] = -1;
+        for (uint32_t a = 0; a < actual->cpuCount; a++) {
+            if (byMpidr ? actual->cpus[a].mpidr == expected->cpus[e].mpidr
+                        : a == e) {
+                toActual[e] = a;
+                paired[a] = true;
+                break;
+            }
+        }
+        if (toActual[e] < 0) {
+            report(callback, context, "DTB cpu %u (MPIDR 0x%llX) is no CPU "
+                                      "of the tables",
+                   e, (unsigned long long)expected->cpus[e].mpidr);
+            differences++;
+        }
+    }
+    for (uint32_t a = 0; a < actual->cpuCount; a++) {
+        if (!paired[a]) {
+            report(callback, context, "cpu%u (UID %u) has no DTB cpu node", a,
+                   actual->cpus[a].uid);
+            differences++;
+        }
+    }
+
+    for (uint32_t e = 0; e < expected->cpuCount; e++) {
+        const AcpiTopologyCpu *want_cpu = &expected->cpus[e];
+        const AcpiTopologyCpu *cpu;
+        uint32_t a;
+
+        if (toActual[e] < 0)
+            continue;
+        a = (uint32_t)toActual[e];
+        cpu = &actual->cpus[a];
+        for (size_t m = 0; m < sizeof(compared) / sizeof(compared[0]); m++) {
+            const uint64_t *mask = mask_at(actual, a, compared[m]);
+            const uint64_t *wanted = mask_at(expected, e, compared[m]);
+            if (compare_mask(actual, mask, expected, wanted, toActual,
+                             scratch))
+                continue;
+            acpi_topology_format_list(actual, mask, have, sizeof(have));
+            acpi_topology_format_list(actual, scratch, want, sizeof(want));
+            report(callback, context, "cpu%u %s: tables %s, DTB %s", a,
+                   acpi_topology_mask_names[compared[m]], have, want);
+            differences++;
+        }
+
+        if (!actual->hasCaches || !expected->hasCaches)
+            continue;
+        for (uint32_t w = 0; w < want_cpu->leafCount; w++) {
+            const AcpiTopologyCache *leaf = &want_cpu->caches[w];
+            uint32_t l;
+
+            for (l = 0; l < cpu->leafCount; l++) {
+                if (cpu->caches[l].level == leaf->level &&
+                    cpu->caches[l].type == leaf->type)
+                    break;
+            }
+            // Without a PPTT cache the kernel takes the type from CLIDR
+            for (uint32_t u = 0; l == cpu->leafCount && u < cpu->leafCount;
+                 u++) {
+                if (cpu->caches[u].level == leaf->level &&
+                    cpu->caches[u].offset == 0)
+                    l = u;
+            }
+            if (l == cpu->leafCount) {
+                report(callback, context,
+                       "cpu%u L%u %s: in the DTB, not in the tables", a,
+                       leaf->level, acpi_topology_cache_type_names[leaf->type]);
+                differences++;
+                continue;
+            }
+            if (compare_mask(actual, cache_mask_at(actual, a, l), expected,
+                             cache_mask_at(expected, e, w), toActual, scratch))
+                continue;
+            acpi_topology_format_list(actual, cache_mask_at(actual, a, l),
+                                      have, sizeof(have));
+            acpi_topology_format_list(actual, scratch, want, sizeof(want));
+            report(callback, context,
+                   "cpu%u L%u %s shared_cpu_list: tables %s, DTB %s", a,
+                   leaf->level, acpi_topology_cache_type_names[leaf->type],
+                   have, want);
+            differences++;
+        }
+    }
+
+out:
+    free(toActual);
+    free(scratch);
+    free(paired);
+    return differences;
+}
+
+/**
+ * Compare two simulations of the same MADT with different PPTTs, e.g.
+ * before and after pptt_optimize(): CPUs, every mask and every cache leaf
+ * must match. Package/cluster/core IDs are not compared, they are table
+ * offsets for nodes without a valid ACPI processor ID.
+ *
+ * @param callback  Called with one message per difference.
+ * @retval          Number of differences.
+ */
+size_t acpi_topology_compare(const AcpiTopology *before,
+                             const AcpiTopology *after,
+                             AcpiTopologyDiffCallback callback,
+                             void *context) {
+    char was[ACPI_TOPOLOGY_MESSAGE_SIZE / 2];
+    char now[ACPI_TOPOLOGY_MESSAGE_SIZE / 2];
+    size_t differences = 0;
+
+    if (before->cpuCount != after->cpuCount) {
+        report(callback, context, "%u CPU(s) before, %u after",
+               before->cpuCount, after->cpuCount);
+        return 1;
+    }
+    for (uint32_t i = 0; i < before->cpuCount; i++) {
+        const AcpiTopologyCpu *old = &before->cpus[i], *cpu = &after->cpus[i];
+
+        if (old->uid != cpu->uid || old->mpidr != cpu->mpidr) {
+            report(callback, context, "cpu%u is UID %u before, UID %u after", i,
+                   old->uid, cpu->uid);
+            differences++;
+            continue;
+        }
+        for (int m = 0; m < ACPI_TOPOLOGY_MASK_COUNT; m++) {
+            if (memcmp(mask_at(before, i, m), mask_at(after, i, m),
+                       before->words * sizeof(uint64_t)) == 0)
+                continue;
+            acpi_topology_format_list(before, mask_at(before, i, m), was,
+                                      sizeof(was));
+            acpi_topology_format_list(after, mask_at(after, i, m), now,
+                                      sizeof(now));
+            report(callback, context, "cpu%u %s: %s before, %s after", i,
+                   acpi_topology_mask_names[m], was, now);
+            differences++;
+        }
+        if (old->leafCount != cpu->leafCount) {
+            report(callback, context, "cpu%u: %u cache leaves before, %u after",
+                   i, old->leafCount, cpu->leafCount);
+            differences++;
+            continue;
+        }
+        for (uint32_t l = 0; l < old->leafCount; l++) {
+            const AcpiTopologyCache *a = &old->caches[l], *b = &cpu->caches[l];
+
+            if (a->level != b->level || a->type != b->type ||
+                (a->offset == 0) != (b->offset == 0) ||
+                a->hasCacheId != b->hasCacheId || a->cacheId != b->cacheId ||
+                a->size != b->size || a->sets != b->sets ||
+                a->ways != b->ways || a->lineSize != b->lineSize) {
+                report(callback, context,
+                       "cpu%u index%u: L%u %s before, L%u %s after, or other "
+                       "properties",
+                       i, l, a->level, acpi_topology_cache_type_names[a->type],
+                       b->level, acpi_topology_cache_type_names[b->type]);
+                differences++;
+                continue;
+            }
+            if (memcmp(cache_mask_at(before, i, l), cache_mask_at(after, i, l),
+                       before->words * sizeof(uint64_t)) == 0)
+                continue;
+            acpi_topology_format_list(before, cache_mask_at(before, i, l), was,
+                                      sizeof(was));
+            acpi_topology_format_list(after, cache_mask_at(after, i, l), now,
+                                      sizeof(now));
+            report(callback, context,
+                   "cpu%u index%u shared_cpu_list: %s before, %s after", i, l,
+                   was, now);
+            differences++;
+        }
+    }
+    return differences;
+}
+
+void acpi_topology_free(AcpiTopology *topology) {
+    free(topology->cpus);
+    free(topology->masks);
+    free(topology->cacheMasks);
+    free(topology->notes);
+    memset(topology, 0, sizeof(*topology));
+}
@@ -0,0 +1,362 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "acpi_validate.h"
+#include "acpi_layout.h"
+#include "utils.h"
+#include <acpi.h>
+#include <common.h>
+#include <common/iort.h>
+#include <common/pptt.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char *const acpi_check_names[ACPI_CHECK_COUNT] = {
+    "signature", "length", "checksum", "subtables", "references",
+};
+
+const char *const acpi_check_status_names[] = {
+    "pass", "skip", "warn", "fail",
+};
+
+// Minimum size of tables without the standard header (FACS, FBPT)
+#define ACPI_SHORT_HEADER_SIZE 8
+
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+    const char *name; // Structure layout name, NULL if unknown
+} ValidateNode;
+
+typedef struct {
+    ValidateNode *nodes;
+    uint32_t count;
+    uint32_t unknown;
+    uint32_t firstUnknown;
+    int32_t unknownType;
+    bool oom;
+} ValidateWalk;
+
+/**
+ * Record a problem, only the first message and the worst status of a check
+ * are kept.
+ */
+static void report(AcpiValidation *result, enum ACPI_CHECK check,
+                   enum ACPI_CHECK_STATUS status, const char *format, ...) {
+    va_list args;
+
+    if (result->message[check][0] == '\0') {
+        va_start(args, format);
+        vsnprintf(result->message[check], ACPI_VALIDATE_MESSAGE_SIZE, format,
+                  args);
+        va_end(args);
+    }
+    if (status > result->status[check])
+        result->status[check] = status;
+}
+
+static int collect_node(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *context) {
+    ValidateWalk *walk = context;
+    ValidateNode *grown;
+
+    (void)table;
+    if (subtable->layout == NULL && walk->unknown++ == 0) {
+        walk->firstUnknown = subtable->offset;
+        walk->unknownType = subtable->type;
+    }
+
+    grown = realloc(walk->nodes, (walk->count + 1) * sizeof(*walk->nodes));
+    if (grown == NULL) {
+        walk->oom = true;
+        return -ENOMEM;
+    }
+    walk->nodes = grown;
+    walk->nodes[walk->count].offset = subtable->offset;
+    walk->nodes[walk->count].length = subtable->length;
+    walk->nodes[walk->count].name =
+        subtable->layout ? subtable->layout->name : NULL;
+    walk->count++;
+    return 0;
+}
+
+static const ValidateNode *find_node(const ValidateWalk *walk,
+                                     uint32_t offset) {
+    // Nodes are collected in offset order
+    uint32_t low = 0;
+    uint32_t high = walk->count;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (walk->nodes[mid].offset == offset)
+            return &walk->nodes[mid];
+        if (walk->nodes[mid].offset < offset)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+
+static bool node_is(const ValidateNode *node, const char *name) {
+    return node != NULL && node->name != NULL && strcmp(node->name, name) == 0;
+}
+
+/**
+ * Follow a chain of references (parents, next level caches) and report
+ * loops. A chain can not be longer than the number of nodes.
+ */
+static void check_chain(const uint8_t *table, const ValidateWalk *walk,
+                        const ValidateNode *start, uint32_t link_offset,
+                        AcpiValidation *result) {
+    const ValidateNode *node = start;
+
+    for (uint32_t steps = 0; steps <= walk->count; steps++) {
+        uint32_t next = read_le32(table, node->offset + link_offset);
+        if (next == 0)
+            return;
+        node = find_node(walk, next);
+        if (node == NULL || node->length < link_offset + 4)
+            return; // Reported by the reference check itself
+    }
+    report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+           "0x%03X: cyclic reference chain", start->offset);
+}
+
+static void check_pptt(const uint8_t *table, const ValidateWalk *walk,
+                       AcpiValidation *result) {
+    for (uint32_t i = 0; i < walk->count; i++) {
+        const ValidateNode *node = &walk->nodes[i];
+        const uint8_t *base = table + node->offset;
+
+        if (node_is(node, "PROCESSOR")) {
+            uint32_t parent, count;
+
+            // Fields are only read once the node is known to hold them
+            if (node->length < sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)) {
+                report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                       "0x%03X: processor node length %u is shorter than %zu",
+                       node->offset, node->length,
+                       sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE));
+                continue;
+            }
+            parent = read_le32(
+                base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent));
+            count = read_le32(base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE,
+                                              NumberOfPrivateResources));
+            if ((node->length - sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)) /
+                    sizeof(ACPI_PPTT_PRIVATE_RESOURCE) <
+                count) {
+                report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                       "0x%03X: %u private resources overflow node length %u",
+                       node->offset, count, node->length);
+                continue;
+            }
+
+            if (parent != 0) {
+                result->referenceCount++;
+                if (!node_is(find_node(walk, parent), "PROCESSOR"))
+                    report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                           "0x%03X: parent 0x%03X is not a processor node",
+                           node->offset, parent);
+                else
+                    check_chain(
+                        table, walk, node,
+                        offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent),
+                        result);
+            }
+
+            for (uint32_t r = 0; r < count; r++) {
+                uint32_t resource =
+                    read_le32(base, sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +
+                                        r * sizeof(ACPI_PPTT_PRIVATE_RESOURCE));
+                const ValidateNode *target = find_node(walk, resource);
+
+                result->referenceCount++;
+                if (target == NULL)
+                    report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                           "0x%03X: resource 0x%03X does not exist",
+                           node->offset, resource);
+                else if (!node_is(target, "CACHE") && !node_is(target, "ID"))
+                    report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_WARN,
+                           "0x%03X: resource 0x%03X is not a cache or ID node",
+                           node->offset, resource);
+            }
+        } else if (node_is(node, "CACHE")) {
+            uint32_t next;
+
+            if (node->length < offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE,
+                                        NextLevelOfCache) +
+                                   sizeof(next)) {
+                report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                       "0x%03X: cache node length %u has no next level",
+                       node->offset, node->length);
+                continue;
+            }
+            next = read_le32(base, offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE,
+                                             NextLevelOfCache));
+            if (next == 0)
+                continue;
+            result->referenceCount++;
+            if (!node_is(find_node(walk, next), "CACHE"))
+                report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                       "0x%03X: next level 0x%03X is not a cache node",
+                       node->offset, next);
+            else
+                check_chain(table, walk, node,
+                            offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE,
+                                     NextLevelOfCache),
+                            result);
+        }
+    }
+}
+
+static void check_iort(const uint8_t *table, const ValidateWalk *walk,
+                       AcpiValidation *result) {
+    for (uint32_t i = 0; i < walk->count; i++) {
+        const ValidateNode *node = &walk->nodes[i];
+        const uint8_t *base = table + node->offset;
+        uint32_t count, array;
+
+        if (node->length < sizeof(IORT_NODE_FORMAT))
+            continue; // Walker already enforces the minimum for Type/Length
+        count = read_le32(base, offsetof(IORT_NODE_FORMAT, NumOfIDMappings));
+        array =
+            read_le32(base, offsetof(IORT_NODE_FORMAT, ReferenceToIdArray));
+        if (count == 0)
+            continue;
+        if (array > node->length ||
+            (node->length - array) / sizeof(IORT_ID_MAPPING_FORMAT) < count) {
+            report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                   "0x%03X: %u ID mappings at 0x%X overflow node length %u",
+                   node->offset, count, array, node->length);
+            continue;
+        }
+
+        for (uint32_t m = 0; m < count; m++) {
+            uint32_t output =
+                read_le32(base, array + m * sizeof(IORT_ID_MAPPING_FORMAT) +
+                                    offsetof(IORT_ID_MAPPING_FORMAT,
+                                             OutputReference));
+            result->referenceCount++;
+            if (find_node(walk, output) == NULL)
+                report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_FAIL,
+                       "0x%03X: ID mapping %u output 0x%X is not a node",
+                       node->offset, m, output);
+        }
+    }
+}
+
+static bool signature_matches(const uint8_t *table, const char *expected) {
+    if (memcmp(table, expected, 4) == 0)
+        return true;
+    // Tables are named after their C structure, MADT carries APIC
+    return memcmp(expected, "MADT", 4) == 0 && memcmp(table, "APIC", 4) == 0;
+}
+
+/**
+ * Run every check on one table.
+ *
+ * @param table     Table content.
+ * @param size      Table file size.
+ * @param expected_signature    Signature expected from the file name (e.g.
+ *                              "MADT" for MADT.aml), NULL to skip the check.
+ * @param result    Filled with the status of every check.
+ */
+void acpi_validate_table(const uint8_t *table, size_t size,
+                         const char *expected_signature,
+                         AcpiValidation *result) {
+    const AcpiTableLayout *layout;
+    ValidateWalk walk = {0};
+    uint32_t length;
+    int ret;
+
+    memset(result, 0, sizeof(*result));
+
+    if (size < ACPI_SHORT_HEADER_SIZE) {
+        for (int check = 0; check < ACPI_CHECK_COUNT; check++)
+            report(result, check, ACPI_CHECK_FAIL, "table too small (%zu bytes)",
+                   size);
+        return;
+    }
+
+    if (expected_signature == NULL || strlen(expected_signature) != 4)
+        result->status[ACPI_CHECK_SIGNATURE] = ACPI_CHECK_SKIP;
+    else if (!signature_matches(table, expected_signature))
+        report(result, ACPI_CHECK_SIGNATURE, ACPI_CHECK_FAIL,
+               "signature %.4s, expected %s", (const char *)table,
+               expected_signature);
+
+    length = read_le32(table, 4);
+    if (length != size)
+        report(result, ACPI_CHECK_LENGTH, ACPI_CHECK_FAIL,
+               "header length %u, file size %zu", length, size);
+    if (table_has_checksum((const char *)table) &&
+        size < sizeof(ACPI_TABLE_HEADER))
+        report(result, ACPI_CHECK_LENGTH, ACPI_CHECK_FAIL,
+               "%zu bytes, shorter than the ACPI header", size);
+    if (result->status[ACPI_CHECK_LENGTH] == ACPI_CHECK_FAIL) {
+        report(result, ACPI_CHECK_CHECKSUM, ACPI_CHECK_SKIP, "length invalid");
+        report(result, ACPI_CHECK_SUBTABLES, ACPI_CHECK_SKIP, "length invalid");
+        report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_SKIP,
+               "length invalid");
+        return;
+    }
+
+    if (!table_has_checksum((const char *)table))
+        result->status[ACPI_CHECK_CHECKSUM] = ACPI_CHECK_SKIP;
+    else if (checksum((uint8_t *)table, size) != 0)
+        report(result, ACPI_CHECK_CHECKSUM, ACPI_CHECK_FAIL,
+               "byte sum 0x%02X, expected 0",
+               (uint8_t)(0 - checksum((uint8_t *)table, size)));
+
+    layout = acpi_layout_find((const char *)table);
+    if (layout == NULL || layout->structureCount == 0) {
+        result->status[ACPI_CHECK_SUBTABLES] = ACPI_CHECK_SKIP;
+        result->status[ACPI_CHECK_REFERENCES] = ACPI_CHECK_SKIP;
+        return;
+    }
+
+    ret = acpi_layout_walk(table, size, layout, collect_node, &walk);
+    result->subtableCount = walk.count;
+    if (walk.oom) {
+        report(result, ACPI_CHECK_SUBTABLES, ACPI_CHECK_FAIL, "out of memory");
+    } else if (ret < 0) {
+        report(result, ACPI_CHECK_SUBTABLES, ACPI_CHECK_FAIL,
+               "type or length out of table bounds after %u subtable(s)",
+               walk.count);
+    } else if (walk.unknown != 0) {
+        report(result, ACPI_CHECK_SUBTABLES, ACPI_CHECK_WARN,
+               "0x%03X: %u subtable(s) of unknown type, first is %d",
+               walk.firstUnknown, walk.unknown, walk.unknownType);
+    }
+
+    if (ret < 0)
+        report(result, ACPI_CHECK_REFERENCES, ACPI_CHECK_SKIP,
+               "subtables invalid");
+    else if (memcmp(table, "PPTT", 4) == 0)
+        check_pptt(table, &walk, result);
+    else if (memcmp(table, "IORT", 4) == 0)
+        check_iort(table, &walk, result);
+    else
+        result->status[ACPI_CHECK_REFERENCES] = ACPI_CHECK_SKIP;
+
+    free(walk.nodes);
+}
+
+/**
+ * Check whether any check of a validation failed, warnings do not count.
+ */
+bool acpi_validation_failed(const AcpiValidation *result) {
+    for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+        if (result->status[check] == ACPI_CHECK_FAIL)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,995 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "acpi_xcheck.h"
+#include "acpi_layout.h"
+#include "utils.h"
+#include <acpi.h>
+#include <common.h>
+#include <common/dbg2.h>
+#include <common/gtdt.h>
+#include <common/iort.h>
+#include <common/madt.h>
+#include <common/mcfg.h>
+#include <common/pptt.h>
+#include <common/spcr.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Cross-table checks, see include/acpi_xcheck.h. Each table is walked once
+// with acpi_layout_walk() into flat arrays, the relations are then checked
+// through XcheckIndex hash maps built over those arrays.
+//
+
+// Concrete instances of the variable structures, only used for offsetof()
+GTDT_DEFINE_TIMER_BLOCK_STRUCTURE_TYPE(XCHECK, 1)
+DBG2_DEFINE_DEBUG_DEVICE_INFO_STRUCTURE(XCHECK, 1, 1, 1)
+
+const char *const acpi_xcheck_names[ACPI_XCHECK_COUNT] = {
+    "cpu-uid", "timer-gsi", "gsi-owner", "console", "pci-segment",
+};
+
+static const char acpi_xcheck_signatures[ACPI_XCHECK_TABLE_COUNT][4] = {
+    [ACPI_XCHECK_MADT] = {ACPI_MADT_SIGNATURE},
+    [ACPI_XCHECK_PPTT] = {ACPI_PPTT_SIGNATURE},
+    [ACPI_XCHECK_GTDT] = {ACPI_GTDT_SIGNATURE},
+    [ACPI_XCHECK_SPCR] = {ACPI_SPCR_SIGNATURE},
+    [ACPI_XCHECK_DBG2] = {ACPI_DBG2_SIGNATURE},
+    [ACPI_XCHECK_MCFG] = {ACPI_MCFG_SIGNATURE},
+    [ACPI_XCHECK_IORT] = {ACPI_IORT_SIGNATURE},
+};
+
+// GIC INTIDs, the extended PPI and SPI ranges need GICv3.1
+#define GIC_PPI_FIRST 16
+#define GIC_PPI_LAST 31
+#define GIC_SPI_FIRST 32
+#define GIC_SPI_LAST 1019
+#define GIC_EPPI_FIRST 1056
+#define GIC_EPPI_LAST 1119
+#define GIC_ESPI_FIRST 4096
+#define GIC_ESPI_LAST 5119
+
+// Offset of a member of the fixed part, right after the standard header
+#define XCHECK_BODY_OFFSET(type, member)                                      \
+    (sizeof(ACPI_TABLE_HEADER) + offsetof(type, member))
+#define XCHECK_MEMBER_END(type, member)                                       \
+    (offsetof(type, member) + sizeof(((type *)0)->member))
+
+// GTDT revision 3 appends the virtual EL2 timer to the fixed part
+#define GTDT_VIRTUAL_EL2_TIMER_GSI_OFFSET                                     \
+    (sizeof(ACPI_TABLE_HEADER) +                                               \
+     XCHECK_MEMBER_END(GTDT_HEADER_EXTRA_DATA, PlatformTimerOffset))
+
+//
+// Open addressing map from a 32-bit key to an entry number. It is sized
+// for its entries up front and never grows.
+//
+typedef struct {
+    uint32_t *keys;
+    uint32_t *slots; // Entry number + 1, 0 for a free slot
+    uint32_t mask;
+} XcheckIndex;
+
+typedef struct {
+    uint32_t offset; // Of the structure in its table
+    uint32_t id;     // GICC UID, PPTT ACPI processor ID
+    uint32_t flags;
+    uint32_t parent; // PPTT only
+    bool isParent;   // PPTT only, another node points to it
+} XcheckCpu;
+
+typedef struct {
+    uint32_t gsi;
+    const char *source; // e.g. "NS EL1 timer", same pointer for same source
+    enum ACPI_XCHECK_TABLE table;
+    uint32_t offset; // Of the structure or field holding the GSI
+    bool perCpu;     // PPI banked per CPU, listed once per GICC
+    int32_t next;    // Next owner of the same GSI with another source
+} XcheckOwner;
+
+typedef struct {
+    const AcpiTableSet *set;
+    AcpiXcheckResult *result;
+    bool broken[ACPI_XCHECK_TABLE_COUNT]; // Subtable stream is malformed
+    XcheckCpu *giccs;
+    uint32_t giccCount;
+    XcheckCpu *processors;
+    uint32_t processorCount;
+    uint8_t gicVersion; // From the GICD, 0 if unknown
+    XcheckOwner *owners;
+    uint32_t ownerCount;
+    uint32_t ownerCapacity;
+    bool oom;
+    // SPCR UART matched against the DBG2 serial ports while walking DBG2
+    uint64_t spcrAddress;
+    uint8_t spcrAddressSpace;
+    uint8_t spcrInterfaceType;
+    uint32_t serialPorts;
+    bool consoleFound;
+} XcheckContext;
+
+typedef struct {
+    uint32_t offset;
+    uint16_t segment;
+    uint8_t startBus;
+    uint8_t endBus;
+    bool hasRootComplex;
+} XcheckSegment;
+
+typedef struct {
+    XcheckContext *context;
+    XcheckSegment *segments;
+    uint32_t count;
+} XcheckSegments;
+
+static uint8_t read_u8(const uint8_t *base, size_t offset) {
+    return base[offset];
+}
+
+static bool is_structure(const AcpiSubtable *subtable, const char *name) {
+    return subtable->layout != NULL &&
+           strcmp(subtable->layout->name, name) == 0;
+}
+
+static const char *table_name(enum ACPI_XCHECK_TABLE table) {
+    static const char *const names[ACPI_XCHECK_TABLE_COUNT] = {
+        "MADT", "PPTT", "GTDT", "SPCR", "DBG2", "MCFG", "IORT",
+    };
+    return names[table];
+}
+
+/**
+ * Add one diagnostic, the check keeps its worst status.
+ */
+static void diagnose(XcheckContext *context, enum ACPI_XCHECK check,
+                     enum ACPI_CHECK_STATUS status, const char *format, ...) {
+    AcpiXcheckResult *result = context->result;
+    AcpiXcheckDiagnostic *diagnostic;
+    va_list args;
+
+    if (status > result->status[check])
+        result->status[check] = status;
+    if (result->diagnosticCount == result->diagnosticCapacity) {
+        size_t capacity =
+            result->diagnosticCapacity ? result->diagnosticCapacity * 2 : 16;
+        AcpiXcheckDiagnostic *grown =
+            realloc(result->diagnostics, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            result->oom = true;
+            return;
+        }
+        result->diagnostics = grown;
+        result->diagnosticCapacity = capacity;
+    }
+    diagnostic = &result->diagnostics[result->diagnosticCount++];
+    diagnostic->check = check;
+    diagnostic->status = status;
+    va_start(args, format);
+    vsnprintf(diagnostic->message, sizeof(diagnostic->message), format, args);
+    va_end(args);
+}
+
+static void index_free(XcheckIndex *index) {
+    free(index->keys);
+    free(index->slots);
+    memset(index, 0, sizeof(*index));
+}
+
+static int index_init(XcheckIndex *index, size_t entries) {
+    size_t capacity = 16;
+
+    while (capacity < entries * 2)
+        capacity *= 2;
+    index->keys = calloc(capacity, sizeof(*index->keys));
+    index->slots = calloc(capacity, sizeof(*index->slots));
+    index->mask = (uint32_t)(capacity - 1);
+    if (index->keys == NULL || index->slots == NULL) {
+        index_free(index);
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+// Slot of key, or the free slot where it goes
+static uint32_t index_probe(const XcheckIndex *index, uint32_t key) {
+    uint32_t hash = key * 0x9E3779B1u;
+    uint32_t slot = (hash ^ (hash >> 16)) & index->mask;
+
+    while (index->slots[slot] != 0 && index->keys[slot] != key)
+        slot = (slot + 1) & index->mask;
+    return slot;
+}
+
+/**
+ * Entry number of key, -1 if it is not in the index.
+ */
+static int64_t index_find(const XcheckIndex *index, uint32_t key) {
+    uint32_t slot = index_probe(index, key);
+    return (int64_t)index->slots[slot] - 1;
+}
+
+/**
+ * Add key for entry, unless the key is there already.
+ *
+ * @retval -1   Added.
+ * @retval >=0  Entry number already holding the key.
+ */
+static int64_t index_add(XcheckIndex *index, uint32_t key, uint32_t entry) {
+    uint32_t slot = index_probe(index, key);
+
+    if (index->slots[slot] != 0)
+        return (int64_t)index->slots[slot] - 1;
+    index->keys[slot] = key;
+    index->slots[slot] = entry + 1;
+    return -1;
+}
+
+static int add_cpu(XcheckCpu **cpus, uint32_t *count, const XcheckCpu *cpu) {
+    XcheckCpu *grown;
+
+    // Grow on powers of two, counts stay small and realloc stays linear
+    if ((*count & (*count - 1)) == 0) {
+        grown = realloc(*cpus, (*count ? *count * 2 : 8) * sizeof(*grown));
+        if (grown == NULL)
+            return -ENOMEM;
+        *cpus = grown;
+    }
+    (*cpus)[(*count)++] = *cpu;
+    return 0;
+}
+
+/**
+ * Record that a structure uses a GSI, 0 means the interrupt is not
+ * implemented.
+ */
+static int add_owner(XcheckContext *context, uint32_t gsi, const char *source,
+                     enum ACPI_XCHECK_TABLE table, uint32_t offset,
+                     bool perCpu) {
+    XcheckOwner *owner;
+
+    if (gsi == 0)
+        return 0;
+    if (context->ownerCount == context->ownerCapacity) {
+        uint32_t capacity =
+            context->ownerCapacity ? context->ownerCapacity * 2 : 32;
+        XcheckOwner *grown =
+            realloc(context->owners, capacity * sizeof(*grown));
+        if (grown == NULL)
+            return -ENOMEM;
+        context->owners = grown;
+        context->ownerCapacity = capacity;
+    }
+    owner = &context->owners[context->ownerCount++];
+    owner->gsi = gsi;
+    owner->source = source;
+    owner->table = table;
+    owner->offset = offset;
+    owner->perCpu = perCpu;
+    owner->next = -1;
+    return 0;
+}
+
+/* Collection, one walk per table */
+
+static int collect_madt(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    XcheckContext *context = data;
+    const uint8_t *base = table + subtable->offset;
+    uint32_t offset = subtable->offset;
+    XcheckCpu cpu = {0};
+    int ret = 0;
+
+    if (is_structure(subtable, "GICD") &&
+        subtable->length >= sizeof(MADT_GICD_STRUCTURE)) {
+        context->gicVersion =
+            read_u8(base, offsetof(MADT_GICD_STRUCTURE, GICVersion));
+        return 0;
+    }
+    if (!is_structure(subtable, "GICC") ||
+        subtable->length <
+            XCHECK_MEMBER_END(MADT_GICC_STRUCTURE, SpeOverflowInterrupt))
+        return 0;
+
+    cpu.offset = offset;
+    cpu.id = read_le32(base, offsetof(MADT_GICC_STRUCTURE, ACPIProcessorUID));
+    cpu.flags = read_le32(base, offsetof(MADT_GICC_STRUCTURE, Flags));
+    if (add_cpu(&context->giccs, &context->giccCount, &cpu) < 0)
+        return -ENOMEM;
+
+    ret |= add_owner(
+        context,
+        read_le32(base, offsetof(MADT_GICC_STRUCTURE, PerformanceInterruptGSI)),
+        "performance interrupt", ACPI_XCHECK_MADT, offset, true);
+    ret |= add_owner(
+        context,
+        read_le32(base,
+                  offsetof(MADT_GICC_STRUCTURE, VGICMaintenanceInterrupt)),
+        "VGIC maintenance interrupt", ACPI_XCHECK_MADT, offset, true);
+    ret |= add_owner(
+        context,
+        read_le16(base, offsetof(MADT_GICC_STRUCTURE, SpeOverflowInterrupt)),
+        "SPE overflow interrupt", ACPI_XCHECK_MADT, offset, true);
+    // TRBEInterrupt follows SpeOverflowInterrupt in ACPI 6.5 GICCs (82 bytes)
+    if (subtable->length >=
+        XCHECK_MEMBER_END(MADT_GICC_STRUCTURE, SpeOverflowInterrupt) + 2)
+        ret |= add_owner(
+            context,
+            read_le16(base, XCHECK_MEMBER_END(MADT_GICC_STRUCTURE,
+                                              SpeOverflowInterrupt)),
+            "TRBE interrupt", ACPI_XCHECK_MADT, offset, true);
+    return ret < 0 ? -ENOMEM : 0;
+}
+
+static int collect_pptt(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    XcheckContext *context = data;
+    const uint8_t *base = table + subtable->offset;
+    XcheckCpu cpu = {0};
+
+    if (!is_structure(subtable, "PROCESSOR") ||
+        subtable->length < sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE))
+        return 0;
+    cpu.offset = subtable->offset;
+    cpu.id = read_le32(
+        base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, AcpiProcessorId));
+    cpu.flags =
+        read_le32(base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Flags));
+    cpu.parent =
+        read_le32(base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent));
+    return add_cpu(&context->processors, &context->processorCount, &cpu);
+}
+
+static int collect_gtdt(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    XcheckContext *context = data;
+    const uint8_t *base = table + subtable->offset;
+    uint32_t count, frames;
+    int ret = 0;
+
+    if (is_structure(subtable, "WATCHDOG") &&
+        subtable->length >= sizeof(ACPI_GTDT_GENERIC_WDT_STRUCTURE))
+        return add_owner(
+            context,
+            read_le32(base, offsetof(ACPI_GTDT_GENERIC_WDT_STRUCTURE,
+                                     WatchdogTimerGSI)),
+            "watchdog", ACPI_XCHECK_GTDT, subtable->offset, false);
+    if (!is_structure(subtable, "GT_BLOCK") ||
+        subtable->length <
+            offsetof(GTDT_TIMER_BLOCK_STRUCTURE_XCHECK, GTBlockTimerStructure))
+        return 0;
+
+    count = read_le32(
+        base, offsetof(GTDT_TIMER_BLOCK_STRUCTURE_XCHECK, GTBlockTimerCount));
+    frames = read_le32(
+        base, offsetof(GTDT_TIMER_BLOCK_STRUCTURE_XCHECK, GTBlockTimerOffset));
+    if (frames > subtable->length ||
+        (subtable->length - frames) / sizeof(GTDT_BLOCK_TIMER_STRUCTURE) <
+            count)
+        return 0; // Reported by acpi_validate
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t frame = frames + i * sizeof(GTDT_BLOCK_TIMER_STRUCTURE);
+        ret |= add_owner(
+            context,
+            read_le32(base, frame + offsetof(GTDT_BLOCK_TIMER_STRUCTURE,
+                                             PhysicalTimerGSI)),
+            "GT frame physical timer", ACPI_XCHECK_GTDT,
+            subtable->offset + frame, false);
+        ret |= add_owner(
+            context,
+            read_le32(base, frame + offsetof(GTDT_BLOCK_TIMER_STRUCTURE,
+                                             VirtualTimerGSI)),
+            "GT frame virtual timer", ACPI_XCHECK_GTDT,
+            subtable->offset + frame, false);
+    }
+    return ret < 0 ? -ENOMEM : 0;
+}
+
+// Per CPU timers of the GTDT fixed part
+static int collect_gtdt_timers(XcheckContext *context, const uint8_t *table,
+                               size_t size) {
+    static const struct {
+        const char *source;
+        uint32_t offset;
+    } timers[] = {
+        {"secure EL1 timer",
+         XCHECK_BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, SecureEL1TimerGSI)},
+        {"NS EL1 timer",
+         XCHECK_BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, NSEL1TimerGSI)},
+        {"virtual EL1 timer",
+         XCHECK_BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, VirtualEL1TimerGSI)},
+        {"EL2 timer", XCHECK_BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, EL2TimerGSI)},
+        {"virtual EL2 timer", GTDT_VIRTUAL_EL2_TIMER_GSI_OFFSET},
+    };
+    int ret = 0;
+
+    for (size_t i = 0; i < sizeof(timers) / sizeof(timers[0]); i++) {
+        if (timers[i].offset == GTDT_VIRTUAL_EL2_TIMER_GSI_OFFSET &&
+            ((const ACPI_TABLE_HEADER *)table)->Revision < 3)
+            continue;
+        if (timers[i].offset + sizeof(uint32_t) > size)
+            continue;
+        ret |= add_owner(context, read_le32(table, timers[i].offset),
+                         timers[i].source, ACPI_XCHECK_GTDT, timers[i].offset,
+                         true);
+    }
+    return ret < 0 ? -ENOMEM : 0;
+}
+
+/**
+ * Walk a table of the set into the context.
+ *
+ * @retval 0        Walked, or the device has no such table.
+ * @retval -ENOMEM  Out of memory.
+ */
+static int collect(XcheckContext *context, enum ACPI_XCHECK_TABLE which,
+                   AcpiSubtableCallback callback, void *data) {
+    const AcpiXcheckTable *entry = &context->set->tables[which];
+    const AcpiTableLayout *layout;
+    int ret;
+
+    if (entry->table == NULL)
+        return 0;
+    layout = acpi_layout_find((const char *)entry->table);
+    if (layout == NULL)
+        return 0;
+    ret = acpi_layout_walk(entry->table, entry->size, layout, callback, data);
+    if (ret == -ENOMEM)
+        return ret;
+    if (ret < 0)
+        context->broken[which] = true;
+    return 0;
+}
+
+/**
+ * Check that the tables of a relation are there and walkable.
+ *
+ * @retval true     Run the check.
+ * @retval false    Skip it, a malformed table gets a warning.
+ */
+static bool tables_ready(XcheckContext *context, enum ACPI_XCHECK check,
+                         enum ACPI_XCHECK_TABLE first,
+                         enum ACPI_XCHECK_TABLE second) {
+    enum ACPI_XCHECK_TABLE tables[2] = {first, second};
+
+    for (int i = 0; i < 2; i++) {
+        if (context->set->tables[tables[i]].table == NULL) {
+            context->result->status[check] = ACPI_CHECK_SKIP;
+            return false;
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (context->broken[tables[i]]) {
+            diagnose(context, check, ACPI_CHECK_WARN,
+                     "%s subtables are malformed (see acpi_validate), "
+                     "not checked",
+                     table_name(tables[i]));
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Checks */
+
+static int check_cpu_uid(XcheckContext *context) {
+    AcpiXcheckResult *result = context->result;
+    XcheckIndex giccs = {0}, leaves = {0}, nodes = {0};
+    int ret = -ENOMEM;
+
+    if (!tables_ready(context, ACPI_XCHECK_CPU_UID, ACPI_XCHECK_MADT,
+                      ACPI_XCHECK_PPTT))
+        return 0;
+    if (index_init(&giccs, context->giccCount) < 0 ||
+        index_init(&leaves, context->processorCount) < 0 ||
+        index_init(&nodes, context->processorCount) < 0)
+        goto out;
+
+    for (uint32_t i = 0; i < context->giccCount; i++) {
+        const XcheckCpu *gicc = &context->giccs[i];
+        int64_t other = index_add(&giccs, gicc->id, i);
+        if (other >= 0)
+            diagnose(context, ACPI_XCHECK_CPU_UID, ACPI_CHECK_FAIL,
+                     "MADT 0x%03X: GICC UID %u already used by GICC 0x%03X",
+                     gicc->offset, gicc->id, context->giccs[other].offset);
+    }
+
+    // Leaves are the processor nodes no other node has as parent
+    for (uint32_t i = 0; i < context->processorCount; i++)
+        index_add(&nodes, context->processors[i].offset, i);
+    for (uint32_t i = 0; i < context->processorCount; i++) {
+        int64_t parent = index_find(&nodes, context->processors[i].parent);
+        if (context->processors[i].parent != 0 && parent >= 0)
+            context->processors[parent].isParent = true;
+    }
+
+    for (uint32_t i = 0; i < context->processorCount; i++) {
+        const XcheckCpu *leaf = &context->processors[i];
+        int64_t other;
+
+        if (leaf->isParent)
+            continue;
+        if (!(leaf->flags & PPTT_PROC_FLAG_ACPI_PROC_ID_VALID)) {
+            diagnose(context, ACPI_XCHECK_CPU_UID, ACPI_CHECK_FAIL,
+                     "PPTT 0x%03X: leaf processor without a valid ACPI "
+                     "processor ID",
+                     leaf->offset);
+            continue;
+        }
+        other = index_add(&leaves, leaf->id, i);
+        if (other >= 0) {
+            diagnose(context, ACPI_XCHECK_CPU_UID, ACPI_CHECK_FAIL,
+                     "PPTT 0x%03X: ACPI processor ID %u already used by "
+                     "leaf 0x%03X",
+                     leaf->offset, leaf->id,
+                     context->processors[other].offset);
+            continue;
+        }
+        result->relations[ACPI_XCHECK_CPU_UID]++;
+        if (index_find(&giccs, leaf->id) < 0)
+            diagnose(context, ACPI_XCHECK_CPU_UID, ACPI_CHECK_FAIL,
+                     "PPTT 0x%03X: ACPI processor ID %u has no MADT GICC",
+                     leaf->offset, leaf->id);
+    }
+
+    // Disabled GICCs that can not be brought online need no topology
+    for (uint32_t i = 0; i < context->giccCount; i++) {
+        const XcheckCpu *gicc = &context->giccs[i];
+
+        if (!(gicc->flags &
+              (MADT_GICC_FLAG_ENABLED | MADT_GICC_FLAG_ONLINE_CAPABLE)))
+            continue;
+        result->relations[ACPI_XCHECK_CPU_UID]++;
+        if (index_find(&leaves, gicc->id) < 0)
+            diagnose(context, ACPI_XCHECK_CPU_UID, ACPI_CHECK_FAIL,
+                     "MADT 0x%03X: GICC UID %u has no PPTT leaf processor",
+                     gicc->offset, gicc->id);
+    }
+    ret = 0;
+
+out:
+    index_free(&giccs);
+    index_free(&leaves);
+    index_free(&nodes);
+    return ret;
+}
+
+/**
+ * Per CPU interrupts must be PPIs, the others SPIs. The extended ranges
+ * need GICv3.1, which the MADT GICD tells.
+ */
+static void check_gsi_range(XcheckContext *context, enum ACPI_XCHECK check,
+                            const XcheckOwner *owner) {
+    const char *kind = owner->perCpu ? "PPI" : "SPI";
+    uint32_t gsi = owner->gsi;
+    bool extended;
+
+    if (owner->perCpu) {
+        if (gsi >= GIC_PPI_FIRST && gsi <= GIC_PPI_LAST)
+            return;
+        extended = gsi >= GIC_EPPI_FIRST && gsi <= GIC_EPPI_LAST;
+    } else {
+        if (gsi >= GIC_SPI_FIRST && gsi <= GIC_SPI_LAST)
+            return;
+        extended = gsi >= GIC_ESPI_FIRST && gsi <= GIC_ESPI_LAST;
+    }
+
+    if (!extended)
+        diagnose(context, check, ACPI_CHECK_FAIL,
+                 "%s 0x%03X: %s GSI %u is not a%s %s",
+                 table_name(owner->table), owner->offset, owner->source, gsi,
+                 owner->perCpu ? "" : "n", kind);
+    else if (context->gicVersion == 0)
+        diagnose(context, check, ACPI_CHECK_WARN,
+                 "%s 0x%03X: %s GSI %u is an extended %s, no MADT GICD "
+                 "version to confirm GICv3.1",
+                 table_name(owner->table), owner->offset, owner->source, gsi,
+                 kind);
+    else if (context->gicVersion < GIC_V3)
+        diagnose(context, check, ACPI_CHECK_FAIL,
+                 "%s 0x%03X: %s GSI %u is an extended %s, MADT GICD is "
+                 "GICv%u",
+                 table_name(owner->table), owner->offset, owner->source, gsi,
+                 kind, context->gicVersion);
+}
+
+static void check_timer_gsi(XcheckContext *context) {
+    const AcpiXcheckTable *gtdt = &context->set->tables[ACPI_XCHECK_GTDT];
+    uint32_t offset =
+        XCHECK_BODY_OFFSET(GTDT_HEADER_EXTRA_DATA, NSEL1TimerGSI);
+
+    if (!tables_ready(context, ACPI_XCHECK_TIMER_GSI, ACPI_XCHECK_GTDT,
+                      ACPI_XCHECK_GTDT))
+        return;
+    // Without MADT the GIC version is unknown, the base ranges still apply
+    if (context->set->tables[ACPI_XCHECK_MADT].table != NULL &&
+        context->gicVersion == 0)
+        diagnose(context, ACPI_XCHECK_TIMER_GSI, ACPI_CHECK_WARN,
+                 "MADT has no GICD with a GIC version");
+
+    if (offset + sizeof(uint32_t) <= gtdt->size &&
+        read_le32(gtdt->table, offset) == 0)
+        diagnose(context, ACPI_XCHECK_TIMER_GSI, ACPI_CHECK_FAIL,
+                 "GTDT 0x%03X: NS EL1 timer has no GSI", offset);
+    for (uint32_t i = 0; i < context->ownerCount; i++) {
+        if (context->owners[i].table != ACPI_XCHECK_GTDT)
+            continue;
+        context->result->relations[ACPI_XCHECK_TIMER_GSI]++;
+        check_gsi_range(context, ACPI_XCHECK_TIMER_GSI, &context->owners[i]);
+    }
+}
+
+static int check_gsi_owner(XcheckContext *context) {
+    XcheckIndex gsis = {0};
+
+    if (context->ownerCount == 0) {
+        context->result->status[ACPI_XCHECK_GSI_OWNER] = ACPI_CHECK_SKIP;
+        return 0;
+    }
+    if (index_init(&gsis, context->ownerCount) < 0)
+        return -ENOMEM;
+
+    for (uint32_t i = 0; i < context->ownerCount; i++) {
+        XcheckOwner *owner = &context->owners[i];
+        int64_t first = index_add(&gsis, owner->gsi, i);
+        XcheckOwner *other;
+
+        // GTDT ranges are the timer check's
+        if (owner->table != ACPI_XCHECK_GTDT)
+            check_gsi_range(context, ACPI_XCHECK_GSI_OWNER, owner);
+        context->result->relations[ACPI_XCHECK_GSI_OWNER]++;
+        if (first < 0)
+            continue;
+
+        // The chain holds one owner per source, it stays short
+        for (other = &context->owners[first];;
+             other = &context->owners[other->next]) {
+            if (other->source == owner->source && other->perCpu &&
+                owner->perCpu)
+                break; // Same PPI on another CPU
+            if (other->next < 0) {
+                other->next = (int32_t)i;
+                diagnose(context, ACPI_XCHECK_GSI_OWNER, ACPI_CHECK_FAIL,
+                         "GSI %u: %s at %s 0x%03X is also the %s at %s "
+                         "0x%03X",
+                         owner->gsi, owner->source, table_name(owner->table),
+                         owner->offset, context->owners[first].source,
+                         table_name(context->owners[first].table),
+                         context->owners[first].offset);
+                break;
+            }
+        }
+    }
+    index_free(&gsis);
+    return 0;
+}
+
+static int collect_dbg2(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    XcheckContext *context = data;
+    const uint8_t *base = table + subtable->offset;
+    uint32_t registers, offset;
+
+    if (subtable->length <
+        offsetof(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_XCHECK, BaseAddrRegister))
+        return 0;
+    if (read_le16(base, offsetof(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_XCHECK,
+                                 PortType)) != DBG2_DEBUG_PORT_TYPE_SERIAL)
+        return 0;
+
+    context->serialPorts++;
+    registers = read_u8(base, offsetof(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_XCHECK,
+                                       NumOfGenericAddrRegs));
+    offset = read_le16(base, offsetof(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_XCHECK,
+                                      BaseAddrRegOffset));
+    if (offset > subtable->length ||
+        (subtable->length - offset) / sizeof(ACPI_GAS) < registers)
+        return 0; // Reported by acpi_validate
+
+    for (uint32_t i = 0; i < registers; i++) {
+        const uint8_t *gas = base + offset + i * sizeof(ACPI_GAS);
+        uint16_t subtype = read_le16(
+            base,
+            offsetof(DBG2_DEBUG_DEVICE_INFO_STRUCTURE_XCHECK, PortSubtype));
+
+        context->result->relations[ACPI_XCHECK_CONSOLE]++;
+        if (read_le64(gas, offsetof(ACPI_GAS, Address)) != context->spcrAddress)
+            continue;
+        context->consoleFound = true;
+        if (subtype != context->spcrInterfaceType)
+            diagnose(context, ACPI_XCHECK_CONSOLE, ACPI_CHECK_FAIL,
+                     "DBG2 0x%03X: port subtype 0x%X, SPCR interface type "
+                     "0x%X for UART 0x%llX",
+                     subtable->offset, subtype, context->spcrInterfaceType,
+                     (unsigned long long)context->spcrAddress);
+        if (read_u8(gas, offsetof(ACPI_GAS, AddressSpaceID)) !=
+            context->spcrAddressSpace)
+            diagnose(context, ACPI_XCHECK_CONSOLE, ACPI_CHECK_FAIL,
+                     "DBG2 0x%03X: address space %u, SPCR uses %u for UART "
+                     "0x%llX",
+                     subtable->offset,
+                     read_u8(gas, offsetof(ACPI_GAS, AddressSpaceID)),
+                     context->spcrAddressSpace,
+                     (unsigned long long)context->spcrAddress);
+    }
+    return 0;
+}
+
+static int check_console(XcheckContext *context) {
+    const AcpiXcheckTable *spcr = &context->set->tables[ACPI_XCHECK_SPCR];
+    int ret;
+
+    if (!tables_ready(context, ACPI_XCHECK_CONSOLE, ACPI_XCHECK_SPCR,
+                      ACPI_XCHECK_DBG2))
+        return 0;
+    if (spcr->size <
+        XCHECK_BODY_OFFSET(SPCR_HEADER_EXTRA_DATA, InterruptType)) {
+        diagnose(context, ACPI_XCHECK_CONSOLE, ACPI_CHECK_FAIL,
+                 "SPCR is %zu bytes, too short for its UART address",
+                 spcr->size);
+        return 0;
+    }
+    context->spcrInterfaceType = read_u8(
+        spcr->table, XCHECK_BODY_OFFSET(SPCR_HEADER_EXTRA_DATA, InterfaceType));
+    context->spcrAddressSpace = read_u8(
+        spcr->table, XCHECK_BODY_OFFSET(SPCR_HEADER_EXTRA_DATA, BaseAddress) +
+                         offsetof(ACPI_GAS, AddressSpaceID));
+    context->spcrAddress = read_le64(
+        spcr->table, XCHECK_BODY_OFFSET(SPCR_HEADER_EXTRA_DATA, BaseAddress) +
+                         offsetof(ACPI_GAS, Address));
+
+    ret = collect(context, ACPI_XCHECK_DBG2, collect_dbg2, context);
+    if (ret < 0)
+        return ret;
+    if (context->broken[ACPI_XCHECK_DBG2])
+        diagnose(context, ACPI_XCHECK_CONSOLE, ACPI_CHECK_WARN,
+                 "DBG2 subtables are malformed (see acpi_validate), checked "
+                 "up to the first bad one");
+    if (!context->consoleFound)
+        diagnose(context, ACPI_XCHECK_CONSOLE, ACPI_CHECK_FAIL,
+                 "SPCR UART 0x%llX is none of the %u DBG2 serial port(s)",
+                 (unsigned long long)context->spcrAddress,
+                 context->serialPorts);
+    return 0;
+}
+
+static int collect_mcfg(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    XcheckSegments *segments = data;
+    const uint8_t *base = table + subtable->offset;
+    XcheckSegment *grown;
+
+    if ((segments->count & (segments->count - 1)) == 0) {
+        grown = realloc(segments->segments,
+                        (segments->count ? segments->count * 2 : 8) *
+                            sizeof(*grown));
+        if (grown == NULL)
+            return -ENOMEM;
+        segments->segments = grown;
+    }
+    segments->segments[segments->count++] = (XcheckSegment){
+        .offset = subtable->offset,
+        .segment = read_le16(base, offsetof(MCFG_MEM_MAP_EC_SPACE_STRUCTURE,
+                                            PCISegmentGroupNumber)),
+        .startBus = read_u8(
+            base, offsetof(MCFG_MEM_MAP_EC_SPACE_STRUCTURE, StartBusNumber)),
+        .endBus = read_u8(
+            base, offsetof(MCFG_MEM_MAP_EC_SPACE_STRUCTURE, EndBusNumber)),
+    };
+    return 0;
+}
+
+typedef struct {
+    XcheckContext *context;
+    XcheckSegments *segments;
+    XcheckIndex *bySegment;  // MCFG allocation of a segment
+    XcheckIndex *complexes;  // IORT root complex of a segment
+} XcheckIort;
+
+static int collect_iort(const uint8_t *table, const AcpiSubtable *subtable,
+                        void *data) {
+    XcheckIort *iort = data;
+    XcheckContext *context = iort->context;
+    uint32_t segment;
+    int64_t allocation, other;
+
+    if (subtable->type != IORT_NODE_TYPE_ROOT_COMPLEX ||
+        subtable->length < sizeof(IORT_PCI_ROOT_COMPLEX_NODE))
+        return 0;
+    segment = read_le32(table + subtable->offset,
+                        offsetof(IORT_PCI_ROOT_COMPLEX_NODE, PCISegmentNumber));
+
+    other = index_add(iort->complexes, segment, subtable->offset);
+    if (other >= 0) {
+        diagnose(context, ACPI_XCHECK_PCI_SEGMENT, ACPI_CHECK_FAIL,
+                 "IORT 0x%03X: segment %u already has root complex 0x%03X",
+                 subtable->offset, segment, (uint32_t)other);
+        return 0;
+    }
+    context->result->relations[ACPI_XCHECK_PCI_SEGMENT]++;
+    allocation = segment <= UINT16_MAX ? index_find(iort->bySegment, segment)
+                                       : -1;
+    if (allocation < 0)
+        diagnose(context, ACPI_XCHECK_PCI_SEGMENT, ACPI_CHECK_FAIL,
+                 "IORT 0x%03X: root complex segment %u has no MCFG "
+                 "allocation",
+                 subtable->offset, segment);
+    else
+        iort->segments->segments[allocation].hasRootComplex = true;
+    return 0;
+}
+
+static int check_pci_segment(XcheckContext *context) {
+    XcheckSegments segments = {context, NULL, 0};
+    XcheckIndex bySegment = {0}, complexes = {0};
+    XcheckIort iort = {context, &segments, &bySegment, &complexes};
+    int ret;
+
+    if (!tables_ready(context, ACPI_XCHECK_PCI_SEGMENT, ACPI_XCHECK_MCFG,
+                      ACPI_XCHECK_IORT))
+        return 0;
+    ret = collect(context, ACPI_XCHECK_MCFG, collect_mcfg, &segments);
+    if (ret == 0)
+        ret = index_init(&bySegment, segments.count);
+    if (ret < 0)
+        goto out;
+
+    // One allocation per segment, unless their bus ranges are disjoint
+    for (uint32_t i = 0; i < segments.count; i++) {
+        const XcheckSegment *segment = &segments.segments[i];
+        int64_t other = index_add(&bySegment, segment->segment, i);
+        const XcheckSegment *first;
+
+        if (other < 0)
+            continue;
+        first = &segments.segments[other];
+        if (segment->startBus <= first->endBus &&
+            first->startBus <= segment->endBus)
+            diagnose(context, ACPI_XCHECK_PCI_SEGMENT, ACPI_CHECK_FAIL,
+                     "MCFG 0x%03X: segment %u buses %u-%u overlap "
+                     "allocation 0x%03X",
+                     segment->offset, segment->segment, segment->startBus,
+                     segment->endBus, first->offset);
+        segments.segments[other].hasRootComplex |= segment->hasRootComplex;
+    }
+
+    ret = index_init(&complexes, context->set->tables[ACPI_XCHECK_IORT].size /
+                                     sizeof(IORT_PCI_ROOT_COMPLEX_NODE));
+    if (ret == 0)
+        ret = collect(context, ACPI_XCHECK_IORT, collect_iort, &iort);
+    if (ret < 0)
+        goto out;
+    if (context->broken[ACPI_XCHECK_IORT])
+        diagnose(context, ACPI_XCHECK_PCI_SEGMENT, ACPI_CHECK_WARN,
+                 "IORT nodes are malformed (see acpi_validate), checked up "
+                 "to the first bad one");
+
+    for (uint32_t i = 0; i < segments.count; i++) {
+        const XcheckSegment *segment = &segments.segments[i];
+        if (index_find(&bySegment, segment->segment) == (int64_t)i &&
+            !segment->hasRootComplex)
+            diagnose(context, ACPI_XCHECK_PCI_SEGMENT, ACPI_CHECK_WARN,
+                     "MCFG 0x%03X: segment %u has no IORT root complex",
+                     segment->offset, segment->segment);
+    }
+
+out:
+    free(segments.segments);
+    index_free(&bySegment);
+    index_free(&complexes);
+    return ret;
+}
+
+/**
+ * Add a table to the set, tables no check reads are ignored.
+ *
+ * @param table     Table content, must stay valid until the checks ran.
+ * @param size      Table file size.
+ * @retval 0        Added or ignored.
+ * @retval -EINVAL  Shorter than its header or than its Length.
+ * @retval -EEXIST  The set already has a table with this signature.
+ */
+int acpi_xcheck_add(AcpiTableSet *set, const uint8_t *table, size_t size) {
+    uint32_t length;
+
+    if (size < sizeof(ACPI_TABLE_HEADER))
+        return -EINVAL;
+    length = read_le32(table, offsetof(ACPI_TABLE_HEADER, Length));
+    if (length < sizeof(ACPI_TABLE_HEADER) || length > size)
+        return -EINVAL;
+
+    for (int i = 0; i < ACPI_XCHECK_TABLE_COUNT; i++) {
+        if (memcmp(table, acpi_xcheck_signatures[i], 4) != 0)
+            continue;
+        if (set->tables[i].table != NULL)
+            return -EEXIST;
+        set->tables[i].table = table;
+        set->tables[i].size = length;
+        return 0;
+    }
+    return 0;
+}
+
+/**
+ * Run every check on a set of tables.
+ *
+ * @param set       Tables of one device.
+ * @param result    Statuses and diagnostics, free with acpi_xcheck_free().
+ * @retval 0        Success, result may hold violations.
+ * @retval -ENOMEM  Out of memory.
+ */
+int acpi_xcheck_run(const AcpiTableSet *set, AcpiXcheckResult *result) {
+    XcheckContext context = {.set = set, .result = result};
+    const AcpiXcheckTable *gtdt = &set->tables[ACPI_XCHECK_GTDT];
+    int ret;
+
+    memset(result, 0, sizeof(*result));
+    ret = collect(&context, ACPI_XCHECK_MADT, collect_madt, &context);
+    if (ret == 0)
+        ret = collect(&context, ACPI_XCHECK_PPTT, collect_pptt, &context);
+    if (ret == 0 && gtdt->table != NULL)
+        ret = collect_gtdt_timers(&context, gtdt->table, gtdt->size);
+    if (ret == 0)
+        ret = collect(&context, ACPI_XCHECK_GTDT, collect_gtdt, &context);
+    if (ret == 0 && set->tables[ACPI_XCHECK_SPCR].table != NULL) {
+        const uint8_t *spcr = set->tables[ACPI_XCHECK_SPCR].table;
+        size_t end = XCHECK_BODY_OFFSET(SPCR_HEADER_EXTRA_DATA,
+                                        GlobalSystemInterrupt) +
+                     sizeof(uint32_t);
+
+        if (set->tables[ACPI_XCHECK_SPCR].size >= end &&
+            (read_u8(spcr, XCHECK_BODY_OFFSET(SPCR_HEADER_EXTRA_DATA,
+                                              InterruptType)) &
+             SPCR_INTERRUPT_TYPE_ARMH_GIC))
+            ret = add_owner(&context,
+                            read_le32(spcr, end - sizeof(uint32_t)),
+                            "console UART", ACPI_XCHECK_SPCR,
+                            end - sizeof(uint32_t), false);
+    }
+
+    if (ret == 0)
+        ret = check_cpu_uid(&context);
+    if (ret == 0) {
+        check_timer_gsi(&context);
+        ret = check_gsi_owner(&context);
+    }
+    if (ret == 0)
+        ret = check_console(&context);
+    if (ret == 0)
+        ret = check_pci_segment(&context);
+
+    free(context.giccs);
+    free(context.processors);
+    free(context.owners);
+    if (ret < 0 || result->oom) {
+        acpi_xcheck_free(result);
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+/**
+ * Check whether any check failed, warnings do not count.
+ */
+bool acpi_xcheck_failed(const AcpiXcheckResult *result) {
+    for (int check = 0; check < ACPI_XCHECK_COUNT; check++) {
+        if (result->status[check] == ACPI_CHECK_FAIL)
+            return true;
+    }
+    return false;
+}
+
+void acpi_xcheck_free(AcpiXcheckResult *result) {
+    free(result->diagnostics);
+    result->diagnostics = NULL;
+    result->diagnosticCount = 0;
+    result->diagnosticCapacity = 0;
+}
@@ -0,0 +1,647 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "acpigen.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ACPI_ARENA_ALIGN 8
+#define ACPIGEN_UNBOUND UINT32_MAX
+#define ACPIGEN_MIN_CAPACITY 256
+
+struct AcpiArenaBlock {
+    AcpiArenaBlock *next;
+    size_t size;
+    size_t used;
+    uint8_t data[]; // 8 byte aligned, the header is three pointers wide
+};
+
+static size_t align_up(size_t size) {
+    return (size + ACPI_ARENA_ALIGN - 1) & ~(size_t)(ACPI_ARENA_ALIGN - 1);
+}
+
+/**
+ * Initialize an empty arena, blocks are allocated on first use.
+ *
+ * @param arena       Arena to initialize.
+ * @param block_size  Minimum block size, 0 for the default.
+ */
+void acpi_arena_init(AcpiArena *arena, size_t block_size) {
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->blockSize = block_size ? block_size : ACPI_ARENA_DEFAULT_BLOCK_SIZE;
+}
+
+/**
+ * Allocate 8 byte aligned memory from the arena.
+ *
+ * Blocks kept by acpi_arena_reset() are reused before a new one is
+ * allocated.
+ *
+ * @retval  Pointer to uninitialized memory, NULL if out of memory.
+ */
+void *acpi_arena_alloc(AcpiArena *arena, size_t size) {
+    AcpiArenaBlock *block = arena->current;
+    AcpiArenaBlock *fresh;
+
+    size = align_up(size ? size : 1);
+    while (block != NULL) {
+        if (block->size - block->used >= size) {
+            void *ptr = block->data + block->used;
+            block->used += size;
+            arena->current = block;
+            return ptr;
+        }
+        if (block->next == NULL)
+            break;
+        block = block->next;
+    }
+
+    fresh = malloc(sizeof(*fresh) +
+                   (size > arena->blockSize ? size : arena->blockSize));
+    if (fresh == NULL)
+        return NULL;
+    fresh->next = NULL;
+    fresh->size = size > arena->blockSize ? size : arena->blockSize;
+    fresh->used = size;
+    if (block == NULL)
+        arena->first = fresh;
+    else
+        block->next = fresh;
+    arena->current = fresh;
+    return fresh->data;
+}
+
+/**
+ * Resize an allocation, in place when it is the last one of its block.
+ *
+ * @retval  New pointer with the old content, NULL if out of memory (the old
+ *          allocation is left untouched).
+ */
+void *acpi_arena_grow(AcpiArena *arena, void *ptr, size_t old_size,
+                      size_t new_size) {
+    AcpiArenaBlock *block = arena->current;
+    void *grown;
+
+    if (ptr == NULL)
+        return acpi_arena_alloc(arena, new_size);
+    if (new_size <= old_size)
+        return ptr;
+
+    old_size = align_up(old_size);
+    if (block != NULL && (uint8_t *)ptr + old_size == block->data + block->used &&
+        block->size - (block->used - old_size) >= align_up(new_size)) {
+        block->used += align_up(new_size) - old_size;
+        return ptr;
+    }
+
+    grown = acpi_arena_alloc(arena, new_size);
+    if (grown != NULL)
+        memcpy(grown, ptr, old_size);
+    return grown;
+}
+
+/**
+ * Release every allocation at once, blocks are kept for reuse.
+ */
+void acpi_arena_reset(AcpiArena *arena) {
+    for (AcpiArenaBlock *block = arena->first; block != NULL;
+         block = block->next)
+        block->used = 0;
+    arena->current = arena->first;
+}
+
+/**
+ * Free all blocks, the arena can be used again afterwards.
+ */
+void acpi_arena_free(AcpiArena *arena) {
+    AcpiArenaBlock *block = arena->first;
+
+    while (block != NULL) {
+        AcpiArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+}
+
+static void set_error(AcpiGen *gen, int error) {
+    if (gen->error == 0)
+        gen->error = error;
+}
+
+/**
+ * Reserve zeroed bytes at the end of the table.
+ *
+ * @retval  Offset of the reserved bytes, UINT32_MAX on error.
+ */
+static uint32_t reserve(AcpiGen *gen, size_t size) {
+    uint32_t offset = gen->length;
+
+    if (gen->error)
+        return UINT32_MAX;
+    if (size > UINT32_MAX - 1 - gen->length) {
+        set_error(gen, -E2BIG);
+        return UINT32_MAX;
+    }
+    if (gen->length + size > gen->capacity) {
+        size_t capacity = gen->capacity ? gen->capacity : ACPIGEN_MIN_CAPACITY;
+        uint8_t *grown;
+
+        while (capacity < gen->length + size)
+            capacity *= 2;
+        if (capacity > UINT32_MAX)
+            capacity = UINT32_MAX;
+        grown = acpi_arena_grow(gen->arena, gen->data, gen->capacity, capacity);
+        if (grown == NULL) {
+            set_error(gen, -ENOMEM);
+            return UINT32_MAX;
+        }
+        gen->data = grown;
+        gen->capacity = (uint32_t)capacity;
+    }
+    memset(gen->data + offset, 0, size);
+    gen->length += (uint32_t)size;
+    return offset;
+}
+
+static AcpiGenRef new_ref(AcpiGen *gen, uint32_t offset) {
+    if (gen->error)
+        return ACPIGEN_NO_REF;
+    if (gen->refCount == gen->refCapacity) {
+        uint32_t capacity = gen->refCapacity ? gen->refCapacity * 2 : 64;
+        uint32_t *grown =
+            acpi_arena_grow(gen->arena, gen->refOffsets,
+                            gen->refCapacity * sizeof(*grown),
+                            capacity * sizeof(*grown));
+        if (grown == NULL) {
+            set_error(gen, -ENOMEM);
+            return ACPIGEN_NO_REF;
+        }
+        gen->refOffsets = grown;
+        gen->refCapacity = capacity;
+    }
+    gen->refOffsets[gen->refCount++] = offset;
+    return gen->refCount; // Index + 1, 0 stays "no reference"
+}
+
+static uint32_t ref_offset(const AcpiGen *gen, AcpiGenRef ref) {
+    return gen->refOffsets[ref - 1];
+}
+
+static void write_u32(AcpiGen *gen, uint32_t offset, uint32_t value) {
+    memcpy(gen->data + offset, &value, sizeof(value));
+}
+
+// Append a subtable counted in the node count, returns its reference
+static AcpiGenRef append_subtable(AcpiGen *gen, const void *data,
+                                  size_t size) {
+    uint32_t offset = reserve(gen, size);
+
+    if (offset == UINT32_MAX)
+        return ACPIGEN_NO_REF;
+    if (data != NULL)
+        memcpy(gen->data + offset, data, size);
+    gen->nodeCount++;
+    return new_ref(gen, offset);
+}
+
+/**
+ * Start a table: standard header followed by a zeroed fixed part.
+ *
+ * OEM fields are blank until acpigen_set_oem(), creator fields are those
+ * of the compile time tables (acpi.h).
+ *
+ * @param gen         Builder to initialize.
+ * @param arena       Arena holding the table and the references.
+ * @param signature   Table signature, 4 characters.
+ * @param revision    Table revision.
+ * @param fixed_size  Bytes between the header and the first subtable.
+ * @retval 0          Success.
+ * @retval -ENOMEM    Out of memory.
+ */
+int acpigen_begin(AcpiGen *gen, AcpiArena *arena, const char signature[4],
+                  uint8_t revision, size_t fixed_size) {
+    static const char creator_id[4] = {ACPI_CREATOR_ID};
+    ACPI_TABLE_HEADER header;
+
+    memset(gen, 0, sizeof(*gen));
+    gen->arena = arena;
+    gen->nodeCountOffset = -1;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.Signature, signature, sizeof(header.Signature));
+    header.Revision = revision;
+    memset(header.OemId, ' ', sizeof(header.OemId));
+    memset(header.OemTableId, ' ', sizeof(header.OemTableId));
+    memcpy(header.CreatorId, creator_id, sizeof(header.CreatorId));
+    header.CreatorRevision = ACPI_CREATOR_REVISION;
+
+    if (reserve(gen, sizeof(header) + fixed_size) == UINT32_MAX)
+        return gen->error;
+    memcpy(gen->data, &header, sizeof(header));
+    return 0;
+}
+
+/**
+ * Set the OEM fields of the header.
+ */
+void acpigen_set_oem(AcpiGen *gen, const char oem_id[6],
+                     const char oem_table_id[8], uint32_t oem_revision) {
+    ACPI_TABLE_HEADER *header;
+
+    if (gen->error)
+        return;
+    header = (ACPI_TABLE_HEADER *)gen->data;
+    memcpy(header->OemId, oem_id, sizeof(header->OemId));
+    memcpy(header->OemTableId, oem_table_id, sizeof(header->OemTableId));
+    header->OemRevision = oem_revision;
+}
+
+/**
+ * Overwrite bytes already in the table, e.g. fields of the fixed part.
+ */
+void acpigen_write(AcpiGen *gen, uint32_t offset, const void *data,
+                   size_t size) {
+    if (gen->error)
+        return;
+    if (offset > gen->length || size > gen->length - offset) {
+        set_error(gen, -EINVAL);
+        return;
+    }
+    memcpy(gen->data + offset, data, size);
+}
+
+/**
+ * Append a raw subtable, stored as given.
+ *
+ * @retval  Reference to the subtable, ACPIGEN_NO_REF on error.
+ */
+AcpiGenRef acpigen_append(AcpiGen *gen, const void *data, size_t size) {
+    return append_subtable(gen, data, size);
+}
+
+/**
+ * Create a reference to a subtable that is not appended yet.
+ *
+ * @retval  Reference to bind with acpigen_bind() before finalizing.
+ */
+AcpiGenRef acpigen_forward(AcpiGen *gen) {
+    return new_ref(gen, ACPIGEN_UNBOUND);
+}
+
+/**
+ * Make a forward reference point to an appended subtable.
+ */
+void acpigen_bind(AcpiGen *gen, AcpiGenRef forward, AcpiGenRef ref) {
+    if (gen->error)
+        return;
+    if (forward == ACPIGEN_NO_REF || forward > gen->refCount ||
+        ref == ACPIGEN_NO_REF || ref > gen->refCount ||
+        ref_offset(gen, ref) == ACPIGEN_UNBOUND) {
+        set_error(gen, -EINVAL);
+        return;
+    }
+    gen->refOffsets[forward - 1] = ref_offset(gen, ref);
+}
+
+/**
+ * Store the table offset of a subtable in a UINT32 at finalize time.
+ *
+ * @param gen   Builder.
+ * @param slot  Table offset of the UINT32 to patch.
+ * @param ref   Subtable reference, ACPIGEN_NO_REF stores 0.
+ */
+void acpigen_reference(AcpiGen *gen, uint32_t slot, AcpiGenRef ref) {
+    if (gen->error)
+        return;
+    if (slot > gen->length || gen->length - slot < sizeof(uint32_t) ||
+        ref > gen->refCount) {
+        set_error(gen, -EINVAL);
+        return;
+    }
+    write_u32(gen, slot, 0);
+    if (ref == ACPIGEN_NO_REF)
+        return;
+
+    if (gen->fixupCount == gen->fixupCapacity) {
+        uint32_t capacity = gen->fixupCapacity ? gen->fixupCapacity * 2 : 64;
+        AcpiGenFixup *grown =
+            acpi_arena_grow(gen->arena, gen->fixups,
+                            gen->fixupCapacity * sizeof(*grown),
+                            capacity * sizeof(*grown));
+        if (grown == NULL) {
+            set_error(gen, -ENOMEM);
+            return;
+        }
+        gen->fixups = grown;
+        gen->fixupCapacity = capacity;
+    }
+    gen->fixups[gen->fixupCount].slot = slot;
+    gen->fixups[gen->fixupCount].ref = ref;
+    gen->fixupCount++;
+}
+
+/**
+ * Resolve references, then fix the length, node count and checksum.
+ *
+ * Appending after finalizing is allowed, finalize again to get the table.
+ *
+ * @param gen     Builder.
+ * @param table   Set to the table, valid until the arena is reset.
+ * @param length  Set to the table length.
+ * @retval 0        Success.
+ * @retval -ENOENT  A forward reference was never bound.
+ * @retval <0       First error of the appends.
+ */
+int acpigen_finalize(AcpiGen *gen, const uint8_t **table, size_t *length) {
+    uint8_t sum = 0;
+
+    *table = NULL;
+    *length = 0;
+    if (gen->error)
+        return gen->error;
+
+    for (uint32_t i = 0; i < gen->fixupCount; i++) {
+        uint32_t offset = ref_offset(gen, gen->fixups[i].ref);
+        if (offset == ACPIGEN_UNBOUND)
+            return -ENOENT;
+        write_u32(gen, gen->fixups[i].slot, offset);
+    }
+
+    write_u32(gen, offsetof(ACPI_TABLE_HEADER, Length), gen->length);
+    if (gen->nodeCountOffset >= 0)
+        write_u32(gen, (uint32_t)gen->nodeCountOffset, gen->nodeCount);
+    gen->data[offsetof(ACPI_TABLE_HEADER, Checksum)] = 0;
+    for (uint32_t i = 0; i < gen->length; i++)
+        sum += gen->data[i];
+    gen->data[offsetof(ACPI_TABLE_HEADER, Checksum)] = (uint8_t)(0 - sum);
+
+    *table = gen->data;
+    *length = gen->length;
+    return 0;
+}
+
+/**
+ * Start a PPTT, the subtables follow the header directly.
+ */
+int acpigen_pptt_begin(AcpiGen *gen, AcpiArena *arena) {
+    return acpigen_begin(gen, arena, (const char[]){ACPI_PPTT_SIGNATURE},
+                         ACPI_PPTT_REVISION, 0);
+}
+
+/**
+ * Append an ID structure.
+ */
+AcpiGenRef acpigen_pptt_id(AcpiGen *gen, const ACPI_PPTT_ID *id) {
+    AcpiGenRef ref = append_subtable(gen, id, sizeof(*id));
+
+    if (ref != ACPIGEN_NO_REF) {
+        ACPI_PPTT_ID *entry = (ACPI_PPTT_ID *)(gen->data + ref_offset(gen, ref));
+        entry->Type = 2;
+        entry->Length = sizeof(*entry);
+    }
+    return ref;
+}
+
+/**
+ * Append a cache type structure.
+ *
+ * @param gen         Builder.
+ * @param cache       Cache properties, Type and Length are filled in.
+ * @param next_level  Next level of cache, or ACPIGEN_NO_REF.
+ * @retval  Reference to the cache, ACPIGEN_NO_REF on error.
+ */
+AcpiGenRef acpigen_pptt_cache(AcpiGen *gen,
+                              const ACPI_PPTT_CACHE_TYPE_STRUCTURE *cache,
+                              AcpiGenRef next_level) {
+    AcpiGenRef ref = append_subtable(gen, cache, sizeof(*cache));
+    uint32_t offset;
+
+    if (ref == ACPIGEN_NO_REF)
+        return ref;
+    offset = ref_offset(gen, ref);
+    gen->data[offset + offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, Type)] = 1;
+    gen->data[offset + offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, Length)] =
+        sizeof(*cache);
+    acpigen_reference(
+        gen, offset + offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, NextLevelOfCache),
+        next_level);
+    return ref;
+}
+
+/**
+ * Append a processor hierarchy node with its private resources.
+ *
+ * @param gen                Builder.
+ * @param flags              PPTT_PROC_FLAG_*.
+ * @param acpi_processor_id  Matches the MADT GICC ACPIProcessorUID for CPUs.
+ * @param parent             Parent node, or ACPIGEN_NO_REF.
+ * @param resources          Private resources (caches, ID).
+ * @param resource_count     Number of resources.
+ * @retval  Reference to the node, ACPIGEN_NO_REF on error.
+ */
+AcpiGenRef acpigen_pptt_processor(AcpiGen *gen, uint32_t flags,
+                                  uint32_t acpi_processor_id,
+                                  AcpiGenRef parent,
+                                  const AcpiGenRef *resources,
+                                  uint32_t resource_count) {
+    size_t size = sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +
+                  (size_t)resource_count * sizeof(ACPI_PPTT_PRIVATE_RESOURCE);
+    ACPI_PPTT_PROCESSOR_HIERARCHY_NODE node = {0};
+    AcpiGenRef ref;
+    uint32_t offset;
+
+    if (size > UINT8_MAX) {
+        set_error(gen, -E2BIG);
+        return ACPIGEN_NO_REF;
+    }
+    node.Type = 0;
+    node.Length = (uint8_t)size;
+    node.Flags = flags;
+    node.AcpiProcessorId = acpi_processor_id;
+    node.NumberOfPrivateResources = resource_count;
+
+    ref = append_subtable(gen, NULL, size);
+    if (ref == ACPIGEN_NO_REF)
+        return ref;
+    offset = ref_offset(gen, ref);
+    memcpy(gen->data + offset, &node, sizeof(node));
+    acpigen_reference(
+        gen, offset + offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent),
+        parent);
+    for (uint32_t i = 0; i < resource_count; i++)
+        acpigen_reference(gen,
+                          offset + sizeof(node) +
+                              i * sizeof(ACPI_PPTT_PRIVATE_RESOURCE),
+                          resources[i]);
+    return ref;
+}
+
+/**
+ * Start a MADT with its header extra data.
+ */
+int acpigen_madt_begin(AcpiGen *gen, AcpiArena *arena,
+                       uint32_t local_intc_address, uint32_t flags) {
+    MADT_HEADER_EXTRA_DATA extra = {
+        .LocalInterruptControllerAddress = local_intc_address,
+        .Flags = flags,
+    };
+    int ret = acpigen_begin(gen, arena, (const char[]){ACPI_MADT_SIGNATURE},
+                            ACPI_MADT_REVISION, sizeof(extra));
+
+    if (ret == 0)
+        acpigen_write(gen, sizeof(ACPI_TABLE_HEADER), &extra, sizeof(extra));
+    return ret;
+}
+
+// MADT structures start with UINT8 Type and UINT8 Length
+static AcpiGenRef append_madt(AcpiGen *gen, const void *data, size_t size,
+                              uint8_t type) {
+    AcpiGenRef ref = append_subtable(gen, data, size);
+
+    if (ref != ACPIGEN_NO_REF) {
+        gen->data[ref_offset(gen, ref)] = type;
+        gen->data[ref_offset(gen, ref) + 1] = (uint8_t)size;
+    }
+    return ref;
+}
+
+AcpiGenRef acpigen_madt_gicc(AcpiGen *gen, const MADT_GICC_STRUCTURE *gicc) {
+    return append_madt(gen, gicc, sizeof(*gicc), 0xB);
+}
+
+AcpiGenRef acpigen_madt_gicd(AcpiGen *gen, const MADT_GICD_STRUCTURE *gicd) {
+    return append_madt(gen, gicd, sizeof(*gicd), 0xC);
+}
+
+AcpiGenRef acpigen_madt_gic_msi_frame(AcpiGen *gen,
+                                      const MADT_GIC_MSI_FRAME_STRUCTURE *msi) {
+    return append_madt(gen, msi, sizeof(*msi), 0xD);
+}
+
+AcpiGenRef acpigen_madt_gicr(AcpiGen *gen, const MADT_GICR_STRUCTURE *gicr) {
+    return append_madt(gen, gicr, sizeof(*gicr), 0xE);
+}
+
+AcpiGenRef acpigen_madt_gic_its(AcpiGen *gen,
+                                const MADT_GIC_ITS_STRUCTURE *its) {
+    return append_madt(gen, its, sizeof(*its), 0xF);
+}
+
+/**
+ * Start an IORT, NumOfNodes is counted by acpigen_finalize().
+ */
+int acpigen_iort_begin(AcpiGen *gen, AcpiArena *arena) {
+    IORT_HEADER_EXTRA_DATA extra = {
+        .NumOfNodes = 0,
+        .OffsetToNodeArray =
+            sizeof(ACPI_TABLE_HEADER) + sizeof(IORT_HEADER_EXTRA_DATA),
+        .Reserved = 0,
+    };
+    int ret = acpigen_begin(gen, arena, (const char[]){ACPI_IORT_SIGNATURE},
+                            ACPI_IORT_REVISION, sizeof(extra));
+
+    if (ret == 0) {
+        acpigen_write(gen, sizeof(ACPI_TABLE_HEADER), &extra, sizeof(extra));
+        gen->nodeCountOffset =
+            sizeof(ACPI_TABLE_HEADER) + offsetof(IORT_HEADER_EXTRA_DATA, NumOfNodes);
+    }
+    return ret;
+}
+
+/**
+ * Append an IORT node followed by its ID mappings.
+ *
+ * @param gen            Builder.
+ * @param node           Node starting with IORT_NODE_FORMAT. Type, Revision
+ *                       and Identifier are kept, Length, NumOfIDMappings and
+ *                       ReferenceToIdArray are filled in.
+ * @param node_size      Node size, without the ID mappings.
+ * @param mappings       ID mappings, output references resolved at finalize.
+ * @param mapping_count  Number of ID mappings.
+ * @retval  Reference to the node, ACPIGEN_NO_REF on error.
+ */
+AcpiGenRef acpigen_iort_node(AcpiGen *gen, const void *node, size_t node_size,
+                             const AcpiGenIortMapping *mappings,
+                             uint32_t mapping_count) {
+    size_t size = node_size + (size_t)mapping_count * sizeof(IORT_ID_MAPPING_FORMAT);
+    IORT_NODE_FORMAT header;
+    AcpiGenRef ref;
+    uint32_t offset;
+
+    if (node_size < sizeof(IORT_NODE_FORMAT)) {
+        set_error(gen, -EINVAL);
+        return ACPIGEN_NO_REF;
+    }
+    if (size > UINT16_MAX) {
+        set_error(gen, -E2BIG);
+        return ACPIGEN_NO_REF;
+    }
+
+    ref = append_subtable(gen, NULL, size);
+    if (ref == ACPIGEN_NO_REF)
+        return ref;
+    offset = ref_offset(gen, ref);
+    memcpy(gen->data + offset, node, node_size);
+    memcpy(&header, node, sizeof(header));
+    header.Length = (uint16_t)size;
+    header.NumOfIDMappings = mapping_count;
+    header.ReferenceToIdArray = mapping_count ? (uint32_t)node_size : 0;
+    memcpy(gen->data + offset, &header, sizeof(header));
+
+    for (uint32_t i = 0; i < mapping_count; i++) {
+        uint32_t entry = offset + (uint32_t)node_size +
+                         i * sizeof(IORT_ID_MAPPING_FORMAT);
+        IORT_ID_MAPPING_FORMAT mapping = {
+            .InputBase = mappings[i].inputBase,
+            .NumOfIds = mappings[i].numOfIds,
+            .OutputBase = mappings[i].outputBase,
+            .OutputReference = 0,
+            .Flags = mappings[i].flags,
+        };
+        memcpy(gen->data + entry, &mapping, sizeof(mapping));
+        acpigen_reference(
+            gen, entry + offsetof(IORT_ID_MAPPING_FORMAT, OutputReference),
+            mappings[i].output);
+    }
+    return ref;
+}
+
+/**
+ * Append an ITS group node listing GIC ITS identifiers.
+ */
+AcpiGenRef acpigen_iort_its_group(AcpiGen *gen, uint32_t identifier,
+                                  const uint32_t *its_ids, uint32_t count) {
+    size_t size = sizeof(IORT_ITS_GROUP_NODE) + (size_t)count * sizeof(uint32_t);
+    IORT_ITS_GROUP_NODE node = {0};
+    AcpiGenRef ref;
+    uint32_t offset;
+
+    if (size > UINT16_MAX) {
+        set_error(gen, -E2BIG);
+        return ACPIGEN_NO_REF;
+    }
+    node.NodeHeader.Type = IORT_NODE_TYPE_ITS_GROUP;
+    node.NodeHeader.Length = (uint16_t)size;
+    node.NodeHeader.Revision = 1;
+    node.NodeHeader.Identifier = identifier;
+    node.NumOfITS = count;
+
+    ref = append_subtable(gen, NULL, size);
+    if (ref == ACPIGEN_NO_REF)
+        return ref;
+    offset = ref_offset(gen, ref);
+    memcpy(gen->data + offset, &node, sizeof(node));
+    if (count)
+        memcpy(gen->data + offset + sizeof(node), its_ids,
+               count * sizeof(uint32_t));
+    return ref;
+}
@@ -0,0 +1,188 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "bundle.h"
+#include "utils.h"
+#include <string.h>
+#ifdef ACPI_BUNDLE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static bool bundle_range_valid(const AcpiBundle *bundle, uint64_t offset,
+                               uint64_t length) {
+    return offset <= bundle->size && length <= bundle->size - offset;
+}
+
+/**
+ * Validate a bundle buffer and set up a view over it.
+ *
+ * No data is copied, buffer must stay valid while bundle is used.
+ *
+ * @param bundle    View to initialize.
+ * @param buffer    Bundle content, 8 bytes aligned.
+ * @param size      Buffer size.
+ * @retval 0        Success.
+ * @retval -EINVAL  Not a bundle, unsupported version or corrupted layout.
+ */
+int bundle_open(AcpiBundle *bundle, const uint8_t *buffer, size_t size) {
+    const char magic[] = {ACPI_BUNDLE_MAGIC};
+    const ACPI_BUNDLE_HEADER *header = (const ACPI_BUNDLE_HEADER *)buffer;
+
+    memset(bundle, 0, sizeof(*bundle));
+    if (buffer == NULL || size < sizeof(ACPI_BUNDLE_HEADER))
+        return -EINVAL;
+    if (memcmp(header->Magic, magic, sizeof(magic)) != 0)
+        return -EINVAL;
+    if (header->Version != ACPI_BUNDLE_VERSION)
+        return -EINVAL;
+    if (header->TotalSize != size)
+        return -EINVAL;
+
+    bundle->base = buffer;
+    bundle->size = size;
+    if (!bundle_range_valid(bundle, header->IndexOffset,
+                            (uint64_t)header->EntryCount *
+                                sizeof(ACPI_BUNDLE_INDEX_ENTRY)) ||
+        !bundle_range_valid(bundle, header->BlobOffset,
+                            (uint64_t)header->BlobCount *
+                                sizeof(ACPI_BUNDLE_BLOB_ENTRY)))
+        return -EINVAL;
+
+    bundle->header = header;
+    bundle->index =
+        (const ACPI_BUNDLE_INDEX_ENTRY *)(buffer + header->IndexOffset);
+    bundle->blobs =
+        (const ACPI_BUNDLE_BLOB_ENTRY *)(buffer + header->BlobOffset);
+
+    for (uint32_t i = 0; i < header->EntryCount; i++) {
+        if (bundle->index[i].BlobIndex >= header->BlobCount)
+            return -EINVAL;
+    }
+    for (uint32_t i = 0; i < header->BlobCount; i++) {
+        if (!bundle_range_valid(bundle, bundle->blobs[i].Offset,
+                                bundle->blobs[i].StoredSize))
+            return -EINVAL;
+    }
+    return 0;
+}
+
+/**
+ * Compare a (device, signature) key against an index entry.
+ *
+ * Index is sorted with this order, device name first then signature.
+ *
+ * @retval <0, 0, >0 like strcmp.
+ */
+int bundle_compare_key(const char *device, const char *signature,
+                       const ACPI_BUNDLE_INDEX_ENTRY *entry) {
+    int ret = strncmp(device, entry->Device, ACPI_BUNDLE_DEVICE_NAME_SIZE);
+    if (ret != 0)
+        return ret;
+    return memcmp(signature, entry->Signature, sizeof(entry->Signature));
+}
+
+/**
+ * Binary search a table in the bundle index.
+ *
+ * @param bundle    Bundle opened with bundle_open.
+ * @param device    Device name, e.g. "qcom_sm8850".
+ * @param signature 4 characters table signature.
+ * @return  Index entry or NULL if the table is not in the bundle.
+ */
+const ACPI_BUNDLE_INDEX_ENTRY *bundle_find(const AcpiBundle *bundle,
+                                           const char *device,
+                                           const char *signature) {
+    size_t low = 0;
+    size_t high = bundle->header->EntryCount;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int ret = bundle_compare_key(device, signature, &bundle->index[mid]);
+        if (ret == 0)
+            return &bundle->index[mid];
+        if (ret < 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return NULL;
+}
+
+/**
+ * Get the blob holding the content of an index entry.
+ */
+const ACPI_BUNDLE_BLOB_ENTRY *
+bundle_entry_blob(const AcpiBundle *bundle,
+                  const ACPI_BUNDLE_INDEX_ENTRY *entry) {
+    return &bundle->blobs[entry->BlobIndex];
+}
+
+/**
+ * Get a pointer to an uncompressed table inside the bundle.
+ *
+ * @return  Table data or NULL if the blob is compressed.
+ */
+const uint8_t *bundle_blob_data(const AcpiBundle *bundle,
+                                const ACPI_BUNDLE_BLOB_ENTRY *blob) {
+    if (blob->Compression != ACPI_BUNDLE_COMPRESSION_NONE)
+        return NULL;
+    return bundle->base + blob->Offset;
+}
+
+/**
+ * Check whether this build can decode a compression method.
+ */
+bool bundle_compression_supported(uint8_t compression) {
+    if (compression == ACPI_BUNDLE_COMPRESSION_NONE)
+        return true;
+#ifdef ACPI_BUNDLE_HAVE_ZLIB
+    if (compression == ACPI_BUNDLE_COMPRESSION_DEFLATE)
+        return true;
+#endif
+    return false;
+}
+
+/**
+ * Copy (and decompress if needed) a table out of the bundle.
+ *
+ * @param bundle        Bundle opened with bundle_open.
+ * @param blob          Blob to read.
+ * @param output        Buffer of at least blob->Size bytes.
+ * @param output_size   Output buffer size.
+ * @retval 0        Success.
+ * @retval -ENOMEM  Output buffer too small.
+ * @retval -EINVAL  Unsupported compression method.
+ * @retval -EIO     Corrupted payload.
+ */
+int bundle_read_blob(const AcpiBundle *bundle,
+                     const ACPI_BUNDLE_BLOB_ENTRY *blob, uint8_t *output,
+                     size_t output_size) {
+    const uint8_t *payload = bundle->base + blob->Offset;
+
+    if (output_size < blob->Size)
+        return -ENOMEM;
+
+    switch (blob->Compression) {
+    case ACPI_BUNDLE_COMPRESSION_NONE:
+        if (blob->StoredSize != blob->Size)
+            return -EIO;
+        memcpy(output, payload, blob->Size);
+        return 0;
+#ifdef ACPI_BUNDLE_HAVE_ZLIB
+    case ACPI_BUNDLE_COMPRESSION_DEFLATE: {
+        uLongf length = blob->Size;
+        if (uncompress(output, &length, payload, blob->StoredSize) != Z_OK ||
+            length != blob->Size)
+            return -EIO;
+        return 0;
+    }
+#endif
+    default:
+        return -EINVAL;
+    }
+}
@@ -0,0 +1,525 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "dtb_platform.h"
+#include <common/madt.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const FdtTree *tree;
+    uint32_t *order; // Non root nodes in script stack order
+    uint32_t orderCount;
+    uint32_t cpus; // /cpus, FDT_NO_NODE if missing
+} DtbWalk;
+
+/**
+ * Case insensitive substring test, as the scripts' "x in name.lower()".
+ */
+bool dtb_contains_nocase(const char *text, const char *needle) {
+    size_t length = strlen(needle);
+
+    for (; *text; text++) {
+        size_t i = 0;
+        while (i < length && text[i] &&
+               tolower((unsigned char)text[i]) ==
+                   tolower((unsigned char)needle[i]))
+            i++;
+        if (i == length)
+            return true;
+    }
+    return length == 0;
+}
+
+/**
+ * OEM revision from "sm<hex digits>" in a file name, sm8850 -> 0x8850.
+ *
+ * @retval  0 if the name has no such part.
+ */
+uint64_t dtb_infer_oem_revision(const char *name) {
+    for (const char *p = name; p[0] && p[1]; p++) {
+        if (tolower((unsigned char)p[0]) == 's' &&
+            tolower((unsigned char)p[1]) == 'm' &&
+            isxdigit((unsigned char)p[2]))
+            return strtoull(p + 2, NULL, 16);
+    }
+    return 0;
+}
+
+/**
+ * Name of a GIC version as used in madt.h.
+ */
+const char *dtb_gic_version_name(uint8_t version) {
+    switch (version) {
+    case GIC_V3:
+        return "GIC_V3";
+    case GIC_V4:
+        return "GIC_V4";
+    default:
+        return "GIC_INVALID";
+    }
+}
+
+/**
+ * Property decoded as cells by pyfdt: not a string list, non empty and a
+ * multiple of 4 bytes.
+ */
+static const FdtProperty *words_property(const FdtTree *tree, uint32_t node,
+                                         const char *name) {
+    const FdtProperty *property = fdt_get_property(tree, node, name);
+
+    if (property == NULL || property->length == 0 || property->length % 4 ||
+        fdt_property_is_string(property))
+        return NULL;
+    return property;
+}
+
+/**
+ * Count the strings of a string list property that contain any needle.
+ */
+static uint32_t count_strings(const FdtProperty *property, const char *first,
+                              const char *second) {
+    uint32_t position = 0;
+    uint32_t count = 0;
+
+    if (!fdt_property_is_string(property))
+        return 0;
+    while (position < property->length) {
+        const char *text = (const char *)property->value + position;
+        if (strstr(text, first) != NULL || strstr(text, second) != NULL)
+            count++;
+        position += (uint32_t)strlen(text) + 1;
+    }
+    return count;
+}
+
+static int build_stack_order(DtbWalk *walk) {
+    const FdtTree *tree = walk->tree;
+    uint32_t *stack = malloc(tree->nodeCount * sizeof(*stack));
+    uint32_t depth = 0;
+
+    walk->order = malloc(tree->nodeCount * sizeof(*walk->order));
+    if (stack == NULL || walk->order == NULL) {
+        free(stack);
+        return -ENOMEM;
+    }
+    stack[depth++] = 0;
+    while (depth > 0) {
+        uint32_t node = stack[--depth];
+        for (uint32_t child = tree->nodes[node].firstChild;
+             child != FDT_NO_NODE; child = tree->nodes[child].nextSibling) {
+            walk->order[walk->orderCount++] = child;
+            stack[depth++] = child;
+        }
+    }
+    free(stack);
+    return 0;
+}
+
+static uint32_t count_cpu_children(const FdtTree *tree, uint32_t node) {
+    uint32_t count = 0;
+
+    for (uint32_t child = tree->nodes[node].firstChild; child != FDT_NO_NODE;
+         child = tree->nodes[child].nextSibling) {
+        if (strncmp(tree->nodes[child].name, "cpu@", 4) == 0)
+            count++;
+    }
+    return count;
+}
+
+/**
+ * Cluster sizes from /cpus/<node>/cpu-map/cluster@*, counting cpu@ nodes.
+ */
+static uint32_t cpu_map_clusters(const DtbWalk *walk, uint32_t *clusters) {
+    const FdtTree *tree = walk->tree;
+
+    if (walk->cpus == FDT_NO_NODE)
+        return 0;
+    for (uint32_t child = tree->nodes[walk->cpus].firstChild;
+         child != FDT_NO_NODE; child = tree->nodes[child].nextSibling) {
+        for (uint32_t map = tree->nodes[child].firstChild; map != FDT_NO_NODE;
+             map = tree->nodes[map].nextSibling) {
+            uint32_t count = 0;
+            if (strcmp(tree->nodes[map].name, "cpu-map") != 0)
+                continue;
+            for (uint32_t cluster = tree->nodes[map].firstChild;
+                 cluster != FDT_NO_NODE && count < DTB_MAX_CLUSTERS;
+                 cluster = tree->nodes[cluster].nextSibling) {
+                if (strncmp(tree->nodes[cluster].name, "cluster@", 8) == 0)
+                    clusters[count++] = count_cpu_children(tree, cluster);
+            }
+            if (count)
+                return count;
+        }
+    }
+    return 0;
+}
+
+static uint32_t append_gic_classes(const FdtTree *tree, uint32_t node,
+                                   uint32_t *clusters, uint32_t count) {
+    const FdtNode *entry = &tree->nodes[node];
+
+    for (uint32_t i = 0; i < entry->propertyCount && count < DTB_MAX_CLUSTERS;
+         i++) {
+        const FdtProperty *property =
+            &tree->properties[entry->firstProperty + i];
+        if (strncmp(property->name, "qcom,gic-class", 14) == 0 &&
+            property->length && property->length % 4 == 0 &&
+            !fdt_property_is_string(property))
+            clusters[count++] = fdt_property_cells(property);
+    }
+    return count;
+}
+
+/**
+ * Cluster sizes from the qcom,gic-class* lists of the gic-interrupt-router
+ * node, or of any node when there is no router.
+ */
+static uint32_t qcom_gic_clusters(const DtbWalk *walk, uint32_t *clusters) {
+    const FdtTree *tree = walk->tree;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < walk->orderCount; i++) {
+        uint32_t node = walk->order[i];
+        if (strstr(tree->nodes[node].name, "gic-interrupt-router") == NULL)
+            continue;
+        count = append_gic_classes(tree, node, clusters, 0);
+        if (count)
+            return count;
+    }
+    for (uint32_t i = 0; i < walk->orderCount; i++)
+        count = append_gic_classes(tree, walk->order[i], clusters, count);
+    return count;
+}
+
+static int compare_descending(const void *a, const void *b) {
+    uint32_t left = *(const uint32_t *)a;
+    uint32_t right = *(const uint32_t *)b;
+    return (left < right) - (left > right);
+}
+
+// dtb_to_table_header.py: cores, clusters and cache levels
+static void extract_topology(const DtbWalk *walk, DtbPlatform *platform) {
+    const FdtTree *tree = walk->tree;
+    uint32_t l2_phandle = 0;
+
+    // Cores, and whether they all share one next-level-cache
+    if (walk->cpus != FDT_NO_NODE) {
+        for (uint32_t cpu = tree->nodes[walk->cpus].firstChild;
+             cpu != FDT_NO_NODE; cpu = tree->nodes[cpu].nextSibling) {
+            const FdtProperty *cache;
+            if (strncmp(tree->nodes[cpu].name, "cpu@", 4) != 0)
+                continue;
+            cache = words_property(tree, cpu, "next-level-cache");
+            if (platform->cores == 0) {
+                platform->l2Shared = cache != NULL;
+                l2_phandle = cache ? fdt_property_cell(cache, 0) : 0;
+            } else if (cache == NULL ||
+                       fdt_property_cell(cache, 0) != l2_phandle) {
+                platform->l2Shared = false;
+            }
+            platform->cores++;
+        }
+    }
+
+    platform->clusterCount = cpu_map_clusters(walk, platform->clusters);
+    if (platform->clusterCount == 0)
+        platform->clusterCount = qcom_gic_clusters(walk, platform->clusters);
+    if (platform->clusterCount == 0) {
+        platform->clusters[0] = platform->cores;
+        platform->clusterCount = 1;
+    }
+    qsort(platform->clusters, platform->clusterCount,
+          sizeof(*platform->clusters), compare_descending);
+
+    for (uint32_t i = 1; i < tree->nodeCount && !platform->l3; i++) {
+        platform->l3 = dtb_contains_nocase(tree->nodes[i].name, "l3") ||
+                       fdt_get_property(tree, i, "cache-level") != NULL ||
+                       fdt_get_property(tree, i, "cache-size") != NULL ||
+                       fdt_get_property(tree, i, "cache-levels") != NULL;
+    }
+}
+
+static uint64_t triplet_gsi(const FdtProperty *property, uint32_t triplet) {
+    uint64_t type = fdt_property_cell(property, triplet * 3);
+    uint64_t number = fdt_property_cell(property, triplet * 3 + 1);
+    return type == 1 ? 16 + number : number;
+}
+
+/**
+ * GSI from the first matching "*<needle>*" cell property, scanning one
+ * batch of siblings at a time like the script does.
+ */
+static uint64_t fallback_gsi(const DtbWalk *walk, const char *needle) {
+    const FdtTree *tree = walk->tree;
+    uint64_t gsi = 0;
+
+    for (uint32_t i = 0; i < walk->orderCount; i++) {
+        const FdtNode *node = &tree->nodes[walk->order[i]];
+        for (uint32_t p = 0; p < node->propertyCount; p++) {
+            const FdtProperty *property =
+                &tree->properties[node->firstProperty + p];
+            if (strstr(property->name, needle) != NULL && property->length &&
+                property->length % 4 == 0 && !fdt_property_is_string(property))
+                gsi = triplet_gsi(property, 0);
+        }
+        // The script only checks for a hit after each popped node's children
+        if (gsi != 0 &&
+            (i + 1 == walk->orderCount ||
+             tree->nodes[walk->order[i + 1]].parent != node->parent))
+            break;
+    }
+    return gsi;
+}
+
+static bool is_gic_node(const FdtTree *tree, uint32_t node) {
+    const FdtNode *entry = &tree->nodes[node];
+    bool controller = false;
+    bool gic = false;
+
+    for (uint32_t i = 0; i < entry->propertyCount; i++) {
+        const FdtProperty *property =
+            &tree->properties[entry->firstProperty + i];
+        controller |= strcmp(property->name, "interrupt-controller") == 0;
+        gic |= fdt_property_has_string(property, "gic");
+    }
+    // The script matches the name of any item, subnodes included
+    for (uint32_t child = entry->firstChild;
+         child != FDT_NO_NODE && !controller;
+         child = tree->nodes[child].nextSibling)
+        controller =
+            strcmp(tree->nodes[child].name, "interrupt-controller") == 0;
+    return controller && gic;
+}
+
+static uint8_t gic_version(const FdtTree *tree, uint32_t gic) {
+    const FdtProperty *compatible;
+    bool v3 = false;
+    uint32_t position = 0;
+
+    if (gic == FDT_NO_NODE)
+        return GIC_INVALID;
+    compatible = fdt_get_property(tree, gic, "compatible");
+    if (compatible == NULL || !fdt_property_is_string(compatible))
+        return GIC_INVALID;
+    while (position < compatible->length) {
+        const char *text = (const char *)compatible->value + position;
+        if (dtb_contains_nocase(text, "gic-v4"))
+            return GIC_V4;
+        v3 |= dtb_contains_nocase(text, "gic-v3");
+        position += (uint32_t)strlen(text) + 1;
+    }
+    return v3 ? GIC_V3 : GIC_INVALID;
+}
+
+// dtb_to_madt.py: GIC distributor, redistributors, ITS and PPIs
+static void extract_gic(const DtbWalk *walk, DtbPlatform *platform) {
+    const FdtTree *tree = walk->tree;
+    uint32_t gic = FDT_NO_NODE;
+    uint32_t its = FDT_NO_NODE;
+
+    // GIC and ITS nodes in one walk, every matching string counts as an ITS
+    for (uint32_t i = 0; i < walk->orderCount; i++) {
+        uint32_t node = walk->order[i];
+        const FdtNode *entry = &tree->nodes[node];
+        if (gic == FDT_NO_NODE && is_gic_node(tree, node))
+            gic = node;
+        for (uint32_t p = 0; p < entry->propertyCount; p++) {
+            uint32_t hits =
+                count_strings(&tree->properties[entry->firstProperty + p],
+                              "gic-its", "gic,its");
+            if (hits && its == FDT_NO_NODE)
+                its = node;
+            platform->itsCount += hits;
+        }
+    }
+
+    if (gic != FDT_NO_NODE) {
+        const FdtProperty *reg = words_property(tree, gic, "reg");
+        const FdtProperty *stride =
+            words_property(tree, gic, "redistributor-stride");
+        const FdtProperty *interrupts = words_property(tree, gic, "interrupts");
+
+        if (reg != NULL) {
+            platform->gicdBase = fdt_property_cell(reg, 0);
+            platform->gicrBase = fdt_property_cell(reg, 2);
+        }
+        if (stride != NULL)
+            platform->gicrStride =
+                fdt_property_cells(stride) == 1
+                    ? fdt_property_cell(stride, 0)
+                    : ((uint64_t)fdt_property_cell(stride, 0) << 32) |
+                          fdt_property_cell(stride, 1);
+        if (interrupts != NULL) {
+            platform->vgicGsi = triplet_gsi(interrupts, 0);
+            platform->perfGsi = fdt_property_cells(interrupts) > 3
+                                    ? triplet_gsi(interrupts, 1)
+                                    : platform->vgicGsi;
+        }
+    }
+    if (its != FDT_NO_NODE) {
+        const FdtProperty *reg = words_property(tree, its, "reg");
+        if (reg != NULL)
+            platform->itsBase = fdt_property_cell(reg, 0);
+    }
+    if (platform->vgicGsi == 0)
+        platform->vgicGsi = fallback_gsi(walk, "vgic");
+    if (platform->perfGsi == 0)
+        platform->perfGsi = fallback_gsi(walk, "performance");
+    platform->gicVersion = gic_version(tree, gic);
+}
+
+// First architected timer with all four PPIs
+static void extract_timer(const DtbWalk *walk, DtbPlatform *platform) {
+    const FdtTree *tree = walk->tree;
+
+    for (uint32_t i = 0; i < walk->orderCount; i++) {
+        uint32_t node = walk->order[i];
+        const FdtProperty *compatible =
+            fdt_get_property(tree, node, "compatible");
+        const FdtProperty *interrupts;
+
+        if (compatible == NULL ||
+            (!fdt_property_has_string(compatible, "arm,armv8-timer") &&
+             !fdt_property_has_string(compatible, "arm,armv7-timer")))
+            continue;
+        interrupts = words_property(tree, node, "interrupts");
+        if (interrupts == NULL || fdt_property_cells(interrupts) < 12)
+            continue;
+        for (uint32_t t = 0; t < 4; t++)
+            platform->timerGsi[t] = (uint32_t)triplet_gsi(interrupts, t);
+        platform->hasTimer = true;
+        return;
+    }
+}
+
+/**
+ * Configuration space base for bus 0 from a ranges entry. The parent
+ * address sometimes sits in the high cell with a zero low cell, and the
+ * child address may encode a starting bus in bits 23:16.
+ */
+static uint64_t ecam_base(uint32_t parent_high, uint32_t parent_low,
+                          uint32_t phys_low) {
+    uint64_t parent = ((uint64_t)parent_high << 32) | parent_low;
+    uint64_t candidate =
+        parent_low == 0 && parent_high != 0 ? parent_high : parent;
+    uint64_t bus_offset = (uint64_t)((phys_low >> 16) & 0xFF) << 16;
+
+    // Below 4 GiB (or negative) the script keeps a 32 bit value
+    if (candidate < bus_offset || candidate - bus_offset <= 0xFFFFFFFFULL)
+        return (candidate - bus_offset) & 0xFFFFFFFFULL;
+    return candidate - bus_offset;
+}
+
+static bool mcfg_entry(const FdtTree *tree, uint32_t node,
+                       DtbMcfgEntry *entry) {
+    const FdtProperty *segment = words_property(tree, node, "linux,pci-domain");
+    const FdtProperty *bus = words_property(tree, node, "bus-range");
+    const FdtProperty *ranges = words_property(tree, node, "ranges");
+    uint32_t cells;
+
+    if (ranges == NULL)
+        return false;
+    memset(entry, 0, sizeof(*entry));
+    entry->segment = segment ? fdt_property_cell(segment, 0) : 0;
+    entry->busEnd = 0xFF;
+    if (bus != NULL && fdt_property_cells(bus) >= 2) {
+        entry->busStart = fdt_property_cell(bus, 0);
+        entry->busEnd = fdt_property_cell(bus, 1);
+    }
+
+    // <phys_hi phys_mid phys_lo> <parent_hi parent_lo> <size_hi size_lo>
+    cells = fdt_property_cells(ranges);
+    for (uint32_t i = 0; i + 6 < cells; i += 7) {
+        if (fdt_property_cell(ranges, i) >> 30 == 0) {
+            entry->base = ecam_base(fdt_property_cell(ranges, i + 3),
+                                    fdt_property_cell(ranges, i + 4),
+                                    fdt_property_cell(ranges, i + 2));
+            snprintf(entry->comment, sizeof(entry->comment), "%s",
+                     tree->nodes[node].name);
+            return true;
+        }
+    }
+    // No config range, the first high memory range is likely the ECAM
+    for (uint32_t i = 0; i + 6 < cells; i += 7) {
+        uint64_t parent =
+            ((uint64_t)fdt_property_cell(ranges, i + 3) << 32) |
+            fdt_property_cell(ranges, i + 4);
+        if (fdt_property_cell(ranges, i) >> 30 == 2 &&
+            parent > 0x100000000ULL) {
+            entry->base = ecam_base(fdt_property_cell(ranges, i + 3),
+                                    fdt_property_cell(ranges, i + 4),
+                                    fdt_property_cell(ranges, i + 2));
+            fdt_node_path(tree, node, entry->comment, sizeof(entry->comment));
+            return true;
+        }
+    }
+    return false;
+}
+
+// dtb_to_mcfg.py: one ECAM entry per pcie node with a usable range
+static int extract_mcfg(const FdtTree *tree, DtbPlatform *platform) {
+    // Node order is pre-order, and the sort by segment below is stable
+    for (uint32_t node = 1; node < tree->nodeCount; node++) {
+        DtbMcfgEntry entry;
+        DtbMcfgEntry *grown;
+        uint32_t at;
+
+        if (!dtb_contains_nocase(tree->nodes[node].name, "pcie") ||
+            !mcfg_entry(tree, node, &entry))
+            continue;
+        grown = realloc(platform->mcfg,
+                        (platform->mcfgCount + 1) * sizeof(*grown));
+        if (grown == NULL)
+            return -ENOMEM;
+        platform->mcfg = grown;
+        at = platform->mcfgCount++;
+        while (at > 0 && grown[at - 1].segment > entry.segment) {
+            grown[at] = grown[at - 1];
+            at--;
+        }
+        grown[at] = entry;
+    }
+    return 0;
+}
+
+/**
+ * Extract the platform description of a parsed tree.
+ *
+ * @param tree      Parsed DTB.
+ * @param platform  Result, release with dtb_platform_free().
+ * @retval 0        Success.
+ * @retval -ENOMEM  Out of memory.
+ */
+int dtb_platform_extract(const FdtTree *tree, DtbPlatform *platform) {
+    DtbWalk walk = {.tree = tree};
+    int ret;
+
+    memset(platform, 0, sizeof(*platform));
+    walk.cpus = fdt_find_path(tree, "/cpus");
+    ret = build_stack_order(&walk);
+    if (ret == 0) {
+        extract_topology(&walk, platform);
+        extract_gic(&walk, platform);
+        extract_timer(&walk, platform);
+        ret = extract_mcfg(tree, platform);
+    }
+    free(walk.order);
+    if (ret < 0)
+        dtb_platform_free(platform);
+    return ret;
+}
+
+void dtb_platform_free(DtbPlatform *platform) {
+    free(platform->mcfg);
+    platform->mcfg = NULL;
+    platform->mcfgCount = 0;
+}
@@ -0,0 +1,497 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "fdt.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FDT_BEGIN_NODE 0x1
+#define FDT_END_NODE 0x2
+#define FDT_PROP 0x3
+#define FDT_NOP 0x4
+#define FDT_END 0x9
+
+#define FDT_HEADER_SIZE 40
+#define FDT_MIN_VERSION 17 // size_dt_struct is in the header from v17
+#define FDT_MAX_DEPTH 64
+#define FDT_MAX_PATH 1024
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+static uint32_t be32(const uint8_t *data) {
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+           ((uint32_t)data[2] << 8) | data[3];
+}
+
+static uint64_t fnv_update(uint64_t hash, const char *text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)text[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t index_slot(uint64_t key, uint32_t size) {
+    return (uint32_t)((key ^ (key >> 29)) & (size - 1));
+}
+
+static int grow_array(void **array, uint32_t *capacity, uint32_t count,
+                      size_t element_size) {
+    void *grown;
+    uint32_t new_capacity;
+
+    if (count < *capacity)
+        return 0;
+    new_capacity = *capacity ? *capacity * 2 : 256;
+    grown = realloc(*array, new_capacity * element_size);
+    if (grown == NULL)
+        return -ENOMEM;
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * Build both hash indexes once all nodes are known.
+ *
+ * @retval 0        Success.
+ * @retval -ENOMEM  Out of memory.
+ */
+static int build_indexes(FdtTree *tree) {
+    uint32_t size = 16;
+
+    while (size < tree->nodeCount * 2)
+        size *= 2;
+    tree->pathIndex = malloc(size * sizeof(*tree->pathIndex));
+    tree->phandleIndex = malloc(size * sizeof(*tree->phandleIndex));
+    if (tree->pathIndex == NULL || tree->phandleIndex == NULL)
+        return -ENOMEM;
+    memset(tree->pathIndex, 0xFF, size * sizeof(*tree->pathIndex));
+    memset(tree->phandleIndex, 0xFF, size * sizeof(*tree->phandleIndex));
+    tree->pathIndexSize = size;
+    tree->phandleIndexSize = size;
+
+    for (uint32_t i = 0; i < tree->nodeCount; i++) {
+        const FdtNode *node = &tree->nodes[i];
+        uint32_t slot = index_slot(node->pathHash, size);
+
+        while (tree->pathIndex[slot] != FDT_NO_NODE)
+            slot = (slot + 1) & (size - 1);
+        tree->pathIndex[slot] = i;
+
+        if (node->phandle == 0 || node->phandle == UINT32_MAX)
+            continue;
+        slot = index_slot(node->phandle, size);
+        while (tree->phandleIndex[slot] != FDT_NO_NODE &&
+               tree->nodes[tree->phandleIndex[slot]].phandle != node->phandle)
+            slot = (slot + 1) & (size - 1);
+        if (tree->phandleIndex[slot] == FDT_NO_NODE)
+            tree->phandleIndex[slot] = i; // First node wins on duplicates
+    }
+    return 0;
+}
+
+/**
+ * Find the next DTB in a buffer holding several, like an Android dtb.img
+ * (concatenated blobs) or DTBO image (table header, then blobs).
+ *
+ * @param data    Buffer.
+ * @param size    Buffer size.
+ * @param offset  In: where to start looking, out: offset of the blob found.
+ * @retval  Size of the blob, 0 if there is none left.
+ */
+size_t fdt_find_blob(const uint8_t *data, size_t size, size_t *offset) {
+    for (size_t at = (*offset + 3) & ~(size_t)3;
+         at + FDT_HEADER_SIZE <= size && at >= *offset; at += 4) {
+        const uint8_t *header = data + at;
+        uint32_t total = be32(header + 4);
+
+        if (be32(header) != FDT_MAGIC || total < FDT_HEADER_SIZE ||
+            total > size - at || be32(header + 8) >= total ||
+            be32(header + 12) > total ||
+            be32(header + 20) < FDT_MIN_VERSION)
+            continue;
+        *offset = at;
+        return total;
+    }
+    return 0;
+}
+
+/**
+ * Parse a DTB already in memory, the blob must outlive the tree.
+ *
+ * @param tree   Tree to fill, released with fdt_close().
+ * @param blob   DTB content.
+ * @param size   Blob size, at least the header totalsize.
+ * @retval 0        Success.
+ * @retval -EINVAL  Not a DTB, or a truncated or malformed structure block.
+ * @retval -ENOMEM  Out of memory.
+ */
+int fdt_parse(FdtTree *tree, const uint8_t *blob, size_t size) {
+    uint32_t stack[FDT_MAX_DEPTH];
+    uint32_t last_child[FDT_MAX_DEPTH];
+    uint32_t node_capacity = 0, property_capacity = 0;
+    uint32_t struct_offset, struct_size, strings_offset, strings_size;
+    uint32_t offset, end;
+    int depth = -1;
+    bool done = false;
+    int ret = 0;
+
+    memset(tree, 0, sizeof(*tree));
+    tree->blob = blob;
+    tree->size = size;
+    if (size < FDT_HEADER_SIZE || be32(blob) != FDT_MAGIC ||
+        be32(blob + 4) > size)
+        return -EINVAL;
+
+    struct_offset = be32(blob + 8);
+    strings_offset = be32(blob + 12);
+    strings_size = be32(blob + 32);
+    struct_size = be32(blob + 36);
+    if (be32(blob + 20) < FDT_MIN_VERSION || struct_offset > size ||
+        struct_size > size - struct_offset || strings_offset > size ||
+        strings_size > size - strings_offset || struct_offset % 4 != 0)
+        return -EINVAL;
+
+    offset = struct_offset;
+    end = struct_offset + struct_size;
+    while (ret == 0 && !done) {
+        uint32_t token;
+
+        // Padding after a name or value may step past an unaligned end
+        if (offset > end || end - offset < 4) {
+            ret = -EINVAL;
+            break;
+        }
+        token = be32(blob + offset);
+        offset += 4;
+
+        switch (token) {
+        case FDT_BEGIN_NODE: {
+            const char *name = (const char *)blob + offset;
+            size_t name_length = strnlen(name, end - offset);
+            FdtNode *node;
+
+            if (name_length == end - offset || depth + 1 >= FDT_MAX_DEPTH ||
+                (depth < 0 && tree->nodeCount > 0)) {
+                ret = -EINVAL;
+                break;
+            }
+            ret = grow_array((void **)&tree->nodes, &node_capacity,
+                             tree->nodeCount, sizeof(FdtNode));
+            if (ret < 0)
+                break;
+
+            node = &tree->nodes[tree->nodeCount];
+            memset(node, 0, sizeof(*node));
+            node->name = name;
+            node->parent = depth >= 0 ? stack[depth] : FDT_NO_NODE;
+            node->firstChild = FDT_NO_NODE;
+            node->nextSibling = FDT_NO_NODE;
+            node->firstProperty = tree->propertyCount;
+            node->depth = (uint32_t)(depth + 1);
+            if (depth < 0) {
+                node->pathHash = fnv_update(FNV_OFFSET, "/", 1);
+            } else {
+                FdtNode *parent = &tree->nodes[stack[depth]];
+                uint64_t hash = depth == 0 ? FNV_OFFSET : parent->pathHash;
+                hash = fnv_update(hash, "/", 1);
+                node->pathHash = fnv_update(hash, name, name_length);
+                if (last_child[depth] == FDT_NO_NODE)
+                    parent->firstChild = tree->nodeCount;
+                else
+                    tree->nodes[last_child[depth]].nextSibling =
+                        tree->nodeCount;
+                last_child[depth] = tree->nodeCount;
+            }
+
+            depth++;
+            stack[depth] = tree->nodeCount;
+            last_child[depth] = FDT_NO_NODE;
+            tree->nodeCount++;
+            offset += (uint32_t)((name_length + 1 + 3) & ~(size_t)3);
+            break;
+        }
+        case FDT_END_NODE:
+            if (depth < 0)
+                ret = -EINVAL;
+            depth--;
+            break;
+        case FDT_PROP: {
+            uint32_t length, name_offset;
+            FdtNode *node;
+            FdtProperty *property;
+
+            if (depth < 0 || end - offset < 8) {
+                ret = -EINVAL;
+                break;
+            }
+            length = be32(blob + offset);
+            name_offset = be32(blob + offset + 4);
+            offset += 8;
+            node = &tree->nodes[stack[depth]];
+            // Properties come before subnodes, so they stay contiguous
+            if (length > end - offset || name_offset >= strings_size ||
+                memchr(blob + strings_offset + name_offset, '\0',
+                       strings_size - name_offset) == NULL ||
+                node->firstChild != FDT_NO_NODE) {
+                ret = -EINVAL;
+                break;
+            }
+            ret = grow_array((void **)&tree->properties, &property_capacity,
+                             tree->propertyCount, sizeof(FdtProperty));
+            if (ret < 0)
+                break;
+
+            property = &tree->properties[tree->propertyCount++];
+            property->name = (const char *)blob + strings_offset + name_offset;
+            property->value = blob + offset;
+            property->length = length;
+            node->propertyCount++;
+            if (length == 4 && (strcmp(property->name, "phandle") == 0 ||
+                                (strcmp(property->name, "linux,phandle") == 0 &&
+                                 node->phandle == 0)))
+                node->phandle = be32(property->value);
+            offset += (length + 3) & ~3U;
+            break;
+        }
+        case FDT_NOP:
+            break;
+        case FDT_END:
+            done = true;
+            break;
+        default:
+            ret = -EINVAL;
+            break;
+        }
+    }
+
+    if (ret == 0 && (depth != -1 || tree->nodeCount == 0))
+        ret = -EINVAL;
+    if (ret == 0)
+        ret = build_indexes(tree);
+    if (ret < 0)
+        fdt_close(tree); // Not mapped yet, only frees the arrays
+    return ret;
+}
+
+/**
+ * Map and parse a DTB file.
+ *
+ * @retval 0        Success.
+ * @retval -ENOENT  File not found.
+ * @retval -EIO     File could not be mapped.
+ * @retval <0       See fdt_parse().
+ */
+int fdt_open(FdtTree *tree, const char *path) {
+    struct stat info;
+    void *blob;
+    int fd = open(path, O_RDONLY);
+    int ret;
+
+    memset(tree, 0, sizeof(*tree));
+    if (fd < 0)
+        return -ENOENT;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return -EIO;
+    }
+    if (info.st_size < FDT_HEADER_SIZE) {
+        close(fd);
+        return -EINVAL;
+    }
+    blob = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (blob == MAP_FAILED)
+        return -EIO;
+
+    ret = fdt_parse(tree, blob, (size_t)info.st_size);
+    if (ret < 0) {
+        munmap(blob, (size_t)info.st_size);
+        memset(tree, 0, sizeof(*tree));
+        return ret;
+    }
+    tree->mapped = true;
+    return 0;
+}
+
+/**
+ * Release the indexes, and unmap the blob if fdt_open() mapped it.
+ */
+void fdt_close(FdtTree *tree) {
+    free(tree->nodes);
+    free(tree->properties);
+    free(tree->pathIndex);
+    free(tree->phandleIndex);
+    if (tree->mapped)
+        munmap((void *)tree->blob, tree->size);
+    memset(tree, 0, sizeof(*tree));
+}
+
+/**
+ * Write the full path of a node ("/soc/pcie@1c00000").
+ *
+ * @retval  Path length, the path is truncated if buffer is too small.
+ */
+size_t fdt_node_path(const FdtTree *tree, uint32_t node, char *buffer,
+                     size_t size) {
+    uint32_t chain[FDT_MAX_DEPTH];
+    uint32_t count = 0;
+    size_t length = 0;
+
+    if (size == 0)
+        return 0;
+    for (uint32_t i = node; i != FDT_NO_NODE && i != 0 && count < FDT_MAX_DEPTH;
+         i = tree->nodes[i].parent)
+        chain[count++] = i;
+
+    buffer[0] = '\0';
+    if (count == 0) {
+        if (size > 1)
+            memcpy(buffer, "/", 2);
+        return 1;
+    }
+    while (count > 0) {
+        const char *name = tree->nodes[chain[--count]].name;
+        size_t name_length = strlen(name);
+        if (length + 1 + name_length < size) {
+            buffer[length] = '/';
+            memcpy(buffer + length + 1, name, name_length + 1);
+        }
+        length += 1 + name_length;
+    }
+    return length;
+}
+
+/**
+ * Look a node up by full path, "/" is the root.
+ *
+ * @retval  Node index, FDT_NO_NODE if there is no such node.
+ */
+uint32_t fdt_find_path(const FdtTree *tree, const char *path) {
+    size_t length = strlen(path);
+    char candidate[FDT_MAX_PATH];
+    uint64_t hash;
+    uint32_t slot;
+
+    if (tree->pathIndexSize == 0 || length == 0 || path[0] != '/')
+        return FDT_NO_NODE;
+    while (length > 1 && path[length - 1] == '/')
+        length--;
+    hash = fnv_update(FNV_OFFSET, path, length);
+
+    slot = index_slot(hash, tree->pathIndexSize);
+    while (tree->pathIndex[slot] != FDT_NO_NODE) {
+        uint32_t node = tree->pathIndex[slot];
+        if (tree->nodes[node].pathHash == hash &&
+            fdt_node_path(tree, node, candidate, sizeof(candidate)) == length &&
+            strncmp(candidate, path, length) == 0)
+            return node;
+        slot = (slot + 1) & (tree->pathIndexSize - 1);
+    }
+    return FDT_NO_NODE;
+}
+
+/**
+ * Look a node up by phandle.
+ *
+ * @retval  Node index, FDT_NO_NODE if no node has this phandle.
+ */
+uint32_t fdt_find_phandle(const FdtTree *tree, uint32_t phandle) {
+    uint32_t slot;
+
+    if (tree->phandleIndexSize == 0 || phandle == 0)
+        return FDT_NO_NODE;
+    slot = index_slot(phandle, tree->phandleIndexSize);
+    while (tree->phandleIndex[slot] != FDT_NO_NODE) {
+        uint32_t node = tree->phandleIndex[slot];
+        if (tree->nodes[node].phandle == phandle)
+            return node;
+        slot = (slot + 1) & (tree->phandleIndexSize - 1);
+    }
+    return FDT_NO_NODE;
+}
+
+/**
+ * Find a property of a node by name.
+ *
+ * @retval  Property, NULL if the node does not have it.
+ */
+const FdtProperty *fdt_get_property(const FdtTree *tree, uint32_t node,
+                                    const char *name) {
+    const FdtNode *entry = &tree->nodes[node];
+
+    for (uint32_t i = 0; i < entry->propertyCount; i++) {
+        const FdtProperty *property =
+            &tree->properties[entry->firstProperty + i];
+        if (strcmp(property->name, name) == 0)
+            return property;
+    }
+    return NULL;
+}
+
+uint32_t fdt_property_cells(const FdtProperty *property) {
+    return property->length / 4;
+}
+
+/**
+ * Read one big endian cell, 0 past the end.
+ */
+uint32_t fdt_property_cell(const FdtProperty *property, uint32_t index) {
+    if (index >= property->length / 4)
+        return 0;
+    return be32(property->value + index * 4);
+}
+
+/**
+ * Whether the value is a list of printable strings, with the rules of dtc
+ * util_is_printable_string(): NUL terminated, no empty string, no CR/LF.
+ */
+bool fdt_property_is_string(const FdtProperty *property) {
+    uint32_t position = 0;
+
+    if (property->length == 0 || property->value[property->length - 1] != 0)
+        return false;
+    while (position < property->length) {
+        uint32_t start = position;
+        while (position < property->length && property->value[position] != 0) {
+            uint8_t c = property->value[position];
+            if (c == '\r' || c == '\n' ||
+                !((c >= 0x20 && c < 0x7F) || (c >= 0x09 && c <= 0x0C)))
+                return false;
+            position++;
+        }
+        if (position == start)
+            return false;
+        position++;
+    }
+    return true;
+}
+
+/**
+ * Whether one string of a string list property contains needle.
+ */
+bool fdt_property_has_string(const FdtProperty *property, const char *needle) {
+    uint32_t position = 0;
+
+    if (!fdt_property_is_string(property))
+        return false;
+    while (position < property->length) {
+        const char *text = (const char *)property->value + position;
+        if (strstr(text, needle) != NULL)
+            return true;
+        position += (uint32_t)strlen(text) + 1;
+    }
+    return false;
+}
@@ -0,0 +1,264 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "layout_manifest.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Writer of the per-device layout manifest (layout.json), see
+// include/layout_manifest.h. Tables and types are collected in two memory
+// streams and written out in one go by layout_write().
+//
+
+static const char *const layout_kind_names[] = {
+    [LAYOUT_UINT] = "uint",
+    [LAYOUT_CHARS] = "chars",
+    [LAYOUT_BYTES] = "bytes",
+    [LAYOUT_STRUCT] = "struct",
+};
+
+static void layout_fail(LayoutWriter *writer, int error) {
+    if (writer->error == 0)
+        writer->error = error;
+}
+
+/**
+ * Write size bytes of value as a JSON string, escaping what JSON needs.
+ */
+static void layout_string(FILE *stream, const char *value, size_t size) {
+    fputc('"', stream);
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = (unsigned char)value[i];
+        if (c == '"' || c == '\\')
+            fprintf(stream, "\\%c", c);
+        else if (c < 0x20 || c >= 0x7F)
+            fprintf(stream, "\\u%04x", c);
+        else
+            fputc(c, stream);
+    }
+    fputc('"', stream);
+}
+
+static int layout_find_type(const LayoutWriter *writer, const char *name) {
+    for (unsigned i = 0; i < writer->typeCount; i++) {
+        if (strcmp(writer->typeNames[i], name) == 0)
+            return (int)i;
+    }
+    return -1;
+}
+
+/**
+ * Start a manifest.
+ *
+ * @param device  <vendor>_<soc> the manifest describes.
+ *
+ * @retval  0 on success, -ENOMEM if the streams cannot be opened.
+ */
+int layout_open(LayoutWriter *writer, const char *device) {
+    memset(writer, 0, sizeof(*writer));
+    writer->device = device;
+    writer->tablesStream =
+        open_memstream(&writer->tablesText, &writer->tablesSize);
+    writer->typesStream =
+        open_memstream(&writer->typesText, &writer->typesSize);
+    if (writer->tablesStream == NULL || writer->typesStream == NULL) {
+        log_err("Failed to allocate the layout manifest of %s", device);
+        layout_close(writer);
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+/**
+ * Start the "tables" entry of a table, followed by its configuration
+ * macros and closed by layout_end_table().
+ *
+ * @param name           Key of the entry, the AML file name without .aml.
+ * @param signature      Signature characters, signatureSize of them.
+ * @param revision       Revision the table is built with.
+ * @param type           Top level structure of the table.
+ * @param size           sizeof() of that structure.
+ */
+void layout_begin_table(LayoutWriter *writer, const char *name,
+                        const char *signature, size_t signatureSize,
+                        unsigned revision, const char *type, size_t size) {
+    FILE *stream = writer->tablesStream;
+
+    fprintf(stream, "%s\n    ", writer->tableCount++ ? "," : "");
+    layout_string(stream, name, strlen(name));
+    fprintf(stream, ": {\"signature\": ");
+    layout_string(stream, signature, signatureSize);
+    fprintf(stream, ", \"revision\": %u, \"struct\": ", revision);
+    layout_string(stream, type, strlen(type));
+    fprintf(stream, ", \"size\": %zu,\n      \"config\": {", size);
+    writer->configCount = 0;
+}
+
+void layout_config(LayoutWriter *writer, const char *name,
+                   unsigned long long value) {
+    FILE *stream = writer->tablesStream;
+
+    fprintf(stream, "%s", writer->configCount++ ? ", " : "");
+    layout_string(stream, name, strlen(name));
+    fprintf(stream, ": %llu", value);
+}
+
+/**
+ * Character list configuration (ACPI_TABLE_HEADER_OEM_ID...), written as
+ * a string without the padding spaces.
+ */
+void layout_config_chars(LayoutWriter *writer, const char *name,
+                         const char *value, size_t size) {
+    FILE *stream = writer->tablesStream;
+
+    while (size > 0 && (value[size - 1] == ' ' || value[size - 1] == '\0'))
+        size--;
+    fprintf(stream, "%s", writer->configCount++ ? ", " : "");
+    layout_string(stream, name, strlen(name));
+    fprintf(stream, ": ");
+    layout_string(stream, value, size);
+}
+
+void layout_end_table(LayoutWriter *writer) {
+    fprintf(writer->tablesStream, "}}");
+}
+
+/**
+ * Add a type to "types". The fields must cover the type byte for byte in
+ * order, and the element types of LAYOUT_STRUCT fields must be added
+ * before. A type added twice must have the same layout both times, tables
+ * share the types of include/acpi.h.
+ *
+ * Errors are kept in writer->error and reported by layout_write().
+ */
+void layout_type(LayoutWriter *writer, const char *name, size_t size,
+                 const LayoutField *fields, size_t count) {
+    char *text = NULL;
+    size_t textSize = 0;
+    size_t offset = 0;
+    FILE *stream;
+    int found;
+
+    for (size_t i = 0; i < count; i++) {
+        const LayoutField *field = &fields[i];
+        if (field->offset != offset) {
+            log_err("%s.%s at offset %u, expected %zu: the layout misses a "
+                    "member",
+                    name, field->name, field->offset, offset);
+            layout_fail(writer, -EINVAL);
+            return;
+        }
+        if (field->kind == LAYOUT_STRUCT &&
+            layout_find_type(writer, field->type) < 0) {
+            log_err("%s.%s: type %s is not described before", name,
+                    field->name, field->type);
+            layout_fail(writer, -EINVAL);
+            return;
+        }
+        offset += field->size;
+    }
+    if (offset != size) {
+        log_err("%s layout covers %zu of %zu bytes", name, offset, size);
+        layout_fail(writer, -EINVAL);
+        return;
+    }
+
+    stream = open_memstream(&text, &textSize);
+    if (stream == NULL) {
+        layout_fail(writer, -ENOMEM);
+        return;
+    }
+    fprintf(stream, "{\"size\": %zu, \"fields\": [", size);
+    for (size_t i = 0; i < count; i++) {
+        const LayoutField *field = &fields[i];
+        fprintf(stream, "%s\n      {\"name\": ", i ? "," : "");
+        layout_string(stream, field->name, strlen(field->name));
+        fprintf(stream,
+                ", \"offset\": %u, \"size\": %u, \"count\": %u, \"kind\": "
+                "\"%s\"",
+                field->offset, field->size, field->count,
+                layout_kind_names[field->kind]);
+        if (field->kind == LAYOUT_STRUCT) {
+            fprintf(stream, ", \"type\": ");
+            layout_string(stream, field->type, strlen(field->type));
+        }
+        fprintf(stream, "}");
+    }
+    fprintf(stream, "]}");
+    fclose(stream);
+
+    found = layout_find_type(writer, name);
+    if (found >= 0) {
+        if (strcmp(writer->typeTexts[found], text) != 0) {
+            log_err("%s has two different layouts", name);
+            layout_fail(writer, -EINVAL);
+        }
+        free(text);
+        return;
+    }
+    if (writer->typeCount == LAYOUT_MAX_TYPES) {
+        log_err("More than %d types in the layout manifest", LAYOUT_MAX_TYPES);
+        layout_fail(writer, -ENOSPC);
+        free(text);
+        return;
+    }
+    writer->typeNames[writer->typeCount] = strdup(name);
+    writer->typeTexts[writer->typeCount] = text;
+    fprintf(writer->typesStream, "%s\n    ", writer->typeCount ? "," : "");
+    layout_string(writer->typesStream, name, strlen(name));
+    fprintf(writer->typesStream, ": %s", text);
+    writer->typeCount++;
+}
+
+/**
+ * Write the manifest to path.
+ *
+ * @retval  0 on success, the first error of the writer or -EIO.
+ */
+int layout_write(LayoutWriter *writer, const char *path) {
+    FILE *file;
+    int ret;
+
+    if (writer->error < 0)
+        return writer->error;
+    if (fflush(writer->tablesStream) != 0 || fflush(writer->typesStream) != 0)
+        return -ENOMEM;
+
+    file = fopen(path, "w");
+    if (file == NULL) {
+        log_err("Failed to open %s", path);
+        return -EIO;
+    }
+    fprintf(file, "{\n  \"device\": ");
+    layout_string(file, writer->device, strlen(writer->device));
+    fprintf(file, ",\n  \"tables\": {%s\n  },\n  \"types\": {%s\n  }\n}\n",
+            writer->tablesText, writer->typesText);
+    ret = ferror(file) ? -EIO : 0;
+    if (fclose(file) != 0)
+        ret = -EIO;
+    if (ret < 0)
+        log_err("Failed to write %s", path);
+    return ret;
+}
+
+void layout_close(LayoutWriter *writer) {
+    if (writer->tablesStream != NULL)
+        fclose(writer->tablesStream);
+    if (writer->typesStream != NULL)
+        fclose(writer->typesStream);
+    free(writer->tablesText);
+    free(writer->typesText);
+    for (unsigned i = 0; i < writer->typeCount; i++) {
+        free(writer->typeNames[i]);
+        free(writer->typeTexts[i]);
+    }
+    memset(writer, 0, sizeof(*writer));
+}
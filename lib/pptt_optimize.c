@@ -0,0 +1,516 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "pptt_optimize.h"
+#include "acpi_layout.h"
+#include "utils.h"
+#include <acpi.h>
+#include <common/pptt.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// PPTT re-emission, see include/pptt_optimize.h. Structures are collected
+// in table order, so references are resolved by binary search on their
+// offsets. Identical caches are found by sorting keys, caches whose next
+// level was just shared may become identical too, so this repeats until
+// nothing is shared anymore.
+//
+
+#define PPTT_OPT_NONE UINT32_MAX
+#define PPTT_OPT_MAX_CACHE 32 // Revision 3 caches are 28 bytes
+
+enum PPTT_OPT_KIND {
+    PPTT_OPT_OTHER = 0,
+    PPTT_OPT_PROCESSOR,
+    PPTT_OPT_CACHE,
+};
+
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+    uint8_t kind;         // enum PPTT_OPT_KIND
+    uint32_t parent;      // Processor: structure index or PPTT_OPT_NONE
+    uint32_t next;        // Cache: structure index or PPTT_OPT_NONE
+    uint32_t firstRef;    // Processor: first of its resources in refs
+    uint32_t refCount;    // Processor: NumberOfPrivateResources
+    uint32_t firstUser;   // Cache: first of its referencing nodes in users
+    uint32_t userCount;   // Cache: processor nodes referencing it
+    uint32_t rep;         // Cache: shared with this one if not itself
+    uint32_t nextMember;  // Cache: next cache shared with the same one
+    uint32_t lastMember;  // Cache representative: end of its member list
+    bool reachable;       // Cache: reached from a processor node
+    AcpiGenRef ref;
+} PpttOptStructure;
+
+typedef struct {
+    PpttOptStructure *structures;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *refs;  // Private resources of every node, structure indexes
+    uint32_t refCount;
+    uint32_t refCapacity;
+    uint32_t *users; // Referencing nodes of every cache
+} PpttOpt;
+
+typedef struct {
+    uint32_t index;
+    uint32_t next; // Representative of the next level, or PPTT_OPT_NONE
+    uint32_t length;
+    uint8_t bytes[PPTT_OPT_MAX_CACHE]; // NextLevelOfCache zeroed
+} PpttOptKey;
+
+// Grow an array on powers of two, before adding element count
+static int grow(void **array, uint32_t *capacity, uint32_t count,
+                size_t elementSize) {
+    void *grown;
+    uint32_t larger;
+
+    if (count < *capacity)
+        return 0;
+    larger = *capacity ? *capacity * 2 : 64;
+    grown = realloc(*array, larger * elementSize);
+    if (grown == NULL)
+        return -ENOMEM;
+    *array = grown;
+    *capacity = larger;
+    return 0;
+}
+
+static int collect(const uint8_t *table, const AcpiSubtable *subtable,
+                   void *data) {
+    PpttOpt *opt = data;
+    PpttOptStructure *entry;
+
+    if (grow((void **)&opt->structures, &opt->capacity, opt->count,
+             sizeof(*entry)) < 0)
+        return -ENOMEM;
+    entry = &opt->structures[opt->count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->offset = subtable->offset;
+    entry->length = subtable->length;
+    entry->parent = PPTT_OPT_NONE;
+    entry->next = PPTT_OPT_NONE;
+
+    if (subtable->layout == NULL)
+        return 0;
+    if (strcmp(subtable->layout->name, "PROCESSOR") == 0) {
+        const uint8_t *base = table + subtable->offset;
+        uint32_t count;
+
+        if (subtable->length < sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE))
+            return -EINVAL;
+        count = read_le32(base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE,
+                                         NumberOfPrivateResources));
+        if (count > (subtable->length -
+                     sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE)) /
+                        sizeof(ACPI_PPTT_PRIVATE_RESOURCE))
+            return -EINVAL;
+        entry->kind = PPTT_OPT_PROCESSOR;
+        entry->firstRef = opt->refCount;
+        entry->refCount = count;
+        // Table offsets for now, resolve() turns them into indexes
+        entry->parent = read_le32(
+            base, offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent));
+        for (uint32_t i = 0; i < count; i++) {
+            if (grow((void **)&opt->refs, &opt->refCapacity, opt->refCount,
+                     sizeof(*opt->refs)) < 0)
+                return -ENOMEM;
+            opt->refs[opt->refCount++] =
+                read_le32(base, sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +
+                                   i * sizeof(ACPI_PPTT_PRIVATE_RESOURCE));
+        }
+    } else if (strcmp(subtable->layout->name, "CACHE") == 0) {
+        if (subtable->length <
+            offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, NextLevelOfCache) +
+                sizeof(uint32_t))
+            return -EINVAL;
+        entry->kind = PPTT_OPT_CACHE;
+        entry->next = read_le32(table + subtable->offset,
+                                offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE,
+                                        NextLevelOfCache));
+    }
+    return 0;
+}
+
+/**
+ * Structure index of a table offset, 0 meaning none.
+ *
+ * @retval 0        index is set.
+ * @retval -EINVAL  The offset is not the start of a structure.
+ */
+static int resolve(const PpttOpt *opt, uint32_t offset, uint32_t *index) {
+    uint32_t low = 0, high = opt->count;
+
+    if (offset == 0) {
+        *index = PPTT_OPT_NONE;
+        return 0;
+    }
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (opt->structures[middle].offset < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == opt->count || opt->structures[low].offset != offset)
+        return -EINVAL;
+    *index = low;
+    return 0;
+}
+
+// Turn every reference into a structure index, and list cache users
+static int link_structures(PpttOpt *opt) {
+    uint32_t userCount = 0;
+    int ret;
+
+    for (uint32_t i = 0; i < opt->count; i++) {
+        PpttOptStructure *entry = &opt->structures[i];
+
+        if (entry->kind == PPTT_OPT_PROCESSOR) {
+            ret = resolve(opt, entry->parent, &entry->parent);
+            for (uint32_t r = 0; ret == 0 && r < entry->refCount; r++)
+                ret = resolve(opt, opt->refs[entry->firstRef + r],
+                              &opt->refs[entry->firstRef + r]);
+        } else if (entry->kind == PPTT_OPT_CACHE) {
+            ret = resolve(opt, entry->next, &entry->next);
+        } else {
+            ret = 0;
+        }
+        if (ret < 0)
+            return ret;
+        entry->rep = i;
+        entry->nextMember = PPTT_OPT_NONE;
+        entry->lastMember = i;
+    }
+
+    // Count the users of each cache, then fill them in
+    for (uint32_t r = 0; r < opt->refCount; r++) {
+        if (opt->refs[r] != PPTT_OPT_NONE &&
+            opt->structures[opt->refs[r]].kind == PPTT_OPT_CACHE)
+            opt->structures[opt->refs[r]].userCount++;
+    }
+    for (uint32_t i = 0; i < opt->count; i++) {
+        opt->structures[i].firstUser = userCount;
+        userCount += opt->structures[i].userCount;
+        opt->structures[i].userCount = 0;
+    }
+    opt->users = malloc((userCount ? userCount : 1) * sizeof(*opt->users));
+    if (opt->users == NULL)
+        return -ENOMEM;
+    for (uint32_t i = 0; i < opt->count; i++) {
+        const PpttOptStructure *node = &opt->structures[i];
+
+        if (node->kind != PPTT_OPT_PROCESSOR)
+            continue;
+        for (uint32_t r = 0; r < node->refCount; r++) {
+            PpttOptStructure *cache;
+
+            if (opt->refs[node->firstRef + r] == PPTT_OPT_NONE)
+                continue;
+            cache = &opt->structures[opt->refs[node->firstRef + r]];
+            if (cache->kind == PPTT_OPT_CACHE)
+                opt->users[cache->firstUser + cache->userCount++] = i;
+        }
+    }
+    return 0;
+}
+
+// Mark the caches reached from processor nodes and their next levels
+static void mark_reachable(PpttOpt *opt) {
+    for (uint32_t r = 0; r < opt->refCount; r++) {
+        uint32_t index = opt->refs[r];
+
+        while (index != PPTT_OPT_NONE &&
+               opt->structures[index].kind == PPTT_OPT_CACHE &&
+               !opt->structures[index].reachable) {
+            opt->structures[index].reachable = true;
+            index = opt->structures[index].next;
+        }
+    }
+}
+
+static uint32_t find_rep(PpttOpt *opt, uint32_t index) {
+    uint32_t root = index;
+
+    if (index == PPTT_OPT_NONE)
+        return index;
+    while (opt->structures[root].rep != root)
+        root = opt->structures[root].rep;
+    while (opt->structures[index].rep != root) {
+        uint32_t up = opt->structures[index].rep;
+        opt->structures[index].rep = root;
+        index = up;
+    }
+    return root;
+}
+
+static int compare_keys(const void *a, const void *b) {
+    const PpttOptKey *left = a, *right = b;
+    int order;
+
+    if (left->length != right->length)
+        return left->length < right->length ? -1 : 1;
+    if (left->next != right->next)
+        return left->next < right->next ? -1 : 1;
+    order = memcmp(left->bytes, right->bytes, left->length);
+    if (order != 0)
+        return order;
+    return left->index < right->index ? -1 : left->index > right->index;
+}
+
+static bool same_key(const PpttOptKey *a, const PpttOptKey *b) {
+    return a->length == b->length && a->next == b->next &&
+           memcmp(a->bytes, b->bytes, a->length) == 0;
+}
+
+// A node referencing a member of cache and one of into needs both
+static bool conflicts(PpttOpt *opt, uint32_t cache, uint32_t into) {
+    for (uint32_t member = cache; member != PPTT_OPT_NONE;
+         member = opt->structures[member].nextMember) {
+        const PpttOptStructure *entry = &opt->structures[member];
+
+        for (uint32_t u = 0; u < entry->userCount; u++) {
+            const PpttOptStructure *node =
+                &opt->structures[opt->users[entry->firstUser + u]];
+
+            for (uint32_t r = 0; r < node->refCount; r++) {
+                uint32_t other = opt->refs[node->firstRef + r];
+                if (other != PPTT_OPT_NONE &&
+                    opt->structures[other].kind == PPTT_OPT_CACHE &&
+                    find_rep(opt, other) == into)
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void share(PpttOpt *opt, uint32_t cache, uint32_t into) {
+    PpttOptStructure *root = &opt->structures[into];
+
+    opt->structures[cache].rep = into;
+    opt->structures[root->lastMember].nextMember = cache;
+    root->lastMember = opt->structures[cache].lastMember;
+}
+
+/**
+ * Share identical reachable caches until no more can be shared.
+ *
+ * @retval  Number of caches shared, or -ENOMEM.
+ */
+static int64_t share_caches(PpttOpt *opt, const uint8_t *table) {
+    PpttOptKey *keys = malloc((opt->count ? opt->count : 1) * sizeof(*keys));
+    int64_t shared = 0;
+    bool progress = true;
+
+    if (keys == NULL)
+        return -ENOMEM;
+    while (progress) {
+        uint32_t keyCount = 0;
+
+        progress = false;
+        for (uint32_t i = 0; i < opt->count; i++) {
+            const PpttOptStructure *entry = &opt->structures[i];
+            PpttOptKey *key;
+
+            if (entry->kind != PPTT_OPT_CACHE || !entry->reachable ||
+                entry->rep != i || entry->length > PPTT_OPT_MAX_CACHE)
+                continue;
+            key = &keys[keyCount++];
+            memset(key, 0, sizeof(*key));
+            key->index = i;
+            key->next = find_rep(opt, entry->next);
+            key->length = entry->length;
+            memcpy(key->bytes, table + entry->offset, entry->length);
+            memset(key->bytes + offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE,
+                                         NextLevelOfCache),
+                   0, sizeof(uint32_t));
+        }
+        qsort(keys, keyCount, sizeof(*keys), compare_keys);
+
+        for (uint32_t start = 0, end; start < keyCount; start = end) {
+            for (end = start + 1;
+                 end < keyCount && same_key(&keys[start], &keys[end]); end++)
+                ;
+            // Earlier caches of the run stay, later ones join the first
+            // one no node needs apart from them
+            for (uint32_t m = start + 1; m < end; m++) {
+                uint32_t cache = keys[m].index;
+
+                // A chain looping through itself is left alone
+                if (keys[m].next == cache)
+                    continue;
+                for (uint32_t r = start; r < m; r++) {
+                    uint32_t into = keys[r].index;
+
+                    if (opt->structures[into].rep != into ||
+                        keys[r].next == into || conflicts(opt, cache, into))
+                        continue;
+                    share(opt, cache, into);
+                    shared++;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+    }
+    free(keys);
+    return shared;
+}
+
+static bool kept(const PpttOptStructure *entry, uint32_t index) {
+    return entry->kind != PPTT_OPT_CACHE ||
+           (entry->reachable && entry->rep == index);
+}
+
+// Forward reference of what a structure index became
+static AcpiGenRef target(PpttOpt *opt, uint32_t index) {
+    if (index == PPTT_OPT_NONE)
+        return ACPIGEN_NO_REF;
+    if (opt->structures[index].kind == PPTT_OPT_CACHE)
+        index = find_rep(opt, index);
+    return opt->structures[index].ref;
+}
+
+static int emit(PpttOpt *opt, const uint8_t *pptt, AcpiArena *arena,
+                const uint8_t **table, size_t *length) {
+    const ACPI_TABLE_HEADER *header = (const ACPI_TABLE_HEADER *)pptt;
+    AcpiGen gen;
+    int ret;
+
+    ret = acpigen_begin(&gen, arena, header->Signature, header->Revision, 0);
+    if (ret < 0)
+        return ret;
+    // OEM and creator fields as built, Length and Checksum are redone
+    acpigen_write(&gen, 0, pptt, sizeof(*header));
+
+    for (uint32_t i = 0; i < opt->count; i++)
+        opt->structures[i].ref =
+            kept(&opt->structures[i], i) ? acpigen_forward(&gen)
+                                         : ACPIGEN_NO_REF;
+
+    for (uint32_t i = 0; i < opt->count; i++) {
+        const PpttOptStructure *entry = &opt->structures[i];
+        const uint8_t *base = pptt + entry->offset;
+        uint32_t offset = gen.length; // Where the structure is appended
+        AcpiGenRef ref;
+
+        if (!kept(entry, i))
+            continue;
+        if (entry->kind == PPTT_OPT_PROCESSOR) {
+            uint8_t node[UINT8_MAX];
+            size_t size = sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +
+                          entry->refCount * sizeof(ACPI_PPTT_PRIVATE_RESOURCE);
+
+            // Length fits in a byte, so do the resources it holds
+            memcpy(node, base, size);
+            node[offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Length)] =
+                (uint8_t)size;
+            ref = acpigen_append(&gen, node, size);
+            if (ref == ACPIGEN_NO_REF)
+                break;
+            acpigen_bind(&gen, entry->ref, ref);
+            acpigen_reference(
+                &gen,
+                offset + offsetof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE, Parent),
+                target(opt, entry->parent));
+            for (uint32_t r = 0; r < entry->refCount; r++)
+                acpigen_reference(
+                    &gen,
+                    offset + sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) +
+                        r * sizeof(ACPI_PPTT_PRIVATE_RESOURCE),
+                    target(opt, opt->refs[entry->firstRef + r]));
+        } else {
+            ref = acpigen_append(&gen, base, entry->length);
+            if (ref == ACPIGEN_NO_REF)
+                break;
+            acpigen_bind(&gen, entry->ref, ref);
+            if (entry->kind == PPTT_OPT_CACHE)
+                acpigen_reference(
+                    &gen,
+                    offset + offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE,
+                                 NextLevelOfCache),
+                    target(opt, entry->next));
+        }
+    }
+    return acpigen_finalize(&gen, table, length);
+}
+
+/**
+ * Re-emit a PPTT with shared caches and packed private resources.
+ *
+ * @param pptt    Built PPTT.
+ * @param size    Its size.
+ * @param arena   Arena holding the optimized table.
+ * @param table   Set to the optimized table, valid until the arena is reset.
+ * @param length  Set to its length.
+ * @param stats   Sizes and what was saved, may be NULL.
+ * @retval 0        Success.
+ * @retval -EINVAL  Not a PPTT, a malformed subtable stream or a reference
+ *                  that is not the start of a structure.
+ * @retval -ENOMEM  Out of memory.
+ */
+int pptt_optimize(const uint8_t *pptt, size_t size, AcpiArena *arena,
+                  const uint8_t **table, size_t *length,
+                  PpttOptimizeStats *stats) {
+    PpttOpt opt = {0};
+    PpttOptimizeStats counts = {0};
+    int64_t shared;
+    int ret;
+
+    *table = NULL;
+    *length = 0;
+    if (size < sizeof(ACPI_TABLE_HEADER) || memcmp(pptt, "PPTT", 4) != 0 ||
+        read_le32(pptt, offsetof(ACPI_TABLE_HEADER, Length)) != size)
+        return -EINVAL;
+
+    ret = acpi_layout_walk(pptt, size, acpi_layout_find("PPTT"), collect,
+                           &opt);
+    if (ret == 0)
+        ret = link_structures(&opt);
+    if (ret < 0)
+        goto out;
+    mark_reachable(&opt);
+    shared = share_caches(&opt, pptt);
+    if (shared < 0) {
+        ret = (int)shared;
+        goto out;
+    }
+
+    counts.sizeBefore = (uint32_t)size;
+    counts.sharedCaches = (uint32_t)shared;
+    for (uint32_t i = 0; i < opt.count; i++) {
+        const PpttOptStructure *entry = &opt.structures[i];
+
+        if (entry->kind == PPTT_OPT_PROCESSOR) {
+            counts.packedBytes +=
+                entry->length - sizeof(ACPI_PPTT_PROCESSOR_HIERARCHY_NODE) -
+                entry->refCount * sizeof(ACPI_PPTT_PRIVATE_RESOURCE);
+        } else if (entry->kind == PPTT_OPT_CACHE) {
+            counts.cachesBefore++;
+            if (!entry->reachable)
+                counts.unreachableCaches++;
+            else if (entry->rep == i)
+                counts.cachesAfter++;
+        }
+    }
+
+    ret = emit(&opt, pptt, arena, table, length);
+    counts.sizeAfter = (uint32_t)*length;
+    if (stats != NULL && ret == 0)
+        *stats = counts;
+
+out:
+    free(opt.structures);
+    free(opt.refs);
+    free(opt.users);
+    return ret;
+}
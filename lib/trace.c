@@ -0,0 +1,130 @@
+/** @file
+ *
+ *  Copyright (c) 2025-2026 The Project Aloha authors. All rights reserved.
+ *
+ *  MIT License
+ *
+ */
+
+#include "trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+//
+// Pipeline stage spans, one JSON object per line appended to the file
+// named by $ACPI_TRACE_FILE. Every tool of the build writes to the same
+// file, tools/trace_merge.py turns it into a Chrome trace.
+//
+
+#define TRACE_MAX_LINE 1024
+#define TRACE_MAX_FIELD 128
+
+/**
+ * Tracing is enabled when $ACPI_TRACE_FILE is set and not empty.
+ */
+bool trace_enabled(void) {
+    const char *path = getenv(TRACE_FILE_ENV);
+    return path != NULL && path[0] != '\0';
+}
+
+uint64_t trace_now_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+void trace_begin(TraceSpan *span) {
+    span->startUs = trace_enabled() ? trace_now_us() : 0;
+    span->endUs = span->startUs;
+}
+
+void trace_end(TraceSpan *span) {
+    span->endUs = trace_enabled() ? trace_now_us() : span->startUs;
+}
+
+/**
+ * Copy a field into out, dropping the characters JSON would need escaped.
+ */
+static const char *trace_field(const char *value, char *out) {
+    size_t used = 0;
+
+    for (; value != NULL && *value && used + 1 < TRACE_MAX_FIELD; value++) {
+        if (*value != '"' && *value != '\\' && (unsigned char)*value >= 0x20)
+            out[used++] = *value;
+    }
+    out[used] = '\0';
+    return out;
+}
+
+/**
+ * Append a closed span to the trace file. Tools usually write their spans
+ * once the table signature is known, after the last stage.
+ *
+ * The line is written with one write() on an O_APPEND descriptor, so
+ * concurrent tools of a parallel build do not interleave their lines.
+ *
+ * @param tool    Name of the writing tool, e.g. "acpi_extractor".
+ * @param device  <vendor>_<soc> the stage works on, may be NULL.
+ * @param table   Table signature, may be NULL.
+ * @param stage   Stage name, e.g. "read", "scan", "write".
+ * @param bytes   Bytes processed by the stage, 0 if not meaningful.
+ *
+ * @retval  0 on success or with tracing disabled, negative errno on failure.
+ */
+int trace_write(const TraceSpan *span, const char *tool, const char *device,
+                const char *table, const char *stage, uint64_t bytes) {
+    char fields[4][TRACE_MAX_FIELD];
+    char line[TRACE_MAX_LINE];
+    const char *path = getenv(TRACE_FILE_ENV);
+    ssize_t written;
+    int length;
+    int fd;
+
+    if (path == NULL || path[0] == '\0')
+        return 0;
+
+    length = snprintf(line, sizeof(line),
+                      "{\"tool\":\"%s\",\"device\":\"%s\",\"table\":\"%s\","
+                      "\"stage\":\"%s\",\"start_us\":%llu,\"dur_us\":%llu,"
+                      "\"bytes\":%llu,\"pid\":%d}\n",
+                      trace_field(tool, fields[0]),
+                      trace_field(device, fields[1]),
+                      trace_field(table, fields[2]),
+                      trace_field(stage, fields[3]),
+                      (unsigned long long)span->startUs,
+                      (unsigned long long)(span->endUs - span->startUs),
+                      (unsigned long long)bytes, (int)getpid());
+    if (length < 0 || (size_t)length >= sizeof(line))
+        return -EINVAL;
+
+    fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -EIO;
+    written = write(fd, line, (size_t)length);
+    close(fd);
+    return written == length ? 0 : -EIO;
+}
+
+/**
+ * Device of a build tree path: the name of its parent directory, so
+ * <build>/qcom_sm8550/PPTT.aml gives qcom_sm8550.
+ *
+ * @retval  buffer, empty if path has no parent directory.
+ */
+const char *trace_device_of(const char *path, char *buffer, size_t size) {
+    const char *end = strrchr(path, '/');
+    const char *start = end;
+
+    buffer[0] = '\0';
+    if (end == NULL || size == 0)
+        return buffer;
+    while (start > path && start[-1] != '/')
+        start--;
+    snprintf(buffer, size, "%.*s", (int)(end - start), start);
+    return buffer;
+}
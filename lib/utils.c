@@ -8,8 +8,12 @@
  */
 
 #include "utils.h"
+#include <common.h>
+#include <dirent.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 
 /**
  * Get file size based on given fileContent.
@@ -79,6 +83,27 @@ bool is_directory(const char *path) {
     return S_ISDIR(st.st_mode);
 }
 
+/**
+ * Read a little-endian field of a table, at any alignment.
+ *
+ * @param base      Start of the table or structure.
+ * @param offset    Byte offset of the field.
+ * @retval          Field value.
+ */
+uint16_t read_le16(const uint8_t *base, size_t offset) {
+    return (uint16_t)(base[offset] | base[offset + 1] << 8);
+}
+
+uint32_t read_le32(const uint8_t *base, size_t offset) {
+    return (uint32_t)read_le16(base, offset) |
+           (uint32_t)read_le16(base, offset + 2) << 16;
+}
+
+uint64_t read_le64(const uint8_t *base, size_t offset) {
+    return (uint64_t)read_le32(base, offset) |
+           (uint64_t)read_le32(base, offset + 4) << 32;
+}
+
 /**
  * Calculate checksum for given buffer.
  *
@@ -93,3 +118,301 @@ uint8_t checksum(uint8_t *buffer, size_t length) {
     return (uint8_t)(0 - chs);
 }
 
+
+/**
+ * Check whether a table carries the standard ACPI header checksum.
+ *
+ * FACS and FBPT only have a signature and a length, byte 9 belongs to
+ * the table body and must not be overwritten.
+ *
+ * @param signature 4 bytes table signature.
+ *
+ */
+bool table_has_checksum(const char *signature) {
+    if (memcmp(signature, "FACS", 4) == 0 || memcmp(signature, "FBPT", 4) == 0)
+        return false;
+    return true;
+}
+
+static int compare_file_path(const void *a, const void *b) {
+    return strcmp(((const FileContent *)a)->filePath,
+                  ((const FileContent *)b)->filePath);
+}
+
+/**
+ * Read every *.aml table of a directory, sorted by file name.
+ *
+ * Each table is checked to be at least 8 bytes long and its Length field
+ * (offset 4 for every table, FACS included) to match the file size.
+ *
+ * @param dir       Directory to scan (e.g. build/qcom_sm8850).
+ * @param tables    Set to an array of tables, free with free_table_directory.
+ * @param count     Set to number of tables read.
+ * @retval 0        Success, at least one table read.
+ * @retval -ENOENT  Directory can not be opened or holds no table.
+ * @retval -EINVAL  A table is malformed.
+ * @retval -ENOMEM  Out of memory.
+ * @retval -EIO     A table can not be read.
+ */
+int read_table_directory(const char *dir, FileContent **tables,
+                         size_t *count) {
+    DIR *pDir = opendir(dir);
+    struct dirent *entry;
+    size_t capacity = 0;
+    int ret = 0;
+
+    *tables = NULL;
+    *count = 0;
+    if (pDir == NULL)
+        return -ENOENT;
+
+    while ((entry = readdir(pDir)) != NULL) {
+        size_t name_len = strlen(entry->d_name);
+        if (name_len < 5 || strcmp(entry->d_name + name_len - 4, ".aml") != 0)
+            continue;
+
+        if (*count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 16;
+            FileContent *grown =
+                realloc(*tables, new_capacity * sizeof(FileContent));
+            if (grown == NULL) {
+                ret = -ENOMEM;
+                break;
+            }
+            *tables = grown;
+            capacity = new_capacity;
+        }
+
+        FileContent *table = &(*tables)[*count];
+        size_t path_len = strlen(dir) + name_len + 2;
+        char *path = malloc(path_len);
+        memset(table, 0, sizeof(*table));
+        if (path == NULL) {
+            ret = -ENOMEM;
+            break;
+        }
+        snprintf(path, path_len, "%s/%s", dir, entry->d_name);
+        table->filePath = path;
+        (*count)++;
+
+        if (get_file_size(table) < 8) {
+            ret = -EINVAL;
+            break;
+        }
+        table->fileBuffer = malloc(table->fileSize);
+        if (table->fileBuffer == NULL) {
+            ret = -ENOMEM;
+            break;
+        }
+        if (read_file_content(table) == NULL) {
+            ret = -EIO;
+            break;
+        }
+        uint32_t length;
+        memcpy(&length, table->fileBuffer + 4, sizeof(length));
+        if (length != table->fileSize) {
+            printf("Error: %s length %u does not match file size %zu\n", path,
+                   length, table->fileSize);
+            ret = -EINVAL;
+            break;
+        }
+    }
+    closedir(pDir);
+
+    if (ret == 0 && *count == 0)
+        ret = -ENOENT;
+    if (ret < 0) {
+        free_table_directory(*tables, *count);
+        *tables = NULL;
+        *count = 0;
+        return ret;
+    }
+    qsort(*tables, *count, sizeof(FileContent), compare_file_path);
+    return 0;
+}
+
+/**
+ * Free tables returned by read_table_directory.
+ */
+void free_table_directory(FileContent *tables, size_t count) {
+    if (tables == NULL)
+        return;
+    for (size_t i = 0; i < count; i++) {
+        free(tables[i].fileBuffer);
+        free((char *)tables[i].filePath);
+    }
+    free(tables);
+}
+
+/**
+ * Milliseconds elapsed since start, taken with CLOCK_MONOTONIC.
+ */
+double elapsed_ms(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 +
+           (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/**
+ * qsort() comparator for an array of C strings.
+ */
+int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static size_t list_entries(const char *dir, const char *suffix,
+                           bool devices, char ***names) {
+    DIR *pDir = opendir(dir);
+    struct dirent *entry;
+    char **list = NULL;
+    size_t count = 0;
+
+    *names = NULL;
+    if (pDir == NULL)
+        return 0;
+    while ((entry = readdir(pDir)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        char **grown;
+
+        if (entry->d_name[0] == '.')
+            continue;
+        if (suffix != NULL &&
+            (length <= strlen(suffix) ||
+             strcmp(entry->d_name + length - strlen(suffix), suffix) != 0))
+            continue;
+        if (devices) {
+            size_t path_len = strlen(dir) + length + 2;
+            char *path = malloc(path_len);
+            bool keep;
+
+            if (path == NULL)
+                break;
+            snprintf(path, path_len, "%s/%s", dir, entry->d_name);
+            keep = strcmp(entry->d_name, "CMakeFiles") != 0 &&
+                   is_directory(path);
+            free(path);
+            if (!keep)
+                continue;
+        }
+        grown = realloc(list, (count + 1) * sizeof(*list));
+        if (grown == NULL)
+            break;
+        list = grown;
+        list[count] = strdup(entry->d_name);
+        if (list[count] != NULL)
+            count++;
+    }
+    closedir(pDir);
+    qsort(list, count, sizeof(*list), compare_names);
+    *names = list;
+    return count;
+}
+
+/**
+ * List the entries of a directory, sorted as CMake's file(GLOB) does.
+ *
+ * @param dir       Directory to scan.
+ * @param suffix    Keep only names ending with it, NULL to keep all.
+ * @param names     Set to the names, free with free_names.
+ * @retval          Number of names, 0 if the directory can not be opened.
+ */
+size_t list_names(const char *dir, const char *suffix, char ***names) {
+    return list_entries(dir, suffix, false, names);
+}
+
+/**
+ * List the device directories of a build tree, sorted, skipping CMake
+ * internals (CMakeFiles, hidden entries).
+ *
+ * @param build_dir Build directory (e.g. build).
+ * @param names     Set to the device names, free with free_names.
+ * @retval          Number of devices.
+ */
+size_t list_devices(const char *build_dir, char ***names) {
+    return list_entries(build_dir, NULL, true, names);
+}
+
+/**
+ * Free names returned by list_names or list_devices.
+ */
+void free_names(char **names, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        free(names[i]);
+    free(names);
+}
+
+/**
+ * Locate a table wrapped in start/end magic inside a compiled binary.
+ *
+ * The last start magic and the last end magic after it are used, so
+ * strings holding the magic earlier in the binary do not confuse the scan.
+ *
+ * @param buffer    Binary content (object file, static library, ...).
+ * @param size      Binary size.
+ * @param offset    Set to the table offset in buffer.
+ * @param length    Set to the size between both magics.
+ * @retval 0        Success.
+ * @retval -ENOENT  Start or end magic not found.
+ */
+int locate_table_in_binary(const uint8_t *buffer, size_t size,
+                           size_t *offset, size_t *length) {
+    const char start_magic[] = {ACPI_TABLE_START_MAGIC};
+    const char end_magic[] = {ACPI_TABLE_END_MAGIC};
+    size_t start = 0;
+    size_t end = 0;
+
+    if (size <= sizeof(start_magic))
+        return -ENOENT;
+
+    for (size_t i = 0; i < size - sizeof(start_magic); i++) {
+        if (memcmp(buffer + i, start_magic, sizeof(start_magic)) == 0)
+            start = i + sizeof(start_magic);
+    }
+    if (start == 0)
+        return -ENOENT;
+
+    for (size_t i = start; i < size - sizeof(end_magic); i++) {
+        if (memcmp(buffer + i, end_magic, sizeof(end_magic)) == 0)
+            end = i;
+    }
+    if (end == 0)
+        return -ENOENT;
+
+    *offset = start;
+    *length = end - start;
+    return 0;
+}
+
+/**
+ * Locate the table in a Qualcomm TZ/hypervisor image (tz.mbn, hyp.mbn).
+ *
+ * The image carries no start/end magic, the table is found by its OEM
+ * table ID "2KDEMOCQ" at offset 0x10 of the ACPI header. The last
+ * occurrence wins, like locate_table_in_binary().
+ *
+ * @param buffer    Image content.
+ * @param size      Image size.
+ * @param offset    Set to the table header offset in buffer.
+ * @retval 0        Success.
+ * @retval -ENOENT  Magic not found.
+ */
+int locate_qcom_table_in_binary(const uint8_t *buffer, size_t size,
+                                size_t *offset) {
+    const char table_start_magic[] = {'2', 'K', 'D', 'E', 'M', 'O', 'C', 'Q'};
+    size_t start = 0;
+
+    if (size <= 0x10 + sizeof(table_start_magic))
+        return -ENOENT;
+
+    for (size_t i = 0x10; i < size - sizeof(table_start_magic); i++) {
+        if (memcmp(buffer + i, table_start_magic,
+                   sizeof(table_start_magic)) == 0)
+            start = i - 0x10; // Adjust to table header start
+    }
+    if (start == 0)
+        return -ENOENT;
+
+    *offset = start;
+    return 0;
+}
@@ -0,0 +1,441 @@
+/* Create, list and extract multi-device ACPI table bundles */
+#include "bundle.h"
+#include "sha256.h"
+#include "utils.h"
+#include <acpi.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef ACPI_BUNDLE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define ALIGN_UP(x, a) (((x) + ((a) - 1)) & ~((uint64_t)(a) - 1))
+
+typedef struct {
+  char device[ACPI_BUNDLE_DEVICE_NAME_SIZE];
+  char signature[4];
+  FileContent file;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  uint32_t blob_index;
+} BundleInput;
+
+typedef struct {
+  BundleInput *owner; // First input with this content
+  uint8_t *payload;   // Points at owner data or at compressed buffer
+  uint32_t stored_size;
+  uint8_t compression;
+  uint64_t offset;
+} BundleBlob;
+
+static void usage(const char *name) {
+  log_warn("Usage: %s create [-z] <build_dir> <output_bundle>", name);
+  log_warn("       %s list <bundle>", name);
+  log_warn("       %s extract <bundle> <device> <signature> <output_aml>",
+           name);
+}
+
+static int compare_inputs(const void *a, const void *b) {
+  const BundleInput *ia = a;
+  const BundleInput *ib = b;
+  int ret = strncmp(ia->device, ib->device, ACPI_BUNDLE_DEVICE_NAME_SIZE);
+  if (ret != 0)
+    return ret;
+  return memcmp(ia->signature, ib->signature, sizeof(ia->signature));
+}
+
+/**
+ * Load every AML file found in <build_dir>/<device>/ as a bundle input.
+ *
+ * @retval 0        Success.
+ * @retval -ENOENT  build_dir can not be opened.
+ * @retval -EINVAL  A table is malformed or a device name is too long.
+ * @retval -ENOMEM  Out of memory.
+ */
+static int collect_inputs(const char *build_dir, BundleInput **inputs,
+                          size_t *count) {
+  DIR *root = opendir(build_dir);
+  struct dirent *device_entry;
+  size_t capacity = 0;
+  int ret = 0;
+
+  *inputs = NULL;
+  *count = 0;
+  if (root == NULL) {
+    log_err("Failed to open directory %s", build_dir);
+    return -ENOENT;
+  }
+
+  while (ret == 0 && (device_entry = readdir(root)) != NULL) {
+    char device_path[4096];
+    struct dirent *table_entry;
+    DIR *device_dir;
+
+    if (device_entry->d_name[0] == '.')
+      continue;
+    snprintf(device_path, sizeof(device_path), "%s/%s", build_dir,
+             device_entry->d_name);
+    if (!is_directory(device_path))
+      continue;
+    device_dir = opendir(device_path);
+    if (device_dir == NULL)
+      continue;
+
+    while ((table_entry = readdir(device_dir)) != NULL) {
+      size_t name_len = strlen(table_entry->d_name);
+      if (name_len < 5 ||
+          strcmp(table_entry->d_name + name_len - 4, ".aml") != 0)
+        continue;
+
+      if (strlen(device_entry->d_name) >= ACPI_BUNDLE_DEVICE_NAME_SIZE) {
+        log_err("Device name %s is longer than %d characters",
+                device_entry->d_name, ACPI_BUNDLE_DEVICE_NAME_SIZE - 1);
+        ret = -EINVAL;
+        break;
+      }
+
+      if (*count == capacity) {
+        size_t new_capacity = capacity ? capacity * 2 : 32;
+        BundleInput *grown =
+            realloc(*inputs, new_capacity * sizeof(BundleInput));
+        if (!grown) {
+          ret = -ENOMEM;
+          break;
+        }
+        *inputs = grown;
+        capacity = new_capacity;
+      }
+
+      BundleInput *input = &(*inputs)[*count];
+      size_t path_len = strlen(device_path) + name_len + 2;
+      char *path = malloc(path_len);
+      memset(input, 0, sizeof(*input));
+      if (!path) {
+        ret = -ENOMEM;
+        break;
+      }
+      snprintf(path, path_len, "%s/%s", device_path, table_entry->d_name);
+      input->file.filePath = path;
+
+      if (!get_file_size(&input->file) || input->file.fileSize < 8) {
+        log_err("Table %s is too small", path);
+        free(path);
+        ret = -EINVAL;
+        break;
+      }
+      input->file.fileBuffer = malloc(input->file.fileSize);
+      if (!input->file.fileBuffer || !read_file_content(&input->file)) {
+        log_err("Failed to read %s", path);
+        free(input->file.fileBuffer);
+        free(path);
+        ret = -EIO;
+        break;
+      }
+      if (((ACPI_TABLE_HEADER *)input->file.fileBuffer)->Length !=
+          input->file.fileSize) {
+        log_err("Table %s length does not match file size", path);
+        free(input->file.fileBuffer);
+        free(path);
+        ret = -EINVAL;
+        break;
+      }
+
+      memcpy(input->device, device_entry->d_name,
+             strlen(device_entry->d_name) + 1);
+      memcpy(input->signature, input->file.fileBuffer, 4);
+      sha256(input->file.fileBuffer, input->file.fileSize, input->digest);
+      (*count)++;
+    }
+    closedir(device_dir);
+  }
+  closedir(root);
+
+  if (ret == 0 && *count == 0) {
+    log_err("No table found under %s", build_dir);
+    ret = -ENOENT;
+  }
+  return ret;
+}
+
+/**
+ * Try to deflate a blob, keep it only when it gets smaller.
+ */
+static int compress_blob(BundleBlob *blob) {
+#ifdef ACPI_BUNDLE_HAVE_ZLIB
+  uLongf length = compressBound(blob->owner->file.fileSize);
+  uint8_t *buffer = malloc(length);
+  if (!buffer)
+    return -ENOMEM;
+  if (compress2(buffer, &length, blob->owner->file.fileBuffer,
+                blob->owner->file.fileSize, Z_BEST_COMPRESSION) != Z_OK) {
+    free(buffer);
+    return -EIO;
+  }
+  if (length >= blob->owner->file.fileSize) {
+    free(buffer);
+    return 0;
+  }
+  blob->payload = buffer;
+  blob->stored_size = length;
+  blob->compression = ACPI_BUNDLE_COMPRESSION_DEFLATE;
+  return 0;
+#else
+  (void)blob;
+  log_err("Compression requested but acpi_bundle was built without zlib");
+  return -EINVAL;
+#endif
+}
+
+static int bundle_create(const char *build_dir, const char *output_path,
+                         bool compress) {
+  BundleInput *inputs = NULL;
+  BundleBlob *blobs = NULL;
+  size_t input_count = 0;
+  size_t blob_count = 0;
+  size_t raw_size = 0;
+  uint64_t offset = 0;
+  FileContent output = {0};
+  int ret = 0;
+
+  ret = collect_inputs(build_dir, &inputs, &input_count);
+  if (ret < 0)
+    goto cleanup;
+  qsort(inputs, input_count, sizeof(BundleInput), compare_inputs);
+
+  // Deduplicate by content hash
+  blobs = calloc(input_count, sizeof(BundleBlob));
+  if (!blobs) {
+    ret = -ENOMEM;
+    goto cleanup;
+  }
+  for (size_t i = 0; i < input_count; i++) {
+    size_t b;
+    raw_size += inputs[i].file.fileSize;
+    if (i > 0 && compare_inputs(&inputs[i - 1], &inputs[i]) == 0) {
+      log_err("Duplicate table %.4s for %s", inputs[i].signature,
+              inputs[i].device);
+      ret = -EINVAL;
+      goto cleanup;
+    }
+    for (b = 0; b < blob_count; b++) {
+      if (memcmp(blobs[b].owner->digest, inputs[i].digest,
+                 SHA256_DIGEST_SIZE) == 0)
+        break;
+    }
+    if (b == blob_count) {
+      blobs[b].owner = &inputs[i];
+      blobs[b].payload = inputs[i].file.fileBuffer;
+      blobs[b].stored_size = inputs[i].file.fileSize;
+      blobs[b].compression = ACPI_BUNDLE_COMPRESSION_NONE;
+      if (compress) {
+        ret = compress_blob(&blobs[b]);
+        if (ret < 0)
+          goto cleanup;
+      }
+      blob_count++;
+    }
+    inputs[i].blob_index = b;
+  }
+
+  // Layout: header, index, blob entries, 8 bytes aligned payloads
+  offset = sizeof(ACPI_BUNDLE_HEADER);
+  uint64_t index_offset = ALIGN_UP(offset, ACPI_BUNDLE_ALIGNMENT);
+  offset = index_offset + input_count * sizeof(ACPI_BUNDLE_INDEX_ENTRY);
+  uint64_t blob_offset = ALIGN_UP(offset, ACPI_BUNDLE_ALIGNMENT);
+  offset = blob_offset + blob_count * sizeof(ACPI_BUNDLE_BLOB_ENTRY);
+  for (size_t b = 0; b < blob_count; b++) {
+    blobs[b].offset = ALIGN_UP(offset, ACPI_BUNDLE_ALIGNMENT);
+    offset = blobs[b].offset + blobs[b].stored_size;
+  }
+
+  output.filePath = output_path;
+  output.fileSize = offset;
+  output.fileBuffer = calloc(1, output.fileSize);
+  if (!output.fileBuffer) {
+    ret = -ENOMEM;
+    goto cleanup;
+  }
+
+  ACPI_BUNDLE_HEADER *header = (ACPI_BUNDLE_HEADER *)output.fileBuffer;
+  const char magic[] = {ACPI_BUNDLE_MAGIC};
+  memcpy(header->Magic, magic, sizeof(header->Magic));
+  header->Version = ACPI_BUNDLE_VERSION;
+  header->EntryCount = input_count;
+  header->BlobCount = blob_count;
+  header->IndexOffset = index_offset;
+  header->BlobOffset = blob_offset;
+  header->TotalSize = output.fileSize;
+
+  ACPI_BUNDLE_INDEX_ENTRY *index =
+      (ACPI_BUNDLE_INDEX_ENTRY *)(output.fileBuffer + index_offset);
+  for (size_t i = 0; i < input_count; i++) {
+    memcpy(index[i].Device, inputs[i].device, sizeof(index[i].Device));
+    memcpy(index[i].Signature, inputs[i].signature,
+           sizeof(index[i].Signature));
+    index[i].BlobIndex = inputs[i].blob_index;
+  }
+
+  ACPI_BUNDLE_BLOB_ENTRY *entries =
+      (ACPI_BUNDLE_BLOB_ENTRY *)(output.fileBuffer + blob_offset);
+  for (size_t b = 0; b < blob_count; b++) {
+    entries[b].Offset = blobs[b].offset;
+    entries[b].StoredSize = blobs[b].stored_size;
+    entries[b].Size = blobs[b].owner->file.fileSize;
+    entries[b].Compression = blobs[b].compression;
+    memcpy(entries[b].Sha256, blobs[b].owner->digest, SHA256_DIGEST_SIZE);
+    memcpy(output.fileBuffer + blobs[b].offset, blobs[b].payload,
+           blobs[b].stored_size);
+  }
+
+  ret = write_file_content(&output);
+  if (ret < 0) {
+    log_err("Failed to write bundle to %s", output_path);
+    goto cleanup;
+  }
+
+  log_info("Bundle written to :\t%s", output_path);
+  log_info("%zu tables, %zu unique, %zu -> %zu bytes", input_count,
+           blob_count, raw_size, output.fileSize);
+
+cleanup:
+  if (blobs) {
+    for (size_t b = 0; b < blob_count; b++) {
+      if (blobs[b].compression != ACPI_BUNDLE_COMPRESSION_NONE)
+        free(blobs[b].payload);
+    }
+  }
+  for (size_t i = 0; i < input_count; i++) {
+    free(inputs[i].file.fileBuffer);
+    free((char *)inputs[i].file.filePath);
+  }
+  free(blobs);
+  free(inputs);
+  free(output.fileBuffer);
+  return ret;
+}
+
+/**
+ * Read and validate a bundle file.
+ */
+static int bundle_load(const char *path, FileContent *file,
+                       AcpiBundle *bundle) {
+  file->filePath = path;
+  if (!get_file_size(file)) {
+    log_err("Failed to get file size for %s", path);
+    return -EINVAL;
+  }
+  file->fileBuffer = malloc(file->fileSize);
+  if (!file->fileBuffer || !read_file_content(file)) {
+    log_err("Failed to read %s", path);
+    return -EIO;
+  }
+  if (bundle_open(bundle, file->fileBuffer, file->fileSize) < 0) {
+    log_err("%s is not a valid bundle", path);
+    return -EINVAL;
+  }
+  return 0;
+}
+
+static int bundle_list(const char *path) {
+  FileContent file = {0};
+  AcpiBundle bundle;
+  int ret = bundle_load(path, &file, &bundle);
+  if (ret < 0)
+    goto cleanup;
+
+  log_info("Bundle %s: %u tables, %u unique blobs, %zu bytes", path,
+           bundle.header->EntryCount, bundle.header->BlobCount, bundle.size);
+  printf("%-32s %-4s %8s %8s %-7s %5s %s\n", "DEVICE", "SIG", "SIZE",
+         "STORED", "COMP", "BLOB", "SHA256");
+  for (uint32_t i = 0; i < bundle.header->EntryCount; i++) {
+    const ACPI_BUNDLE_INDEX_ENTRY *entry = &bundle.index[i];
+    const ACPI_BUNDLE_BLOB_ENTRY *blob = bundle_entry_blob(&bundle, entry);
+    char hex[SHA256_DIGEST_SIZE * 2 + 1];
+    sha256_to_hex(blob->Sha256, hex);
+    printf("%-32.32s %-4.4s %8u %8u %-7s %5u %.16s\n", entry->Device,
+           entry->Signature, blob->Size, blob->StoredSize,
+           blob->Compression == ACPI_BUNDLE_COMPRESSION_DEFLATE ? "deflate"
+                                                                 : "none",
+           entry->BlobIndex, hex);
+  }
+
+cleanup:
+  free(file.fileBuffer);
+  return ret;
+}
+
+static int bundle_extract(const char *path, const char *device,
+                          const char *signature, const char *output_path) {
+  FileContent file = {0};
+  FileContent output = {0};
+  AcpiBundle bundle;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  int ret = 0;
+
+  if (strlen(signature) != 4) {
+    log_err("Signature must be 4 characters: %s", signature);
+    return -EINVAL;
+  }
+  ret = bundle_load(path, &file, &bundle);
+  if (ret < 0)
+    goto cleanup;
+
+  const ACPI_BUNDLE_INDEX_ENTRY *entry =
+      bundle_find(&bundle, device, signature);
+  if (!entry) {
+    log_err("%s %s not found in %s", device, signature, path);
+    ret = -ENOENT;
+    goto cleanup;
+  }
+  const ACPI_BUNDLE_BLOB_ENTRY *blob = bundle_entry_blob(&bundle, entry);
+
+  output.filePath = output_path;
+  output.fileSize = blob->Size;
+  output.fileBuffer = malloc(output.fileSize);
+  if (!output.fileBuffer) {
+    ret = -ENOMEM;
+    goto cleanup;
+  }
+  ret = bundle_read_blob(&bundle, blob, output.fileBuffer, output.fileSize);
+  if (ret < 0) {
+    log_err("Failed to read %s %s from bundle", device, signature);
+    goto cleanup;
+  }
+  sha256(output.fileBuffer, output.fileSize, digest);
+  if (memcmp(digest, blob->Sha256, SHA256_DIGEST_SIZE) != 0) {
+    log_err("SHA-256 mismatch for %s %s", device, signature);
+    ret = -EIO;
+    goto cleanup;
+  }
+
+  ret = write_file_content(&output);
+  if (ret < 0) {
+    log_err("Failed to write table to %s", output_path);
+    goto cleanup;
+  }
+  log_info("Table extracted to :\t%s", output_path);
+
+cleanup:
+  free(output.fileBuffer);
+  free(file.fileBuffer);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 2 && strcmp(argv[1], "create") == 0) {
+    bool compress = argc == 5 && strcmp(argv[2], "-z") == 0;
+    if (argc != 4 && !compress) {
+      usage(argv[0]);
+      return -EINVAL;
+    }
+    return bundle_create(argv[argc - 2], argv[argc - 1], compress);
+  }
+  if (argc == 3 && strcmp(argv[1], "list") == 0)
+    return bundle_list(argv[2]);
+  if (argc == 6 && strcmp(argv[1], "extract") == 0)
+    return bundle_extract(argv[2], argv[3], argv[4], argv[5]);
+
+  usage(argv[0]);
+  return -EINVAL;
+}
@@ -0,0 +1,504 @@
+/* Field level difference between the tables of two builds */
+#include "acpi_layout.h"
+#include "sha256.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Usage
+
+  acpi_diff [-q] <old_build> <new_build>
+
+  Tables of every <build>/<device>/ are paired by device and signature.
+  Identical tables (same SHA-256) are skipped, the others are compared field
+  by field with the layouts of lib/acpi_layout.c:
+
+    ~ qcom_sm8850 APIC (MADT.aml)
+        OemRevision: 0x8850 -> 0x8851
+        GICC[3].MPIDR: 0x300 -> 0x10300
+        GICC[8]: only in new
+    + qcom_sm8850 IORT (IORT.aml): only in new
+
+  Subtables are paired by structure name and index, the same addressing as
+  acpi_patch. Bytes not covered by a field (private resources, tables
+  without layout) are shown as byte ranges. Checksum changes are not
+  reported unless nothing else differs. -q only prints the summary.
+
+  Returns 0 if both builds hold the same tables, 1 if they differ, a
+  negative errno on failure.
+*/
+
+#define DIFF_MAX_NAME 256
+#define DIFF_MAX_RANGE_BYTES 8 // Bytes printed per differing range
+#define DIFF_MAX_RANGES 16     // Ranges printed per table
+
+typedef struct {
+  char signature[5];
+  const FileContent *file;
+} DiffTable;
+
+typedef struct {
+  AcpiSubtable *items;
+  size_t count;
+} SubtableList;
+
+typedef struct {
+  bool quiet;
+  size_t compared;
+  size_t identical;
+  size_t changed;
+  size_t added;
+  size_t removed;
+} DiffStats;
+
+static int compare_signatures(const void *a, const void *b) {
+  const DiffTable *left = a;
+  const DiffTable *right = b;
+  int ret = strcmp(left->signature, right->signature);
+  return ret != 0 ? ret : strcmp(left->file->filePath, right->file->filePath);
+}
+
+/**
+ * Load the tables of one device, sorted by signature.
+ *
+ * A missing directory or one without tables gives an empty list.
+ *
+ * @retval 0        Success.
+ * @retval -EINVAL  A table is truncated or its length does not match.
+ * @retval -ENOMEM  Out of memory.
+ */
+static int load_device(const char *build_dir, const char *device,
+                       FileContent **files, size_t *fileCount,
+                       DiffTable **tables) {
+  char dir[DIFF_MAX_NAME * 2];
+  int ret;
+
+  *tables = NULL;
+  snprintf(dir, sizeof(dir), "%s/%s", build_dir, device);
+  ret = read_table_directory(dir, files, fileCount);
+  if (ret == -ENOENT)
+    return 0;
+  if (ret < 0) {
+    log_err("Failed to read tables of %s (%d)", dir, ret);
+    return ret;
+  }
+
+  *tables = calloc(*fileCount, sizeof(**tables));
+  if (*tables == NULL) {
+    free_table_directory(*files, *fileCount);
+    *files = NULL;
+    *fileCount = 0;
+    return -ENOMEM;
+  }
+  for (size_t i = 0; i < *fileCount; i++) {
+    memcpy((*tables)[i].signature, (*files)[i].fileBuffer, 4);
+    (*tables)[i].file = &(*files)[i];
+  }
+  qsort(*tables, *fileCount, sizeof(**tables), compare_signatures);
+  return 0;
+}
+
+static const char *file_name(const FileContent *file) {
+  const char *name = strrchr(file->filePath, '/');
+  return name != NULL ? name + 1 : file->filePath;
+}
+
+static void format_field(char *text, size_t size, const uint8_t *base,
+                         const AcpiFieldDescriptor *field) {
+  if (field->kind == ACPI_FIELD_UINT) {
+    snprintf(text, size, "0x%llX",
+             (unsigned long long)acpi_field_read(base, field));
+  } else if (field->kind == ACPI_FIELD_CHARS) {
+    size_t used = snprintf(text, size, "\"");
+    for (uint32_t i = 0; i < field->size && used + 3 < size; i++) {
+      char c = (char)base[field->offset + i];
+      text[used++] = (c >= 0x20 && c < 0x7F) ? c : '.';
+    }
+    snprintf(text + used, size - used, "\"");
+  } else {
+    size_t used = 0;
+    text[0] = '\0';
+    for (uint32_t i = 0; i < field->size && used + 4 < size; i++)
+      used += snprintf(text + used, size - used, i ? " %02X" : "%02X",
+                       base[field->offset + i]);
+  }
+}
+
+static void print_bytes(const uint8_t *data, size_t start, size_t end) {
+  for (size_t i = start; i < end && i < start + DIFF_MAX_RANGE_BYTES; i++)
+    printf(i == start ? "%02X" : " %02X", data[i]);
+  if (end - start > DIFF_MAX_RANGE_BYTES)
+    printf(" ...");
+  if (end == start)
+    printf("(none)");
+}
+
+/**
+ * Print the ranges where old[start..oldEnd) and new[start..newEnd) differ.
+ *
+ * Offsets are printed relative to origin, prefixed by path.
+ *
+ * @retval  Number of ranges printed.
+ */
+static size_t diff_bytes(const char *path, const uint8_t *old_data,
+                         size_t old_end, const uint8_t *new_data,
+                         size_t new_end, size_t start, size_t origin,
+                         size_t *budget) {
+  size_t common = old_end < new_end ? old_end : new_end;
+  size_t printed = 0;
+  size_t i = start;
+
+  while (i < common && *budget > 0) {
+    size_t end;
+
+    if (old_data[i] == new_data[i]) {
+      i++;
+      continue;
+    }
+    end = i;
+    while (end < common && old_data[end] != new_data[end])
+      end++;
+    printf("    %s+0x%zX..0x%zX: ", path, i - origin, end - 1 - origin);
+    print_bytes(old_data, i, end);
+    printf(" -> ");
+    print_bytes(new_data, i, end);
+    printf("\n");
+    (*budget)--;
+    printed++;
+    i = end;
+  }
+
+  if (old_end != new_end && *budget > 0) {
+    printf("    %s+0x%zX: ", path, common - origin);
+    print_bytes(old_data, common, old_end);
+    printf(" -> ");
+    print_bytes(new_data, common, new_end);
+    printf(" (%zu -> %zu bytes)\n", old_end - origin, new_end - origin);
+    (*budget)--;
+    printed++;
+  }
+  if (*budget == 0 && printed > 0)
+    printf("    %s: more differences not shown\n", path);
+  return printed;
+}
+
+/**
+ * Print the fields that differ between two instances of a structure.
+ *
+ * Fields past the end of one instance are shown as absent.
+ *
+ * @retval  Number of fields printed.
+ */
+static size_t diff_fields(const char *path, const AcpiFieldDescriptor *fields,
+                          size_t count, const uint8_t *old_base,
+                          size_t old_length, const uint8_t *new_base,
+                          size_t new_length) {
+  size_t printed = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const AcpiFieldDescriptor *field = &fields[i];
+    size_t end = (size_t)field->offset + field->size;
+    bool in_old = end <= old_length;
+    bool in_new = end <= new_length;
+    char old_text[128] = "absent";
+    char new_text[128] = "absent";
+
+    if (strcmp(field->name, "Checksum") == 0)
+      continue;
+    if (!in_old && !in_new)
+      continue;
+    if (in_old && in_new &&
+        memcmp(old_base + field->offset, new_base + field->offset,
+               field->size) == 0)
+      continue;
+
+    if (in_old)
+      format_field(old_text, sizeof(old_text), old_base, field);
+    if (in_new)
+      format_field(new_text, sizeof(new_text), new_base, field);
+    printf("    %s%s%s: %s -> %s\n", path, *path ? "." : "", field->name,
+           old_text, new_text);
+    printed++;
+  }
+  return printed;
+}
+
+static size_t fields_end(const AcpiFieldDescriptor *fields, size_t count,
+                         size_t start) {
+  size_t end = start;
+  for (size_t i = 0; i < count; i++)
+    if ((size_t)fields[i].offset + fields[i].size > end)
+      end = (size_t)fields[i].offset + fields[i].size;
+  return end;
+}
+
+static int collect_subtable(const uint8_t *table, const AcpiSubtable *subtable,
+                            void *context) {
+  SubtableList *list = context;
+  AcpiSubtable *grown;
+
+  (void)table;
+  grown = realloc(list->items, (list->count + 1) * sizeof(*list->items));
+  if (grown == NULL)
+    return -ENOMEM;
+  list->items = grown;
+  list->items[list->count] = *subtable;
+  // Subtables of unknown type are numbered among those of the same type
+  if (subtable->layout == NULL) {
+    list->items[list->count].index = 0;
+    for (size_t i = 0; i < list->count; i++)
+      if (list->items[i].layout == NULL &&
+          list->items[i].type == subtable->type)
+        list->items[list->count].index++;
+  }
+  list->count++;
+  return 0;
+}
+
+static bool same_slot(const AcpiSubtable *a, const AcpiSubtable *b) {
+  if (a->layout != NULL || b->layout != NULL)
+    return a->layout == b->layout && a->index == b->index;
+  return a->type == b->type && a->index == b->index;
+}
+
+static void subtable_path(char *path, size_t size,
+                          const AcpiSubtable *subtable) {
+  if (subtable->layout != NULL)
+    snprintf(path, size, "%s[%u]", subtable->layout->name, subtable->index);
+  else
+    snprintf(path, size, "TYPE_0x%X[%u]", (unsigned)subtable->type,
+             subtable->index);
+}
+
+/**
+ * Compare the subtable streams of two tables, slot by slot.
+ *
+ * @retval  Number of differences printed.
+ */
+static size_t diff_subtables(const SubtableList *old_list,
+                             const SubtableList *new_list,
+                             const uint8_t *old_table,
+                             const uint8_t *new_table, size_t *budget) {
+  size_t printed = 0;
+
+  for (size_t i = 0; i < old_list->count; i++) {
+    const AcpiSubtable *old_sub = &old_list->items[i];
+    const AcpiSubtable *new_sub = NULL;
+    const uint8_t *old_base = old_table + old_sub->offset;
+    const uint8_t *new_base;
+    char path[DIFF_MAX_NAME];
+    size_t covered = 0;
+
+    for (size_t j = 0; j < new_list->count && new_sub == NULL; j++)
+      if (same_slot(old_sub, &new_list->items[j]))
+        new_sub = &new_list->items[j];
+
+    subtable_path(path, sizeof(path), old_sub);
+    if (new_sub == NULL) {
+      printf("    %s: only in old\n", path);
+      printed++;
+      continue;
+    }
+    new_base = new_table + new_sub->offset;
+    if (old_sub->length == new_sub->length &&
+        memcmp(old_base, new_base, old_sub->length) == 0)
+      continue;
+
+    if (old_sub->layout != NULL) {
+      printed += diff_fields(path, old_sub->layout->fields,
+                             old_sub->layout->fieldCount, old_base,
+                             old_sub->length, new_base, new_sub->length);
+      covered = fields_end(old_sub->layout->fields,
+                           old_sub->layout->fieldCount, 0);
+    }
+    printed += diff_bytes(path, old_base, old_sub->length, new_base,
+                          new_sub->length, covered, 0, budget);
+  }
+
+  for (size_t j = 0; j < new_list->count; j++) {
+    bool paired = false;
+    char path[DIFF_MAX_NAME];
+
+    for (size_t i = 0; i < old_list->count && !paired; i++)
+      paired = same_slot(&old_list->items[i], &new_list->items[j]);
+    if (paired)
+      continue;
+    subtable_path(path, sizeof(path), &new_list->items[j]);
+    printf("    %s: only in new\n", path);
+    printed++;
+  }
+  return printed;
+}
+
+/**
+ * Print the field level differences of two tables with the same signature.
+ *
+ * Falls back to a byte diff of the whole table when there is no layout, the
+ * subtable stream is malformed, or no field explains the difference.
+ */
+static void diff_table(const char *signature, const FileContent *old_file,
+                       const FileContent *new_file) {
+  const AcpiTableLayout *layout = acpi_layout_find(signature);
+  const uint8_t *old_table = old_file->fileBuffer;
+  const uint8_t *new_table = new_file->fileBuffer;
+  SubtableList old_list = {0};
+  SubtableList new_list = {0};
+  size_t budget = DIFF_MAX_RANGES;
+  size_t printed = 0;
+
+  if (layout != NULL) {
+    if (layout->hasHeader)
+      printed += diff_fields("", acpi_header_fields, acpi_header_field_count,
+                             old_table, old_file->fileSize, new_table,
+                             new_file->fileSize);
+    printed += diff_fields("", layout->fields, layout->fieldCount, old_table,
+                           old_file->fileSize, new_table, new_file->fileSize);
+
+    if (layout->structureCount > 0 &&
+        acpi_layout_walk(old_table, old_file->fileSize, layout,
+                         collect_subtable, &old_list) == 0 &&
+        acpi_layout_walk(new_table, new_file->fileSize, layout,
+                         collect_subtable, &new_list) == 0)
+      printed += diff_subtables(&old_list, &new_list, old_table, new_table,
+                                &budget);
+    else if (layout->structureCount > 0)
+      printed = 0; // Let the byte diff show the broken stream
+    free(old_list.items);
+    free(new_list.items);
+  }
+
+  if (printed == 0)
+    diff_bytes(signature, old_table, old_file->fileSize, new_table,
+               new_file->fileSize, 0, 0, &budget);
+}
+
+/**
+ * Compare the tables of one device in both builds.
+ *
+ * @retval 0   Success, stats are updated.
+ * @retval <0  A table could not be loaded.
+ */
+static int diff_device(const char *old_build, const char *new_build,
+                       const char *device, DiffStats *stats) {
+  FileContent *old_files = NULL, *new_files = NULL;
+  size_t old_count = 0, new_count = 0;
+  DiffTable *old_tables = NULL, *new_tables = NULL;
+  size_t i = 0, j = 0;
+  int ret;
+
+  ret = load_device(old_build, device, &old_files, &old_count, &old_tables);
+  if (ret == 0)
+    ret = load_device(new_build, device, &new_files, &new_count, &new_tables);
+
+  while (ret == 0 && (i < old_count || j < new_count)) {
+    int order;
+
+    if (i == old_count)
+      order = 1;
+    else if (j == new_count)
+      order = -1;
+    else
+      order = strcmp(old_tables[i].signature, new_tables[j].signature);
+
+    if (order < 0) {
+      stats->removed++;
+      if (!stats->quiet)
+        printf("- %s %s (%s): only in old\n", device, old_tables[i].signature,
+               file_name(old_tables[i].file));
+      i++;
+    } else if (order > 0) {
+      stats->added++;
+      if (!stats->quiet)
+        printf("+ %s %s (%s): only in new\n", device, new_tables[j].signature,
+               file_name(new_tables[j].file));
+      j++;
+    } else {
+      const FileContent *old_file = old_tables[i].file;
+      const FileContent *new_file = new_tables[j].file;
+      uint8_t old_digest[SHA256_DIGEST_SIZE];
+      uint8_t new_digest[SHA256_DIGEST_SIZE];
+
+      stats->compared++;
+      sha256(old_file->fileBuffer, old_file->fileSize, old_digest);
+      sha256(new_file->fileBuffer, new_file->fileSize, new_digest);
+      if (old_file->fileSize == new_file->fileSize &&
+          memcmp(old_digest, new_digest, sizeof(old_digest)) == 0) {
+        stats->identical++;
+      } else {
+        stats->changed++;
+        if (!stats->quiet) {
+          printf("~ %s %s (%s)\n", device, old_tables[i].signature,
+                 file_name(new_file));
+          diff_table(old_tables[i].signature, old_file, new_file);
+        }
+      }
+      i++;
+      j++;
+    }
+  }
+
+  free(old_tables);
+  free(new_tables);
+  free_table_directory(old_files, old_count);
+  free_table_directory(new_files, new_count);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  DiffStats stats = {0};
+  char **old_devices = NULL, **new_devices = NULL;
+  size_t old_count, new_count, i = 0, j = 0;
+  struct timespec start;
+  int arg = 1;
+  int ret = 0;
+
+  if (argc > 1 && strcmp(argv[1], "-q") == 0) {
+    stats.quiet = true;
+    arg++;
+  }
+  if (argc - arg != 2) {
+    log_warn("Usage: %s [-q] <old_build> <new_build>", argv[0]);
+    return -EINVAL;
+  }
+  for (int k = arg; k < argc; k++) {
+    if (!is_directory(argv[k])) {
+      log_err("%s is not a directory", argv[k]);
+      return -ENOENT;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  old_count = list_devices(argv[arg], &old_devices);
+  new_count = list_devices(argv[arg + 1], &new_devices);
+
+  // Both device lists are sorted, tables of a device only on one side are
+  // reported as added or removed
+  while (ret == 0 && (i < old_count || j < new_count)) {
+    const char *device;
+
+    if (i == old_count)
+      device = new_devices[j++];
+    else if (j == new_count)
+      device = old_devices[i++];
+    else {
+      int order = strcmp(old_devices[i], new_devices[j]);
+      device = order <= 0 ? old_devices[i] : new_devices[j];
+      i += order <= 0;
+      j += order >= 0;
+    }
+    ret = diff_device(argv[arg], argv[arg + 1], device, &stats);
+  }
+
+  free_names(old_devices, old_count);
+  free_names(new_devices, new_count);
+  if (ret < 0)
+    return ret;
+
+  printf("%zu tables compared: %zu identical, %zu changed, %zu only in old, "
+         "%zu only in new (%.1f ms)\n",
+         stats.compared, stats.identical, stats.changed, stats.removed,
+         stats.added, elapsed_ms(&start));
+  return (stats.changed || stats.added || stats.removed) ? 1 : 0;
+}
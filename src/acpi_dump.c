@@ -0,0 +1,82 @@
+/* Disassemble built tables natively in the iasl data table format */
+#include "acpi_dump.h"
+#include "trace.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Usage
+
+  acpi_dump <table.aml> [output.dsl]
+
+  Writes the DSL text to output.dsl, or to stdout when no output is given.
+  The text reads like "iasl -d" output, so the DSL parsing tests also run on
+  hosts without iasl.
+*/
+
+int main(int argc, char **argv) {
+  FileContent table = {0};
+  const char *name = NULL;
+  FILE *out = stdout;
+  TraceSpan span;
+  char device[64];
+  char signature[5] = {0};
+  int ret = 0;
+
+  if (argc != 2 && argc != 3) {
+    log_warn("Usage: %s <table.aml> [output.dsl]", argv[0]);
+    return -EINVAL;
+  }
+
+  trace_begin(&span);
+  table.filePath = argv[1];
+  if (!get_file_size(&table)) {
+    log_err("Failed to get file size for %s", table.filePath);
+    return -EINVAL;
+  }
+  table.fileBuffer = malloc(table.fileSize);
+  if (table.fileBuffer == NULL) {
+    log_err("Failed to allocate %zu bytes for %s", table.fileSize,
+            table.filePath);
+    return -ENOMEM;
+  }
+  if (read_file_content(&table) == NULL) {
+    free(table.fileBuffer);
+    log_err("Failed to read %s", table.filePath);
+    return -EIO;
+  }
+
+  if (table.fileSize >= 4 && !acpi_dump_supported((char *)table.fileBuffer))
+    log_warn("No field layout for %.4s, dumping header and raw data only",
+             (char *)table.fileBuffer);
+
+  if (argc == 3) {
+    out = fopen(argv[2], "w");
+    if (out == NULL) {
+      free(table.fileBuffer);
+      log_err("Failed to open %s", argv[2]);
+      return -EIO;
+    }
+  }
+
+  name = strrchr(table.filePath, '/');
+  name = name != NULL ? name + 1 : table.filePath;
+  ret = acpi_dump_table(out, table.fileBuffer, table.fileSize, name);
+  if (ret < 0)
+    log_err("%s is too short to be an ACPI table", table.filePath);
+
+  if (out != stdout && fclose(out) != 0 && ret == 0) {
+    log_err("Failed to write %s", argv[2]);
+    ret = -EIO;
+  }
+  trace_end(&span);
+  if (ret == 0) {
+    memcpy(signature, table.fileBuffer, 4);
+    trace_device_of(table.filePath, device, sizeof(device));
+    trace_write(&span, "acpi_dump", device, signature, "disassemble",
+                table.fileSize);
+  }
+  free(table.fileBuffer);
+  return ret;
+}
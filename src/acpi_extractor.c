@@ -1,19 +1,24 @@
 /* Locate magic and extract table from compiled binaries */
+#include "trace.h"
 #include "utils.h"
 #include <acpi.h>
 #include <common.h>
+#include <common/fpdt.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 int main(int argc, char **argv) {
   uint32_t table_size = 0;
-  uint32_t table_start_offset = 0;
-  uint32_t table_end_offset = 0;
+  size_t table_offset = 0;
+  size_t wrapped_size = 0;
   ACPI_TABLE_HEADER *table_header = NULL;
   char *output_file_path = NULL;
   FileContent output_table = {0};
   FileContent input_binary = {0};
+  TraceSpan read_span, scan_span, write_span;
+  char device[64];
+  char signature[5];
 
   int ret = 0;
 
@@ -31,61 +36,38 @@ int main(int argc, char **argv) {
     log_err("Failed to get file size for %s", input_binary.filePath);
     return -EINVAL;
   }
+  trace_begin(&read_span);
   input_binary.fileBuffer = malloc(input_binary.fileSize);
   read_file_content(&input_binary);
+  trace_end(&read_span);
 
   // Locate magic in input binary
-  char table_start_magic[] = {ACPI_TABLE_START_MAGIC};
-  char table_end_magic[] = {ACPI_TABLE_END_MAGIC};
-
-  // Get offset of table start
-  for (size_t i = 0; i < input_binary.fileSize - sizeof(table_start_magic);
-       i++) {
-    if (memcmp(input_binary.fileBuffer + i, table_start_magic,
-               sizeof(table_start_magic)) == 0) {
-      table_start_offset = i + sizeof(table_start_magic);
-    }
-  }
-
-  // Check if table found
-  if (table_start_offset == 0) {
-    free(input_binary.fileBuffer);
-    log_err("Table start magic not found in %s", input_binary.filePath);
-    return -ENOENT;
-  }
-
-  // Get offset of table end
-  for (size_t i = table_start_offset;
-       i < input_binary.fileSize - sizeof(table_end_magic); i++) {
-    if (memcmp(input_binary.fileBuffer + i, table_end_magic,
-               sizeof(table_end_magic)) == 0) {
-      table_end_offset = i;
-    }
-  }
-
-  // Check if table end found
-  if (table_end_offset == 0) {
+  trace_begin(&scan_span);
+  ret = locate_table_in_binary(input_binary.fileBuffer, input_binary.fileSize,
+                               &table_offset, &wrapped_size);
+  if (ret < 0) {
     free(input_binary.fileBuffer);
-    log_err("Table end magic not found in %s", input_binary.filePath);
-    return -ENOENT;
+    log_err("Table magic not found in %s", input_binary.filePath);
+    return ret;
   }
+  trace_end(&scan_span);
 
   // Map header
   table_header =
-      (ACPI_TABLE_HEADER *)(input_binary.fileBuffer + table_start_offset);
+      (ACPI_TABLE_HEADER *)(input_binary.fileBuffer + table_offset);
 
   // Calulate and validate table size
   table_size = table_header->Length;
-  if (table_size != table_end_offset - table_start_offset) {
+  if (table_size != wrapped_size) {
     printf(
-        "[WARN] Table size mismatch: table size in header %u, actual size %u\n",
-        table_size, table_end_offset - table_start_offset);
+        "[WARN] Table size mismatch: table size in header %u, actual size %zu\n",
+        table_size, wrapped_size);
   }
 
   // Calculate and correct checksum if needed
-  if (memcmp(table_header->Signature, "FACS", 4) != 0)
+  if (table_has_checksum(table_header->Signature))
     table_header->Checksum =
-        checksum(input_binary.fileBuffer + table_start_offset, table_size);
+        checksum(input_binary.fileBuffer + table_offset, table_size);
 
   // Check if output file string does not exist
   if (argc == 2) {
@@ -130,7 +112,8 @@ int main(int argc, char **argv) {
   // Write table to output file
   output_table.fileSize = table_size;
   output_table.fileBuffer = malloc(output_table.fileSize);
-  memcpy(output_table.fileBuffer, input_binary.fileBuffer + table_start_offset,
+  trace_begin(&write_span);
+  memcpy(output_table.fileBuffer, input_binary.fileBuffer + table_offset,
          output_table.fileSize);
   ret = write_file_content(&output_table);
   if (ret < 0) {
@@ -141,12 +124,33 @@ int main(int argc, char **argv) {
       free(output_file_path);
     return ret;
   }
+  trace_end(&write_span);
+
+  // Stage spans, the device is the directory of the output table
+  memcpy(signature, table_header->Signature, 4);
+  signature[4] = '\0';
+  trace_device_of(output_table.filePath, device, sizeof(device));
+  trace_write(&read_span, "acpi_extractor", device, signature, "read",
+              input_binary.fileSize);
+  trace_write(&scan_span, "acpi_extractor", device, signature, "scan",
+              input_binary.fileSize);
+  trace_write(&write_span, "acpi_extractor", device, signature, "write",
+              output_table.fileSize);
 
   // Success
   log_info("Table %c%c%c%c extracted to :\t%s", table_header->Signature[0],
            table_header->Signature[1], table_header->Signature[2],
            table_header->Signature[3], output_table.filePath);
 
+  // Report fields firmware is expected to patch in place
+  if (memcmp(table_header->Signature, "FPDT", 4) == 0)
+    log_info("Patch offset FPDT.FBPTPointer:\t0x%zx (8 bytes)",
+             (size_t)FPDT_FBPT_POINTER_OFFSET);
+  else if (memcmp(table_header->Signature, "FBPT", 4) == 0)
+    log_info("Patch offset FBPT.BasicBootPerformanceData:\t0x%zx (%zu bytes)",
+             (size_t)FBPT_BASIC_BOOT_PERFORMANCE_DATA_OFFSET,
+             sizeof(FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD));
+
   // Clean up
   free(input_binary.fileBuffer);
   free(output_table.fileBuffer);
@@ -0,0 +1,387 @@
+/* Link all tables of a device into one image laid out at final addresses */
+#include "utils.h"
+#include <acpi.h>
+#include <common.h>
+#include <common/facp.h>
+#include <common/fpdt.h>
+#include <common/rsdp.h>
+#include <common/xsdt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINK_MAX_TABLES 64
+#define LINK_TABLE_ALIGNMENT 8
+#define LINK_FACS_ALIGNMENT 64 // FACS must be aligned on a 64 bytes boundary
+#define LINK_PAGE_SIZE 4096    // Granule of the UEFI memory map
+
+#define ALIGN_UP(x, a) (((x) + ((a) - 1)) & ~((uint64_t)(a) - 1))
+
+/**
+ * Memory type firmware must publish a table in.
+ *
+ * FACS is written by OSPM and firmware at run time and must be ACPI NVS,
+ * FBPT is updated by firmware after ExitBootServices() and must be
+ * reserved memory. Everything else can be reclaimed once tables are read.
+ */
+typedef enum {
+  LINK_MEMORY_RECLAIM = 0,
+  LINK_MEMORY_RESERVED,
+  LINK_MEMORY_NVS,
+} LinkMemoryType;
+
+static const char *const link_memory_names[] = {
+    [LINK_MEMORY_RECLAIM] = "ACPI reclaim (EfiACPIReclaimMemory)",
+    [LINK_MEMORY_RESERVED] = "reserved (EfiReservedMemoryType)",
+    [LINK_MEMORY_NVS] = "ACPI NVS (EfiACPIMemoryNVS)",
+};
+
+typedef struct {
+  char signature[5];
+  FileContent *file;
+  uint64_t offset; // Offset from image base
+} LinkTable;
+
+typedef struct {
+  LinkMemoryType type;
+  uint64_t offset; // From image base, on a page
+  uint64_t size;
+} LinkRegion;
+
+/**
+ * Order tables in the image and in XSDT.
+ *
+ * FACP goes first as OSPM expects, tables which are not listed in XSDT
+ * (DSDT, FBPT, FACS) go last. FBPT and FACS end the image in their own
+ * regions, see link_table_memory().
+ */
+static int link_table_rank(const char *signature) {
+  if (memcmp(signature, "FACP", 4) == 0)
+    return 0;
+  if (memcmp(signature, "DSDT", 4) == 0)
+    return 2;
+  if (memcmp(signature, "FBPT", 4) == 0)
+    return 3;
+  if (memcmp(signature, "FACS", 4) == 0)
+    return 4;
+  return 1;
+}
+
+static int compare_link_tables(const void *a, const void *b) {
+  const LinkTable *ta = a;
+  const LinkTable *tb = b;
+  int ra = link_table_rank(ta->signature);
+  int rb = link_table_rank(tb->signature);
+  if (ra != rb)
+    return ra - rb;
+  return memcmp(ta->signature, tb->signature, 4);
+}
+
+static LinkMemoryType link_table_memory(const char *signature) {
+  if (memcmp(signature, "FACS", 4) == 0)
+    return LINK_MEMORY_NVS;
+  if (memcmp(signature, "FBPT", 4) == 0)
+    return LINK_MEMORY_RESERVED;
+  return LINK_MEMORY_RECLAIM;
+}
+
+static bool table_in_xsdt(const char *signature) {
+  return link_table_rank(signature) <= 1;
+}
+
+static LinkTable *find_link_table(LinkTable *tables, size_t count,
+                                  const char *signature) {
+  for (size_t i = 0; i < count; i++) {
+    if (memcmp(tables[i].signature, signature, 4) == 0)
+      return &tables[i];
+  }
+  return NULL;
+}
+
+/**
+ * Load every table of a device output directory.
+ *
+ * @param dir     Device output directory (e.g. build/qcom_sm8850).
+ * @param files   Tables read, owned by caller.
+ * @param tables  Array to fill, entries point into files.
+ * @param count   Number of tables loaded.
+ * @retval 0      Success.
+ * @retval -ENOENT  Directory can not be opened or contains no table.
+ * @retval -EINVAL  A table is malformed or duplicated.
+ */
+static int load_link_tables(const char *dir, FileContent **files,
+                            LinkTable *tables, size_t *count) {
+  int ret = read_table_directory(dir, files, count);
+  if (ret < 0) {
+    log_err("Failed to read tables from %s", dir);
+    return ret;
+  }
+  if (*count > LINK_MAX_TABLES) {
+    log_err("Too many tables in %s (max %d)", dir, LINK_MAX_TABLES);
+    return -EINVAL;
+  }
+
+  for (size_t i = 0; i < *count; i++) {
+    tables[i].file = &(*files)[i];
+    memcpy(tables[i].signature, tables[i].file->fileBuffer, 4);
+    tables[i].signature[4] = '\0';
+    if (find_link_table(tables, i, tables[i].signature)) {
+      log_err("Duplicate table %s in %s", tables[i].signature, dir);
+      return -EINVAL;
+    }
+  }
+  return 0;
+}
+
+static void write_u64(uint8_t *buffer, size_t offset, uint64_t value) {
+  memcpy(buffer + offset, &value, sizeof(value));
+}
+
+static void write_u32(uint8_t *buffer, size_t offset, uint32_t value) {
+  memcpy(buffer + offset, &value, sizeof(value));
+}
+
+/**
+ * Patch table to table pointers now that final addresses are known.
+ *
+ * @retval 0        Success.
+ * @retval -EINVAL  A table is too short to hold the pointer field.
+ */
+static int link_fixup_pointers(uint8_t *image, uint64_t base,
+                               LinkTable *tables, size_t count) {
+  LinkTable *facp = find_link_table(tables, count, "FACP");
+  LinkTable *facs = find_link_table(tables, count, "FACS");
+  LinkTable *dsdt = find_link_table(tables, count, "DSDT");
+  LinkTable *fpdt = find_link_table(tables, count, "FPDT");
+  LinkTable *fbpt = find_link_table(tables, count, "FBPT");
+
+  if (facp) {
+    uint8_t *fadt = image + facp->offset;
+    size_t data = sizeof(ACPI_TABLE_HEADER);
+    if (facp->file->fileSize < data + offsetof(FACP_DATA_STRUCTURE, X_DSDT) +
+                                  sizeof(UINT64)) {
+      log_err("FACP is too short to hold X_DSDT (%zu bytes)",
+              facp->file->fileSize);
+      return -EINVAL;
+    }
+    // When the 64-bit pointer is set the 32-bit one must be zero
+    if (facs) {
+      write_u32(fadt, data + offsetof(FACP_DATA_STRUCTURE, FIRMWARE_CTRL), 0);
+      write_u64(fadt, data + offsetof(FACP_DATA_STRUCTURE, X_FIRMWARE_CTRL),
+                base + facs->offset);
+    } else {
+      log_warn("No FACS table, FACP.X_FIRMWARE_CTRL left unchanged");
+    }
+    if (dsdt) {
+      write_u32(fadt, data + offsetof(FACP_DATA_STRUCTURE, DSDT), 0);
+      write_u64(fadt, data + offsetof(FACP_DATA_STRUCTURE, X_DSDT),
+                base + dsdt->offset);
+    } else {
+      log_warn("No DSDT table, FACP.X_DSDT left unchanged");
+    }
+  }
+
+  if (fpdt && fbpt) {
+    if (fpdt->file->fileSize < FPDT_FBPT_POINTER_OFFSET + sizeof(UINT64)) {
+      log_err("FPDT is too short to hold FBPTPointer (%zu bytes)",
+              fpdt->file->fileSize);
+      return -EINVAL;
+    }
+    write_u64(image + fpdt->offset, FPDT_FBPT_POINTER_OFFSET,
+              base + fbpt->offset);
+  }
+
+  return 0;
+}
+
+static void link_fill_rsdp(uint8_t *image, uint64_t xsdt_address,
+                           const LinkTable *oem_source) {
+  ACPI_RSDP_STRUCTURE *rsdp = (ACPI_RSDP_STRUCTURE *)image;
+  const CHAR8 signature[] = {ACPI_RSDP_SIGNATURE};
+
+  memcpy(rsdp->Signature, signature, sizeof(rsdp->Signature));
+  memcpy(rsdp->OemId,
+         ((ACPI_TABLE_HEADER *)oem_source->file->fileBuffer)->OemId,
+         sizeof(rsdp->OemId));
+  rsdp->Revision = ACPI_RSDP_REVISION;
+  rsdp->RsdtAddress = 0;
+  rsdp->Length = sizeof(ACPI_RSDP_STRUCTURE);
+  rsdp->XsdtAddress = xsdt_address;
+  rsdp->Checksum = 0;
+  rsdp->ExtendedChecksum = 0;
+  rsdp->Checksum = checksum(image, ACPI_RSDP_CHECKSUM_LENGTH);
+  rsdp->ExtendedChecksum = checksum(image, sizeof(ACPI_RSDP_STRUCTURE));
+}
+
+static void link_fill_xsdt(uint8_t *image, uint64_t xsdt_offset,
+                           uint64_t base, LinkTable *tables, size_t count,
+                           size_t entries) {
+  ACPI_TABLE_HEADER *xsdt = (ACPI_TABLE_HEADER *)(image + xsdt_offset);
+  const ACPI_TABLE_HEADER *oem =
+      (const ACPI_TABLE_HEADER *)tables[0].file->fileBuffer;
+  const CHAR8 signature[] = {ACPI_XSDT_SIGNATURE};
+  const CHAR8 creator[] = {ACPI_CREATOR_ID};
+  size_t entry = 0;
+
+  memcpy(xsdt->Signature, signature, sizeof(xsdt->Signature));
+  xsdt->Length = XSDT_TABLE_LENGTH(entries);
+  xsdt->Revision = ACPI_XSDT_REVISION;
+  memcpy(xsdt->OemId, oem->OemId, sizeof(xsdt->OemId));
+  memcpy(xsdt->OemTableId, oem->OemTableId, sizeof(xsdt->OemTableId));
+  xsdt->OemRevision = oem->OemRevision;
+  memcpy(xsdt->CreatorId, creator, sizeof(xsdt->CreatorId));
+  xsdt->CreatorRevision = ACPI_CREATOR_REVISION;
+
+  for (size_t i = 0; i < count; i++) {
+    if (!table_in_xsdt(tables[i].signature))
+      continue;
+    write_u64(image, xsdt_offset + sizeof(ACPI_XSDT_TABLE_HEADER) +
+                         entry * sizeof(UINT64),
+              base + tables[i].offset);
+    entry++;
+  }
+
+  xsdt->Checksum = 0;
+  xsdt->Checksum = checksum((uint8_t *)xsdt, xsdt->Length);
+}
+
+int main(int argc, char **argv) {
+  LinkTable tables[LINK_MAX_TABLES] = {0};
+  LinkRegion regions[LINK_MEMORY_NVS + 1] = {0};
+  size_t region_count = 1;
+  FileContent *files = NULL;
+  size_t table_count = 0;
+  size_t xsdt_entries = 0;
+  uint64_t base = 0;
+  uint64_t xsdt_offset = 0;
+  uint64_t image_size = 0;
+  char *end = NULL;
+  FileContent output_image = {0};
+  int ret = 0;
+
+  // Check args, device table directory, base address and output image
+  if (argc != 4) {
+    log_warn("Usage: %s <device_table_dir> <base_address> <output_image>",
+             argv[0]);
+    return -EINVAL;
+  }
+
+  base = strtoull(argv[2], &end, 0);
+  if (end == argv[2] || *end != '\0') {
+    log_err("Invalid base address %s", argv[2]);
+    return -EINVAL;
+  }
+  // Regions are laid out on pages from the base, the first one would share
+  // its page with the memory below the image otherwise. RSDP at the base is
+  // then 16 bytes aligned as well.
+  if (base % LINK_PAGE_SIZE) {
+    log_err("Base address 0x%llx is not %d bytes (page) aligned",
+            (unsigned long long)base, LINK_PAGE_SIZE);
+    return -EINVAL;
+  }
+
+  ret = load_link_tables(argv[1], &files, tables, &table_count);
+  if (ret < 0)
+    goto cleanup;
+  qsort(tables, table_count, sizeof(LinkTable), compare_link_tables);
+
+  // Layout: RSDP, XSDT, then every table at its final address. A table of
+  // another memory type starts a new region on a page boundary, so that no
+  // page holds two memory types.
+  for (size_t i = 0; i < table_count; i++) {
+    if (table_in_xsdt(tables[i].signature))
+      xsdt_entries++;
+  }
+  xsdt_offset = ALIGN_UP(sizeof(ACPI_RSDP_STRUCTURE), LINK_TABLE_ALIGNMENT);
+  image_size = xsdt_offset + XSDT_TABLE_LENGTH(xsdt_entries);
+  regions[0].type = LINK_MEMORY_RECLAIM;
+  regions[0].size = image_size;
+  for (size_t i = 0; i < table_count; i++) {
+    LinkMemoryType type = link_table_memory(tables[i].signature);
+    uint64_t alignment = memcmp(tables[i].signature, "FACS", 4) == 0
+                             ? LINK_FACS_ALIGNMENT
+                             : LINK_TABLE_ALIGNMENT;
+    LinkRegion *region = &regions[region_count - 1];
+
+    if (type != region->type) {
+      region->size = ALIGN_UP(base + image_size, LINK_PAGE_SIZE) - base -
+                     region->offset;
+      region = &regions[region_count++];
+      region->type = type;
+      region->offset = region[-1].offset + region[-1].size;
+      image_size = region->offset;
+    }
+    // Align the final address, not only the offset in the image
+    tables[i].offset = ALIGN_UP(base + image_size, alignment) - base;
+    image_size = tables[i].offset + tables[i].file->fileSize;
+    region->size = image_size - region->offset;
+  }
+
+  output_image.fileSize = image_size;
+  output_image.fileBuffer = calloc(1, output_image.fileSize);
+  if (!output_image.fileBuffer) {
+    log_err("Failed to allocate %llu bytes for image",
+            (unsigned long long)image_size);
+    ret = -ENOMEM;
+    goto cleanup;
+  }
+
+  for (size_t i = 0; i < table_count; i++) {
+    memcpy(output_image.fileBuffer + tables[i].offset,
+           tables[i].file->fileBuffer, tables[i].file->fileSize);
+  }
+
+  ret = link_fixup_pointers(output_image.fileBuffer, base, tables,
+                            table_count);
+  if (ret < 0)
+    goto cleanup;
+
+  // Pointers changed, recompute checksums of every table in the image
+  for (size_t i = 0; i < table_count; i++) {
+    ACPI_TABLE_HEADER *header =
+        (ACPI_TABLE_HEADER *)(output_image.fileBuffer + tables[i].offset);
+    if (!table_has_checksum(tables[i].signature))
+      continue;
+    header->Checksum = 0;
+    header->Checksum = checksum((uint8_t *)header, header->Length);
+  }
+
+  link_fill_xsdt(output_image.fileBuffer, xsdt_offset, base, tables,
+                 table_count, xsdt_entries);
+  link_fill_rsdp(output_image.fileBuffer, base + xsdt_offset, &tables[0]);
+
+  output_image.filePath = argv[3];
+  ret = write_file_content(&output_image);
+  if (ret < 0) {
+    log_err("Failed to write ACPI image to %s", output_image.filePath);
+    goto cleanup;
+  }
+
+  // Success, print the final memory map
+  log_info("RSDP at 0x%016llx (%zu bytes)", (unsigned long long)base,
+           sizeof(ACPI_RSDP_STRUCTURE));
+  log_info("XSDT at 0x%016llx (%zu bytes, %zu entries)",
+           (unsigned long long)(base + xsdt_offset),
+           (size_t)XSDT_TABLE_LENGTH(xsdt_entries), xsdt_entries);
+  for (size_t i = 0; i < table_count; i++) {
+    log_info("%s at 0x%016llx (%zu bytes)%s", tables[i].signature,
+             (unsigned long long)(base + tables[i].offset),
+             tables[i].file->fileSize,
+             table_in_xsdt(tables[i].signature) ? "" : ", not in XSDT");
+  }
+  // Firmware publishes each region with its own memory type
+  for (size_t i = 0; i < region_count; i++) {
+    log_info("Region 0x%016llx-0x%016llx: %s",
+             (unsigned long long)(base + regions[i].offset),
+             (unsigned long long)(base + regions[i].offset + regions[i].size -
+                                  1),
+             link_memory_names[regions[i].type]);
+  }
+  log_info("Image linked to :\t%s (%llu bytes)", output_image.filePath,
+           (unsigned long long)image_size);
+
+cleanup:
+  free_table_directory(files, table_count);
+  free(output_image.fileBuffer);
+  return ret;
+}
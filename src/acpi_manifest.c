@@ -0,0 +1,315 @@
+/* Golden manifest of every built table, to prove refactors are byte identical */
+#include "sha256.h"
+#include "utils.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Usage
+
+  acpi_manifest write <build_dir> <manifest>
+  acpi_manifest check <build_dir> <golden_manifest>
+
+  The manifest has one line per <build_dir>/<device>/<TABLE>.aml, sorted:
+
+    <device>/<TABLE>.aml <signature> <length> <checksum> <sha256>
+
+  with checksum "-" for tables without one (FACS, FBPT). check hashes the
+  current build and reports every table that differs from, is missing from
+  or is not in the golden manifest. Use acpi_diff against a build of the
+  previous revision to see which fields changed.
+*/
+
+#define MANIFEST_MAX_NAME 256
+#define MANIFEST_HEADER                                                        \
+  "# <device>/<TABLE>.aml <signature> <length> <checksum> <sha256>\n"
+
+typedef struct {
+  char path[MANIFEST_MAX_NAME * 2]; // <device>/<TABLE>.aml
+  char signature[5];
+  uint32_t length;
+  char checksum[5]; // "0xXX" or "-"
+  char sha256[SHA256_DIGEST_SIZE * 2 + 1];
+} ManifestEntry;
+
+typedef struct {
+  ManifestEntry *entries;
+  size_t count;
+  size_t capacity;
+} Manifest;
+
+static ManifestEntry *manifest_append(Manifest *manifest) {
+  if (manifest->count == manifest->capacity) {
+    size_t capacity = manifest->capacity ? manifest->capacity * 2 : 64;
+    ManifestEntry *grown =
+        realloc(manifest->entries, capacity * sizeof(*grown));
+    if (grown == NULL)
+      return NULL;
+    manifest->entries = grown;
+    manifest->capacity = capacity;
+  }
+  memset(&manifest->entries[manifest->count], 0, sizeof(ManifestEntry));
+  return &manifest->entries[manifest->count++];
+}
+
+static int compare_entries(const void *a, const void *b) {
+  return strcmp(((const ManifestEntry *)a)->path,
+                ((const ManifestEntry *)b)->path);
+}
+
+static int add_table(Manifest *manifest, const char *device,
+                     const FileContent *table) {
+  ManifestEntry *entry = manifest_append(manifest);
+  const char *name = strrchr(table->filePath, '/');
+  uint8_t digest[SHA256_DIGEST_SIZE];
+
+  if (entry == NULL)
+    return -ENOMEM;
+  name = name != NULL ? name + 1 : table->filePath;
+  snprintf(entry->path, sizeof(entry->path), "%s/%s", device, name);
+  memcpy(entry->signature, table->fileBuffer, 4);
+  for (int i = 0; i < 4; i++)
+    if (entry->signature[i] <= ' ' || entry->signature[i] >= 0x7F)
+      entry->signature[i] = '?';
+  entry->length = (uint32_t)table->fileSize;
+  if (table_has_checksum(entry->signature) && table->fileSize > 9)
+    snprintf(entry->checksum, sizeof(entry->checksum), "0x%02X",
+             table->fileBuffer[9]);
+  else
+    memcpy(entry->checksum, "-", 2);
+  sha256(table->fileBuffer, table->fileSize, digest);
+  sha256_to_hex(digest, entry->sha256);
+  return 0;
+}
+
+/**
+ * Hash every <build_dir>/<device>/<TABLE>.aml.
+ *
+ * Directories without tables (CMakeFiles, ...) are skipped.
+ *
+ * @retval 0        Success, manifest is sorted by path.
+ * @retval -ENOENT  No table found.
+ * @retval <0       A table could not be read.
+ */
+static int scan_build(const char *build_dir, Manifest *manifest) {
+  DIR *handle = opendir(build_dir);
+  struct dirent *entry;
+  int ret = 0;
+
+  if (handle == NULL)
+    return -ENOENT;
+  while (ret == 0 && (entry = readdir(handle)) != NULL) {
+    char dir[MANIFEST_MAX_NAME * 2];
+    FileContent *tables = NULL;
+    size_t count = 0;
+
+    if (entry->d_name[0] == '.' || strcmp(entry->d_name, "CMakeFiles") == 0 ||
+        strlen(entry->d_name) >= MANIFEST_MAX_NAME)
+      continue;
+    snprintf(dir, sizeof(dir), "%s/%s", build_dir, entry->d_name);
+    if (!is_directory(dir))
+      continue;
+
+    ret = read_table_directory(dir, &tables, &count);
+    if (ret == -ENOENT) {
+      ret = 0;
+      continue;
+    }
+    if (ret < 0) {
+      log_err("Failed to read tables of %s (%d)", dir, ret);
+      break;
+    }
+    for (size_t i = 0; i < count && ret == 0; i++)
+      ret = add_table(manifest, entry->d_name, &tables[i]);
+    free_table_directory(tables, count);
+  }
+  closedir(handle);
+
+  if (ret == 0 && manifest->count == 0)
+    ret = -ENOENT;
+  qsort(manifest->entries, manifest->count, sizeof(ManifestEntry),
+        compare_entries);
+  return ret;
+}
+
+static int write_manifest(const char *path, const Manifest *manifest) {
+  FILE *out = fopen(path, "w");
+
+  if (out == NULL) {
+    log_err("Failed to open %s", path);
+    return -EIO;
+  }
+  fputs(MANIFEST_HEADER, out);
+  for (size_t i = 0; i < manifest->count; i++) {
+    const ManifestEntry *entry = &manifest->entries[i];
+    fprintf(out, "%s %s %u %s %s\n", entry->path, entry->signature,
+            entry->length, entry->checksum, entry->sha256);
+  }
+  if (fclose(out) != 0) {
+    log_err("Failed to write %s", path);
+    return -EIO;
+  }
+  return 0;
+}
+
+/**
+ * Load a manifest written by write_manifest().
+ *
+ * @retval 0        Success, manifest is sorted by path.
+ * @retval -ENOENT  File not found.
+ * @retval -EINVAL  Malformed line.
+ */
+static int read_manifest(const char *path, Manifest *manifest) {
+  FILE *in = fopen(path, "r");
+  char line[MANIFEST_MAX_NAME * 4];
+  unsigned line_number = 0;
+  int ret = 0;
+
+  if (in == NULL)
+    return -ENOENT;
+  while (ret == 0 && fgets(line, sizeof(line), in) != NULL) {
+    ManifestEntry *entry;
+    char extra;
+
+    line_number++;
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+      continue;
+    entry = manifest_append(manifest);
+    if (entry == NULL) {
+      ret = -ENOMEM;
+      break;
+    }
+    if (sscanf(line, "%511s %4s %u %4s %64s %c", entry->path,
+               entry->signature, &entry->length, entry->checksum,
+               entry->sha256, &extra) != 5 ||
+        strlen(entry->sha256) != SHA256_DIGEST_SIZE * 2) {
+      log_err("%s:%u: malformed manifest line", path, line_number);
+      ret = -EINVAL;
+    }
+  }
+  fclose(in);
+  qsort(manifest->entries, manifest->count, sizeof(ManifestEntry),
+        compare_entries);
+  return ret;
+}
+
+static void report_mismatch(const ManifestEntry *golden,
+                            const ManifestEntry *current) {
+  char detail[256];
+  size_t used = 0;
+
+  detail[0] = '\0';
+  if (strcmp(golden->signature, current->signature) != 0)
+    used += snprintf(detail + used, sizeof(detail) - used,
+                     ", signature %s -> %s", golden->signature,
+                     current->signature);
+  if (golden->length != current->length)
+    used += snprintf(detail + used, sizeof(detail) - used,
+                     ", length %u -> %u", golden->length, current->length);
+  if (strcmp(golden->checksum, current->checksum) != 0)
+    used += snprintf(detail + used, sizeof(detail) - used,
+                     ", checksum %s -> %s", golden->checksum,
+                     current->checksum);
+  if (strcmp(golden->sha256, current->sha256) != 0)
+    snprintf(detail + used, sizeof(detail) - used, ", sha256 %.12s -> %.12s",
+             golden->sha256, current->sha256);
+  log_err("%s changed: %s", current->path, detail + 2);
+}
+
+/**
+ * Compare the current build against the golden manifest.
+ *
+ * @retval  Number of tables that changed, appeared or disappeared.
+ */
+static size_t check_manifest(const Manifest *golden, const Manifest *current) {
+  size_t mismatches = 0;
+  size_t i = 0, j = 0;
+
+  while (i < golden->count || j < current->count) {
+    int order;
+
+    if (i == golden->count)
+      order = 1;
+    else if (j == current->count)
+      order = -1;
+    else
+      order = strcmp(golden->entries[i].path, current->entries[j].path);
+
+    if (order < 0) {
+      log_err("%s is in the golden manifest but was not built",
+              golden->entries[i].path);
+      mismatches++;
+      i++;
+    } else if (order > 0) {
+      log_err("%s is not in the golden manifest", current->entries[j].path);
+      mismatches++;
+      j++;
+    } else {
+      const ManifestEntry *old_entry = &golden->entries[i];
+      const ManifestEntry *new_entry = &current->entries[j];
+      if (strcmp(old_entry->sha256, new_entry->sha256) != 0 ||
+          old_entry->length != new_entry->length ||
+          strcmp(old_entry->checksum, new_entry->checksum) != 0 ||
+          strcmp(old_entry->signature, new_entry->signature) != 0) {
+        report_mismatch(old_entry, new_entry);
+        mismatches++;
+      }
+      i++;
+      j++;
+    }
+  }
+  return mismatches;
+}
+
+int main(int argc, char **argv) {
+  Manifest current = {0};
+  Manifest golden = {0};
+  struct timespec start;
+  bool write;
+  int ret;
+
+  if (argc != 4 ||
+      (strcmp(argv[1], "write") != 0 && strcmp(argv[1], "check") != 0)) {
+    log_warn("Usage: %s write|check <build_dir> <manifest>", argv[0]);
+    return -EINVAL;
+  }
+  write = strcmp(argv[1], "write") == 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  ret = scan_build(argv[2], &current);
+  if (ret == -ENOENT)
+    log_err("No tables found under %s", argv[2]);
+  if (ret < 0)
+    goto out;
+
+  if (write) {
+    ret = write_manifest(argv[3], &current);
+    if (ret == 0)
+      log_info("Wrote %zu table(s) to %s", current.count, argv[3]);
+    goto out;
+  }
+
+  ret = read_manifest(argv[3], &golden);
+  if (ret == -ENOENT)
+    log_err("Golden manifest %s not found", argv[3]);
+  if (ret < 0)
+    goto out;
+
+  size_t mismatches = check_manifest(&golden, &current);
+  if (mismatches) {
+    printf(LOG_COLOR_ERROR "[FAIL] %zu of %zu table(s) differ from %s "
+                           "(%.2f ms)" LOG_COLOR_RESET "\n",
+           mismatches, current.count, argv[3], elapsed_ms(&start));
+    ret = -EINVAL;
+  } else {
+    log_info("All %zu table(s) match %s (%.2f ms)", current.count, argv[3],
+             elapsed_ms(&start));
+  }
+
+out:
+  free(current.entries);
+  free(golden.entries);
+  return ret;
+}
@@ -0,0 +1,595 @@
+/* Apply declarative SKU overrides to built tables and emit all variants */
+#include "acpi_layout.h"
+#include "utils.h"
+#include <acpi.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/** Override file format
+
+  # Comment
+  <SIG> <structure> <field> <value>     lines before any section apply
+  [variant_name]                        to every variant
+  <SIG> <structure> <field> <value>
+
+  SIG        Table signature, or * for every table that has the field.
+  structure  "." for the fixed part (header and header extra data), or
+             NAME[selector] for subtables, e.g. GICC[3], GICC[*] or
+             GICC[ACPIProcessorUID=5]. Selectors match the unpatched table.
+  field      Field name from lib/acpi_layout.c, e.g. Flags, OemRevision,
+             BaseAddress.Address.
+  value      Integer (C syntax) or "string" for character fields, strings
+             are padded with spaces.
+
+  Without any section the patched tables are written to output_dir,
+  otherwise to output_dir/<variant_name>/. Variant names must not contain
+  '/' or "..".
+*/
+
+#define PATCH_MAX_TOKEN 64
+#define PATCH_MAX_LINE 512
+#define PATCH_COMMON_VARIANT -1
+
+typedef enum {
+  PATCH_SELECT_FIXED = 0, // "."
+  PATCH_SELECT_INDEX,     // NAME[n]
+  PATCH_SELECT_ALL,       // NAME[*]
+  PATCH_SELECT_KEY,       // NAME[Field=value]
+} PatchSelector;
+
+typedef struct {
+  size_t table;                      // Index in loaded tables
+  uint32_t base;                     // Structure offset in table
+  const AcpiFieldDescriptor *field; // Offset relative to base
+} PatchTarget;
+
+typedef struct {
+  int line;
+  int variant; // PATCH_COMMON_VARIANT or index in variant names
+  char signature[5];
+  char structure[PATCH_MAX_TOKEN];
+  PatchSelector selector;
+  uint32_t index;
+  char key[PATCH_MAX_TOKEN];
+  uint64_t keyValue;
+  char field[PATCH_MAX_TOKEN];
+  bool isString;
+  char string[PATCH_MAX_TOKEN];
+  uint64_t value;
+  PatchTarget *targets;
+  size_t targetCount;
+} Patch;
+
+typedef struct {
+  Patch *patches;
+  size_t patchCount;
+  char (*variants)[PATCH_MAX_TOKEN];
+  size_t variantCount;
+} PatchFile;
+
+static bool parse_number(const char *text, uint64_t *value) {
+  char *end = NULL;
+  if (*text == '\0' || *text == '-')
+    return false;
+  *value = strtoull(text, &end, 0);
+  return *end == '\0';
+}
+
+/**
+ * Split a line into whitespace separated tokens, "quoted strings" kept whole.
+ *
+ * @return  Number of tokens, -1 on unterminated quote or too long token.
+ */
+static int tokenize(char *line, char tokens[][PATCH_MAX_TOKEN],
+                    int max_tokens, bool *quoted) {
+  int count = 0;
+  char *p = line;
+
+  while (*p) {
+    while (isspace((unsigned char)*p))
+      p++;
+    if (*p == '\0' || *p == '#')
+      break;
+    if (count == max_tokens)
+      return -1;
+
+    size_t length = 0;
+    quoted[count] = *p == '"';
+    if (quoted[count]) {
+      char *end = strchr(++p, '"');
+      if (end == NULL)
+        return -1;
+      length = end - p;
+      if (length >= PATCH_MAX_TOKEN)
+        return -1;
+      memcpy(tokens[count], p, length);
+      p = end + 1;
+    } else {
+      while (p[length] && !isspace((unsigned char)p[length]) &&
+             p[length] != '#')
+        length++;
+      if (length >= PATCH_MAX_TOKEN)
+        return -1;
+      memcpy(tokens[count], p, length);
+      p += length;
+    }
+    tokens[count][length] = '\0';
+    count++;
+  }
+  return count;
+}
+
+/**
+ * Parse "NAME[selector]" or "." into a patch.
+ */
+static bool parse_structure(const char *text, Patch *patch) {
+  const char *open = strchr(text, '[');
+  size_t length = strlen(text);
+
+  if (strcmp(text, ".") == 0) {
+    patch->selector = PATCH_SELECT_FIXED;
+    return true;
+  }
+  if (open == NULL || open == text || text[length - 1] != ']')
+    return false;
+
+  memcpy(patch->structure, text, open - text);
+  patch->structure[open - text] = '\0';
+
+  char selector[PATCH_MAX_TOKEN];
+  size_t selector_length = text + length - 1 - (open + 1);
+  memcpy(selector, open + 1, selector_length);
+  selector[selector_length] = '\0';
+
+  char *equal = strchr(selector, '=');
+  if (strcmp(selector, "*") == 0) {
+    patch->selector = PATCH_SELECT_ALL;
+  } else if (equal != NULL) {
+    *equal = '\0';
+    patch->selector = PATCH_SELECT_KEY;
+    strcpy(patch->key, selector);
+    if (!parse_number(equal + 1, &patch->keyValue))
+      return false;
+  } else {
+    uint64_t index;
+    if (!parse_number(selector, &index) || index > UINT32_MAX)
+      return false;
+    patch->selector = PATCH_SELECT_INDEX;
+    patch->index = index;
+  }
+  return true;
+}
+
+static void free_patch_file(PatchFile *file) {
+  for (size_t i = 0; i < file->patchCount; i++)
+    free(file->patches[i].targets);
+  free(file->patches);
+  free(file->variants);
+  memset(file, 0, sizeof(*file));
+}
+
+/**
+ * Parse an override file.
+ *
+ * @retval 0        Success.
+ * @retval -ENOENT  File can not be opened.
+ * @retval -EINVAL  Syntax error, reported with its line number.
+ * @retval -ENOMEM  Out of memory.
+ */
+static int parse_patch_file(const char *path, PatchFile *file) {
+  FILE *pFile = fopen(path, "r");
+  char line[PATCH_MAX_LINE];
+  int line_number = 0;
+  int variant = PATCH_COMMON_VARIANT;
+  size_t patch_capacity = 0;
+  size_t variant_capacity = 0;
+  int ret = 0;
+
+  memset(file, 0, sizeof(*file));
+  if (pFile == NULL) {
+    log_err("Failed to open override file %s", path);
+    return -ENOENT;
+  }
+
+  while (ret == 0 && fgets(line, sizeof(line), pFile) != NULL) {
+    char tokens[4][PATCH_MAX_TOKEN];
+    bool quoted[4];
+    int count;
+
+    line_number++;
+    count = tokenize(line, tokens, 4, quoted);
+    if (count == 0)
+      continue;
+
+    // [variant_name]
+    if (count == 1 && tokens[0][0] == '[') {
+      size_t length = strlen(tokens[0]);
+      if (length < 3 || tokens[0][length - 1] != ']') {
+        log_err("%s:%d: invalid section %s", path, line_number, tokens[0]);
+        ret = -EINVAL;
+        break;
+      }
+      if (file->variantCount == variant_capacity) {
+        variant_capacity = variant_capacity ? variant_capacity * 2 : 16;
+        void *grown = realloc(file->variants,
+                              variant_capacity * sizeof(*file->variants));
+        if (grown == NULL) {
+          ret = -ENOMEM;
+          break;
+        }
+        file->variants = grown;
+      }
+      memcpy(file->variants[file->variantCount], tokens[0] + 1, length - 2);
+      file->variants[file->variantCount][length - 2] = '\0';
+      // The name is an output directory, it must stay under output_dir
+      if (strchr(file->variants[file->variantCount], '/') != NULL ||
+          strstr(file->variants[file->variantCount], "..") != NULL) {
+        log_err("%s:%d: invalid variant name %s", path, line_number,
+                file->variants[file->variantCount]);
+        ret = -EINVAL;
+        break;
+      }
+      for (size_t i = 0; i < file->variantCount; i++) {
+        if (strcmp(file->variants[i], file->variants[file->variantCount]) ==
+            0) {
+          log_err("%s:%d: duplicate variant %s", path, line_number,
+                  file->variants[i]);
+          ret = -EINVAL;
+        }
+      }
+      variant = file->variantCount++;
+      continue;
+    }
+
+    if (count != 4 || (strlen(tokens[0]) != 4 && strcmp(tokens[0], "*"))) {
+      log_err("%s:%d: expected <SIG> <structure> <field> <value>", path,
+              line_number);
+      ret = -EINVAL;
+      break;
+    }
+
+    if (file->patchCount == patch_capacity) {
+      patch_capacity = patch_capacity ? patch_capacity * 2 : 32;
+      Patch *grown =
+          realloc(file->patches, patch_capacity * sizeof(Patch));
+      if (grown == NULL) {
+        ret = -ENOMEM;
+        break;
+      }
+      file->patches = grown;
+    }
+
+    Patch *patch = &file->patches[file->patchCount];
+    memset(patch, 0, sizeof(*patch));
+    patch->line = line_number;
+    patch->variant = variant;
+    strcpy(patch->signature, tokens[0]);
+    strcpy(patch->field, tokens[2]);
+    file->patchCount++;
+
+    if (!parse_structure(tokens[1], patch)) {
+      log_err("%s:%d: invalid structure %s", path, line_number, tokens[1]);
+      ret = -EINVAL;
+      break;
+    }
+    patch->isString = quoted[3];
+    if (patch->isString) {
+      strcpy(patch->string, tokens[3]);
+    } else if (!parse_number(tokens[3], &patch->value)) {
+      log_err("%s:%d: invalid value %s", path, line_number, tokens[3]);
+      ret = -EINVAL;
+      break;
+    }
+  }
+  fclose(pFile);
+
+  if (ret < 0)
+    free_patch_file(file);
+  return ret;
+}
+
+static int add_target(Patch *patch, size_t table, uint32_t base,
+                      const AcpiFieldDescriptor *field) {
+  PatchTarget *grown = realloc(patch->targets, (patch->targetCount + 1) *
+                                                   sizeof(PatchTarget));
+  if (grown == NULL)
+    return -ENOMEM;
+  patch->targets = grown;
+  patch->targets[patch->targetCount++] = (PatchTarget){table, base, field};
+  return 0;
+}
+
+typedef struct {
+  Patch *patch;
+  size_t table;
+  const AcpiStructureLayout *structure;
+  const AcpiFieldDescriptor *field;
+  const AcpiFieldDescriptor *key;
+} ResolveContext;
+
+static int resolve_subtable(const uint8_t *table,
+                            const AcpiSubtable *subtable, void *context) {
+  ResolveContext *ctx = context;
+  Patch *patch = ctx->patch;
+
+  if (subtable->layout != ctx->structure)
+    return 0;
+
+  switch (patch->selector) {
+  case PATCH_SELECT_INDEX:
+    if (subtable->index != patch->index)
+      return 0;
+    break;
+  case PATCH_SELECT_KEY:
+    if (ctx->key->offset + ctx->key->size > subtable->length ||
+        acpi_field_read(table + subtable->offset, ctx->key) !=
+            patch->keyValue)
+      return 0;
+    break;
+  default:
+    break;
+  }
+
+  // Variable structures (e.g. DBG2 devices) may be shorter than described
+  if (ctx->field->offset + ctx->field->size > subtable->length) {
+    log_err("line %d: %s[%u] is too short for %s", patch->line,
+            patch->structure, subtable->index, patch->field);
+    return -EINVAL;
+  }
+  return add_target(patch, ctx->table, subtable->offset, ctx->field);
+}
+
+/**
+ * Resolve the table offsets a patch writes to.
+ *
+ * @retval 0        Success, at least one target found.
+ * @retval -EINVAL  Unknown table, structure or field, or nothing matched.
+ */
+static int resolve_patch(Patch *patch, FileContent *tables,
+                         size_t table_count) {
+  bool any_table = strcmp(patch->signature, "*") == 0;
+
+  for (size_t t = 0; t < table_count; t++) {
+    const uint8_t *table = tables[t].fileBuffer;
+    const AcpiTableLayout *layout;
+    int ret;
+
+    if (!any_table && memcmp(table, patch->signature, 4) != 0)
+      continue;
+    layout = acpi_layout_find((const char *)table);
+    if (layout == NULL) {
+      if (any_table)
+        continue;
+      log_err("line %d: no known layout for table %s", patch->line,
+              patch->signature);
+      return -EINVAL;
+    }
+
+    if (patch->selector == PATCH_SELECT_FIXED) {
+      const AcpiFieldDescriptor *field =
+          acpi_layout_find_table_field(layout, patch->field);
+      if (field == NULL) {
+        if (any_table)
+          continue;
+        log_err("line %d: %.4s has no field %s", patch->line, (const char *)table,
+                patch->field);
+        return -EINVAL;
+      }
+      if (field->offset + field->size > tables[t].fileSize) {
+        log_err("line %d: %.4s is too short for %s", patch->line, (const char *)table,
+                patch->field);
+        return -EINVAL;
+      }
+      ret = add_target(patch, t, 0, field);
+      if (ret < 0)
+        return ret;
+      continue;
+    }
+
+    ResolveContext ctx = {.patch = patch, .table = t};
+    ctx.structure = acpi_layout_find_structure(layout, patch->structure);
+    if (ctx.structure == NULL) {
+      if (any_table)
+        continue;
+      log_err("line %d: %.4s has no structure %s", patch->line, (const char *)table,
+              patch->structure);
+      return -EINVAL;
+    }
+    ctx.field = acpi_layout_find_field(ctx.structure->fields,
+                                       ctx.structure->fieldCount,
+                                       patch->field);
+    if (patch->selector == PATCH_SELECT_KEY)
+      ctx.key = acpi_layout_find_field(ctx.structure->fields,
+                                       ctx.structure->fieldCount, patch->key);
+    if (ctx.field == NULL ||
+        (patch->selector == PATCH_SELECT_KEY && ctx.key == NULL)) {
+      log_err("line %d: %s has no field %s", patch->line, patch->structure,
+              ctx.field == NULL ? patch->field : patch->key);
+      return -EINVAL;
+    }
+    ret = acpi_layout_walk(table, tables[t].fileSize, layout,
+                           resolve_subtable, &ctx);
+    if (ret < 0) {
+      log_err("line %d: failed to walk %.4s", patch->line,
+              (const char *)table);
+      return ret;
+    }
+  }
+
+  if (patch->targetCount == 0) {
+    log_err("line %d: %s %s%s%s does not match anything", patch->line,
+            patch->signature,
+            patch->selector == PATCH_SELECT_FIXED ? "." : patch->structure,
+            patch->selector == PATCH_SELECT_FIXED ? "" : "[...] ",
+            patch->field);
+    return -EINVAL;
+  }
+
+  // Check value against every target field once
+  for (size_t i = 0; i < patch->targetCount; i++) {
+    const AcpiFieldDescriptor *field = patch->targets[i].field;
+    if (patch->isString) {
+      if (field->kind != ACPI_FIELD_CHARS ||
+          strlen(patch->string) > field->size) {
+        log_err("line %d: \"%s\" does not fit %s (%u characters)",
+                patch->line, patch->string, field->name, field->size);
+        return -EINVAL;
+      }
+    } else if (!acpi_field_fits(field, patch->value)) {
+      log_err("line %d: 0x%llx does not fit %s (%u bytes)", patch->line,
+              (unsigned long long)patch->value, field->name, field->size);
+      return -EINVAL;
+    }
+  }
+  return 0;
+}
+
+static void apply_patch(const Patch *patch, uint8_t **buffers) {
+  for (size_t i = 0; i < patch->targetCount; i++) {
+    const PatchTarget *target = &patch->targets[i];
+    uint8_t *base = buffers[target->table] + target->base;
+    if (patch->isString) {
+      size_t length = strlen(patch->string);
+      memset(base + target->field->offset, ' ', target->field->size);
+      memcpy(base + target->field->offset, patch->string, length);
+    } else {
+      acpi_field_write(base, target->field, patch->value);
+    }
+  }
+}
+
+/**
+ * Build one variant from the original tables and write it out.
+ */
+static int emit_variant(const PatchFile *file, int variant,
+                        FileContent *tables, size_t table_count,
+                        uint8_t **buffers, const char *output_dir) {
+  char path[4096];
+
+  if (mkdir(output_dir, 0755) != 0 && !is_directory(output_dir)) {
+    log_err("Failed to create directory %s", output_dir);
+    return -EIO;
+  }
+
+  for (size_t t = 0; t < table_count; t++)
+    memcpy(buffers[t], tables[t].fileBuffer, tables[t].fileSize);
+
+  for (size_t i = 0; i < file->patchCount; i++) {
+    if (file->patches[i].variant == PATCH_COMMON_VARIANT ||
+        file->patches[i].variant == variant)
+      apply_patch(&file->patches[i], buffers);
+  }
+
+  for (size_t t = 0; t < table_count; t++) {
+    ACPI_TABLE_HEADER *header = (ACPI_TABLE_HEADER *)buffers[t];
+    FileContent output = {0};
+    int ret;
+
+    if (table_has_checksum(header->Signature)) {
+      header->Checksum = 0;
+      header->Checksum = checksum(buffers[t], tables[t].fileSize);
+    }
+
+    // Keep the input file name, e.g. MADT.aml holds an APIC table
+    const char *name = strrchr(tables[t].filePath, '/');
+    snprintf(path, sizeof(path), "%s/%s", output_dir,
+             name ? name + 1 : tables[t].filePath);
+    output.filePath = path;
+    output.fileBuffer = buffers[t];
+    output.fileSize = tables[t].fileSize;
+    ret = write_file_content(&output);
+    if (ret < 0) {
+      log_err("Failed to write %s", path);
+      return ret;
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  FileContent *tables = NULL;
+  size_t table_count = 0;
+  uint8_t **buffers = NULL;
+  PatchFile file = {0};
+  struct timespec start;
+  int ret = 0;
+
+  // Check args, device table directory, override file and output directory
+  if (argc != 4) {
+    log_warn("Usage: %s <device_table_dir> <override_file> <output_dir>",
+             argv[0]);
+    return -EINVAL;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  ret = read_table_directory(argv[1], &tables, &table_count);
+  if (ret < 0) {
+    log_err("Failed to read tables from %s", argv[1]);
+    return ret;
+  }
+
+  ret = parse_patch_file(argv[2], &file);
+  if (ret < 0)
+    goto cleanup;
+
+  for (size_t i = 0; i < file.patchCount; i++) {
+    ret = resolve_patch(&file.patches[i], tables, table_count);
+    if (ret < 0) {
+      log_err("Failed to resolve %s", argv[2]);
+      goto cleanup;
+    }
+  }
+
+  buffers = calloc(table_count, sizeof(uint8_t *));
+  if (buffers == NULL) {
+    ret = -ENOMEM;
+    goto cleanup;
+  }
+  for (size_t t = 0; t < table_count; t++) {
+    buffers[t] = malloc(tables[t].fileSize);
+    if (buffers[t] == NULL) {
+      ret = -ENOMEM;
+      goto cleanup;
+    }
+  }
+
+  if (file.variantCount == 0) {
+    ret = emit_variant(&file, PATCH_COMMON_VARIANT, tables, table_count,
+                       buffers, argv[3]);
+  } else {
+    char variant_dir[4096];
+    if (mkdir(argv[3], 0755) != 0 && !is_directory(argv[3])) {
+      log_err("Failed to create directory %s", argv[3]);
+      ret = -EIO;
+      goto cleanup;
+    }
+    for (size_t v = 0; v < file.variantCount && ret == 0; v++) {
+      snprintf(variant_dir, sizeof(variant_dir), "%s/%s", argv[3],
+               file.variants[v]);
+      ret = emit_variant(&file, v, tables, table_count, buffers,
+                         variant_dir);
+    }
+  }
+  if (ret < 0)
+    goto cleanup;
+
+  log_info("Patched %zu variant(s) x %zu tables (%zu overrides) in %.2f ms",
+           file.variantCount ? file.variantCount : 1, table_count,
+           file.patchCount, elapsed_ms(&start));
+  log_info("Variants written to :\t%s", argv[3]);
+
+cleanup:
+  if (buffers) {
+    for (size_t t = 0; t < table_count; t++)
+      free(buffers[t]);
+  }
+  free(buffers);
+  free_patch_file(&file);
+  free_table_directory(tables, table_count);
+  return ret;
+}
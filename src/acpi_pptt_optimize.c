@@ -0,0 +1,260 @@
+/* Shrink built PPTTs and check Linux sees the same topology */
+#include "acpi_topology.h"
+#include "acpi_validate.h"
+#include "pptt_optimize.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/** Usage
+
+  acpi_pptt_optimize [-o <out_dir>] <build_dir> [device...]
+
+  Re-emits the PPTT of every <build_dir>/<device> (or of the given devices)
+  with identical cache structures shared and private resource lists packed,
+  see include/pptt_optimize.h, and prints its size before and after.
+
+  Each optimized PPTT must pass the native checks of acpi_validate, and the
+  topology Linux derives from it with the device MADT (include/
+  acpi_topology.h) must be the same as with the built one: every CPU mask,
+  cache leaf and shared_cpu_list. The exit status is non zero otherwise.
+
+  -o writes the optimized tables to <out_dir>/<device>/PPTT.aml. The built
+  tables are left as they are.
+*/
+
+#define OPTIMIZE_MAX_NAME 256
+#define OPTIMIZE_MAX_DEVICES 256
+
+typedef struct {
+  const char *outDir;
+  AcpiArena arena;
+  uint64_t sizeBefore;
+  uint64_t sizeAfter;
+  size_t failed;
+} OptimizeOptions;
+
+static const FileContent *find_table(const FileContent *tables, size_t count,
+                                     const char *signature) {
+  for (size_t i = 0; i < count; i++) {
+    if (tables[i].fileSize >= 4 &&
+        memcmp(tables[i].fileBuffer, signature, 4) == 0)
+      return &tables[i];
+  }
+  return NULL;
+}
+
+static int write_table(const char *out_dir, const char *device,
+                       const uint8_t *table, size_t size) {
+  char path[OPTIMIZE_MAX_NAME * 3];
+  FILE *out;
+  size_t written;
+
+  snprintf(path, sizeof(path), "%s/%s", out_dir, device);
+  if (mkdir(path, 0755) != 0 && !is_directory(path)) {
+    log_err("Failed to create %s", path);
+    return -EIO;
+  }
+  snprintf(path + strlen(path), sizeof(path) - strlen(path), "/PPTT.aml");
+  out = fopen(path, "wb");
+  if (out == NULL) {
+    log_err("Failed to open %s", path);
+    return -EIO;
+  }
+  written = fwrite(table, 1, size, out);
+  if (fclose(out) != 0 || written != size) {
+    log_err("Failed to write %s", path);
+    return -EIO;
+  }
+  return 0;
+}
+
+static void report_change(const char *message, void *context) {
+  const char *device = context;
+  printf(LOG_COLOR_ERROR "[FAIL] %s: topology changed: %s" LOG_COLOR_RESET
+                         "\n",
+         device, message);
+}
+
+/**
+ * Topology of the MADT with both PPTTs.
+ *
+ * @retval  Number of differences, 1 if either could not be simulated.
+ */
+static size_t check_topology(const char *device, const FileContent *madt,
+                             const uint8_t *before, size_t beforeSize,
+                             const uint8_t *after, size_t afterSize) {
+  AcpiTopology old, optimized;
+  size_t differences;
+  int ret;
+
+  ret = acpi_topology_simulate(before, beforeSize,
+                               madt ? madt->fileBuffer : NULL,
+                               madt ? madt->fileSize : 0, &old);
+  if (ret < 0) {
+    log_err("%s: failed to simulate the built PPTT (%d)", device, ret);
+    return 1;
+  }
+  ret = acpi_topology_simulate(after, afterSize,
+                               madt ? madt->fileBuffer : NULL,
+                               madt ? madt->fileSize : 0, &optimized);
+  if (ret < 0) {
+    log_err("%s: failed to simulate the optimized PPTT (%d)", device, ret);
+    acpi_topology_free(&old);
+    return 1;
+  }
+  differences =
+      acpi_topology_compare(&old, &optimized, report_change, (void *)device);
+  acpi_topology_free(&old);
+  acpi_topology_free(&optimized);
+  return differences;
+}
+
+/**
+ * Optimize and check the PPTT of one device.
+ *
+ * @retval 0        Done, options->failed counts a failed check.
+ * @retval -ENOENT  The device has no PPTT.
+ * @retval <0       Tables could not be read, optimized or written.
+ */
+static int optimize_device(OptimizeOptions *options, const char *build_dir,
+                           const char *device) {
+  char dir[OPTIMIZE_MAX_NAME * 2];
+  FileContent *tables = NULL;
+  const FileContent *pptt;
+  const uint8_t *table;
+  PpttOptimizeStats stats;
+  AcpiValidation validation;
+  size_t count = 0, length;
+  int ret;
+
+  snprintf(dir, sizeof(dir), "%s/%s", build_dir, device);
+  ret = read_table_directory(dir, &tables, &count);
+  if (ret < 0)
+    return ret;
+  pptt = find_table(tables, count, "PPTT");
+  if (pptt == NULL) {
+    free_table_directory(tables, count);
+    return -ENOENT;
+  }
+
+  acpi_arena_reset(&options->arena);
+  ret = pptt_optimize(pptt->fileBuffer, pptt->fileSize, &options->arena,
+                      &table, &length, &stats);
+  if (ret < 0) {
+    log_err("Failed to optimize %s (%d)", pptt->filePath, ret);
+    goto out;
+  }
+
+  acpi_validate_table(table, length, "PPTT", &validation);
+  if (acpi_validation_failed(&validation)) {
+    for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+      if (validation.status[check] == ACPI_CHECK_FAIL)
+        printf(LOG_COLOR_ERROR "[FAIL] %s: optimized PPTT %s: %s"
+                               LOG_COLOR_RESET "\n",
+               device, acpi_check_names[check], validation.message[check]);
+    }
+    options->failed++;
+  } else if (check_topology(device, find_table(tables, count, "APIC"),
+                            pptt->fileBuffer, pptt->fileSize, table,
+                            length) != 0) {
+    options->failed++;
+  } else {
+    log_info("%s: %u -> %u bytes (-%.1f%%), %u -> %u cache(s): %u shared, "
+             "%u unreachable, %u byte(s) of unused resources",
+             device, stats.sizeBefore, stats.sizeAfter,
+             100.0 * (stats.sizeBefore - stats.sizeAfter) / stats.sizeBefore,
+             stats.cachesBefore, stats.cachesAfter, stats.sharedCaches,
+             stats.unreachableCaches, stats.packedBytes);
+    if (options->outDir != NULL)
+      ret = write_table(options->outDir, device, table, length);
+  }
+  options->sizeBefore += stats.sizeBefore;
+  options->sizeAfter += stats.sizeAfter;
+
+out:
+  free_table_directory(tables, count);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  OptimizeOptions options = {0};
+  const char *build_dir = NULL;
+  const char *named[OPTIMIZE_MAX_DEVICES];
+  const char **devices = named;
+  char **found = NULL;
+  size_t foundCount = 0;
+  size_t deviceCount = 0, optimized = 0;
+  bool listed = false;
+  int ret = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      options.outDir = argv[++i];
+    } else if (argv[i][0] == '-') {
+      build_dir = NULL;
+      break;
+    } else if (build_dir == NULL) {
+      build_dir = argv[i];
+    } else if (deviceCount < OPTIMIZE_MAX_DEVICES) {
+      named[deviceCount++] = argv[i];
+      listed = true;
+    }
+  }
+  if (build_dir == NULL) {
+    log_warn("Usage: %s [-o <out_dir>] <build_dir> [device...]", argv[0]);
+    ret = -EINVAL;
+    goto out;
+  }
+  if (options.outDir != NULL && mkdir(options.outDir, 0755) != 0 &&
+      !is_directory(options.outDir)) {
+    log_err("Failed to create %s", options.outDir);
+    ret = -EIO;
+    goto out;
+  }
+  if (!listed) {
+    foundCount = list_devices(build_dir, &found);
+    devices = (const char **)found;
+    deviceCount = foundCount;
+  }
+
+  acpi_arena_init(&options.arena, 0);
+  for (size_t i = 0; i < deviceCount; i++) {
+    int deviceRet = optimize_device(&options, build_dir, devices[i]);
+
+    // Devices without a PPTT have nothing to optimize, unless asked for
+    if (deviceRet == -ENOENT && !listed)
+      continue;
+    if (deviceRet == -ENOENT)
+      log_err("No PPTT found under %s/%s", build_dir, devices[i]);
+    if (deviceRet < 0)
+      ret = deviceRet;
+    else
+      optimized++;
+  }
+  acpi_arena_free(&options.arena);
+
+  if (ret == 0 && optimized == 0) {
+    log_err("No PPTT found under %s", build_dir);
+    ret = -ENOENT;
+  } else if (options.failed) {
+    printf(LOG_COLOR_ERROR "[FAIL] %zu of %zu optimized PPTT(s) failed their "
+                           "checks" LOG_COLOR_RESET "\n",
+           options.failed, optimized);
+    if (ret == 0)
+      ret = -EINVAL;
+  } else if (ret == 0) {
+    log_info("%zu PPTT(s) keep their topology, %llu -> %llu bytes (-%.1f%%)",
+             optimized, (unsigned long long)options.sizeBefore,
+             (unsigned long long)options.sizeAfter,
+             100.0 * (options.sizeBefore - options.sizeAfter) /
+                 options.sizeBefore);
+  }
+
+out:
+  free_names(found, foundCount);
+  return ret;
+}
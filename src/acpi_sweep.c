@@ -0,0 +1,472 @@
+/* Generate and validate table variants in-process with libacpigen */
+#include "acpi_topology.h"
+#include "acpi_validate.h"
+#include "acpigen.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/** Usage
+
+  acpi_sweep [-c max_clusters] [-n max_cores_per_cluster] [-r rounds]
+             [-o out_dir] [-i]
+
+  Builds a PPTT, MADT and IORT for every topology of 1..max_clusters
+  clusters of 1..max_cores_per_cluster cores, with and without a shared L3,
+  and runs the acpi_validate checks on each table. The topology Linux
+  derives from the PPTT and MADT (include/acpi_topology.h) must be the one
+  described: private L1 data and instruction caches, an L2 per cluster and
+  the L3 shared by all CPUs. Nothing touches the disk
+  unless -o is given, then variant tables are written to
+  <out_dir>/c<clusters>_n<cores>[_l3][_id]/<TABLE>.aml. rounds repeats the
+  sweep to measure the generation rate.
+
+  -i builds revision 3 PPTTs in which every cache has its own Cache ID, so
+  Linux shares a cache leaf by ID rather than by processor node. The CPUs
+  of a cluster then get their own L1 structures instead of sharing them.
+*/
+
+#define SWEEP_MAX_CORES 64 // Per cluster, MPIDR Aff0 stays below 256
+#define SWEEP_MAX_CLUSTERS 8
+#define SWEEP_MASK_WORDS (SWEEP_MAX_CLUSTERS * SWEEP_MAX_CORES / 64)
+#define SWEEP_MAX_NAME 32
+
+// CacheId follows LineSize in revision 3 cache structures
+#define PPTT_CACHE_ID_OFFSET                                                   \
+  (offsetof(ACPI_PPTT_CACHE_TYPE_STRUCTURE, LineSize) + sizeof(uint16_t))
+
+typedef struct {
+  uint32_t clusters;
+  uint32_t coresPerCluster;
+  bool l3;
+  bool cacheIds;
+} SweepConfig;
+
+typedef struct {
+  size_t variants;
+  size_t tables;
+  size_t bytes;
+  size_t failed;
+} SweepStats;
+
+static ACPI_PPTT_CACHE_TYPE_STRUCTURE cache_of(uint32_t size, uint8_t ways,
+                                               uint8_t type) {
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE cache = {0};
+  cache.Flags = PPTT_CACHE_FLAG_SIZE_PROPERTY_VALID |
+                PPTT_CACHE_FLAG_ASSOCIATIVITY_VALID |
+                PPTT_CACHE_FLAG_CACHE_TYPE_VALID |
+                PPTT_CACHE_FLAG_LINE_SIZE_VALID;
+  cache.Size = size;
+  cache.NumberOfSets = size / 64 / ways;
+  cache.Associativity = ways;
+  cache.Attributes = SET_BITS(PPTT_CACHE_ATTR_CACHE_TYPE_MSK, type);
+  cache.LineSize = 64;
+  return cache;
+}
+
+static const char *variant_name(const SweepConfig *config,
+                                char name[SWEEP_MAX_NAME]) {
+  snprintf(name, SWEEP_MAX_NAME, "c%u_n%u%s%s", config->clusters,
+           config->coresPerCluster, config->l3 ? "_l3" : "",
+           config->cacheIds ? "_id" : "");
+  return name;
+}
+
+/**
+ * Append a cache, as a revision 3 structure with the next Cache ID when the
+ * variant has them.
+ */
+static AcpiGenRef append_cache(AcpiGen *gen, const SweepConfig *config,
+                               const ACPI_PPTT_CACHE_TYPE_STRUCTURE *cache,
+                               uint32_t *last_id) {
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE with_id = *cache;
+  uint8_t entry[PPTT_CACHE_ID_OFFSET + sizeof(uint32_t)];
+
+  if (!config->cacheIds)
+    return acpigen_pptt_cache(gen, cache, ACPIGEN_NO_REF);
+  with_id.Type = 1;
+  with_id.Length = sizeof(entry);
+  with_id.Flags |= PPTT_CACHE_FLAG_CACHE_ID_VALID;
+  ++*last_id;
+  memcpy(entry, &with_id, PPTT_CACHE_ID_OFFSET);
+  memcpy(entry + PPTT_CACHE_ID_OFFSET, last_id, sizeof(*last_id));
+  return acpigen_append(gen, entry, sizeof(entry));
+}
+
+/**
+ * PPTT: system node with the L3, then per cluster a node with its L2, then
+ * the CPUs with their L1 caches. Cluster nodes are referenced before they
+ * exist to use forward references like a top down generator would.
+ *
+ * NextLevelOfCache only links caches private to the same node, as Linux
+ * adds up the levels of every node from the leaf up: an L1 pointing to the
+ * cluster L2 would count that L2 twice (once per core, once as shared).
+ */
+static int build_pptt(AcpiGen *gen, AcpiArena *arena,
+                      const SweepConfig *config) {
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE l1i =
+      cache_of(SIZE_KB(64), 4, PPTT_CACHE_ATTR_CACHE_TYPE_INSTRUCTION);
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE l1d =
+      cache_of(SIZE_KB(64), 4, PPTT_CACHE_ATTR_CACHE_TYPE_DATA);
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE l2 =
+      cache_of(SIZE_MB(1), 8, PPTT_CACHE_ATTR_CACHE_TYPE_UNIFIED);
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE l3 =
+      cache_of(SIZE_MB(8), 16, PPTT_CACHE_ATTR_CACHE_TYPE_UNIFIED);
+  ACPI_PPTT_ID id = {0};
+  AcpiGenRef system, shared, caches[2], resources[2];
+  AcpiGenRef clusters[SWEEP_MAX_CLUSTERS];
+  uint32_t last_id = 0;
+  int ret = config->cacheIds
+                ? acpigen_begin(gen, arena,
+                                (const char[]){ACPI_PPTT_SIGNATURE}, 3, 0)
+                : acpigen_pptt_begin(gen, arena);
+
+  if (ret < 0)
+    return ret;
+  shared = config->l3 ? append_cache(gen, config, &l3, &last_id)
+                      : acpigen_pptt_id(gen, &id);
+  system = acpigen_pptt_processor(gen, PPTT_PROC_FLAG_PHYSICAL_PACKAGE, 0,
+                                  ACPIGEN_NO_REF, &shared, 1);
+
+  for (uint32_t c = 0; c < config->clusters; c++)
+    clusters[c] = acpigen_forward(gen);
+  for (uint32_t c = 0; c < config->clusters; c++) {
+    AcpiGenRef l2_ref = append_cache(gen, config, &l2, &last_id);
+
+    for (uint32_t n = 0; n < config->coresPerCluster; n++) {
+      uint32_t cpu = c * config->coresPerCluster + n;
+
+      // Cores may share L1 structures, the tokens Linux compares are their
+      // own nodes. A Cache ID stands for one cache, so not with IDs.
+      if (n == 0 || config->cacheIds) {
+        caches[0] = append_cache(gen, config, &l1i, &last_id);
+        caches[1] = append_cache(gen, config, &l1d, &last_id);
+      }
+      resources[0] = caches[0];
+      resources[1] = caches[1];
+      acpigen_pptt_processor(
+          gen, PPTT_PROC_FLAG_ACPI_PROC_ID_VALID | PPTT_PROC_FLAG_NODE_IS_LEAF,
+          cpu, clusters[c], resources, 2);
+    }
+    acpigen_bind(gen, clusters[c],
+                 acpigen_pptt_processor(gen, 0, c, system, &l2_ref, 1));
+  }
+  return gen->error;
+}
+
+static int build_madt(AcpiGen *gen, AcpiArena *arena,
+                      const SweepConfig *config) {
+  MADT_GICD_STRUCTURE gicd = {
+      .PhysicalBaseAddress = 0x17000000ULL,
+      .GICVersion = GIC_V3,
+  };
+  MADT_GIC_ITS_STRUCTURE its = {.PhysicalBaseAddress = 0x17040000ULL};
+  int ret = acpigen_madt_begin(gen, arena, 0, 0);
+
+  if (ret < 0)
+    return ret;
+  acpigen_madt_gicd(gen, &gicd);
+  acpigen_madt_gic_its(gen, &its);
+  for (uint32_t c = 0; c < config->clusters; c++) {
+    for (uint32_t n = 0; n < config->coresPerCluster; n++) {
+      uint32_t cpu = c * config->coresPerCluster + n;
+      MADT_GICC_STRUCTURE gicc = {
+          .CPUInterfaceNumber = cpu,
+          .ACPIProcessorUID = cpu,
+          .Flags = MADT_GICC_FLAG_ENABLED,
+          .PerformanceInterruptGSI = GIC_PPI(7),
+          .VGICMaintenanceInterrupt = GIC_PPI(9),
+          .GICRBaseAddress = 0x17080000ULL + 0x40000ULL * cpu,
+          .MPIDR = ((uint64_t)c << 16) | ((uint64_t)n << 8),
+          .ProcessorPowerEfficiencyClass = (uint8_t)c,
+      };
+      acpigen_madt_gicc(gen, &gicc);
+    }
+  }
+  return gen->error;
+}
+
+/**
+ * IORT: root complex -> SMMUv3 -> ITS group. The root complex comes first
+ * and maps to the SMMU through a forward reference.
+ */
+static int build_iort(AcpiGen *gen, AcpiArena *arena) {
+  IORT_PCI_ROOT_COMPLEX_NODE root = {
+      .NodeHeader = {.Type = IORT_NODE_TYPE_ROOT_COMPLEX, .Revision = 4},
+      .MemAccessProps = {.CCA = 1},
+      .MemoryAddressSizeLimit = 48,
+  };
+  IORT_SMMU_V3_NODE smmu = {
+      .NodeHeader = {.Type = IORT_NODE_TYPE_SMMU_V3,
+                     .Revision = 5,
+                     .Identifier = 1},
+      .BaseAddress = 0x15000000ULL,
+      .Flags = IORT_SMMU_V3_COHACC_OVERRIDE,
+  };
+  uint32_t its_id = 0;
+  AcpiGenRef smmu_ref, its_ref;
+  AcpiGenIortMapping mapping = {
+      .inputBase = 0, .numOfIds = 0x10000, .outputBase = 0};
+  int ret = acpigen_iort_begin(gen, arena);
+
+  if (ret < 0)
+    return ret;
+  smmu_ref = acpigen_forward(gen);
+  mapping.output = smmu_ref;
+  acpigen_iort_node(gen, &root, sizeof(root), &mapping, 1);
+  its_ref = acpigen_iort_its_group(gen, 2, &its_id, 1);
+  mapping.output = its_ref;
+  acpigen_bind(gen, smmu_ref,
+               acpigen_iort_node(gen, &smmu, sizeof(smmu), &mapping, 1));
+  return gen->error;
+}
+
+static bool mask_is_range(const AcpiTopology *topology, const uint64_t *mask,
+                          uint32_t first, uint32_t count) {
+  uint64_t expected[SWEEP_MASK_WORDS] = {0};
+
+  for (uint32_t cpu = first; cpu < first + count; cpu++)
+    expected[cpu / 64] |= 1ULL << (cpu % 64);
+  return memcmp(mask, expected, topology->words * sizeof(*mask)) == 0;
+}
+
+/**
+ * Check the cache hierarchy and clusters Linux derives from the tables.
+ *
+ * @retval  Number of problems, the first one of the variant is logged.
+ */
+static size_t check_topology(const SweepConfig *config, const uint8_t *pptt,
+                             size_t pptt_size, const uint8_t *madt,
+                             size_t madt_size) {
+  static const struct {
+    uint8_t level;
+    uint8_t type;
+  } leaves[] = {
+      {1, ACPI_TOPOLOGY_CACHE_DATA},
+      {1, ACPI_TOPOLOGY_CACHE_INSTRUCTION},
+      {2, ACPI_TOPOLOGY_CACHE_UNIFIED},
+      {3, ACPI_TOPOLOGY_CACHE_UNIFIED},
+  };
+  uint32_t cores = config->coresPerCluster;
+  uint32_t cpus = config->clusters * cores;
+  uint32_t leafCount = config->l3 ? 4 : 3;
+  AcpiTopology topology;
+  char problem[ACPI_TOPOLOGY_MESSAGE_SIZE] = "";
+  char name[SWEEP_MAX_NAME];
+  size_t problems = 0;
+
+  if (acpi_topology_simulate(pptt, pptt_size, madt, madt_size, &topology) <
+      0) {
+    log_err("Topology of %s could not be simulated",
+            variant_name(config, name));
+    return 1;
+  }
+  if (topology.cpuCount != cpus) {
+    snprintf(problem, sizeof(problem), "%u CPU(s) instead of %u",
+             topology.cpuCount, cpus);
+    problems++;
+  }
+  for (uint32_t cpu = 0; cpu < topology.cpuCount && problems == 0; cpu++) {
+    const AcpiTopologyCpu *entry = &topology.cpus[cpu];
+    uint32_t cluster = cpu / cores * cores;
+
+    if (!mask_is_range(&topology,
+                       acpi_topology_mask(&topology, cpu,
+                                          ACPI_TOPOLOGY_CLUSTER_CPUS),
+                       cluster, cores)) {
+      snprintf(problem, sizeof(problem), "CPU %u cluster_cpus", cpu);
+      problems++;
+      break;
+    }
+    if (entry->leafCount != leafCount) {
+      snprintf(problem, sizeof(problem), "CPU %u has %u cache leaves, not %u",
+               cpu, entry->leafCount, leafCount);
+      problems++;
+      break;
+    }
+    for (uint32_t leaf = 0; leaf < leafCount; leaf++) {
+      const AcpiTopologyCache *cache = &entry->caches[leaf];
+      uint32_t first = leaf < 2 ? cpu : leaf == 2 ? cluster : 0;
+      uint32_t count = leaf < 2 ? 1 : leaf == 2 ? cores : cpus;
+
+      if (cache->level != leaves[leaf].level ||
+          cache->type != leaves[leaf].type || cache->offset == 0 ||
+          cache->hasCacheId != config->cacheIds ||
+          !mask_is_range(&topology,
+                         acpi_topology_cache_mask(&topology, cpu, leaf),
+                         first, count)) {
+        snprintf(problem, sizeof(problem),
+                 "CPU %u index%u is not the L%u %s cache of CPUs %u-%u", cpu,
+                 leaf, leaves[leaf].level,
+                 acpi_topology_cache_type_names[leaves[leaf].type], first,
+                 first + count - 1);
+        problems++;
+        break;
+      }
+    }
+  }
+  if (problems)
+    log_err("Topology of %s: %s", variant_name(config, name), problem);
+  acpi_topology_free(&topology);
+  return problems;
+}
+
+static int write_table(const char *out_dir, const SweepConfig *config,
+                       const char *name, const uint8_t *table, size_t size) {
+  char path[512];
+  char variant[SWEEP_MAX_NAME];
+  FILE *out;
+  size_t written;
+
+  snprintf(path, sizeof(path), "%s/%s", out_dir,
+           variant_name(config, variant));
+  mkdir(path, 0755);
+  snprintf(path + strlen(path), sizeof(path) - strlen(path), "/%s.aml", name);
+  out = fopen(path, "wb");
+  if (out == NULL) {
+    log_err("Failed to open %s", path);
+    return -EIO;
+  }
+  written = fwrite(table, 1, size, out);
+  if (fclose(out) != 0 || written != size) {
+    log_err("Failed to write %s", path);
+    return -EIO;
+  }
+  return 0;
+}
+
+/**
+ * Build, validate and optionally write the tables of one configuration.
+ *
+ * @retval 0   Success, stats are updated (invalid tables are counted).
+ * @retval <0  A table could not be built or written.
+ */
+static int sweep_variant(AcpiArena *arena, const SweepConfig *config,
+                         const char *out_dir, SweepStats *stats) {
+  static const char *const names[] = {"PPTT", "MADT", "IORT"};
+  static const char *const signatures[] = {"PPTT", "APIC", "IORT"};
+  const uint8_t *pptt = NULL;
+  size_t pptt_size = 0;
+  char variant[SWEEP_MAX_NAME];
+  int ret = 0;
+
+  for (size_t t = 0; t < sizeof(names) / sizeof(names[0]) && ret == 0; t++) {
+    AcpiGen gen;
+    AcpiValidation result;
+    const uint8_t *table;
+    size_t size;
+
+    if (t == 0)
+      ret = build_pptt(&gen, arena, config);
+    else if (t == 1)
+      ret = build_madt(&gen, arena, config);
+    else
+      ret = build_iort(&gen, arena);
+    if (ret == 0)
+      ret = acpigen_finalize(&gen, &table, &size);
+    if (ret < 0) {
+      log_err("Failed to build %s for %s (%d)", names[t],
+              variant_name(config, variant), ret);
+      break;
+    }
+
+    acpi_validate_table(table, size, signatures[t], &result);
+    if (acpi_validation_failed(&result)) {
+      for (int check = 0; check < ACPI_CHECK_COUNT; check++)
+        if (result.status[check] == ACPI_CHECK_FAIL)
+          log_err("%s of %s: %s", names[t], variant_name(config, variant),
+                  result.message[check]);
+      stats->failed++;
+    }
+    // Tables stay in the arena until the variant is done
+    if (t == 0) {
+      pptt = table;
+      pptt_size = size;
+    } else if (t == 1 && check_topology(config, pptt, pptt_size, table, size)) {
+      stats->failed++;
+    }
+    stats->tables++;
+    stats->bytes += size;
+    if (out_dir != NULL)
+      ret = write_table(out_dir, config, names[t], table, size);
+  }
+
+  stats->variants++;
+  acpi_arena_reset(arena);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  uint32_t max_clusters = 4;
+  uint32_t max_cores = 16;
+  long rounds = 1;
+  const char *out_dir = NULL;
+  bool cache_ids = false;
+  SweepStats stats = {0};
+  AcpiArena arena;
+  struct timespec start;
+  double total_ms;
+  int ret = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+      max_clusters = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+      max_cores = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+      rounds = strtol(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+      out_dir = argv[++i];
+    } else if (strcmp(argv[i], "-i") == 0) {
+      cache_ids = true;
+    } else {
+      log_warn("Usage: %s [-c max_clusters] [-n max_cores_per_cluster] "
+               "[-r rounds] [-o out_dir] [-i]",
+               argv[0]);
+      return -EINVAL;
+    }
+  }
+  if (max_clusters < 1 || max_clusters > SWEEP_MAX_CLUSTERS || max_cores < 1 ||
+      max_cores > SWEEP_MAX_CORES || rounds < 1) {
+    log_err("Clusters must be 1..8, cores per cluster 1..%d, rounds >= 1",
+            SWEEP_MAX_CORES);
+    return -EINVAL;
+  }
+  if (out_dir != NULL && mkdir(out_dir, 0755) != 0 && !is_directory(out_dir)) {
+    log_err("Failed to create %s", out_dir);
+    return -EIO;
+  }
+
+  acpi_arena_init(&arena, 0);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long round = 0; round < rounds && ret == 0; round++) {
+    for (uint32_t c = 1; c <= max_clusters && ret == 0; c++) {
+      for (uint32_t n = 1; n <= max_cores && ret == 0; n++) {
+        for (int l3 = 0; l3 <= 1 && ret == 0; l3++) {
+          SweepConfig config = {c, n, l3 != 0, cache_ids};
+          ret = sweep_variant(&arena, &config,
+                              round == 0 ? out_dir : NULL, &stats);
+        }
+      }
+    }
+  }
+  total_ms = elapsed_ms(&start);
+  acpi_arena_free(&arena);
+  if (ret < 0)
+    return ret;
+
+  if (stats.failed) {
+    printf(LOG_COLOR_ERROR "[FAIL] %zu of %zu table(s) failed their checks"
+                           LOG_COLOR_RESET "\n",
+           stats.failed, stats.tables);
+    return -EINVAL;
+  }
+  log_info("%zu variant(s), %zu table(s), %zu bytes in %.2f ms "
+           "(%.0f variants/s), all valid",
+           stats.variants, stats.tables, stats.bytes, total_ms,
+           total_ms > 0 ? stats.variants * 1000.0 / total_ms : 0.0);
+  return 0;
+}
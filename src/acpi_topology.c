@@ -0,0 +1,464 @@
+/* CPU and cache topology Linux derives from the PPTT and MADT of a build */
+#include "acpi_topology.h"
+#include "fdt.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Usage
+
+  acpi_topology [-q] [--json <file>] [--dtb <dtb>] <build_dir> [device...]
+
+  For every <build_dir>/<device> with a PPTT (or the given devices), prints
+  what an arm64 kernel would make of the MADT and PPTT, see
+  include/acpi_topology.h:
+
+    - per CPU: UID, MPIDR, GICC efficiency class, package/cluster/core/
+      thread IDs and the thread_siblings, core_siblings, cluster_cpus,
+      llc_siblings, coregroup (MC) and clustergroup (CLS) CPU lists
+    - per cache leaf (cpuN/cache/indexM): level, type and shared_cpu_list,
+      with a CPU x CPU sharing matrix
+    - capacity classes by GICC efficiency class
+    - what the kernel would warn about
+
+  -q prints the summary and the warnings only. --json writes the same data
+  for every device. --dtb compares one device with the topology Linux reads
+  from a device tree (/cpus/cpu-map and next-level-cache chains): every
+  mask or cache that differs is a failure.
+*/
+
+#define TOPOLOGY_MAX_NAME 256
+#define TOPOLOGY_LIST_SIZE 256
+#define TOPOLOGY_MAX_DEVICES 256
+#define SCHED_CAPACITY_SCALE 1024 // Every CPU without _CPC
+
+typedef struct {
+  bool quiet;
+  FILE *json;
+  bool jsonFirst;
+  const char *dtb;
+  size_t differences;
+} TopologyOptions;
+
+static const FileContent *find_table(const FileContent *tables, size_t count,
+                                     const char *signature) {
+  for (size_t i = 0; i < count; i++) {
+    if (tables[i].fileSize >= 4 &&
+        memcmp(tables[i].fileBuffer, signature, 4) == 0)
+      return &tables[i];
+  }
+  return NULL;
+}
+
+static const char *format_id(int64_t id, char *buffer, size_t size) {
+  if (id == ACPI_TOPOLOGY_NO_ID)
+    snprintf(buffer, size, "-");
+  else
+    snprintf(buffer, size, "%lld", (long long)id);
+  return buffer;
+}
+
+static void print_cpus(const AcpiTopology *topology) {
+  char ids[4][24];
+
+  printf("  cpu   uid  mpidr         class  package  cluster  core  "
+         "thread\n");
+  for (uint32_t i = 0; i < topology->cpuCount; i++) {
+    const AcpiTopologyCpu *cpu = &topology->cpus[i];
+    printf("  %-4u  %-3u  0x%-10llX  %-5u  %-7s  %-7s  %-4s  %s\n", i,
+           cpu->uid, (unsigned long long)cpu->mpidr, cpu->efficiencyClass,
+           format_id(cpu->packageId, ids[0], sizeof(ids[0])),
+           format_id(cpu->clusterId, ids[1], sizeof(ids[1])),
+           format_id(cpu->coreId, ids[2], sizeof(ids[2])),
+           format_id(cpu->threadId, ids[3], sizeof(ids[3])));
+  }
+
+  printf("  cpu ");
+  for (int mask = 0; mask < ACPI_TOPOLOGY_MASK_COUNT; mask++)
+    printf("  %-15s", acpi_topology_mask_names[mask]);
+  printf("\n");
+  for (uint32_t i = 0; i < topology->cpuCount; i++) {
+    printf("  %-4u", i);
+    for (int mask = 0; mask < ACPI_TOPOLOGY_MASK_COUNT; mask++) {
+      char list[TOPOLOGY_LIST_SIZE];
+      acpi_topology_format_list(topology,
+                                acpi_topology_mask(topology, i, mask), list,
+                                sizeof(list));
+      printf("  %-15s", list);
+    }
+    printf("\n");
+  }
+}
+
+// One matrix per cache leaf index, rows are the CPUs having that leaf
+static void print_caches(const AcpiTopology *topology) {
+  uint32_t leaves = 0;
+
+  for (uint32_t i = 0; i < topology->cpuCount; i++) {
+    if (topology->cpus[i].leafCount > leaves)
+      leaves = topology->cpus[i].leafCount;
+  }
+  for (uint32_t leaf = 0; leaf < leaves; leaf++) {
+    const AcpiTopologyCache *first = NULL;
+
+    for (uint32_t i = 0; i < topology->cpuCount && first == NULL; i++) {
+      if (leaf < topology->cpus[i].leafCount)
+        first = &topology->cpus[i].caches[leaf];
+    }
+    printf("  index%u: L%u %s\n       ", leaf, first->level,
+           acpi_topology_cache_type_names[first->type]);
+    for (uint32_t j = 0; j < topology->cpuCount; j++)
+      printf("%3u", j);
+    printf("  shared_cpu_list\n");
+
+    for (uint32_t i = 0; i < topology->cpuCount; i++) {
+      const AcpiTopologyCpu *cpu = &topology->cpus[i];
+      const uint64_t *mask;
+      char list[TOPOLOGY_LIST_SIZE];
+
+      if (leaf >= cpu->leafCount)
+        continue;
+      mask = acpi_topology_cache_mask(topology, i, leaf);
+      printf("  cpu%-3u", i);
+      for (uint32_t j = 0; j < topology->cpuCount; j++)
+        printf("%3s", (mask[j / 64] >> (j % 64)) & 1 ? "x" : ".");
+      acpi_topology_format_list(topology, mask, list, sizeof(list));
+      if (cpu->caches[leaf].level != first->level ||
+          cpu->caches[leaf].type != first->type)
+        printf("  %s (L%u %s)\n", list, cpu->caches[leaf].level,
+               acpi_topology_cache_type_names[cpu->caches[leaf].type]);
+      else if (cpu->caches[leaf].offset == 0)
+        printf("  %s (no PPTT cache)\n", list);
+      else
+        printf("  %s\n", list);
+    }
+  }
+}
+
+/**
+ * Efficiency classes of the CPUs, in increasing order.
+ *
+ * @retval  Number of classes.
+ */
+static uint32_t capacity_classes(const AcpiTopology *topology,
+                                 uint8_t classes[256]) {
+  bool seen[256] = {false};
+  uint32_t count = 0;
+
+  for (uint32_t i = 0; i < topology->cpuCount; i++)
+    seen[topology->cpus[i].efficiencyClass] = true;
+  for (uint32_t value = 0; value < 256; value++) {
+    if (seen[value])
+      classes[count++] = (uint8_t)value;
+  }
+  return count;
+}
+
+static void class_mask(const AcpiTopology *topology, uint8_t value,
+                       uint64_t *mask) {
+  memset(mask, 0, topology->words * sizeof(uint64_t));
+  for (uint32_t i = 0; i < topology->cpuCount; i++) {
+    if (topology->cpus[i].efficiencyClass == value)
+      mask[i / 64] |= 1ULL << (i % 64);
+  }
+}
+
+static void print_capacity(const AcpiTopology *topology, uint64_t *scratch) {
+  uint8_t classes[256];
+  uint32_t count = capacity_classes(topology, classes);
+
+  printf("  capacity %u on every CPU (no _CPC), GICC efficiency classes:",
+         SCHED_CAPACITY_SCALE);
+  for (uint32_t c = 0; c < count; c++) {
+    char list[TOPOLOGY_LIST_SIZE];
+    class_mask(topology, classes[c], scratch);
+    acpi_topology_format_list(topology, scratch, list, sizeof(list));
+    printf("%s %u: %s", c ? "," : "", classes[c], list);
+  }
+  printf("\n");
+}
+
+static void json_string(FILE *out, const char *text) {
+  fputc('"', out);
+  for (; *text; text++) {
+    if (*text == '"' || *text == '\\')
+      fprintf(out, "\\%c", *text);
+    else if ((unsigned char)*text < 0x20)
+      fprintf(out, "\\u%04x", *text);
+    else
+      fputc(*text, out);
+  }
+  fputc('"', out);
+}
+
+static void json_id(FILE *out, const char *name, int64_t id) {
+  if (id == ACPI_TOPOLOGY_NO_ID)
+    fprintf(out, ", \"%s\": null", name);
+  else
+    fprintf(out, ", \"%s\": %lld", name, (long long)id);
+}
+
+static void json_list(FILE *out, const AcpiTopology *topology,
+                      const char *name, const uint64_t *mask) {
+  char list[TOPOLOGY_LIST_SIZE];
+
+  acpi_topology_format_list(topology, mask, list, sizeof(list));
+  fprintf(out, ", \"%s_list\": \"%s\"", name, list);
+}
+
+static void write_json(TopologyOptions *options, const char *device,
+                       const AcpiTopology *topology, uint64_t *scratch) {
+  FILE *out = options->json;
+  uint8_t classes[256];
+  uint32_t classCount = capacity_classes(topology, classes);
+
+  fprintf(out, "%s\n    {\"device\": ", options->jsonFirst ? "" : ",");
+  options->jsonFirst = false;
+  json_string(out, device);
+  fprintf(out, ", \"source\": \"%s\", \"pptt_revision\": %u,\n",
+          topology->hasMpidr ? "MADT+PPTT" : "PPTT", topology->ppttRevision);
+  fprintf(out, "     \"cpus\": [");
+  for (uint32_t i = 0; i < topology->cpuCount; i++) {
+    const AcpiTopologyCpu *cpu = &topology->cpus[i];
+
+    fprintf(out,
+            "%s\n      {\"cpu\": %u, \"uid\": %u, \"mpidr\": \"0x%llX\", "
+            "\"efficiency_class\": %u",
+            i ? "," : "", i, cpu->uid, (unsigned long long)cpu->mpidr,
+            cpu->efficiencyClass);
+    json_id(out, "physical_package_id", cpu->packageId);
+    json_id(out, "cluster_id", cpu->clusterId);
+    json_id(out, "core_id", cpu->coreId);
+    json_id(out, "thread_id", cpu->threadId);
+    for (int mask = 0; mask < ACPI_TOPOLOGY_MASK_COUNT; mask++)
+      json_list(out, topology, acpi_topology_mask_names[mask],
+                acpi_topology_mask(topology, i, mask));
+    fprintf(out, ",\n       \"caches\": [");
+    for (uint32_t leaf = 0; leaf < cpu->leafCount; leaf++) {
+      const AcpiTopologyCache *cache = &cpu->caches[leaf];
+      fprintf(out,
+              "%s{\"index\": %u, \"level\": %u, \"type\": \"%s\", "
+              "\"pptt_offset\": %u, \"size\": %u, \"ways\": %u, \"sets\": "
+              "%u, \"line_size\": %u",
+              leaf ? ", " : "", leaf, cache->level,
+              acpi_topology_cache_type_names[cache->type], cache->offset,
+              cache->size, cache->ways, cache->sets, cache->lineSize);
+      json_list(out, topology, "shared_cpu",
+                acpi_topology_cache_mask(topology, i, leaf));
+      fprintf(out, "}");
+    }
+    fprintf(out, "]}");
+  }
+  fprintf(out, "],\n     \"capacity_classes\": [");
+  for (uint32_t c = 0; c < classCount; c++) {
+    fprintf(out, "%s{\"efficiency_class\": %u, \"capacity\": %u",
+            c ? ", " : "", classes[c], SCHED_CAPACITY_SCALE);
+    class_mask(topology, classes[c], scratch);
+    json_list(out, topology, "cpus", scratch);
+    fprintf(out, "}");
+  }
+  fprintf(out, "],\n     \"notes\": [");
+  for (size_t n = 0; n < topology->noteCount; n++) {
+    fprintf(out, "%s", n ? ", " : "");
+    json_string(out, topology->notes[n].message);
+  }
+  fprintf(out, "]}");
+}
+
+static void report_difference(const char *message, void *context) {
+  const char *device = context;
+  printf(LOG_COLOR_ERROR "[FAIL] %s: %s" LOG_COLOR_RESET "\n", device,
+         message);
+}
+
+static int compare_dtb(TopologyOptions *options, const char *device,
+                       const AcpiTopology *topology) {
+  AcpiTopology expected;
+  FdtTree tree;
+  size_t differences;
+  int ret;
+
+  ret = fdt_open(&tree, options->dtb);
+  if (ret < 0) {
+    log_err("Failed to read %s (%d)", options->dtb, ret);
+    return ret;
+  }
+  ret = acpi_topology_from_dtb(&tree, &expected);
+  if (ret < 0) {
+    log_err("No CPU topology in %s (%d)", options->dtb, ret);
+    fdt_close(&tree);
+    return ret;
+  }
+  for (size_t n = 0; n < expected.noteCount; n++)
+    log_warn("%s: %s", options->dtb, expected.notes[n].message);
+
+  differences = acpi_topology_diff(topology, &expected, report_difference,
+                                   (void *)device);
+  if (differences == 0)
+    log_info("%s: topology matches %s (%u CPU(s))", device, options->dtb,
+             expected.cpuCount);
+  options->differences += differences;
+  acpi_topology_free(&expected);
+  fdt_close(&tree);
+  return 0;
+}
+
+/**
+ * Simulate and print one device.
+ *
+ * @retval 0        Done.
+ * @retval -ENOENT  The device has no PPTT.
+ * @retval <0       Tables could not be read or are malformed.
+ */
+static int show_device(TopologyOptions *options, const char *build_dir,
+                       const char *device) {
+  char dir[TOPOLOGY_MAX_NAME * 2];
+  FileContent *tables = NULL;
+  const FileContent *pptt, *madt;
+  AcpiTopology topology;
+  uint64_t *scratch = NULL;
+  size_t count = 0;
+  int ret;
+
+  snprintf(dir, sizeof(dir), "%s/%s", build_dir, device);
+  ret = read_table_directory(dir, &tables, &count);
+  if (ret < 0)
+    return ret;
+  pptt = find_table(tables, count, "PPTT");
+  madt = find_table(tables, count, "APIC");
+  if (pptt == NULL) {
+    free_table_directory(tables, count);
+    return -ENOENT;
+  }
+
+  ret = acpi_topology_simulate(pptt->fileBuffer, pptt->fileSize,
+                               madt ? madt->fileBuffer : NULL,
+                               madt ? madt->fileSize : 0, &topology);
+  if (ret < 0) {
+    log_err("Failed to simulate the topology of %s (%d)", device, ret);
+    goto out;
+  }
+  scratch = calloc(topology.words, sizeof(uint64_t));
+  if (scratch == NULL) {
+    ret = -ENOMEM;
+    goto out_topology;
+  }
+
+  log_info("%s: %u CPU(s) from %s, PPTT revision %u", device,
+           topology.cpuCount, madt ? "MADT" : "PPTT leaves",
+           topology.ppttRevision);
+  for (size_t n = 0; n < topology.noteCount; n++)
+    log_warn("%s: %s", device, topology.notes[n].message);
+  if (!options->quiet) {
+    print_cpus(&topology);
+    print_caches(&topology);
+    print_capacity(&topology, scratch);
+  }
+  if (options->json != NULL)
+    write_json(options, device, &topology, scratch);
+  if (options->dtb != NULL)
+    ret = compare_dtb(options, device, &topology);
+
+out_topology:
+  free(scratch);
+  acpi_topology_free(&topology);
+out:
+  free_table_directory(tables, count);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  TopologyOptions options = {.jsonFirst = true};
+  const char *json = NULL, *build_dir = NULL;
+  const char *named[TOPOLOGY_MAX_DEVICES];
+  const char **devices = named;
+  char **found = NULL;
+  size_t foundCount = 0;
+  size_t deviceCount = 0, shown = 0;
+  bool listed = false;
+  int ret = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-q") == 0) {
+      options.quiet = true;
+    } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json = argv[++i];
+    } else if (strcmp(argv[i], "--dtb") == 0 && i + 1 < argc) {
+      options.dtb = argv[++i];
+    } else if (argv[i][0] == '-') {
+      build_dir = NULL;
+      break;
+    } else if (build_dir == NULL) {
+      build_dir = argv[i];
+    } else if (deviceCount < TOPOLOGY_MAX_DEVICES) {
+      named[deviceCount++] = argv[i];
+      listed = true;
+    }
+  }
+  if (build_dir == NULL || (options.dtb != NULL && deviceCount != 1)) {
+    log_warn("Usage: %s [-q] [--json <file>] [--dtb <dtb>] <build_dir> "
+             "[device...]",
+             argv[0]);
+    log_warn("--dtb compares exactly one device");
+    ret = -EINVAL;
+    goto out;
+  }
+  if (!listed) {
+    foundCount = list_devices(build_dir, &found);
+    devices = (const char **)found;
+    deviceCount = foundCount;
+  }
+
+  if (json != NULL) {
+    options.json = fopen(json, "w");
+    if (options.json == NULL) {
+      log_err("Failed to open %s", json);
+      ret = -EIO;
+      goto out;
+    }
+    fprintf(options.json, "{\n  \"devices\": [");
+  }
+
+  for (size_t i = 0; i < deviceCount; i++) {
+    int deviceRet = show_device(&options, build_dir, devices[i]);
+
+    // Devices without a PPTT have no topology, unless asked for
+    if (deviceRet == -ENOENT && !listed)
+      continue;
+    if (deviceRet == -ENOENT)
+      log_err("No PPTT found under %s/%s", build_dir, devices[i]);
+    if (deviceRet < 0)
+      ret = deviceRet;
+    else
+      shown++;
+  }
+
+  if (options.json != NULL) {
+    fprintf(options.json, "\n  ]\n}\n");
+    if (fclose(options.json) != 0) {
+      log_err("Failed to write %s", json);
+      ret = -EIO;
+    }
+  }
+  if (ret == 0 && shown == 0) {
+    log_err("No PPTT found under %s", build_dir);
+    ret = -ENOENT;
+  }
+  if (options.differences) {
+    printf(LOG_COLOR_ERROR "[FAIL] %zu topology difference(s) with %s"
+                           LOG_COLOR_RESET "\n",
+           options.differences, options.dtb);
+    if (ret == 0)
+      ret = -EINVAL;
+  } else if (ret == 0) {
+    log_info("Simulated %zu device topolog%s%s%s", shown,
+             shown == 1 ? "y" : "ies", json ? ", wrote " : "",
+             json ? json : "");
+  }
+
+out:
+  free_names(found, foundCount);
+  return ret;
+}
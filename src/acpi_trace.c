@@ -0,0 +1,101 @@
+/* Run one build step and record it as a pipeline stage span */
+#include "trace.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/** Usage
+
+  acpi_trace [-f trace_file] -s stage [-d device] [-t table]
+             [-b bytes_of] -- command [args...]
+
+  Runs command with $ACPI_TRACE_FILE set to trace_file, so the tools it
+  starts add their own spans, then appends one span with tool "run" for
+  the whole command. bytes is the size of bytes_of after the command, e.g.
+  the AML or DSL file it produced. The exit status is the command's.
+
+  CMake uses it as compile and archive launcher of the table libraries and
+  to wrap the extract, disassemble and validation commands when configured
+  with -DACPI_TRACE=ON. Without -f and $ACPI_TRACE_FILE the command is run
+  untraced.
+*/
+
+int main(int argc, char **argv) {
+  const char *file = NULL;
+  const char *stage = NULL;
+  const char *device = NULL;
+  const char *table = NULL;
+  const char *bytes_of = NULL;
+  char **command = NULL;
+  struct stat info;
+  uint64_t bytes = 0;
+  TraceSpan span;
+  pid_t child;
+  int status;
+  int ret;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--") == 0) {
+      command = &argv[i + 1];
+      break;
+    } else if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+      file = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+      stage = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+      device = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+      table = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+      bytes_of = argv[++i];
+    } else {
+      break;
+    }
+  }
+  if (stage == NULL || command == NULL || command[0] == NULL) {
+    log_warn("Usage: %s [-f trace_file] -s stage [-d device] [-t table] "
+             "[-b bytes_of] -- command [args...]",
+             argv[0]);
+    return -EINVAL;
+  }
+
+  if (file != NULL && setenv(TRACE_FILE_ENV, file, 1) != 0) {
+    log_err("Failed to set %s", TRACE_FILE_ENV);
+    return -ENOMEM;
+  }
+
+  trace_begin(&span);
+  child = fork();
+  if (child < 0) {
+    log_err("Failed to fork for %s", command[0]);
+    return -EIO;
+  }
+  if (child == 0) {
+    execvp(command[0], command);
+    log_err("Failed to run %s: %s", command[0], strerror(errno));
+    fflush(stdout);
+    _exit(127);
+  }
+  while (waitpid(child, &status, 0) < 0) {
+    if (errno != EINTR) {
+      log_err("Failed to wait for %s", command[0]);
+      return -EIO;
+    }
+  }
+  trace_end(&span);
+
+  if (bytes_of != NULL && stat(bytes_of, &info) == 0)
+    bytes = (uint64_t)info.st_size;
+  ret = trace_write(&span, "run", device, table, stage, bytes);
+  if (ret < 0)
+    log_warn("Failed to append to %s", getenv(TRACE_FILE_ENV));
+
+  if (WIFEXITED(status))
+    return WEXITSTATUS(status);
+  return 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+}
@@ -0,0 +1,408 @@
+/* Validate every built table natively, in parallel, with JUnit/JSON reports */
+#include "acpi_validate.h"
+#include "trace.h"
+#include "utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Usage
+
+  acpi_validate [-j jobs] [--junit file] [--json file] <build_dir>
+
+  Every <build_dir>/<device>/<TABLE>.aml is loaded and goes through the
+  checks of lib/acpi_validate.c. Tables are validated by a pool of threads,
+  results are reported in a stable (device, file) order. JUnit reports one
+  test case per table and check so CI shows which check broke.
+*/
+
+#define VALIDATE_MAX_NAME 256
+#define VALIDATE_MAX_JOBS 64
+
+typedef struct {
+  char device[VALIDATE_MAX_NAME];
+  char file[VALIDATE_MAX_NAME];
+  char path[VALIDATE_MAX_NAME * 3];
+  char signature[5]; // Read from the table
+  size_t size;
+  bool readFailed;
+  double timeMs;
+  AcpiValidation result;
+} ValidateJob;
+
+typedef struct {
+  ValidateJob *jobs;
+  size_t count;
+  atomic_size_t next;
+} ValidateQueue;
+
+/**
+ * Collect every <build_dir>/<device>/<TABLE>.aml, skipping CMake internals.
+ *
+ * @retval  Number of tables found, jobs is allocated by this function.
+ */
+static size_t discover_tables(const char *build_dir, ValidateJob **jobs) {
+  char **devices = NULL;
+  size_t deviceCount = list_names(build_dir, NULL, &devices);
+  size_t count = 0;
+
+  *jobs = NULL;
+  for (size_t d = 0; d < deviceCount; d++) {
+    char dir[VALIDATE_MAX_NAME * 2];
+    char **files = NULL;
+    size_t fileCount;
+
+    if (strcmp(devices[d], "CMakeFiles") == 0)
+      continue;
+    snprintf(dir, sizeof(dir), "%s/%s", build_dir, devices[d]);
+    if (!is_directory(dir))
+      continue;
+
+    fileCount = list_names(dir, ".aml", &files);
+    for (size_t f = 0; f < fileCount; f++) {
+      ValidateJob *grown = realloc(*jobs, (count + 1) * sizeof(**jobs));
+      if (grown == NULL)
+        break;
+      *jobs = grown;
+      memset(&grown[count], 0, sizeof(grown[count]));
+      memcpy(grown[count].device, devices[d], strlen(devices[d]) + 1);
+      memcpy(grown[count].file, files[f], strlen(files[f]) + 1);
+      snprintf(grown[count].path, sizeof(grown[count].path), "%s/%s", dir,
+               files[f]);
+      count++;
+    }
+    free_names(files, fileCount);
+  }
+
+  free_names(devices, deviceCount);
+  return count;
+}
+
+static void run_job(ValidateJob *job) {
+  struct timespec start;
+  TraceSpan span;
+  char expected[5] = {0};
+  FILE *file;
+  uint8_t *buffer;
+  long size;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  trace_begin(&span);
+  file = fopen(job->path, "rb");
+  if (file == NULL || fseek(file, 0, SEEK_END) != 0 ||
+      (size = ftell(file)) < 0) {
+    if (file)
+      fclose(file);
+    job->readFailed = true;
+    return;
+  }
+  rewind(file);
+  buffer = malloc(size ? (size_t)size : 1);
+  if (buffer == NULL || fread(buffer, 1, size, file) != (size_t)size) {
+    fclose(file);
+    free(buffer);
+    job->readFailed = true;
+    return;
+  }
+  fclose(file);
+
+  // PPTT.aml -> "PPTT", only four character names map to a signature
+  if (strlen(job->file) == 8)
+    memcpy(expected, job->file, 4);
+  job->size = size;
+  if (size >= 4)
+    memcpy(job->signature, buffer, 4);
+  acpi_validate_table(buffer, size, expected[0] ? expected : NULL,
+                      &job->result);
+  free(buffer);
+  job->timeMs = elapsed_ms(&start);
+  trace_end(&span);
+  trace_write(&span, "acpi_validate", job->device, job->signature, "validate",
+              job->size);
+}
+
+static void *worker(void *context) {
+  ValidateQueue *queue = context;
+  size_t index;
+
+  while ((index = atomic_fetch_add(&queue->next, 1)) < queue->count)
+    run_job(&queue->jobs[index]);
+  return NULL;
+}
+
+static bool job_failed(const ValidateJob *job) {
+  return job->readFailed || acpi_validation_failed(&job->result);
+}
+
+static bool job_warned(const ValidateJob *job) {
+  for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+    if (job->result.status[check] == ACPI_CHECK_WARN)
+      return true;
+  }
+  return false;
+}
+
+static void print_job(const ValidateJob *job) {
+  if (job->readFailed) {
+    printf(LOG_COLOR_ERROR "[FAIL] %s/%s: cannot read file" LOG_COLOR_RESET
+                           "\n",
+           job->device, job->file);
+    return;
+  }
+
+  for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+    if (job->result.status[check] == ACPI_CHECK_FAIL)
+      printf(LOG_COLOR_ERROR "[FAIL] %s/%s: %s: %s" LOG_COLOR_RESET "\n",
+             job->device, job->file, acpi_check_names[check],
+             job->result.message[check]);
+    else if (job->result.status[check] == ACPI_CHECK_WARN)
+      log_warn("%s/%s: %s: %s", job->device, job->file,
+               acpi_check_names[check], job->result.message[check]);
+  }
+  if (!job_failed(job))
+    log_info("%s/%s: %zu bytes, %u subtables, %u references OK", job->device,
+             job->file, job->size, job->result.subtableCount,
+             job->result.referenceCount);
+}
+
+// Escape for both XML attributes and JSON strings
+static void write_escaped(FILE *out, const char *text, bool xml) {
+  for (; *text; text++) {
+    switch (*text) {
+    case '&':
+      fputs(xml ? "&amp;" : "&", out);
+      break;
+    case '<':
+      fputs(xml ? "&lt;" : "<", out);
+      break;
+    case '>':
+      fputs(xml ? "&gt;" : ">", out);
+      break;
+    case '"':
+      fputs(xml ? "&quot;" : "\\\"", out);
+      break;
+    case '\\':
+      fputs(xml ? "\\" : "\\\\", out);
+      break;
+    default:
+      if ((unsigned char)*text < 0x20)
+        fprintf(out, xml ? "&#%d;" : "\\u%04x", *text);
+      else
+        fputc(*text, out);
+    }
+  }
+}
+
+static int write_junit(const char *path, const ValidateJob *jobs, size_t count,
+                       double total_ms) {
+  FILE *out = fopen(path, "w");
+  size_t failures = 0;
+
+  if (out == NULL) {
+    log_err("Failed to open %s", path);
+    return -EIO;
+  }
+  for (size_t i = 0; i < count; i++) {
+    for (int check = 0; check < ACPI_CHECK_COUNT; check++)
+      failures += jobs[i].readFailed ||
+                  jobs[i].result.status[check] == ACPI_CHECK_FAIL;
+  }
+
+  fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+  fprintf(out,
+          "<testsuites name=\"acpi_validate\" tests=\"%zu\" failures=\"%zu\" "
+          "time=\"%.6f\">\n",
+          count * ACPI_CHECK_COUNT, failures, total_ms / 1000.0);
+
+  // Jobs are sorted by device, one test suite per device
+  for (size_t start = 0; start < count;) {
+    size_t end = start;
+    size_t suiteFailures = 0, suiteSkipped = 0;
+
+    while (end < count && strcmp(jobs[end].device, jobs[start].device) == 0) {
+      for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+        suiteFailures += jobs[end].readFailed ||
+                         jobs[end].result.status[check] == ACPI_CHECK_FAIL;
+        suiteSkipped += !jobs[end].readFailed &&
+                        jobs[end].result.status[check] == ACPI_CHECK_SKIP;
+      }
+      end++;
+    }
+
+    fprintf(out,
+            "  <testsuite name=\"%s\" tests=\"%zu\" failures=\"%zu\" "
+            "skipped=\"%zu\">\n",
+            jobs[start].device, (end - start) * ACPI_CHECK_COUNT,
+            suiteFailures, suiteSkipped);
+    for (size_t i = start; i < end; i++) {
+      const ValidateJob *job = &jobs[i];
+      for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+        uint8_t status = job->result.status[check];
+
+        fprintf(out,
+                "    <testcase classname=\"%s.%s\" name=\"%s\" "
+                "time=\"%.6f\"",
+                job->device, job->file, acpi_check_names[check],
+                job->timeMs / 1000.0 / ACPI_CHECK_COUNT);
+        if (job->readFailed) {
+          fprintf(out, ">\n      <failure message=\"cannot read file\"/>\n"
+                       "    </testcase>\n");
+        } else if (status == ACPI_CHECK_PASS) {
+          fprintf(out, "/>\n");
+        } else if (status == ACPI_CHECK_WARN) {
+          // Warnings pass, keep the message visible in the report
+          fprintf(out, ">\n      <system-out>");
+          write_escaped(out, job->result.message[check], true);
+          fprintf(out, "</system-out>\n    </testcase>\n");
+        } else {
+          fprintf(out, ">\n      <%s message=\"",
+                  status == ACPI_CHECK_FAIL ? "failure" : "skipped");
+          write_escaped(out, job->result.message[check], true);
+          fprintf(out, "\"/>\n    </testcase>\n");
+        }
+      }
+    }
+    fprintf(out, "  </testsuite>\n");
+    start = end;
+  }
+
+  fprintf(out, "</testsuites>\n");
+  fclose(out);
+  return 0;
+}
+
+static int write_json(const char *path, const ValidateJob *jobs, size_t count,
+                      size_t failed, size_t warned, double total_ms) {
+  FILE *out = fopen(path, "w");
+
+  if (out == NULL) {
+    log_err("Failed to open %s", path);
+    return -EIO;
+  }
+
+  fprintf(out, "{\n  \"tables\": [\n");
+  for (size_t i = 0; i < count; i++) {
+    const ValidateJob *job = &jobs[i];
+
+    fprintf(out, "    {\"device\": \"");
+    write_escaped(out, job->device, false);
+    fprintf(out, "\", \"file\": \"");
+    write_escaped(out, job->file, false);
+    fprintf(out, "\", \"signature\": \"");
+    write_escaped(out, job->signature, false);
+    fprintf(out,
+            "\", \"size\": %zu, \"subtables\": %u, \"references\": %u, "
+            "\"passed\": %s, \"checks\": {",
+            job->size, job->result.subtableCount, job->result.referenceCount,
+            job_failed(job) ? "false" : "true");
+    for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+      fprintf(out, "%s\"%s\": {\"status\": \"%s\", \"message\": \"",
+              check ? ", " : "", acpi_check_names[check],
+              job->readFailed
+                  ? "fail"
+                  : acpi_check_status_names[job->result.status[check]]);
+      write_escaped(out,
+                    job->readFailed ? "cannot read file"
+                                    : job->result.message[check],
+                    false);
+      fprintf(out, "\"}");
+    }
+    fprintf(out, "}}%s\n", i + 1 < count ? "," : "");
+  }
+  fprintf(out,
+          "  ],\n  \"summary\": {\"tables\": %zu, \"failed\": %zu, "
+          "\"warnings\": %zu, \"time_ms\": %.3f}\n}\n",
+          count, failed, warned, total_ms);
+  fclose(out);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *junit = NULL;
+  const char *json = NULL;
+  const char *build_dir = NULL;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  pthread_t threads[VALIDATE_MAX_JOBS];
+  ValidateQueue queue = {0};
+  struct timespec start;
+  size_t failed = 0, warned = 0;
+  double total_ms;
+  bool usage = false;
+  int ret = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+      jobs = strtol(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "--junit") == 0 && i + 1 < argc)
+      junit = argv[++i];
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+      json = argv[++i];
+    else if (build_dir == NULL && argv[i][0] != '-')
+      build_dir = argv[i];
+    else
+      usage = true;
+  }
+  if (usage || build_dir == NULL) {
+    log_warn("Usage: %s [-j jobs] [--junit file] [--json file] <build_dir>",
+             argv[0]);
+    return -EINVAL;
+  }
+  if (!is_directory(build_dir)) {
+    log_err("Build directory %s not found", build_dir);
+    return -ENOENT;
+  }
+  if (jobs < 1)
+    jobs = 1;
+  if (jobs > VALIDATE_MAX_JOBS)
+    jobs = VALIDATE_MAX_JOBS;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  queue.count = discover_tables(build_dir, &queue.jobs);
+  if (queue.count == 0) {
+    log_err("No tables found under %s", build_dir);
+    return -ENOENT;
+  }
+  if ((size_t)jobs > queue.count)
+    jobs = queue.count;
+
+  // The calling thread is one of the workers
+  atomic_init(&queue.next, 0);
+  for (long i = 1; i < jobs; i++) {
+    if (pthread_create(&threads[i], NULL, worker, &queue) != 0)
+      jobs = i;
+  }
+  worker(&queue);
+  for (long i = 1; i < jobs; i++)
+    pthread_join(threads[i], NULL);
+  total_ms = elapsed_ms(&start);
+
+  for (size_t i = 0; i < queue.count; i++) {
+    print_job(&queue.jobs[i]);
+    failed += job_failed(&queue.jobs[i]);
+    warned += job_warned(&queue.jobs[i]);
+  }
+
+  if (junit != NULL &&
+      write_junit(junit, queue.jobs, queue.count, total_ms) < 0)
+    ret = -EIO;
+  if (json != NULL && write_json(json, queue.jobs, queue.count, failed, warned,
+                                 total_ms) < 0)
+    ret = -EIO;
+
+  if (failed) {
+    printf(LOG_COLOR_ERROR "[FAIL] %zu of %zu table(s) failed validation "
+                           "(%.2f ms, %ld jobs)" LOG_COLOR_RESET "\n",
+           failed, queue.count, total_ms, jobs);
+    ret = -EINVAL;
+  } else {
+    log_info("All %zu table(s) valid, %zu with warnings (%.2f ms, %ld jobs)",
+             queue.count, warned, total_ms, jobs);
+  }
+
+  free(queue.jobs);
+  return ret;
+}
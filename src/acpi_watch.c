@@ -0,0 +1,701 @@
+/* Watch table headers and regenerate affected tables incrementally */
+#include "acpi_validate.h"
+#include "utils.h"
+#include <acpi.h>
+#include <ctype.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Incremental regeneration
+
+  Every (device, table) pair CMake would configure is compiled directly with
+  the same flags, skipping make, archiving and iasl. The compiler writes a
+  depfile (-MD) for each object, so a changed header maps to the exact pairs
+  including it. Tables are extracted from the object files with the same
+  magic scan as acpi_extractor, written where the build puts them
+  (<build_dir>/<vendor>_<soc>/<TABLE>.aml) and checked with the
+  acpi_validate checks.
+*/
+
+#ifndef ACPI_WATCH_C_COMPILER
+#define ACPI_WATCH_C_COMPILER "cc"
+#endif
+#ifndef ACPI_WATCH_C_FLAGS
+#define ACPI_WATCH_C_FLAGS "-std=gnu11 -Wall -Wextra -O2 -Wno-missing-braces"
+#endif
+
+#define WATCH_MAX_PATH 1024
+#define WATCH_MAX_NAME 64
+#define WATCH_MAX_DIRS 256
+#define WATCH_DEBOUNCE_MS 50
+#define WATCH_EVENT_BUFFER 8192
+#define WATCH_MAX_ARGS 64
+
+typedef struct {
+  char device[WATCH_MAX_NAME]; // e.g. "qcom_sm8850"
+  char table[WATCH_MAX_NAME];  // e.g. "madt"
+  char vendorDir[WATCH_MAX_PATH];
+  char targetDir[WATCH_MAX_PATH];
+  char source[WATCH_MAX_PATH];
+  char **deps; // Real paths of every file the object depends on
+  size_t depCount;
+  bool dirty;
+  bool failed; // Last compile failed, the pair stays dirty until it builds
+  pid_t pid;
+} WatchPair;
+
+typedef struct {
+  char sourceDir[WATCH_MAX_PATH];
+  char buildDir[WATCH_MAX_PATH];
+  char objectDir[WATCH_MAX_PATH];
+  WatchPair *pairs;
+  size_t pairCount;
+  int inotify;
+  char (*dirs)[WATCH_MAX_PATH]; // Indexed by watch descriptor order
+  int *descriptors;
+  size_t dirCount;
+} Watch;
+
+/**
+ * snprintf for paths and names, truncation is reported instead of silent.
+ *
+ * @retval true if the whole string fit.
+ */
+static bool format_path(char *path, size_t size, const char *format, ...) {
+  va_list args;
+  int ret;
+
+  va_start(args, format);
+  ret = vsnprintf(path, size, format, args);
+  va_end(args);
+  if (ret < 0 || (size_t)ret >= size) {
+    log_warn("Path truncated: %s", path);
+    return false;
+  }
+  return true;
+}
+
+static bool file_is_empty(const char *path) {
+  struct stat st;
+  return stat(path, &st) != 0 || st.st_size == 0;
+}
+
+static void free_deps(WatchPair *pair) {
+  for (size_t i = 0; i < pair->depCount; i++)
+    free(pair->deps[i]);
+  free(pair->deps);
+  pair->deps = NULL;
+  pair->depCount = 0;
+}
+
+static WatchPair *find_pair(Watch *watch, const char *device,
+                            const char *table) {
+  for (size_t i = 0; i < watch->pairCount; i++) {
+    if (strcmp(watch->pairs[i].device, device) == 0 &&
+        strcmp(watch->pairs[i].table, table) == 0)
+      return &watch->pairs[i];
+  }
+  return NULL;
+}
+
+/**
+ * Enumerate (device, table) pairs the same way CMakeLists.txt does.
+ *
+ * A pair exists for every src/dummy/<table>.c with a non empty
+ * include/vendor/<vendor>/<soc>/<table>.h. Known pairs are kept, new ones
+ * are appended and marked dirty.
+ *
+ * @retval >=0  Number of new pairs.
+ * @retval -ENOMEM  Out of memory.
+ */
+static int scan_pairs(Watch *watch) {
+  char path[WATCH_MAX_PATH];
+  char **tables = NULL;
+  char **vendors = NULL;
+  size_t tableCount, vendorCount;
+  int added = 0;
+
+  format_path(path, sizeof(path), "%s/src/dummy", watch->sourceDir);
+  tableCount = list_names(path, ".c", &tables);
+  format_path(path, sizeof(path), "%s/include/vendor", watch->sourceDir);
+  vendorCount = list_names(path, NULL, &vendors);
+
+  for (size_t v = 0; v < vendorCount; v++) {
+    char vendorDir[WATCH_MAX_PATH];
+    char **socs = NULL;
+    size_t socCount;
+
+    format_path(vendorDir, sizeof(vendorDir), "%s/include/vendor/%s",
+             watch->sourceDir, vendors[v]);
+    if (!is_directory(vendorDir))
+      continue;
+    socCount = list_names(vendorDir, NULL, &socs);
+
+    for (size_t s = 0; s < socCount; s++) {
+      char targetDir[WATCH_MAX_PATH];
+      char device[WATCH_MAX_NAME];
+
+      format_path(targetDir, sizeof(targetDir), "%s/%s", vendorDir, socs[s]);
+      if (!is_directory(targetDir))
+        continue;
+      format_path(device, sizeof(device), "%s_%s", vendors[v], socs[s]);
+
+      for (size_t t = 0; t < tableCount; t++) {
+        char table[WATCH_MAX_NAME];
+        WatchPair *pair;
+
+        format_path(table, sizeof(table), "%.*s",
+                 (int)(strlen(tables[t]) - 2), tables[t]);
+        format_path(path, sizeof(path), "%s/%s.h", targetDir, table);
+        if (file_is_empty(path) || find_pair(watch, device, table) != NULL)
+          continue;
+
+        pair = realloc(watch->pairs,
+                       (watch->pairCount + 1) * sizeof(*watch->pairs));
+        if (pair == NULL) {
+          free_names(socs, socCount);
+          free_names(vendors, vendorCount);
+          free_names(tables, tableCount);
+          return -ENOMEM;
+        }
+        watch->pairs = pair;
+        pair = &watch->pairs[watch->pairCount++];
+        memset(pair, 0, sizeof(*pair));
+        format_path(pair->device, sizeof(pair->device), "%s", device);
+        format_path(pair->table, sizeof(pair->table), "%s", table);
+        format_path(pair->vendorDir, sizeof(pair->vendorDir), "%s", vendorDir);
+        format_path(pair->targetDir, sizeof(pair->targetDir), "%s", targetDir);
+        format_path(pair->source, sizeof(pair->source), "%s/src/dummy/%s",
+                 watch->sourceDir, tables[t]);
+        pair->dirty = true;
+        added++;
+      }
+    }
+    free_names(socs, socCount);
+  }
+
+  free_names(vendors, vendorCount);
+  free_names(tables, tableCount);
+  return added;
+}
+
+static void pair_path(const Watch *watch, const WatchPair *pair,
+                      const char *extension, char *path, size_t size) {
+  format_path(path, size, "%s/%s_%s.%s", watch->objectDir, pair->device,
+           pair->table, extension);
+}
+
+/**
+ * Load the depfile written by the compiler into pair->deps.
+ *
+ * Paths are resolved with realpath() so they compare equal to the paths
+ * built from inotify events.
+ */
+static int load_deps(const Watch *watch, WatchPair *pair) {
+  char path[WATCH_MAX_PATH];
+  FileContent depfile = {0};
+  char *token;
+  char *cursor;
+
+  pair_path(watch, pair, "d", path, sizeof(path));
+  depfile.filePath = path;
+  if (get_file_size(&depfile) == 0)
+    return -ENOENT;
+  depfile.fileBuffer = malloc(depfile.fileSize + 1);
+  if (depfile.fileBuffer == NULL)
+    return -ENOMEM;
+  read_file_content(&depfile);
+  depfile.fileBuffer[depfile.fileSize] = '\0';
+
+  free_deps(pair);
+  cursor = (char *)depfile.fileBuffer;
+  // Skip "object.o:"
+  cursor = strchr(cursor, ':');
+  cursor = cursor ? cursor + 1 : (char *)depfile.fileBuffer;
+
+  while ((token = strtok_r(cursor, " \t\r\n\\", &cursor)) != NULL) {
+    char resolved[PATH_MAX];
+    char **grown;
+
+    if (realpath(token, resolved) == NULL)
+      continue;
+    grown = realloc(pair->deps, (pair->depCount + 1) * sizeof(*pair->deps));
+    if (grown == NULL)
+      break;
+    pair->deps = grown;
+    pair->deps[pair->depCount] = strdup(resolved);
+    if (pair->deps[pair->depCount] != NULL)
+      pair->depCount++;
+  }
+
+  free(depfile.fileBuffer);
+  return 0;
+}
+
+static pid_t start_compile(const Watch *watch, WatchPair *pair) {
+  char include[WATCH_MAX_PATH + 2];
+  char vendor[WATCH_MAX_PATH + 2];
+  char target[WATCH_MAX_PATH + 2];
+  char object[WATCH_MAX_PATH];
+  char depfile[WATCH_MAX_PATH];
+  pid_t pid;
+
+  format_path(include, sizeof(include), "-I%s/include", watch->sourceDir);
+  format_path(vendor, sizeof(vendor), "-I%s", pair->vendorDir);
+  format_path(target, sizeof(target), "-I%s", pair->targetDir);
+  pair_path(watch, pair, "o", object, sizeof(object));
+  pair_path(watch, pair, "d", depfile, sizeof(depfile));
+
+  pid = fork();
+  if (pid == 0) {
+    // Same flags as the per table libraries, passed in by CMakeLists.txt
+    char flags[] = ACPI_WATCH_C_FLAGS;
+    char *const tail[] = {include, vendor, target, "-MD", "-MF", depfile,
+                          "-c", pair->source, "-o", object, NULL};
+    char *args[WATCH_MAX_ARGS + sizeof(tail) / sizeof(tail[0])];
+    size_t count = 0;
+
+    args[count++] = ACPI_WATCH_C_COMPILER;
+    for (char *flag = strtok(flags, " ");
+         flag != NULL && count < WATCH_MAX_ARGS; flag = strtok(NULL, " "))
+      args[count++] = flag;
+    memcpy(args + count, tail, sizeof(tail));
+    execvp(args[0], args);
+    _exit(127);
+  }
+  return pid;
+}
+
+/**
+ * Compile every dirty pair, at most one job per online CPU.
+ *
+ * A pair that fails stays dirty: its depfile may be missing or stale, so
+ * it is compiled again on the next change of any watched file.
+ *
+ * @retval  Number of pairs that failed to compile.
+ */
+static int compile_dirty(Watch *watch) {
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  long running = 0;
+  int failed = 0;
+  size_t next = 0;
+
+  if (jobs < 1)
+    jobs = 1;
+
+  for (;;) {
+    int status;
+    pid_t pid;
+
+    while (running < jobs && next < watch->pairCount) {
+      WatchPair *pair = &watch->pairs[next++];
+      if (!pair->dirty)
+        continue;
+      pair->failed = false;
+      pair->pid = start_compile(watch, pair);
+      if (pair->pid < 0) {
+        log_err("Failed to start compiler for %s_%s", pair->device,
+                pair->table);
+        pair->failed = true;
+        failed++;
+        continue;
+      }
+      running++;
+    }
+    if (running == 0)
+      break;
+
+    pid = wait(&status);
+    if (pid < 0)
+      break;
+    running--;
+    for (size_t i = 0; i < watch->pairCount; i++) {
+      WatchPair *pair = &watch->pairs[i];
+      if (pair->pid != pid)
+        continue;
+      pair->pid = 0;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        log_err("Failed to compile %s_%s", pair->device, pair->table);
+        pair->failed = true;
+        failed++;
+      }
+      break;
+    }
+  }
+  return failed;
+}
+
+/**
+ * Check a freshly extracted table with the same checks as acpi_validate.
+ *
+ * @retval  Number of failed checks, each problem is logged.
+ */
+static int validate_table(const char *name, const char *signature,
+                          const uint8_t *table, size_t size) {
+  AcpiValidation result;
+  int problems = 0;
+
+  acpi_validate_table(table, size, signature, &result);
+  for (int check = 0; check < ACPI_CHECK_COUNT; check++) {
+    if (result.status[check] == ACPI_CHECK_FAIL) {
+      log_err("%s: %s: %s", name, acpi_check_names[check],
+              result.message[check]);
+      problems++;
+    } else if (result.status[check] == ACPI_CHECK_WARN) {
+      log_warn("%s: %s: %s", name, acpi_check_names[check],
+               result.message[check]);
+    }
+  }
+  return problems;
+}
+
+/**
+ * Extract the table of a compiled pair and write it to the build tree.
+ *
+ * @retval 0    Table written and valid.
+ * @retval <0   Extraction failed or validation found problems.
+ */
+static int extract_pair(const Watch *watch, const WatchPair *pair) {
+  char object[WATCH_MAX_PATH];
+  char output[WATCH_MAX_PATH];
+  char name[WATCH_MAX_NAME * 2 + 8];
+  char upper[WATCH_MAX_NAME];
+  ACPI_TABLE_HEADER *header;
+  FileContent binary = {0};
+  FileContent table = {0};
+  size_t offset = 0;
+  size_t wrapped = 0;
+  uint32_t length;
+  int ret;
+
+  pair_path(watch, pair, "o", object, sizeof(object));
+  binary.filePath = object;
+  if (get_file_size(&binary) == 0)
+    return -ENOENT;
+  binary.fileBuffer = malloc(binary.fileSize);
+  if (binary.fileBuffer == NULL)
+    return -ENOMEM;
+  read_file_content(&binary);
+
+  ret = locate_table_in_binary(binary.fileBuffer, binary.fileSize, &offset,
+                               &wrapped);
+  if (ret < 0 || wrapped < 8) {
+    log_err("Table magic not found in %s", object);
+    free(binary.fileBuffer);
+    return -ENOENT;
+  }
+
+  memcpy(&length, binary.fileBuffer + offset + 4, sizeof(length));
+  if (length > wrapped) {
+    log_err("%s_%s: header length %u exceeds table data %zu", pair->device,
+            pair->table, length, wrapped);
+    free(binary.fileBuffer);
+    return -EINVAL;
+  }
+  header = (ACPI_TABLE_HEADER *)(binary.fileBuffer + offset);
+  if (table_has_checksum(header->Signature)) {
+    header->Checksum = 0;
+    header->Checksum = checksum(binary.fileBuffer + offset, length);
+  }
+
+  // <device>/<TABLE>.aml, as named by CMakeLists.txt
+  format_path(output, sizeof(output), "%s/%s", watch->buildDir, pair->device);
+  mkdir(output, 0755);
+  format_path(upper, sizeof(upper), "%s", pair->table);
+  for (char *c = upper; *c != '\0'; c++)
+    *c = (char)toupper((unsigned char)*c);
+  format_path(name, sizeof(name), "%s/%s.aml", pair->device, upper);
+  format_path(output, sizeof(output), "%s/%s", watch->buildDir, name);
+
+  table.filePath = output;
+  table.fileBuffer = binary.fileBuffer + offset;
+  table.fileSize = length;
+  ret = write_file_content(&table);
+  if (ret < 0) {
+    log_err("Failed to write %s", output);
+  } else if (validate_table(name, upper, table.fileBuffer,
+                            table.fileSize) != 0) {
+    ret = -EINVAL;
+  } else {
+    log_info("%-28s %5u bytes  OK", name, length);
+  }
+
+  free(binary.fileBuffer);
+  return ret;
+}
+
+/**
+ * Compile, extract and validate every dirty pair.
+ *
+ * @retval  Number of pairs that failed.
+ */
+static int rebuild(Watch *watch) {
+  struct timespec start;
+  int failed;
+  int rebuilt = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  failed = compile_dirty(watch);
+
+  for (size_t i = 0; i < watch->pairCount; i++) {
+    WatchPair *pair = &watch->pairs[i];
+    if (!pair->dirty || pair->failed)
+      continue;
+    pair->dirty = false;
+    load_deps(watch, pair);
+    if (extract_pair(watch, pair) < 0)
+      failed++;
+    rebuilt++;
+  }
+
+  if (failed)
+    log_warn("Rebuilt %d table(s), %d failed in %.1f ms", rebuilt, failed,
+             elapsed_ms(&start));
+  else
+    log_info("Rebuilt %d table(s) in %.1f ms", rebuilt, elapsed_ms(&start));
+  return failed;
+}
+
+static int add_watch_dir(Watch *watch, const char *dir) {
+  char resolved[PATH_MAX];
+  void *grown;
+  int wd;
+
+  if (realpath(dir, resolved) == NULL)
+    return -ENOENT;
+  for (size_t i = 0; i < watch->dirCount; i++) {
+    if (strcmp(watch->dirs[i], resolved) == 0)
+      return 0;
+  }
+  if (watch->dirCount >= WATCH_MAX_DIRS)
+    return -ENOMEM;
+
+  wd = inotify_add_watch(watch->inotify, resolved,
+                         IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+  if (wd < 0)
+    return -EIO;
+
+  grown = realloc(watch->dirs, (watch->dirCount + 1) * sizeof(*watch->dirs));
+  if (grown == NULL)
+    return -ENOMEM;
+  watch->dirs = grown;
+  grown = realloc(watch->descriptors,
+                  (watch->dirCount + 1) * sizeof(*watch->descriptors));
+  if (grown == NULL)
+    return -ENOMEM;
+  watch->descriptors = grown;
+  format_path(watch->dirs[watch->dirCount], WATCH_MAX_PATH, "%s", resolved);
+  watch->descriptors[watch->dirCount++] = wd;
+  return 0;
+}
+
+/**
+ * Watch include/, include/common, every vendor and soc directory and
+ * src/dummy. Called again after new directories show up.
+ */
+static void add_watch_tree(Watch *watch, const char *dir, int depth) {
+  char **names = NULL;
+  size_t count;
+
+  if (add_watch_dir(watch, dir) < 0 || depth == 0)
+    return;
+  count = list_names(dir, NULL, &names);
+  for (size_t i = 0; i < count; i++) {
+    char child[WATCH_MAX_PATH];
+    format_path(child, sizeof(child), "%s/%s", dir, names[i]);
+    if (is_directory(child))
+      add_watch_tree(watch, child, depth - 1);
+  }
+  free_names(names, count);
+}
+
+static void add_watches(Watch *watch) {
+  char path[WATCH_MAX_PATH];
+
+  format_path(path, sizeof(path), "%s/include", watch->sourceDir);
+  add_watch_tree(watch, path, 3);
+  format_path(path, sizeof(path), "%s/src/dummy", watch->sourceDir);
+  add_watch_tree(watch, path, 0);
+}
+
+static const char *watch_dir(const Watch *watch, int wd) {
+  for (size_t i = 0; i < watch->dirCount; i++) {
+    if (watch->descriptors[i] == wd)
+      return watch->dirs[i];
+  }
+  return NULL;
+}
+
+/**
+ * Mark pairs depending on a changed file dirty.
+ *
+ * @retval true if at least one pair depends on it.
+ */
+static bool mark_dependents(Watch *watch, const char *path) {
+  bool found = false;
+
+  for (size_t i = 0; i < watch->pairCount; i++) {
+    WatchPair *pair = &watch->pairs[i];
+    for (size_t d = 0; d < pair->depCount; d++) {
+      if (strcmp(pair->deps[d], path) == 0) {
+        pair->dirty = true;
+        found = true;
+        break;
+      }
+    }
+  }
+  return found;
+}
+
+static bool has_suffix(const char *name, const char *suffix) {
+  size_t length = strlen(name);
+  size_t suffix_length = strlen(suffix);
+
+  return length >= suffix_length &&
+         strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+/**
+ * Read pending inotify events and mark affected pairs dirty.
+ *
+ * @retval  Number of changed files.
+ */
+static int drain_events(Watch *watch, bool *rescan) {
+  char buffer[WATCH_EVENT_BUFFER]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+  int changes = 0;
+
+  for (;;) {
+    struct pollfd fd = {.fd = watch->inotify, .events = POLLIN};
+    ssize_t length;
+
+    // Editors save with several events, wait until they settle
+    if (poll(&fd, 1, changes ? WATCH_DEBOUNCE_MS : -1) <= 0)
+      break;
+    length = read(watch->inotify, buffer, sizeof(buffer));
+    if (length <= 0)
+      break;
+
+    for (char *cursor = buffer; cursor < buffer + length;) {
+      const struct inotify_event *event =
+          (const struct inotify_event *)cursor;
+      const char *dir = watch_dir(watch, event->wd);
+      cursor += sizeof(*event) + event->len;
+
+      if (dir == NULL || event->len == 0 || event->name[0] == '.')
+        continue;
+      if (event->mask & IN_ISDIR) {
+        *rescan = true;
+        changes++;
+        continue;
+      }
+      if (!has_suffix(event->name, ".h") && !has_suffix(event->name, ".c"))
+        continue;
+
+      char path[WATCH_MAX_PATH * 2];
+      format_path(path, sizeof(path), "%s/%s", dir, event->name);
+      // Unknown or deleted files may add or remove pairs
+      if (!mark_dependents(watch, path) || (event->mask & IN_DELETE))
+        *rescan = true;
+      changes++;
+    }
+  }
+  return changes;
+}
+
+static void drop_removed_pairs(Watch *watch) {
+  size_t kept = 0;
+
+  for (size_t i = 0; i < watch->pairCount; i++) {
+    WatchPair *pair = &watch->pairs[i];
+    char header[WATCH_MAX_PATH * 2];
+
+    format_path(header, sizeof(header), "%s/%s.h", pair->targetDir, pair->table);
+    if (file_is_empty(header) || access(pair->source, F_OK) != 0) {
+      log_info("Dropping %s_%s, header or source removed", pair->device,
+               pair->table);
+      free_deps(pair);
+      continue;
+    }
+    watch->pairs[kept++] = *pair;
+  }
+  watch->pairCount = kept;
+}
+
+int main(int argc, char **argv) {
+  Watch watch = {0};
+  bool once = false;
+  int argi = 1;
+  int failed;
+
+  // Rebuild reports show up at once when the output is piped or logged
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  if (argc > 1 && strcmp(argv[1], "--once") == 0) {
+    once = true;
+    argi++;
+  }
+  if (argc - argi != 2) {
+    log_warn("Usage: %s [--once] <source_dir> <build_dir>", argv[0]);
+    return -EINVAL;
+  }
+
+  if (realpath(argv[argi], watch.sourceDir) == NULL ||
+      !is_directory(watch.sourceDir)) {
+    log_err("Source directory %s not found", argv[argi]);
+    return -ENOENT;
+  }
+  mkdir(argv[argi + 1], 0755);
+  if (realpath(argv[argi + 1], watch.buildDir) == NULL) {
+    log_err("Build directory %s not found", argv[argi + 1]);
+    return -ENOENT;
+  }
+  format_path(watch.objectDir, sizeof(watch.objectDir), "%s/watch",
+           watch.buildDir);
+  mkdir(watch.objectDir, 0755);
+
+  if (scan_pairs(&watch) < 0) {
+    log_err("Failed to enumerate device tables");
+    return -ENOMEM;
+  }
+  log_info("Found %zu device table(s) under %s", watch.pairCount,
+           watch.sourceDir);
+
+  // First pass builds everything and records header dependencies
+  failed = rebuild(&watch);
+  if (once)
+    return failed ? -EINVAL : 0;
+
+  watch.inotify = inotify_init1(IN_CLOEXEC);
+  if (watch.inotify < 0) {
+    log_err("Failed to initialize inotify");
+    return -EIO;
+  }
+  add_watches(&watch);
+  log_info("Watching %zu directories, press Ctrl+C to stop", watch.dirCount);
+
+  for (;;) {
+    bool rescan = false;
+    int changes = drain_events(&watch, &rescan);
+
+    if (changes == 0)
+      continue;
+    if (rescan) {
+      drop_removed_pairs(&watch);
+      scan_pairs(&watch);
+      add_watches(&watch);
+    }
+    rebuild(&watch);
+  }
+
+  return 0;
+}
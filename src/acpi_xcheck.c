@@ -0,0 +1,164 @@
+/* Cross-table consistency checks of every built device */
+#include "acpi_xcheck.h"
+#include "utils.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/** Usage
+
+  acpi_xcheck <build_dir> [device...]
+
+  Loads the tables of every <build_dir>/<device> (or of the given devices
+  only) and checks the relations between them, see include/acpi_xcheck.h:
+
+    cpu-uid      MADT GICC ACPIProcessorUID <-> PPTT leaf ACPI processor ID
+    timer-gsi    GTDT timer GSIs in the PPI/SPI range of the MADT GIC
+    gsi-owner    no GSI shared by two interrupt sources
+    console      SPCR UART is a DBG2 serial port of the same type
+    pci-segment  MCFG segments <-> IORT root complexes
+
+  A check is skipped on devices without its tables. Every violation is
+  printed, the exit status is non zero if any check failed.
+*/
+
+#define XCHECK_MAX_NAME 256
+
+static void print_result(const char *device, const AcpiXcheckResult *result) {
+  for (size_t i = 0; i < result->diagnosticCount; i++) {
+    const AcpiXcheckDiagnostic *diagnostic = &result->diagnostics[i];
+    if (diagnostic->status == ACPI_CHECK_FAIL)
+      printf(LOG_COLOR_ERROR "[FAIL] %s: %s: %s" LOG_COLOR_RESET "\n",
+             device, acpi_xcheck_names[diagnostic->check],
+             diagnostic->message);
+    else
+      log_warn("%s: %s: %s", device, acpi_xcheck_names[diagnostic->check],
+               diagnostic->message);
+  }
+
+  char summary[ACPI_XCHECK_COUNT * 48];
+  size_t used = 0;
+
+  for (int check = 0; check < ACPI_XCHECK_COUNT; check++) {
+    const char *separator = check ? ", " : "";
+    if (result->status[check] == ACPI_CHECK_PASS ||
+        result->status[check] == ACPI_CHECK_WARN)
+      used += snprintf(summary + used, sizeof(summary) - used, "%s%s %u",
+                       separator, acpi_xcheck_names[check],
+                       result->relations[check]);
+    else
+      used += snprintf(summary + used, sizeof(summary) - used, "%s%s %s",
+                       separator, acpi_xcheck_names[check],
+                       result->status[check] == ACPI_CHECK_SKIP ? "skipped"
+                                                                : "failed");
+  }
+  if (!acpi_xcheck_failed(result))
+    log_info("%s: %s", device, summary);
+}
+
+/**
+ * Check one device directory.
+ *
+ * @retval 0        Checked, failed tells whether a check failed.
+ * @retval -ENOENT  No table in the directory.
+ * @retval <0       Tables could not be read or checked.
+ */
+static int check_device(const char *build_dir, const char *device,
+                        bool *failed) {
+  char dir[XCHECK_MAX_NAME * 2];
+  FileContent *tables = NULL;
+  AcpiTableSet set = {0};
+  AcpiXcheckResult result;
+  size_t count = 0;
+  int ret;
+
+  snprintf(dir, sizeof(dir), "%s/%s", build_dir, device);
+  ret = read_table_directory(dir, &tables, &count);
+  if (ret < 0)
+    return ret;
+
+  for (size_t i = 0; i < count; i++) {
+    ret = acpi_xcheck_add(&set, tables[i].fileBuffer, tables[i].fileSize);
+    if (ret == -EINVAL) {
+      log_warn("%s: %s is not a complete table, not checked", device,
+               tables[i].filePath);
+    } else if (ret == -EEXIST) {
+      log_warn("%s: %s repeats a signature, not checked", device,
+               tables[i].filePath);
+    }
+  }
+
+  ret = acpi_xcheck_run(&set, &result);
+  if (ret < 0) {
+    log_err("Failed to check %s (%d)", device, ret);
+  } else {
+    print_result(device, &result);
+    *failed = acpi_xcheck_failed(&result);
+    acpi_xcheck_free(&result);
+  }
+  free_table_directory(tables, count);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  char **devices = NULL;
+  size_t deviceCount, checked = 0, failed = 0;
+  struct timespec start;
+  int ret = 0;
+
+  if (argc < 2) {
+    log_warn("Usage: %s <build_dir> [device...]", argv[0]);
+    return -EINVAL;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (argc > 2) {
+    deviceCount = argc - 2;
+    devices = calloc(deviceCount, sizeof(*devices));
+    for (size_t i = 0; devices != NULL && i < deviceCount; i++)
+      devices[i] = strdup(argv[i + 2]);
+  } else {
+    deviceCount = list_devices(argv[1], &devices);
+  }
+  if (devices == NULL)
+    deviceCount = 0;
+
+  for (size_t i = 0; i < deviceCount && devices[i] != NULL; i++) {
+    bool deviceFailed = false;
+    int deviceRet = check_device(argv[1], devices[i], &deviceFailed);
+
+    // Directories without tables are not devices, unless asked for
+    if (deviceRet == -ENOENT && argc == 2)
+      continue;
+    if (deviceRet < 0) {
+      if (deviceRet == -ENOENT)
+        log_err("No tables found under %s/%s", argv[1], devices[i]);
+      ret = deviceRet;
+      failed++;
+    } else if (deviceFailed) {
+      failed++;
+    }
+    checked++;
+  }
+
+  if (checked == 0) {
+    log_err("No tables found under %s", argv[1]);
+    ret = -ENOENT;
+  } else if (failed) {
+    printf(LOG_COLOR_ERROR "[FAIL] %zu of %zu device(s) failed cross-table "
+                           "checks (%.2f ms)" LOG_COLOR_RESET "\n",
+           failed, checked, elapsed_ms(&start));
+    if (ret == 0)
+      ret = -EINVAL;
+  } else {
+    log_info("All %zu device(s) consistent across tables (%.2f ms)", checked,
+             elapsed_ms(&start));
+  }
+
+  for (size_t i = 0; i < deviceCount; i++)
+    free(devices[i]);
+  free(devices);
+  return ret;
+}
@@ -0,0 +1,437 @@
+/* Build MADT, PPTT, MCFG and GTDT AML straight from a DTB */
+#include "acpigen.h"
+#include "dtb_platform.h"
+#include "fdt.h"
+#include "trace.h"
+#include "utils.h"
+#include <common/gtdt.h>
+#include <common/mcfg.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/** Usage
+
+  dtb_to_aml --vendor <vendor> [-o out_dir] [-I include_dir]
+             [--oem-rev rev] [--l1 count] <dtb>
+
+  Fast path for experiments: the platform is extracted from the DTB with
+  lib/dtb_platform.c (the dtb_to_headers heuristics) and the tables are
+  built in memory with libacpigen, no headers, compiler or extractor
+  involved. out_dir (default <vendor>_<dtb_stem>) receives MADT.aml,
+  PPTT.aml, GTDT.aml and, if the tree has PCIe, MCFG.aml, laid out like
+  the build tree so acpi_diff can compare it with a regular build.
+
+  The bytes are those of the normal pipeline for the same platform:
+
+    - MADT, MCFG: the madt.h and mcfg.h written by dtb_to_headers, MPIDR
+      placeholders included.
+    - PPTT: pptt.h of the reference platform (qcom/sm8850): ID, then
+      L3, L2 and L1 caches (empty cache structures), system, clusters
+      and cores. Clusters share one L2 when every core has the same
+      next-level-cache, otherwise each cluster gets its own.
+    - GTDT: gtdt.h of the reference platform, with the PPIs of the
+      arm,armv8-timer node when the tree has one.
+
+  OEM ID and OEM table ID come from <include_dir>/vendor/<vendor>/
+  acpi_vendor.h, the OEM revision is inferred from the DTB name as in
+  dtb_to_headers unless --oem-rev is given.
+*/
+
+#define DTB_MAX_PATH 1024
+#define DTB_MAX_LINE 512
+
+#ifndef ACPI_INCLUDE_DIR
+#define ACPI_INCLUDE_DIR "include"
+#endif
+
+// Reference gtdt.h: Secure EL1, non secure EL1, virtual EL1, EL2 PPIs
+static const uint32_t default_timer_gsi[4] = {0x1D, 0x1E, 0x1B, 0x1A};
+
+typedef struct {
+  char oemId[6];
+  char oemTableId[8];
+  uint32_t oemRevision;
+  uint32_t l1;
+} AmlOptions;
+
+/**
+ * Read the characters of a "#define NAME 'A', 'B', ..." line.
+ */
+static bool parse_char_list(const char *line, const char *name, char *out,
+                            size_t size) {
+  size_t length = strlen(name);
+  size_t count = 0;
+
+  line += strspn(line, " \t");
+  if (strncmp(line, "#define", 7) != 0)
+    return false;
+  line += 7;
+  line += strspn(line, " \t");
+  if (strncmp(line, name, length) != 0 || (line[length] != ' ' &&
+                                           line[length] != '\t'))
+    return false;
+  for (line += length; *line && strncmp(line, "//", 2) != 0; line++) {
+    if (line[0] != '\'' || line[1] == '\0' || line[2] != '\'')
+      continue;
+    if (count < size)
+      out[count] = line[1];
+    count++;
+    line += 2;
+  }
+  return count == size;
+}
+
+static int load_vendor_oem(const char *include_dir, const char *vendor,
+                           AmlOptions *options) {
+  char path[DTB_MAX_PATH];
+  char line[DTB_MAX_LINE];
+  bool oem_id = false, oem_table_id = false;
+  FILE *file;
+
+  if ((size_t)snprintf(path, sizeof(path), "%s/vendor/%s/acpi_vendor.h",
+                       include_dir, vendor) >= sizeof(path))
+    return -ENAMETOOLONG;
+  file = fopen(path, "r");
+  if (file == NULL) {
+    log_err("Failed to open %s", path);
+    return -ENOENT;
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    oem_id |= parse_char_list(line, "ACPI_TABLE_HEADER_OEM_ID", options->oemId,
+                              sizeof(options->oemId));
+    oem_table_id |=
+        parse_char_list(line, "ACPI_TABLE_HEADER_OEM_TABLE_ID",
+                        options->oemTableId, sizeof(options->oemTableId));
+  }
+  fclose(file);
+  if (!oem_id || !oem_table_id) {
+    log_err("%s does not define the OEM ID and OEM table ID", path);
+    return -EINVAL;
+  }
+  return 0;
+}
+
+/**
+ * Cluster of a core as CPUID_TO_CLUSTER() in common/madt.h computes it,
+ * which only knows the first four clusters.
+ */
+static uint8_t madt_cluster_of(const DtbPlatform *platform, uint32_t cpu) {
+  uint32_t first = 0;
+
+  for (uint32_t c = 0; c < platform->clusterCount && c < 4; c++) {
+    first += platform->clusters[c];
+    if (cpu < first)
+      return (uint8_t)c;
+  }
+  return 0;
+}
+
+static int build_madt(AcpiGen *gen, AcpiArena *arena,
+                      const DtbPlatform *platform) {
+  MADT_GICD_STRUCTURE gicd = {
+      .PhysicalBaseAddress = platform->gicdBase,
+      .GICVersion = platform->gicVersion,
+  };
+  MADT_GIC_ITS_STRUCTURE its = {.PhysicalBaseAddress = platform->itsBase};
+  int ret = acpigen_madt_begin(gen, arena, 0, 0);
+
+  if (ret < 0)
+    return ret;
+  acpigen_madt_gicd(gen, &gicd);
+  // madt.h declares NUM_ITS entries but only initializes the first one
+  for (uint32_t i = 0; i < platform->itsCount; i++) {
+    if (i == 0)
+      acpigen_madt_gic_its(gen, &its);
+    else
+      acpigen_append(gen, NULL, sizeof(its));
+  }
+  for (uint32_t cpu = 0; cpu < platform->cores; cpu++) {
+    MADT_GICC_STRUCTURE gicc = {
+        .CPUInterfaceNumber = cpu,
+        .ACPIProcessorUID = cpu,
+        .Flags = MADT_GICC_FLAG_ENABLED,
+        .PerformanceInterruptGSI = (uint32_t)platform->perfGsi,
+        .VGICMaintenanceInterrupt = (uint32_t)platform->vgicGsi,
+        .GICRBaseAddress = platform->gicrBase + platform->gicrStride * cpu,
+        .MPIDR = (uint64_t)cpu << 8,
+        .ProcessorPowerEfficiencyClass = madt_cluster_of(platform, cpu),
+    };
+    acpigen_madt_gicc(gen, &gicc);
+  }
+  return gen->error;
+}
+
+/**
+ * PPTT in the struct order of common/pptt.h: ID, caches, system, clusters,
+ * cores. Every reference points backwards, no forward references needed.
+ */
+static int build_pptt(AcpiGen *gen, AcpiArena *arena,
+                      const DtbPlatform *platform, uint32_t l1) {
+  ACPI_PPTT_CACHE_TYPE_STRUCTURE cache = {0};
+  ACPI_PPTT_ID id = {0};
+  uint32_t l2_count = platform->l2Shared ? 1 : platform->clusterCount;
+  AcpiGenRef system_resources[2], l2[DTB_MAX_CLUSTERS], l1_refs[8];
+  AcpiGenRef clusters[DTB_MAX_CLUSTERS];
+  AcpiGenRef system;
+  uint32_t system_count = 0;
+  uint32_t cluster_end = 0;
+  uint32_t c = 0;
+  int ret;
+
+  if (l1 > sizeof(l1_refs) / sizeof(l1_refs[0])) {
+    log_err("At most %zu L1 caches per core are supported",
+            sizeof(l1_refs) / sizeof(l1_refs[0]));
+    return -EINVAL;
+  }
+  ret = acpigen_pptt_begin(gen, arena);
+  if (ret < 0)
+    return ret;
+  system_resources[system_count++] = acpigen_pptt_id(gen, &id);
+  if (platform->l3)
+    system_resources[system_count++] =
+        acpigen_pptt_cache(gen, &cache, ACPIGEN_NO_REF);
+  for (uint32_t i = 0; i < l2_count; i++)
+    l2[i] = acpigen_pptt_cache(gen, &cache, ACPIGEN_NO_REF);
+  for (uint32_t i = 0; i < l1; i++)
+    l1_refs[i] = acpigen_pptt_cache(gen, &cache, ACPIGEN_NO_REF);
+
+  system = acpigen_pptt_processor(gen, PPTT_PROC_FLAG_PHYSICAL_PACKAGE, 0,
+                                  ACPIGEN_NO_REF, system_resources,
+                                  system_count);
+  // Cluster nodes all use ACPI processor ID 0, as in the reference pptt.h
+  for (uint32_t i = 0; i < platform->clusterCount; i++)
+    clusters[i] = acpigen_pptt_processor(
+        gen, 0, 0, system, &l2[platform->l2Shared ? 0 : i], 1);
+  cluster_end = platform->clusters[0];
+  for (uint32_t cpu = 0; cpu < platform->cores; cpu++) {
+    // Cores past the last cluster stay in it, as the headers would
+    while (cpu >= cluster_end && c + 1 < platform->clusterCount)
+      cluster_end += platform->clusters[++c];
+    acpigen_pptt_processor(gen, PPTT_PROC_FLAG_ACPI_PROC_ID_VALID, cpu,
+                           clusters[c], l1_refs, l1);
+  }
+  return gen->error;
+}
+
+static int build_gtdt(AcpiGen *gen, AcpiArena *arena,
+                      const DtbPlatform *platform) {
+  const uint32_t *gsi =
+      platform->hasTimer ? platform->timerGsi : default_timer_gsi;
+  GTDT_HEADER_EXTRA_DATA extra = {
+      .CntControlBasePhyAddress = 0xFFFFFFFFFFFFFFFFULL,
+      .SecureEL1TimerGSI = gsi[0],
+      .SecureEL1TimerFlags = GTDT_BLOCK_S_NS_ELX_TIMER_FLAG_ALWATS_ON_CAP,
+      .NSEL1TimerGSI = gsi[1],
+      .NSEL1TimerFlags = GTDT_BLOCK_S_NS_ELX_TIMER_FLAG_ALWATS_ON_CAP,
+      .VirtualEL1TimerGSI = gsi[2],
+      .VirtualEL1TimerFlags = GTDT_BLOCK_S_NS_ELX_TIMER_FLAG_ALWATS_ON_CAP,
+      .EL2TimerGSI = gsi[3],
+      .EL2TimerFlags = GTDT_BLOCK_S_NS_ELX_TIMER_FLAG_ALWATS_ON_CAP,
+      .CntReadBasePhyAddress = 0xFFFFFFFFFFFFFFFFULL,
+  };
+  int ret = acpigen_begin(gen, arena, (const char[]){ACPI_GTDT_SIGNATURE},
+                          ACPI_GTDT_REVISION, sizeof(extra));
+
+  if (ret < 0)
+    return ret;
+  acpigen_write(gen, sizeof(ACPI_TABLE_HEADER), &extra, sizeof(extra));
+  return gen->error;
+}
+
+static int build_mcfg(AcpiGen *gen, AcpiArena *arena,
+                      const DtbPlatform *platform) {
+  int ret = acpigen_begin(gen, arena, (const char[]){ACPI_MCFG_SIGNATURE},
+                          ACPI_MCFG_REVISION, sizeof(MCFG_HEADER_EXTRA_DATA));
+
+  if (ret < 0)
+    return ret;
+  for (uint32_t i = 0; i < platform->mcfgCount; i++) {
+    MCFG_MEM_MAP_EC_SPACE_STRUCTURE entry = {
+        .BaseAddress = platform->mcfg[i].base,
+        .PCISegmentGroupNumber = (uint16_t)platform->mcfg[i].segment,
+        .StartBusNumber = (uint8_t)platform->mcfg[i].busStart,
+        .EndBusNumber = (uint8_t)platform->mcfg[i].busEnd,
+    };
+    acpigen_append(gen, &entry, sizeof(entry));
+  }
+  return gen->error;
+}
+
+static int write_table(const char *out_dir, const char *name,
+                       const uint8_t *table, size_t size) {
+  char path[DTB_MAX_PATH];
+  FILE *out;
+  size_t written;
+
+  if ((size_t)snprintf(path, sizeof(path), "%s/%s.aml", out_dir, name) >=
+      sizeof(path)) {
+    log_err("Path too long: %s/%s.aml", out_dir, name);
+    return -ENAMETOOLONG;
+  }
+  out = fopen(path, "wb");
+  if (out == NULL) {
+    log_err("Failed to open %s", path);
+    return -EIO;
+  }
+  written = fwrite(table, 1, size, out);
+  if (fclose(out) != 0 || written != size) {
+    log_err("Failed to write %s", path);
+    return -EIO;
+  }
+  log_info("Wrote %s (%zu bytes)", path, size);
+  return 0;
+}
+
+/**
+ * Build one table, stamp the OEM fields and write it.
+ */
+static int emit_table(const char *out_dir, const char *name, AcpiGen *gen,
+                      int built, const AmlOptions *options) {
+  const char *device = strrchr(out_dir, '/') ? strrchr(out_dir, '/') + 1
+                                             : out_dir;
+  const uint8_t *table;
+  TraceSpan span;
+  size_t length;
+  int ret = built;
+
+  trace_begin(&span);
+  if (ret == 0) {
+    acpigen_set_oem(gen, options->oemId, options->oemTableId,
+                    options->oemRevision);
+    ret = acpigen_finalize(gen, &table, &length);
+  }
+  if (ret < 0) {
+    log_err("Failed to build %s: %d", name, ret);
+    return ret;
+  }
+  ret = write_table(out_dir, name, table, length);
+  trace_end(&span);
+  trace_write(&span, "dtb_to_aml", device, name, "write", length);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  const char *vendor = NULL;
+  const char *out_dir = NULL;
+  const char *include_dir = ACPI_INCLUDE_DIR;
+  const char *input = NULL;
+  const char *dtb_name;
+  uint64_t oem_revision = 0;
+  AmlOptions options = {.l1 = 2};
+  bool usage = false;
+  char default_dir[DTB_MAX_PATH];
+  DtbPlatform platform;
+  AcpiArena arena;
+  AcpiGen gen;
+  FdtTree tree;
+  struct timespec start;
+  TraceSpan parse_span, extract_span, build_span;
+  const char *device;
+  int ret;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--vendor") == 0) {
+      vendor = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+      out_dir = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-I") == 0) {
+      include_dir = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--oem-rev") == 0) {
+      oem_revision = strtoull(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "--l1") == 0) {
+      options.l1 = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (argv[i][0] != '-' && input == NULL) {
+      input = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || vendor == NULL || input == NULL) {
+    log_warn("Usage: %s --vendor <vendor> [-o out_dir] [-I include_dir] "
+             "[--oem-rev rev] [--l1 count] <dtb>",
+             argv[0]);
+    return -EINVAL;
+  }
+
+  ret = load_vendor_oem(include_dir, vendor, &options);
+  if (ret < 0)
+    return ret;
+  dtb_name = strrchr(input, '/') ? strrchr(input, '/') + 1 : input;
+  if (oem_revision == 0)
+    oem_revision = dtb_infer_oem_revision(dtb_name);
+  options.oemRevision = (uint32_t)oem_revision;
+  if (out_dir == NULL) {
+    snprintf(default_dir, sizeof(default_dir), "%s_%.*s", vendor,
+             (int)strcspn(dtb_name, "."), dtb_name);
+    out_dir = default_dir;
+  }
+  device = strrchr(out_dir, '/') ? strrchr(out_dir, '/') + 1 : out_dir;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  trace_begin(&parse_span);
+  ret = fdt_open(&tree, input);
+  if (ret == -ENOENT)
+    log_err("DTB not found: %s", input);
+  else if (ret < 0)
+    log_err("%s is not a valid DTB", input);
+  if (ret < 0)
+    return ret;
+  trace_end(&parse_span);
+  trace_write(&parse_span, "dtb_to_aml", device, NULL, "parse", tree.size);
+  trace_begin(&extract_span);
+  ret = dtb_platform_extract(&tree, &platform);
+  if (ret < 0) {
+    fdt_close(&tree);
+    return ret;
+  }
+  trace_end(&extract_span);
+  trace_write(&extract_span, "dtb_to_aml", device, NULL, "extract", 0);
+  if (platform.cores == 0) {
+    log_err("%s has no /cpus/cpu@ nodes", input);
+    ret = -ENODEV;
+  } else if (mkdir(out_dir, 0755) != 0 && !is_directory(out_dir)) {
+    log_err("Failed to create %s", out_dir);
+    ret = -EIO;
+  }
+  if (ret == 0) {
+    if (platform.gicVersion == GIC_INVALID)
+      log_warn("GIC version not recognized as v3 or v4, MADT uses "
+               "GIC_INVALID");
+    if (platform.itsCount > 1)
+      log_warn("%u ITS found, only the first one is described and the "
+               "others are zero filled, as madt.h does",
+               platform.itsCount);
+    log_warn("MPIDR values are placeholders (core << 8), as in madt.h");
+  }
+
+  trace_begin(&build_span);
+  acpi_arena_init(&arena, 0);
+  if (ret == 0)
+    ret = emit_table(out_dir, "MADT", &gen, build_madt(&gen, &arena, &platform),
+                     &options);
+  if (ret == 0)
+    ret = emit_table(out_dir, "PPTT", &gen,
+                     build_pptt(&gen, &arena, &platform, options.l1),
+                     &options);
+  if (ret == 0)
+    ret = emit_table(out_dir, "GTDT", &gen, build_gtdt(&gen, &arena, &platform),
+                     &options);
+  if (ret == 0 && platform.mcfgCount == 0)
+    log_info("No PCIe ECAM in the tree, MCFG skipped");
+  else if (ret == 0)
+    ret = emit_table(out_dir, "MCFG", &gen, build_mcfg(&gen, &arena, &platform),
+                     &options);
+  trace_end(&build_span);
+  trace_write(&build_span, "dtb_to_aml", device, NULL, "build", 0);
+  if (ret == 0)
+    log_info("%u cores, %u clusters, tables in %.2f ms", platform.cores,
+             platform.clusterCount, elapsed_ms(&start));
+  acpi_arena_free(&arena);
+  dtb_platform_free(&platform);
+  fdt_close(&tree);
+  return ret;
+}
@@ -0,0 +1,820 @@
+/* Generate table_header.h, madt.h and mcfg.h from one parse of a DTB */
+#include "dtb_platform.h"
+#include "fdt.h"
+#include "sha256.h"
+#include "trace.h"
+#include "utils.h"
+#include <common/madt.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Usage
+
+  dtb_to_headers --vendor <vendor> [-o out_dir] [--oem-rev rev] [--l1 count]
+                 <dtb>
+
+  Native replacement for tools/dtb_to_table_header.py, dtb_to_madt.py and
+  dtb_to_mcfg.py. The DTB is mapped and parsed once, then the three headers
+  are written to out_dir (default include/vendor/<vendor>/<dtb_stem>) with
+  the same heuristics and the same text as the Python scripts.
+
+  dtb_to_headers --vendor <vendor> --batch [-j jobs] [-o out_root]
+                 [--oem-rev rev] [--l1 count] <dir|dtb.img>...
+
+  Batch mode splits every input (a directory of DTBs, or concatenated
+  dtb.img / DTBO images) into blobs, parses and hashes them on jobs
+  threads, and groups the variants by a canonical hash of the nodes ACPI
+  is generated from: /cpus, the GIC and ITS, PCIe, the architected timer
+  and UARTs. One header tree is written per group to
+  out_root/<soc>[_<hash>] (default include/vendor/<vendor>), with a
+  devices.txt listing the variants that map to it.
+
+  The values come from lib/dtb_platform.c, which dtb_to_aml shares.
+*/
+
+#define DTB_MAX_PATH 1024
+#define DTB_MAX_NAME 128
+#define DTB_MAX_INPUTS 64
+#define DTB_MAX_JOBS 64
+
+static FILE *open_output(const char *dir, const char *name, char *path,
+                         size_t size) {
+  FILE *file;
+
+  if ((size_t)snprintf(path, size, "%s/%s", dir, name) >= size) {
+    log_err("Path too long: %s/%s", dir, name);
+    return NULL;
+  }
+  file = fopen(path, "w");
+  if (file == NULL)
+    log_err("Failed to create %s", path);
+  return file;
+}
+
+static int close_output(FILE *file, const char *path) {
+  if (fclose(file) != 0) {
+    log_err("Failed to write %s", path);
+    return -EIO;
+  }
+  log_info("Wrote %s", path);
+  return 0;
+}
+
+static int make_directories(const char *path) {
+  char buffer[DTB_MAX_PATH];
+  size_t length = strlen(path);
+
+  if (length == 0 || length >= sizeof(buffer))
+    return -EINVAL;
+  memcpy(buffer, path, length + 1);
+  for (size_t i = 1; i <= length; i++) {
+    if (buffer[i] != '/' && buffer[i] != '\0')
+      continue;
+    buffer[i] = '\0';
+    if (mkdir(buffer, 0755) != 0 && !is_directory(buffer))
+      return -EIO;
+    buffer[i] = path[i];
+  }
+  return 0;
+}
+
+static int write_table_header(const DtbPlatform *platform, const char *dir,
+                              const char *dtb_name, uint64_t oem_revision,
+                              uint32_t l1) {
+  char path[DTB_MAX_PATH];
+  FILE *file;
+
+  if (oem_revision == 0)
+    oem_revision = dtb_infer_oem_revision(dtb_name);
+
+  file = open_output(dir, "table_header.h", path, sizeof(path));
+  if (file == NULL)
+    return -EIO;
+  fprintf(file,
+          "#pragma once\n"
+          "#include <acpi_vendor.h>\n"
+          "\n"
+          "#define ACPI_OEM_REVISION 0x%04llx\n"
+          "\n"
+          "/* Platform specific configuration */\n"
+          "#define NUM_CORES %u\n"
+          "#define NUM_CLUSTERS %u\n"
+          "#define NUM_SYSTEM 1\n",
+          (unsigned long long)oem_revision, platform->cores,
+          platform->clusterCount);
+  for (uint32_t i = 0; i < platform->clusterCount; i++)
+    fprintf(file, "#define NUM_CLUSTER_%u_CORES %u\n", i,
+            platform->clusters[i]);
+  fprintf(file, "\n#define L1_CACHES_COUNT %u\n", l1);
+  if (platform->l2Shared)
+    fprintf(file, "#define L2_CACHES_COUNT 1\n");
+  else
+    fprintf(file, "#define L2_CACHES_COUNT /*Fix Me*/\n");
+  fprintf(file, "#define L3_CACHES_COUNT %d\n", platform->l3 ? 1 : 0);
+  return close_output(file, path);
+}
+
+static int write_madt(const DtbPlatform *platform, const char *dir) {
+  const char *version = dtb_gic_version_name(platform->gicVersion);
+  char path[DTB_MAX_PATH];
+  FILE *file;
+
+  if (platform->gicVersion == GIC_INVALID)
+    log_warn("GIC version not recognized as v3 or v4; GIC_VERSION will be "
+             "set to GIC_INVALID");
+
+  file = open_output(dir, "madt.h", path, sizeof(path));
+  if (file == NULL)
+    return -EIO;
+  fprintf(file,
+          "\n#pragma once\n"
+          "#include \"table_header.h\"\n"
+          "#include <common/madt.h>\n"
+          "\n"
+          "#define GICD_BASE_ADDRESS 0x%08llxULL\n",
+          (unsigned long long)platform->gicdBase);
+  if (platform->itsCount)
+    fprintf(file, "#define GIC_ITS_BASE_ADDRESS 0x%08llxULL\n",
+            (unsigned long long)platform->itsBase);
+  fprintf(file,
+          "#define GICR_BASE_ADDRESS 0x%08llxULL\n"
+          "#define GICR_STRIDE 0x%08llxULL\n"
+          "#define GIC_VERSION %s %s\n"
+          "#define GICC_PERFORMANCE_INTERRUPT_GSI 0x%02llx\n"
+          "#define GICC_VGIC_MAINTENANCE_INTERRUPT 0x%02llx\n"
+          "\n",
+          (unsigned long long)platform->gicrBase,
+          (unsigned long long)platform->gicrStride, version,
+          platform->gicVersion == GIC_V3
+              ? "/* Fix GIC version if using GICv4 */"
+              : "",
+          (unsigned long long)platform->perfGsi,
+          (unsigned long long)platform->vgicGsi);
+  if (platform->cores)
+    fprintf(file, "/* Fix Me: MPIDR values are placeholders, please verify "
+                  "per-platform */\n");
+  for (uint32_t i = 0; i < platform->cores; i++)
+    fprintf(file, "#define GICC_MPIDR_CORE%u 0x%08xULL\n", i, i << 8);
+  fprintf(file,
+          "#define NUM_ITS %u\n"
+          "\n"
+          "MADT_DEFINE_TABLE(NUM_CORES, NUM_ITS, "
+          "ACPI_MADT_TABLE_STRUCTURE_NAME);\n"
+          "MADT_DEFINE_WITH_MAGIC;\n"
+          "\n"
+          "MADT_START{\n"
+          "    /* Table Header */\n"
+          "    MADT_DECLARE_HEADER,\n"
+          "    MADT_DECLARE_HEADER_EXTRA_DATA(0, 0),\n"
+          "    /* GICD Structure */\n"
+          "    MADT_DECLARE_GICD_STRUCTURE(GICD_BASE_ADDRESS, GIC_VERSION),\n"
+          "\n"
+          "%s\n"
+          "    /* GICC Structure */\n",
+          platform->itsCount,
+          platform->itsCount ? "    MADT_DECLARE_GIC_ITS_STRUCTURE(0, "
+                               "GIC_ITS_BASE_ADDRESS, 0),"
+                             : "");
+  for (uint32_t i = 0; i < platform->cores; i++) {
+    fprintf(file,
+            "    MADT_DECLARE_GICC_STRUCTURE(%u, %u, GICC_MPIDR_CORE%u), "
+            "// Core %u%s",
+            i, i, i, i, i + 1 < platform->cores ? "\n" : "");
+  }
+  fprintf(file, "\n} MADT_END;\n");
+  return close_output(file, path);
+}
+
+static int write_mcfg(const DtbPlatform *platform, const char *dir) {
+  const DtbMcfgEntry *entries = platform->mcfg;
+  uint32_t count = platform->mcfgCount;
+  char path[DTB_MAX_PATH];
+  FILE *file;
+
+  file = open_output(dir, "mcfg.h", path, sizeof(path));
+  if (file == NULL)
+    return -EIO;
+  if (count == 0) {
+    fprintf(file, "// No MCFG parameters found in device tree\n");
+  } else {
+    fprintf(file,
+            "#pragma once\n"
+            "#include \"table_header.h\"\n"
+            "#include <common/mcfg.h>\n"
+            "\n"
+            "#define PCI_EC_SPACE_COUNT %u\n",
+            count);
+    for (uint32_t i = 0; i < count; i++)
+      fprintf(file, "#define PCI_EC_%u_BASE_ADDRESS 0x%llXULL  /* %s */\n", i,
+              (unsigned long long)entries[i].base, entries[i].comment);
+    fprintf(file, "\n\n"
+                  "MCFG_DEFINE_TABLE(PCI_EC_SPACE_COUNT);\n"
+                  "MCFG_DEFINE_WITH_MAGIC;\n"
+                  "\n\n"
+                  "MCFG_START {\n"
+                  "    MCFG_DECLARE_HEADER,\n"
+                  "    MCFG_DECLARE_HEADER_EXTRA_DATA,\n");
+    for (uint32_t i = 0; i < count; i++)
+      fprintf(file,
+              "    MCFG_DECLARE_EC_SPACE_STRUCTURE(%u, %u, "
+              "PCI_EC_%u_BASE_ADDRESS, 0x%02X, 0x%02X), // PCI Segment %u\n",
+              i, entries[i].segment, i, entries[i].busStart,
+              entries[i].busEnd, entries[i].segment);
+    fprintf(file, "} MCFG_END\n");
+  }
+  return close_output(file, path);
+}
+
+/**
+ * Write the three headers of one parsed tree into dir.
+ *
+ * @param name  DTB (or SoC) name the OEM revision is inferred from.
+ */
+static int generate_headers(const FdtTree *tree, const char *dir,
+                            const char *name, uint64_t oem_revision,
+                            uint32_t l1) {
+  const char *device = strrchr(dir, '/') ? strrchr(dir, '/') + 1 : dir;
+  DtbPlatform platform;
+  TraceSpan span;
+  int ret;
+
+  trace_begin(&span);
+  ret = dtb_platform_extract(tree, &platform);
+  if (ret == 0 && make_directories(dir) != 0) {
+    log_err("Failed to create %s", dir);
+    ret = -EIO;
+  }
+  if (ret == 0)
+    ret = write_table_header(&platform, dir, name, oem_revision, l1);
+  if (ret == 0)
+    ret = write_madt(&platform, dir);
+  if (ret == 0)
+    ret = write_mcfg(&platform, dir);
+  dtb_platform_free(&platform);
+  trace_end(&span);
+  trace_write(&span, "dtb_to_headers", device, NULL, "generate", tree->size);
+  return ret;
+}
+
+//
+// Batch mode: every DTB of a directory or multi-DTB image is parsed and
+// hashed in parallel, then variants are grouped by the hash of the nodes
+// the ACPI tables are generated from.
+//
+typedef struct {
+  char source[DTB_MAX_PATH]; // file, or file#index for multi-DTB images
+  char model[DTB_MAX_NAME];
+  char soc[DTB_MAX_NAME];
+  const uint8_t *blob;
+  size_t size;
+  FdtTree tree;
+  int status;      // fdt_parse() result, -ENODEV without /cpus (overlays)
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  size_t group;
+} BatchDevice;
+
+typedef struct {
+  BatchDevice *devices;
+  size_t count;
+  size_t capacity;
+  FileContent *files;
+  size_t fileCount;
+  atomic_size_t next;
+} BatchQueue;
+
+typedef struct {
+  uint32_t node;
+  char path[DTB_MAX_PATH];
+} BatchNode;
+
+// Properties holding only phandles, hashed as the target path so variants
+// that number phandles differently still match
+static const char *const phandle_properties[] = {
+    "next-level-cache", "interrupt-parent", "cpu", "cpu-idle-states"};
+
+static const char *const subset_compatibles[] = {
+    "gic-its", "gic,its", "arm,armv7-timer", "arm,armv8-timer",
+    "uart",    "serial",  "pl011"};
+
+static int compare_batch_nodes(const void *a, const void *b) {
+  return strcmp(((const BatchNode *)a)->path, ((const BatchNode *)b)->path);
+}
+
+static int compare_properties(const void *a, const void *b) {
+  return strcmp((*(const FdtProperty *const *)a)->name,
+                (*(const FdtProperty *const *)b)->name);
+}
+
+static bool has_compatible(const FdtTree *tree, uint32_t node,
+                           const char *needle) {
+  const FdtProperty *compatible = fdt_get_property(tree, node, "compatible");
+  return compatible != NULL && fdt_property_has_string(compatible, needle);
+}
+
+/**
+ * Whether a node is part of the ACPI relevant subset: /cpus and the GIC
+ * with their subtrees, ITS, PCIe, architected timer and UART nodes.
+ */
+static bool in_subset(const FdtTree *tree, uint32_t node, const bool *subtree) {
+  if (subtree[node] || dtb_contains_nocase(tree->nodes[node].name, "pcie"))
+    return true;
+  for (size_t i = 0; i < sizeof(subset_compatibles) / sizeof(subset_compatibles[0]); i++) {
+    if (has_compatible(tree, node, subset_compatibles[i]))
+      return true;
+  }
+  return false;
+}
+
+static void hash_property(const FdtTree *tree, const FdtProperty *property,
+                          Sha256Context *sha) {
+  uint32_t length = property->length;
+
+  sha256_update(sha, property->name, strlen(property->name) + 1);
+  for (size_t i = 0; i < sizeof(phandle_properties) / sizeof(phandle_properties[0]); i++) {
+    if (strcmp(property->name, phandle_properties[i]) != 0)
+      continue;
+    for (uint32_t cell = 0; cell < fdt_property_cells(property); cell++) {
+      char path[DTB_MAX_PATH] = "?";
+      uint32_t target =
+          fdt_find_phandle(tree, fdt_property_cell(property, cell));
+      if (target != FDT_NO_NODE)
+        fdt_node_path(tree, target, path, sizeof(path));
+      sha256_update(sha, path, strlen(path) + 1);
+    }
+    return;
+  }
+  sha256_update(sha, &length, sizeof(length));
+  sha256_update(sha, property->value, length);
+}
+
+/**
+ * Canonical hash of the ACPI relevant subset, nodes by path and properties
+ * by name so the blob layout does not matter. phandle values are skipped.
+ */
+static int hash_subset(const FdtTree *tree, uint8_t *digest) {
+  bool *subtree = calloc(tree->nodeCount, sizeof(*subtree));
+  BatchNode *nodes = malloc(tree->nodeCount * sizeof(*nodes));
+  const FdtProperty **properties = NULL;
+  size_t count = 0;
+  Sha256Context sha;
+
+  if (subtree == NULL || nodes == NULL) {
+    free(subtree);
+    free(nodes);
+    return -ENOMEM;
+  }
+  // Pre-order, so a parent is always decided before its children
+  for (uint32_t i = 1; i < tree->nodeCount; i++) {
+    const FdtNode *node = &tree->nodes[i];
+    subtree[i] = subtree[node->parent] ||
+                 (node->parent == 0 && strcmp(node->name, "cpus") == 0) ||
+                 (fdt_get_property(tree, i, "interrupt-controller") &&
+                  has_compatible(tree, i, "gic"));
+    if (!in_subset(tree, i, subtree))
+      continue;
+    nodes[count].node = i;
+    fdt_node_path(tree, i, nodes[count].path, sizeof(nodes[count].path));
+    count++;
+  }
+  qsort(nodes, count, sizeof(*nodes), compare_batch_nodes);
+
+  sha256_init(&sha);
+  for (size_t i = 0; i < count; i++) {
+    const FdtNode *node = &tree->nodes[nodes[i].node];
+    uint32_t kept = 0;
+    const FdtProperty **grown =
+        realloc(properties, (node->propertyCount + 1) * sizeof(*properties));
+    if (grown == NULL) {
+      count = 0;
+      break;
+    }
+    properties = grown;
+    for (uint32_t p = 0; p < node->propertyCount; p++) {
+      const FdtProperty *property =
+          &tree->properties[node->firstProperty + p];
+      if (strcmp(property->name, "phandle") != 0 &&
+          strcmp(property->name, "linux,phandle") != 0)
+        properties[kept++] = property;
+    }
+    qsort(properties, kept, sizeof(*properties), compare_properties);
+    sha256_update(&sha, nodes[i].path, strlen(nodes[i].path) + 1);
+    for (uint32_t p = 0; p < kept; p++)
+      hash_property(tree, properties[p], &sha);
+  }
+  sha256_final(&sha, digest);
+
+  free(properties);
+  free(subtree);
+  free(nodes);
+  return 0;
+}
+
+/**
+ * SoC name from the last root compatible ("qcom,sm8850" -> "sm8850"),
+ * falling back to the file name up to the first '.'.
+ */
+static void device_names(BatchDevice *device, const char *file_name) {
+  const FdtTree *tree = &device->tree;
+  const FdtProperty *compatible = fdt_get_property(tree, 0, "compatible");
+  const FdtProperty *model = fdt_get_property(tree, 0, "model");
+  const char *soc = NULL;
+  size_t length;
+
+  if (compatible != NULL && fdt_property_is_string(compatible)) {
+    for (uint32_t position = 0; position < compatible->length;) {
+      soc = (const char *)compatible->value + position;
+      position += (uint32_t)strlen(soc) + 1;
+    }
+    soc = strchr(soc, ',') ? strchr(soc, ',') + 1 : soc;
+    length = strlen(soc);
+  } else {
+    soc = file_name;
+    length = strcspn(file_name, ".#");
+  }
+  if (length >= sizeof(device->soc))
+    length = sizeof(device->soc) - 1;
+  for (size_t i = 0; i < length; i++)
+    device->soc[i] = isalnum((unsigned char)soc[i]) || soc[i] == '-'
+                         ? soc[i]
+                         : '_';
+  device->soc[length] = '\0';
+
+  if (model != NULL && fdt_property_is_string(model))
+    snprintf(device->model, sizeof(device->model), "%s", model->value);
+}
+
+static void run_batch_job(BatchDevice *device) {
+  const char *name = strrchr(device->source, '/');
+  TraceSpan span;
+
+  trace_begin(&span);
+  device->status = fdt_parse(&device->tree, device->blob, device->size);
+  if (device->status < 0)
+    return;
+  device_names(device, name ? name + 1 : device->source);
+  if (fdt_find_path(&device->tree, "/cpus") == FDT_NO_NODE)
+    device->status = -ENODEV;
+  else
+    device->status = hash_subset(&device->tree, device->digest);
+  trace_end(&span);
+  trace_write(&span, "dtb_to_headers", device->soc, NULL, "parse",
+              device->size);
+}
+
+static void *batch_worker(void *context) {
+  BatchQueue *queue = context;
+  size_t index;
+
+  while ((index = atomic_fetch_add(&queue->next, 1)) < queue->count)
+    run_batch_job(&queue->devices[index]);
+  return NULL;
+}
+
+/**
+ * Load one input file and queue every DTB it contains.
+ *
+ * @retval  Number of DTBs found, negative errno on read errors.
+ */
+static int queue_file(BatchQueue *queue, const char *path) {
+  FileContent *file;
+  size_t offset = 0, size;
+  int found = 0;
+
+  FileContent *grown =
+      realloc(queue->files, (queue->fileCount + 1) * sizeof(*grown));
+  if (grown == NULL)
+    return -ENOMEM;
+  queue->files = grown;
+  file = &queue->files[queue->fileCount];
+  file->filePath = strdup(path);
+  file->fileBuffer = NULL;
+  if (file->filePath == NULL)
+    return -ENOMEM;
+  queue->fileCount++;
+  file->fileSize = get_file_size(file);
+  if (file->fileSize == 0)
+    return 0;
+  file->fileBuffer = malloc(file->fileSize);
+  if (file->fileBuffer == NULL)
+    return -ENOMEM;
+  if (read_file_content(file) == NULL) {
+    log_err("Failed to read %s", path);
+    return -EIO;
+  }
+
+  while ((size = fdt_find_blob(file->fileBuffer, file->fileSize, &offset))) {
+    BatchDevice *device;
+    if (queue->count == queue->capacity) {
+      size_t capacity = queue->capacity ? queue->capacity * 2 : 64;
+      BatchDevice *devices =
+          realloc(queue->devices, capacity * sizeof(*devices));
+      if (devices == NULL)
+        return -ENOMEM;
+      queue->devices = devices;
+      queue->capacity = capacity;
+    }
+    device = &queue->devices[queue->count++];
+    memset(device, 0, sizeof(*device));
+    device->blob = file->fileBuffer + offset;
+    device->size = size;
+    snprintf(device->source, sizeof(device->source), "%s", path);
+    found++;
+    offset += size;
+  }
+  // Name blobs of multi-DTB images by index
+  for (int i = 0; found > 1 && i < found; i++) {
+    BatchDevice *device = &queue->devices[queue->count - found + i];
+    size_t length = strlen(device->source);
+    snprintf(device->source + length, sizeof(device->source) - length, "#%d",
+             i);
+  }
+  return found;
+}
+
+/**
+ * Queue a directory (its regular files, sorted) or a single image.
+ */
+static int queue_input(BatchQueue *queue, const char *input) {
+  char **names = NULL;
+  size_t count = 0;
+  struct dirent *entry;
+  DIR *dir;
+  int ret = 0;
+
+  if (access(input, R_OK) != 0)
+    return -ENOENT;
+  if (!is_directory(input)) {
+    ret = queue_file(queue, input);
+    if (ret == 0)
+      log_warn("No DTB found in %s", input);
+    return ret < 0 ? ret : 0;
+  }
+
+  dir = opendir(input);
+  if (dir == NULL)
+    return -ENOENT;
+  while ((entry = readdir(dir)) != NULL) {
+    char path[DTB_MAX_PATH];
+    char **grown;
+    size_t length = strlen(entry->d_name);
+    // Skip hidden files and the index files of tools/dtb_index.py
+    if (entry->d_name[0] == '.' ||
+        (length > 4 && strcmp(entry->d_name + length - 4, ".idx") == 0))
+      continue;
+    snprintf(path, sizeof(path), "%s/%s", input, entry->d_name);
+    if (is_directory(path))
+      continue;
+    grown = realloc(names, (count + 1) * sizeof(*names));
+    if (grown == NULL || (grown[count] = strdup(path)) == NULL) {
+      names = grown ? grown : names;
+      ret = -ENOMEM;
+      break;
+    }
+    names = grown;
+    count++;
+  }
+  closedir(dir);
+
+  qsort(names, count, sizeof(*names), compare_names);
+  for (size_t i = 0; i < count && ret == 0; i++) {
+    int found = queue_file(queue, names[i]);
+    ret = found < 0 ? found : 0;
+  }
+  for (size_t i = 0; i < count; i++)
+    free(names[i]);
+  free(names);
+  return ret;
+}
+
+/**
+ * Group parsed devices by subset hash, write one header tree per group
+ * under out_root and a devices.txt listing the variants of the group.
+ *
+ * @retval  Number of groups, negative errno on failure.
+ */
+static int write_groups(BatchQueue *queue, const char *out_root,
+                        uint64_t oem_revision, uint32_t l1) {
+  size_t *leaders = malloc(queue->count * sizeof(*leaders));
+  size_t groups = 0;
+  int ret = 0;
+
+  if (leaders == NULL)
+    return -ENOMEM;
+  for (size_t i = 0; i < queue->count; i++) {
+    BatchDevice *device = &queue->devices[i];
+    size_t group;
+    if (device->status < 0)
+      continue;
+    for (group = 0; group < groups; group++) {
+      if (memcmp(queue->devices[leaders[group]].digest, device->digest,
+                 SHA256_DIGEST_SIZE) == 0)
+        break;
+    }
+    if (group == groups)
+      leaders[groups++] = i;
+    device->group = group;
+  }
+
+  for (size_t group = 0; group < groups && ret == 0; group++) {
+    const BatchDevice *leader = &queue->devices[leaders[group]];
+    char hex[SHA256_DIGEST_SIZE * 2 + 1];
+    char name[DTB_MAX_NAME + 16];
+    char dir[DTB_MAX_PATH];
+    char path[DTB_MAX_PATH];
+    size_t same_soc = 0, members = 0;
+    FILE *report;
+
+    // Several groups of one SoC get the hash in their directory name
+    for (size_t other = 0; other < groups; other++)
+      same_soc +=
+          strcmp(queue->devices[leaders[other]].soc, leader->soc) == 0;
+    sha256_to_hex(leader->digest, hex);
+    if (same_soc > 1)
+      snprintf(name, sizeof(name), "%s_%.8s", leader->soc, hex);
+    else
+      snprintf(name, sizeof(name), "%s", leader->soc);
+    if ((size_t)snprintf(dir, sizeof(dir), "%s/%s", out_root, name) >=
+        sizeof(dir)) {
+      log_err("Path too long: %s/%s", out_root, name);
+      ret = -EINVAL;
+      break;
+    }
+
+    ret = generate_headers(&leader->tree, dir, name, oem_revision, l1);
+    if (ret < 0)
+      break;
+    report = open_output(dir, "devices.txt", path, sizeof(path));
+    if (report == NULL) {
+      ret = -EIO;
+      break;
+    }
+    fprintf(report, "# ACPI subset sha256 %s\n# <source> <model>\n", hex);
+    for (size_t i = 0; i < queue->count; i++) {
+      const BatchDevice *device = &queue->devices[i];
+      if (device->status < 0 || device->group != group)
+        continue;
+      fprintf(report, "%s %s\n", device->source, device->model);
+      members++;
+    }
+    ret = close_output(report, path);
+    printf("  %-24s %zu device(s), subset %.16s\n", name, members, hex);
+  }
+  free(leaders);
+  return ret < 0 ? ret : (int)groups;
+}
+
+static int run_batch(char **inputs, int input_count, const char *out_root,
+                     long jobs, uint64_t oem_revision, uint32_t l1) {
+  pthread_t threads[DTB_MAX_JOBS];
+  BatchQueue queue = {0};
+  struct timespec start;
+  size_t skipped = 0;
+  int ret = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < input_count && ret == 0; i++) {
+    ret = queue_input(&queue, inputs[i]);
+    if (ret == -ENOENT)
+      log_err("%s not found", inputs[i]);
+  }
+  if (ret == 0 && queue.count == 0) {
+    log_err("No DTB found");
+    ret = -ENOENT;
+  }
+
+  if (ret == 0) {
+    if (jobs > (long)queue.count)
+      jobs = (long)queue.count;
+    // The calling thread is one of the workers
+    atomic_init(&queue.next, 0);
+    for (long i = 1; i < jobs; i++) {
+      if (pthread_create(&threads[i], NULL, batch_worker, &queue) != 0)
+        jobs = i;
+    }
+    batch_worker(&queue);
+    for (long i = 1; i < jobs; i++)
+      pthread_join(threads[i], NULL);
+
+    for (size_t i = 0; i < queue.count; i++) {
+      const BatchDevice *device = &queue.devices[i];
+      if (device->status == -ENODEV)
+        log_warn("%s: no /cpus node (overlay?), skipped", device->source);
+      else if (device->status < 0)
+        log_warn("%s: not a valid DTB, skipped", device->source);
+      skipped += device->status < 0;
+    }
+    ret = write_groups(&queue, out_root, oem_revision, l1);
+  }
+  if (ret >= 0)
+    log_info("%zu DTB(s) in %zu file(s), %zu skipped, %d group(s) in %s "
+             "(%.2f ms, %ld jobs)",
+             queue.count, queue.fileCount, skipped, ret, out_root,
+             elapsed_ms(&start), jobs);
+
+  for (size_t i = 0; i < queue.count; i++)
+    fdt_close(&queue.devices[i].tree);
+  for (size_t i = 0; i < queue.fileCount; i++) {
+    free(queue.files[i].fileBuffer);
+    free((char *)queue.files[i].filePath);
+  }
+  free(queue.devices);
+  free(queue.files);
+  return ret < 0 ? ret : 0;
+}
+
+int main(int argc, char **argv) {
+  const char *vendor = NULL;
+  const char *out_dir = NULL;
+  char *inputs[DTB_MAX_INPUTS];
+  int input_count = 0;
+  const char *dtb_name;
+  uint64_t oem_revision = 0;
+  uint32_t l1 = 2;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  bool batch = false;
+  bool usage = false;
+  char default_dir[DTB_MAX_PATH];
+  FdtTree tree;
+  struct timespec start;
+  TraceSpan span;
+  int ret;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--vendor") == 0) {
+      vendor = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+      out_dir = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--oem-rev") == 0) {
+      oem_revision = strtoull(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "--l1") == 0) {
+      l1 = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "-j") == 0) {
+      jobs = strtol(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "--batch") == 0) {
+      batch = true;
+    } else if (argv[i][0] != '-' && input_count < DTB_MAX_INPUTS) {
+      inputs[input_count++] = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || vendor == NULL || input_count == 0 ||
+      (!batch && input_count > 1)) {
+    log_warn("Usage: %s --vendor <vendor> [-o out_dir] [--oem-rev rev] "
+             "[--l1 count] <dtb>",
+             argv[0]);
+    log_warn("       %s --vendor <vendor> --batch [-j jobs] [-o out_root] "
+             "[--oem-rev rev] [--l1 count] <dir|dtb.img>...",
+             argv[0]);
+    return -EINVAL;
+  }
+  if (jobs < 1)
+    jobs = 1;
+  if (jobs > DTB_MAX_JOBS)
+    jobs = DTB_MAX_JOBS;
+
+  if (batch) {
+    if (out_dir == NULL) {
+      snprintf(default_dir, sizeof(default_dir), "include/vendor/%s", vendor);
+      out_dir = default_dir;
+    }
+    return run_batch(inputs, input_count, out_dir, jobs, oem_revision, l1);
+  }
+
+  dtb_name = strrchr(inputs[0], '/') ? strrchr(inputs[0], '/') + 1 : inputs[0];
+  if (out_dir == NULL) {
+    snprintf(default_dir, sizeof(default_dir), "include/vendor/%s/%.*s",
+             vendor, (int)strcspn(dtb_name, "."), dtb_name);
+    out_dir = default_dir;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  trace_begin(&span);
+  ret = fdt_open(&tree, inputs[0]);
+  if (ret == -ENOENT)
+    log_err("DTB not found: %s", inputs[0]);
+  else if (ret < 0)
+    log_err("%s is not a valid DTB", inputs[0]);
+  if (ret < 0)
+    return ret;
+  trace_end(&span);
+  trace_write(&span, "dtb_to_headers",
+              strrchr(out_dir, '/') ? strrchr(out_dir, '/') + 1 : out_dir, NULL,
+              "parse", tree.size);
+
+  ret = generate_headers(&tree, out_dir, dtb_name, oem_revision, l1);
+  if (ret == 0)
+    log_info("%u nodes, %u properties, 3 headers in %.2f ms", tree.nodeCount,
+             tree.propertyCount, elapsed_ms(&start));
+  fdt_close(&tree);
+  return ret;
+}
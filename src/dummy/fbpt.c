@@ -0,0 +1 @@
+#include <fbpt.h>
\ No newline at end of file
@@ -0,0 +1 @@
+#include <fpdt.h>
\ No newline at end of file
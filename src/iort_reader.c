@@ -1,4 +1,5 @@
 /* Locate magic and extract table from compiled binaries */
+#include "trace.h"
 #include "utils.h"
 #include <acpi.h>
 #include <common.h>
@@ -8,11 +9,14 @@
 
 int main(int argc, char **argv) {
   uint32_t table_size = 0;
-  uint32_t table_start_offset = 0;
+  size_t table_start_offset = 0;
   ACPI_TABLE_HEADER *table_header = NULL;
   char *output_file_path = NULL;
   FileContent output_table = {0};
   FileContent input_binary = {0};
+  TraceSpan read_span, scan_span, write_span;
+  char device[64];
+  char signature[5];
 
   int ret = 0;
 
@@ -30,25 +34,21 @@ int main(int argc, char **argv) {
     log_err("Failed to get file size for %s", input_binary.filePath);
     return -EINVAL;
   }
+  trace_begin(&read_span);
   input_binary.fileBuffer = malloc(input_binary.fileSize);
   read_file_content(&input_binary);
+  trace_end(&read_span);
 
   // Locate magic in input binary
-  char table_start_magic[] = {'2', 'K', 'D', 'E', 'M', 'O', 'C', 'Q'};
-  for (size_t i = 0x10; i < input_binary.fileSize - sizeof(table_start_magic);
-       i++) {
-    if (memcmp(input_binary.fileBuffer + i, table_start_magic,
-               sizeof(table_start_magic)) == 0) {
-      table_start_offset = i - 0x10; // Adjust to table header start
-    }
-  }
-
-  // Check if table found
-  if (table_start_offset == 0) {
+  trace_begin(&scan_span);
+  ret = locate_qcom_table_in_binary(input_binary.fileBuffer,
+                                    input_binary.fileSize, &table_start_offset);
+  if (ret < 0) {
     free(input_binary.fileBuffer);
     log_err("Table start magic not found in %s", input_binary.filePath);
-    return -ENOENT;
+    return ret;
   }
+  trace_end(&scan_span);
 
   // Map header
   table_header =
@@ -108,6 +108,7 @@ int main(int argc, char **argv) {
   // Write table to output file
   output_table.fileSize = table_size;
   output_table.fileBuffer = malloc(output_table.fileSize);
+  trace_begin(&write_span);
   memcpy(output_table.fileBuffer, input_binary.fileBuffer + table_start_offset,
          output_table.fileSize);
   ret = write_file_content(&output_table);
@@ -119,6 +120,18 @@ int main(int argc, char **argv) {
       free(output_file_path);
     return ret;
   }
+  trace_end(&write_span);
+
+  // Stage spans, the device is the directory of the output table
+  memcpy(signature, table_header->Signature, 4);
+  signature[4] = '\0';
+  trace_device_of(output_table.filePath, device, sizeof(device));
+  trace_write(&read_span, "iort_reader", device, signature, "read",
+              input_binary.fileSize);
+  trace_write(&scan_span, "iort_reader", device, signature, "scan",
+              input_binary.fileSize);
+  trace_write(&write_span, "iort_reader", device, signature, "write",
+              output_table.fileSize);
 
   // Success
   log_info("Table %c%c%c%c extracted to :\t%s", table_header->Signature[0],
@@ -0,0 +1,121 @@
+/* Layout of the shared ACPI types and of the RSDP, XSDT and IORT */
+#include "layout_manifest.h"
+#include <acpi.h>
+#include <common/iort.h>
+#include <common/rsdp.h>
+#include <common/xsdt.h>
+#include <acpi_fields.h>
+
+void layout_common_types(LayoutWriter *writer) {
+  LAYOUT_LIST_TYPE(writer, ACPI_TABLE_HEADER);
+  LAYOUT_LIST_TYPE(writer, ACPI_GENERIC_ADDRESS_STRUCTURE);
+
+  /* RSDP and XSDT, linked by acpi_link */
+  LAYOUT_TYPE(writer, ACPI_RSDP_STRUCTURE,
+              LAYOUT_CHARS_FIELD(ACPI_RSDP_STRUCTURE, Signature),
+              LAYOUT_UINT_FIELD(ACPI_RSDP_STRUCTURE, Checksum),
+              LAYOUT_CHARS_FIELD(ACPI_RSDP_STRUCTURE, OemId),
+              LAYOUT_UINT_FIELD(ACPI_RSDP_STRUCTURE, Revision),
+              LAYOUT_UINT_FIELD(ACPI_RSDP_STRUCTURE, RsdtAddress),
+              LAYOUT_UINT_FIELD(ACPI_RSDP_STRUCTURE, Length),
+              LAYOUT_UINT_FIELD(ACPI_RSDP_STRUCTURE, XsdtAddress),
+              LAYOUT_UINT_FIELD(ACPI_RSDP_STRUCTURE, ExtendedChecksum),
+              LAYOUT_BYTES_FIELD(ACPI_RSDP_STRUCTURE, Reserved));
+  LAYOUT_TYPE(writer, ACPI_XSDT_TABLE_HEADER,
+              LAYOUT_STRUCT_FIELD(ACPI_XSDT_TABLE_HEADER, Header,
+                                  ACPI_TABLE_HEADER));
+
+  /* IORT, built by iort_reader */
+  LAYOUT_LIST_TYPE(writer, IORT_HEADER_EXTRA_DATA);
+  LAYOUT_LIST_TYPE(writer, IORT_NODE_FORMAT);
+  LAYOUT_TYPE(writer, IORT_ID_MAPPING_FORMAT,
+              LAYOUT_UINT_FIELD(IORT_ID_MAPPING_FORMAT, InputBase),
+              LAYOUT_UINT_FIELD(IORT_ID_MAPPING_FORMAT, NumOfIds),
+              LAYOUT_UINT_FIELD(IORT_ID_MAPPING_FORMAT, OutputBase),
+              LAYOUT_UINT_FIELD(IORT_ID_MAPPING_FORMAT, OutputReference),
+              LAYOUT_UINT_FIELD(IORT_ID_MAPPING_FORMAT, Flags));
+  LAYOUT_TYPE(writer, IORT_MEMORY_ACCESS_PROPERTIES,
+              LAYOUT_UINT_FIELD(IORT_MEMORY_ACCESS_PROPERTIES, CCA),
+              LAYOUT_UINT_FIELD(IORT_MEMORY_ACCESS_PROPERTIES, AH),
+              LAYOUT_UINT_FIELD(IORT_MEMORY_ACCESS_PROPERTIES, Reserved),
+              LAYOUT_UINT_FIELD(IORT_MEMORY_ACCESS_PROPERTIES, MAF));
+  LAYOUT_TYPE(
+      writer, IORT_SMMU_V1_V2_NODE,
+      LAYOUT_STRUCT_FIELD(IORT_SMMU_V1_V2_NODE, NodeHeader, IORT_NODE_FORMAT),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, BaseAddress),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, Span),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, Model),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, Flags),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, ReferenceToGlobalInterruptArray),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, NumOfContextInterrupts),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, ReferenceToContextInterruptArray),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, NumOfPMUInterrupts),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, ReferenceToPMUInterruptArray),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, SMMUNSgIrpt),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, SMMUNSgIrptInterruptFlags),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, SMMUNSgCfgIrpt),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V1_V2_NODE, SMMUNSgCfgIrptInterruptFlags));
+  LAYOUT_TYPE(
+      writer, IORT_SMMU_V3_NODE,
+      LAYOUT_STRUCT_FIELD(IORT_SMMU_V3_NODE, NodeHeader, IORT_NODE_FORMAT),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, BaseAddress),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, Flags),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, Reserved),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, VATOSAddress),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, Model),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, Event),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, PRI),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, GERR),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, Sync),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, ProximityDomain),
+      LAYOUT_UINT_FIELD(IORT_SMMU_V3_NODE, DeviceIDMappingIndex));
+  LAYOUT_TYPE(writer, IORT_PMCG_NODE,
+              LAYOUT_STRUCT_FIELD(IORT_PMCG_NODE, NodeHeader, IORT_NODE_FORMAT),
+              LAYOUT_UINT_FIELD(IORT_PMCG_NODE, Page0BaseAddress),
+              LAYOUT_UINT_FIELD(IORT_PMCG_NODE, OverflowInterruptGSIV),
+              LAYOUT_UINT_FIELD(IORT_PMCG_NODE, NodeReference),
+              LAYOUT_UINT_FIELD(IORT_PMCG_NODE, Page1BaseAddress));
+  LAYOUT_TYPE(
+      writer, IORT_ITS_GROUP_NODE,
+      LAYOUT_STRUCT_FIELD(IORT_ITS_GROUP_NODE, NodeHeader, IORT_NODE_FORMAT),
+      LAYOUT_UINT_FIELD(IORT_ITS_GROUP_NODE, NumOfITS));
+  LAYOUT_TYPE(
+      writer, IORT_NAMED_COMPONENT_NODE,
+      LAYOUT_STRUCT_FIELD(IORT_NAMED_COMPONENT_NODE, NodeHeader,
+                          IORT_NODE_FORMAT),
+      LAYOUT_UINT_FIELD(IORT_NAMED_COMPONENT_NODE, Flags),
+      LAYOUT_STRUCT_FIELD(IORT_NAMED_COMPONENT_NODE, MemAccessProps,
+                          IORT_MEMORY_ACCESS_PROPERTIES),
+      LAYOUT_UINT_FIELD(IORT_NAMED_COMPONENT_NODE,
+                        DeviceMemoryAddressSizeLimit));
+  LAYOUT_TYPE(
+      writer, IORT_PCI_ROOT_COMPLEX_NODE,
+      LAYOUT_STRUCT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, NodeHeader,
+                          IORT_NODE_FORMAT),
+      LAYOUT_STRUCT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, MemAccessProps,
+                          IORT_MEMORY_ACCESS_PROPERTIES),
+      LAYOUT_UINT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, ATSAttribute),
+      LAYOUT_UINT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, PCISegmentNumber),
+      LAYOUT_UINT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, MemoryAddressSizeLimit),
+      LAYOUT_UINT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, PASIDCapabilities),
+      LAYOUT_UINT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, Reserved),
+      LAYOUT_UINT_FIELD(IORT_PCI_ROOT_COMPLEX_NODE, Flags));
+  LAYOUT_TYPE(
+      writer, IORT_MEMORY_RANGE_DESCIPTOR,
+      LAYOUT_UINT_FIELD(IORT_MEMORY_RANGE_DESCIPTOR, PhysicalRangeOffset),
+      LAYOUT_UINT_FIELD(IORT_MEMORY_RANGE_DESCIPTOR, PhysicalRangeLength),
+      LAYOUT_UINT_FIELD(IORT_MEMORY_RANGE_DESCIPTOR, Reserved));
+  LAYOUT_TYPE(writer, IORT_RESERVED_MEMORY_RANGE_NODE,
+              LAYOUT_STRUCT_FIELD(IORT_RESERVED_MEMORY_RANGE_NODE, NodeHeader,
+                                  IORT_NODE_FORMAT),
+              LAYOUT_UINT_FIELD(IORT_RESERVED_MEMORY_RANGE_NODE, Flags),
+              LAYOUT_UINT_FIELD(IORT_RESERVED_MEMORY_RANGE_NODE,
+                                NumOfMemoryRangeDescriptors),
+              LAYOUT_UINT_FIELD(IORT_RESERVED_MEMORY_RANGE_NODE,
+                                ReferenceToMemoryRangeDescriptor));
+  LAYOUT_TYPE(writer, IORT_IWB_NODE,
+              LAYOUT_STRUCT_FIELD(IORT_IWB_NODE, NodeHeader, IORT_NODE_FORMAT),
+              LAYOUT_UINT_FIELD(IORT_IWB_NODE, Reserved),
+              LAYOUT_UINT_FIELD(IORT_IWB_NODE, ConfigFrameBase),
+              LAYOUT_UINT_FIELD(IORT_IWB_NODE, IWBIndex));
+}
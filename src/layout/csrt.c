@@ -0,0 +1,33 @@
+/* Layout of the device CSRT */
+#define table_with_magic layout_csrt_table_with_magic
+#include <csrt.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_csrt(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "CSRT", ACPI_CSRT_REVISION,
+                     ACPI_CSRT_TABLE_STRUCTURE_NAME, ACPI_CSRT_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+#ifdef CSRT_RG_TIMER_VENDOR_DEFINED_INFO_LENGTH
+  LAYOUT_CONFIG(writer, CSRT_RG_TIMER_VENDOR_DEFINED_INFO_LENGTH);
+#endif
+#ifdef CSRT_RG_MISC_VENDOR_DEFINED_INFO_LENGTH
+  LAYOUT_CONFIG(writer, CSRT_RG_MISC_VENDOR_DEFINED_INFO_LENGTH);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, CSRT_RESOURCE_GROUPS_HEADER_FORMAT);
+  LAYOUT_TYPE(writer, CSRT_RESOURCE_DESCRIPTOR_FORMAT,
+              LAYOUT_UINT_FIELD(CSRT_RESOURCE_DESCRIPTOR_FORMAT, Length),
+              LAYOUT_UINT_FIELD(CSRT_RESOURCE_DESCRIPTOR_FORMAT, ResourceType),
+              LAYOUT_UINT_FIELD(CSRT_RESOURCE_DESCRIPTOR_FORMAT,
+                                ResourceSubType),
+              LAYOUT_UINT_FIELD(CSRT_RESOURCE_DESCRIPTOR_FORMAT, UID));
+
+  /* Resource groups are named per device, they are the body */
+  LAYOUT_TYPE(writer, ACPI_CSRT_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_CSRT_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_BODY_AFTER(ACPI_CSRT_TABLE_STRUCTURE_NAME, Header));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_CSRT_TABLE_STRUCTURE_NAME);
+}
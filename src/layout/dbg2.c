@@ -0,0 +1,37 @@
+/* Layout of the device DBG2 */
+#define table_with_magic layout_dbg2_table_with_magic
+#include <dbg2.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_dbg2(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "DBG2", ACPI_DBG2_REVISION,
+                     ACPI_DBG2_TABLE_STRUCTURE_NAME, ACPI_DBG2_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+#ifdef UARD_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, UARD_BASE_ADDRESS);
+#endif
+#ifdef UARD_NUM_GAS
+  LAYOUT_CONFIG(writer, UARD_NUM_GAS);
+#endif
+#ifdef URS0_NUM_GAS
+  LAYOUT_CONFIG(writer, URS0_NUM_GAS);
+#endif
+#ifdef USB_OEM_DATA_SIZE
+  LAYOUT_CONFIG(writer, USB_OEM_DATA_SIZE);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, ACPI_GAS);
+  LAYOUT_LIST_TYPE(writer, DBG2_HEADER_EXTRA_DATA);
+
+  /* Debug device information structures are named per device */
+  LAYOUT_TYPE(writer, ACPI_DBG2_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_DBG2_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_DBG2_TABLE_STRUCTURE_NAME,
+                                  Dbg2HeaderExtraData, DBG2_HEADER_EXTRA_DATA),
+              LAYOUT_BODY_AFTER(ACPI_DBG2_TABLE_STRUCTURE_NAME,
+                                Dbg2HeaderExtraData));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_DBG2_TABLE_STRUCTURE_NAME);
+}
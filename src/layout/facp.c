@@ -0,0 +1,26 @@
+/* Layout of the device FACP (FADT) */
+#define table_with_magic layout_facp_table_with_magic
+#include <facp.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_facp(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "FACP", ACPI_FACP_REVISION,
+                     ACPI_FACP_TABLE_STRUCTURE_NAME, ACPI_FACP_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+#ifdef FACP_RESET_REG_ADDRESS
+  LAYOUT_CONFIG(writer, FACP_RESET_REG_ADDRESS);
+#endif
+#ifdef ACPI_FACP_HYP_VENDOR_ID
+  LAYOUT_CONFIG(writer, ACPI_FACP_HYP_VENDOR_ID);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, FACP_DATA_STRUCTURE);
+  LAYOUT_TYPE(writer, ACPI_FACP_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_FACP_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_FACP_TABLE_STRUCTURE_NAME,
+                                  FacpDataStructure, FACP_DATA_STRUCTURE));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_FACP_TABLE_STRUCTURE_NAME);
+}
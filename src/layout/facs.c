@@ -0,0 +1,17 @@
+/* Layout of the device FACS */
+#define table_with_magic layout_facs_table_with_magic
+#include <facs.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_facs(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "FACS", ACPI_FACS_REVISION,
+                     ACPI_FACS_TABLE_STRUCTURE_NAME, ACPI_FACS_SIGNATURE);
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, ACPI_FACS_TABLE);
+  LAYOUT_TYPE(writer, ACPI_FACS_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_FACS_TABLE_STRUCTURE_NAME, FacsData,
+                                  ACPI_FACS_TABLE));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_FACS_TABLE_STRUCTURE_NAME);
+}
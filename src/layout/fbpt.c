@@ -0,0 +1,23 @@
+/* Layout of the device FBPT template */
+#define table_with_magic layout_fbpt_table_with_magic
+#include <fbpt.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_fbpt(LayoutWriter *writer) {
+  /* No ACPI header, so no revision either */
+  LAYOUT_BEGIN_TABLE(writer, "FBPT", 0,
+                     ACPI_FBPT_TABLE_STRUCTURE_NAME, ACPI_FBPT_SIGNATURE);
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, FPDT_PERFORMANCE_RECORD_HEADER);
+  LAYOUT_LIST_TYPE(writer, FBPT_HEADER);
+  LAYOUT_LIST_TYPE(writer, FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD);
+  LAYOUT_TYPE(writer, ACPI_FBPT_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_FBPT_TABLE_STRUCTURE_NAME, Header,
+                                  FBPT_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_FBPT_TABLE_STRUCTURE_NAME,
+                                  BasicBootPerformanceData,
+                                  FBPT_BASIC_BOOT_PERFORMANCE_DATA_RECORD));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_FBPT_TABLE_STRUCTURE_NAME);
+}
@@ -0,0 +1,24 @@
+/* Layout of the device FPDT */
+#define table_with_magic layout_fpdt_table_with_magic
+#include <fpdt.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_fpdt(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "FPDT", ACPI_FPDT_REVISION,
+                     ACPI_FPDT_TABLE_STRUCTURE_NAME, ACPI_FPDT_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+#ifdef FPDT_FBPT_ADDRESS
+  LAYOUT_CONFIG(writer, FPDT_FBPT_ADDRESS);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, FPDT_PERFORMANCE_RECORD_HEADER);
+  LAYOUT_LIST_TYPE(writer, FPDT_FBPT_POINTER_RECORD);
+  LAYOUT_TYPE(writer, ACPI_FPDT_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_FPDT_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_FPDT_TABLE_STRUCTURE_NAME,
+                                  FbptPointerRecord, FPDT_FBPT_POINTER_RECORD));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_FPDT_TABLE_STRUCTURE_NAME);
+}
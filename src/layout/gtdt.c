@@ -0,0 +1,36 @@
+/* Layout of the device GTDT */
+#define table_with_magic layout_gtdt_table_with_magic
+#include <gtdt.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_gtdt(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "GTDT", ACPI_GTDT_REVISION,
+                     ACPI_GTDT_TABLE_STRUCTURE_NAME, ACPI_GTDT_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, GTDT_HEADER_EXTRA_DATA);
+  LAYOUT_TYPE(
+      writer, GTDT_BLOCK_TIMER_STRUCTURE,
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, GTFrameNumber),
+      LAYOUT_BYTES_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, Reserved),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, CNTBaseX),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, CNTEL0BaseX),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, PhysicalTimerGSI),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, PhysicalTimerFlags),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, VirtualTimerGSI),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, VirtualTimerFlags),
+      LAYOUT_UINT_FIELD(GTDT_BLOCK_TIMER_STRUCTURE, CommonFlags));
+  LAYOUT_LIST_TYPE(writer, ACPI_GTDT_GENERIC_WDT_STRUCTURE);
+
+  /* Timer blocks and watchdogs are named per device */
+  LAYOUT_TYPE(writer, ACPI_GTDT_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_GTDT_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_GTDT_TABLE_STRUCTURE_NAME,
+                                  GTDTHeaderExtraData, GTDT_HEADER_EXTRA_DATA),
+              LAYOUT_BODY_AFTER(ACPI_GTDT_TABLE_STRUCTURE_NAME,
+                                GTDTHeaderExtraData));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_GTDT_TABLE_STRUCTURE_NAME);
+}
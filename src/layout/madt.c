@@ -0,0 +1,63 @@
+/* Layout of the device MADT */
+#define table_with_magic layout_madt_table_with_magic
+#include <madt.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_madt(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "MADT", ACPI_MADT_REVISION,
+                     ACPI_MADT_TABLE_STRUCTURE_NAME, ACPI_MADT_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+  LAYOUT_CONFIG(writer, NUM_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_0_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_1_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_2_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_3_CORES);
+#ifdef NUM_ITS
+  LAYOUT_CONFIG(writer, NUM_ITS);
+#endif
+#ifdef GIC_VERSION
+  LAYOUT_CONFIG(writer, GIC_VERSION);
+#endif
+#ifdef GICD_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, GICD_BASE_ADDRESS);
+#endif
+#ifdef GIC_ITS_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, GIC_ITS_BASE_ADDRESS);
+#endif
+#ifdef GICR_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, GICR_BASE_ADDRESS);
+#endif
+#ifdef GICR_STRIDE
+  LAYOUT_CONFIG(writer, GICR_STRIDE);
+#endif
+#ifdef GICC_PERFORMANCE_INTERRUPT_GSI
+  LAYOUT_CONFIG(writer, GICC_PERFORMANCE_INTERRUPT_GSI);
+#endif
+#ifdef GICC_VGIC_MAINTENANCE_INTERRUPT
+  LAYOUT_CONFIG(writer, GICC_VGIC_MAINTENANCE_INTERRUPT);
+#endif
+#ifdef GICC_HAS_TRBE_INTERRUPT
+  layout_config(writer, "GICC_HAS_TRBE_INTERRUPT", 1);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, MADT_HEADER_EXTRA_DATA);
+  LAYOUT_LIST_TYPE(writer, MADT_GICC_STRUCTURE);
+  LAYOUT_LIST_TYPE(writer, MADT_GICD_STRUCTURE);
+  LAYOUT_LIST_TYPE(writer, MADT_GIC_MSI_FRAME_STRUCTURE);
+  LAYOUT_LIST_TYPE(writer, MADT_GICR_STRUCTURE);
+  LAYOUT_LIST_TYPE(writer, MADT_GIC_ITS_STRUCTURE);
+  LAYOUT_TYPE(writer, ACPI_MADT_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_MADT_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_MADT_TABLE_STRUCTURE_NAME,
+                                  MadtHeaderExtraData, MADT_HEADER_EXTRA_DATA),
+              LAYOUT_STRUCT_FIELD(ACPI_MADT_TABLE_STRUCTURE_NAME,
+                                  GicDStructure, MADT_GICD_STRUCTURE),
+              LAYOUT_STRUCT_FIELD(ACPI_MADT_TABLE_STRUCTURE_NAME,
+                                  GicItsStructures, MADT_GIC_ITS_STRUCTURE),
+              LAYOUT_STRUCT_FIELD(ACPI_MADT_TABLE_STRUCTURE_NAME,
+                                  GiccStructures, MADT_GICC_STRUCTURE));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_MADT_TABLE_STRUCTURE_NAME);
+}
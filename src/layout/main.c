@@ -0,0 +1,55 @@
+/* Write the layout manifest of one device */
+#include "layout_manifest.h"
+#include "utils.h"
+#include <errno.h>
+#include <string.h>
+
+/** Usage
+
+  <device>_layout device layout.json
+
+  Writes the layout manifest of device, see include/layout_manifest.h.
+  The program is built once per device from src/layout/<table>.c of the
+  tables the device has, the others are weak and left out.
+*/
+
+#define LAYOUT_WEAK_TABLE(name)                                                \
+  extern __typeof__(layout_table_##name) layout_table_##name                   \
+      __attribute__((weak));
+LAYOUT_TABLES(LAYOUT_WEAK_TABLE)
+
+#define LAYOUT_TABLE_ENTRY(name) layout_table_##name,
+static void (*const layout_tables[])(LayoutWriter *) = {
+    LAYOUT_TABLES(LAYOUT_TABLE_ENTRY)};
+
+int main(int argc, char **argv) {
+  LayoutWriter writer;
+  unsigned count = 0;
+  int ret;
+
+  if (argc != 3) {
+    log_warn("Usage: %s device layout.json", argv[0]);
+    return -EINVAL;
+  }
+
+  ret = layout_open(&writer, argv[1]);
+  if (ret < 0)
+    return ret;
+  layout_common_types(&writer);
+  for (size_t i = 0; i < sizeof(layout_tables) / sizeof(layout_tables[0]);
+       i++) {
+    if (layout_tables[i] != NULL) {
+      layout_tables[i](&writer);
+      count++;
+    }
+  }
+
+  ret = layout_write(&writer, argv[2]);
+  if (ret == 0)
+    log_info("Wrote %s: %u table(s), %u type(s)", argv[2], count,
+             writer.typeCount);
+  else
+    log_err("Failed to write the layout manifest of %s: %d", argv[1], ret);
+  layout_close(&writer);
+  return ret;
+}
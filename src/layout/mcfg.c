@@ -0,0 +1,33 @@
+/* Layout of the device MCFG */
+#define table_with_magic layout_mcfg_table_with_magic
+#include <mcfg.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_mcfg(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "MCFG", ACPI_MCFG_REVISION,
+                     ACPI_MCFG_TABLE_STRUCTURE_NAME, ACPI_MCFG_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+#ifdef PCI_EC_SPACE_COUNT
+  LAYOUT_CONFIG(writer, PCI_EC_SPACE_COUNT);
+#endif
+#ifdef PCI_EC_0_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, PCI_EC_0_BASE_ADDRESS);
+#endif
+#ifdef PCI_EC_1_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, PCI_EC_1_BASE_ADDRESS);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, MCFG_HEADER_EXTRA_DATA);
+  LAYOUT_LIST_TYPE(writer, MCFG_MEM_MAP_EC_SPACE_STRUCTURE);
+  LAYOUT_TYPE(writer, ACPI_MCFG_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_MCFG_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_MCFG_TABLE_STRUCTURE_NAME,
+                                  MadtHeaderExtraData, MCFG_HEADER_EXTRA_DATA),
+              LAYOUT_STRUCT_FIELD(ACPI_MCFG_TABLE_STRUCTURE_NAME,
+                                  MemMapEcSpaceBaseAddrStructure,
+                                  MCFG_MEM_MAP_EC_SPACE_STRUCTURE));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_MCFG_TABLE_STRUCTURE_NAME);
+}
@@ -0,0 +1,72 @@
+/* Layout of the device PPTT */
+#define table_with_magic layout_pptt_table_with_magic
+#include <pptt.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_pptt(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "PPTT", ACPI_PPTT_REVISION,
+                     ACPI_PPTT_TABLE_STRUCTURE_NAME, ACPI_PPTT_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+  LAYOUT_CONFIG(writer, NUM_SYSTEM);
+  LAYOUT_CONFIG(writer, NUM_CLUSTERS);
+  LAYOUT_CONFIG(writer, NUM_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_0_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_1_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_2_CORES);
+  LAYOUT_CONFIG(writer, NUM_CLUSTER_3_CORES);
+  LAYOUT_CONFIG(writer, L1_CACHES_COUNT);
+  LAYOUT_CONFIG(writer, L2_CACHES_COUNT);
+  LAYOUT_CONFIG(writer, L3_CACHES_COUNT);
+  LAYOUT_CONFIG(writer, SYSTEM_PRIVATE_RESOURCES_COUNT);
+  LAYOUT_CONFIG(writer, CLUSTER_PRIVATE_RESOURCES_COUNT);
+  LAYOUT_CONFIG(writer, PHYSICAL_CPU_PRIVATE_RESOURCES_COUNT);
+  layout_end_table(writer);
+
+  LAYOUT_TYPE(writer, ACPI_PPTT_PRIVATE_RESOURCE,
+              LAYOUT_UINT_FIELD(ACPI_PPTT_PRIVATE_RESOURCE, reference));
+  LAYOUT_LIST_TYPE(writer, ACPI_PPTT_PROCESSOR_HIERARCHY_NODE);
+  LAYOUT_LIST_TYPE(writer, ACPI_PPTT_CACHE_TYPE_STRUCTURE);
+  LAYOUT_LIST_TYPE(writer, ACPI_PPTT_ID);
+
+  /* Processor nodes with their private resources, sized per device */
+  LAYOUT_TYPE(writer, ACPI_PPTT_PROCESSOR_HIERARCHY_SYSTEM,
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_PROCESSOR_HIERARCHY_SYSTEM,
+                                  ProcNode,
+                                  ACPI_PPTT_PROCESSOR_HIERARCHY_NODE),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_PROCESSOR_HIERARCHY_SYSTEM,
+                                  PrivateResources,
+                                  ACPI_PPTT_PRIVATE_RESOURCE));
+  LAYOUT_TYPE(writer, ACPI_PPTT_PROCESSOR_HIERARCHY_CLUSTER,
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_PROCESSOR_HIERARCHY_CLUSTER,
+                                  ProcNode,
+                                  ACPI_PPTT_PROCESSOR_HIERARCHY_NODE),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_PROCESSOR_HIERARCHY_CLUSTER,
+                                  PrivateResources,
+                                  ACPI_PPTT_PRIVATE_RESOURCE));
+  LAYOUT_TYPE(writer, ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU,
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU,
+                                  ProcNode,
+                                  ACPI_PPTT_PROCESSOR_HIERARCHY_NODE),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU,
+                                  PrivateResources,
+                                  ACPI_PPTT_PRIVATE_RESOURCE));
+  LAYOUT_TYPE(writer, ACPI_PPTT_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_TABLE_STRUCTURE_NAME, Id,
+                                  ACPI_PPTT_ID),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_TABLE_STRUCTURE_NAME,
+                                  CacheTypeStructures,
+                                  ACPI_PPTT_CACHE_TYPE_STRUCTURE),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_TABLE_STRUCTURE_NAME,
+                                  SystemHierarchyNode,
+                                  ACPI_PPTT_PROCESSOR_HIERARCHY_SYSTEM),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_TABLE_STRUCTURE_NAME,
+                                  ClusterHierarchyNodes,
+                                  ACPI_PPTT_PROCESSOR_HIERARCHY_CLUSTER),
+              LAYOUT_STRUCT_FIELD(ACPI_PPTT_TABLE_STRUCTURE_NAME,
+                                  PhysicalCpuHierarchyNodes,
+                                  ACPI_PPTT_PROCESSOR_HIERARCHY_PHYSICAL_CPU));
+  LAYOUT_MAGIC_TYPE(writer, ACPI_PPTT_TABLE_STRUCTURE_NAME);
+}
@@ -0,0 +1,37 @@
+/* Layout of the device SPCR */
+#define table_with_magic layout_spcr_table_with_magic
+#include <spcr.h>
+#include <acpi_fields.h>
+#include "layout_manifest.h"
+
+void layout_table_spcr(LayoutWriter *writer) {
+  LAYOUT_BEGIN_TABLE(writer, "SPCR", ACPI_SPCR_REVISION,
+                     ACPI_SPCR_TABLE_STRUCTURE_NAME, ACPI_SPCR_SIGNATURE);
+  LAYOUT_HEADER_CONFIG(writer);
+#ifdef UARD_BASE_ADDRESS
+  LAYOUT_CONFIG(writer, UARD_BASE_ADDRESS);
+#endif
+#ifdef UARD_GIC_SPI_INTERRUPT_NUMBER
+  LAYOUT_CONFIG(writer, UARD_GIC_SPI_INTERRUPT_NUMBER);
+#endif
+  layout_end_table(writer);
+
+  LAYOUT_LIST_TYPE(writer, ACPI_GAS);
+  LAYOUT_LIST_TYPE(writer, SPCR_HEADER_EXTRA_DATA);
+#if ACPI_SPCR_REVISION == 4
+  LAYOUT_TYPE(writer, ACPI_SPCR_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_SPCR_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_SPCR_TABLE_STRUCTURE_NAME,
+                                  SPCRHeaderExtraData, SPCR_HEADER_EXTRA_DATA),
+              LAYOUT_CHARS_FIELD(ACPI_SPCR_TABLE_STRUCTURE_NAME,
+                                 NamespaceString));
+#else
+  LAYOUT_TYPE(writer, ACPI_SPCR_TABLE_STRUCTURE_NAME,
+              LAYOUT_STRUCT_FIELD(ACPI_SPCR_TABLE_STRUCTURE_NAME, Header,
+                                  ACPI_TABLE_HEADER),
+              LAYOUT_STRUCT_FIELD(ACPI_SPCR_TABLE_STRUCTURE_NAME,
+                                  SPCRHeaderExtraData, SPCR_HEADER_EXTRA_DATA));
+#endif
+  LAYOUT_MAGIC_TYPE(writer, ACPI_SPCR_TABLE_STRUCTURE_NAME);
+}
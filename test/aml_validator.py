@@ -5,28 +5,31 @@ Validates that generated PPTT.aml files comply with ACPI specification
 """
 
 import sys
-import struct
 from pathlib import Path
 
+from layout_manifest import LayoutManifest, manifest_for
+
 
 class ACPITableHeader:
-    """ACPI Table Header Structure"""
-    SIZE = 36
-    
-    def __init__(self, data):
-        if len(data) < self.SIZE:
-            raise ValueError(f"Data too short, at least {self.SIZE} bytes required")
-        
-        self.signature = data[0:4].decode('ascii', errors='ignore')
-        self.length = struct.unpack('<I', data[4:8])[0]
-        self.revision = data[8]
-        self.checksum = data[9]
-        self.oem_id = data[10:16].decode('ascii', errors='ignore').rstrip()
-        self.oem_table_id = data[16:24].decode('ascii', errors='ignore').rstrip()
-        self.oem_revision = struct.unpack('<I', data[24:28])[0]
-        self.creator_id = data[28:32].decode('ascii', errors='ignore')
-        self.creator_revision = struct.unpack('<I', data[32:36])[0]
-    
+    """ACPI Table Header Structure, ACPI_TABLE_HEADER of the layout manifest"""
+
+    def __init__(self, data, manifest: LayoutManifest):
+        layout = manifest.type('ACPI_TABLE_HEADER')
+        self.size = layout.size
+        if len(data) < self.size:
+            raise ValueError(f"Data too short, at least {self.size} bytes required")
+
+        fields = layout.unpack(data)
+        self.signature = fields['Signature'].decode('ascii', errors='ignore')
+        self.length = fields['Length']
+        self.revision = fields['Revision']
+        self.checksum = fields['Checksum']
+        self.oem_id = fields['OemId'].decode('ascii', errors='ignore').rstrip()
+        self.oem_table_id = fields['OemTableId'].decode('ascii', errors='ignore').rstrip()
+        self.oem_revision = fields['OemRevision']
+        self.creator_id = fields['CreatorId'].decode('ascii', errors='ignore')
+        self.creator_revision = fields['CreatorRevision']
+
     def __str__(self):
         return f"""ACPI Table Header:
   Signature: {self.signature}
@@ -46,12 +49,15 @@ def calculate_checksum(data):
     return (0x100 - (total & 0xFF)) & 0xFF
 
 
-def validate_pptt_structure(data, header):
-    """Validate PPTT structure"""
+def validate_pptt_structure(data, header, manifest):
+    """Validate PPTT structure, node sizes from the layout manifest"""
     errors = []
     warnings = []
+    processor_size = manifest.type('ACPI_PPTT_PROCESSOR_HIERARCHY_NODE').size
+    cache_size = manifest.type('ACPI_PPTT_CACHE_TYPE_STRUCTURE').size
+    id_size = manifest.type('ACPI_PPTT_ID').size
     
-    offset = ACPITableHeader.SIZE
+    offset = header.size
     node_count = 0
     
     while offset < len(data):
@@ -72,11 +78,14 @@ def validate_pptt_structure(data, header):
         
         # Validate node type
         if node_type == 0:  # Processor Hierarchy Node
-            if node_length < 20:  # Minimum length
+            if node_length < processor_size:  # Minimum length
                 errors.append(f"Offset 0x{offset:04x}: Processor node too short")
         elif node_type == 1:  # Cache Type Structure
-            if node_length != 28:  # Fixed length
-                warnings.append(f"Offset 0x{offset:04x}: Cache node length abnormal ({node_length} != 28)")
+            if node_length != cache_size:  # Fixed length
+                warnings.append(f"Offset 0x{offset:04x}: Cache node length abnormal ({node_length} != {cache_size})")
+        elif node_type == 2:  # ID Structure
+            if node_length < id_size:
+                errors.append(f"Offset 0x{offset:04x}: ID node too short")
         else:
             warnings.append(f"Offset 0x{offset:04x}: Unknown node type {node_type}")
         
@@ -98,13 +107,15 @@ def validate_aml_file(file_path):
         print(f"❌ Cannot read file: {e}")
         return False
     
-    if len(data) < ACPITableHeader.SIZE:
-        print(f"❌ File too short ({len(data)} bytes < {ACPITableHeader.SIZE} bytes)")
+    try:
+        manifest = manifest_for(file_path)
+    except (OSError, ValueError) as e:
+        print(f"❌ Cannot read layout manifest: {e}")
         return False
     
     # Parse header
     try:
-        header = ACPITableHeader(data)
+        header = ACPITableHeader(data, manifest)
         print(header)
         print()
     except Exception as e:
@@ -144,12 +155,12 @@ def validate_aml_file(file_path):
     calculated_checksum = calculate_checksum(data)
     # FACS (Firmware ACPI Control Structure) is not required to have an
     # ACPI header checksum in-place; allow non-zero checksum for FACS as a
-    # compatibility workaround.
-    if header.signature == 'FACS':
+    # compatibility workaround. FBPT only has signature + length, no checksum.
+    if header.signature in ('FACS', 'FBPT'):
         if calculated_checksum == 0:
-            print(f"✅ Checksum correct (FACS): 0x{header.checksum:02x}")
+            print(f"✅ Checksum correct ({header.signature}): 0x{header.checksum:02x}")
         else:
-            print(f"ℹ️  FACS table: checksum not required/verified (calculated 0x{calculated_checksum:02x})")
+            print(f"ℹ️  {header.signature} table: checksum not required/verified (calculated 0x{calculated_checksum:02x})")
     else:
         if calculated_checksum != 0:
             print(f"❌ Checksum error: calculated 0x{calculated_checksum:02x} (should be 0)")
@@ -158,7 +169,7 @@ def validate_aml_file(file_path):
     
     # Validate structure (PPTT-specific validation)
     if header.signature == 'PPTT':
-        errors, warnings, node_count = validate_pptt_structure(data, header)
+        errors, warnings, node_count = validate_pptt_structure(data, header, manifest)
         print(f"✅ Found {node_count} PPTT node(s)")
     else:
         # For non-PPTT tables, skip structure validation
@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+"""
+DTB Fixture Test
+The test writes a small synthetic DTB (two clusters sharing an L2, GICv3
+with ITS, armv8 timer, two PCIe root ports) and checks the DTB tools on it:
+ - dtb_to_headers writes the same headers as the tools/dtb_to_*.py scripts,
+   run with <dtb>.idx removed before each one (cold) and then kept (warm)
+ - dtb_to_aml writes the bytes of the normal pipeline: dtb_to_headers output
+   (with the qcom/sm8850 pptt.h and gtdt.h), compiled with the table flags
+   and extracted by acpi_extractor. The tables are compared with
+   acpi_manifest, the acpi_diff report is printed when they differ.
+ - truncated and malformed blobs make dtb_to_headers and dtb_to_aml fail
+   with an error, not a crash, and write nothing
+
+Usage: dtb_fixture.py [build_dir] [--cc compiler] [--cflags flags]
+"""
+
+import argparse
+import shlex
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+ROOT_DIR = Path(__file__).resolve().parent.parent
+VENDOR = 'qcom'
+SOC = 'sm9999'  # OEM revision 0x9999, inferred from the DTB name
+REFERENCE = ROOT_DIR / 'include' / 'vendor' / VENDOR / 'sm8850'
+TABLES = ('madt', 'mcfg', 'pptt', 'gtdt')
+# Header written by each script, and its extra arguments
+SCRIPTS = (('dtb_to_table_header.py', 'table_header.h', ['--vendor', VENDOR]),
+           ('dtb_to_madt.py', 'madt.h', ['--vendor', VENDOR]),
+           ('dtb_to_mcfg.py', 'mcfg.h', ['--vendor', VENDOR]))
+CFLAGS = '-std=gnu11 -Wall -Wextra -O2 -Wno-missing-braces'
+
+FDT_MAGIC = 0xD00DFEED
+FDT_BEGIN_NODE = 1
+FDT_END_NODE = 2
+FDT_PROP = 3
+FDT_END = 9
+
+
+def cells(*values) -> bytes:
+    return struct.pack('>%dI' % len(values), *values)
+
+
+def strings(*values) -> bytes:
+    return b''.join(value.encode() + b'\0' for value in values)
+
+
+class FdtWriter:
+    """Flattened tree writer, version 17 with an empty reservation map"""
+
+    def __init__(self):
+        self.structure = bytearray()
+        self.names = bytearray()
+        self.offsets = {}
+        self.unaligned_end = None  # End of the first value that needs padding
+
+    def align(self):
+        self.structure += b'\0' * (-len(self.structure) % 4)
+
+    def begin(self, name: str):
+        self.structure += cells(FDT_BEGIN_NODE) + name.encode() + b'\0'
+        self.align()
+
+    def end(self):
+        self.structure += cells(FDT_END_NODE)
+
+    def prop(self, name: str, value: bytes = b''):
+        if name not in self.offsets:
+            self.offsets[name] = len(self.names)
+            self.names += name.encode() + b'\0'
+        self.structure += cells(FDT_PROP, len(value), self.offsets[name]) + value
+        if self.unaligned_end is None and len(value) % 4:
+            self.unaligned_end = len(self.structure)
+        self.align()
+
+    def blob(self, struct_size: int = None) -> bytes:
+        structure = bytes(self.structure) + cells(FDT_END)
+        reservations = 40
+        struct_offset = reservations + 16
+        strings_offset = struct_offset + len(structure)
+        total = strings_offset + len(self.names)
+        header = cells(FDT_MAGIC, total, struct_offset, strings_offset,
+                       reservations, 17, 16, 0, len(self.names),
+                       len(structure) if struct_size is None else struct_size)
+        return header + bytes(16) + structure + bytes(self.names)
+
+
+def node(fdt: FdtWriter, name: str, properties, children=()):
+    fdt.begin(name)
+    for prop_name, value in properties:
+        fdt.prop(prop_name, value)
+    for child in children:
+        child(fdt)
+    fdt.end()
+
+
+def fixture_dtb(unaligned_end: bool = False) -> bytes:
+    """sm8850 like layout: 6 + 2 cores, one shared L2, no L3
+
+    With unaligned_end, size_dt_struct stops inside the padding of the first
+    value that has some. The tokens after it are still valid, a parser that
+    steps past the end keeps going and accepts the blob.
+    """
+    l2 = 1
+    cpus = [(lambda fdt, i=i: node(fdt, f'cpu@{i:x}00', [
+        ('device_type', strings('cpu')),
+        ('compatible', strings('arm,armv8')),
+        ('reg', cells(0, i << 8)),
+        ('next-level-cache', cells(l2)),
+        ('phandle', cells(0x10 + i)),
+    ])) for i in range(8)]
+    fdt = FdtWriter()
+    node(fdt, '', [
+        ('#address-cells', cells(2)),
+        ('#size-cells', cells(2)),
+        ('model', strings(f'Synthetic {SOC}')),
+        ('compatible', strings(f'{VENDOR},{SOC}')),
+    ], [
+        lambda fdt: node(fdt, 'cpus', [('#address-cells', cells(2)), ('#size-cells', cells(0))],
+                         cpus + [
+            lambda fdt: node(fdt, 'l2-cache', [('compatible', strings('cache')),
+                                               ('phandle', cells(l2))]),
+        ]),
+        lambda fdt: node(fdt, 'timer', [
+            ('compatible', strings('arm,armv8-timer')),
+            # Secure, non secure, virtual and EL2 PPIs of the sm8850 gtdt.h
+            ('interrupts', cells(1, 13, 8, 1, 14, 8, 1, 11, 8, 1, 10, 8)),
+        ]),
+        lambda fdt: node(fdt, 'soc@0', [
+            ('#address-cells', cells(1)),
+            ('#size-cells', cells(1)),
+            ('ranges', b''),
+        ], [
+            lambda fdt: node(fdt, 'interrupt-controller@17100000', [
+                ('compatible', strings('arm,gic-v3')),
+                ('interrupt-controller', b''),
+                ('#interrupt-cells', cells(3)),
+                ('reg', cells(0x17100000, 0x10000, 0x17180000, 0x200000)),
+                ('redistributor-stride', cells(0, 0x40000)),
+                ('interrupts', cells(1, 9, 4)),
+            ], [
+                lambda fdt: node(fdt, 'msi-controller@17140000', [
+                    ('compatible', strings('arm,gic-v3-its', 'qcom,gic-its')),
+                    ('msi-controller', b''),
+                    ('reg', cells(0x17140000, 0x20000)),
+                ]),
+            ]),
+            # Clusters as qcom trees describe them, CPUs per GIC class
+            lambda fdt: node(fdt, 'gic-interrupt-router@17a00000', [
+                ('qcom,gic-class0', cells(*range(6))),
+                ('qcom,gic-class1', cells(6, 7)),
+            ]),
+            # Config space range, then a root port with only a 64 bit range
+            lambda fdt: node(fdt, 'pcie@1c00000', [
+                ('device_type', strings('pci')),
+                ('linux,pci-domain', cells(0)),
+                ('bus-range', cells(0, 0xFF)),
+                ('ranges', cells(0x00000000, 0, 0, 0, 0x40000000, 0, 0x10000000,
+                                 0x02000000, 0, 0x50000000, 0, 0x50000000, 0, 0x10000000)),
+            ]),
+            lambda fdt: node(fdt, 'pcie@1c08000', [
+                ('device_type', strings('pci')),
+                ('linux,pci-domain', cells(1)),
+                ('bus-range', cells(0, 0x7F)),
+                ('ranges', cells(0x83000000, 4, 0, 4, 0x40000000, 0, 0x40000000)),
+            ]),
+        ]),
+    ])
+    return fdt.blob(fdt.unaligned_end if unaligned_end else None)
+
+
+def malformed_dtbs() -> dict:
+    blob = fixture_dtb()
+    return {
+        'truncated': blob[:len(blob) // 2],
+        'unaligned structure end': fixture_dtb(unaligned_end=True),
+    }
+
+
+def run(command, failures: list, what: str) -> bool:
+    result = subprocess.run([str(part) for part in command], capture_output=True, text=True)
+    if result.returncode != 0:
+        failures.append(f"{what} failed ({result.returncode}):\n{result.stdout}{result.stderr}")
+    return result.returncode == 0
+
+
+def build_tables(build_dir: Path, include: Path, out_dir: Path, cc: str, cflags: str,
+                 failures: list):
+    """The normal build of one device: compile each table, extract its AML"""
+    vendor = include / 'vendor' / VENDOR
+    target = vendor / SOC
+    out_dir.mkdir(parents=True)
+    for table in TABLES:
+        source = ROOT_DIR / 'src' / 'dummy' / f'{table}.c'
+        obj = out_dir / f'{table}.o'
+        if not run([cc, *shlex.split(cflags), '-I', include, '-I', vendor, '-I', target,
+                    '-c', source, '-o', obj], failures, f"compiling {table}.c"):
+            continue
+        run([build_dir / 'acpi_extractor', obj, out_dir / f'{table.upper()}.aml'],
+            failures, f"extracting {table.upper()}.aml")
+        obj.unlink()
+
+
+def compare_headers(expected_dir: Path, actual_dir: Path, what: str, failures: list):
+    for _, header, _ in SCRIPTS:
+        expected = expected_dir / header
+        actual = actual_dir / header
+        if not actual.exists():
+            failures.append(f"{what}: {header} was not written")
+        elif expected.read_bytes() != actual.read_bytes():
+            failures.append(f"{what}: {header} differs from dtb_to_headers")
+
+
+def run_scripts(dtb: Path, out_dir: Path, failures: list, cold: bool):
+    """Cold: every script parses the blob, warm: every script loads <dtb>.idx"""
+    index = Path(str(dtb) + '.idx')
+    for script, header, extra in SCRIPTS:
+        if cold:
+            index.unlink(missing_ok=True)
+        run([sys.executable, ROOT_DIR / 'tools' / script, dtb, *extra, '-o', out_dir / header],
+            failures, script)
+
+
+def check_scripts(build_dir: Path, work: Path, dtb: Path, failures: list):
+    """dtb_to_headers against the Python scripts it replaces, whose
+    tools/dtb_index.py index claims the bytes of a fresh parse"""
+    native = work / 'native'
+    index = Path(str(dtb) + '.idx')
+    if not run([build_dir / 'dtb_to_headers', '--vendor', VENDOR, '-o', native, dtb],
+               failures, "dtb_to_headers"):
+        return
+    run_scripts(dtb, work / 'cold', failures, cold=True)
+    compare_headers(native, work / 'cold', "scripts, cold index", failures)
+    if not index.exists():
+        failures.append(f"{index.name} was not written")
+        return
+    saved = index.stat().st_mtime_ns, index.read_bytes()
+    run_scripts(dtb, work / 'warm', failures, cold=False)
+    compare_headers(native, work / 'warm', "scripts, warm index", failures)
+    if (index.stat().st_mtime_ns, index.read_bytes()) != saved:
+        failures.append(f"{index.name} was rebuilt instead of loaded")
+
+
+def check_malformed(build_dir: Path, work: Path, failures: list):
+    """Broken blobs are rejected with an exit status, not a signal"""
+    for name, blob in malformed_dtbs().items():
+        case = work / 'malformed' / name.replace(' ', '_')
+        case.mkdir(parents=True)
+        dtb = case / f'{SOC}.dtb'
+        dtb.write_bytes(blob)
+        for tool, extra in (('dtb_to_headers', []), ('dtb_to_aml', ['-I', ROOT_DIR / 'include'])):
+            out_dir = case / tool
+            result = subprocess.run([str(part) for part in [build_dir / tool, '--vendor', VENDOR,
+                                                           *extra, '-o', out_dir, dtb]],
+                                    capture_output=True, text=True)
+            if result.returncode <= 0:
+                failures.append(f"{tool} on the {name} DTB returned {result.returncode}:\n"
+                                f"{result.stdout}{result.stderr}")
+            elif out_dir.exists() and any(out_dir.iterdir()):
+                failures.append(f"{tool} on the {name} DTB wrote {sorted(p.name for p in out_dir.iterdir())}")
+
+
+def check_aml(build_dir: Path, work: Path, dtb: Path, cc: str, cflags: str, failures: list):
+    include = work / 'include'
+    shutil.copytree(ROOT_DIR / 'include', include, ignore=shutil.ignore_patterns('vendor'))
+    target = include / 'vendor' / VENDOR / SOC
+    target.mkdir(parents=True)
+    shutil.copy(ROOT_DIR / 'include' / 'vendor' / VENDOR / 'acpi_vendor.h', target.parent)
+    if not run([build_dir / 'dtb_to_headers', '--vendor', VENDOR, '-o', target, dtb],
+               failures, "dtb_to_headers"):
+        return
+    for header in ('pptt.h', 'gtdt.h'):
+        shutil.copy(REFERENCE / header, target)
+
+    device = f'{VENDOR}_{SOC}'
+    headers_build = work / 'headers'
+    aml_build = work / 'aml'
+    aml_build.mkdir()
+    build_tables(build_dir, include, headers_build / device, cc, cflags, failures)
+    if not run([build_dir / 'dtb_to_aml', '--vendor', VENDOR, '-I', include,
+                '-o', aml_build / device, dtb], failures, "dtb_to_aml") or failures:
+        return
+
+    manifest = work / 'headers.manifest'
+    run([build_dir / 'acpi_manifest', 'write', headers_build, manifest], failures,
+        "acpi_manifest write")
+    result = subprocess.run([str(build_dir / 'acpi_manifest'), 'check', str(aml_build),
+                             str(manifest)], capture_output=True, text=True)
+    if result.returncode != 0:
+        diff = subprocess.run([str(build_dir / 'acpi_diff'), str(headers_build),
+                               str(aml_build)], capture_output=True, text=True)
+        failures.append(f"dtb_to_aml differs from the header build:\n{diff.stdout}{diff.stderr}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check the DTB tools against the normal build on a synthetic DTB")
+    parser.add_argument('build_dir', nargs='?', default=str(ROOT_DIR / 'build'),
+                        help="build directory holding the tools (default: <repo>/build)")
+    parser.add_argument('--cc', default='cc', help="C compiler of the table build")
+    parser.add_argument('--cflags', default=CFLAGS, help="flags of the table build")
+    args = parser.parse_args()
+
+    build_dir = Path(args.build_dir).resolve()
+    for tool in ('dtb_to_headers', 'dtb_to_aml', 'acpi_extractor', 'acpi_manifest', 'acpi_diff'):
+        if not (build_dir / tool).exists():
+            print(f"{tool} not found in {args.build_dir}")
+            sys.exit(1)
+
+    failures = []
+    with tempfile.TemporaryDirectory() as temp:
+        work = Path(temp)
+        dtb = work / f'{SOC}.dtb'
+        dtb.write_bytes(fixture_dtb())
+        check_scripts(build_dir, work, dtb, failures)
+        check_aml(build_dir, work, dtb, args.cc, args.cflags, failures)
+        check_malformed(build_dir, work, failures)
+
+    if failures:
+        for failure in failures:
+            print(f"FAIL: {failure}")
+        sys.exit(1)
+    print(f"dtb_to_headers matches the scripts (cold and warm index), dtb_to_aml matches the build of its "
+          f"output ({len(TABLES)} tables), {len(malformed_dtbs())} malformed DTBs rejected")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""
+acpi_dump / iasl Comparison Test
+acpi_dump stands in for "iasl -d" on hosts without iasl, so both must print
+the same fields. Every <device>/<SIG>.aml of a build is disassembled by
+both and the field lines ("[offset decimal length] Name : Value") are
+compared. Comments, decoded flag bits and the raw hex dump are not.
+
+Usage: dump_iasl.py [build_dir] [--iasl path]
+"""
+
+import argparse
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+ROOT_DIR = Path(__file__).resolve().parent.parent
+# FBPT is not a standalone ACPI table, iasl cannot disassemble it
+SKIPPED = {'FBPT'}
+# Newer iasl prints the length as "004h", older ones as "  4"
+FIELD_LINE = re.compile(r'^\[([0-9A-F]+)h\s+\d+\s+([0-9A-F]+h|\d+)\]\s*(.*?)\s*:\s*(.*?)\s*$')
+
+
+def field_lines(text: str):
+    """(offset, length, name, value) of every field line, spacing folded"""
+    fields = []
+    for line in text.splitlines():
+        match = FIELD_LINE.match(line)
+        if match:
+            offset, length, name, value = match.groups()
+            length = int(length[:-1], 16) if length.endswith('h') else int(length)
+            fields.append((int(offset, 16), length, name, ' '.join(value.split())))
+    return fields
+
+
+def describe(field) -> str:
+    if field is None:
+        return "(none)"
+    offset, length, name, value = field
+    return f"[{offset:03X}h {length}] {name} : {value}"
+
+
+def compare_table(dump: Path, iasl: str, aml: Path, work: Path) -> list:
+    result = subprocess.run([str(dump), str(aml)], capture_output=True, text=True)
+    if result.returncode != 0:
+        return [f"acpi_dump failed ({result.returncode}): {result.stderr.strip()}"]
+    ours = field_lines(result.stdout)
+
+    shutil.copy(aml, work / aml.name)
+    result = subprocess.run([iasl, '-d', aml.name], cwd=work, capture_output=True, text=True)
+    dsl = work / f'{aml.stem}.dsl'
+    if not dsl.exists():
+        return [f"iasl -d failed ({result.returncode}): {result.stdout.strip()}"]
+    theirs = field_lines(dsl.read_text(errors='replace'))
+
+    for index in range(max(len(ours), len(theirs))):
+        mine = ours[index] if index < len(ours) else None
+        other = theirs[index] if index < len(theirs) else None
+        if mine != other:
+            return [f"field {index} differs", f"  acpi_dump: {describe(mine)}",
+                    f"  iasl -d:   {describe(other)}"]
+    return []
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare acpi_dump with iasl -d on every table of a build")
+    parser.add_argument('build_dir', nargs='?', default=str(ROOT_DIR / 'build'),
+                        help="build directory holding acpi_dump and the tables (default: <repo>/build)")
+    parser.add_argument('--iasl', default=shutil.which('iasl'), help="iasl executable (default: from PATH)")
+    args = parser.parse_args()
+
+    build_dir = Path(args.build_dir).resolve()
+    dump = build_dir / 'acpi_dump'
+    if not dump.exists():
+        print(f"acpi_dump not found in {args.build_dir}")
+        sys.exit(1)
+    if not args.iasl:
+        print("iasl not found")
+        sys.exit(1)
+
+    tables = sorted(aml for device in build_dir.iterdir()
+                    if device.is_dir() and device.name != 'CMakeFiles'
+                    for aml in device.glob('*.aml') if aml.stem not in SKIPPED)
+    failures = 0
+    for aml in tables:
+        with tempfile.TemporaryDirectory() as temp:
+            problems = compare_table(dump, args.iasl, aml, Path(temp))
+        if problems:
+            failures += 1
+            print(f"FAIL: {aml.parent.name}/{aml.name}: " + '\n'.join(problems))
+
+    if failures:
+        print(f"{failures} of {len(tables)} table(s) differ between acpi_dump and iasl -d")
+        sys.exit(1)
+    print(f"acpi_dump matches iasl -d on all {len(tables)} table(s)")
+
+
+if __name__ == "__main__":
+    main()
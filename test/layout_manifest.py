@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+Layout Manifest Reader
+Reads <build>/<device>/layout.json, written by the <device>_layout host
+program from the C structures (include/layout_manifest.h, src/layout/).
+It gives the offset and size of every member of the table structures and
+the configuration macros the device tables were built with, so the tests
+do not repeat struct layouts or parse the headers.
+
+Usage: layout_manifest.py <device dir | layout.json> [type ...]
+       (prints the tables, or the layout of the given types)
+"""
+
+import json
+import struct
+import sys
+from dataclasses import dataclass
+from functools import lru_cache
+from pathlib import Path
+from typing import Dict, List, Union
+
+MANIFEST_NAME = 'layout.json'
+
+# struct format of the little endian integers, by size
+UINT_FORMATS = {1: 'B', 2: 'H', 4: 'I', 8: 'Q'}
+
+
+@dataclass(frozen=True)
+class FieldLayout:
+    name: str
+    offset: int
+    size: int   # Whole member, all elements of an array
+    count: int  # Array elements, 1 for scalars
+    kind: str   # uint, chars, bytes or struct
+    type: str = ''  # Element type of struct fields
+
+    @property
+    def format(self) -> str:
+        """struct format of the member: integers are unpacked one by one,
+        everything else as bytes"""
+        if self.kind == 'uint':
+            if self.count == 0:
+                return ''
+            return UINT_FORMATS[self.size // self.count] * self.count
+        return f'{self.size}s'
+
+
+@dataclass(frozen=True)
+class TypeLayout:
+    name: str
+    size: int
+    fields: List[FieldLayout]
+
+    def field(self, name: str) -> FieldLayout:
+        for member in self.fields:
+            if member.name == name:
+                return member
+        raise KeyError(f"{self.name} has no member {name}")
+
+    def offset(self, name: str) -> int:
+        return self.field(name).offset
+
+    @property
+    def struct(self) -> struct.Struct:
+        return struct.Struct('<' + ''.join(member.format for member in self.fields))
+
+    def unpack(self, data: bytes, offset: int = 0) -> Dict[str, Union[int, bytes, tuple]]:
+        """Members by name, integer arrays as tuples and character arrays
+        as bytes"""
+        values = iter(self.struct.unpack_from(data, offset))
+        members = {}
+        for member in self.fields:
+            if member.kind == 'uint' and member.count != 1:
+                members[member.name] = tuple(next(values) for _ in range(member.count))
+            else:
+                members[member.name] = next(values)
+        return members
+
+
+@dataclass(frozen=True)
+class TableLayout:
+    name: str       # AML file name without .aml
+    signature: str
+    revision: int
+    struct: str     # Top level type
+    size: int
+    config: Dict[str, Union[int, str]]
+
+
+class LayoutManifest:
+    """layout.json of one device"""
+
+    def __init__(self, path: Path):
+        self.path = Path(path)
+        data = json.loads(self.path.read_text())
+        self.device: str = data['device']
+        self.tables: Dict[str, TableLayout] = {
+            name: TableLayout(name, t['signature'], t['revision'], t['struct'], t['size'], t['config'])
+            for name, t in data['tables'].items()}
+        self.types: Dict[str, TypeLayout] = {
+            name: TypeLayout(name, t['size'], [FieldLayout(**f) for f in t['fields']])
+            for name, t in data['types'].items()}
+
+    def type(self, name: str) -> TypeLayout:
+        try:
+            return self.types[name]
+        except KeyError:
+            raise KeyError(f"{self.path}: no layout for {name}") from None
+
+    def table(self, name: str) -> TableLayout:
+        try:
+            return self.tables[name]
+        except KeyError:
+            raise KeyError(f"{self.path}: {self.device} has no {name} table") from None
+
+    def config(self, table: str, macro: str, default=None):
+        """Configuration macro a table was built with, default if the
+        device does not define it"""
+        return self.table(table).config.get(macro, default)
+
+
+@lru_cache(maxsize=None)
+def load_manifest(path: Path) -> LayoutManifest:
+    """Manifest of a device directory, or of a layout.json path"""
+    path = Path(path)
+    if path.is_dir():
+        path = path / MANIFEST_NAME
+    if not path.exists():
+        raise FileNotFoundError(f"Cannot find layout manifest {path}, build the 'layout' target")
+    return LayoutManifest(path)
+
+
+def manifest_for(aml_path: Path) -> LayoutManifest:
+    """Manifest of the device an AML file was built for"""
+    return load_manifest(Path(aml_path).resolve().parent)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: python layout_manifest.py <device dir | layout.json> [type ...]")
+        sys.exit(1)
+
+    manifest = load_manifest(Path(sys.argv[1]))
+    if len(sys.argv) == 2:
+        print(f"{manifest.device}: {len(manifest.tables)} table(s), {len(manifest.types)} type(s)")
+        for table in manifest.tables.values():
+            print(f"  {table.name}: {table.signature} revision {table.revision}, "
+                  f"{table.struct} ({table.size} bytes)")
+            for macro, value in table.config.items():
+                print(f"    {macro} = {value}")
+        return
+
+    for name in sys.argv[2:]:
+        layout = manifest.type(name)
+        print(f"{layout.name} ({layout.size} bytes)")
+        for member in layout.fields:
+            element = f" {member.type}" if member.type else ""
+            array = f"[{member.count}]" if member.count > 1 else ""
+            print(f"  0x{member.offset:03X} {member.name}{array}: {member.kind}{element}, {member.size} bytes")
+
+
+if __name__ == "__main__":
+    main()
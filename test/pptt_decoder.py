@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+PPTT Binary Decoder
+Streaming decoder for PPTT.aml, following the structures of
+include/common/pptt.h: processor hierarchy nodes with their private
+resources (type 0), cache type structures for revision 1 (24 bytes) and
+revision 3 (28 bytes, Cache ID) (type 1) and ID structures (type 2).
+Structure layouts come from the layout manifest of the device
+(layout_manifest.py).
+
+Used by verify_node_references.py and pptt_validate.py, so neither needs
+iasl or its text format.
+
+Usage: pptt_decoder.py <PPTT.aml>   (prints the decoded nodes)
+"""
+
+import struct
+import sys
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, Iterator, List, Optional, Union
+
+from aml_validator import ACPITableHeader
+from layout_manifest import LayoutManifest, manifest_for
+
+# Subtable types
+PPTT_TYPE_PROCESSOR = 0
+PPTT_TYPE_CACHE = 1
+PPTT_TYPE_ID = 2
+
+# Processor Structure Flags (Table 5.190)
+PPTT_PROC_FLAG_PHYSICAL_PACKAGE = 1 << 0
+PPTT_PROC_FLAG_ACPI_PROC_ID_VALID = 1 << 1
+PPTT_PROC_FLAG_PROCESSOR_IS_THREAD = 1 << 2
+PPTT_PROC_FLAG_NODE_IS_LEAF = 1 << 3
+PPTT_PROC_FLAG_IDENTICAL_IMPLEMENTATION = 1 << 4
+
+# Cache Attributes bits 3:2
+PPTT_CACHE_TYPE_NAMES = {0: 'Data', 1: 'Instruction', 2: 'Unified', 3: 'Unified'}
+
+
+@dataclass(frozen=True)
+class PPTTLayouts:
+    """Subtable structures of a device, from its layout manifest"""
+    header_size: int
+    processor: struct.Struct
+    resource: struct.Struct
+    cache: struct.Struct  # Up to LineSize, the revision 1 structure
+    cache_size: int       # sizeof(ACPI_PPTT_CACHE_TYPE_STRUCTURE) as built
+    cache_id_offset: int  # Of the revision 3 CacheId, after LineSize
+    id: struct.Struct
+
+    @classmethod
+    def from_manifest(cls, manifest: LayoutManifest) -> 'PPTTLayouts':
+        cache = manifest.type('ACPI_PPTT_CACHE_TYPE_STRUCTURE')
+        line_size = cache.field('LineSize')
+        rev1 = [f for f in cache.fields if f.offset <= line_size.offset]
+        return cls(manifest.type('ACPI_TABLE_HEADER').size,
+                   manifest.type('ACPI_PPTT_PROCESSOR_HIERARCHY_NODE').struct,
+                   manifest.type('ACPI_PPTT_PRIVATE_RESOURCE').struct,
+                   struct.Struct('<' + ''.join(f.format for f in rev1)),
+                   cache.size, line_size.offset + line_size.size,
+                   manifest.type('ACPI_PPTT_ID').struct)
+
+
+@dataclass
+class ProcessorHierarchyNode:
+    offset: int
+    length: int
+    flags: int
+    parent: int
+    acpi_processor_id: int
+    private_resources: List[int] = field(default_factory=list)
+
+    @property
+    def node_type(self):
+        return PPTT_TYPE_PROCESSOR
+
+
+@dataclass
+class CacheTypeStructure:
+    offset: int
+    length: int
+    flags: int
+    next_level: int
+    size: int
+    number_of_sets: int
+    associativity: int
+    attributes: int
+    line_size: int
+    cache_id: Optional[int] = None  # Revision 3 only
+
+    @property
+    def node_type(self):
+        return PPTT_TYPE_CACHE
+
+    @property
+    def cache_type(self):
+        return PPTT_CACHE_TYPE_NAMES[(self.attributes >> 2) & 0x3]
+
+
+@dataclass
+class IdStructure:
+    offset: int
+    length: int
+    vendor_id: int
+    level1_id: int
+    level2_id: int
+    major_revision: int
+    minor_revision: int
+    spin_revision: int
+
+    @property
+    def node_type(self):
+        return PPTT_TYPE_ID
+
+
+PPTTNode = Union[ProcessorHierarchyNode, CacheTypeStructure, IdStructure]
+
+
+class PPTTDecodeError(ValueError):
+    """Subtable stream is not well formed (offset is the failing subtable)"""
+
+    def __init__(self, offset: int, message: str):
+        super().__init__(f"0x{offset:03X}: {message}")
+        self.offset = offset
+
+
+def iter_subtables(data: bytes, layouts: PPTTLayouts, end: Optional[int] = None) -> Iterator[PPTTNode]:
+    """Decode the subtables one by one, from the end of the header to the
+    table length. Raises PPTTDecodeError on a truncated or zero length
+    subtable; nodes before it have already been yielded."""
+    end = len(data) if end is None else min(end, len(data))
+    processor, resource, cache, id_node = layouts.processor, layouts.resource, layouts.cache, layouts.id
+    offset = layouts.header_size
+    while offset < end:
+        if offset + 2 > end:
+            raise PPTTDecodeError(offset, "Truncated subtable header")
+        node_type, length = data[offset], data[offset + 1]
+        if length < 2:
+            raise PPTTDecodeError(offset, f"Invalid subtable length {length}")
+        if offset + length > end:
+            raise PPTTDecodeError(offset, f"Subtable length {length} exceeds table length {end}")
+        body = data[offset:offset + length]
+
+        if node_type == PPTT_TYPE_PROCESSOR:
+            if length < processor.size:
+                raise PPTTDecodeError(offset, f"Processor node too short ({length} bytes)")
+            _, _, _, flags, parent, acpi_id, count = processor.unpack_from(body)
+            if processor.size + resource.size * count > length:
+                raise PPTTDecodeError(offset, f"{count} private resource(s) do not fit in {length} bytes")
+            resources = [resource.unpack_from(body, processor.size + resource.size * i)[0]
+                         for i in range(count)]
+            yield ProcessorHierarchyNode(offset, length, flags, parent, acpi_id, resources)
+        elif node_type == PPTT_TYPE_CACHE:
+            if length < cache.size:
+                raise PPTTDecodeError(offset, f"Cache type structure too short ({length} bytes)")
+            _, _, _, flags, next_level, size, sets, assoc, attributes, line_size = cache.unpack_from(body)
+            cache_id = None
+            if length >= layouts.cache_id_offset + 4:
+                cache_id = struct.unpack_from('<I', body, layouts.cache_id_offset)[0]
+            yield CacheTypeStructure(offset, length, flags, next_level, size, sets, assoc,
+                                     attributes, line_size, cache_id)
+        elif node_type == PPTT_TYPE_ID:
+            if length < id_node.size:
+                raise PPTTDecodeError(offset, f"ID structure too short ({length} bytes)")
+            _, _, _, vendor, level1, level2, major, minor, spin = id_node.unpack_from(body)
+            yield IdStructure(offset, length, vendor, level1, level2, major, minor, spin)
+        else:
+            raise PPTTDecodeError(offset, f"Unknown subtable type {node_type}")
+        offset += length
+
+
+@dataclass
+class PPTTTable:
+    header: ACPITableHeader
+    nodes: Dict[int, PPTTNode]  # By offset, in table order
+    errors: List[str]
+    warnings: List[str]
+
+    @property
+    def processors(self) -> List[ProcessorHierarchyNode]:
+        return [n for n in self.nodes.values() if isinstance(n, ProcessorHierarchyNode)]
+
+    @property
+    def caches(self) -> List[CacheTypeStructure]:
+        return [n for n in self.nodes.values() if isinstance(n, CacheTypeStructure)]
+
+    def leaves(self) -> List[ProcessorHierarchyNode]:
+        """Processor nodes no other node points to as parent (the CPUs)"""
+        parents = {n.parent for n in self.processors}
+        return [n for n in self.processors if n.offset not in parents]
+
+
+def decode_pptt(data: bytes, manifest: LayoutManifest) -> PPTTTable:
+    """Decode a whole PPTT with the layouts of manifest. Stream errors end
+    the walk and are reported in errors together with header problems; the
+    nodes decoded up to there are kept."""
+    header = ACPITableHeader(data, manifest)
+    layouts = PPTTLayouts.from_manifest(manifest)
+    errors, warnings = [], []
+    if header.signature != 'PPTT':
+        errors.append(f"Signature is '{header.signature}', expected 'PPTT'")
+    if header.length != len(data):
+        errors.append(f"Header length {header.length} does not match file size {len(data)}")
+    if sum(data[:header.length]) & 0xFF:
+        errors.append(f"Checksum invalid (sum={sum(data[:header.length]) & 0xFF})")
+
+    nodes: Dict[int, PPTTNode] = {}
+    try:
+        for node in iter_subtables(data, layouts, header.length):
+            nodes[node.offset] = node
+    except PPTTDecodeError as e:
+        errors.append(str(e))
+
+    # Cache structure size follows the table revision (pptt.h)
+    expected = layouts.cache_size
+    for cache in (n for n in nodes.values() if isinstance(n, CacheTypeStructure)):
+        if cache.length != expected:
+            warnings.append(f"0x{cache.offset:03X}: Cache type structure is {cache.length} bytes, "
+                            f"revision {header.revision} uses {expected}")
+    return PPTTTable(header, nodes, errors, warnings)
+
+
+def describe(node: PPTTNode) -> str:
+    if isinstance(node, ProcessorHierarchyNode):
+        res = ", ".join(f"0x{r:03X}" for r in node.private_resources) or "None"
+        return (f"Processor Node (Flags=0x{node.flags:X}, Parent=0x{node.parent:03X}, "
+                f"ACPI ID={node.acpi_processor_id}, Resources=[{res}])")
+    if isinstance(node, CacheTypeStructure):
+        cache_id = f", Cache ID={node.cache_id}" if node.cache_id is not None else ""
+        return (f"Cache Node ({node.cache_type}, Size={node.size}, Ways={node.associativity}, "
+                f"Line={node.line_size}, Next Level=0x{node.next_level:03X}{cache_id})")
+    return f"ID Node (Vendor=0x{node.vendor_id:08X}, Level1=0x{node.level1_id:X}, Level2=0x{node.level2_id:X})"
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: python pptt_decoder.py <PPTT.aml>")
+        sys.exit(1)
+
+    path = Path(sys.argv[1])
+    table = decode_pptt(path.read_bytes(), manifest_for(path))
+    print(f"PPTT revision {table.header.revision}, {table.header.length} bytes, {len(table.nodes)} node(s)")
+    for offset, node in table.nodes.items():
+        print(f"  0x{offset:03X}: {describe(node)}")
+    for warning in table.warnings:
+        print(f"⚠️  {warning}")
+    for error in table.errors:
+        print(f"❌ {error}")
+    sys.exit(1 if table.errors else 0)
+
+
+if __name__ == "__main__":
+    main()
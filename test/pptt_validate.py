@@ -1,329 +1,256 @@
 #!/usr/bin/env python3
 """
 PPTT Validation Tool
-Validates PPTT table correctness by parsing iasl-generated DSL files and C header configurations
+Validates PPTT table correctness by decoding PPTT.aml and comparing the
+topology with the configuration the device PPTT was built with, as written
+to <build_dir>/<device>/layout.json (layout_manifest.py)
+
+The iasl/acpi_dump disassembly is only read with --dsl, as a cross-check
+of the decoded nodes.
+
+Usage: pptt_validate.py [build_dir] [device ...] [--dsl]
 """
 
+import argparse
 import re
 import sys
 from pathlib import Path
 from typing import Dict, List, Optional
 
+from layout_manifest import load_manifest
+from pptt_decoder import (PPTT_PROC_FLAG_ACPI_PROC_ID_VALID, PPTTTable,
+                          ProcessorHierarchyNode, decode_pptt)
 
-class HeaderParser:
-    """Parse configurations in C header files"""
-    
-    def __init__(self, header_path: Path):
-        self.header_path = header_path
-        self.defines = {}
-        self._parse()
-    
-    def _parse(self):
-        """Parse header file"""
-        content = self.header_path.read_text()
-        
-        # Match #define macros
-        pattern = r'#define\s+(\w+)\s+(.+?)(?://.*)?$'
-        for match in re.finditer(pattern, content, re.MULTILINE):
-            name = match.group(1)
-            value = match.group(2).strip()
-            
-            # Evaluate expressions (simple support)
-            try:
-                if isinstance(value, str):
-                    if 'KB' in value or 'MB' in value:
-                        value = value.replace('KB', '* 1024').replace('MB', '* 1024 * 1024')
-                        # Replace possible parentheses and spaces
-                        value = value.replace('(', '').replace(')', '').strip()
-                        value = eval(value)
-                    elif value.startswith('0x'):
-                        value = int(value, 16)
-                    elif value.replace(' ', '').replace('*', '').isdigit():
-                        value = eval(value)
-            except:
-                pass
-            
-            self.defines[name] = value
-    
-    def get(self, name: str, default=None):
-        return self.defines.get(name, default)
-    
-    def __str__(self):
-        return f"Header Config ({self.header_path.name}):\n" + \
-               "\n".join(f"  {k} = {v}" for k, v in sorted(self.defines.items()))
+ROOT_DIR = Path(__file__).resolve().parent.parent
 
 
 class DSLParser:
     """Parse iasl-generated DSL file (table format)"""
-    
+
     def __init__(self, dsl_path: Path):
         self.dsl_path = dsl_path
-        self.content = dsl_path.read_text()
+        self.content = dsl_path.read_text(encoding='utf-8', errors='ignore')
         self.caches = []
         self.processors = []
         self._parse()
-    
+
     def _parse(self):
         """Parse DSL table format content"""
         lines = self.content.split('\n')
-        i = 0
-        
-        while i < len(lines):
-            line = lines[i].strip()
-            
+
+        for i, line in enumerate(lines):
             # Only detect Subtable Type lines
-            if 'Subtable Type' in line:
-                # Detect Processor Hierarchy Node
-                if 'Processor Hierarchy Node' in line:
-                    proc = self._parse_processor(lines, i)
-                    if proc:
-                        self.processors.append(proc)
-                
-                # Detect Cache Type
-                elif 'Cache Type' in line:
-                    cache = self._parse_cache(lines, i)
-                    if cache and cache.get('size'):  # Only add valid cache
-                        self.caches.append(cache)
-            
-            i += 1
-    
-    def _parse_processor(self, lines: List[str], start: int) -> Optional[Dict]:
+            if 'Subtable Type' not in line:
+                continue
+            match = re.search(r'\[([0-9A-Fa-f]+)h', line)
+            offset = int(match.group(1), 16) if match else None
+            if 'Processor Hierarchy Node' in line:
+                proc = self._parse_processor(lines, i)
+                proc['offset'] = offset
+                self.processors.append(proc)
+            elif 'Cache Type' in line:
+                self.caches.append({'offset': offset})
+
+    def _parse_processor(self, lines: List[str], start: int) -> Dict:
         """Parse processor node"""
         proc = {}
-        
-        for i in range(start, min(start + 20, len(lines))):
+
+        for i in range(start + 1, min(start + 20, len(lines))):
             line = lines[i]
-            
+
+            if 'Subtable Type' in line:
+                break
+            match = re.search(r':\s*([0-9A-Fa-f]+)', line)
+            if not match:
+                continue
             if 'Flags (decoded below)' in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    proc['flags'] = int(match.group(1), 16)
-            
-            elif 'Parent' in line and 'Private Resource Number' not in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    proc['parent'] = int(match.group(1), 16)
-            
-            elif 'ACPI Processor ID' in line and 'valid' not in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    proc['proc_id'] = int(match.group(1), 16)
-            
+                proc['flags'] = int(match.group(1), 16)
+            elif re.search(r'\bParent\s*:', line):
+                proc['parent'] = int(match.group(1), 16)
+            elif re.search(r'ACPI Processor ID\s*:', line):
+                proc['proc_id'] = int(match.group(1), 16)
             elif 'Private Resource Number' in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    proc['num_resources'] = int(match.group(1), 16)
-            
-            elif 'Subtable Type' in line and i > start:
-                break
-        
-        return proc if proc else None
-    
-    def _parse_cache(self, lines: List[str], start: int) -> Optional[Dict]:
-        """Parse cache node"""
-        cache = {}
-        
-        for i in range(start, min(start + 30, len(lines))):
-            line = lines[i]
-            
-            if 'Size' in line and 'Line Size' not in line and 'Size valid' not in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    cache['size'] = int(match.group(1), 16)
-            
-            elif 'Associativity' in line and 'valid' not in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    cache['associativity'] = int(match.group(1), 16)
-            
-            elif 'Line Size' in line and 'valid' not in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    cache['line_size'] = int(match.group(1), 16)
-            
-            # Match "                                  Cache Type : 2" format
-            elif line.strip().startswith('Cache Type :'):
-                match = re.search(r':\s*(\d+)', line)
-                if match:
-                    type_val = int(match.group(1))
-                    # ACPI Spec: 0=Data(RW), 1=Instruction(RO), 2=Unified
-                    type_map = {0: 'ReadWrite', 1: 'ReadOnly', 2: 'Unified'}
-                    cache['type'] = type_map.get(type_val, 'Unknown')
-            
-            elif 'Cache ID' in line and 'valid' not in line:
-                match = re.search(r':\s*([0-9A-Fa-f]+)', line)
-                if match:
-                    cache['cache_id'] = int(match.group(1), 16)
-            
-            elif 'Subtable Type' in line and i > start:
-                break
-        
-        return cache if cache else None
-    
-    def get_cache_by_type(self, cache_type: str) -> List[Dict]:
-        """Get all caches of specified type"""
-        return [c for c in self.caches if c.get('type') == cache_type]
+                proc['num_resources'] = int(match.group(1), 16)
+
+        return proc
 
 
 class PPTTValidator:
     """PPTT Validator"""
-    
-    def __init__(self, platform: str):
-        self.platform = platform
-        self.base_path = Path('/workspaces/acpi-table-generator')
-        self.build_path = self.base_path / 'build' / platform
-        
-        # Load header configuration
-        self.header = HeaderParser(self.base_path / 'include' / platform / 'pptt.h')
-        
-        # Load DSL file
-        dsl_path = self.build_path / 'PPTT.dsl'
-        
-        if not dsl_path.exists():
-            raise FileNotFoundError(f"Cannot find DSL file: {dsl_path}")
-        
-        self.dsl = DSLParser(dsl_path)
-        
-        self.errors = []
-        self.warnings = []
-    
-    def validate_cache_config(self, cache_name: str, cache_type: str, 
-                             expected_size, expected_assoc, 
-                             expected_line) -> bool:
-        """Validate cache configuration"""
-        caches = self.dsl.get_cache_by_type(cache_type)
-        
-        if not caches:
-            self.errors.append(f"No cache of type {cache_type} found")
+
+    def __init__(self, build_dir: Path, device: str):
+        self.device = device
+        self.aml_path = build_dir / device / 'PPTT.aml'
+        self.dsl_path = build_dir / device / 'PPTT.dsl'
+
+        if not self.aml_path.exists():
+            raise FileNotFoundError(f"Cannot find AML file: {self.aml_path}")
+
+        self.manifest = load_manifest(build_dir / device)
+        self.config = self.manifest.table('PPTT').config
+        self.table: PPTTTable = decode_pptt(self.aml_path.read_bytes(), self.manifest)
+
+        self.errors = list(self.table.errors)
+        self.warnings = list(self.table.warnings)
+
+    def expect(self, what: str, macro: str, actual: int, optional: bool = False) -> bool:
+        """Compare a count with a config macro, skipped if it is not defined"""
+        expected = self.config.get(macro)
+        if expected is None:
+            if optional:
+                return True
+            self.warnings.append(f"{macro} not defined, {what} not checked (found {actual})")
+            return True
+        if expected != actual:
+            self.errors.append(f"{what}: {macro} is {expected}, table has {actual}")
             return False
-        
-        # For L1 caches, there should be NUM_CORES units
-        num_cores = self.header.get('NUM_CORES', 2)
-        
-        if cache_type in ['ReadOnly', 'ReadWrite']:  # L1
-            if len(caches) != num_cores:
-                self.errors.append(f"{cache_name}: Expected {num_cores}, found {len(caches)}")
-                return False
-        
-        # Validate first cache configuration
-        cache = caches[0]
-        valid = True
-        
-        if cache['size'] != expected_size:
-            self.errors.append(f"{cache_name}: Size mismatch (expected {expected_size}, actual {cache['size']})")
-            valid = False
-        
-        if cache['associativity'] != expected_assoc:
-            self.errors.append(f"{cache_name}: Associativity mismatch (expected {expected_assoc}, actual {cache['associativity']})")
-            valid = False
-        
-        if cache['line_size'] != expected_line:
-            self.errors.append(f"{cache_name}: Line Size mismatch (expected {expected_line}, actual {cache['line_size']})")
-            valid = False
-        
-        return valid
-    
-    def validate(self) -> bool:
+        print(f"  ✅ {what}: {actual}")
+        return True
+
+    def validate_hierarchy(self):
+        """Node counts per level against NUM_SYSTEM/NUM_CLUSTERS/NUM_CORES"""
+        processors = self.table.processors
+        leaves = self.table.leaves()
+        roots = [p for p in processors if p.parent == 0]
+        clusters = [p for p in processors if p.parent != 0 and p not in leaves]
+
+        self.expect("System nodes", 'NUM_SYSTEM', len(roots))
+        self.expect("Cluster nodes", 'NUM_CLUSTERS', len(clusters))
+        self.expect("Physical CPU nodes", 'NUM_CORES', len(leaves))
+
+        # All zero (NUM_CLUSTER_CORES_SUM == 0) means no cluster sizes are declared
+        if sum(self.config.get(f'NUM_CLUSTER_{index}_CORES', 0) for index in range(4)):
+            for index, cluster in enumerate(clusters):
+                cores = sum(1 for leaf in leaves if leaf.parent == cluster.offset)
+                self.expect(f"Cluster {index} cores", f'NUM_CLUSTER_{index}_CORES', cores, optional=True)
+
+        caches = self.table.caches
+        expected = [self.config.get(f'L{level}_CACHES_COUNT') for level in (1, 2, 3)]
+        if None not in expected:
+            if sum(expected) != len(caches):
+                self.errors.append(f"Cache structures: L1/L2/L3_CACHES_COUNT give {sum(expected)}, "
+                                   f"table has {len(caches)}")
+            else:
+                print(f"  ✅ Cache structures: {len(caches)}")
+
+        ids = [leaf.acpi_processor_id for leaf in leaves]
+        if len(set(ids)) != len(ids):
+            self.errors.append(f"Duplicate ACPI processor IDs on CPU nodes: {ids}")
+        for leaf in leaves:
+            if not leaf.flags & PPTT_PROC_FLAG_ACPI_PROC_ID_VALID:
+                self.errors.append(f"0x{leaf.offset:03X}: CPU node without ACPI Processor ID valid flag")
+
+        for name, nodes, macro in (("System", roots, 'SYSTEM_PRIVATE_RESOURCES_COUNT'),
+                                   ("Cluster", clusters, 'CLUSTER_PRIVATE_RESOURCES_COUNT'),
+                                   ("Physical CPU", leaves, 'PHYSICAL_CPU_PRIVATE_RESOURCES_COUNT')):
+            self.validate_node_size(name, nodes, macro)
+
+    def validate_node_size(self, name: str, nodes: List[ProcessorHierarchyNode], macro: str):
+        """Node length follows the *_PRIVATE_RESOURCES_COUNT array of pptt.h"""
+        count = self.config.get(macro)
+        if count is None:
+            return
+        length = (self.manifest.type('ACPI_PPTT_PROCESSOR_HIERARCHY_NODE').size +
+                  self.manifest.type('ACPI_PPTT_PRIVATE_RESOURCE').size * count)
+        for node in nodes:
+            if node.length != length:
+                self.errors.append(f"0x{node.offset:03X}: {name} node is {node.length} bytes, "
+                                   f"{macro}={count} gives {length}")
+            elif len(node.private_resources) > count:
+                self.errors.append(f"0x{node.offset:03X}: {name} node has {len(node.private_resources)} "
+                                   f"private resource(s), {macro} is {count}")
+
+    def cross_check_dsl(self):
+        """Processor and cache nodes of the disassembly match the binary"""
+        if not self.dsl_path.exists():
+            self.warnings.append(f"No DSL file to cross-check: {self.dsl_path}")
+            return
+        dsl = DSLParser(self.dsl_path)
+        if len(dsl.caches) != len(self.table.caches):
+            self.errors.append(f"DSL cross-check: {len(dsl.caches)} cache node(s) in DSL, "
+                               f"{len(self.table.caches)} in AML")
+        by_offset = {p.offset: p for p in self.table.processors}
+        if len(dsl.processors) != len(by_offset):
+            self.errors.append(f"DSL cross-check: {len(dsl.processors)} processor node(s) in DSL, "
+                               f"{len(by_offset)} in AML")
+        for proc in dsl.processors:
+            node = by_offset.get(proc['offset'])
+            actual = node and {'flags': node.flags, 'parent': node.parent,
+                               'proc_id': node.acpi_processor_id,
+                               'num_resources': len(node.private_resources)}
+            if actual is None or any(actual[k] != v for k, v in proc.items() if k != 'offset'):
+                self.errors.append(f"DSL cross-check: processor node at {proc['offset']} differs: "
+                                   f"DSL {proc}, AML {actual}")
+        if not self.errors:
+            print(f"  ✅ DSL cross-check: {len(dsl.processors)} processor and {len(dsl.caches)} cache node(s) match")
+
+    def validate(self, with_dsl: bool = False) -> bool:
         """Execute validation"""
-        print(f"=== Validating PPTT Table: {self.platform} ===\n")
-        
-        print(f"Header Configuration:")
-        print(f"  NUM_CORES: {self.header.get('NUM_CORES')}")
-        print(f"  L1D: {self.header.get('L1D_SIZE')} bytes, {self.header.get('L1D_ASSOCIATIVITY')}-way")
-        print(f"  L1I: {self.header.get('L1I_SIZE')} bytes, {self.header.get('L1I_ASSOCIATIVITY')}-way")
-        print(f"  L2: {self.header.get('L2_SIZE')} bytes, {self.header.get('L2_ASSOCIATIVITY')}-way")
+        print(f"=== Validating PPTT Table: {self.device} ===\n")
+
+        print(f"Build Configuration ({self.manifest.path}):")
+        for macro in ('NUM_SYSTEM', 'NUM_CLUSTERS', 'NUM_CORES', 'L1_CACHES_COUNT',
+                      'L2_CACHES_COUNT', 'L3_CACHES_COUNT'):
+            print(f"  {macro}: {self.config.get(macro)}")
         print()
-        
-        print(f"DSL Parse Results:")
-        print(f"  Processor Nodes: {len(self.dsl.processors)}")
-        print(f"  Cache Nodes: {len(self.dsl.caches)}")
+
+        print(f"AML Decode Results (revision {self.table.header.revision}):")
+        print(f"  Processor Nodes: {len(self.table.processors)}")
+        print(f"  Cache Nodes: {len(self.table.caches)}")
         print()
-        
-        # Validate cache configuration
-        valid = True
-        
-        # Calculate expected values
-        def calc_value(v):
-            if isinstance(v, str):
-                v = v.replace('KB', '* 1024').replace('MB', '* 1024 * 1024')
-                v = v.replace('(', '').replace(')', '').strip()
-                try:
-                    return eval(v)
-                except:
-                    return v
-            return v
-        
-        print("Validating L1 Data Cache...")
-        valid &= self.validate_cache_config(
-            "L1D", "ReadWrite",
-            calc_value(self.header.get('L1D_SIZE')),
-            calc_value(self.header.get('L1D_ASSOCIATIVITY')),
-            calc_value(self.header.get('CACHE_LINE_SIZE', 64))
-        )
-        
-        print("Validating L1 Instruction Cache...")
-        valid &= self.validate_cache_config(
-            "L1I", "ReadOnly",
-            calc_value(self.header.get('L1I_SIZE')),
-            calc_value(self.header.get('L1I_ASSOCIATIVITY')),
-            calc_value(self.header.get('CACHE_LINE_SIZE', 64))
-        )
-        
-        print("Validating L2 Cache...")
-        valid &= self.validate_cache_config(
-            "L2", "Unified",
-            calc_value(self.header.get('L2_SIZE')),
-            calc_value(self.header.get('L2_ASSOCIATIVITY')),
-            calc_value(self.header.get('CACHE_LINE_SIZE', 64))
-        )
-        
-        # Validate processor count
-        num_cores = self.header.get('NUM_CORES', 2)
-        # Should have 1 Package + NUM_CORES Cores
-        expected_procs = 1 + num_cores
-        if len(self.dsl.processors) != expected_procs:
-            self.errors.append(f"Processor node count mismatch (expected {expected_procs}, actual {len(self.dsl.processors)})")
-            valid = False
-        
+
+        self.validate_hierarchy()
+        if with_dsl:
+            self.cross_check_dsl()
+
         print()
-        
+
         # Print results
         if self.errors:
             print(f"❌ Found {len(self.errors)} error(s):")
             for err in self.errors:
                 print(f"  - {err}")
-        
+
         if self.warnings:
             print(f"⚠️  Found {len(self.warnings)} warning(s):")
             for warn in self.warnings:
                 print(f"  - {warn}")
-        
-        if valid and not self.errors:
-            print("✅ Validation passed! DSL configuration matches header file.")
+
+        if not self.errors:
+            print("✅ Validation passed! PPTT topology matches the build configuration.")
         else:
             print("❌ Validation failed!")
-        
-        return valid
+        print()
+
+        return not self.errors
 
 
 def main():
-    if len(sys.argv) < 2:
-        print("Usage: python pptt_validate.py <platform>")
-        print("  Example: python pptt_validate.py qcom_sm8550")
-        sys.exit(1)
-    
-    platform = sys.argv[1]
-    
-    try:
-        validator = PPTTValidator(platform)
-        success = validator.validate()
-        sys.exit(0 if success else 1)
-    except Exception as e:
-        print(f"Error: {e}")
-        import traceback
-        traceback.print_exc()
+    parser = argparse.ArgumentParser(description="Validate PPTT.aml against the device configuration")
+    parser.add_argument('build_dir', nargs='?', default=str(ROOT_DIR / 'build'),
+                        help="build directory (default: <repo>/build)")
+    parser.add_argument('devices', nargs='*', help="devices to check, e.g. qcom_sm8550 (default: all)")
+    parser.add_argument('--dsl', action='store_true', help="cross-check with the PPTT.dsl disassembly")
+    args = parser.parse_args()
+
+    build_dir = Path(args.build_dir)
+    devices = args.devices or sorted(p.parent.name for p in build_dir.glob('*/PPTT.aml'))
+    if not devices:
+        print(f"No PPTT.aml found in {build_dir}")
         sys.exit(1)
 
+    failed = []
+    for device in devices:
+        try:
+            if not PPTTValidator(build_dir, device).validate(args.dsl):
+                failed.append(device)
+        except Exception as e:
+            print(f"Error: {device}: {e}")
+            failed.append(device)
+
+    print(f"{len(devices) - len(failed)}/{len(devices)} PPTT table(s) valid")
+    sys.exit(1 if failed else 0)
+
 
 if __name__ == "__main__":
     main()
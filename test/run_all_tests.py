@@ -2,14 +2,43 @@
 """
 ACPI Table Generator - Complete Test Suite
 Cross-platform test script (supports Windows/Linux/macOS)
+
+The build tree is discovered and every table (AML and DSL) is read once
+into a BuildModel. Checks then run as (check, table) jobs on a process
+pool that shares that model, and the report ends with the wall time of
+every check and device and the slowest jobs.
+
+Passing results are kept in <build_dir>/.test-cache, keyed by the check,
+the table, the SHA-256 of its AML (and DSL) bytes and the suite version
+(check code and `iasl -v` output), so only the checks whose inputs changed
+run again. The layout manifest of the device (layout.json) is part of the
+key too, the checks decode the tables with it.
+
+Usage: run_all_tests.py [build_dir] [-j jobs] [--slowest N] [--no-cache]
 """
 
+import argparse
+import contextlib
+import hashlib
+import io
+import json
 import os
-import sys
-import subprocess
-import struct
 import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+from concurrent.futures import ProcessPoolExecutor
+from dataclasses import dataclass, field
 from pathlib import Path
+from typing import Callable, Dict, List, Optional, Tuple
+
+sys.path.insert(0, str(Path(__file__).parent))
+
+from aml_validator import validate_aml_file  # noqa: E402
+from verify_node_references import PPTTValidator  # noqa: E402
 
 
 class Colors:
@@ -21,7 +50,7 @@ class Colors:
     RED = '\033[91m'
     ENDC = '\033[0m'
     BOLD = '\033[1m'
-    
+
     @classmethod
     def disable(cls):
         cls.HEADER = ''
@@ -86,6 +115,42 @@ def run_command(cmd, cwd=None, capture=True):
         return -1, "", str(e)
 
 
+# =============================================================================
+# Shared in-memory model of the build tree
+# =============================================================================
+
+@dataclass
+class Table:
+    """One <device>/<TABLE>.aml with its disassembly, read once"""
+    device: str
+    aml_path: Path
+    aml: bytes
+    dsl_path: Optional[Path] = None
+    dsl: Optional[str] = None
+    aml_digest: str = ''
+    dsl_digest: str = ''
+    layout_digest: str = ''  # Of <device>/layout.json
+
+    @property
+    def name(self):
+        return self.aml_path.name
+
+    @property
+    def label(self):
+        return f"{self.device}/{self.aml_path.name}"
+
+    @property
+    def signature(self):
+        return self.aml[0:4].decode('ascii', errors='ignore')
+
+
+@dataclass
+class BuildModel:
+    build_dir: Path
+    devices: List[str] = field(default_factory=list)
+    tables: List[Table] = field(default_factory=list)
+
+
 def discover_device_targets(build_dir):
     """Discover all device targets from build directory"""
     targets = []
@@ -98,48 +163,106 @@ def discover_device_targets(build_dir):
     return sorted(targets)
 
 
-def test_aml_generation(build_dir, targets):
+def load_build_model(build_dir):
+    """Discover the devices and read every AML and DSL file once"""
+    model = BuildModel(build_dir=build_dir, devices=discover_device_targets(build_dir))
+    for device in model.devices:
+        layout_path = build_dir / device / 'layout.json'
+        layout_digest = hashlib.sha256(layout_path.read_bytes()).hexdigest() if layout_path.exists() else ''
+        for aml_path in sorted((build_dir / device).glob('*.aml')):
+            aml = aml_path.read_bytes()
+            table = Table(device=device, aml_path=aml_path, aml=aml,
+                          aml_digest=hashlib.sha256(aml).hexdigest(), layout_digest=layout_digest)
+            dsl_path = aml_path.with_suffix('.dsl')
+            if dsl_path.exists():
+                dsl = dsl_path.read_bytes()
+                table.dsl_path = dsl_path
+                table.dsl = dsl.decode('utf-8', errors='ignore')
+                table.dsl_digest = hashlib.sha256(dsl).hexdigest()
+            model.tables.append(table)
+    return model
+
+
+# =============================================================================
+# Checks
+#
+# A table check gets one Table and returns (passed, messages), a global
+# check gets None. Messages are ('ok' | 'error' | 'info', text) and are
+# printed by the parent in table order, so the report does not depend on
+# which worker finished first.
+# =============================================================================
+
+Messages = List[Tuple[str, str]]
+
+
+def check_aml_generation(table: Table) -> Tuple[bool, Messages]:
     """Test 1: Verify AML file generation"""
-    print_section("📦 Test 1: Verify AML File Generation")
-    
-    all_passed = True
-    for target in targets:
-        target_dir = build_dir / target
-        aml_files = list(target_dir.glob('*.aml'))
-        
-        if aml_files:
-            for aml_file in aml_files:
-                size = aml_file.stat().st_size
-                print_success(f"{target}/{aml_file.name} ({size} bytes)")
-        else:
-            print_error(f"{target}: No AML files found")
-            all_passed = False
-    
-    return all_passed
-
-
-def test_dsl_decompilation(build_dir, targets):
-    """Test 2: Verify DSL decompilation"""
-    print_section("📄 Test 2: Verify DSL Decompilation")
-    
-    all_passed = True
-    for target in targets:
-        target_dir = build_dir / target
-        dsl_files = list(target_dir.glob('*.dsl'))
-        
-        if dsl_files:
-            for dsl_file in dsl_files:
-                with open(dsl_file, 'r', encoding='utf-8', errors='ignore') as f:
-                    lines = len(f.readlines())
-                print_success(f"{target}/{dsl_file.name} ({lines} lines)")
-        else:
-            print_info(f"⚠️  {target}: No DSL files (iasl may not be installed)")
-    
-    return all_passed
+    return True, [('ok', f"{table.label} ({len(table.aml)} bytes)")]
+
+
+def check_aml_signature(table: Table) -> Tuple[bool, Messages]:
+    """Test 2: Verify AML file signature matches filename"""
+    if len(table.aml) < 4:
+        return False, [('error', f"{table.label}: File too short to read signature")]
+
+    # Read the 4-byte ACPI table signature
+    signature = table.signature
+
+    # Extract expected signature from filename (e.g., PPTT.aml -> PPTT)
+    expected_signature = table.aml_path.stem.upper()
+
+    if signature == expected_signature:
+        return True, [('ok', f"{table.label}: Signature '{signature}' matches filename")]
+
+    # Allow known equivalences (e.g., APIC accepted for MADT)
+    EQUIVALENCES = {'MADT': ['APIC'], 'APIC': ['MADT']}
+    if signature in EQUIVALENCES.get(expected_signature, []):
+        return True, [('ok', f"{table.label}: Signature '{signature}' accepted as equivalent to expected '{expected_signature}' (compatibility workaround)")]
+    return False, [
+        ('error', f"{table.label}: Signature MISMATCH! File contains '{signature}' but filename suggests '{expected_signature}'"),
+        ('info', "  This indicates the wrong table was extracted!"),
+    ]
+
 
+def check_aml_validator(table: Table) -> Tuple[bool, Messages]:
+    """Test 3: Header length, checksum and PPTT subtable stream (aml_validator.py)"""
+    output = io.StringIO()
+    with contextlib.redirect_stdout(output):
+        ok = validate_aml_file(str(table.aml_path))
+    if ok:
+        return True, [('ok', f"{table.label}: Header and structure valid")]
+    failures = [l.strip() for l in output.getvalue().splitlines() if '❌' in l or l.strip().startswith('•')]
+    return False, [('error', f"{table.label}: aml_validator failed")] + [('info', f"  {l}") for l in failures[:6]]
 
-def test_dsl_no_errors(build_dir, targets):
-    """Test 3: Verify DSL files have no errors.
+
+def check_dsl_decompilation(table: Table) -> Tuple[bool, Messages]:
+    """Test 4: Verify DSL decompilation"""
+    if table.dsl is None:
+        return True, []
+    lines = len(table.dsl.splitlines())
+    return True, [('ok', f"{table.device}/{table.dsl_path.name} ({lines} lines)")]
+
+
+# Patterns considered indicative of errors (case-insensitive)
+ERROR_PATTERNS = [re.compile(p, re.IGNORECASE) for p in (
+    r'\berror\b', r'\bfatal\b', r'\bfailed\b', r'\binvalid\b', r'\bsyntax\b', r'\bunknown\b', r'\bassert\b')]
+# Known benign substrings to ignore
+BENIGN_SUBSTRINGS = ['Error checking', 'No errors found', 'no error']
+
+# Known benign iasl errors to ignore (per project policy)
+IGNORE_ERRORS = [
+    '32-bit DSDT Address and 64-bit X_DSDT Address cannot both be zero',
+    'Found NULL field - Field name "TRBE Interrupt" needed',
+    # CSRT/other tables: some vendor fields or null subfields can trigger
+    # internal iasl errors; allow ignoring the specific 'Type' NULL-field
+    # and generic 'Invalid field label' reports for now.
+    'Found NULL field - Field name "Type" needed',
+    'Invalid field label',
+]
+
+
+def check_dsl_no_errors(table: Table) -> Tuple[bool, Messages]:
+    """Test 5: Verify DSL files have no errors.
 
     Strategy:
       - If `iasl` is available in PATH, attempt to compile each .dsl with `iasl -tc` and use
@@ -147,292 +270,427 @@ def test_dsl_no_errors(build_dir, targets):
       - Otherwise, fall back to scanning for a broader set of error keywords while
         excluding known benign phrases.
     """
-    print_section("🔍 Test 3: Verify DSL Files Have No Errors")
-
-    import shutil
-
-    all_passed = True
+    if table.dsl is None:
+        return True, []
+    name = f"{table.device}/{table.dsl_path.name}"
     iasl_path = shutil.which('iasl')
-    if iasl_path:
-        print_info(f"Using iasl at: {iasl_path} to validate DSL files")
-    else:
-        print_info("iasl not found: falling back to keyword scanning for errors")
 
-    # Patterns considered indicative of errors (case-insensitive)
-    ERROR_PATTERNS = [r'\berror\b', r'\bfatal\b', r'\bfailed\b', r'\binvalid\b', r'\bsyntax\b', r'\bunknown\b', r'\bassert\b']
-    # Known benign substrings to ignore
-    BENIGN_SUBSTRINGS = ['Error checking', 'No errors found', 'no error']
-
-    for target in targets:
-        target_dir = build_dir / target
-        dsl_files = list(target_dir.glob('*.dsl'))
-
-        for dsl_file in dsl_files:
-            if iasl_path:
-                print_info(f"  Compiling {target}/{dsl_file.name} with iasl...")
-                returncode, stdout, stderr = run_command([iasl_path, '-tc', str(dsl_file)])
-                if returncode != 0:
-                    # Consolidate iasl output for inspection
-                    error_text = (stderr or stdout or "")
-
-                    # Known benign iasl errors to ignore (per project policy)
-                    IGNORE_ERRORS = [
-                        '32-bit DSDT Address and 64-bit X_DSDT Address cannot both be zero',
-                        'Found NULL field - Field name "TRBE Interrupt" needed',
-                        # CSRT/other tables: some vendor fields or null subfields can trigger
-                        # internal iasl errors; allow ignoring the specific 'Type' NULL-field
-                        # and generic 'Invalid field label' reports for now.
-                        'Found NULL field - Field name "Type" needed',
-                        'Invalid field label',
-                    ]
-
-                    if any(p in error_text for p in IGNORE_ERRORS):
-                        print_info(f"{target}/{dsl_file.name}: iasl reported known benign issue; ignoring error")
-                        for line in error_text.splitlines()[:6]:
-                            print_info(f"  {line}")
-                        print_success(f"{target}/{dsl_file.name}: iasl compile OK (known benign issues ignored)")
-                    else:
-                        print_error(f"{target}/{dsl_file.name}: iasl compilation FAILED (rc={returncode})")
-                        # Show first few stderr lines for debugging
-                        for line in (stderr or stdout).splitlines()[:6]:
-                            print_info(f"  {line}")
-                        all_passed = False
-                else:
-                    # iasl may emit warnings on stdout/stderr; treat them as info
-                    print_success(f"{target}/{dsl_file.name}: iasl compile OK")
-            else:
-                # Fallback textual scan
-                content = dsl_file.read_text(encoding='utf-8', errors='ignore')
-                error_lines = []
-                for line in content.split('\n'):
-                    l = line.strip()
-                    if any(re.search(p, l, re.IGNORECASE) for p in ERROR_PATTERNS):
-                        if not any(b in l for b in BENIGN_SUBSTRINGS):
-                            error_lines.append(l)
-
-                if error_lines:
-                    print_error(f"{target}/{dsl_file.name}: Contains error-like keywords")
-                    for line in error_lines[:3]:
-                        print_info(f"  {line}")
-                    all_passed = False
-                else:
-                    print_success(f"{target}/{dsl_file.name}: No error-like keywords found")
-
-    return all_passed
-
-
-def test_node_references(build_dir, targets):
-    """Test 4: Node reference verification"""
-    print_section("🔗 Test 4: Node Reference Verification")
-    
-    all_passed = True
-    test_script = Path(__file__).parent / "verify_node_references.py"
-    
-    if not test_script.exists():
-        print_info("⚠️  Verification script not found: verify_node_references.py (skip)")
-        return True
-    
-    for target in targets:
-        target_dir = build_dir / target
-        dsl_files = list(target_dir.glob('*.dsl'))
-        
-        if not dsl_files:
-            print_info(f"⚠️  {target}: No DSL files (skip)")
-            continue
-        
-        for dsl_file in dsl_files:
-            print(f"🔍 Verifying {target}/{dsl_file.name}...")
-            returncode, stdout, stderr = run_command(
-                [sys.executable, str(test_script), str(dsl_file)],
-                capture=True
-            )
-            
-            if returncode == 0:
-                # Extract statistics
-                match = re.search(r'Found (\d+) nodes', stdout)
-                if match:
-                    node_count = match.group(1)
-                    print_success(f"{target}/{dsl_file.name}: All {node_count} node references correct")
-                else:
-                    print_success(f"{target}/{dsl_file.name}: Node reference verification passed")
-            else:
-                print_error(f"{target}/{dsl_file.name}: Found node reference errors")
-                all_passed = False
-    
-    print()
-    return all_passed
-
-
-def test_checksum(build_dir, targets):
-    """Test 5: Checksum verification"""
-    print_section("🔐 Test 5: Checksum Verification")
-    
-    all_passed = True
-    for target in targets:
-        target_dir = build_dir / target
-        aml_files = list(target_dir.glob('*.aml'))
-        
-        for aml_file in aml_files:
-            try:
-                with open(aml_file, 'rb') as f:
-                    data = f.read()
-                    # Read signature and compute checksum
-                    signature = data[0:4].decode('ascii', errors='ignore') if len(data) >= 4 else ''
-                    checksum = sum(data) & 0xFF
-
-                    # Workaround: FACS tables may be emitted without a valid checksum.
-                    # Accept non-zero checksum for FACS and report informationally.
-                    if signature == 'FACS':
-                        print_success(f"{target}/{aml_file.name}: FACS checksum skipped (sum={checksum})")
-                    else:
-                        # ACPI table checksum should make the sum of all bytes == 0 (mod 256)
-                        if checksum == 0:
-                            print_success(f"{target}/{aml_file.name}: Checksum valid (sum=0)")
-                        else:
-                            print_error(f"{target}/{aml_file.name}: Checksum invalid (sum={checksum})")
-                            all_passed = False
-            except Exception as e:
-                print_error(f"{target}/{aml_file.name}: Cannot read checksum - {e}")
-                all_passed = False
-    
-    return all_passed
-
-
-def test_madt_apic_workaround():
-    """Test: MADT <-> APIC signature equivalence workaround"""
-    print_section("⚙️ Test: MADT ↔ APIC Signature Workaround")
-    from aml_validator import validate_aml_file
-    import tempfile
+    if iasl_path:
+        returncode, stdout, stderr = run_command([iasl_path, '-tc', str(table.dsl_path)])
+        if returncode == 0:
+            # iasl may emit warnings on stdout/stderr; treat them as info
+            return True, [('ok', f"{name}: iasl compile OK")]
+        # Consolidate iasl output for inspection
+        error_text = (stderr or stdout or "")
+        details = [('info', f"  {line}") for line in error_text.splitlines()[:6]]
+        if any(p in error_text for p in IGNORE_ERRORS):
+            return True, [('info', f"{name}: iasl reported known benign issue; ignoring error")] + details + [
+                ('ok', f"{name}: iasl compile OK (known benign issues ignored)")]
+        return False, [('error', f"{name}: iasl compilation FAILED (rc={returncode})")] + details
+
+    # Fallback textual scan
+    error_lines = []
+    for line in table.dsl.split('\n'):
+        l = line.strip()
+        if any(p.search(l) for p in ERROR_PATTERNS):
+            if not any(b in l for b in BENIGN_SUBSTRINGS):
+                error_lines.append(l)
+    if error_lines:
+        return False, [('error', f"{name}: Contains error-like keywords")] + [
+            ('info', f"  {line}") for line in error_lines[:3]]
+    return True, [('ok', f"{name}: No error-like keywords found")]
+
+
+def check_node_references(table: Table) -> Tuple[bool, Messages]:
+    """Test 6: PPTT node reference verification on the AML, cross-checked
+    with the DSL when there is one (verify_node_references.py)"""
+    if table.signature != 'PPTT':
+        return True, []
+    validator = PPTTValidator(table.aml_path, table.dsl_path, aml=table.aml, dsl=table.dsl)
+    with contextlib.redirect_stdout(io.StringIO()):
+        ok = validator.validate()
+    source = " (DSL cross-checked)" if table.dsl is not None else ""
+    if ok:
+        return True, [('ok', f"{table.label}: All {len(validator.nodes)} node references correct{source}")]
+    return False, [('error', f"{table.label}: Found node reference errors")] + [
+        ('info', f"  {e}") for e in validator.errors[:6]]
+
+
+def check_checksum(table: Table) -> Tuple[bool, Messages]:
+    """Test 7: Checksum verification"""
+    signature = table.signature
+    checksum = sum(table.aml) & 0xFF
+
+    # Workaround: FACS tables may be emitted without a valid checksum.
+    # FBPT has no checksum field at all (signature + length only).
+    # Accept non-zero checksum for them and report informationally.
+    if signature in ('FACS', 'FBPT'):
+        return True, [('ok', f"{table.label}: {signature} checksum skipped (sum={checksum})")]
+    # ACPI table checksum should make the sum of all bytes == 0 (mod 256)
+    if checksum == 0:
+        return True, [('ok', f"{table.label}: Checksum valid (sum=0)")]
+    return False, [('error', f"{table.label}: Checksum invalid (sum={checksum})")]
+
+
+def check_madt_apic_workaround(_table=None) -> Tuple[bool, Messages]:
+    """Test 8: MADT <-> APIC signature equivalence workaround"""
     try:
         with tempfile.TemporaryDirectory() as td:
             path = Path(td) / "MADT.aml"
-            # Minimal AML header: signature 'APIC', length 36, remainder zero
+            # aml_validator reads the header layout from the manifest next to the table
+            shutil.copy(_MODEL.tables[0].aml_path.parent / 'layout.json', td)
             # Build a minimal 36-byte ACPI header with signature 'APIC' and a valid checksum
             hdr = bytearray(36)
             hdr[0:4] = b'APIC'
             hdr[4:8] = struct.pack('<I', 36)
             # Calculate checksum so sum(hdr) % 256 == 0
-            checksum = (256 - (sum(hdr) % 256)) % 256
-            hdr[9] = checksum
-            with open(path, 'wb') as f:
-                f.write(hdr)
-            ok = validate_aml_file(str(path))
-            if ok:
-                print_success("MADT expected file with 'APIC' signature accepted")
-                return True
-            else:
-                print_error("MADT expected file with 'APIC' signature was rejected")
-                return False
+            hdr[9] = (256 - (sum(hdr) % 256)) % 256
+            path.write_bytes(hdr)
+            with contextlib.redirect_stdout(io.StringIO()):
+                ok = validate_aml_file(str(path))
     except Exception as e:
-        print_error(f"Exception during workaround test - {e}")
-        return False
-
-
-def test_aml_signature_match(build_dir, targets):
-    """Test 6: Verify AML file signature matches filename"""
-    print_section("🏷️  Test 6: AML Signature Match Verification")
-    
-    all_passed = True
-    for target in targets:
-        target_dir = build_dir / target
-        aml_files = list(target_dir.glob('*.aml'))
-        
-        for aml_file in aml_files:
-            try:
-                with open(aml_file, 'rb') as f:
-                    data = f.read()
-                
-                if len(data) < 4:
-                    print_error(f"{target}/{aml_file.name}: File too short to read signature")
-                    all_passed = False
-                    continue
-                
-                # Read the 4-byte ACPI table signature
-                signature = data[0:4].decode('ascii', errors='ignore')
-                
-                # Extract expected signature from filename (e.g., PPTT.aml -> PPTT)
-                expected_signature = aml_file.stem.upper()
-                
-                if signature == expected_signature:
-                    print_success(f"{target}/{aml_file.name}: Signature '{signature}' matches filename")
-                else:
-                    # Allow known equivalences (e.g., APIC accepted for MADT)
-                    EQUIVALENCES = {'MADT': ['APIC'], 'APIC': ['MADT']}
-                    if signature in EQUIVALENCES.get(expected_signature, []):
-                        print_success(f"{target}/{aml_file.name}: Signature '{signature}' accepted as equivalent to expected '{expected_signature}' (compatibility workaround)")
-                    else:
-                        print_error(f"{target}/{aml_file.name}: Signature MISMATCH! File contains '{signature}' but filename suggests '{expected_signature}'")
-                        print_info(f"  This indicates the wrong table was extracted!")
-                        all_passed = False
-            except Exception as e:
-                print_error(f"{target}/{aml_file.name}: Cannot read signature - {e}")
-                all_passed = False
-    
-    return all_passed
+        return False, [('error', f"Exception during workaround test - {e}")]
+    if ok:
+        return True, [('ok', "MADT expected file with 'APIC' signature accepted")]
+    return False, [('error', "MADT expected file with 'APIC' signature was rejected")]
+
+
+@dataclass(frozen=True)
+class Check:
+    key: str
+    name: str
+    section: str
+    func: Callable
+    per_table: bool = True
+    needs_dsl: bool = False  # Skipped for tables without DSL
+    reads_dsl: bool = False  # Uses the DSL when there is one
+    reads_layout: bool = False  # Global check reading the first table's layout.json
+
+
+CHECKS = [
+    Check('aml_generation', 'AML File Generation', "📦 Test 1: Verify AML File Generation", check_aml_generation),
+    Check('aml_signature', 'AML Signature Match', "🏷️  Test 2: AML Signature Match Verification", check_aml_signature),
+    Check('aml_validator', 'AML Header and Structure', "🧾 Test 3: AML Header and Structure (aml_validator)", check_aml_validator),
+    Check('dsl_decompilation', 'DSL Decompilation', "📄 Test 4: Verify DSL Decompilation", check_dsl_decompilation, needs_dsl=True),
+    Check('dsl_no_errors', 'DSL No Errors', "🔍 Test 5: Verify DSL Files Have No Errors", check_dsl_no_errors, needs_dsl=True),
+    Check('node_references', 'Node Reference Verification', "🔗 Test 6: Node Reference Verification", check_node_references, reads_dsl=True),
+    Check('checksum', 'Checksum Valid', "🔐 Test 7: Checksum Verification", check_checksum),
+    Check('madt_apic_workaround', 'MADT/APIC Signature Workaround', "⚙️ Test 8: MADT ↔ APIC Signature Workaround", check_madt_apic_workaround, per_table=False, reads_layout=True),
+]
+CHECKS_BY_KEY = {check.key: check for check in CHECKS}
+
+
+# =============================================================================
+# Process pool
+# =============================================================================
+
+_MODEL: Optional[BuildModel] = None
+
+
+def _init_worker(model):
+    """Pool initializer: inherited (fork) or unpickled once (spawn) per worker"""
+    global _MODEL
+    _MODEL = model
+
+
+@dataclass
+class JobResult:
+    check: str
+    table: Optional[int]  # Index in BuildModel.tables, None for global checks
+    passed: bool
+    messages: Messages
+    start: float
+    end: float
+    cached: bool = False
+    pid: int = 0
+
+    @property
+    def seconds(self):
+        return self.end - self.start
+
+
+def _run_job(job):
+    key, index = job
+    check = CHECKS_BY_KEY[key]
+    table = _MODEL.tables[index] if index is not None else None
+    start = time.monotonic()
+    try:
+        passed, messages = check.func(table)
+    except Exception as e:
+        where = table.label if table else check.name
+        passed, messages = False, [('error', f"{where}: {type(e).__name__}: {e}")]
+    return JobResult(key, index, passed, messages, start, time.monotonic(), pid=os.getpid())
+
+
+def run_checks(model, jobs, cache=None):
+    work = []
+    for check in CHECKS:
+        if not check.per_table:
+            work.append((check.key, None))
+            continue
+        for index, table in enumerate(model.tables):
+            if check.needs_dsl and table.dsl is None:
+                continue
+            work.append((check.key, index))
+
+    results = {}
+    if cache:
+        for job in work:
+            hit = cache.get(model, *job)
+            if hit:
+                results[job] = hit
+    misses = [job for job in work if job not in results]
+
+    if jobs <= 1 or len(misses) <= 1:
+        _init_worker(model)
+        ran = [_run_job(job) for job in misses]
+    else:
+        # Small jobs, chunk them so the pool overhead stays below the work
+        chunksize = max(1, len(misses) // (jobs * 4))
+        with ProcessPoolExecutor(max_workers=jobs, initializer=_init_worker, initargs=(model,)) as pool:
+            ran = list(pool.map(_run_job, misses, chunksize=chunksize))
+
+    for result in ran:
+        results[(result.check, result.table)] = result
+        if cache:
+            cache.put(model, result)
+    return [results[job] for job in work]
+
+
+# =============================================================================
+# Pipeline trace
+# =============================================================================
+
+def write_trace_spans(model, results, load_start, load_end):
+    """Append the model load and every executed check job to $ACPI_TRACE_FILE
+    as stage spans (lib/trace.c format), cache hits did no work and are left
+    out. Job times are monotonic, shifted to the wall clock of the other tools."""
+    path = os.environ.get('ACPI_TRACE_FILE')
+    if not path:
+        return
+    to_wall_us = lambda t: int((t + time.time() - time.monotonic()) * 1e6)
+    lines = []
+
+    def span(device, table, stage, start, end, size, pid):
+        lines.append(json.dumps({
+            'tool': 'run_all_tests', 'device': device, 'table': table, 'stage': stage,
+            'start_us': to_wall_us(start), 'dur_us': int((end - start) * 1e6),
+            'bytes': size, 'pid': pid}, separators=(',', ':')) + '\n')
+
+    span('all', '', 'load', load_start, load_end,
+         sum(len(t.aml) + len(t.dsl or '') for t in model.tables), os.getpid())
+    for result in results:
+        if result.cached:
+            continue
+        table = model.tables[result.table] if result.table is not None else None
+        span(table.device if table else 'all', table.signature if table else '',
+             f"check:{result.check}", result.start, result.end,
+             len(table.aml) if table else 0, result.pid)
+    with open(path, 'a') as trace:
+        trace.write(''.join(lines))
+
+
+# =============================================================================
+# Result cache
+# =============================================================================
+
+def suite_version():
+    """Hash of the check code and of the tools it runs: a change in any of
+    them invalidates every cached result"""
+    digest = hashlib.sha256()
+    script_dir = Path(__file__).parent
+    for name in ('run_all_tests.py', 'aml_validator.py', 'verify_node_references.py', 'pptt_decoder.py',
+                 'layout_manifest.py'):
+        digest.update((script_dir / name).read_bytes())
+    # The path alone misses an iasl upgraded in place
+    iasl_path = shutil.which('iasl')
+    digest.update(str(iasl_path).encode())
+    if iasl_path:
+        _, stdout, stderr = run_command([iasl_path, '-v'])
+        digest.update((stdout + stderr).encode())
+    return digest.hexdigest()
+
+
+class ResultCache:
+    """Passing check results on disk, one JSON file per key
+
+    Failures are never stored, a failing check always runs again. The
+    table label is part of the key because the messages name the table.
+    """
+
+    def __init__(self, directory):
+        self.directory = Path(directory)
+        self.version = suite_version()
+        self.hits: Dict[str, int] = {}
+        self.misses: Dict[str, int] = {}
+
+    def key(self, model, check_key, index):
+        check = CHECKS_BY_KEY[check_key]
+        parts = [self.version, check_key]
+        if index is not None:
+            table = model.tables[index]
+            parts += [table.label, table.aml_digest, table.layout_digest]
+            if check.needs_dsl or check.reads_dsl:
+                parts.append(table.dsl_digest)
+        elif check.reads_layout and model.tables:
+            parts.append(model.tables[0].layout_digest)
+        return hashlib.sha256('\0'.join(parts).encode()).hexdigest()
+
+    def path(self, key):
+        return self.directory / key[:2] / f"{key}.json"
+
+    def get(self, model, check_key, index):
+        try:
+            entry = json.loads(self.path(self.key(model, check_key, index)).read_text())
+            result = JobResult(check_key, index, True, [tuple(m) for m in entry['messages']],
+                               0.0, 0.0, cached=True)
+        except (OSError, ValueError, KeyError, TypeError):
+            self.misses[check_key] = self.misses.get(check_key, 0) + 1
+            return None
+        self.hits[check_key] = self.hits.get(check_key, 0) + 1
+        return result
+
+    def put(self, model, result):
+        if not result.passed:
+            return
+        path = self.path(self.key(model, result.check, result.table))
+        try:
+            path.parent.mkdir(parents=True, exist_ok=True)
+            tmp = path.with_suffix(f".{os.getpid()}.tmp")
+            tmp.write_text(json.dumps({'check': result.check, 'messages': result.messages}))
+            tmp.replace(path)
+        except OSError:
+            pass  # A read only build tree only loses the cache
+
+
+# =============================================================================
+# Report
+# =============================================================================
+
+def print_check_results(model, results):
+    by_check: Dict[str, List[JobResult]] = {}
+    for result in results:
+        by_check.setdefault(result.check, []).append(result)
+
+    passed = {}
+    for check in CHECKS:
+        print_section(check.section)
+        check_results = sorted(by_check.get(check.key, []), key=lambda r: -1 if r.table is None else r.table)
+        for result in check_results:
+            for kind, text in result.messages:
+                {'ok': print_success, 'error': print_error}.get(kind, print_info)(text)
+        if check.needs_dsl:
+            for device in model.devices:
+                if not any(t.dsl is not None for t in model.tables if t.device == device):
+                    print_info(f"⚠️  {device}: No DSL files (iasl may not be installed)")
+        passed[check.key] = all(r.passed for r in check_results)
+    return passed
+
+
+def span(results):
+    """Wall time covered by a set of jobs, which may overlap"""
+    results = [r for r in results if not r.cached]
+    if not results:
+        return 0.0
+    return max(r.end for r in results) - min(r.start for r in results)
+
+
+def print_timing(model, results, load_seconds, total_seconds, jobs, slowest):
+    print_section("⏱️  Timing")
+    cached = sum(1 for r in results if r.cached)
+    print_info(f"Load: {len(model.tables)} table(s) in {load_seconds * 1000:.1f} ms, "
+               f"checks: {len(results) - cached} job(s) on {jobs} worker(s) + {cached} cached, "
+               f"total {total_seconds * 1000:.1f} ms")
+
+    print_info("")
+    print_info(f"{'Check':<34} {'Jobs':>5} {'Cached':>6} {'Wall ms':>9} {'CPU ms':>9}")
+    for check in CHECKS:
+        check_results = [r for r in results if r.check == check.key]
+        print_info(f"{check.name:<34} {len(check_results):>5} {sum(1 for r in check_results if r.cached):>6} "
+                   f"{span(check_results) * 1000:>9.1f} {sum(r.seconds for r in check_results) * 1000:>9.1f}")
+
+    print_info("")
+    print_info(f"{'Device':<34} {'Jobs':>5} {'Cached':>6} {'Wall ms':>9} {'CPU ms':>9}")
+    for device in model.devices:
+        device_results = [r for r in results if r.table is not None and model.tables[r.table].device == device]
+        print_info(f"{device:<34} {len(device_results):>5} {sum(1 for r in device_results if r.cached):>6} "
+                   f"{span(device_results) * 1000:>9.1f} {sum(r.seconds for r in device_results) * 1000:>9.1f}")
+
+    results = [r for r in results if not r.cached]
+    if slowest > 0 and results:
+        print_info("")
+        print_info(f"Slowest {min(slowest, len(results))} job(s):")
+        for result in sorted(results, key=lambda r: r.seconds, reverse=True)[:slowest]:
+            where = model.tables[result.table].label if result.table is not None else "-"
+            print_info(f"  {result.seconds * 1000:>8.2f} ms  {CHECKS_BY_KEY[result.check].name:<32} {where}")
 
 
 def main():
     """Main test function"""
+    parser = argparse.ArgumentParser(description="ACPI table test suite")
+    parser.add_argument('build_dir', nargs='?', help="build directory (default: <repo>/build)")
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count() or 1,
+                        help="worker processes (default: CPU count)")
+    parser.add_argument('--slowest', type=int, default=10, metavar='N',
+                        help="list the N slowest check jobs (default: 10)")
+    parser.add_argument('--no-cache', action='store_true',
+                        help="run every check, do not read or write the result cache")
+    parser.add_argument('--cache-dir', help="result cache (default: <build_dir>/.test-cache)")
+    args = parser.parse_args()
+
     print_header("ACPI Table Generator - Complete Test Suite")
-    
+
     # Detect project root directory
     script_dir = Path(__file__).parent
     root_dir = script_dir.parent
-    
-    # Check if build_dir was passed as argument
-    if len(sys.argv) > 1:
-        build_dir = Path(sys.argv[1])
-    else:
-        build_dir = root_dir / "build"
-    
+    build_dir = Path(args.build_dir) if args.build_dir else root_dir / "build"
+
     if not build_dir.exists():
         print_error("Build directory does not exist, please run cmake first")
         print(f"   Expected directory: {build_dir}")
         return 1
-    
-    # Discover all device targets
-    targets = discover_device_targets(build_dir)
-    
-    if not targets:
+
+    start = time.monotonic()
+    model = load_build_model(build_dir)
+    load_end = time.monotonic()
+    load_seconds = load_end - start
+
+    if not model.devices:
         print_error("No device targets found in build directory")
         return 1
-    
-    print(f"Found {len(targets)} device target(s): {', '.join(targets)}")
-    
-    # Run all tests
-    results = {}
-    
-    results['aml_generation'] = test_aml_generation(build_dir, targets)
-    results['aml_signature'] = test_aml_signature_match(build_dir, targets)
-    results['dsl_decompilation'] = test_dsl_decompilation(build_dir, targets)
-    results['dsl_no_errors'] = test_dsl_no_errors(build_dir, targets)
-    results['node_references'] = test_node_references(build_dir, targets)
-    results['checksum'] = test_checksum(build_dir, targets)
-    results['madt_apic_workaround'] = test_madt_apic_workaround()
-    
+
+    print(f"Found {len(model.devices)} device target(s): {', '.join(model.devices)}")
+    if shutil.which('iasl'):
+        print_info(f"Using iasl at: {shutil.which('iasl')} to validate DSL files")
+    else:
+        print_info("iasl not found: falling back to keyword scanning for errors")
+
+    jobs = max(1, args.jobs)
+    cache = None
+    if not args.no_cache:
+        cache = ResultCache(args.cache_dir or build_dir / '.test-cache')
+    results = run_checks(model, jobs, cache)
+    write_trace_spans(model, results, start, load_end)
+    passed = print_check_results(model, results)
+    print_timing(model, results, load_seconds, time.monotonic() - start, jobs, args.slowest)
+    if cache:
+        hits, misses = sum(cache.hits.values()), sum(cache.misses.values())
+        print_info("")
+        print_info(f"Cache: {hits} hit(s), {misses} miss(es) in {cache.directory}")
+
     # Summary
     print_header("✅ Test Summary")
-    
-    test_names = [
-        ('aml_generation', 'AML File Generation'),
-        ('aml_signature', 'AML Signature Match'),
-        ('dsl_decompilation', 'DSL Decompilation'),
-        ('dsl_no_errors', 'DSL No Errors'),
-        ('node_references', 'Node Reference Verification'),
-        ('checksum', 'Checksum Valid'),
-        ('madt_apic_workaround', 'MADT/APIC Signature Workaround')
-    ]
-    
-    passed_count = sum(1 for result in results.values() if result)
-    total_count = len(results)
-    
+
+    passed_count = sum(1 for ok in passed.values() if ok)
+    total_count = len(passed)
+
     print("Test Results:")
-    for key, name in test_names:
-        status = "✅ PASS" if results[key] else "❌ FAIL"
-        print(f"  [{status}] {name}")
-    
+    for check in CHECKS:
+        status = "✅ PASS" if passed[check.key] else "❌ FAIL"
+        print(f"  [{status}] {check.name}")
+
     print(f"\nTotal: {passed_count}/{total_count} tests passed")
-    
+
     if passed_count == total_count:
         print(f"\n{Colors.GREEN}🎉 All tests passed!{Colors.ENDC}\n")
         return 0
@@ -3,6 +3,10 @@
 PPTT Node Reference Verification Script
 Verify that each node's Parent and Private Resource references in PPTT table
 point to correct node offsets
+
+Nodes are decoded from PPTT.aml (pptt_decoder.py). The iasl/acpi_dump
+disassembly can be given as well: its nodes are then cross-checked against
+the binary ones. A DSL file alone is still accepted and parsed as before.
 """
 
 import sys
@@ -10,6 +14,9 @@ import re
 from pathlib import Path
 from typing import Dict, List, Optional, Set
 
+from layout_manifest import manifest_for
+from pptt_decoder import CacheTypeStructure, ProcessorHierarchyNode, decode_pptt
+
 
 class PPTTNode:
     """PPTT Node Base Class"""
@@ -54,27 +61,99 @@ class ProcessorNode(PPTTNode):
 class PPTTValidator:
     """PPTT Table Validator"""
     
-    def __init__(self, dsl_file: Path):
+    def __init__(self, aml_file: Optional[Path] = None, dsl_file: Optional[Path] = None,
+                 aml: Optional[bytes] = None, dsl: Optional[str] = None):
+        self.aml_file = aml_file
         self.dsl_file = dsl_file
         self.nodes: Dict[int, PPTTNode] = {}
         self.errors: List[str] = []
         self.warnings: List[str] = []
-        self.content = ""
-        
-    def parse_dsl(self) -> bool:
-        """Parse DSL file"""
-        if not self.dsl_file.exists():
-            self.errors.append(f"File does not exist: {self.dsl_file}")
-            return False
+        # Table bytes / DSL text already in memory (run_all_tests.py), read from the files otherwise
+        self.aml = aml
+        self.content = dsl or ""
         
+    @property
+    def name(self) -> str:
+        return (self.aml_file or self.dsl_file or Path("PPTT")).name
+    
+    def _read(self, path: Path, binary: bool):
+        if not path.exists():
+            self.errors.append(f"File does not exist: {path}")
+            return None
         try:
-            with open(self.dsl_file, 'r', encoding='utf-8', errors='ignore') as f:
-                self.content = f.read()
+            return path.read_bytes() if binary else path.read_text(encoding='utf-8', errors='ignore')
         except Exception as e:
             self.errors.append(f"Failed to read file: {e}")
+            return None
+    
+    def load(self) -> bool:
+        """Load nodes from the AML, cross-checked with the DSL if there is one"""
+        if self.aml is None and self.aml_file is not None:
+            self.aml = self._read(self.aml_file, binary=True)
+            if self.aml is None:
+                return False
+        if not self.content and self.dsl_file is not None:
+            self.content = self._read(self.dsl_file, binary=False)
+            if self.content is None:
+                return False
+        
+        if self.aml is None:
+            if not self.content:
+                self.errors.append("No PPTT.aml or PPTT.dsl given")
+                return False
+            self.nodes = self.parse_dsl(self.content)
+            return True
+        
+        if self.aml_file is None:
+            self.errors.append("PPTT bytes given without their file, no layout manifest to decode them")
+            return False
+        try:
+            # Layouts of the device the AML was built for, next to it
+            table = decode_pptt(self.aml, manifest_for(self.aml_file))
+        except (OSError, ValueError) as e:
+            self.errors.append(f"Cannot decode PPTT: {e}")
             return False
+        self.errors.extend(table.errors)
+        self.warnings.extend(table.warnings)
+        for offset, decoded in table.nodes.items():
+            self.nodes[offset] = self._from_decoded(decoded)
+        
+        if self.content:
+            self._cross_check_dsl(self.parse_dsl(self.content))
+        return True
+    
+    @staticmethod
+    def _from_decoded(decoded) -> PPTTNode:
+        if isinstance(decoded, ProcessorHierarchyNode):
+            return ProcessorNode(decoded.offset, decoded.length, decoded.parent,
+                                 list(decoded.private_resources), decoded.acpi_processor_id)
+        if isinstance(decoded, CacheTypeStructure):
+            return CacheNode(decoded.offset, decoded.length, decoded.next_level)
+        return IDNode(decoded.offset, decoded.length)
+    
+    def _cross_check_dsl(self, dsl_nodes: Dict[int, PPTTNode]):
+        """Every node of the disassembly must match the binary one"""
+        if set(dsl_nodes) != set(self.nodes):
+            missing = sorted(set(self.nodes) - set(dsl_nodes))
+            extra = sorted(set(dsl_nodes) - set(self.nodes))
+            self.errors.append("DSL cross-check: node offsets differ "
+                               f"(missing in DSL: {[f'0x{o:03X}' for o in missing]}, "
+                               f"not in AML: {[f'0x{o:03X}' for o in extra]})")
+        for offset in sorted(set(self.nodes) & set(dsl_nodes)):
+            aml_node, dsl_node = self.nodes[offset], dsl_nodes[offset]
+            if type(aml_node) is not type(dsl_node) or aml_node.length != dsl_node.length:
+                self.errors.append(f"DSL cross-check: 0x{offset:03X} is {aml_node!r} in AML, {dsl_node!r} in DSL")
+            elif isinstance(aml_node, ProcessorNode):
+                if (aml_node.parent, aml_node.private_resources, aml_node.acpi_id) != \
+                        (dsl_node.parent, dsl_node.private_resources, dsl_node.acpi_id):
+                    self.errors.append(f"DSL cross-check: 0x{offset:03X} is {aml_node!r} in AML, {dsl_node!r} in DSL")
+            elif isinstance(aml_node, CacheNode) and aml_node.next_level != dsl_node.next_level:
+                self.errors.append(f"DSL cross-check: 0x{offset:03X} is {aml_node!r} in AML, {dsl_node!r} in DSL")
         
-        lines = self.content.split('\n')
+    def parse_dsl(self, content: str) -> Dict[int, PPTTNode]:
+        """Parse DSL text"""
+        nodes: Dict[int, PPTTNode] = {}
+        lines = content.split('\n')
         i = 0
         
         while i < len(lines):
@@ -92,19 +171,19 @@ class PPTTValidator:
                     if subtype == 0x00:  # Processor Hierarchy Node
                         node = self._parse_processor_node(lines, i, offset)
                         if node:
-                            self.nodes[offset] = node
+                            nodes[offset] = node
                     elif subtype == 0x01:  # Cache Type
                         node = self._parse_cache_node(lines, i, offset)
                         if node:
-                            self.nodes[offset] = node
+                            nodes[offset] = node
                     elif subtype == 0x02:  # ID
                         node = self._parse_id_node(lines, i, offset)
                         if node:
-                            self.nodes[offset] = node
+                            nodes[offset] = node
             
             i += 1
         
-        return True
+        return nodes
     
     def _parse_processor_node(self, lines: List[str], start: int, offset: int) -> Optional[ProcessorNode]:
         """Parse processor hierarchy node"""
@@ -196,10 +275,14 @@ class PPTTValidator:
     
     def validate(self) -> bool:
         """Execute all validations"""
-        if not self.parse_dsl():
+        if not self.load():
+            self._print_results()
             return False
         
-        print(f"Parsed file: {self.dsl_file.name}")
+        source = "AML" if self.aml is not None else "DSL"
+        if self.aml is not None and self.content:
+            source = "AML, cross-checked with DSL"
+        print(f"Parsed file: {self.name} ({source})")
         print(f"Found {len(self.nodes)} nodes\n")
         
         # Display all nodes
@@ -388,16 +471,20 @@ def main():
     """Main function"""
     print_header()
     
-    if len(sys.argv) < 2:
-        print("Usage: python verify_node_references.py <DSL_file_path>")
+    if len(sys.argv) not in (2, 3):
+        print("Usage: python verify_node_references.py <PPTT.aml> [PPTT.dsl]")
+        print("       python verify_node_references.py <PPTT.dsl>")
         print("\nExamples:")
-        print("  python verify_node_references.py build/qcom_sm8850/PPTT.dsl")
+        print("  python verify_node_references.py build/qcom_sm8850/PPTT.aml")
+        print("  python verify_node_references.py build/qcom_sm8850/PPTT.aml build/qcom_sm8850/PPTT.dsl")
         print("  python verify_node_references.py build/qcom_sm8750/PPTT.dsl")
         sys.exit(1)
     
-    dsl_file = Path(sys.argv[1])
+    files = [Path(arg) for arg in sys.argv[1:]]
+    aml_file = next((f for f in files if f.suffix.lower() == '.aml'), None)
+    dsl_file = next((f for f in files if f.suffix.lower() != '.aml'), None)
     
-    validator = PPTTValidator(dsl_file)
+    validator = PPTTValidator(aml_file, dsl_file)
     success = validator.validate()
     
     sys.exit(0 if success else 1)
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+acpi_watch Retry Test
+A (device, table) pair that fails its first compile has no dependencies
+yet. Fixing its header must still rebuild it: acpi_watch keeps failed
+pairs dirty and compiles them again on the next change.
+
+The test runs acpi_watch on a copy of include/ and src/dummy with a single
+device, breaks its pptt.h before the first pass, then restores it.
+
+Usage: watch_retry.py [build_dir]
+"""
+
+import argparse
+import queue
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+from pathlib import Path
+
+ROOT_DIR = Path(__file__).resolve().parent.parent
+DEVICE = ('mtk', 'mt1234')
+TIMEOUT = 60
+
+
+def copy_tree(source_dir: Path):
+    """Copy the sources acpi_watch reads, with one vendor device only"""
+    shutil.copytree(ROOT_DIR / 'src' / 'dummy', source_dir / 'src' / 'dummy')
+    include = source_dir / 'include'
+    shutil.copytree(ROOT_DIR / 'include', include,
+                    ignore=shutil.ignore_patterns('vendor'))
+    vendor = include / 'vendor' / DEVICE[0]
+    vendor.mkdir(parents=True)
+    shutil.copy(ROOT_DIR / 'include' / 'vendor' / DEVICE[0] / 'acpi_vendor.h', vendor)
+    shutil.copytree(ROOT_DIR / 'include' / 'vendor' / DEVICE[0] / DEVICE[1],
+                    vendor / DEVICE[1])
+
+
+def read_lines(stream, lines: queue.Queue):
+    for line in stream:
+        lines.put(line.rstrip())
+    lines.put(None)
+
+
+def wait_for(lines: queue.Queue, text: str, seen: list) -> bool:
+    """Collect output lines until one contains text"""
+    while True:
+        try:
+            line = lines.get(timeout=TIMEOUT)
+        except queue.Empty:
+            return False
+        if line is None:
+            return False
+        seen.append(line)
+        if text in line:
+            return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check that acpi_watch retries tables that failed to compile")
+    parser.add_argument('build_dir', nargs='?', default=str(ROOT_DIR / 'build'),
+                        help="build directory holding acpi_watch (default: <repo>/build)")
+    args = parser.parse_args()
+
+    watch = Path(args.build_dir).resolve() / 'acpi_watch'
+    if not watch.exists():
+        print(f"acpi_watch not found in {args.build_dir}")
+        sys.exit(1)
+
+    with tempfile.TemporaryDirectory() as temp:
+        source_dir = Path(temp) / 'src'
+        build_dir = Path(temp) / 'build'
+        copy_tree(source_dir)
+        header = source_dir / 'include' / 'vendor' / DEVICE[0] / DEVICE[1] / 'pptt.h'
+        original = header.read_text()
+        header.write_text(original + '\nthis is not C\n')
+        table = build_dir / f"{DEVICE[0]}_{DEVICE[1]}" / 'PPTT.aml'
+
+        process = subprocess.Popen([str(watch), str(source_dir), str(build_dir)],
+                                   stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                   text=True, errors='replace')
+        lines = queue.Queue()
+        threading.Thread(target=read_lines, args=(process.stdout, lines), daemon=True).start()
+        seen = []
+        failures = []
+        try:
+            if not wait_for(lines, 'Watching', seen):
+                failures.append("acpi_watch did not start watching")
+            elif table.exists() or not any('Failed to compile' in line for line in seen):
+                failures.append("broken pptt.h did not fail the first pass")
+            else:
+                header.write_text(original)
+                if not wait_for(lines, 'Rebuilt', seen) or 'Rebuilt 1 table(s) in' not in seen[-1]:
+                    failures.append("fixed pptt.h did not rebuild the failed table")
+                elif not table.exists():
+                    failures.append(f"{table.name} was not written")
+        finally:
+            process.terminate()
+            process.wait()
+
+    if failures:
+        print('\n'.join(seen))
+        for failure in failures:
+            print(f"FAIL: {failure}")
+        sys.exit(1)
+    print("Failed table rebuilt once its header was fixed")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,418 @@
+#!/usr/bin/env python3
+"""
+Persistent index of a device tree blob (DTB), shared by the dtb_to_* tools.
+
+The blob is parsed once into packed tables (array('I') / array('Q')):
+ - nodes: name offset, parent, first property, property count, first child
+   and next sibling, in pre-order, node 0 is the root
+ - properties: name offset, value offset, length and kind
+ - path -> node and phandle -> node, as sorted keys for bisect
+ - node base name (unit address dropped), property name and string value
+   -> nodes maps
+ - the rank of every node in the stack order the generators search in
+   (pop a node, look at its children in order, push them)
+
+Names and values are not copied, every offset points into the blob. The
+tables are written next to the DTB as <dtb>.idx with the SHA-256 of the
+blob; later runs hash the blob and load the tables with marshal, which for
+packed arrays is a copy, instead of parsing. A changed DTB or index version
+rebuilds the file.
+
+Nodes are handed out as light views with the pyfdt attributes the scripts
+use (name, parent, subdata, and words / strings on properties).
+
+Usage:
+  python tools/dtb_index.py sm7325.dtb          # build or refresh the index
+  python tools/dtb_index.py sm7325.dtb --stats  # and print its size
+"""
+
+from __future__ import annotations
+import argparse
+import hashlib
+import marshal
+import string
+import struct
+import sys
+from array import array
+from bisect import bisect_left
+from pathlib import Path
+from typing import Callable, Dict, List, Optional
+
+INDEX_VERSION = 2
+INDEX_SUFFIX = '.idx'
+
+FDT_MAGIC = 0xD00DFEED
+FDT_BEGIN_NODE = 1
+FDT_END_NODE = 2
+FDT_PROP = 3
+FDT_NOP = 4
+FDT_END = 9
+
+NO_NODE = 0xFFFFFFFF
+NODE_FIELDS = 6      # name, parent, first property, property count, first child, next sibling
+PROPERTY_FIELDS = 4  # name, value offset, length, kind
+
+# Property kinds, decoded the way pyfdt does
+KIND_EMPTY = 0
+KIND_STRINGS = 1
+KIND_WORDS = 2
+KIND_BYTES = 3
+
+PRINTABLE = frozenset(string.printable.encode()) - {ord('\r'), ord('\n')}
+
+
+def is_string_list(value: bytes) -> bool:
+    """NUL terminated list of non empty printable strings (dtc / pyfdt rule)."""
+    if not value or value[-1] != 0:
+        return False
+    return all(part and all(c in PRINTABLE for c in part) for part in value[:-1].split(b'\0'))
+
+
+def property_kind(value: bytes) -> int:
+    if not value:
+        return KIND_EMPTY
+    if is_string_list(value):
+        return KIND_STRINGS
+    if len(value) % 4 == 0:
+        return KIND_WORDS
+    return KIND_BYTES
+
+
+def path_hash(path: str) -> int:
+    return int.from_bytes(hashlib.blake2b(path.encode(), digest_size=8).digest(), 'little')
+
+
+def u32_array(values=()) -> array:
+    packed = array('I')
+    assert packed.itemsize == 4
+    packed.extend(values)
+    return packed
+
+
+def from_bytes(typecode: str, data: bytes) -> array:
+    packed = array(typecode)
+    packed.frombytes(data)
+    return packed
+
+
+class DtbProperty:
+    """pyfdt style property, only the attribute of its kind is set."""
+    __slots__ = ('name', 'words', 'strings', 'bytes')
+
+    def __init__(self, name: str, kind: int, value: bytes):
+        self.name = name
+        if kind == KIND_STRINGS:
+            self.strings = value[:-1].decode('ascii').split('\0')
+        elif kind == KIND_WORDS:
+            self.words = list(struct.unpack('>%dI' % (len(value) // 4), value))
+        elif kind == KIND_BYTES:
+            self.bytes = value
+
+
+class DtbNode:
+    """pyfdt style node view, subdata lists properties then subnodes."""
+    __slots__ = ('index', 'id', 'name', '_subdata')
+
+    def __init__(self, index: 'DtbIndex', node_id: int):
+        self.index = index
+        self.id = node_id
+        self.name = index.node_name(node_id)
+        self._subdata = None
+
+    @property
+    def parent(self) -> Optional['DtbNode']:
+        parent = self.index.parent_id(self.id)
+        return self.index.node(parent) if parent != NO_NODE else None
+
+    @property
+    def subdata(self) -> list:
+        if self._subdata is None:
+            self._subdata = [self.index.get_property(i) for i in self.index.property_ids(self.id)]
+            self._subdata += self.children
+        return self._subdata
+
+    @property
+    def children(self) -> List['DtbNode']:
+        return [self.index.node(c) for c in self.index.child_ids(self.id)]
+
+    def prop(self, name: str) -> Optional[DtbProperty]:
+        for i in self.index.property_ids(self.id):
+            if self.index.property_name(i) == name:
+                return self.index.get_property(i)
+        return None
+
+    @property
+    def path(self) -> str:
+        return self.index.path(self.id)
+
+
+class DtbIndex:
+    def __init__(self, blob: bytes, tables: dict):
+        self.blob = blob
+        self.nodes = from_bytes('I', tables['nodes'])
+        self.properties = from_bytes('I', tables['properties'])
+        self.path_keys = from_bytes('Q', tables['path_keys'])
+        self.path_nodes = from_bytes('I', tables['path_nodes'])
+        self.phandle_keys = from_bytes('I', tables['phandle_keys'])
+        self.phandle_nodes = from_bytes('I', tables['phandle_nodes'])
+        self.stack_rank = from_bytes('I', tables['stack_rank'])
+        # name -> packed node ids, unpacked on first use
+        self.by_name: Dict[str, bytes] = tables['by_name']
+        self.by_property: Dict[str, bytes] = tables['by_property']
+        self.by_string: Dict[str, bytes] = tables['by_string']
+        self._views: Dict[int, DtbNode] = {}
+        self._names: Dict[int, str] = {}
+
+    # --- building -----------------------------------------------------
+
+    @staticmethod
+    def parse(blob: bytes) -> dict:
+        """Build the index tables from a DTB in one pass."""
+        if len(blob) < 40:
+            raise ValueError('not a DTB: too short')
+        (magic, total, off_struct, off_strings, _, version, _, _,
+         _, size_struct) = struct.unpack_from('>10I', blob)
+        if magic != FDT_MAGIC or total > len(blob) or version < 17:
+            raise ValueError('not a DTB: bad header')
+
+        nodes = u32_array()
+        properties = u32_array()
+        paths: List[str] = []
+        phandles: Dict[int, int] = {}
+        by_name: Dict[str, list] = {}
+        by_property: Dict[str, list] = {}
+        by_string: Dict[str, list] = {}
+        name_cache: Dict[int, str] = {}
+        stack: List[int] = []
+        last_child: List[int] = []
+        offset, end = off_struct, off_struct + size_struct
+
+        while offset < end:
+            token, = struct.unpack_from('>I', blob, offset)
+            offset += 4
+            if token == FDT_BEGIN_NODE:
+                name_end = blob.index(b'\0', offset)
+                name = blob[offset:name_end].decode('ascii', 'replace')
+                node_id = len(nodes) // NODE_FIELDS
+                parent = stack[-1] if stack else NO_NODE
+                nodes.extend((offset, parent, len(properties) // PROPERTY_FIELDS, 0, NO_NODE, NO_NODE))
+                if parent != NO_NODE:
+                    if last_child[-1] == NO_NODE:
+                        nodes[parent * NODE_FIELDS + 4] = node_id
+                    else:
+                        nodes[last_child[-1] * NODE_FIELDS + 5] = node_id
+                    last_child[-1] = node_id
+                    paths.append((paths[parent] if parent else '') + '/' + name)
+                else:
+                    paths.append('/')
+                by_name.setdefault(name.split('@', 1)[0], []).append(node_id)
+                stack.append(node_id)
+                last_child.append(NO_NODE)
+                offset = (name_end + 4) & ~3
+            elif token == FDT_END_NODE:
+                stack.pop()
+                last_child.pop()
+            elif token == FDT_PROP:
+                length, name_offset = struct.unpack_from('>II', blob, offset)
+                offset += 8
+                name = name_cache.get(name_offset)
+                if name is None:
+                    name_start = off_strings + name_offset
+                    name = blob[name_start:blob.index(b'\0', name_start)].decode('ascii', 'replace')
+                    name_cache[name_offset] = name
+                value = blob[offset:offset + length]
+                kind = property_kind(value)
+                node_id = stack[-1]
+                properties.extend((off_strings + name_offset, offset, length, kind))
+                nodes[node_id * NODE_FIELDS + 3] += 1
+                by_property.setdefault(name, []).append(node_id)
+                if kind == KIND_STRINGS:
+                    for text in value[:-1].decode('ascii').split('\0'):
+                        by_string.setdefault(text, []).append(node_id)
+                if name in ('phandle', 'linux,phandle') and length == 4:
+                    phandles.setdefault(struct.unpack('>I', value)[0], node_id)
+                offset = (offset + length + 3) & ~3
+            elif token == FDT_NOP:
+                continue
+            elif token == FDT_END:
+                break
+            else:
+                raise ValueError('bad token 0x%x at offset 0x%x' % (token, offset - 4))
+        if stack or not paths:
+            raise ValueError('not a DTB: unbalanced structure block')
+
+        node_count = len(paths)
+        stack_rank = u32_array([0]) * node_count
+        rank, pending = 0, [0]
+        while pending:
+            child = nodes[pending.pop() * NODE_FIELDS + 4]
+            while child != NO_NODE:
+                stack_rank[child] = rank
+                rank += 1
+                pending.append(child)
+                child = nodes[child * NODE_FIELDS + 5]
+
+        by_path = sorted((path_hash(p), i) for i, p in enumerate(paths))
+        by_phandle = sorted(phandles.items())
+
+        def pack(mapping):
+            return {key: u32_array(ids).tobytes() for key, ids in mapping.items()}
+
+        return {
+            'version': INDEX_VERSION,
+            'nodes': nodes.tobytes(),
+            'properties': properties.tobytes(),
+            'path_keys': array('Q', (h for h, _ in by_path)).tobytes(),
+            'path_nodes': u32_array(i for _, i in by_path).tobytes(),
+            'phandle_keys': u32_array(p for p, _ in by_phandle).tobytes(),
+            'phandle_nodes': u32_array(i for _, i in by_phandle).tobytes(),
+            'stack_rank': stack_rank.tobytes(),
+            'by_name': pack(by_name),
+            'by_property': pack(by_property),
+            'by_string': pack(by_string),
+        }
+
+    @classmethod
+    def load(cls, dtb_path: Path, cache: bool = True) -> 'DtbIndex':
+        """Index of dtb_path, from <dtb>.idx when its hash matches the blob."""
+        blob = Path(dtb_path).read_bytes()
+        digest = hashlib.sha256(blob).hexdigest()
+        index_path = Path(str(dtb_path) + INDEX_SUFFIX)
+
+        if cache:
+            try:
+                tables = marshal.loads(index_path.read_bytes())
+                if tables.get('version') == INDEX_VERSION and tables.get('sha256') == digest:
+                    return cls(blob, tables)
+            except (OSError, EOFError, ValueError, TypeError, AttributeError):
+                pass
+
+        tables = cls.parse(blob)
+        tables['sha256'] = digest
+        if cache:
+            try:
+                index_path.write_bytes(marshal.dumps(tables))
+            except OSError:
+                pass  # Read only location, index again next time
+        return cls(blob, tables)
+
+    # --- raw tables -----------------------------------------------------
+
+    @property
+    def node_count(self) -> int:
+        return len(self.nodes) // NODE_FIELDS
+
+    @property
+    def property_count(self) -> int:
+        return len(self.properties) // PROPERTY_FIELDS
+
+    def _string_at(self, offset: int) -> str:
+        return self.blob[offset:self.blob.index(b'\0', offset)].decode('ascii', 'replace')
+
+    def node_name(self, node_id: int) -> str:
+        name = self._names.get(node_id)
+        if name is None:
+            name = self._names[node_id] = self._string_at(self.nodes[node_id * NODE_FIELDS])
+        return name
+
+    def parent_id(self, node_id: int) -> int:
+        return self.nodes[node_id * NODE_FIELDS + 1]
+
+    def property_ids(self, node_id: int) -> range:
+        base = node_id * NODE_FIELDS
+        return range(self.nodes[base + 2], self.nodes[base + 2] + self.nodes[base + 3])
+
+    def child_ids(self, node_id: int) -> List[int]:
+        ids = []
+        child = self.nodes[node_id * NODE_FIELDS + 4]
+        while child != NO_NODE:
+            ids.append(child)
+            child = self.nodes[child * NODE_FIELDS + 5]
+        return ids
+
+    def property_name(self, prop_id: int) -> str:
+        return self._string_at(self.properties[prop_id * PROPERTY_FIELDS])
+
+    def get_property(self, prop_id: int) -> DtbProperty:
+        name_offset, offset, length, kind = self.properties[prop_id * PROPERTY_FIELDS:(prop_id + 1) * PROPERTY_FIELDS]
+        return DtbProperty(self._string_at(name_offset), kind, self.blob[offset:offset + length])
+
+    # --- lookups --------------------------------------------------------
+
+    def node(self, node_id: int) -> DtbNode:
+        view = self._views.get(node_id)
+        if view is None:
+            view = self._views[node_id] = DtbNode(self, node_id)
+        return view
+
+    @property
+    def rootnode(self) -> DtbNode:
+        return self.node(0)
+
+    def path(self, node_id: int) -> str:
+        parts = []
+        while node_id not in (0, NO_NODE):
+            parts.append(self.node_name(node_id))
+            node_id = self.parent_id(node_id)
+        return '/' + '/'.join(reversed(parts))
+
+    def find_path(self, path: str) -> Optional[DtbNode]:
+        path = path.rstrip('/') or '/'
+        key = path_hash(path)
+        i = bisect_left(self.path_keys, key)
+        while i < len(self.path_keys) and self.path_keys[i] == key:
+            if self.path(self.path_nodes[i]) == path:
+                return self.node(self.path_nodes[i])
+            i += 1
+        return None
+
+    def find_phandle(self, phandle: int) -> Optional[DtbNode]:
+        i = bisect_left(self.phandle_keys, phandle)
+        if i < len(self.phandle_keys) and self.phandle_keys[i] == phandle:
+            return self.node(self.phandle_nodes[i])
+        return None
+
+    def in_stack_order(self, node_ids) -> List[DtbNode]:
+        """Non root nodes sorted by their stack order rank, duplicates kept."""
+        return [self.node(i) for i in sorted((i for i in node_ids if i), key=self.stack_rank.__getitem__)]
+
+    @staticmethod
+    def _collect(mapping: Dict[str, bytes], match: Callable[[str], bool]) -> List[int]:
+        ids: List[int] = []
+        for key, packed in mapping.items():
+            if match(key):
+                ids.extend(from_bytes('I', packed))
+        return ids
+
+    def nodes_named(self, match: Callable[[str], bool]) -> List[int]:
+        """Ids of nodes whose base name (before '@') matches, in tree order."""
+        return sorted(self._collect(self.by_name, match))
+
+    def nodes_with_property(self, match: Callable[[str], bool]) -> List[int]:
+        """Ids of nodes with a property whose name matches, once per node."""
+        return sorted(set(self._collect(self.by_property, match)))
+
+    def nodes_with_string(self, match: Callable[[str], bool]) -> List[int]:
+        """Node ids, once per string property value that matches."""
+        return self._collect(self.by_string, match)
+
+
+def main():
+    p = argparse.ArgumentParser(description='Build the persistent index of a DTB')
+    p.add_argument('dtb', type=Path, help='DTB file')
+    p.add_argument('--stats', action='store_true', help='Print index statistics')
+    args = p.parse_args()
+
+    if not args.dtb.exists():
+        print(f"DTB not found: {args.dtb}")
+        return 2
+    index = DtbIndex.load(args.dtb)
+    print(f"Indexed {args.dtb} -> {args.dtb}{INDEX_SUFFIX}")
+    if args.stats:
+        print(f"  {index.node_count} nodes, {index.property_count} properties, "
+              f"{len(index.phandle_keys)} phandles, {len(index.by_string)} distinct strings")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -5,7 +5,7 @@ Generate a MADT-style C header from a device tree blob (DTB).
 Usage:
   python tools/dtb_to_madt.py sm7325.dtb -o include/vendor/qcom/sm7325/madt.h --vendor qcom
 
-This script uses pyfdt (pip install pyfdt). It will:
+The DTB is read through tools/dtb_index.py (index cached in <dtb>.idx). It will:
  - parse the DTB and count CPU cores under /cpus
  - find the main GIC interrupt-controller node and extract reg/redistributor stride
  - attempt to locate ITS nodes (if any) and set NUM_ITS and ITS base
@@ -13,7 +13,6 @@ This script uses pyfdt (pip install pyfdt). It will:
  - produce a header with macros (all macros except per-core MPIDR values)
 
 Notes:
- - If pyfdt is not installed, the script will print a helpful error message.
  - The script tries to be conservative: if a value cannot be determined it will emit 0
    or a short comment in the generated header so it's obvious what's missing.
 """
@@ -24,11 +23,7 @@ import sys
 from pathlib import Path
 from typing import List, Tuple, Optional
 
-# Import pyfdt parser
-try:
-    from pyfdt.pyfdt import FdtBlobParse
-except Exception as e:
-    sys.exit("Missing dependency: pyfdt (pip install pyfdt). Error: %s" % e)
+from dtb_index import DtbIndex
 
 
 def to_u64(high: int, low: int) -> int:
@@ -55,59 +50,34 @@ def words_to_int(w: List[int]) -> int:
     return 0
 
 
-def find_gic_node(rootnode) -> Optional[object]:
-    # Traverse nodes to find one with 'interrupt-controller' prop and 'gic' in compatible
-    stack = [rootnode]
-    while stack:
-        n = stack.pop()
-        for sd in n.subdata:
-            if not hasattr(sd, 'subdata'):
-                continue
-            stack.append(sd)
-            # Collect property names/strings
-            names = [p.name for p in sd.subdata if hasattr(p, 'name')]
-            strings = []
-            for p in sd.subdata:
-                if hasattr(p, 'strings') and p.strings:
-                    strings += p.strings
-            if 'interrupt-controller' in names and any('gic' in s for s in strings if s):
-                return sd
+def find_gic_node(index) -> Optional[object]:
+    # First node (in search order) with an 'interrupt-controller' item and 'gic' in a string
+    # (a subnode named 'interrupt-controller' counts too)
+    ids = set(index.nodes_with_property(lambda name: name == 'interrupt-controller'))
+    ids.update(index.parent_id(i) for i in index.nodes_named(lambda name: name == 'interrupt-controller')
+               if index.node_name(i) == 'interrupt-controller')
+    for node in index.in_stack_order(ids):
+        strings = []
+        for p in node.subdata:
+            if hasattr(p, 'strings') and p.strings:
+                strings += p.strings
+        if any('gic' in s for s in strings if s):
+            return node
     return None
 
 
-def find_its_nodes(rootnode) -> List[object]:
-    hits = []
-    stack = [rootnode]
-    while stack:
-        n = stack.pop()
-        for sd in n.subdata:
-            if not hasattr(sd, 'subdata'):
-                continue
-            stack.append(sd)
-            for p in sd.subdata:
-                if hasattr(p, 'strings') and p.strings:
-                    for s in p.strings:
-                        if s and ('gic-its' in s or 'gic,its' in s or 'arm,gic-its' in s):
-                            hits.append(sd)
-    return hits
-
-
-def find_cpus(rootnode) -> List[object]:
+def find_its_nodes(index) -> List[object]:
+    # One hit per matching string, so a node listing two ITS strings counts twice
+    return index.in_stack_order(
+        index.nodes_with_string(lambda s: 'gic-its' in s or 'gic,its' in s or 'arm,gic-its' in s))
+
+
+def find_cpus(index) -> List[object]:
     # find /cpus node and return cpu@ subnodes
-    stack = [rootnode]
-    cpus_node = None
-    while stack and cpus_node is None:
-        n = stack.pop()
-        for sd in n.subdata:
-            if not hasattr(sd, 'subdata'):
-                continue
-            if sd.name == 'cpus':
-                cpus_node = sd
-                break
-            stack.append(sd)
+    cpus_node = index.find_path('/cpus')
     if not cpus_node:
         return []
-    cpus = [sd for sd in cpus_node.subdata if hasattr(sd, 'name') and sd.name.startswith('cpu@')]
+    cpus = [sd for sd in cpus_node.children if sd.name.startswith('cpu@')]
     return cpus
 
 
@@ -144,6 +114,24 @@ def triplet_to_gsi(triplet: Tuple[int, int, int]) -> int:
         return num
 
 
+def find_fallback_gsi(index, needle: str) -> int:
+    # Search order goes one batch of siblings at a time and stops after the
+    # first batch that left a non-zero value (last match in a batch wins)
+    gsi = 0
+    batch = None
+    for node in index.in_stack_order(index.nodes_with_property(lambda name: needle in name)):
+        parent = index.parent_id(node.id)
+        if gsi != 0 and parent != batch:
+            break
+        batch = parent
+        for p in node.subdata:
+            if hasattr(p, 'words') and needle in p.name:
+                w = p.words
+                trip = (w[0] if len(w) > 0 else 0, w[1] if len(w) > 1 else 0, w[2] if len(w) > 2 else 0)
+                gsi = triplet_to_gsi(trip)
+    return gsi
+
+
 HEADER_TEMPLATE = """
 #pragma once
 #include "table_header.h"
@@ -166,7 +154,7 @@ MADT_START{{
     MADT_DECLARE_HEADER,
     MADT_DECLARE_HEADER_EXTRA_DATA(0, 0),
     /* GICD Structure */
-    MADT_DECLARE_GICD_STRUCTURE(GICD_BASE_ADDRESS, 0),
+    MADT_DECLARE_GICD_STRUCTURE(GICD_BASE_ADDRESS, GIC_VERSION),
 
 {gic_its_decl}
     /* GICC Structure */
@@ -176,15 +164,12 @@ MADT_START{{
 
 
 def generate_header(out_path: Path, dtb_path: Path, platform_name: Optional[str] = None):
-    with dtb_path.open('rb') as f:
-        fdt = FdtBlobParse(f).to_fdt()
-
-    root = fdt.rootnode
+    index = DtbIndex.load(dtb_path)
 
-    cpus = find_cpus(root)
+    cpus = find_cpus(index)
     num_cores = len(cpus)
 
-    gic = find_gic_node(root)
+    gic = find_gic_node(index)
 
     # defaults
     gicd = 0
@@ -224,7 +209,7 @@ def generate_header(out_path: Path, dtb_path: Path, platform_name: Optional[str]
                 perf_gsi = triplet_to_gsi(triplets[0])
 
 
-    its_nodes = find_its_nodes(root)
+    its_nodes = find_its_nodes(index)
     if its_nodes:
         num_its = len(its_nodes)
         # take first its reg if present
@@ -234,34 +219,11 @@ def generate_header(out_path: Path, dtb_path: Path, platform_name: Optional[str]
             if pairs:
                 gicits = words_to_int([pairs[0][0]])
 
-    # Fallbacks if none found
+    # Fallbacks if none found: properties named like 'vgic-maintenance-interrupt'
     if vgic_gsi == 0:
-        # try to look for a property named 'vgic-maintenance-interrupt' somewhere
-        stack = [root]
-        while stack and vgic_gsi == 0:
-            n = stack.pop()
-            for sd in n.subdata:
-                if not hasattr(sd, 'subdata'):
-                    continue
-                stack.append(sd)
-                for p in sd.subdata:
-                    if hasattr(p, 'name') and 'vgic' in p.name and hasattr(p, 'words'):
-                        w = p.words
-                        trip = (w[0] if len(w) > 0 else 0, w[1] if len(w) > 1 else 0, w[2] if len(w) > 2 else 0)
-                        vgic_gsi = triplet_to_gsi(trip)
+        vgic_gsi = find_fallback_gsi(index, 'vgic')
     if perf_gsi == 0:
-        stack = [root]
-        while stack and perf_gsi == 0:
-            n = stack.pop()
-            for sd in n.subdata:
-                if not hasattr(sd, 'subdata'):
-                    continue
-                stack.append(sd)
-                for p in sd.subdata:
-                    if hasattr(p, 'name') and 'performance' in p.name and hasattr(p, 'words'):
-                        w = p.words
-                        trip = (w[0] if len(w) > 0 else 0, w[1] if len(w) > 1 else 0, w[2] if len(w) > 2 else 0)
-                        perf_gsi = triplet_to_gsi(trip)
+        perf_gsi = find_fallback_gsi(index, 'performance')
 
     # generate GICC declarations and MPIDR macros
     gicc_lines = []
@@ -280,7 +242,7 @@ def generate_header(out_path: Path, dtb_path: Path, platform_name: Optional[str]
     gic_its_decl = ''
     gic_its_macro = ''
     if num_its > 0:
-        gic_its_decl = f"    MADT_DECLARE_GIC_ITS_STRUCTURE(0, GIC_ITS_BASE_ADDRESS),"
+        gic_its_decl = f"    MADT_DECLARE_GIC_ITS_STRUCTURE(0, GIC_ITS_BASE_ADDRESS, 0),"
         gic_its_macro = f"#define GIC_ITS_BASE_ADDRESS {gicits:#010x}ULL\n"
 
     # Detect GIC version from compatible strings (only support v3 and v4 intentionally)
@@ -14,7 +14,7 @@ This script parses the DTB and extracts:
   - Bus number ranges for each domain
   - Generate the corresponding C header file
 
-Requires: pyfdt (pip install pyfdt)
+The DTB is read through tools/dtb_index.py (index cached in <dtb>.idx).
 """
 
 from __future__ import annotations
@@ -24,10 +24,7 @@ import re
 from pathlib import Path
 from typing import List, Tuple, Optional, Dict
 
-try:
-    from pyfdt.pyfdt import FdtBlobParse
-except Exception as e:
-    sys.exit("Missing dependency: pyfdt (pip install pyfdt). Error: %s" % e)
+from dtb_index import DtbIndex
 
 
 def to_u64(high: int, low: int) -> int:
@@ -123,41 +120,19 @@ def parse_ranges_property(node) -> List[Dict]:
     return results
 
 
-def find_pcie_nodes(rootnode) -> List[Tuple[object, str, int]]:
+def find_pcie_nodes(index) -> List[Tuple[object, str, int]]:
     """Find all PCIe controller nodes and return (node, path, domain_number).
 
     The returned "path" is the full device-tree path (e.g., '/soc/qcom,pcie@1c00000')
-    to avoid ambiguity between vendor-prefixed names.
+    to avoid ambiguity between vendor-prefixed names. Nodes come in tree order.
     """
     results = []
-    
-    def node_full_path(node):
-        parts = []
-        p = node
-        while p is not None and hasattr(p, 'name') and p.name:
-            parts.append(p.name)
-            p = getattr(p, 'parent', None)
-        if parts:
-            # filter out any empty parts and ensure single leading slash
-            parts = [p for p in reversed(parts) if p]
-            # Ensure single leading slash and no duplicate slashes
-            path = '/' + '/'.join(parts)
-            return re.sub('/+', '/', path)
-        return node.name
-
-    def walk(node, depth=0):
-        if hasattr(node, 'name') and node.name and 'pcie' in node.name.lower():
-            # Extract domain number from node name (e.g., pcie@1c00000 -> 0, pcie1@... -> 1)
-            match = re.search(r'pcie(\d+)?', node.name)
-            domain_num = int(match.group(1)) if match and match.group(1) else 0
-            results.append((node, node_full_path(node), domain_num))
-        
-        if hasattr(node, 'subdata'):
-            for child in node.subdata:
-                if hasattr(child, 'subdata'):
-                    walk(child, depth + 1)
-    
-    walk(rootnode)
+    for node_id in index.nodes_named(lambda name: 'pcie' in name.lower()):
+        node = index.node(node_id)
+        # Extract domain number from node name (e.g., pcie@1c00000 -> 0, pcie1@... -> 1)
+        match = re.search(r'pcie(\d+)?', node.name)
+        domain_num = int(match.group(1)) if match and match.group(1) else 0
+        results.append((node, node.path, domain_num))
     return results
 
 
@@ -201,11 +176,8 @@ def extract_mcfg_params(dtb_path: str) -> List[Dict]:
       - bus_end: Ending bus number
       - domain_num: Domain number from device tree
     """
-    with open(dtb_path, 'rb') as f:
-        fdt = FdtBlobParse(f).to_fdt()
-    
-    root = fdt.get_rootnode()
-    pcie_nodes = find_pcie_nodes(root)
+    index = DtbIndex.load(Path(dtb_path))
+    pcie_nodes = find_pcie_nodes(index)
     
     results = []
     
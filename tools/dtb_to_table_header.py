@@ -17,7 +17,7 @@ Usage:
   python tools/dtb_to_table_header.py sm7325.dtb
   python tools/dtb_to_table_header.py sm7325.dtb -o include/sm7325/table_header.h --oem-rev 0x7325
 
-Requires: pyfdt (pip install pyfdt)
+The DTB is read through tools/dtb_index.py, which caches its index in <dtb>.idx.
 """
 
 from __future__ import annotations
@@ -27,81 +27,57 @@ import sys
 from pathlib import Path
 from typing import List, Dict
 
-try:
-    from pyfdt.pyfdt import FdtBlobParse
-except Exception as e:
-    sys.exit("Missing dependency: pyfdt (pip install pyfdt). Error: %s" % e)
+from dtb_index import DtbIndex
 
 
-def find_cpus(rootnode):
+def find_cpus(index):
     # return list of cpu nodes (node objects)
-    def walk(node):
-        for sd in node.subdata:
-            if hasattr(sd, 'subdata'):
-                if sd.name == 'cpus':
-                    return [n for n in sd.subdata if hasattr(n, 'name') and n.name.startswith('cpu@')]
-                r = walk(sd)
-                if r:
-                    return r
+    cpus = index.find_path('/cpus')
+    if cpus is None:
         return []
-    return walk(rootnode)
-
-
-def find_cpu_map_clusters(rootnode):
-    # Look for /cpus/cpu-map -> cluster@ entries
-    def walk(node):
-        for sd in node.subdata:
-            if hasattr(sd, 'subdata') and sd.name == 'cpus':
-                for child in sd.subdata:
-                    if hasattr(child, 'subdata'):
-                        # cpu-map is typically a child under /cpus or named 'cpu-map'
-                        for cc in child.subdata:
-                            if hasattr(cc, 'name') and cc.name == 'cpu-map':
-                                # parse cluster entries
-                                clusters = []
-                                for cluster in cc.subdata:
-                                    if hasattr(cluster, 'name') and cluster.name.startswith('cluster@'):
-                                        core_count = sum(1 for c in cluster.subdata if hasattr(c, 'name') and c.name.startswith('cpu@'))
-                                        clusters.append(core_count)
-                                if clusters:
-                                    return clusters
-        return None
-    return walk(rootnode)
+    return [n for n in cpus.children if n.name.startswith('cpu@')]
 
 
-def find_clusters_from_qcom_gic(rootnode):
-    # Prefer explicit 'gic-interrupt-router' node; gather qcom,gic-class* lists
-    stack = [rootnode]
-    clusters = []
-    while stack:
-        n = stack.pop()
-        for sd in n.subdata:
-            if not hasattr(sd, 'subdata'):
-                continue
-            # check node name first for explicit router
-            if sd.name and 'gic-interrupt-router' in sd.name:
-                for p in sd.subdata:
-                    if hasattr(p, 'name') and p.name.startswith('qcom,gic-class') and hasattr(p, 'words'):
-                        clusters.append(len(p.words))
+def find_cpu_map_clusters(index):
+    # Look for /cpus/<node>/cpu-map -> cluster@ entries
+    cpus = index.find_path('/cpus')
+    if cpus is None:
+        return None
+    for child in cpus.children:
+        for cc in child.children:
+            if cc.name == 'cpu-map':
+                # parse cluster entries
+                clusters = []
+                for cluster in cc.children:
+                    if cluster.name.startswith('cluster@'):
+                        core_count = sum(1 for c in cluster.children if c.name.startswith('cpu@'))
+                        clusters.append(core_count)
                 if clusters:
                     return clusters
-            stack.append(sd)
-    # fallback: scan entire tree for qcom,gic-class* props
-    stack = [rootnode]
-    while stack:
-        n = stack.pop()
-        for sd in n.subdata:
-            if not hasattr(sd, 'subdata'):
-                continue
-            for p in sd.subdata:
-                if hasattr(p, 'name') and p.name.startswith('qcom,gic-class') and hasattr(p, 'words'):
-                    clusters.append(len(p.words))
-            stack.append(sd)
+    return None
+
+
+def gic_class_counts(node):
+    return [len(p.words) for p in node.subdata
+            if hasattr(p, 'words') and p.name.startswith('qcom,gic-class')]
+
+
+def find_clusters_from_qcom_gic(index):
+    # Prefer explicit 'gic-interrupt-router' node; gather qcom,gic-class* lists
+    candidates = index.in_stack_order(
+        index.nodes_with_property(lambda name: name.startswith('qcom,gic-class')))
+    for node in candidates:
+        if 'gic-interrupt-router' in node.name:
+            clusters = gic_class_counts(node)
+            if clusters:
+                return clusters
+    # fallback: every node with qcom,gic-class* props
+    clusters = [count for node in candidates for count in gic_class_counts(node)]
     return clusters if clusters else None
 
 
 def count_l2_caches(cpus):
-    """Return 2 if every CPU references the same next-level-cache phandle, otherwise return None to indicate manual inspection needed."""
+    """Return 1 if every CPU references the same next-level-cache phandle, otherwise return None to indicate manual inspection needed."""
     ph_list = []
     for cpu in cpus:
         val = None
@@ -116,25 +92,19 @@ def count_l2_caches(cpus):
     if first is None:
         return None
     if all(x == first for x in ph_list):
-        # Per requirement: if equal across CPUs, set to 2
-        return 2
+        # One shared L2, as the qcom/sm8850 pptt.h declares it
+        return 1
     return None
 
 
-def detect_l3_caches(rootnode):
+def detect_l3_caches(index):
     # look for nodes with 'l3' in name or properties stating level 3
-    stack = [rootnode]
-    for n in stack:
-        for sd in n.subdata:
-            if hasattr(sd, 'subdata'):
-                stack.append(sd)
-                if sd.name and 'l3' in sd.name.lower():
-                    return 1
-                # check properties for cache level
-                for p in sd.subdata:
-                    if hasattr(p, 'name') and p.name in ('cache-level', 'cache-size', 'cache-levels'):
-                        # best-effort: treat as L3 present
-                        return 1
+    if index.nodes_named(lambda name: 'l3' in name.lower()):
+        return 1
+    # best-effort: treat as L3 present (root properties do not count)
+    cache_props = ('cache-level', 'cache-size', 'cache-levels')
+    if any(index.nodes_with_property(lambda name: name in cache_props)):
+        return 1
     return 0
 
 
@@ -166,17 +136,14 @@ HEADER_TMPL = '''#pragma once
 
 
 def generate_header(dtb_path: Path, out_path: Path, oem_rev: int = 0, default_l1: int = 2):
-    with dtb_path.open('rb') as f:
-        fdt = FdtBlobParse(f).to_fdt()
-
-    root = fdt.rootnode
-    cpus = find_cpus(root)
+    index = DtbIndex.load(dtb_path)
+    cpus = find_cpus(index)
     num_cores = len(cpus)
 
     # clusters detection
-    clusters = find_cpu_map_clusters(root)
+    clusters = find_cpu_map_clusters(index)
     if not clusters:
-        clusters = find_clusters_from_qcom_gic(root)
+        clusters = find_clusters_from_qcom_gic(index)
     if not clusters:
         # fallback: single cluster
         clusters = [num_cores] if num_cores > 0 else [0]
@@ -195,7 +162,7 @@ def generate_header(dtb_path: Path, out_path: Path, oem_rev: int = 0, default_l1
 
     # caches
     l2_count = count_l2_caches(cpus)
-    l3_count = detect_l3_caches(root)
+    l3_count = detect_l3_caches(index)
     l1_count = default_l1
 
     # Format L2 macro: if l2_count is None -> prompt for manual fix
@@ -0,0 +1,387 @@
+#!/usr/bin/env python3
+"""
+Synthetic scale benchmark of the build pipeline.
+
+Generates a source tree with N fake devices (vendors v000, v001, ... with
+--socs-per-vendor SoCs each) next to the real one: CMakeLists.txt, src/,
+lib/ and include/common are symlinked, include/vendor only holds the
+generated devices. Every device gets realistic headers:
+
+ - table_header.h: OEM revision, NUM_CORES/NUM_CLUSTERS/NUM_CLUSTER_n_CORES
+   and cache counts, 1 to 4 clusters of 1 to 8 cores
+ - pptt.h: ID, optional L3, one L2 per cluster, shared L1I/L1D, system,
+   cluster and CPU nodes (the sm8850 layout, scaled)
+ - madt.h: GICD, ITS and one GICC per core
+ - csrt.h: timer group and a misc group with a 4 to 64 KiB vendor blob
+ - gtdt.h: the reference timers
+
+Core counts and blob sizes come from a seeded RNG, so a given N always
+produces the same tree. For every N the stages are then run and timed in a
+fresh build directory:
+
+  configure  cmake -S <tree> -B <build> (table discovery, one target per table)
+  tools      the tools target build_all_devices depends on (constant, the
+             baseline)
+  compile    build_all_devices: header compile and archive of every table
+  extract    process_all_tables: extract, disassemble, grep validation
+  validate   acpi_validate over the build directory
+  noop       a second full build with nothing to do (dependency checks)
+
+Each stage records wall time, CPU time and the peak RSS of its process
+tree (wait4), the build directory size is recorded after the last stage.
+The report (text, plus JSON for tracking across releases) gives per stage
+time and memory against N, the cost per device and the growth exponent
+between consecutive sizes (1.0 is linear).
+
+Usage:
+  python tools/scale_bench.py -n 10,100,1000 -j 8 -w build/scale -o scale.json
+  python tools/scale_bench.py -n 50 --generate-only -w /tmp/tree
+"""
+
+import argparse
+import json
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import time
+from pathlib import Path
+from typing import Dict, List
+
+ROOT_DIR = Path(__file__).resolve().parent.parent
+
+# Entries of the source tree shared with the generated one
+LINKED = ('CMakeLists.txt', 'src', 'lib', 'bench', 'test', 'tools')
+
+STAGES = ('configure', 'tools', 'compile', 'extract', 'validate', 'noop')
+
+
+# =============================================================================
+# Tree generator
+# =============================================================================
+
+def vendor_header(vendor: str, index: int) -> str:
+    oem = (vendor.upper() + '    ')[:6]
+    oem_id = ', '.join(f"'{c}'" for c in oem)
+    table_id = ', '.join(f"'{c}'" for c in (vendor.upper() + 'EDK2')[:8].ljust(8))
+    return f"""#pragma once
+
+#define ACPI_TABLE_HEADER_OEM_ID {oem_id} // "{oem.strip()}"
+#define ACPI_TABLE_HEADER_OEM_TABLE_ID {table_id}
+#define ACPI_CSRT_VENDOR_ID 0x{0x4D560000 + index:08X}ULL
+#define ACPI_CSRT_SUB_VENDOR_ID 0x0ULL
+
+enum ACPI_CSRT_DEVICE_ID {{
+  DEVICE_ID_TIMER = 0x100B,
+  DEVICE_ID_MISC = 0x100C,
+}};
+"""
+
+
+def table_header(revision: int, clusters: List[int], l3: int) -> str:
+    lines = [
+        "#include <acpi_vendor.h>", "",
+        f"#define ACPI_OEM_REVISION 0x{revision:04X}", "",
+        "/* Platform specific configuration */",
+        f"#define NUM_CORES {sum(clusters)}",
+        f"#define NUM_CLUSTERS {len(clusters)}",
+        "#define NUM_SYSTEM 1",
+    ]
+    lines += [f"#define NUM_CLUSTER_{i}_CORES {cores}" for i, cores in enumerate(clusters)]
+    lines += ["",
+              "#define L1_CACHES_COUNT 2",
+              f"#define L2_CACHES_COUNT {len(clusters)}",
+              f"#define L3_CACHES_COUNT {l3}"]
+    return '\n'.join(lines) + '\n'
+
+
+def pptt_header(clusters: List[int], l3: int) -> str:
+    # Cache indexes: L3 first, then one L2 per cluster, then L1I/L1D
+    l2_base = l3
+    l1i, l1d = l3 + len(clusters), l3 + len(clusters) + 1
+    out = ["#pragma once", '#include "table_header.h"', "#include <common/pptt.h>", "",
+           "/* Platform specific configuration */",
+           "#define SYSTEM_PRIVATE_RESOURCES_COUNT 1       // ID",
+           "#define CLUSTER_PRIVATE_RESOURCES_COUNT 1      // L2 Cache",
+           "#define PHYSICAL_CPU_PRIVATE_RESOURCES_COUNT 2 // L1I, L1D", "",
+           "PPTT_DEFINE_SYSTEM;", "PPTT_DEFINE_CLUSTER;", "PPTT_DEFINE_PHYSICAL_CPU;",
+           "PPTT_DEFINE_TABLE;", "PPTT_DEFINE_WITH_MAGIC;", "",
+           "PPTT_START{", "    PPTT_DECLARE_HEADER,", "    PPTT_DECLARE_ID(),",
+           "    PPTT_DECLARE_PROCESSOR_HIERARCHY_SYSTEM(0, 0, PPTT_REFERENCE_ID),"]
+    if l3:
+        out.append("    PPTT_DECLARE_L3_CACHE(0, 0),")
+    next_level = "PPTT_REFERENCE_CACHE(0)" if l3 else "0"
+    for c in range(len(clusters)):
+        out.append(f"    PPTT_DECLARE_L2_CACHE({l2_base + c}, {next_level}), // Cluster {c}")
+    out += [f"    PPTT_DECLARE_L1_ICACHE({l1i}, 0),", f"    PPTT_DECLARE_L1_DCACHE({l1d}, 0),"]
+    for c in range(len(clusters)):
+        out.append(f"    PPTT_DECLARE_PROCESSOR_HIERARCHY_CLUSTER({c}, {c}, PPTT_REFERENCE_SYSTEM,\n"
+                   f"                                             PPTT_REFERENCE_CACHE({l2_base + c})),")
+    core = 0
+    for c, cores in enumerate(clusters):
+        for _ in range(cores):
+            out.append(f"    PPTT_DECLARE_PROCESSOR_HIERARCHY_PHYSICAL_CPU(\n"
+                       f"        {core}, {core}, PPTT_REFERENCE_CLUSTER({c}), PPTT_REFERENCE_CACHE({l1i}),\n"
+                       f"        PPTT_REFERENCE_CACHE({l1d})),")
+            core += 1
+    out.append("} PPTT_END")
+    return '\n'.join(out) + '\n'
+
+
+def madt_header(clusters: List[int], base: int) -> str:
+    out = ["#pragma once", '#include "table_header.h"', "#include <common/madt.h>", "",
+           f"#define GICD_BASE_ADDRESS 0x{base:08X}ULL",
+           f"#define GIC_ITS_BASE_ADDRESS 0x{base + 0x40000:08X}ULL",
+           f"#define GICR_BASE_ADDRESS 0x{base + 0x80000:08X}ULL",
+           "#define GICR_STRIDE 0x40000ULL",
+           "#define GICC_PERFORMANCE_INTERRUPT_GSI 0x17",
+           "#define GICC_VGIC_MAINTENANCE_INTERRUPT 0x19",
+           "#define GIC_VERSION GIC_V3",
+           "#define NUM_ITS 1", "",
+           "MADT_DEFINE_TABLE(NUM_CORES, NUM_ITS, ACPI_MADT_TABLE_STRUCTURE_NAME);",
+           "MADT_DEFINE_WITH_MAGIC;", "",
+           "MADT_START{", "    MADT_DECLARE_HEADER,", "    MADT_DECLARE_HEADER_EXTRA_DATA(0, 0),",
+           "    MADT_DECLARE_GICD_STRUCTURE(GICD_BASE_ADDRESS, GIC_VERSION),",
+           "    MADT_DECLARE_GIC_ITS_STRUCTURE(0, GIC_ITS_BASE_ADDRESS, 0),"]
+    core = 0
+    for c, cores in enumerate(clusters):
+        for i in range(cores):
+            out.append(f"    MADT_DECLARE_GICC_STRUCTURE({core}, {core}, 0x{(c << 16) | (i << 8):08X}ULL),")
+            core += 1
+    out.append("} MADT_END;")
+    return '\n'.join(out) + '\n'
+
+
+def csrt_header(rng: random.Random, blob_size: int) -> str:
+    timer = [0x02, 0, 0, 0, 0, 0, 0xC1, 0x17, 0, 0, 0, 0, 0xFD, 0x7F, 0, 0, 0x20, 0, 0, 0]
+    # Mostly zero like the real misc blobs, with runs of descriptor words
+    blob = bytearray(blob_size)
+    for offset in range(0, blob_size - 12, 12):
+        if rng.random() < 0.4:
+            blob[offset:offset + 6] = bytes(rng.randrange(256) for _ in range(6))
+    rows = ',\n'.join('        ' + ', '.join(f"0x{b:02X}" for b in blob[i:i + 12])
+                      for i in range(0, blob_size, 12))
+    return f"""#pragma once
+#include "table_header.h"
+#include <common/csrt.h>
+
+#define CSRT_RG_TIMER_VENDOR_DEFINED_INFO_LENGTH 0x{len(timer):X}
+#define CSRT_RG_MISC_VENDOR_DEFINED_INFO_LENGTH 0x{blob_size:X}
+
+CSRT_DEFINE_RESOURCE_GROUP(TIMER, 0, CSRT_RG_TIMER_VENDOR_DEFINED_INFO_LENGTH);
+CSRT_DEFINE_RESOURCE_GROUP(MISC, 0, CSRT_RG_MISC_VENDOR_DEFINED_INFO_LENGTH);
+
+CSRT_DEFINE_TABLE(CSRT_TABLE_DEFINE_RESOURCE_GROUP(TIMER);
+                  CSRT_TABLE_DEFINE_RESOURCE_GROUP(MISC););
+CSRT_DEFINE_WITH_MAGIC;
+
+CSRT_START{{
+    CSRT_DECLARE_HEADER,
+    CSRT_DECLARE_RG(TIMER, ACPI_CSRT_VENDOR_ID, ACPI_CSRT_SUB_VENDOR_ID,
+                    DEVICE_ID_TIMER, 0, 0, 0,
+                    CSRT_RG_TIMER_VENDOR_DEFINED_INFO_LENGTH,
+                    CSRT_RESOURCE_TYPE_TIMER, CSRT_RESOURCE_TIMER_SUBTYPE_TIMER, 1,
+        {', '.join(f"0x{b:02X}" for b in timer)}),
+    CSRT_DECLARE_RG(MISC, ACPI_CSRT_VENDOR_ID, ACPI_CSRT_SUB_VENDOR_ID,
+                    DEVICE_ID_MISC, 0, 1, 0,
+                    CSRT_RG_MISC_VENDOR_DEFINED_INFO_LENGTH,
+                    CSRT_RESOURCE_TYPE_PLATFORM_SECURITY,
+                    CSRT_RESOURCE_PLATFORM_SECURITY_SUBTYPE_PLATFORM_SECURITY,
+                    0xDEADF00D,
+{rows}),
+}} CSRT_END;
+"""
+
+
+def generate_tree(tree: Path, devices: int, socs_per_vendor: int, seed: int) -> Dict:
+    """Write the mirrored source tree with devices fake SoCs, returns its stats"""
+    if tree.exists():
+        shutil.rmtree(tree)
+    (tree / 'include' / 'vendor').mkdir(parents=True)
+    for name in LINKED:
+        (tree / name).symlink_to(ROOT_DIR / name)
+    for entry in (ROOT_DIR / 'include').iterdir():
+        if entry.name != 'vendor':
+            (tree / 'include' / entry.name).symlink_to(entry)
+
+    rng = random.Random(seed)
+    stats = {'devices': devices, 'tables': 0, 'cores': 0, 'header_bytes': 0}
+    for number in range(devices):
+        vendor_index, soc_index = divmod(number, socs_per_vendor)
+        vendor = f"v{vendor_index:03d}"
+        vendor_dir = tree / 'include' / 'vendor' / vendor
+        if soc_index == 0:
+            vendor_dir.mkdir()
+            (vendor_dir / 'acpi_vendor.h').write_text(vendor_header(vendor, vendor_index))
+        soc_dir = vendor_dir / f"s{soc_index:03d}"
+        soc_dir.mkdir()
+
+        clusters = [rng.randint(1, 8) for _ in range(rng.randint(1, 4))]
+        l3 = 1 if sum(clusters) > 8 else 0
+        headers = {
+            'table_header.h': table_header(0x1000 + number, clusters, l3),
+            'pptt.h': pptt_header(clusters, l3),
+            'madt.h': madt_header(clusters, 0x17000000 + (number % 16) * 0x100000),
+            'csrt.h': csrt_header(rng, rng.randrange(4096, 65536, 12)),
+            'gtdt.h': (ROOT_DIR / 'include/vendor/qcom/sm8850/gtdt.h').read_text(),
+        }
+        for name, text in headers.items():
+            (soc_dir / name).write_text(text)
+            stats['header_bytes'] += len(text)
+        stats['tables'] += len(headers) - 1
+        stats['cores'] += sum(clusters)
+    return stats
+
+
+# =============================================================================
+# Stage runner
+# =============================================================================
+
+def run_stage(command: List[str], log) -> Dict:
+    """Run command, returning wall and CPU time and the peak RSS of its process
+    tree (wait4 accounts the waited-for descendants to the child)"""
+    log.write(f"$ {' '.join(command)}\n")
+    log.flush()
+    start = time.monotonic()
+    process = subprocess.Popen(command, stdout=log, stderr=subprocess.STDOUT)
+    _, status, usage = os.wait4(process.pid, 0)
+    process.returncode = os.waitstatus_to_exitcode(status)
+    return {
+        'ok': process.returncode == 0,
+        'wall_s': round(time.monotonic() - start, 3),
+        'cpu_s': round(usage.ru_utime + usage.ru_stime, 3),
+        'peak_rss_kb': usage.ru_maxrss,
+    }
+
+
+def directory_size(path: Path) -> int:
+    return sum(p.stat().st_size for p in path.rglob('*') if p.is_file() and not p.is_symlink())
+
+
+def measure(work: Path, devices: int, args) -> Dict:
+    tree, build = work / f"n{devices}" / 'tree', work / f"n{devices}" / 'build'
+    start = time.monotonic()
+    result = generate_tree(tree, devices, args.socs_per_vendor, args.seed)
+    result['generate_s'] = round(time.monotonic() - start, 3)
+    if build.exists():
+        shutil.rmtree(build)
+
+    cmake = [args.cmake, '--build', str(build), '-j', str(args.jobs), '--target']
+    commands = {
+        'configure': [args.cmake, '-S', str(tree), '-B', str(build), '-DACPI_DUMP_NATIVE=ON',
+                      '-DEXPORT_COMPILE_COMMANDS=OFF'],
+        'tools': cmake + ['tools'],
+        'compile': cmake + ['build_all_devices'],
+        'extract': cmake + ['process_all_tables'],
+        'validate': [str(build / 'acpi_validate'), str(build)],
+        'noop': [args.cmake, '--build', str(build), '-j', str(args.jobs)],
+    }
+    result['stages'] = {}
+    with open(work / f"n{devices}" / 'stages.log', 'w') as log:
+        for stage in STAGES:
+            if stage == 'noop':
+                # The rest of ALL (other tools, manifest), not measured
+                run_stage(commands['noop'], log)
+            stage_result = run_stage(commands[stage], log)
+            result['stages'][stage] = stage_result
+            print(f"  {stage:<10} {stage_result['wall_s']:>9.2f} s  "
+                  f"{stage_result['peak_rss_kb'] / 1024:>8.1f} MiB"
+                  f"{'' if stage_result['ok'] else '  FAILED (see stages.log)'}")
+            if not stage_result['ok']:
+                break
+    result['build_bytes'] = directory_size(build)
+    if not args.keep:
+        shutil.rmtree(work / f"n{devices}")
+    return result
+
+
+# =============================================================================
+# Report
+# =============================================================================
+
+def growth(small: Dict, large: Dict, stage: str) -> str:
+    """Exponent k of time ~ N^k between two sizes"""
+    t0 = small['stages'].get(stage, {}).get('wall_s')
+    t1 = large['stages'].get(stage, {}).get('wall_s')
+    if not t0 or not t1 or small['devices'] == large['devices']:
+        return '-'
+    return f"{math.log(t1 / t0) / math.log(large['devices'] / small['devices']):.2f}"
+
+
+def report(results: List[Dict]) -> List[str]:
+    lines = [f"{'N':>6} {'tables':>7} {'stage':<10} {'wall s':>9} {'ms/device':>10} "
+             f"{'cpu s':>9} {'peak MiB':>9}"]
+    for result in results:
+        for stage in STAGES:
+            s = result['stages'].get(stage)
+            if not s:
+                continue
+            lines.append(f"{result['devices']:>6} {result['tables']:>7} {stage:<10} {s['wall_s']:>9.2f} "
+                         f"{1000 * s['wall_s'] / result['devices']:>10.1f} {s['cpu_s']:>9.2f} "
+                         f"{s['peak_rss_kb'] / 1024:>9.1f}")
+        lines.append(f"{result['devices']:>6} {'':>7} {'disk':<10} "
+                     f"{result['build_bytes'] / 2 ** 20:>9.1f} MiB build tree, "
+                     f"{result['header_bytes'] / 2 ** 20:.1f} MiB headers")
+    if len(results) > 1:
+        lines += ["", "Growth exponent of wall time between sizes (1.00 = linear)"]
+        for small, large in zip(results, results[1:]):
+            lines.append(f"  {small['devices']:>5} -> {large['devices']:<5} " +
+                         "  ".join(f"{stage} {growth(small, large, stage)}" for stage in STAGES))
+    return lines
+
+
+def parse_sizes(text: str) -> List[int]:
+    return sorted({int(size) for size in text.split(',') if size.strip()})
+
+
+def main():
+    p = argparse.ArgumentParser(description='Scale benchmark with generated vendor trees')
+    p.add_argument('-n', '--devices', default='10,50', help='device counts, e.g. 10,100,1000')
+    p.add_argument('-m', '--socs-per-vendor', type=int, default=10, help='SoCs per fake vendor (default 10)')
+    p.add_argument('-j', '--jobs', type=int, default=os.cpu_count() or 1, help='build jobs')
+    p.add_argument('-w', '--work-dir', type=Path, default=ROOT_DIR / 'build' / 'scale',
+                   help='generated trees and builds (default: build/scale)')
+    p.add_argument('-o', '--output', type=Path, help='JSON report')
+    p.add_argument('-l', '--label', default='', help='label stored in the JSON, e.g. release or commit')
+    p.add_argument('--seed', type=int, default=1, help='generator seed (default 1)')
+    p.add_argument('--cmake', default='cmake', help='cmake executable')
+    p.add_argument('--keep', action='store_true', help='keep the generated trees and builds')
+    p.add_argument('--generate-only', action='store_true', help='only write the tree of the first size')
+    args = p.parse_args()
+
+    sizes = parse_sizes(args.devices)
+    if not sizes or args.socs_per_vendor < 1:
+        p.error('need at least one device count and one SoC per vendor')
+    args.work_dir.mkdir(parents=True, exist_ok=True)
+
+    if args.generate_only:
+        stats = generate_tree(args.work_dir / 'tree', sizes[0], args.socs_per_vendor, args.seed)
+        print(f"Wrote {stats['devices']} device(s), {stats['tables']} table(s), {stats['cores']} core(s) "
+              f"to {args.work_dir / 'tree'}")
+        return 0
+
+    results = []
+    for devices in sizes:
+        print(f"N={devices} ({math.ceil(devices / args.socs_per_vendor)} vendor(s) x "
+              f"{min(devices, args.socs_per_vendor)} SoC(s), -j{args.jobs})")
+        results.append(measure(args.work_dir, devices, args))
+
+    lines = report(results)
+    print()
+    print('\n'.join(lines))
+    failed = [r['devices'] for r in results if not all(s['ok'] for s in r['stages'].values())]
+    if args.output:
+        args.output.write_text(json.dumps({
+            'label': args.label, 'jobs': args.jobs, 'seed': args.seed,
+            'socs_per_vendor': args.socs_per_vendor, 'results': results,
+        }, indent=2) + '\n')
+        print(f"\nWrote {args.output}")
+    if failed:
+        print(f"Failed for N={', '.join(map(str, failed))}")
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
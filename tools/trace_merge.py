@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+Merge the pipeline stage spans of a build into a Chrome trace.
+
+Spans come from <build>/trace/spans.jsonl, one JSON object per line
+(tool, device, table, stage, start_us, dur_us, bytes, pid), written by
+lib/trace.c in the C tools, by acpi_trace around every traced build step
+(tool "run") and by test/run_all_tests.py. With the Ninja generator the
+<build>/.ninja_log entries are added too: ninja logs times relative to its
+own start, they are moved to the wall clock with the median offset between
+the output mtimes and the entry end times of the last ninja run. Entries a
+"run" span already covers are dropped.
+
+Writes:
+  <out>/trace.json   Chrome trace format (chrome://tracing, Perfetto), one
+                     process per device, one thread per OS process
+  <out>/summary.txt  Critical path of every device: the table whose serial
+                     compile -> archive -> extract -> disassemble -> validate
+                     chain is the longest, with the share of each stage,
+                     then totals per stage and tool
+
+Usage:
+  python tools/trace_merge.py build
+  python tools/trace_merge.py build --spans other.jsonl -o /tmp/trace
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+from collections import defaultdict
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, List
+
+# Serial steps of one table, in build order
+PIPELINE = ('compile', 'archive', 'extract', 'disassemble', 'validate')
+
+# Ninja outputs of the per table steps, see the device loop of CMakeLists.txt
+NINJA_OUTPUTS = (
+    (re.compile(r'CMakeFiles/(?P<target>\w+)\.dir/.*\.c\.o$'), 'compile'),
+    (re.compile(r'(?:^|/)lib(?P<target>\w+)\.a$'), 'archive'),
+    (re.compile(r'(?:^|/)(?P<device>[^/]+)/(?P<table>[A-Z0-9]{4})\.aml$'), 'extract'),
+    (re.compile(r'(?:^|/)(?P<device>[^/]+)/(?P<table>[A-Z0-9]{4})\.dsl$'), 'disassemble'),
+    (re.compile(r'(?:^|/)(?P<device>[^/]+)/\.(?P<table>\w+)_validated$'), 'validate'),
+)
+
+
+@dataclass
+class Span:
+    tool: str
+    device: str
+    table: str
+    stage: str
+    start_us: int
+    dur_us: int
+    bytes: int = 0
+    pid: int = 0
+
+    @property
+    def end_us(self):
+        return self.start_us + self.dur_us
+
+
+def load_spans(path: Path) -> List[Span]:
+    spans = []
+    if not path.exists():
+        return spans
+    for number, line in enumerate(path.read_text().splitlines(), 1):
+        if not line.strip():
+            continue
+        try:
+            entry = json.loads(line)
+            spans.append(Span(entry['tool'], entry.get('device') or 'all', entry.get('table', ''),
+                              entry['stage'], int(entry['start_us']), int(entry['dur_us']),
+                              int(entry.get('bytes', 0)), int(entry.get('pid', 0))))
+        except (ValueError, KeyError, TypeError) as e:
+            print(f"⚠️  {path}:{number}: skipped ({e})")
+    return spans
+
+
+def split_target(target: str, devices: List[str]):
+    """<device>_<table> library target -> (device, TABLE)"""
+    for device in sorted(devices, key=len, reverse=True):
+        if target.startswith(device + '_'):
+            return device, target[len(device) + 1:].upper()
+    return None, None
+
+
+def classify_output(output: str, devices: List[str]):
+    """(device, table, stage) of a ninja output, tools and the rest go to 'tools'"""
+    for pattern, stage in NINJA_OUTPUTS:
+        match = pattern.search(output)
+        if not match:
+            continue
+        groups = match.groupdict()
+        if 'target' in groups:
+            device, table = split_target(groups['target'], devices)
+        else:
+            device, table = groups['device'], groups['table'].upper()
+        if device in devices:
+            return device, table, stage
+    return 'tools', Path(output).name, 'build'
+
+
+def load_ninja_log(build_dir: Path, devices: List[str]) -> List[Span]:
+    """Entries of the last ninja run, on the wall clock (see module doc)"""
+    path = build_dir / '.ninja_log'
+    if not path.exists():
+        return []
+    entries = []
+    for line in path.read_text().splitlines():
+        if line.startswith('#'):
+            continue
+        fields = line.split('\t')
+        if len(fields) < 4:
+            continue
+        try:
+            start_ms, end_ms, mtime = int(fields[0]), int(fields[1]), int(fields[2])
+        except ValueError:
+            continue
+        # mtime is in ns since ninja 1.9, in seconds before
+        mtime_us = mtime // 1000 if mtime > 10 ** 14 else mtime * 10 ** 6
+        entries.append((start_ms, end_ms, mtime_us, fields[3]))
+    if not entries:
+        return []
+
+    # Outputs of older runs (or restat'ed ones) have older mtimes, the last
+    # run is the cluster with the largest offsets
+    offsets = [mtime - end * 1000 for _, end, mtime, _ in entries]
+    latest = max(offsets)
+    recent = [o for o in offsets if o >= latest - 5 * 10 ** 6]
+    base = int(statistics.median(recent))
+
+    spans = []
+    for (start, end, _, output), offset in zip(entries, offsets):
+        if offset < latest - 5 * 10 ** 6:
+            continue
+        device, table, stage = classify_output(output, devices)
+        spans.append(Span('ninja', device, table, stage, base + start * 1000, (end - start) * 1000))
+    return spans
+
+
+def merge(spans: List[Span], ninja: List[Span]) -> List[Span]:
+    covered = {(s.device, s.table, s.stage) for s in spans if s.tool == 'run'}
+    return sorted(spans + [s for s in ninja if (s.device, s.table, s.stage) not in covered],
+                  key=lambda s: s.start_us)
+
+
+def chrome_trace(spans: List[Span]) -> Dict:
+    t0 = min(s.start_us for s in spans)
+    devices = sorted({s.device for s in spans})
+    pids = {device: number for number, device in enumerate(devices, 1)}
+    events = [{'name': 'process_name', 'ph': 'M', 'pid': pids[d], 'args': {'name': d}} for d in devices]
+    for s in spans:
+        events.append({
+            'name': f"{s.stage} {s.table}".strip(), 'cat': s.tool, 'ph': 'X',
+            'ts': s.start_us - t0, 'dur': s.dur_us, 'pid': pids[s.device], 'tid': s.pid,
+            'args': {'tool': s.tool, 'table': s.table, 'bytes': s.bytes},
+        })
+    return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+
+def ms(us: int) -> str:
+    return f"{us / 1000:.1f} ms"
+
+
+def summarize(spans: List[Span]) -> List[str]:
+    lines = ["Critical path per device (longest table chain of build steps)", ""]
+    steps = [s for s in spans if s.tool in ('run', 'ninja') and s.stage in PIPELINE]
+    by_device: Dict[str, List[Span]] = defaultdict(list)
+    for s in steps:
+        by_device[s.device].append(s)
+    if not by_device:
+        lines.append("  no build step spans (compile ... validate)")
+
+    for device in sorted(by_device):
+        chains: Dict[str, Dict[str, int]] = defaultdict(lambda: defaultdict(int))
+        for s in by_device[device]:
+            chains[s.table][s.stage] += s.dur_us
+        wall = max(s.end_us for s in by_device[device]) - min(s.start_us for s in by_device[device])
+        table, chain = max(chains.items(), key=lambda item: sum(item[1].values()))
+        total = sum(chain.values())
+        stages = ", ".join(f"{stage} {ms(chain[stage])} ({100 * chain[stage] / total:.0f}%)"
+                           for stage in PIPELINE if stage in chain)
+        lines.append(f"{device:<24} wall {ms(wall)}, critical {table} {ms(total)}: {stages}")
+
+    lines += ["", "Totals per stage", ""]
+    totals: Dict[tuple, List[Span]] = defaultdict(list)
+    for s in spans:
+        totals[(s.tool, s.stage)].append(s)
+    lines.append(f"  {'tool':<16} {'stage':<26} {'count':>6} {'total':>12} {'max':>12} {'bytes':>12}")
+    for (tool, stage), group in sorted(totals.items(), key=lambda item: -sum(s.dur_us for s in item[1])):
+        lines.append(f"  {tool:<16} {stage:<26} {len(group):>6} {ms(sum(s.dur_us for s in group)):>12} "
+                     f"{ms(max(s.dur_us for s in group)):>12} {sum(s.bytes for s in group):>12}")
+
+    start, end = min(s.start_us for s in spans), max(s.end_us for s in spans)
+    devices = {s.device for s in spans}
+    lines += ["", f"{len(spans)} span(s), {len(devices)} device(s), {ms(end - start)} wall"]
+    return lines
+
+
+def main():
+    p = argparse.ArgumentParser(description='Merge build trace spans into a Chrome trace')
+    p.add_argument('build_dir', type=Path, nargs='?', default=Path('build'), help='build directory')
+    p.add_argument('--spans', type=Path, help='span file (default: <build>/trace/spans.jsonl)')
+    p.add_argument('-o', '--out', type=Path, help='output directory (default: <build>/trace)')
+    args = p.parse_args()
+
+    spans_path = args.spans or args.build_dir / 'trace' / 'spans.jsonl'
+    out_dir = args.out or args.build_dir / 'trace'
+    spans = load_spans(spans_path)
+    devices = sorted({s.device for s in spans} |
+                     {d.name for d in args.build_dir.glob('*/') if any(d.glob('*.aml'))})
+    ninja = load_ninja_log(args.build_dir, devices)
+    spans = merge(spans, ninja)
+    if not spans:
+        print(f"No spans in {spans_path}, configure with -DACPI_TRACE=ON and rebuild")
+        return 1
+
+    out_dir.mkdir(parents=True, exist_ok=True)
+    (out_dir / 'trace.json').write_text(json.dumps(chrome_trace(spans)))
+    summary = summarize(spans)
+    (out_dir / 'summary.txt').write_text('\n'.join(summary) + '\n')
+    print('\n'.join(summary))
+    print(f"\nWrote {out_dir / 'trace.json'} ({len(ninja)} ninja entries) and {out_dir / 'summary.txt'}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())